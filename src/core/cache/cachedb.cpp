@@ -86,7 +86,7 @@ bool CCacheDBManager::LoadFromFile(const std::string& path)
 
 	if (header->fileVersion != CACHE_DB_FILE_VERSION)
 	{
-		Log("CACHE: Failed to load CacheDB file: \"%s\". Invalid version\n", path.c_str());
+		LOG_WARN(CACHE, "CACHE: Failed to load CacheDB file: \"%s\". Invalid version\n", path.c_str());
 		return false;
 	}
 
@@ -0,0 +1,514 @@
+#include <pch.h>
+#include <core/cache/exportmanifest.h>
+
+#include <game/rtech/cpakfile.h>
+
+#include <thirdparty/zstd/common/xxhash.h>
+
+extern ExportSettings_t g_ExportSettings;
+
+CExportManifest g_exportManifest;
+
+template <typename T>
+static const uint64_t HashValue(const T& value, const uint64_t seed)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	return XXH64(&value, sizeof(T), seed);
+}
+
+static const uint64_t HashString(const std::string_view str, const uint64_t seed)
+{
+	return XXH64(str.data(), str.length(), seed);
+}
+
+const uint64_t CExportManifest::EntryKey(const uint64_t guid, const uint32_t assetType)
+{
+	return HashValue(assetType, HashValue(guid, 0ull));
+}
+
+const bool CExportManifest::GetFileState(const std::filesystem::path& path, uint64_t& fileSize, int64_t& writeTime)
+{
+	std::error_code ec;
+
+	fileSize = std::filesystem::file_size(path, ec);
+	if (ec)
+		return false;
+
+	writeTime = static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+	return !ec;
+}
+
+// the identity of the file an asset was loaded from, a pak's crc changes whenever it is rebuilt
+static const uint64_t HashContainerSource(CAsset* const asset, uint64_t hash)
+{
+	const CAssetContainer* const container = asset->GetContainerFile<CAssetContainer>();
+	if (!container)
+		return hash;
+
+	if (asset->GetAssetContainerType() == CAsset::ContainerType::PAK)
+	{
+		const CPakFile* const pak = asset->GetContainerFile<CPakFile>();
+
+		if (pak->header()->crc != 0)
+		{
+			hash = HashValue(pak->header()->crc, hash);
+
+			for (const uint64_t patchCrc : pak->patchCrcs())
+				hash = HashValue(patchCrc, hash);
+
+			return hash;
+		}
+	}
+
+	std::error_code ec;
+	const std::filesystem::path containerPath = container->GetContainerFilePath();
+	const uint64_t fileSize = std::filesystem::file_size(containerPath, ec);
+	const int64_t writeTime = ec ? 0ll : static_cast<int64_t>(std::filesystem::last_write_time(containerPath, ec).time_since_epoch().count());
+
+	hash = HashValue(fileSize, hash);
+	hash = HashValue(writeTime, hash);
+
+	return hash;
+}
+
+// exporters write files for the dependencies they use (a model's material textures, a rig's sequences), and those can come from other paks
+// every dependency reachable from the asset is walked, the container of each one outside the asset's own is part of the asset's source
+static const uint64_t HashDependencySources(CPakAsset* const asset, uint64_t hash)
+{
+	const CAssetContainer* const container = asset->GetContainerFile<CAssetContainer>();
+
+	std::vector<CPakAsset*> visited = { asset };
+	std::vector<CPakAsset*> pending = { asset };
+	std::vector<AssetGuid_t> dependencies;
+
+	while (!pending.empty())
+	{
+		CPakAsset* const current = pending.back();
+		pending.pop_back();
+
+		current->getDependencies(dependencies);
+
+		for (const AssetGuid_t& guid : dependencies)
+		{
+			hash = HashValue(guid.guid, hash);
+
+			// one that isn't loaded leaves the guid alone, loading it later changes the hash
+			CPakAsset* const depAsset = g_assetData.FindAssetByGUID<CPakAsset>(guid.guid);
+			if (!depAsset || std::ranges::find(visited, depAsset) != visited.end())
+				continue;
+
+			visited.emplace_back(depAsset);
+			pending.emplace_back(depAsset);
+
+			if (depAsset->GetContainerFile<CAssetContainer>() != container)
+				hash = HashContainerSource(depAsset, hash);
+		}
+	}
+
+	return hash;
+}
+
+static const uint64_t HashAssetSource(CAsset* const asset)
+{
+	uint64_t hash = HashValue(asset->GetAssetGUID(), 0ull);
+	hash = HashString(asset->GetAssetName(), hash); // output paths are built from the name, which the cache db can change
+
+	hash = HashContainerSource(asset, hash);
+
+	if (asset->GetAssetContainerType() == CAsset::ContainerType::PAK)
+		hash = HashDependencySources(static_cast<CPakAsset*>(asset), hash);
+
+	return hash;
+}
+
+static const uint64_t HashTextureSettings(const uint64_t seed)
+{
+	uint64_t hash = HashValue(g_ExportSettings.exportNormalRecalcSetting, seed);
+	hash = HashValue(g_ExportSettings.exportTextureNameSetting, hash);
+	hash = HashValue(g_ExportSettings.exportMaterialTextures, hash);
+
+	// material textures are exported in the format picked for the texture type, not the material's or model's own setting
+	const auto txtrAssetBinding = g_assetData.m_assetTypeBindings.find('rtxt');
+	if (txtrAssetBinding != g_assetData.m_assetTypeBindings.end())
+		hash = HashValue(txtrAssetBinding->second.e.exportSetting, hash);
+
+	return hash;
+}
+
+static const uint64_t HashSequenceSettings(const uint64_t seed)
+{
+	uint64_t hash = HashValue(g_ExportSettings.qcMajorVersion, seed);
+	hash = HashValue(g_ExportSettings.qcMinorVersion, hash);
+	hash = HashValue(g_ExportSettings.exportSeqKeyReduction, hash);
+
+	if (g_ExportSettings.exportSeqKeyReduction)
+	{
+		hash = HashValue(g_ExportSettings.exportSeqKeyPosTolerance, hash);
+		hash = HashValue(g_ExportSettings.exportSeqKeyRotTolerance, hash);
+		hash = HashValue(g_ExportSettings.exportSeqKeyScaleTolerance, hash);
+	}
+
+	return hash;
+}
+
+// only the fields the type's exporter reads, so changing e.g. the flac level doesn't make every texture stale
+static const uint64_t HashExportSettings(const uint32_t assetType, const int exportSetting)
+{
+	uint64_t hash = HashValue(exportSetting, 0ull);
+	hash = HashValue(g_ExportSettings.exportPathsFull, hash);
+	hash = HashString(std::filesystem::current_path().string(), hash); // the export directory is relative to it
+
+	switch (static_cast<AssetType_t>(assetType))
+	{
+	case AssetType_t::MDL_:
+	case AssetType_t::MDL:
+	{
+		hash = HashTextureSettings(hash);
+		hash = HashSequenceSettings(hash);
+
+		hash = HashValue(g_ExportSettings.exportRigSequences, hash);
+		hash = HashValue(g_ExportSettings.exportModelMatsTruncated, hash);
+		hash = HashValue(g_ExportSettings.exportModelSkin, hash);
+
+		if (g_ExportSettings.exportModelSkin)
+			hash = HashValue(g_ExportSettings.previewedSkinIndex, hash);
+
+		hash = HashValue(g_ExportSettings.exportPhysicsContentsFilter, hash);
+		hash = HashValue(g_ExportSettings.exportPhysicsFilterExclusive, hash);
+		hash = HashValue(g_ExportSettings.exportPhysicsFilterAND, hash);
+
+		break;
+	}
+	case AssetType_t::ARIG:
+	{
+		hash = HashSequenceSettings(hash);
+		hash = HashValue(g_ExportSettings.exportRigSequences, hash);
+
+		break;
+	}
+	case AssetType_t::ASEQ:
+	case AssetType_t::SEQ:
+	{
+		hash = HashSequenceSettings(hash);
+
+		break;
+	}
+	case AssetType_t::MATL:
+	case AssetType_t::TXTR:
+	{
+		hash = HashTextureSettings(hash);
+
+		break;
+	}
+	case AssetType_t::ASRC:
+	{
+		hash = HashValue(g_ExportSettings.exportAudioFlacLevel, hash);
+		hash = HashValue(g_ExportSettings.exportAudioFlacBitDepth, hash);
+
+		break;
+	}
+	default:
+		break;
+	}
+
+	return hash;
+}
+
+void CExportManifest::StampAsset(CAsset* const asset, const int exportSetting, ExportManifestStamp_t& stamp)
+{
+	stamp.guid = asset->GetAssetGUID();
+	stamp.assetType = asset->GetAssetType();
+	stamp.exportSetting = exportSetting;
+
+	stamp.sourceHash = HashAssetSource(asset);
+	stamp.settingsHash = HashExportSettings(stamp.assetType, exportSetting);
+}
+
+bool CExportManifest::SaveToFile(const std::string& path)
+{
+	std::lock_guard lock(m_manifestMutex);
+
+	// nothing new, keep the file as it is
+	if (!m_dirty && std::filesystem::exists(path))
+		return true;
+
+	// only outputs that an entry still refers to are written
+	std::unordered_map<std::string_view, uint32_t> outputIndices;
+	std::vector<std::string_view> outputPaths;
+
+	uint32_t numOutputRefs = 0u;
+	for (auto& it : m_entries)
+	{
+		for (const std::string& output : it.second.outputs)
+		{
+			if (outputIndices.try_emplace(output, static_cast<uint32_t>(outputPaths.size())).second)
+				outputPaths.emplace_back(output);
+		}
+
+		numOutputRefs += static_cast<uint32_t>(it.second.outputs.size());
+	}
+
+	ExportManifestHeader_t header = {};
+
+	header.fileVersion = EXPORT_MANIFEST_FILE_VERSION;
+	header.numEntries = static_cast<uint32_t>(m_entries.size());
+	header.numOutputRefs = numOutputRefs;
+	header.numOutputs = static_cast<uint32_t>(outputPaths.size());
+
+	StreamIO manifestFile;
+	if (!manifestFile.open(path, eStreamIOMode::Write))
+		return false;
+
+	manifestFile.write(header);
+
+	uint32_t nextOutputRef = 0u;
+	for (auto& it : m_entries)
+	{
+		ExportManifestEntry_t entry = {};
+		entry.guid = it.second.guid;
+		entry.assetType = it.second.assetType;
+		entry.exportSetting = it.second.exportSetting;
+		entry.sourceHash = it.second.sourceHash;
+		entry.settingsHash = it.second.settingsHash;
+		entry.exportTimeNs = it.second.exportTimeNs;
+		entry.firstOutputRef = nextOutputRef;
+		entry.numOutputRefs = static_cast<uint32_t>(it.second.outputs.size());
+
+		nextOutputRef += entry.numOutputRefs;
+
+		manifestFile.write(entry);
+	}
+
+	for (auto& it : m_entries)
+	{
+		for (const std::string& output : it.second.outputs)
+			manifestFile.write(outputIndices.at(output));
+	}
+
+	uint64_t nextStringOffset = 0;
+	for (const std::string_view outputPath : outputPaths)
+	{
+		const Output_t& state = m_outputs.at(std::string(outputPath));
+
+		ExportManifestOutput_t output = {};
+		output.fileSize = state.fileSize;
+		output.writeTime = state.writeTime;
+		output.pathOffset = static_cast<uint32_t>(nextStringOffset);
+
+		nextStringOffset += outputPath.length() + 1;
+
+		manifestFile.write(output);
+	}
+
+	header.stringTableOffset = manifestFile.tell();
+
+	for (const std::string_view outputPath : outputPaths)
+	{
+		manifestFile.write(outputPath.data(), outputPath.length() + 1);
+	}
+
+	manifestFile.seek(0);
+	manifestFile.write(header);
+	manifestFile.close();
+
+	m_dirty = false;
+
+	return true;
+}
+
+bool CExportManifest::LoadFromFile(const std::string& path)
+{
+	if (!std::filesystem::exists(path))
+		return true;
+
+	StreamIO manifestFile;
+	if (!manifestFile.open(path, eStreamIOMode::Read))
+		return false;
+
+	const uint64_t manifestFileSize = manifestFile.size();
+	if (manifestFileSize < sizeof(ExportManifestHeader_t))
+	{
+		LOG_WARN(CACHE, "EXPORT MANIFEST: Failed to load export manifest file: \"%s\". File is truncated\n", path.c_str());
+		return false;
+	}
+
+	std::unique_ptr<char[]> fileData = std::make_unique<char[]>(manifestFileSize);
+	manifestFile.read(fileData.get(), manifestFileSize);
+	manifestFile.close();
+
+	const ExportManifestHeader_t* const header = reinterpret_cast<const ExportManifestHeader_t*>(fileData.get());
+
+	if (header->fileVersion != EXPORT_MANIFEST_FILE_VERSION)
+	{
+		LOG_WARN(CACHE, "EXPORT MANIFEST: Failed to load export manifest file: \"%s\". Invalid version\n", path.c_str());
+		return false;
+	}
+
+	const uint64_t tablesSize = sizeof(ExportManifestHeader_t) + (static_cast<uint64_t>(header->numEntries) * sizeof(ExportManifestEntry_t))
+		+ (static_cast<uint64_t>(header->numOutputRefs) * sizeof(uint32_t)) + (static_cast<uint64_t>(header->numOutputs) * sizeof(ExportManifestOutput_t));
+
+	if (tablesSize > manifestFileSize || header->stringTableOffset > manifestFileSize)
+	{
+		LOG_WARN(CACHE, "EXPORT MANIFEST: Failed to load export manifest file: \"%s\". File is truncated\n", path.c_str());
+		return false;
+	}
+
+	const ExportManifestEntry_t* const entries = reinterpret_cast<const ExportManifestEntry_t*>(&header[1]);
+	const uint32_t* const outputRefs = reinterpret_cast<const uint32_t*>(&entries[header->numEntries]);
+	const ExportManifestOutput_t* const outputs = reinterpret_cast<const ExportManifestOutput_t*>(&outputRefs[header->numOutputRefs]);
+
+	// checked before anything is taken from the file
+	for (uint32_t i = 0; i < header->numOutputs; ++i)
+	{
+		if (!header->GetString(outputs[i].pathOffset, manifestFileSize))
+		{
+			LOG_WARN(CACHE, "EXPORT MANIFEST: Failed to load export manifest file: \"%s\". String table is corrupt\n", path.c_str());
+			return false;
+		}
+	}
+
+	std::vector<std::string> outputPaths;
+	outputPaths.reserve(header->numOutputs);
+
+	std::lock_guard lock(m_manifestMutex);
+
+	m_outputs.reserve(header->numOutputs);
+	for (uint32_t i = 0; i < header->numOutputs; ++i)
+	{
+		const ExportManifestOutput_t* const output = &outputs[i];
+
+		outputPaths.emplace_back(header->GetString(output->pathOffset));
+		m_outputs.insert_or_assign(outputPaths.back(), Output_t{ output->fileSize, output->writeTime });
+	}
+
+	m_entries.reserve(header->numEntries);
+	for (uint32_t i = 0; i < header->numEntries; ++i)
+	{
+		const ExportManifestEntry_t* const entry = &entries[i];
+
+		if (static_cast<uint64_t>(entry->firstOutputRef) + entry->numOutputRefs > header->numOutputRefs)
+			continue;
+
+		Entry_t loaded{ entry->guid, entry->assetType, entry->exportSetting, entry->sourceHash, entry->settingsHash, entry->exportTimeNs, {} };
+
+		loaded.outputs.reserve(entry->numOutputRefs);
+		for (uint32_t ref = 0; ref < entry->numOutputRefs; ++ref)
+		{
+			const uint32_t outputIdx = outputRefs[entry->firstOutputRef + ref];
+
+			if (outputIdx < header->numOutputs)
+				loaded.outputs.emplace_back(outputPaths[outputIdx]);
+		}
+
+		m_entries.insert_or_assign(EntryKey(entry->guid, entry->assetType), std::move(loaded));
+	}
+
+	return true;
+}
+
+const bool CExportManifest::IsUpToDate(const ExportManifestStamp_t& stamp)
+{
+	std::vector<std::pair<std::string, Output_t>> outputs;
+	int64_t exportTimeNs = 0ll;
+	bool found = false;
+
+	{
+		std::lock_guard lock(m_manifestMutex);
+
+		const auto it = m_entries.find(EntryKey(stamp.guid, stamp.assetType));
+		if (it != m_entries.end() && it->second.exportSetting == stamp.exportSetting && it->second.sourceHash == stamp.sourceHash && it->second.settingsHash == stamp.settingsHash)
+		{
+			outputs.reserve(it->second.outputs.size());
+			for (const std::string& output : it->second.outputs)
+			{
+				const auto outputIt = m_outputs.find(output);
+				if (outputIt == m_outputs.end())
+					break;
+
+				outputs.emplace_back(output, outputIt->second);
+			}
+
+			exportTimeNs = it->second.exportTimeNs;
+			found = outputs.size() == it->second.outputs.size();
+		}
+	}
+
+	// every file has to be as the last export left it, one that was deleted or edited since means exporting again
+	if (found)
+	{
+		for (const auto& [output, state] : outputs)
+		{
+			uint64_t fileSize = 0ull;
+			int64_t writeTime = 0ll;
+			if (!GetFileState(output, fileSize, writeTime) || fileSize != state.fileSize || writeTime != state.writeTime)
+			{
+				found = false;
+				break;
+			}
+		}
+	}
+
+	if (!found)
+	{
+		++m_exported;
+		return false;
+	}
+
+	++m_skipped;
+	m_savedNs += exportTimeNs;
+
+	return true;
+}
+
+void CExportManifest::Add(const ExportManifestStamp_t& stamp, const std::vector<std::string>& files, const int64_t exportTimeNs)
+{
+	Entry_t entry{ stamp.guid, stamp.assetType, stamp.exportSetting, stamp.sourceHash, stamp.settingsHash, exportTimeNs, {} };
+	std::vector<Output_t> states;
+
+	entry.outputs.reserve(files.size());
+	states.reserve(files.size());
+
+	// files that are gone again (temporary files, or ones another export replaced while this one ran) can't be checked later
+	for (const std::string& file : files)
+	{
+		Output_t state = {};
+		if (!GetFileState(file, state.fileSize, state.writeTime))
+			continue;
+
+		entry.outputs.emplace_back(std::filesystem::absolute(file).string());
+		states.emplace_back(state);
+	}
+
+	std::lock_guard lock(m_manifestMutex);
+
+	const uint64_t key = EntryKey(stamp.guid, stamp.assetType);
+
+	if (entry.outputs.empty())
+	{
+		if (m_entries.erase(key))
+			m_dirty = true;
+
+		return;
+	}
+
+	for (size_t i = 0; i < entry.outputs.size(); ++i)
+		m_outputs.insert_or_assign(entry.outputs[i], states[i]);
+
+	m_entries.insert_or_assign(key, std::move(entry));
+	m_dirty = true;
+}
+
+void CExportManifest::Remove(const ExportManifestStamp_t& stamp)
+{
+	std::lock_guard lock(m_manifestMutex);
+
+	if (m_entries.erase(EntryKey(stamp.guid, stamp.assetType)))
+		m_dirty = true;
+}
+
+const ExportManifestStats_t CExportManifest::GetStats() const
+{
+	std::lock_guard lock(m_manifestMutex);
+
+	return { m_skipped.load(), m_exported.load(), m_entries.size(), m_savedNs.load() };
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+class CAsset;
+
+constexpr int EXPORT_MANIFEST_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct ExportManifestHeader_t
+{
+	uint32_t fileVersion;
+	uint32_t numEntries;	// entries immediately follow the header
+	uint32_t numOutputRefs;	// output indices of every entry, after the entries
+	uint32_t numOutputs;	// after the output indices
+
+	uint64_t stringTableOffset;
+
+	const char* GetString(uint64_t offset) const
+	{
+		return reinterpret_cast<const char*>(this) + stringTableOffset + offset;
+	}
+
+	// null if the string starts past the end of the file or isn't terminated before it
+	const char* GetString(uint64_t offset, uint64_t fileSize) const
+	{
+		if (offset >= fileSize || stringTableOffset + offset >= fileSize)
+			return nullptr;
+
+		const char* const str = GetString(offset);
+		return memchr(str, '\0', fileSize - (stringTableOffset + offset)) ? str : nullptr;
+	}
+};
+
+struct ExportManifestEntry_t
+{
+	uint64_t guid;
+	uint32_t assetType;
+	int32_t exportSetting;
+
+	uint64_t sourceHash;
+	uint64_t settingsHash;
+
+	int64_t exportTimeNs;	// time the export took, what skipping it saves
+
+	uint32_t firstOutputRef;
+	uint32_t numOutputRefs;
+};
+
+struct ExportManifestOutput_t
+{
+	uint64_t fileSize;
+	int64_t writeTime;		// last write time of the file when it was recorded, a change means the file was edited or replaced
+	uint32_t pathOffset;	// offset relative to stringTableOffset
+};
+#pragma pack(pop)
+
+// what an asset's export depends on, taken before exporting it
+struct ExportManifestStamp_t
+{
+	uint64_t guid;
+	uint32_t assetType;
+	int exportSetting;
+
+	uint64_t sourceHash;	// container identity (pak crc and patches, or file size and write time) and the asset name, and the containers of dependencies in other paks
+	uint64_t settingsHash;	// export directory and the g_ExportSettings fields the asset's exporter reads
+};
+
+struct ExportManifestStats_t
+{
+	uint64_t skipped;
+	uint64_t exported;
+	uint64_t entries;
+	int64_t savedNs;
+};
+
+// record of every asset exported, the files it wrote and what they were exported from
+// an asset is up to date when its source, exporter and settings are unchanged and every file it wrote is still the size and write time it was left at
+// files written by more than one asset (material textures, shared dependency files) are stored once, whichever export wrote one last sets its state
+class CExportManifest
+{
+public:
+	static void StampAsset(CAsset* const asset, const int exportSetting, ExportManifestStamp_t& stamp);
+
+	bool SaveToFile(const std::string& path);
+	bool LoadFromFile(const std::string& path);
+
+	// true if the asset's last export can be kept as it is
+	const bool IsUpToDate(const ExportManifestStamp_t& stamp);
+
+	// records a successful export and the files it wrote, an export that wrote nothing that can be checked later is not recorded
+	void Add(const ExportManifestStamp_t& stamp, const std::vector<std::string>& files, const int64_t exportTimeNs);
+
+	// forgets an asset, for exports that failed
+	void Remove(const ExportManifestStamp_t& stamp);
+
+	const ExportManifestStats_t GetStats() const;
+
+	void Clear()
+	{
+		std::lock_guard lock(m_manifestMutex);
+
+		m_entries.clear();
+		m_outputs.clear();
+		m_dirty = true;
+	}
+
+private:
+	struct Entry_t
+	{
+		uint64_t guid;
+		uint32_t assetType;
+		int exportSetting;
+
+		uint64_t sourceHash;
+		uint64_t settingsHash;
+
+		int64_t exportTimeNs;
+
+		std::vector<std::string> outputs; // keys into m_outputs
+	};
+
+	struct Output_t
+	{
+		uint64_t fileSize;
+		int64_t writeTime;
+	};
+
+	static const uint64_t EntryKey(const uint64_t guid, const uint32_t assetType);
+	static const bool GetFileState(const std::filesystem::path& path, uint64_t& fileSize, int64_t& writeTime);
+
+	std::unordered_map<uint64_t, Entry_t> m_entries; // by EntryKey
+	std::unordered_map<std::string, Output_t> m_outputs; // by absolute path
+	bool m_dirty = false; // entries changed since the last save
+
+	std::atomic<uint64_t> m_skipped = 0ull;
+	std::atomic<uint64_t> m_exported = 0ull;
+	std::atomic<int64_t> m_savedNs = 0ll;
+
+	mutable std::mutex m_manifestMutex;
+};
+
+extern CExportManifest g_exportManifest;
@@ -0,0 +1,292 @@
+#include <pch.h>
+#include <core/cache/fingerprintindex.h>
+
+#include <thirdparty/zstd/common/xxhash.h>
+
+CAssetFingerprintIndex g_assetFingerprintIndex;
+
+template <typename T>
+static const uint64_t HashValue(const T& value, const uint64_t seed)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	return XXH64(&value, sizeof(T), seed);
+}
+
+// a missing file hashes differently from any size, so a starpak that is gone invalidates the entry as well
+const uint64_t CAssetFingerprintIndex::HashFileStates(const std::vector<std::string>& files)
+{
+	uint64_t hash = HashValue(files.size(), 0ull);
+
+	for (const std::string& file : files)
+	{
+		hash = XXH64(file.data(), file.length(), hash);
+
+		std::error_code ec;
+		const uint64_t fileSize = std::filesystem::file_size(file, ec);
+		if (ec)
+		{
+			hash = HashValue(UINT64_MAX, hash);
+			continue;
+		}
+
+		const int64_t writeTime = static_cast<int64_t>(std::filesystem::last_write_time(file, ec).time_since_epoch().count());
+
+		hash = HashValue(fileSize, hash);
+		hash = HashValue(ec ? 0ll : writeTime, hash);
+	}
+
+	return hash;
+}
+
+bool CAssetFingerprintIndex::SaveToFile(const std::string& path)
+{
+	std::lock_guard lock(m_indexMutex);
+
+	// nothing new, keep the file as it is
+	if (!m_dirty && std::filesystem::exists(path))
+		return true;
+
+	FingerprintIndexHeader_t header = {};
+
+	header.fileVersion = FINGERPRINT_INDEX_FILE_VERSION;
+	header.numEntries = static_cast<uint32_t>(m_entries.size());
+
+	for (auto& it : m_entries)
+	{
+		header.numSourceFiles += static_cast<uint32_t>(it.second.sourceFiles.size());
+		header.numAssets += static_cast<uint32_t>(it.second.assets.size());
+	}
+
+	StreamIO indexFile;
+	if (!indexFile.open(path, eStreamIOMode::Write))
+		return false;
+
+	indexFile.write(header);
+
+	// strings are written in the same order they are referenced below
+	uint64_t nextStringOffset = 0;
+	uint32_t nextSourceFile = 0u;
+	uint32_t nextAsset = 0u;
+	for (auto& it : m_entries)
+	{
+		FingerprintIndexEntry_t entry = {};
+		entry.stateHash = it.second.stateHash;
+		entry.pathOffset = static_cast<uint32_t>(nextStringOffset);
+		entry.firstSourceFile = nextSourceFile;
+		entry.numSourceFiles = static_cast<uint32_t>(it.second.sourceFiles.size());
+		entry.firstAsset = nextAsset;
+		entry.numAssets = static_cast<uint32_t>(it.second.assets.size());
+
+		nextStringOffset += it.first.length() + 1;
+		nextSourceFile += entry.numSourceFiles;
+		nextAsset += entry.numAssets;
+
+		indexFile.write(entry);
+	}
+
+	for (auto& it : m_entries)
+	{
+		for (const std::string& sourceFile : it.second.sourceFiles)
+		{
+			indexFile.write(static_cast<uint32_t>(nextStringOffset));
+			nextStringOffset += sourceFile.length() + 1;
+		}
+	}
+
+	for (auto& it : m_entries)
+	{
+		for (const AssetFingerprint_t& fingerprint : it.second.assets)
+		{
+			FingerprintIndexAsset_t asset = {};
+			asset.guid = fingerprint.guid;
+			asset.fingerprint = fingerprint.fingerprint;
+			asset.type = fingerprint.type;
+			asset.nameOffset = static_cast<uint32_t>(nextStringOffset);
+
+			nextStringOffset += fingerprint.name.length() + 1;
+
+			indexFile.write(asset);
+		}
+	}
+
+	header.stringTableOffset = indexFile.tell();
+
+	for (auto& it : m_entries)
+		indexFile.write(it.first.c_str(), it.first.length() + 1);
+
+	for (auto& it : m_entries)
+	{
+		for (const std::string& sourceFile : it.second.sourceFiles)
+			indexFile.write(sourceFile.c_str(), sourceFile.length() + 1);
+	}
+
+	for (auto& it : m_entries)
+	{
+		for (const AssetFingerprint_t& fingerprint : it.second.assets)
+			indexFile.write(fingerprint.name.c_str(), fingerprint.name.length() + 1);
+	}
+
+	indexFile.seek(0);
+	indexFile.write(header);
+	indexFile.close();
+
+	m_dirty = false;
+
+	return true;
+}
+
+bool CAssetFingerprintIndex::LoadFromFile(const std::string& path)
+{
+	if (!std::filesystem::exists(path))
+		return true;
+
+	StreamIO indexFile;
+	if (!indexFile.open(path, eStreamIOMode::Read))
+		return false;
+
+	const uint64_t indexFileSize = indexFile.size();
+	if (indexFileSize < sizeof(FingerprintIndexHeader_t))
+	{
+		LOG_WARN(CACHE, "FINGERPRINT INDEX: Failed to load fingerprint index file: \"%s\". File is truncated\n", path.c_str());
+		return false;
+	}
+
+	std::unique_ptr<char[]> fileData = std::make_unique<char[]>(indexFileSize);
+	indexFile.read(fileData.get(), indexFileSize);
+	indexFile.close();
+
+	const FingerprintIndexHeader_t* const header = reinterpret_cast<const FingerprintIndexHeader_t*>(fileData.get());
+
+	if (header->fileVersion != FINGERPRINT_INDEX_FILE_VERSION)
+	{
+		LOG_WARN(CACHE, "FINGERPRINT INDEX: Failed to load fingerprint index file: \"%s\". Invalid version\n", path.c_str());
+		return false;
+	}
+
+	const uint64_t tablesSize = sizeof(FingerprintIndexHeader_t) + (static_cast<uint64_t>(header->numEntries) * sizeof(FingerprintIndexEntry_t))
+		+ (static_cast<uint64_t>(header->numSourceFiles) * sizeof(uint32_t)) + (static_cast<uint64_t>(header->numAssets) * sizeof(FingerprintIndexAsset_t));
+
+	if (tablesSize > indexFileSize || header->stringTableOffset > indexFileSize)
+	{
+		LOG_WARN(CACHE, "FINGERPRINT INDEX: Failed to load fingerprint index file: \"%s\". File is truncated\n", path.c_str());
+		return false;
+	}
+
+	const FingerprintIndexEntry_t* const entries = reinterpret_cast<const FingerprintIndexEntry_t*>(&header[1]);
+	const uint32_t* const sourceFiles = reinterpret_cast<const uint32_t*>(&entries[header->numEntries]);
+	const FingerprintIndexAsset_t* const assets = reinterpret_cast<const FingerprintIndexAsset_t*>(&sourceFiles[header->numSourceFiles]);
+
+	// checked before anything is taken from the file
+	bool stringsValid = true;
+	for (uint32_t i = 0; i < header->numEntries && stringsValid; ++i)
+		stringsValid = header->GetString(entries[i].pathOffset, indexFileSize) != nullptr;
+
+	for (uint32_t i = 0; i < header->numSourceFiles && stringsValid; ++i)
+		stringsValid = header->GetString(sourceFiles[i], indexFileSize) != nullptr;
+
+	for (uint32_t i = 0; i < header->numAssets && stringsValid; ++i)
+		stringsValid = header->GetString(assets[i].nameOffset, indexFileSize) != nullptr;
+
+	if (!stringsValid)
+	{
+		LOG_WARN(CACHE, "FINGERPRINT INDEX: Failed to load fingerprint index file: \"%s\". String table is corrupt\n", path.c_str());
+		return false;
+	}
+
+	std::lock_guard lock(m_indexMutex);
+
+	m_entries.reserve(header->numEntries);
+	for (uint32_t i = 0; i < header->numEntries; ++i)
+	{
+		const FingerprintIndexEntry_t* const entry = &entries[i];
+
+		if (static_cast<uint64_t>(entry->firstSourceFile) + entry->numSourceFiles > header->numSourceFiles
+			|| static_cast<uint64_t>(entry->firstAsset) + entry->numAssets > header->numAssets)
+			continue;
+
+		Entry_t loaded{ entry->stateHash, {}, {} };
+
+		loaded.sourceFiles.reserve(entry->numSourceFiles);
+		for (uint32_t file = 0; file < entry->numSourceFiles; ++file)
+			loaded.sourceFiles.emplace_back(header->GetString(sourceFiles[entry->firstSourceFile + file]));
+
+		loaded.assets.reserve(entry->numAssets);
+		for (uint32_t idx = 0; idx < entry->numAssets; ++idx)
+		{
+			const FingerprintIndexAsset_t* const asset = &assets[entry->firstAsset + idx];
+			loaded.assets.emplace_back(AssetFingerprint_t{ asset->guid, asset->fingerprint, asset->type, header->GetString(asset->nameOffset) });
+		}
+
+		m_entries.insert_or_assign(header->GetString(entry->pathOffset), std::move(loaded));
+	}
+
+	return true;
+}
+
+const bool CAssetFingerprintIndex::Find(const std::string& inputPath, std::vector<AssetFingerprint_t>& assets)
+{
+	std::vector<std::string> sourceFiles;
+	uint64_t stateHash = 0ull;
+
+	{
+		std::lock_guard lock(m_indexMutex);
+
+		const auto it = m_entries.find(inputPath);
+		if (it == m_entries.end())
+		{
+			++m_misses;
+			return false;
+		}
+
+		sourceFiles = it->second.sourceFiles;
+		stateHash = it->second.stateHash;
+	}
+
+	// stat the files without holding the lock, an input usually has a handful of them
+	if (HashFileStates(sourceFiles) != stateHash)
+	{
+		++m_misses;
+		return false;
+	}
+
+	{
+		std::lock_guard lock(m_indexMutex);
+
+		const auto it = m_entries.find(inputPath);
+		if (it == m_entries.end() || it->second.stateHash != stateHash)
+		{
+			++m_misses;
+			return false;
+		}
+
+		assets = it->second.assets;
+	}
+
+	++m_hits;
+	return true;
+}
+
+void CAssetFingerprintIndex::Add(const std::string& inputPath, const std::vector<std::string>& sourceFiles, const std::vector<AssetFingerprint_t>& assets)
+{
+	Entry_t entry{ HashFileStates(sourceFiles), sourceFiles, assets };
+
+	std::lock_guard lock(m_indexMutex);
+
+	m_entries.insert_or_assign(inputPath, std::move(entry));
+	m_dirty = true;
+}
+
+void CAssetFingerprintIndex::Remove(const std::string& inputPath)
+{
+	std::lock_guard lock(m_indexMutex);
+
+	if (m_entries.erase(inputPath))
+		m_dirty = true;
+}
+
+const FingerprintIndexStats_t CAssetFingerprintIndex::GetStats() const
+{
+	std::lock_guard lock(m_indexMutex);
+
+	return { m_hits.load(), m_misses.load(), m_entries.size() };
+}
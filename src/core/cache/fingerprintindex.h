@@ -0,0 +1,114 @@
+#pragma once
+
+constexpr int FINGERPRINT_INDEX_FILE_VERSION = 2; // 2: pak fingerprints are taken before load functions run
+
+#pragma pack(push, 1)
+struct FingerprintIndexHeader_t
+{
+	uint32_t fileVersion;
+	uint32_t numEntries;		// entries immediately follow the header
+	uint32_t numSourceFiles;	// string offsets of every entry's source files, after the entries
+	uint32_t numAssets;			// after the source files
+
+	uint64_t stringTableOffset;
+
+	const char* GetString(uint64_t offset) const
+	{
+		return reinterpret_cast<const char*>(this) + stringTableOffset + offset;
+	}
+
+	// null if the string starts past the end of the file or isn't terminated before it
+	const char* GetString(uint64_t offset, uint64_t fileSize) const
+	{
+		if (offset >= fileSize || stringTableOffset + offset >= fileSize)
+			return nullptr;
+
+		const char* const str = GetString(offset);
+		return memchr(str, '\0', fileSize - (stringTableOffset + offset)) ? str : nullptr;
+	}
+};
+
+struct FingerprintIndexEntry_t
+{
+	uint64_t stateHash;		// sizes and write times of the source files when the fingerprints were taken
+	uint32_t pathOffset;	// offset relative to stringTableOffset
+
+	uint32_t firstSourceFile;
+	uint32_t numSourceFiles;
+
+	uint32_t firstAsset;
+	uint32_t numAssets;
+};
+
+struct FingerprintIndexAsset_t
+{
+	uint64_t guid;
+	uint64_t fingerprint;
+	uint32_t type;
+	uint32_t nameOffset;	// offset relative to stringTableOffset
+};
+#pragma pack(pop)
+
+struct AssetFingerprint_t
+{
+	uint64_t guid;
+	uint64_t fingerprint;	// hash of the asset's content, the same in two builds if the asset didn't change
+	uint32_t type;
+	std::string name;
+};
+
+struct FingerprintIndexStats_t
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t entries;
+};
+
+// persistent fingerprints of every asset in an input file, keyed by the file's path
+// an entry holds every file its fingerprints were read from (the input, patches, starpaks, stream files) and stays valid
+// while all of them keep the size and write time they had, so comparing against an old build doesn't mean loading it again
+class CAssetFingerprintIndex
+{
+public:
+	bool SaveToFile(const std::string& path);
+	bool LoadFromFile(const std::string& path);
+
+	// gets the fingerprints of the assets in an input file, false if there are none or a file they were read from changed since
+	const bool Find(const std::string& inputPath, std::vector<AssetFingerprint_t>& assets);
+
+	// sourceFiles are every file the fingerprints were read from
+	void Add(const std::string& inputPath, const std::vector<std::string>& sourceFiles, const std::vector<AssetFingerprint_t>& assets);
+
+	// forgets an input file, for files that won't be compared again
+	void Remove(const std::string& inputPath);
+
+	const FingerprintIndexStats_t GetStats() const;
+
+	void Clear()
+	{
+		std::lock_guard lock(m_indexMutex);
+
+		m_entries.clear();
+		m_dirty = true;
+	}
+
+private:
+	struct Entry_t
+	{
+		uint64_t stateHash;
+		std::vector<std::string> sourceFiles;
+		std::vector<AssetFingerprint_t> assets;
+	};
+
+	static const uint64_t HashFileStates(const std::vector<std::string>& files);
+
+	std::unordered_map<std::string, Entry_t> m_entries; // by absolute path of the input file
+	bool m_dirty = false; // entries changed since the last save
+
+	std::atomic<uint64_t> m_hits = 0ull;
+	std::atomic<uint64_t> m_misses = 0ull;
+
+	mutable std::mutex m_indexMutex;
+};
+
+extern CAssetFingerprintIndex g_assetFingerprintIndex;
@@ -0,0 +1,592 @@
+#include <pch.h>
+#include <core/cache/modelcache.h>
+
+#include <thirdparty/zstd/common/xxhash.h>
+
+CModelCache g_modelCache;
+
+// entries used this session are always kept, older ones are dropped once the file would grow past this
+static constexpr uint64_t s_modelCacheMaxSize = 4ull * 1024ull * 1024ull * 1024ull;
+
+//
+// ENTRY DATA
+// lods with their models and meshes, then bodyparts, then the noodles
+//
+#pragma pack(push, 1)
+struct ModelCacheData_t
+{
+	uint64_t hwDataSize;
+	uint32_t lodCount;
+	uint32_t bodyPartCount;
+	uint32_t noodleCount;
+};
+
+struct ModelCacheLOD_t
+{
+	uint64_t vertexCount;
+	uint64_t indexCount;
+	float switchPoint;
+	uint16_t texcoordsPerVert;
+	uint16_t weightsPerVert;
+	uint32_t modelCount;
+	uint32_t meshCount;
+};
+
+struct ModelCacheModel_t
+{
+	uint64_t meshIndex;
+	int64_t meshOffset; // index of the first mesh the model points at, -1 for none
+	uint32_t meshCount;
+	uint32_t vertCount;
+	uint32_t nameLength; // name follows
+};
+
+struct ModelCacheMesh_t
+{
+	uint64_t meshVertexDataIndex;
+	uint64_t rawVertexLayoutFlags;
+	uint32_t indexCount;
+	uint32_t vertCount;
+	uint16_t vertCacheSize;
+	uint16_t weightsPerVert;
+	uint32_t weightsCount;
+	int16_t texcoordCount;
+	int16_t texcoodIndices;
+	int materialId;
+	int bodyPartIndex;
+};
+
+struct ModelCacheBodyPart_t
+{
+	int modelIndex;
+	int numModels;
+	uint32_t nameLength; // name follows
+};
+
+struct ModelCacheNoodle_t
+{
+	uint64_t compressedSize; // compressed data follows
+	uint64_t decompressedSize;
+	eRamenCodec codec;
+};
+#pragma pack(pop)
+
+class CModelCacheWriter
+{
+public:
+	CModelCacheWriter(std::vector<char>& out) : m_out(out) {};
+
+	template <typename T>
+	void Write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		WriteBytes(&value, sizeof(T));
+	}
+
+	void WriteBytes(const void* const data, const size_t size)
+	{
+		const char* const bytes = reinterpret_cast<const char*>(data);
+		m_out.insert(m_out.end(), bytes, bytes + size);
+	}
+
+private:
+	std::vector<char>& m_out;
+};
+
+// every read is bounds checked, a damaged entry is a miss instead of a crash
+class CModelCacheReader
+{
+public:
+	CModelCacheReader(const char* const data, const uint64_t size) : m_cur(data), m_end(data + size) {};
+
+	template <typename T>
+	const bool Read(T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		const char* const bytes = ReadBytes(sizeof(T));
+		if (!bytes)
+			return false;
+
+		memcpy(&value, bytes, sizeof(T));
+		return true;
+	}
+
+	const char* ReadBytes(const uint64_t size)
+	{
+		if (size > static_cast<uint64_t>(m_end - m_cur))
+			return nullptr;
+
+		const char* const bytes = m_cur;
+		m_cur += size;
+
+		return bytes;
+	}
+
+	inline const bool AtEnd() const { return m_cur == m_end; };
+
+private:
+	const char* m_cur;
+	const char* const m_end;
+};
+
+static const bool SerializeModelCacheData(std::vector<char>& out, ModelParsedData_t* const parsedData)
+{
+	CModelCacheWriter writer(out);
+
+	writer.Write(ModelCacheData_t{ parsedData->studiohdr.hwDataSize, static_cast<uint32_t>(parsedData->lods.size()), static_cast<uint32_t>(parsedData->bodyParts.size()), static_cast<uint32_t>(parsedData->meshVertexData.size()) });
+
+	for (const ModelLODData_t& lod : parsedData->lods)
+	{
+		writer.Write(ModelCacheLOD_t{ lod.vertexCount, lod.indexCount, lod.switchPoint, lod.texcoordsPerVert, lod.weightsPerVert, static_cast<uint32_t>(lod.models.size()), static_cast<uint32_t>(lod.meshes.size()) });
+
+		for (const ModelModelData_t& model : lod.models)
+		{
+			const int64_t meshOffset = model.meshes ? static_cast<int64_t>(model.meshes - lod.meshes.data()) : -1ll;
+
+			writer.Write(ModelCacheModel_t{ model.meshIndex, meshOffset, model.meshCount, model.vertCount, static_cast<uint32_t>(model.name.length()) });
+			writer.WriteBytes(model.name.data(), model.name.length());
+		}
+
+		for (const ModelMeshData_t& mesh : lod.meshes)
+		{
+			writer.Write(ModelCacheMesh_t{ mesh.meshVertexDataIndex, mesh.rawVertexLayoutFlags, mesh.indexCount, mesh.vertCount, mesh.vertCacheSize, mesh.weightsPerVert, mesh.weightsCount,
+				mesh.texcoordCount, mesh.texcoodIndices, mesh.materialId, mesh.bodyPartIndex });
+		}
+	}
+
+	for (const ModelBodyPart_t& part : parsedData->bodyParts)
+	{
+		writer.Write(ModelCacheBodyPart_t{ part.modelIndex, part.numModels, static_cast<uint32_t>(part.partName.length()) });
+		writer.WriteBytes(part.partName.data(), part.partName.length());
+	}
+
+	// noodles are stored as they were compressed, restoring them doesn't compress anything again
+	for (size_t i = 0; i < parsedData->meshVertexData.size(); i++)
+	{
+		const CRamen::CNoodle* const noodle = parsedData->meshVertexData.begin()[i];
+		const std::unique_ptr<char[]> compressed = parsedData->meshVertexData.getCompressedIdx(i);
+
+		if (!compressed)
+			return false;
+
+		writer.Write(ModelCacheNoodle_t{ noodle->compressedSize, noodle->decompressedSize, noodle->codec });
+		writer.WriteBytes(compressed.get(), noodle->compressedSize);
+	}
+
+	return true;
+}
+
+static const bool DeserializeModelCacheData(const char* const data, const uint64_t size, ModelParsedData_t* const parsedData)
+{
+	CModelCacheReader reader(data, size);
+
+	ModelCacheData_t header = {};
+	if (!reader.Read(header))
+		return false;
+
+	// counts that can't fit in the entry, don't allocate for them
+	if (header.lodCount > size / sizeof(ModelCacheLOD_t) || header.bodyPartCount > size / sizeof(ModelCacheBodyPart_t) || header.noodleCount > size / sizeof(ModelCacheNoodle_t))
+		return false;
+
+	std::vector<ModelLODData_t> lods(header.lodCount);
+	for (ModelLODData_t& lod : lods)
+	{
+		ModelCacheLOD_t lodHeader = {};
+		if (!reader.Read(lodHeader))
+			return false;
+
+		if (lodHeader.modelCount > size / sizeof(ModelCacheModel_t) || lodHeader.meshCount > size / sizeof(ModelCacheMesh_t))
+			return false;
+
+		lod.vertexCount = lodHeader.vertexCount;
+		lod.indexCount = lodHeader.indexCount;
+		lod.switchPoint = lodHeader.switchPoint;
+		lod.texcoordsPerVert = lodHeader.texcoordsPerVert;
+		lod.weightsPerVert = lodHeader.weightsPerVert;
+
+		lod.models.resize(lodHeader.modelCount);
+		lod.meshes.resize(lodHeader.meshCount);
+
+		for (ModelModelData_t& model : lod.models)
+		{
+			ModelCacheModel_t modelHeader = {};
+			if (!reader.Read(modelHeader))
+				return false;
+
+			const char* const name = reader.ReadBytes(modelHeader.nameLength);
+			if (!name)
+				return false;
+
+			if (modelHeader.meshOffset >= static_cast<int64_t>(lodHeader.meshCount))
+				return false;
+
+			model.name.assign(name, modelHeader.nameLength);
+			model.meshIndex = static_cast<size_t>(modelHeader.meshIndex);
+			model.meshCount = modelHeader.meshCount;
+			model.vertCount = modelHeader.vertCount;
+			model.meshes = modelHeader.meshOffset >= 0ll ? &lod.meshes.at(static_cast<size_t>(modelHeader.meshOffset)) : nullptr;
+		}
+
+		for (ModelMeshData_t& mesh : lod.meshes)
+		{
+			ModelCacheMesh_t meshHeader = {};
+			if (!reader.Read(meshHeader))
+				return false;
+
+			if (meshHeader.meshVertexDataIndex != invalidNoodleIdx && meshHeader.meshVertexDataIndex >= header.noodleCount)
+				return false;
+
+			mesh.meshVertexDataIndex = static_cast<size_t>(meshHeader.meshVertexDataIndex);
+			mesh.rawVertexLayoutFlags = meshHeader.rawVertexLayoutFlags;
+			mesh.indexCount = meshHeader.indexCount;
+			mesh.vertCount = meshHeader.vertCount;
+			mesh.vertCacheSize = meshHeader.vertCacheSize;
+			mesh.weightsPerVert = meshHeader.weightsPerVert;
+			mesh.weightsCount = meshHeader.weightsCount;
+			mesh.texcoordCount = meshHeader.texcoordCount;
+			mesh.texcoodIndices = meshHeader.texcoodIndices;
+			mesh.bodyPartIndex = meshHeader.bodyPartIndex;
+
+			// parsed meshes are the ones with vertex data, the material asset is looked up again as it's a pointer for this session
+			if (mesh.meshVertexDataIndex != invalidNoodleIdx)
+			{
+				if (meshHeader.materialId < 0 || meshHeader.materialId >= static_cast<int>(parsedData->materials.size()))
+					return false;
+
+				mesh.ParseMaterial(parsedData, meshHeader.materialId);
+			}
+			else
+			{
+				mesh.materialId = meshHeader.materialId;
+			}
+		}
+	}
+
+	std::vector<ModelBodyPart_t> bodyParts(header.bodyPartCount);
+	for (ModelBodyPart_t& part : bodyParts)
+	{
+		ModelCacheBodyPart_t partHeader = {};
+		if (!reader.Read(partHeader))
+			return false;
+
+		const char* const name = reader.ReadBytes(partHeader.nameLength);
+		if (!name)
+			return false;
+
+		part.partName.assign(name, partHeader.nameLength);
+		part.modelIndex = partHeader.modelIndex;
+		part.numModels = partHeader.numModels;
+	}
+
+	CRamen meshVertexData(header.noodleCount);
+	for (uint32_t i = 0; i < header.noodleCount; i++)
+	{
+		ModelCacheNoodle_t noodleHeader = {};
+		if (!reader.Read(noodleHeader) || noodleHeader.codec >= eRamenCodec::_COUNT)
+			return false;
+
+		const char* const compressed = reader.ReadBytes(noodleHeader.compressedSize);
+		if (!compressed)
+			return false;
+
+		char* const buf = new char[noodleHeader.compressedSize];
+		memcpy(buf, compressed, noodleHeader.compressedSize);
+
+		meshVertexData.addCompressed(buf, noodleHeader.compressedSize, noodleHeader.decompressedSize, noodleHeader.codec);
+	}
+
+	if (!reader.AtEnd())
+		return false;
+
+	// vectors keep their buffers when swapped, so the model mesh pointers stay valid
+	parsedData->studiohdr.hwDataSize = header.hwDataSize;
+	parsedData->lods.swap(lods);
+	parsedData->bodyParts.swap(bodyParts);
+	parsedData->meshVertexData.move(meshVertexData);
+
+	return true;
+}
+
+//
+// CACHE
+//
+const uint64_t CModelCache::HashData(const void* const data, const size_t size, const uint64_t seed)
+{
+	return XXH64(data, size, seed);
+}
+
+bool CModelCache::SaveToFile(const std::string& path)
+{
+	std::lock_guard lock(m_cacheMutex);
+
+	LOG_INFO(CACHE, "MDL CACHE: %llu models restored, %llu parsed this session\n", m_hits.load(), m_misses.load());
+
+	// nothing new, keep the file as it is
+	if (!m_dirty && std::filesystem::exists(path))
+		return true;
+
+	// entries from this session first, older ones while there is room
+	std::vector<std::pair<uint64_t, const Entry_t*>> entries;
+	entries.reserve(m_entries.size());
+
+	for (const bool used : { true, false })
+	{
+		for (const auto& it : m_entries)
+		{
+			if (it.second.used == used)
+				entries.emplace_back(it.first, &it.second);
+		}
+	}
+
+	const std::string tempPath = path + ".tmp";
+
+	StreamIO cacheFile;
+	if (!cacheFile.open(tempPath, eStreamIOMode::Write))
+		return false;
+
+	ModelCacheHeader_t header = {};
+	header.fileVersion = MODEL_CACHE_FILE_VERSION;
+
+	std::vector<ModelCacheMapping_t> mappings;
+	mappings.reserve(entries.size());
+
+	uint64_t dataOffset = sizeof(ModelCacheHeader_t) + (entries.size() * sizeof(ModelCacheMapping_t));
+	for (const auto& it : entries)
+	{
+		if (!it.second->used && dataOffset + it.second->size > s_modelCacheMaxSize)
+			break;
+
+		mappings.push_back({ it.first, it.second->contentHash, it.second->dataHash, dataOffset, it.second->size });
+		dataOffset += it.second->size;
+	}
+
+	header.numEntries = static_cast<uint32_t>(mappings.size());
+
+	// the mapping table is sized for every entry, dropped entries leave it partly unused
+	cacheFile.write(header);
+	cacheFile.seek(sizeof(ModelCacheHeader_t) + (entries.size() * sizeof(ModelCacheMapping_t)));
+
+	std::vector<char> sessionData;
+	for (size_t i = 0; i < mappings.size(); i++)
+	{
+		const Entry_t* const entry = entries.at(i).second;
+
+		if (entry->data)
+		{
+			cacheFile.write(entry->data, entry->size);
+			continue;
+		}
+
+		if (!ReadSessionEntry(*entry, sessionData))
+		{
+			LOG_ERROR(CACHE, "MDL CACHE: Failed to read model cache session file: \"%s\"\n", m_sessionPath.c_str());
+			cacheFile.close();
+
+			std::error_code ec;
+			std::filesystem::remove(tempPath, ec);
+
+			return false;
+		}
+
+		cacheFile.write(sessionData.data(), sessionData.size());
+	}
+
+	cacheFile.seek(sizeof(ModelCacheHeader_t));
+	for (const ModelCacheMapping_t& mapping : mappings)
+	{
+		cacheFile.write(mapping);
+	}
+
+	cacheFile.close();
+
+	// the old file can't be replaced while it's mapped
+	m_file.Close();
+	m_entries.clear();
+
+	std::error_code ec;
+
+	// everything in the session file is in the new cache file now
+	m_sessionFile.close();
+	m_sessionSize = 0ull;
+	std::filesystem::remove(m_sessionPath, ec);
+
+	std::filesystem::rename(tempPath, path, ec);
+	if (ec)
+	{
+		LOG_ERROR(CACHE, "MDL CACHE: Failed to replace model cache file: \"%s\". %s\n", path.c_str(), ec.message().c_str());
+		std::filesystem::remove(tempPath, ec);
+
+		return false;
+	}
+
+	m_dirty = false;
+
+	return true;
+}
+
+bool CModelCache::LoadFromFile(const std::string& path)
+{
+	std::lock_guard lock(m_cacheMutex);
+
+	m_sessionPath = path + ".session";
+
+	if (!std::filesystem::exists(path))
+		return true;
+
+	if (!m_file.Open(path))
+	{
+		LOG_ERROR(CACHE, "MDL CACHE: Failed to map model cache file: \"%s\"\n", path.c_str());
+		return false;
+	}
+
+	const uint64_t cacheFileSize = m_file.Size();
+	if (cacheFileSize < sizeof(ModelCacheHeader_t))
+	{
+		LOG_WARN(CACHE, "MDL CACHE: Failed to load model cache file: \"%s\". File is truncated\n", path.c_str());
+		m_file.Close();
+
+		return false;
+	}
+
+	const ModelCacheHeader_t* const header = reinterpret_cast<const ModelCacheHeader_t*>(m_file.Data());
+
+	if (header->fileVersion != MODEL_CACHE_FILE_VERSION)
+	{
+		LOG_WARN(CACHE, "MDL CACHE: Failed to load model cache file: \"%s\". Invalid version\n", path.c_str());
+		m_file.Close();
+
+		return false;
+	}
+
+	if (sizeof(ModelCacheHeader_t) + (header->numEntries * sizeof(ModelCacheMapping_t)) > cacheFileSize)
+	{
+		LOG_WARN(CACHE, "MDL CACHE: Failed to load model cache file: \"%s\". File is truncated\n", path.c_str());
+		m_file.Close();
+
+		return false;
+	}
+
+	const ModelCacheMapping_t* const mappings = reinterpret_cast<const ModelCacheMapping_t*>(&header[1]);
+
+	// only the table is read here, entry data stays on disk until a model asks for it
+	m_entries.reserve(header->numEntries);
+	for (uint32_t i = 0; i < header->numEntries; ++i)
+	{
+		const ModelCacheMapping_t* const mapping = &mappings[i];
+
+		if (mapping->dataOffset > cacheFileSize || mapping->dataSize > cacheFileSize - mapping->dataOffset)
+			continue;
+
+		m_entries.emplace(mapping->guid, Entry_t{ mapping->contentHash, mapping->dataHash, m_file.Data() + mapping->dataOffset, mapping->dataSize, 0ull, false });
+	}
+
+	return true;
+}
+
+const bool CModelCache::ReadSessionEntry(const Entry_t& entry, std::vector<char>& out)
+{
+	out.resize(entry.size);
+
+	m_sessionFile.seekg(static_cast<std::streamoff>(entry.sessionOffset));
+	m_sessionFile.read(out.data(), static_cast<std::streamsize>(entry.size));
+
+	if (!m_sessionFile || static_cast<uint64_t>(m_sessionFile.gcount()) != entry.size)
+	{
+		m_sessionFile.clear();
+		return false;
+	}
+
+	return true;
+}
+
+const bool CModelCache::Restore(const uint64_t guid, const uint64_t contentHash, ModelParsedData_t* const parsedData)
+{
+	Entry_t entry = {};
+	std::vector<char> sessionData; // a model parsed earlier this session and loaded again
+
+	{
+		std::lock_guard lock(m_cacheMutex);
+
+		const auto it = m_entries.find(guid);
+		if (it == m_entries.end() || it->second.contentHash != contentHash)
+		{
+			++m_misses;
+			return false;
+		}
+
+		it->second.used = true;
+		entry = it->second;
+
+		if (!entry.data)
+		{
+			if (!ReadSessionEntry(entry, sessionData))
+			{
+				m_entries.erase(guid);
+
+				++m_misses;
+				return false;
+			}
+
+			entry.data = sessionData.data();
+		}
+	}
+
+	PROFILE_SCOPE("model cache restore");
+
+	// the counts and sizes are checked while reading, the noodles are only checked by the hash as they stay compressed until used
+	if (HashData(entry.data, entry.size, 0ull) != entry.dataHash || !DeserializeModelCacheData(entry.data, entry.size, parsedData))
+	{
+		LOG_WARN(CACHE, "MDL CACHE: Entry for model 0x%llX is damaged, parsing it again\n", guid);
+
+		std::lock_guard lock(m_cacheMutex);
+		m_entries.erase(guid);
+		m_dirty = true;
+
+		++m_misses;
+		return false;
+	}
+
+	++m_hits;
+	return true;
+}
+
+void CModelCache::Add(const uint64_t guid, const uint64_t contentHash, ModelParsedData_t* const parsedData)
+{
+	std::vector<char> data;
+	if (!SerializeModelCacheData(data, parsedData))
+		return;
+
+	std::lock_guard lock(m_cacheMutex);
+
+	// no cache file to go with it
+	if (m_sessionPath.empty())
+		return;
+
+	if (!m_sessionFile.is_open())
+	{
+		m_sessionFile.open(m_sessionPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		m_sessionSize = 0ull;
+
+		if (!m_sessionFile.is_open())
+		{
+			LOG_WARN(CACHE, "MDL CACHE: Failed to open model cache session file: \"%s\", models parsed this session won't be cached\n", m_sessionPath.c_str());
+			m_sessionPath.clear();
+
+			return;
+		}
+	}
+
+	m_sessionFile.seekp(static_cast<std::streamoff>(m_sessionSize));
+	m_sessionFile.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+	if (!m_sessionFile)
+	{
+		m_sessionFile.clear();
+		return;
+	}
+
+	m_entries.insert_or_assign(guid, Entry_t{ contentHash, HashData(data.data(), data.size(), 0ull), nullptr, data.size(), m_sessionSize, true });
+	m_sessionSize += data.size();
+	m_dirty = true;
+}
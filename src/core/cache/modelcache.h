@@ -0,0 +1,78 @@
+#pragma once
+#include <core/mdl/modeldata.h>
+
+// bump when the vertex parsing output changes, old caches are dropped on load
+constexpr int MODEL_CACHE_FILE_VERSION = 2;
+
+#pragma pack(push, 1)
+struct ModelCacheHeader_t
+{
+	uint32_t fileVersion;
+	uint32_t numEntries; // entries immediately follow the header
+};
+
+struct ModelCacheMapping_t
+{
+	uint64_t guid;
+	uint64_t contentHash;	// hash of the studio data and vertex data the entry was parsed from
+	uint64_t dataHash;		// hash of the entry data itself, an entry damaged on disk is parsed again
+	uint64_t dataOffset;	// offset from the start of the file
+	uint64_t dataSize;
+};
+#pragma pack(pop)
+
+// persistent cache of parsed model vertex data
+// parsing decodes every mesh and compresses it into noodles, the cache keeps the noodles as they were compressed along with the
+// lod, model, mesh and bodypart data so a model whose source data is unchanged skips all of that on the next load
+// the file stays mapped for the session, entries are only read when a model is loaded
+// models parsed this session are appended to a session file next to it, nothing parsed is held in memory until the save
+class CModelCache
+{
+public:
+	// chain calls to build a key, seed with 0 for the first call
+	static const uint64_t HashData(const void* const data, const size_t size, const uint64_t seed);
+
+	bool SaveToFile(const std::string& path);
+	bool LoadFromFile(const std::string& path);
+
+	// fills the lods, bodyparts and mesh vertex data of parsedData from the cache
+	// returns false if there is no entry for this guid, it was parsed from different data or it is damaged, parsedData is untouched then
+	const bool Restore(const uint64_t guid, const uint64_t contentHash, ModelParsedData_t* const parsedData);
+
+	// stores freshly parsed vertex data, the entry is written straight to the session file instead of being held until the save
+	void Add(const uint64_t guid, const uint64_t contentHash, ModelParsedData_t* const parsedData);
+
+	inline const uint64_t GetHits() const { return m_hits; };
+	inline const uint64_t GetMisses() const { return m_misses; };
+
+private:
+	struct Entry_t
+	{
+		uint64_t contentHash;
+		uint64_t dataHash;
+		const char* data; // into the mapped file, null for entries added this session
+		uint64_t size;
+		uint64_t sessionOffset; // where an entry added this session is in the session file
+		bool used; // restored or added this session, kept first when the file is over the size limit
+	};
+
+	// reads an entry added this session back from the session file, m_cacheMutex must be held
+	const bool ReadSessionEntry(const Entry_t& entry, std::vector<char>& out);
+
+	CMappedFile m_file;
+
+	// entries added this session are appended here and copied into the cache file when it's saved
+	std::string m_sessionPath;
+	std::fstream m_sessionFile;
+	uint64_t m_sessionSize = 0ull;
+
+	std::unordered_map<uint64_t, Entry_t> m_entries;
+	bool m_dirty = false; // entries changed since the last save
+
+	std::atomic<uint64_t> m_hits = 0ull;
+	std::atomic<uint64_t> m_misses = 0ull;
+
+	mutable std::mutex m_cacheMutex;
+};
+
+extern CModelCache g_modelCache;
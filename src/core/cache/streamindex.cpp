@@ -0,0 +1,160 @@
+#include <pch.h>
+#include <core/cache/streamindex.h>
+
+CMilesStreamIndex g_milesStreamIndex;
+
+bool CMilesStreamIndex::SaveToFile(const std::string& path)
+{
+	std::lock_guard lock(m_indexMutex);
+
+	// nothing new, keep the file as it is
+	if (!m_dirty && std::filesystem::exists(path))
+		return true;
+
+	MilesStreamIndexHeader_t header = {};
+
+	header.fileVersion = MILES_STREAM_INDEX_FILE_VERSION;
+	header.numEntries = static_cast<uint32_t>(m_entries.size());
+
+	StreamIO indexFile;
+	if (!indexFile.open(path, eStreamIOMode::Write))
+		return false;
+
+	indexFile.write(header);
+
+	uint64_t nextStringOffset = 0;
+	for (auto& it : m_entries)
+	{
+		MilesStreamIndexMapping_t mapping = {};
+		mapping.fileSize = it.second.fileSize;
+		mapping.writeTime = it.second.writeTime;
+		mapping.header = it.second.header;
+		mapping.pathOffset = static_cast<uint32_t>(nextStringOffset);
+
+		nextStringOffset += it.first.length() + 1;
+
+		indexFile.write(mapping);
+	}
+
+	header.stringTableOffset = indexFile.tell();
+
+	for (auto& it : m_entries)
+	{
+		indexFile.write(it.first.c_str(), it.first.length() + 1);
+	}
+
+	indexFile.seek(0);
+	indexFile.write(header);
+	indexFile.close();
+
+	m_dirty = false;
+
+	return true;
+}
+
+bool CMilesStreamIndex::LoadFromFile(const std::string& path)
+{
+	if (!std::filesystem::exists(path))
+		return true;
+
+	StreamIO indexFile;
+	if (!indexFile.open(path, eStreamIOMode::Read))
+		return false;
+
+	const uint64_t indexFileSize = indexFile.size();
+	if (indexFileSize < sizeof(MilesStreamIndexHeader_t))
+	{
+		LOG_WARN(CACHE, "MSTR INDEX: Failed to load stream index file: \"%s\". File is truncated\n", path.c_str());
+		return false;
+	}
+
+	std::unique_ptr<char[]> fileData = std::make_unique<char[]>(indexFileSize);
+	indexFile.read(fileData.get(), indexFileSize);
+	indexFile.close();
+
+	const MilesStreamIndexHeader_t* const header = reinterpret_cast<const MilesStreamIndexHeader_t*>(fileData.get());
+
+	if (header->fileVersion != MILES_STREAM_INDEX_FILE_VERSION)
+	{
+		LOG_WARN(CACHE, "MSTR INDEX: Failed to load stream index file: \"%s\". Invalid version\n", path.c_str());
+		return false;
+	}
+
+	if (sizeof(MilesStreamIndexHeader_t) + (header->numEntries * sizeof(MilesStreamIndexMapping_t)) > indexFileSize || header->stringTableOffset > indexFileSize)
+	{
+		LOG_WARN(CACHE, "MSTR INDEX: Failed to load stream index file: \"%s\". File is truncated\n", path.c_str());
+		return false;
+	}
+
+	const MilesStreamIndexMapping_t* const mappings = reinterpret_cast<const MilesStreamIndexMapping_t*>(&header[1]);
+
+	// check every path before taking any entry, a damaged file is dropped as a whole
+	for (uint32_t i = 0; i < header->numEntries; ++i)
+	{
+		if (!header->GetString(mappings[i].pathOffset, indexFileSize))
+		{
+			LOG_WARN(CACHE, "MSTR INDEX: Failed to load stream index file: \"%s\". String table is corrupt\n", path.c_str());
+			return false;
+		}
+	}
+
+	std::lock_guard lock(m_indexMutex);
+
+	m_entries.reserve(header->numEntries);
+	for (uint32_t i = 0; i < header->numEntries; ++i)
+	{
+		const MilesStreamIndexMapping_t* const mapping = &mappings[i];
+
+		m_entries.emplace(header->GetString(mapping->pathOffset), Entry_t{ mapping->fileSize, mapping->writeTime, mapping->header });
+	}
+
+	return true;
+}
+
+const bool CMilesStreamIndex::GetHeader(const std::filesystem::directory_entry& file, MilesStreamHeader_t& header)
+{
+	std::error_code ec;
+
+	// the directory scan already has these, no need to touch the file
+	const uint64_t fileSize = file.file_size(ec);
+	if (ec)
+		return false;
+
+	const int64_t writeTime = static_cast<int64_t>(file.last_write_time(ec).time_since_epoch().count());
+	if (ec)
+		return false;
+
+	const std::string path = std::filesystem::absolute(file.path()).string();
+
+	{
+		std::lock_guard lock(m_indexMutex);
+
+		const auto it = m_entries.find(path);
+		if (it != m_entries.end() && it->second.fileSize == fileSize && it->second.writeTime == writeTime)
+		{
+			header = it->second.header;
+			++m_hits;
+
+			return true;
+		}
+	}
+
+	++m_misses;
+
+	if (fileSize < sizeof(MilesStreamHeader_t))
+		return false;
+
+	StreamIO stream;
+	if (!stream.open(file.path().string(), eStreamIOMode::Read))
+		return false;
+
+	header = stream.read<MilesStreamHeader_t>();
+	stream.close();
+
+	std::lock_guard lock(m_indexMutex);
+
+	m_entries.insert_or_assign(path, Entry_t{ fileSize, writeTime, header });
+	m_dirty = true;
+
+	return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <game/audio/miles.h>
+
+constexpr int MILES_STREAM_INDEX_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct MilesStreamIndexHeader_t
+{
+	uint32_t fileVersion;
+	uint32_t numEntries; // entries immediately follow the header
+
+	uint64_t stringTableOffset;
+
+	const char* GetString(uint64_t offset) const
+	{
+		return reinterpret_cast<const char*>(this) + stringTableOffset + offset;
+	}
+
+	// null if the string starts past the end of the file or isn't terminated before it
+	const char* GetString(uint64_t offset, uint64_t fileSize) const
+	{
+		if (offset >= fileSize || stringTableOffset + offset >= fileSize)
+			return nullptr;
+
+		const char* const str = GetString(offset);
+		return memchr(str, '\0', fileSize - (stringTableOffset + offset)) ? str : nullptr;
+	}
+};
+
+struct MilesStreamIndexMapping_t
+{
+	uint64_t fileSize;
+	int64_t writeTime;		// last write time of the stream file when its header was read
+	MilesStreamHeader_t header;
+	uint32_t pathOffset;	// offset relative to stringTableOffset
+};
+#pragma pack(pop)
+
+// persistent index of miles stream file headers
+// banks scan every .mstr next to them on load, the index keeps each file's header keyed by its path so a file
+// that still has the same size and write time doesn't have to be opened again
+class CMilesStreamIndex
+{
+public:
+	bool SaveToFile(const std::string& path);
+	bool LoadFromFile(const std::string& path);
+
+	// gets the header of the stream file, from the index if the file is unchanged
+	// returns false if the file is too small to hold a header
+	const bool GetHeader(const std::filesystem::directory_entry& file, MilesStreamHeader_t& header);
+
+	inline const uint64_t GetHits() const { return m_hits; };
+	inline const uint64_t GetMisses() const { return m_misses; };
+
+private:
+	struct Entry_t
+	{
+		uint64_t fileSize;
+		int64_t writeTime;
+		MilesStreamHeader_t header;
+	};
+
+	std::unordered_map<std::string, Entry_t> m_entries;
+	bool m_dirty = false; // entries changed since the last save
+
+	std::atomic<uint64_t> m_hits = 0ull;
+	std::atomic<uint64_t> m_misses = 0ull;
+
+	mutable std::mutex m_indexMutex;
+};
+
+extern CMilesStreamIndex g_milesStreamIndex;
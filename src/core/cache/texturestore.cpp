@@ -0,0 +1,217 @@
+#include <pch.h>
+#include <core/cache/texturestore.h>
+
+#include <thirdparty/zstd/common/xxhash.h>
+
+CTextureExportStore g_textureExportStore;
+
+const uint64_t CTextureExportStore::HashData(const void* const data, const size_t size, const uint64_t seed)
+{
+	return XXH64(data, size, seed);
+}
+
+const bool CTextureExportStore::GetFileState(const std::filesystem::path& path, uint64_t& fileSize, int64_t& writeTime)
+{
+	std::error_code ec;
+
+	fileSize = std::filesystem::file_size(path, ec);
+	if (ec)
+		return false;
+
+	writeTime = static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+	return !ec;
+}
+
+bool CTextureExportStore::SaveToFile(const std::string& path)
+{
+	std::lock_guard lock(m_storeMutex);
+
+	// nothing new, keep the file as it is
+	if (!m_dirty && std::filesystem::exists(path))
+		return true;
+
+	TextureStoreHeader_t header = {};
+
+	header.fileVersion = TEXTURE_STORE_FILE_VERSION;
+	header.numEntries = static_cast<uint32_t>(m_entries.size());
+
+	StreamIO storeFile;
+	if (!storeFile.open(path, eStreamIOMode::Write))
+		return false;
+
+	storeFile.write(header);
+
+	uint64_t nextStringOffset = 0;
+	for (auto& it : m_entries)
+	{
+		TextureStoreMapping_t mapping = {};
+		mapping.key = it.first;
+		mapping.fileSize = it.second.fileSize;
+		mapping.writeTime = it.second.writeTime;
+		mapping.encodeTimeNs = it.second.encodeTimeNs;
+		mapping.pathOffset = static_cast<uint32_t>(nextStringOffset);
+
+		nextStringOffset += it.second.path.length() + 1;
+
+		storeFile.write(mapping);
+	}
+
+	header.stringTableOffset = storeFile.tell();
+
+	for (auto& it : m_entries)
+	{
+		storeFile.write(it.second.path.c_str(), it.second.path.length() + 1);
+	}
+
+	storeFile.seek(0);
+	storeFile.write(header);
+	storeFile.close();
+
+	m_dirty = false;
+
+	return true;
+}
+
+bool CTextureExportStore::LoadFromFile(const std::string& path)
+{
+	if (!std::filesystem::exists(path))
+		return true;
+
+	StreamIO storeFile;
+	if (!storeFile.open(path, eStreamIOMode::Read))
+		return false;
+
+	const uint64_t storeFileSize = storeFile.size();
+	if (storeFileSize < sizeof(TextureStoreHeader_t))
+	{
+		LOG_WARN(CACHE, "TXTR STORE: Failed to load texture store file: \"%s\". File is truncated\n", path.c_str());
+		return false;
+	}
+
+	std::unique_ptr<char[]> fileData = std::make_unique<char[]>(storeFileSize);
+	storeFile.read(fileData.get(), storeFileSize);
+	storeFile.close();
+
+	const TextureStoreHeader_t* const header = reinterpret_cast<const TextureStoreHeader_t*>(fileData.get());
+
+	if (header->fileVersion != TEXTURE_STORE_FILE_VERSION)
+	{
+		LOG_WARN(CACHE, "TXTR STORE: Failed to load texture store file: \"%s\". Invalid version\n", path.c_str());
+		return false;
+	}
+
+	if (sizeof(TextureStoreHeader_t) + (header->numEntries * sizeof(TextureStoreMapping_t)) > storeFileSize || header->stringTableOffset > storeFileSize)
+	{
+		LOG_WARN(CACHE, "TXTR STORE: Failed to load texture store file: \"%s\". File is truncated\n", path.c_str());
+		return false;
+	}
+
+	const TextureStoreMapping_t* const mappings = reinterpret_cast<const TextureStoreMapping_t*>(&header[1]);
+
+	// check every path before taking any entry, a damaged file is dropped as a whole
+	for (uint32_t i = 0; i < header->numEntries; ++i)
+	{
+		if (!header->GetString(mappings[i].pathOffset, storeFileSize))
+		{
+			LOG_WARN(CACHE, "TXTR STORE: Failed to load texture store file: \"%s\". String table is corrupt\n", path.c_str());
+			return false;
+		}
+	}
+
+	std::lock_guard lock(m_storeMutex);
+
+	m_entries.reserve(header->numEntries);
+	for (uint32_t i = 0; i < header->numEntries; ++i)
+	{
+		const TextureStoreMapping_t* const mapping = &mappings[i];
+
+		m_entries.emplace(mapping->key, Entry_t{ header->GetString(mapping->pathOffset), mapping->fileSize, mapping->writeTime, mapping->encodeTimeNs });
+	}
+
+	return true;
+}
+
+const bool CTextureExportStore::TryReuse(const uint64_t key, const std::filesystem::path& exportPath)
+{
+	Entry_t entry;
+	bool found = false;
+
+	{
+		std::lock_guard lock(m_storeMutex);
+
+		const auto it = m_entries.find(key);
+		if (it != m_entries.end())
+		{
+			entry = it->second;
+			found = true;
+		}
+	}
+
+	std::error_code ec;
+
+	if (found)
+	{
+		const std::filesystem::path storedPath(entry.path);
+
+		uint64_t fileSize = 0ull;
+		int64_t writeTime = 0ll;
+		if (GetFileState(storedPath, fileSize, writeTime) && fileSize == entry.fileSize && writeTime == entry.writeTime)
+		{
+			bool reused = std::filesystem::equivalent(storedPath, exportPath, ec);
+
+			if (!reused)
+			{
+				std::filesystem::remove(exportPath, ec);
+				std::filesystem::create_hard_link(storedPath, exportPath, ec);
+
+				// different volume or a file system without hard links
+				if (ec)
+					std::filesystem::copy_file(storedPath, exportPath, std::filesystem::copy_options::overwrite_existing, ec);
+
+				reused = !ec;
+			}
+
+			if (reused)
+			{
+				++m_hits;
+				m_savedNs += entry.encodeTimeNs;
+
+				CWrittenFileTracker::Record(exportPath);
+				return true;
+			}
+		}
+		else
+		{
+			// the stored file is gone or was changed since it was exported
+			std::lock_guard lock(m_storeMutex);
+
+			m_entries.erase(key);
+			m_dirty = true;
+		}
+	}
+
+	++m_misses;
+
+	std::filesystem::remove(exportPath, ec);
+	return false;
+}
+
+void CTextureExportStore::Add(const uint64_t key, const std::filesystem::path& exportPath, const int64_t encodeTimeNs)
+{
+	uint64_t fileSize = 0ull;
+	int64_t writeTime = 0ll;
+	if (!GetFileState(exportPath, fileSize, writeTime))
+		return;
+
+	std::lock_guard lock(m_storeMutex);
+
+	m_entries.insert_or_assign(key, Entry_t{ std::filesystem::absolute(exportPath).string(), fileSize, writeTime, encodeTimeNs });
+	m_dirty = true;
+}
+
+const TextureStoreStats_t CTextureExportStore::GetStats() const
+{
+	std::lock_guard lock(m_storeMutex);
+
+	return { m_hits.load(), m_misses.load(), m_entries.size(), m_savedNs.load() };
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+constexpr int TEXTURE_STORE_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct TextureStoreHeader_t
+{
+	uint32_t fileVersion;
+	uint32_t numEntries; // entries immediately follow the header
+
+	uint64_t stringTableOffset;
+
+	const char* GetString(uint64_t offset) const
+	{
+		return reinterpret_cast<const char*>(this) + stringTableOffset + offset;
+	}
+
+	// null if the string starts past the end of the file or isn't terminated before it
+	const char* GetString(uint64_t offset, uint64_t fileSize) const
+	{
+		if (offset >= fileSize || stringTableOffset + offset >= fileSize)
+			return nullptr;
+
+		const char* const str = GetString(offset);
+		return memchr(str, '\0', fileSize - (stringTableOffset + offset)) ? str : nullptr;
+	}
+};
+
+struct TextureStoreMapping_t
+{
+	uint64_t key;
+	uint64_t fileSize;
+	int64_t writeTime;		// last write time of the file when it was recorded, a change means the file was edited or replaced
+	int64_t encodeTimeNs;	// time spent decoding and encoding the texture, what a reuse of this entry saves
+	uint32_t pathOffset;	// offset relative to stringTableOffset
+};
+#pragma pack(pop)
+
+struct TextureStoreStats_t
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t entries;
+	int64_t savedNs;
+};
+
+// content addressed store for exported textures
+// textures with the same source mip bytes and export options produce the same file, so instead of
+// decoding and encoding them again the file exported previously is hard linked (or copied) to the new path
+class CTextureExportStore
+{
+public:
+	// chain calls to build a key, seed with 0 for the first call
+	static const uint64_t HashData(const void* const data, const size_t size, const uint64_t seed);
+
+	template <typename T>
+	static const uint64_t HashValue(const T& value, const uint64_t seed)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		return HashData(&value, sizeof(T), seed);
+	}
+
+	bool SaveToFile(const std::string& path);
+	bool LoadFromFile(const std::string& path);
+
+	// places the file stored for this key at exportPath, returns false if there is no usable file for it
+	// on false any existing file at exportPath is removed, so writing it can't modify a file it was linked to
+	const bool TryReuse(const uint64_t key, const std::filesystem::path& exportPath);
+
+	// records a freshly exported file for this key
+	void Add(const uint64_t key, const std::filesystem::path& exportPath, const int64_t encodeTimeNs);
+
+	const TextureStoreStats_t GetStats() const;
+
+	void Clear()
+	{
+		std::lock_guard lock(m_storeMutex);
+
+		m_entries.clear();
+		m_dirty = true;
+	}
+
+private:
+	struct Entry_t
+	{
+		std::string path;
+		uint64_t fileSize;
+		int64_t writeTime;
+		int64_t encodeTimeNs;
+	};
+
+	static const bool GetFileState(const std::filesystem::path& path, uint64_t& fileSize, int64_t& writeTime);
+
+	std::unordered_map<uint64_t, Entry_t> m_entries;
+	bool m_dirty = false; // entries changed since the last save
+
+	std::atomic<uint64_t> m_hits = 0ull;
+	std::atomic<uint64_t> m_misses = 0ull;
+	std::atomic<int64_t> m_savedNs = 0ll;
+
+	mutable std::mutex m_storeMutex;
+};
+
+extern CTextureExportStore g_textureExportStore;
@@ -0,0 +1,858 @@
+#include <pch.h>
+#include <core/filehandling/assetdiff.h>
+#include <core/filehandling/load.h>
+#include <core/filehandling/export.h>
+#include <core/render/dx.h>
+#include <core/ui/previewtable.h>
+#include <core/window.h>
+
+#include <thirdparty/imgui/misc/imgui_utility.h>
+#include <thirdparty/zstd/common/xxhash.h>
+
+#include <game/rtech/cpakfile.h>
+#include <game/rtech/utils/utils.h>
+#include <game/audio/miles.h>
+
+template <typename T>
+static const uint64_t HashValue(const T& value, const uint64_t seed)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	return XXH64(&value, sizeof(T), seed);
+}
+
+// markers hashed in place of a pointer, so a pointer can't hash the same as the bytes around it
+enum class eFingerprintRef : uint8_t
+{
+	NONE,		// null pointer
+	UNRESOLVED,	// points at data that isn't loaded (lower patch pages) or into the header segment
+	LOCAL,		// data of this asset, followed by its discovery order
+	ASSET,		// another asset, followed by its guid
+	STARPAK,
+};
+
+// hashes the content of pak assets, independent of where the pak's builder placed it
+// the data of an asset is split into chunks at every address something points to, chunks are walked from the asset's header
+// following its pointers. pointers hash as the order their target was first reached in, or as the guid of the asset they
+// point at, so moving an asset's data around a page (or adding other assets around it) doesn't change its fingerprint
+class CPakFingerprinter
+{
+public:
+	CPakFingerprinter(const CPakFile* const pak, const std::vector<CAsset*>& assets);
+
+	const uint64_t Fingerprint(CPakAsset* const asset);
+
+	// every file fingerprints of this pak's assets are read from, besides the pak itself
+	void GetSourceFiles(std::vector<std::string>& files) const;
+
+private:
+	struct PageRange_t
+	{
+		const char* begin;
+		const char* end;
+	};
+
+	const char* ChunkEnd(const char* const begin) const;
+	const uint64_t HashStarpakData(CPakAsset* const asset, const bool opt, const uint64_t seed);
+
+	const CPakFile* const m_pak;
+
+	std::vector<PageRange_t> m_pages;		// non header pages, sorted by address
+	std::vector<const char*> m_slots;		// address of every pointer, sorted
+	std::vector<const char*> m_boundaries;	// address of every pointer target and asset root, sorted
+	std::unordered_map<const char*, uint64_t> m_roots; // asset header and data pointers, to the asset's guid
+
+	std::unordered_map<std::string, std::unique_ptr<CMappedFile>> m_starpakFiles;
+};
+
+CPakFingerprinter::CPakFingerprinter(const CPakFile* const pak, const std::vector<CAsset*>& assets) : m_pak(pak)
+{
+	const PakHdr_t* const header = pak->header();
+
+	m_pages.reserve(header->numPages);
+	for (int i = 0; i < header->numPages; ++i)
+	{
+		const char* const page = pak->pageBuffer(i);
+		if (!page)
+			continue;
+
+		// headers of a patched pak all share the same buffer, they are only walked from their asset
+		const PakPageHdr_t& pageHdr = pak->pageHeaders()[i];
+		if (pak->segmentHeaders()[pageHdr.segment].IsHeaderSegment())
+			continue;
+
+		m_pages.emplace_back(PageRange_t{ page, page + pageHdr.size });
+	}
+
+	std::sort(m_pages.begin(), m_pages.end(), [](const PageRange_t& a, const PageRange_t& b) { return a.begin < b.begin; });
+
+	m_slots.reserve(header->numPointers);
+	m_boundaries.reserve(static_cast<size_t>(header->numPointers) + (assets.size() * 2));
+	for (int i = 0; i < header->numPointers; ++i)
+	{
+		const PakPointerHdr_t& pointerHdr = pak->pointerHeaders()[i];
+
+		const char* const page = pak->pageBuffer(pointerHdr.index);
+		if (!page)
+			continue;
+
+		const char* const slot = page + pointerHdr.offset;
+		m_slots.emplace_back(slot);
+
+		if (const char* const target = reinterpret_cast<const PagePtr_t*>(slot)->ptr)
+			m_boundaries.emplace_back(target);
+	}
+
+	for (CAsset* const asset : assets)
+	{
+		const PakAsset_t* const data = static_cast<CPakAsset*>(asset)->data();
+
+		for (const char* const root : { data->headPagePtr.ptr, data->dataPagePtr.ptr })
+		{
+			if (!root)
+				continue;
+
+			m_roots.try_emplace(root, data->guid);
+			m_boundaries.emplace_back(root);
+		}
+	}
+
+	std::sort(m_slots.begin(), m_slots.end());
+	m_slots.erase(std::unique(m_slots.begin(), m_slots.end()), m_slots.end());
+
+	std::sort(m_boundaries.begin(), m_boundaries.end());
+	m_boundaries.erase(std::unique(m_boundaries.begin(), m_boundaries.end()), m_boundaries.end());
+}
+
+// a chunk runs until the next address something points to, or the end of its page
+// nullptr if it isn't in a loaded page
+const char* CPakFingerprinter::ChunkEnd(const char* const begin) const
+{
+	auto page = std::upper_bound(m_pages.begin(), m_pages.end(), begin, [](const char* const ptr, const PageRange_t& range) { return ptr < range.begin; });
+	if (page == m_pages.begin())
+		return nullptr;
+
+	--page;
+	if (begin >= page->end)
+		return nullptr;
+
+	const auto next = std::upper_bound(m_boundaries.begin(), m_boundaries.end(), begin);
+	return next != m_boundaries.end() && *next < page->end ? *next : page->end;
+}
+
+const uint64_t CPakFingerprinter::HashStarpakData(CPakAsset* const asset, const bool opt, const uint64_t seed)
+{
+	if ((opt ? asset->optStarpakOffset() : asset->starpakOffset()) == -1)
+		return seed;
+
+	uint64_t hash = HashValue(eFingerprintRef::STARPAK, seed);
+	hash = HashValue(opt, hash);
+
+	const StarPak_t* const starpak = asset->getStarPak(opt);
+	const AssetPtr_t entry = asset->getStarPakStreamEntry(opt);
+	if (!starpak || IS_ASSET_PTR_INVALID(entry))
+		return HashValue(eFingerprintRef::UNRESOLVED, hash);
+
+	hash = HashValue(entry.size, hash);
+
+	std::unique_ptr<CMappedFile>& file = m_starpakFiles[starpak->filePath];
+	if (!file)
+		file = std::make_unique<CMappedFile>(starpak->filePath);
+
+	// a missing starpak only changes the fingerprint if it comes back different
+	if (!file->IsOpen() || entry.offset + entry.size > file->Size())
+		return HashValue(eFingerprintRef::UNRESOLVED, hash);
+
+	return XXH64(file->Data() + entry.offset, entry.size, hash);
+}
+
+const uint64_t CPakFingerprinter::Fingerprint(CPakAsset* const asset)
+{
+	const PakAsset_t* const data = asset->data();
+
+	uint64_t hash = HashValue(data->type, 0ull);
+	hash = HashValue(data->version, hash);
+	hash = HashValue(data->headerStructSize, hash);
+
+	struct Chunk_t
+	{
+		const char* begin;
+		const char* end;
+	};
+
+	// chunks are walked in the order they are found, so the same data gets the same order in every build
+	std::vector<Chunk_t> chunks;
+	std::unordered_map<const char*, uint32_t> chunkOrder;
+
+	if (data->headPagePtr.ptr)
+	{
+		chunks.emplace_back(Chunk_t{ data->headPagePtr.ptr, data->headPagePtr.ptr + data->headerStructSize });
+		chunkOrder.emplace(data->headPagePtr.ptr, 0u);
+	}
+
+	if (data->dataPagePtr.ptr && !chunkOrder.contains(data->dataPagePtr.ptr))
+	{
+		if (const char* const end = ChunkEnd(data->dataPagePtr.ptr))
+			chunks.emplace_back(Chunk_t{ data->dataPagePtr.ptr, end });
+
+		chunkOrder.emplace(data->dataPagePtr.ptr, static_cast<uint32_t>(chunkOrder.size()));
+	}
+
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		const Chunk_t chunk = chunks[i];
+		const char* cursor = chunk.begin;
+
+		for (auto slot = std::lower_bound(m_slots.begin(), m_slots.end(), chunk.begin); slot != m_slots.end() && *slot + sizeof(PagePtr_t) <= chunk.end; ++slot)
+		{
+			// the bytes of the pointer itself are an address, which is different on every load
+			if (*slot < cursor)
+				continue;
+
+			hash = XXH64(cursor, static_cast<size_t>(*slot - cursor), hash);
+			cursor = *slot + sizeof(PagePtr_t);
+
+			const char* const target = reinterpret_cast<const PagePtr_t*>(*slot)->ptr;
+			if (!target)
+			{
+				hash = HashValue(eFingerprintRef::NONE, hash);
+				continue;
+			}
+
+			if (const auto root = m_roots.find(target); root != m_roots.end() && root->second != data->guid)
+			{
+				hash = HashValue(eFingerprintRef::ASSET, hash);
+				hash = HashValue(root->second, hash);
+				continue;
+			}
+
+			if (const auto order = chunkOrder.find(target); order != chunkOrder.end())
+			{
+				hash = HashValue(eFingerprintRef::LOCAL, hash);
+				hash = HashValue(order->second, hash);
+				continue;
+			}
+
+			const char* const end = ChunkEnd(target);
+			if (!end)
+			{
+				hash = HashValue(eFingerprintRef::UNRESOLVED, hash);
+				continue;
+			}
+
+			const uint32_t order = static_cast<uint32_t>(chunkOrder.size());
+			chunkOrder.emplace(target, order);
+			chunks.emplace_back(Chunk_t{ target, end });
+
+			hash = HashValue(eFingerprintRef::LOCAL, hash);
+			hash = HashValue(order, hash);
+		}
+
+		hash = XXH64(cursor, static_cast<size_t>(chunk.end - cursor), hash);
+	}
+
+	hash = HashStarpakData(asset, false, hash);
+	hash = HashStarpakData(asset, true, hash);
+
+	return hash;
+}
+
+void CPakFingerprinter::GetSourceFiles(std::vector<std::string>& files) const
+{
+	for (const bool opt : { false, true })
+	{
+		for (size_t i = 0; i < m_pak->starPakCount(opt); ++i)
+		{
+			if (const StarPak_t* const starpak = m_pak->getStarPak(static_cast<int>(i), opt))
+				files.emplace_back(std::filesystem::absolute(starpak->filePath).string());
+		}
+	}
+}
+
+static std::string PathKey(const std::filesystem::path& path)
+{
+	std::string key = std::filesystem::absolute(path).lexically_normal().make_preferred().string();
+	std::transform(key.begin(), key.end(), key.begin(), [](const unsigned char c) { return static_cast<char>(tolower(c)); });
+
+	return key;
+}
+
+// fingerprints of a pak's assets and the starpaks they were read from, taken as the pak loaded
+struct PakFingerprintCapture_t
+{
+	std::vector<AssetFingerprint_t> assets;
+	std::vector<std::string> sourceFiles;
+};
+
+static std::atomic<bool> s_capturePakFingerprints = false;
+
+static std::unordered_map<std::string, PakFingerprintCapture_t> s_pakFingerprintCaptures; // by PathKey of the loaded pak
+static std::mutex s_pakFingerprintCaptureMutex;
+
+void SetPakFingerprintCapture(const bool enabled)
+{
+	s_capturePakFingerprints = enabled;
+}
+
+const bool IsPakFingerprintCaptureEnabled()
+{
+	return s_capturePakFingerprints;
+}
+
+void CapturePakFingerprints(const CPakFile* const pak, const std::vector<CAsset*>& assets)
+{
+	const std::string key = PathKey(pak->GetContainerFilePath());
+
+	if (!s_capturePakFingerprints)
+	{
+		// a capture from an earlier load of the same file says nothing about this one
+		std::lock_guard lock(s_pakFingerprintCaptureMutex);
+		s_pakFingerprintCaptures.erase(key);
+
+		return;
+	}
+
+	PROFILE_SCOPE("fingerprint pak on load");
+
+	PakFingerprintCapture_t capture;
+	capture.assets.reserve(assets.size());
+
+	CPakFingerprinter fingerprinter(pak, assets);
+	fingerprinter.GetSourceFiles(capture.sourceFiles);
+
+	for (CAsset* const asset : assets)
+		capture.assets.emplace_back(AssetFingerprint_t{ asset->GetAssetGUID(), fingerprinter.Fingerprint(static_cast<CPakAsset*>(asset)), asset->GetAssetType(), std::string(asset->GetAssetName()) });
+
+	std::lock_guard lock(s_pakFingerprintCaptureMutex);
+	s_pakFingerprintCaptures.insert_or_assign(key, std::move(capture));
+}
+
+void ClearPakFingerprintCaptures()
+{
+	std::lock_guard lock(s_pakFingerprintCaptureMutex);
+	s_pakFingerprintCaptures.clear();
+}
+
+static const bool FindPakFingerprintCapture(const std::filesystem::path& pakPath, PakFingerprintCapture_t& capture)
+{
+	std::lock_guard lock(s_pakFingerprintCaptureMutex);
+
+	const auto it = s_pakFingerprintCaptures.find(PathKey(pakPath));
+	if (it == s_pakFingerprintCaptures.end())
+		return false;
+
+	capture = it->second;
+	return true;
+}
+
+static void ErasePakFingerprintCapture(const std::filesystem::path& pakPath)
+{
+	std::lock_guard lock(s_pakFingerprintCaptureMutex);
+	s_pakFingerprintCaptures.erase(PathKey(pakPath));
+}
+
+static const uint64_t FingerprintAudioSource(CMilesAudioBank* const bank, CAsset* const asset, std::vector<std::string>& files)
+{
+	const MilesSource_t* const source = reinterpret_cast<const MilesSource_t*>(asset->GetAssetData());
+
+	uint64_t hash = HashValue(asset->GetAssetType(), 0ull);
+	hash = HashValue(source->languageIdx, hash);
+	hash = HashValue(source->streamHeaderSize, hash);
+	hash = HashValue(source->streamDataSize, hash);
+
+	std::filesystem::path streamPath(bank->GetContainerFilePath());
+	streamPath.replace_filename(bank->GetStreamingFileNameForSource(source));
+	files.emplace_back(std::filesystem::absolute(streamPath).string());
+
+	const CMappedFile* const streamFile = bank->GetStreamFileForSource(source);
+	if (!streamFile)
+		return HashValue(eFingerprintRef::UNRESOLVED, hash);
+
+	const MilesStreamHeader_t* const streamHeader = reinterpret_cast<const MilesStreamHeader_t*>(streamFile->Data());
+	const uint64_t dataOffset = static_cast<uint64_t>(streamHeader->streamDataOffset) + source->streamDataOffset;
+
+	if (source->streamHeaderOffset + source->streamHeaderSize > streamFile->Size() || dataOffset + source->streamDataSize > streamFile->Size())
+		return HashValue(eFingerprintRef::UNRESOLVED, hash);
+
+	hash = XXH64(streamFile->Data() + source->streamHeaderOffset, source->streamHeaderSize, hash);
+	hash = XXH64(streamFile->Data() + dataOffset, source->streamDataSize, hash);
+
+	return hash;
+}
+
+// fingerprints of the assets in one loaded container, and the files they were read from
+// false for a pak that was loaded without capture, its pages have been through its load functions and can't be fingerprinted anymore
+static const bool FingerprintContainer(CAssetContainer* const container, const std::vector<CAsset*>& assets, std::vector<AssetFingerprint_t>& fingerprints, std::vector<std::string>& files)
+{
+	PROFILE_SCOPE("fingerprint container");
+
+	const std::filesystem::path containerPath = container->GetContainerFilePath();
+	files.emplace_back(std::filesystem::absolute(containerPath).string());
+
+	fingerprints.reserve(fingerprints.size() + assets.size());
+
+	switch (container->GetContainerType())
+	{
+	case CAsset::ContainerType::PAK:
+	{
+		PakFingerprintCapture_t capture;
+		if (!FindPakFingerprintCapture(containerPath, capture))
+			return false;
+
+		// which patch gets loaded comes from here
+		const std::filesystem::path patchMasterPath = containerPath.parent_path() / "patch_master.rpak";
+		if (std::filesystem::exists(patchMasterPath))
+			files.emplace_back(std::filesystem::absolute(patchMasterPath).string());
+
+		files.insert(files.end(), capture.sourceFiles.begin(), capture.sourceFiles.end());
+		fingerprints.insert(fingerprints.end(), std::make_move_iterator(capture.assets.begin()), std::make_move_iterator(capture.assets.end()));
+
+		break;
+	}
+	case CAsset::ContainerType::AUDIO:
+	{
+		CMilesAudioBank* const bank = static_cast<CMilesAudioBank*>(container);
+
+		for (CAsset* const asset : assets)
+			fingerprints.emplace_back(AssetFingerprint_t{ asset->GetAssetGUID(), FingerprintAudioSource(bank, asset, files), asset->GetAssetType(), std::string(asset->GetAssetName()) });
+
+		break;
+	}
+	default:
+	{
+		// models and bluepoint paks don't keep enough of their layout around to split the file per asset, any change to the file changes all of them
+		const CMappedFile file(containerPath);
+		const uint64_t fileHash = file.IsOpen() ? XXH64(file.Data(), file.Size(), 0ull) : HashValue(eFingerprintRef::UNRESOLVED, 0ull);
+
+		for (CAsset* const asset : assets)
+		{
+			const std::string_view name = asset->GetAssetName();
+
+			uint64_t hash = HashValue(asset->GetAssetType(), fileHash);
+			hash = XXH64(name.data(), name.length(), hash);
+
+			fingerprints.emplace_back(AssetFingerprint_t{ asset->GetAssetGUID(), hash, asset->GetAssetType(), std::string(name) });
+		}
+
+		break;
+	}
+	}
+
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end()), files.end());
+
+	return true;
+}
+
+static void AddToSet(const std::vector<AssetFingerprint_t>& fingerprints, AssetFingerprintSet_t& set)
+{
+	for (const AssetFingerprint_t& fingerprint : fingerprints)
+	{
+		AssetSetEntry_t& entry = set[fingerprint.guid];
+		if (entry.fingerprints.empty())
+		{
+			entry.type = fingerprint.type;
+			entry.name = fingerprint.name;
+		}
+
+		// the same asset in several paks only counts once per distinct version of it, so adding a pak that has a copy isn't a change
+		const auto it = std::lower_bound(entry.fingerprints.begin(), entry.fingerprints.end(), fingerprint.fingerprint);
+		if (it == entry.fingerprints.end() || *it != fingerprint.fingerprint)
+			entry.fingerprints.insert(it, fingerprint.fingerprint);
+	}
+}
+
+static void FingerprintLoaded(const std::vector<std::string>& filePaths, const bool useIndex, AssetFingerprintSet_t& set, AssetFingerprintStats_t& stats)
+{
+	PROFILE_SCOPE("fingerprint loaded files");
+
+	// loaded containers, by the path they were loaded from
+	// a pak that was swapped for its top patch on load is also found by the file name that was asked for
+	std::unordered_map<std::string, CAssetContainer*> containersByPath;
+	std::unordered_map<std::string, CAssetContainer*> paksByBaseName;
+	for (CAssetContainer* const container : g_assetData.v_assetContainers)
+	{
+		const std::filesystem::path containerPath = container->GetContainerFilePath();
+		containersByPath.emplace(PathKey(containerPath), container);
+
+		if (container->GetContainerType() == CAsset::ContainerType::PAK)
+			paksByBaseName.emplace(PathKey(containerPath.parent_path() / container->GetContainerFileName()), container);
+	}
+
+	std::unordered_map<const CAssetContainer*, std::vector<CAsset*>> containerAssets;
+	for (const CGlobalAssetData::AssetLookup_t& lookup : g_assetData.v_assets)
+		containerAssets[lookup.m_asset->GetContainerFile<CAssetContainer>()].emplace_back(lookup.m_asset);
+
+	struct FileFingerprints_t
+	{
+		std::string path;
+		CAssetContainer* container;
+		bool cached;
+		bool skipped;
+
+		std::vector<AssetFingerprint_t> assets;
+		std::vector<std::string> sourceFiles;
+	};
+
+	std::vector<FileFingerprints_t> files(filePaths.size());
+
+	CParallelTask parallelProcessTask(UtilsConfig->parseThreadCount);
+	for (size_t i = 0; i < filePaths.size(); ++i)
+	{
+		FileFingerprints_t& file = files[i];
+		file.path = std::filesystem::absolute(filePaths[i]).string();
+		file.container = nullptr;
+		file.skipped = false;
+		file.cached = useIndex && g_assetFingerprintIndex.Find(file.path, file.assets);
+
+		if (file.cached)
+			continue;
+
+		const std::filesystem::path path(filePaths[i]);
+		if (const auto it = containersByPath.find(PathKey(path)); it != containersByPath.end())
+			file.container = it->second;
+		else if (const auto pakIt = paksByBaseName.find(PathKey(path.parent_path() / (GetPakFileStemNoPatchNum(path) + ".rpak"))); pakIt != paksByBaseName.end())
+			file.container = pakIt->second;
+
+		// failed to load, there is nothing to compare
+		if (!file.container)
+			continue;
+
+		parallelProcessTask.addTask([&file, &containerAssets]
+			{
+				file.sourceFiles.emplace_back(file.path);
+
+				const auto it = containerAssets.find(file.container);
+				if (!FingerprintContainer(file.container, it != containerAssets.end() ? it->second : std::vector<CAsset*>(), file.assets, file.sourceFiles))
+				{
+					LOG_WARN(PAK, "ASSET DIFF: \"%s\" was loaded before fingerprinting was enabled, its assets are left out of the comparison\n", file.path.c_str());
+					file.skipped = true;
+
+					return;
+				}
+
+				g_assetFingerprintIndex.Add(file.path, file.sourceFiles, file.assets);
+			}, 1u);
+	}
+
+	parallelProcessTask.execute();
+	parallelProcessTask.wait();
+
+	for (const FileFingerprints_t& file : files)
+	{
+		AddToSet(file.assets, set);
+
+		++stats.files;
+		stats.assets += static_cast<uint32_t>(file.assets.size());
+
+		if (file.cached)
+			++stats.cachedFiles;
+
+		if (file.skipped)
+			++stats.skippedFiles;
+	}
+}
+
+void FingerprintLoadedFiles(const std::vector<std::string>& filePaths, AssetFingerprintSet_t& set, AssetFingerprintStats_t& stats)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	FingerprintLoaded(filePaths, true, set, stats);
+
+	stats.elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void FingerprintFileSet(const std::vector<std::string>& filePaths, AssetFingerprintSet_t& set, AssetFingerprintStats_t& stats)
+{
+	assertm(g_assetData.v_assetContainers.empty(), "fingerprinting a file set needs nothing else to be loaded");
+
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::string> missingPaths;
+	for (const std::string& path : filePaths)
+	{
+		std::vector<AssetFingerprint_t> fingerprints;
+		if (!g_assetFingerprintIndex.Find(std::filesystem::absolute(path).string(), fingerprints))
+		{
+			missingPaths.emplace_back(path);
+			continue;
+		}
+
+		AddToSet(fingerprints, set);
+
+		++stats.files;
+		++stats.cachedFiles;
+		stats.assets += static_cast<uint32_t>(fingerprints.size());
+	}
+
+	if (!missingPaths.empty())
+	{
+		const bool capturing = IsPakFingerprintCaptureEnabled();
+
+		SetPakFingerprintCapture(true);
+		HandleFileLoad(missingPaths);
+		SetPakFingerprintCapture(capturing);
+
+		FingerprintLoaded(missingPaths, false, set, stats);
+
+		// the index has them now
+		for (const CAssetContainer* const container : g_assetData.v_assetContainers)
+		{
+			if (container->GetContainerType() == CAsset::ContainerType::PAK)
+				ErasePakFingerprintCapture(container->GetContainerFilePath());
+		}
+
+		g_assetData.ClearAssetData();
+	}
+
+	stats.elapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void DiffAssetSets(const AssetFingerprintSet_t& oldSet, const AssetFingerprintSet_t& newSet, AssetDiffResult_t& result)
+{
+	PROFILE_SCOPE("diff asset sets");
+
+	for (const auto& [guid, entry] : newSet)
+	{
+		const auto it = oldSet.find(guid);
+		if (it == oldSet.end())
+		{
+			result.entries.emplace_back(AssetDiffEntry_t{ guid, entry.type, eAssetDiffChange::ADDED, entry.name });
+			++result.types[entry.type].added;
+
+			continue;
+		}
+
+		if (it->second.type != entry.type || it->second.fingerprints != entry.fingerprints)
+		{
+			result.entries.emplace_back(AssetDiffEntry_t{ guid, entry.type, eAssetDiffChange::CHANGED, entry.name });
+			++result.types[entry.type].changed;
+
+			continue;
+		}
+
+		++result.types[entry.type].unchanged;
+	}
+
+	for (const auto& [guid, entry] : oldSet)
+	{
+		if (newSet.contains(guid))
+			continue;
+
+		result.entries.emplace_back(AssetDiffEntry_t{ guid, entry.type, eAssetDiffChange::REMOVED, entry.name });
+		++result.types[entry.type].removed;
+	}
+
+	std::sort(result.entries.begin(), result.entries.end(), [](const AssetDiffEntry_t& a, const AssetDiffEntry_t& b)
+		{
+			if (a.type != b.type)
+				return a.type < b.type;
+
+			if (a.change != b.change)
+				return a.change < b.change;
+
+			return a.name < b.name;
+		});
+}
+
+//
+// UI
+//
+extern CDXParentHandler* g_dxHandler;
+extern ExportSettings_t g_ExportSettings;
+extern std::atomic<bool> inJobAction;
+
+// only the window and the jobs it starts touch these, and the window isn't drawn while a job runs
+static std::vector<std::string> s_diffBaselinePaths;
+static AssetFingerprintSet_t s_diffBaselineSet;
+static AssetFingerprintStats_t s_diffBaselineStats = {};
+
+static AssetDiffResult_t s_diffResult;
+static AssetFingerprintStats_t s_diffStats = {};
+static bool s_hasDiffResult = false;
+static bool s_diffResultChanged = false; // the result table is rebuilt on the next draw
+static size_t s_diffUnloadGeneration = 0ull;
+static size_t s_diffContainerCount = 0ull;
+
+static void HandleBuildDiffBaselineDialog(const HWND windowHandle)
+{
+	inJobAction = true;
+
+	std::vector<std::string> filePaths;
+	if (ShowOpenFileDialog(windowHandle, filePaths))
+	{
+		s_diffBaselineSet.clear();
+		s_diffBaselineStats = {};
+		FingerprintFileSet(filePaths, s_diffBaselineSet, s_diffBaselineStats);
+
+		s_diffBaselinePaths = std::move(filePaths);
+		s_hasDiffResult = false;
+
+		// the build opened next is compared against it, its paks have to be fingerprinted as they load
+		SetPakFingerprintCapture(true);
+	}
+
+	inJobAction = false;
+}
+
+static void HandleBuildDiffCompare()
+{
+	inJobAction = true;
+
+	std::vector<std::string> filePaths;
+	for (const CAssetContainer* const container : g_assetData.v_assetContainers)
+		filePaths.emplace_back(container->GetContainerFilePath().string());
+
+	AssetFingerprintSet_t currentSet;
+	s_diffStats = {};
+	FingerprintLoadedFiles(filePaths, currentSet, s_diffStats);
+
+	s_diffResult = {};
+	DiffAssetSets(s_diffBaselineSet, currentSet, s_diffResult);
+
+	s_diffUnloadGeneration = g_assetData.m_unloadGeneration;
+	s_diffContainerCount = g_assetData.v_assetContainers.size();
+	s_hasDiffResult = true;
+	s_diffResultChanged = true;
+
+	inJobAction = false;
+}
+
+static void ClearBuildDiffBaseline()
+{
+	s_diffBaselinePaths.clear();
+	s_diffBaselineSet.clear();
+	s_diffBaselineStats = {};
+
+	s_diffResult = {};
+	s_hasDiffResult = false;
+
+	SetPakFingerprintCapture(false);
+	ClearPakFingerprintCaptures();
+}
+
+static const ImU32 AssetDiffChangeColour(const eAssetDiffChange change)
+{
+	switch (change)
+	{
+	case eAssetDiffChange::ADDED:   return IM_COL32(110, 220, 110, 255);
+	case eAssetDiffChange::REMOVED: return IM_COL32(230, 100, 100, 255);
+	default:                        return IM_COL32(230, 200, 90, 255);
+	}
+}
+
+void DrawBuildDiffWindow(bool* const open)
+{
+	static CPreviewTable resultTable;
+
+	ImGui::SetNextWindowSize(ImVec2(900.f, 500.f), ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Build Diff", open))
+	{
+		ImGui::End();
+		return;
+	}
+
+	// the baseline is loaded and unloaded again to fingerprint it, it can't share the asset list with anything
+	const bool filesLoaded = !g_assetData.v_assetContainers.empty();
+	const bool hasBaseline = !s_diffBaselinePaths.empty();
+
+	if (hasBaseline)
+	{
+		ImGui::Text("Baseline: %llu assets in %u files (%u from the fingerprint index), %.3fs", s_diffBaselineSet.size(), s_diffBaselineStats.files, s_diffBaselineStats.cachedFiles, static_cast<double>(s_diffBaselineStats.elapsedNs) / 1e9);
+	}
+	else
+	{
+		ImGui::TextUnformatted("Choose the files of the older build as the baseline, then open the newer build and compare.");
+	}
+
+	ImGui::BeginDisabled(filesLoaded);
+	if (ImGui::Button("Choose baseline files..."))
+		CThread(HandleBuildDiffBaselineDialog, g_dxHandler->GetWindowHandle()).detach();
+	ImGui::EndDisabled();
+
+	ImGui::SameLine();
+	ImGui::BeginDisabled(!hasBaseline);
+	if (ImGui::Button("Clear baseline"))
+		ClearBuildDiffBaseline();
+	ImGui::EndDisabled();
+
+	ImGui::SameLine();
+	ImGui::BeginDisabled(!hasBaseline || !filesLoaded);
+	if (ImGui::Button("Compare with loaded files"))
+		CThread(HandleBuildDiffCompare).detach();
+	ImGui::EndDisabled();
+
+	if (filesLoaded && !hasBaseline)
+		ImGui::TextDisabled("Unload all files to choose a baseline.");
+
+	if (!s_hasDiffResult)
+	{
+		ImGui::End();
+		return;
+	}
+
+	if (s_diffResultChanged)
+	{
+		resultTable.Reset(s_diffResult.entries.size());
+		resultTable.AddColumn("Change", ePreviewColumnSort::TEXT);
+		resultTable.AddColumn("Type", ePreviewColumnSort::TEXT);
+		resultTable.AddColumn("GUID", ePreviewColumnSort::NUMBER);
+		resultTable.AddColumn("Name", ePreviewColumnSort::TEXT);
+
+		for (const AssetDiffEntry_t& entry : s_diffResult.entries)
+		{
+			resultTable.SetRowColour(AssetDiffChangeColour(entry.change));
+
+			resultTable.AddCell(AssetDiffChangeToString(entry.change));
+			resultTable.AddCell(fourCCToString(entry.type).c_str());
+			resultTable.AddCellFormat(static_cast<double>(entry.guid), "0x{:X}", entry.guid);
+			resultTable.AddCell(entry.name.data(), entry.name.length());
+		}
+
+		s_diffResultChanged = false;
+	}
+
+	AssetDiffTypeStats_t totals = {};
+	for (const auto& [type, stats] : s_diffResult.types)
+	{
+		totals.added += stats.added;
+		totals.removed += stats.removed;
+		totals.changed += stats.changed;
+		totals.unchanged += stats.unchanged;
+	}
+
+	ImGui::Text("%u added, %u removed, %u changed, %u unchanged. fingerprinted %u assets in %u files (%u from the fingerprint index), %.3fs",
+		totals.added, totals.removed, totals.changed, totals.unchanged, s_diffStats.assets, s_diffStats.files, s_diffStats.cachedFiles, static_cast<double>(s_diffStats.elapsedNs) / 1e9);
+
+	if (s_diffStats.skippedFiles)
+		ImGui::TextColored(ImVec4(1.f, 0.3f, 0.3f, 1.f), "%u paks were opened before the baseline was chosen and are left out, open them again to compare them.", s_diffStats.skippedFiles);
+
+	// the result names assets by guid, an unload or another load since can change which of them are loaded
+	const bool stale = s_diffUnloadGeneration != g_assetData.m_unloadGeneration || s_diffContainerCount != g_assetData.v_assetContainers.size();
+	if (stale)
+		ImGui::TextColored(ImVec4(1.f, 0.8f, 0.3f, 1.f), "Files were loaded or unloaded since this comparison, compare again to export.");
+
+	ImGui::BeginDisabled(stale || totals.added + totals.changed == 0u);
+	if (ImGui::Button("Export added and changed"))
+	{
+		std::unordered_set<uint64_t> exportGuids;
+		for (const AssetDiffEntry_t& entry : s_diffResult.entries)
+		{
+			if (entry.change != eAssetDiffChange::REMOVED)
+				exportGuids.insert(entry.guid);
+		}
+
+		std::vector<CGlobalAssetData::AssetLookup_t> exportAssets;
+		for (const CGlobalAssetData::AssetLookup_t& lookup : g_assetData.v_assets)
+		{
+			if (exportGuids.contains(lookup.m_guid))
+				exportAssets.push_back(lookup);
+		}
+
+		CThread(HandleExportSelectedAssetType, std::move(exportAssets), g_ExportSettings.exportAssetDeps).detach();
+	}
+	ImGui::EndDisabled();
+
+	resultTable.Draw("Diff Results", ImVec2(0.f, 0.f));
+
+	ImGui::End();
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <core/cache/fingerprintindex.h>
+
+enum class eAssetDiffChange : uint8_t
+{
+	ADDED,
+	REMOVED,
+	CHANGED,
+};
+
+// every asset of a build, by guid
+// an asset that is in more than one file keeps each distinct fingerprint it has, sorted
+struct AssetSetEntry_t
+{
+	uint32_t type;
+	std::string name;
+	std::vector<uint64_t> fingerprints;
+};
+
+typedef std::unordered_map<uint64_t, AssetSetEntry_t> AssetFingerprintSet_t;
+
+struct AssetFingerprintStats_t
+{
+	uint32_t files;
+	uint32_t cachedFiles;	// files whose fingerprints came from g_assetFingerprintIndex
+	uint32_t skippedFiles;	// paks that were loaded without capture, their assets are left out
+	uint32_t assets;
+	int64_t elapsedNs;
+};
+
+struct AssetDiffEntry_t
+{
+	uint64_t guid;
+	uint32_t type;
+	eAssetDiffChange change;
+	std::string name;
+};
+
+struct AssetDiffTypeStats_t
+{
+	uint32_t added;
+	uint32_t removed;
+	uint32_t changed;
+	uint32_t unchanged;
+};
+
+struct AssetDiffResult_t
+{
+	std::vector<AssetDiffEntry_t> entries; // sorted by type, then change, then name
+	std::map<uint32_t, AssetDiffTypeStats_t> types;
+};
+
+class CPakFile;
+
+// pak pages are fingerprinted as the pak loads, before any load function runs on them. load functions are free to rewrite
+// page data (headers fixed up in place, pointers to extra data written into them) and what they leave behind isn't what the pak shipped with
+// capturing costs a walk over every asset and a read of its starpak data, so it is only on while a build is loaded to be compared
+void SetPakFingerprintCapture(const bool enabled);
+const bool IsPakFingerprintCaptureEnabled();
+
+// called by the pak loader once the pak's assets exist and before their load functions run
+void CapturePakFingerprints(const CPakFile* const pak, const std::vector<CAsset*>& assets);
+
+// drops every capture, they are kept until then so a loaded build can be compared more than once
+void ClearPakFingerprintCaptures();
+
+// fingerprints every asset in these files without keeping them loaded, files with fingerprints in the index aren't loaded at all
+// nothing else can be loaded while this runs, the loaded assets are cleared when it is done
+void FingerprintFileSet(const std::vector<std::string>& filePaths, AssetFingerprintSet_t& set, AssetFingerprintStats_t& stats);
+
+// fingerprints the assets of these files, which have to be loaded already. paks among them have to have been loaded with capture on
+void FingerprintLoadedFiles(const std::vector<std::string>& filePaths, AssetFingerprintSet_t& set, AssetFingerprintStats_t& stats);
+
+void DiffAssetSets(const AssetFingerprintSet_t& oldSet, const AssetFingerprintSet_t& newSet, AssetDiffResult_t& result);
+
+// compares the loaded files against a baseline picked in the window, and exports what was added or changed
+void DrawBuildDiffWindow(bool* const open);
+
+inline const char* const AssetDiffChangeToString(const eAssetDiffChange change)
+{
+	switch (change)
+	{
+	case eAssetDiffChange::ADDED:   return "added";
+	case eAssetDiffChange::REMOVED: return "removed";
+	case eAssetDiffChange::CHANGED: return "changed";
+	default:                        return "unknown";
+	}
+}
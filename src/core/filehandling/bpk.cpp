@@ -9,6 +9,8 @@
 
 void HandleBPKLoad(std::vector<std::string> filePaths)
 {
+    PROFILE_SCOPE("load bpk files");
+
     std::atomic<uint32_t> pakfileLoadingProgress = 0;
     const ProgressBarEvent_t* const pakfileLoadProgressBar = g_pImGuiHandler->AddProgressBarEvent("Loading Bluepoint Pak Files..", static_cast<uint32_t>(filePaths.size()), &pakfileLoadingProgress, true);
 
@@ -25,7 +27,7 @@ void HandleBPKLoad(std::vector<std::string> filePaths)
         if (!pakfile->ParseFromFile())
         {
             assertm(false, "failed to parse bluepoint pakfile");
-            Log("%s failed to load!\n", pakfile->GetFileName());
+            LOG_ERROR(PAK, "%s failed to load!\n", pakfile->GetFileName());
 
             delete pakfile;
 
@@ -59,6 +61,9 @@ void HandleBPKLoad(std::vector<std::string> filePaths)
 
                 g_assetData.v_assets.emplace_back(file->GetAssetGUID(), file);
 
+                PROFILE_SCOPE_TYPE("load", file->GetAssetType());
+                PROFILE_COUNTER_ADD(eProfileCounter::ASSETS_LOADED, 1);
+
                 binding->second.loadFunc(pakfile, file);
             }
 
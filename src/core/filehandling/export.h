@@ -2,7 +2,7 @@
 #include <game/rtech/cpakfile.h>
 
 // rpak.cpp
-FORCEINLINE void HandleExportBindingForAsset(CAsset* const asset, const bool exportDependencies);
+FORCEINLINE const bool HandleExportBindingForAsset(CAsset* const asset, const bool exportDependencies);
 void HandlePakAssetExportList(std::deque<CAsset*> selectedAssets, const bool exportDependencies);
 void HandleExportAllPakAssets(std::vector<CGlobalAssetData::AssetLookup_t>* const pakAssets, const bool exportDependencies);
 void HandleExportSelectedAssetType(std::vector<CGlobalAssetData::AssetLookup_t> pakAssets, const bool exportDependencies);
@@ -7,24 +7,43 @@ extern CBufferManager g_BufferManager;
 
 extern std::atomic<bool> inJobAction;
 
-static void HandleFileLoad(std::vector<std::string> filePaths)
+// extensions are matched case insensitively, as windows paths are
+static const CAsset::ContainerType ContainerTypeFromPath(const std::filesystem::path& path)
+{
+    static const std::pair<const char*, CAsset::ContainerType> s_loadableExtensions[] = {
+        { ".rpak", CAsset::ContainerType::PAK },
+        { ".mbnk", CAsset::ContainerType::AUDIO },
+        { ".mdl", CAsset::ContainerType::MDL },
+        { ".bpk", CAsset::ContainerType::BP_PAK },
+    };
+
+    const std::string extension = path.extension().string();
+    for (const auto& [loadableExtension, containerType] : s_loadableExtensions)
+    {
+        if (_stricmp(extension.c_str(), loadableExtension) == 0)
+            return containerType;
+    }
+
+    return CAsset::ContainerType::_COUNT;
+}
+
+const bool IsLoadableFile(const std::filesystem::path& path)
+{
+    return ContainerTypeFromPath(path) != CAsset::ContainerType::_COUNT;
+}
+
+void HandleFileLoad(std::vector<std::string> filePaths)
 {
     std::vector<std::string> pathsByExtension[CAsset::ContainerType::_COUNT];
 
     for (auto& path : filePaths)
     {
-        const std::string extension = std::filesystem::path(path).extension().string();
-
-        if (extension == ".rpak")
-            pathsByExtension[CAsset::ContainerType::PAK].emplace_back(path);
-        else if (extension == ".mbnk")
-            pathsByExtension[CAsset::ContainerType::AUDIO].emplace_back(path);
-        else if (extension == ".mdl")
-            pathsByExtension[CAsset::ContainerType::MDL].emplace_back(path);
-        else if (extension == ".bpk")
-            pathsByExtension[CAsset::ContainerType::BP_PAK].emplace_back(path);
+        const CAsset::ContainerType containerType = ContainerTypeFromPath(path);
+
+        if (containerType != CAsset::ContainerType::_COUNT)
+            pathsByExtension[containerType].emplace_back(path);
         else
-            Log("Invalid file extension found in path: %s.\n", path.c_str());
+            LOG_WARN(GENERAL, "Invalid file extension found in path: %s.\n", path.c_str());
     }
 
     for (uint32_t i = 0; i < CAsset::ContainerType::_COUNT; ++i)
@@ -68,11 +87,9 @@ void HandleLoadFromCommandLine(const CCommandLine* const cli)
     CThread(HandleFileLoad, std::move(filePaths)).detach();
 }
 
-void HandleOpenFileDialog(const HWND windowHandle)
+// the files picked in the open dialog, false if it was cancelled
+const bool ShowOpenFileDialog(const HWND windowHandle, std::vector<std::string>& filePaths)
 {
-    // We are in pak load now.
-    inJobAction = true;
-
     CManagedBuffer* fileNames = g_BufferManager.ClaimBuffer();
     memset(fileNames->Buffer(), 0, CBufferManager::MaxBufferSize());
 
@@ -86,9 +103,9 @@ void HandleOpenFileDialog(const HWND windowHandle)
     openFileName.Flags = OFN_EXPLORER | OFN_FILEMUSTEXIST | OFN_ALLOWMULTISELECT | OFN_NOCHANGEDIR;
     openFileName.lpstrDefExt = "";
 
-    if (GetOpenFileNameA(&openFileName))
+    const bool picked = GetOpenFileNameA(&openFileName) != FALSE;
+    if (picked)
     {
-        std::vector<std::string> filePaths;
         std::string directoryPath(fileNames->Buffer());
 
         // fileNames buffer is a collection of strings
@@ -108,13 +125,25 @@ void HandleOpenFileDialog(const HWND windowHandle)
         {
             filePaths.push_back(std::move(directoryPath));
         }
+    }
+
+    g_BufferManager.RelieveBuffer(fileNames);
+
+    return picked;
+}
+
+void HandleOpenFileDialog(const HWND windowHandle)
+{
+    // We are in pak load now.
+    inJobAction = true;
 
+    std::vector<std::string> filePaths;
+    if (ShowOpenFileDialog(windowHandle, filePaths))
+    {
         // We are moving the whole vector out of here into HandlePakLoad.
         HandleFileLoad(std::move(filePaths));
     }
 
-    g_BufferManager.RelieveBuffer(fileNames);
-
     // We are done with pak loading.
     inJobAction = false;
 }
\ No newline at end of file
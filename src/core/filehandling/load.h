@@ -1,9 +1,19 @@
 #pragma once
 
 class CCommandLine;
+class CSourceModelAsset;
+class CSourceSequenceAsset;
 
 void HandleLoadFromCommandLine(const CCommandLine* const cli);
+
+// true for files HandleFileLoad can load, by extension
+const bool IsLoadableFile(const std::filesystem::path& path);
+
+void HandleFileLoad(std::vector<std::string> filePaths);
 void HandlePakLoad(std::vector<std::string> filePaths);
 void HandleMBNKLoad(std::vector<std::string> filePaths);
 void HandleMDLLoad(std::vector<std::string> filePaths);
-void HandleBPKLoad(std::vector<std::string> filePaths);
\ No newline at end of file
+void HandleBPKLoad(std::vector<std::string> filePaths);
+
+// builds the assets of one model file without registering them, nullptr if the file is invalid or unsupported
+CSourceModelAsset* const CreateSourceModelAssets(const std::string& path, std::vector<CSourceSequenceAsset*>& sequenceAssets);
\ No newline at end of file
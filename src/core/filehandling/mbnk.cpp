@@ -9,10 +9,12 @@
 
 void HandleMBNKLoad(std::vector<std::string> filePaths)
 {
+	PROFILE_SCOPE("load mbnk files");
+
 	std::atomic<uint32_t> bankLoadingProgress = 0;
 	const ProgressBarEvent_t* const bankLoadProgressBar = g_pImGuiHandler->AddProgressBarEvent("Loading Audio Banks..", static_cast<uint32_t>(filePaths.size()), &bankLoadingProgress, true);
 
-	Log("Started MBNK load.\n");
+	LOG_DEBUG(AUDIO, "Started MBNK load.\n");
 
 	for (const std::string& path : filePaths)
 	{
@@ -22,7 +24,7 @@ void HandleMBNKLoad(std::vector<std::string> filePaths)
 		}
 		else
 		{
-			Log("bank failed to load!\n");
+			LOG_ERROR(AUDIO, "bank failed to load!\n");
 			delete bank;
 		}
 
@@ -8,130 +8,246 @@
 #include <game/rtech/assets/model.h>
 #include <game/model/sourcemodel.h>
 
-void HandleMDLLoad(std::vector<std::string> filePaths)
+// assets built from one model file, registered and loaded together
+struct SourceModelLoad_t
 {
-    std::vector<uint64_t> guids; // assets to load
-    guids.reserve(filePaths.size());
+    CSourceModelAsset* model;
+    std::vector<CSourceSequenceAsset*> sequences;
+};
 
-    std::atomic<uint32_t> modelLoadingProgress = 0;
-    const ProgressBarEvent_t* const modelLoadProgressBar = g_pImGuiHandler->AddProgressBarEvent("Loading Model Files..", static_cast<uint32_t>(filePaths.size()), &modelLoadingProgress, true);
+// maps a model file and builds its model and sequence assets, nullptr if the file is invalid or unsupported
+CSourceModelAsset* const CreateSourceModelAssets(const std::string& path, std::vector<CSourceSequenceAsset*>& sequenceAssets)
+{
+    const CMappedFile file(path);
 
-    for (std::string& path : filePaths)
+    // enough to read the header length from either header layout
+    if (!file.IsOpen() || file.Size() < sizeof(int) * 21)
     {
-        if (!std::filesystem::exists(path))
-        {
-            assertm(false, "model file did not exist");
-            continue;
-        }
+        assertm(false, "model file did not exist");
+        return nullptr;
+    }
 
-        const size_t fileSize = std::filesystem::file_size(path);
-        std::unique_ptr<char[]> fileBuf = std::make_unique<char[]>(fileSize);
+    const studiohdr_short_t* const pStudioHdr = reinterpret_cast<const studiohdr_short_t* const>(file.Data());
 
-        StreamIO fileIn(path, eStreamIOMode::Read);
-        fileIn.R()->read(fileBuf.get(), fileSize);
+    if (pStudioHdr->id != MODEL_FILE_ID)
+    {
+        assertm(false, "invalid file");
+        return nullptr;
+    }
 
-        const studiohdr_short_t* const pStudioHdr = reinterpret_cast<const studiohdr_short_t* const>(fileBuf.get());
+    // only handle supported versions
+    switch (pStudioHdr->version)
+    {
+    case 52: // r1
+    case 53: // r2
+    case 63: // r1x360
+    {
+        break;
+    }
+    case 54: // r5 (should be pak only)
+    {
+        LOG_WARN(MODEL, "Studio version 54 is only supported through RPak export, skipping...\n");
+        return nullptr;
+    }
+    default:
+    {
+        LOG_WARN(MODEL, "Studio version %i is not supported, skipping...\n", pStudioHdr->version);
+        return nullptr;
+    }
+    }
 
-        if (pStudioHdr->id != MODEL_FILE_ID)
-        {
-            assertm(false, "invalid file");
-            continue;
-        }
+    if (pStudioHdr->length() <= 0 || static_cast<size_t>(pStudioHdr->length()) > file.Size())
+    {
+        assertm(false, "truncated model file");
+        return nullptr;
+    }
 
-        // only handle supported versions
-        switch (pStudioHdr->version)
-        {
-        case 52: // r1
-        case 53: // r2
-        case 63: // r1x360
-        {
-            break;
-        }
-        case 54: // r5 (should be pak only)
-        {
-            Log("Studio version 54 is only supported through RPak export, skipping...\n");
-            continue;
-        }
-        default:
+    // the asset copies the header out of the mapped view
+    CSourceModelAsset* const srcMdlAsset = new CSourceModelAsset(pStudioHdr);
+    CSourceModelSource* const srcMdlSource = static_cast<CSourceModelSource*>(srcMdlAsset->GetContainerFile<CAssetContainer>());
+
+    srcMdlSource->SetFilePath(path);
+
+    // parse sequences
+    switch (pStudioHdr->version)
+    {
+    case 52:
+    {
+        break;
+    }
+    case 53:
+    {
+        // use the model we stored so we don't point to bad data
+        r2::studiohdr_t* const pLocalHdr = reinterpret_cast<r2::studiohdr_t* const>(srcMdlAsset->GetAssetData());
+        const std::filesystem::path srcMdlPath(pStudioHdr->pszName());
+
+        uint64_t* sequences = new uint64_t[pLocalHdr->numlocalseq];
+        sequenceAssets.reserve(pLocalHdr->numlocalseq);
+
+        assertm(s_AssetTypePaths.contains(AssetType_t::SEQ), "somehow missing prefix");
+        const char* const s_SeqPrefix = s_AssetTypePaths.find(AssetType_t::SEQ)->second;
+
+        // sequence paths share the model's base path, only the label and extension get appended
+        std::string seqPath(std::format("{}/{}/{}/", s_SeqPrefix, srcMdlPath.parent_path().string(), srcMdlPath.stem().string()));
+        const size_t basePathLength = seqPath.length();
+
+        for (int i = 0; i < pLocalHdr->numlocalseq; i++)
         {
-            Log("Studio version %i is not supported, skipping...\n", pStudioHdr->version);
-            continue;
-        }
+            const r2::mstudioseqdesc_t* const pSeqdesc = pLocalHdr->pSeqdesc(i);
+
+            seqPath.resize(basePathLength);
+            seqPath.append(pSeqdesc->pszLabel());
+            seqPath.append(".seq");
+
+            CSourceSequenceAsset* const srcSeqAsset = new CSourceSequenceAsset(srcMdlAsset, pSeqdesc, seqPath);
+
+            sequenceAssets.push_back(srcSeqAsset);
+            sequences[i] = srcSeqAsset->GetAssetGUID();
         }
 
-        CSourceModelAsset* srcMdlAsset = new CSourceModelAsset(pStudioHdr);
-        CSourceModelSource* const srcMdlSource = static_cast<CSourceModelSource*>(srcMdlAsset->GetContainerFile<CAssetContainer>());
+        srcMdlAsset->SetSequenceList(sequences, pLocalHdr->numlocalseq);
 
-        srcMdlSource->SetFilePath(path);
+        break;
+    }
+    case 63:
+    {
+        break;
+    }
+    default:
+    {
+        assertm(false, "should not be hit");
+        break;
+    }
+    }
 
-        g_assetData.v_assets.emplace_back(srcMdlAsset->GetAssetGUID(), srcMdlAsset);
-        g_assetData.v_assetContainers.emplace_back(srcMdlSource);
-        guids.push_back(srcMdlAsset->GetAssetGUID());
+    return srcMdlAsset;
+}
 
-        // parse sequences
-        const std::filesystem::path srcMdlPath = (pStudioHdr->pszName());
+static void LoadSourceModelAssetBinding(CAsset* const asset)
+{
+    assertm(asset->GetAssetContainerType() == CAsset::ContainerType::MDL, "invalid container");
 
-        switch (pStudioHdr->version)
-        {
-        case 52:
+    if (auto it = g_assetData.m_assetTypeBindings.find(asset->GetAssetType()); it != g_assetData.m_assetTypeBindings.end())
+    {
+        if (it->second.loadFunc)
         {
-            break;
+            PROFILE_SCOPE_TYPE("load", asset->GetAssetType());
+            PROFILE_COUNTER_ADD(eProfileCounter::ASSETS_LOADED, 1);
+
+            it->second.loadFunc(asset->GetContainerFile<CAssetContainer>(), asset);
         }
-        case 53:
-        {
-            // use the model we stored so we don't point to bad data
-            r2::studiohdr_t* const pLocalHdr = reinterpret_cast<r2::studiohdr_t* const>(srcMdlAsset->GetAssetData());
+    }
+}
 
-            uint64_t* sequences = new uint64_t[pLocalHdr->numlocalseq];
+// models built by a worker before they are registered with the global asset data
+static constexpr size_t s_ModelRegisterBatchSize = 64ull;
 
-            assertm(s_AssetTypePaths.contains(AssetType_t::SEQ), "somehow missing prefix");
-            const char* const s_SeqPrefix = s_AssetTypePaths.find(AssetType_t::SEQ)->second;
-            const std::string basePath(std::format("{}/{}/{}", s_SeqPrefix, srcMdlPath.parent_path().string(), srcMdlPath.stem().string()));
+void HandleMDLLoad(std::vector<std::string> filePaths)
+{
+    PROFILE_SCOPE("load mdl files");
 
-            for (int i = 0; i < pLocalHdr->numlocalseq; i++)
-            {
-                const r2::mstudioseqdesc_t* const pSeqdesc = pLocalHdr->pSeqdesc(i);
-                const std::string seqPath = std::format("{}/{}.seq", basePath, pSeqdesc->pszLabel());
+    const uint32_t fileCount = static_cast<uint32_t>(filePaths.size());
+    const uint32_t threadCount = std::min(UtilsConfig->parseThreadCount, std::max(fileCount, 1u));
+
+    std::atomic<uint32_t> modelLoadingProgress = 0;
+    const ProgressBarEvent_t* const modelLoadProgressBar = g_pImGuiHandler->AddProgressBarEvent("Loading Model Files..", fileCount, &modelLoadingProgress, true);
 
-                CSourceSequenceAsset* srcSeqAsset = new CSourceSequenceAsset(srcMdlAsset, pSeqdesc, seqPath);
+    std::vector<SourceModelLoad_t> loads; // registered models, kept so nothing has to be looked up again
+    loads.reserve(fileCount);
 
-                const uint64_t guid = srcSeqAsset->GetAssetGUID();
-                g_assetData.v_assets.emplace_back(guid, srcSeqAsset);
-                guids.push_back(guid);
+    std::mutex registerMutex;
 
-                sequences[i] = guid;
-            }
+    // moves a worker's built models into the global asset data
+    auto registerBatch = [&registerMutex, &loads](std::vector<SourceModelLoad_t>& batch)
+    {
+        if (batch.empty())
+            return;
 
-            srcMdlAsset->SetSequenceList(sequences, pLocalHdr->numlocalseq);
+        std::lock_guard<std::mutex> lock(registerMutex);
 
-            break;
-        }
-        case 63:
+        for (SourceModelLoad_t& load : batch)
         {
-            break;
+            g_assetData.v_assets.emplace_back(load.model->GetAssetGUID(), load.model);
+            g_assetData.v_assetContainers.emplace_back(load.model->GetContainerFile<CAssetContainer>());
+
+            for (CSourceSequenceAsset* const srcSeqAsset : load.sequences)
+                g_assetData.v_assets.emplace_back(srcSeqAsset->GetAssetGUID(), srcSeqAsset);
+
+            loads.push_back(std::move(load));
         }
-        default:
+
+        batch.clear();
+    };
+
+    // map, validate and build the assets for each file
+    {
+        CParallelTask parallelBuildTask(threadCount);
+
+        std::atomic<uint32_t> fileIdx = 0;
+        parallelBuildTask.addTask([&filePaths, fileCount, &fileIdx, &modelLoadingProgress, &registerBatch]
         {
-            assertm(false, "should not be hit");
-            break;
-        }
-        }
+            std::vector<SourceModelLoad_t> batch;
+            batch.reserve(s_ModelRegisterBatchSize);
 
-        ++modelLoadingProgress;
-    }
+            while (fileIdx < fileCount)
+            {
+                const uint32_t fileToProcess = fileIdx++;
+                if (fileToProcess >= fileCount)
+                    continue;
 
-    g_pImGuiHandler->FinishProgressBarEvent(modelLoadProgressBar);
+                SourceModelLoad_t load;
+                load.model = CreateSourceModelAssets(filePaths[fileToProcess], load.sequences);
+
+                // skipped files count as loaded
+                if (!load.model)
+                {
+                    ++modelLoadingProgress;
+                    continue;
+                }
+
+                batch.push_back(std::move(load));
+
+                if (batch.size() >= s_ModelRegisterBatchSize)
+                    registerBatch(batch);
+            }
+
+            registerBatch(batch);
+        }, threadCount);
+
+        parallelBuildTask.execute();
+        parallelBuildTask.wait();
+    }
 
-    for (const uint64_t& guid : guids)
+    // load functions look up other assets (materials), so they only run once every model is registered
+    // the model is loaded before its sequences
     {
-        CAsset* const asset = g_assetData.FindAssetByGUID(guid);
+        CParallelTask parallelLoadTask(threadCount);
 
-        assertm(asset->GetAssetContainerType() == CAsset::ContainerType::MDL, "invalid container");
+        const uint32_t loadCount = static_cast<uint32_t>(loads.size());
 
-        if (auto it = g_assetData.m_assetTypeBindings.find(asset->GetAssetType()); it != g_assetData.m_assetTypeBindings.end())
+        std::atomic<uint32_t> loadIdx = 0;
+        parallelLoadTask.addTask([&loads, loadCount, &loadIdx, &modelLoadingProgress]
         {
-            if (it->second.loadFunc)
-                it->second.loadFunc(asset->GetContainerFile<CAssetContainer>(), asset);
-        }
+            while (loadIdx < loadCount)
+            {
+                const uint32_t loadToProcess = loadIdx++;
+                if (loadToProcess >= loadCount)
+                    continue;
+
+                const SourceModelLoad_t& load = loads[loadToProcess];
+
+                LoadSourceModelAssetBinding(load.model);
+
+                for (CSourceSequenceAsset* const srcSeqAsset : load.sequences)
+                    LoadSourceModelAssetBinding(srcSeqAsset);
+
+                ++modelLoadingProgress;
+            }
+        }, threadCount);
+
+        parallelLoadTask.execute();
+        parallelLoadTask.wait();
     }
-}
\ No newline at end of file
+
+    g_pImGuiHandler->FinishProgressBarEvent(modelLoadProgressBar);
+}
@@ -6,9 +6,14 @@
 #include <core/filehandling/export.h>
 
 #include <game/rtech/cpakfile.h>
+#include <core/cache/exportmanifest.h>
+
+extern ExportSettings_t g_ExportSettings;
 
 void HandlePakLoad(std::vector<std::string> filePaths)
 {
+    PROFILE_SCOPE("load rpak files");
+
     std::atomic<uint32_t> pakLoadingProgress = 0;
     const ProgressBarEvent_t* const pakLoadProgress = g_pImGuiHandler->AddProgressBarEvent("Loading Paks..", static_cast<uint32_t>(filePaths.size()), &pakLoadingProgress, true);
 
@@ -46,7 +51,7 @@ void HandlePakLoad(std::vector<std::string> filePaths)
                     g_assetData.m_pakPatchMaster = nullptr;
                 }
 
-                //Log("[PTCH] Found %lld patch entries.\n", g_assetData.m_patchMasterEntries.size());           
+                //LOG_DEBUG(PAK, "[PTCH] Found %lld patch entries.\n", g_assetData.m_patchMasterEntries.size());           
             }
         }
 
@@ -65,7 +70,7 @@ void HandlePakLoad(std::vector<std::string> filePaths)
                 const std::string topPatchFileName = std::format("{}({:02}).rpak", pakStem, patchVersion);
                 fsPath.replace_filename(topPatchFileName);
 
-                Log("Loading highest patch '%s' instead of requested file '%s'\n", topPatchFileName.c_str(), path.c_str());
+                LOG_INFO(PAK, "Loading highest patch '%s' instead of requested file '%s'\n", topPatchFileName.c_str(), path.c_str());
             }
         }
 
@@ -114,19 +119,56 @@ static void TraverseAssetDependencies(CPakAsset* const asset, std::deque<CPakAss
         cpyAssets.emplace_back(asset);
 }
 
-static void HandleExportBindingForAssetEx(CAsset* const asset)
+static const bool HandleExportBindingForAssetEx(CAsset* const asset)
 {
     if (auto it = g_assetData.m_assetTypeBindings.find(asset->GetAssetType()); it != g_assetData.m_assetTypeBindings.end())
     {
         if (it->second.e.exportFunc)
         {
-            const bool exported = it->second.e.exportFunc(asset, it->second.e.exportSetting);
+            PROFILE_SCOPE_TYPE("export", asset->GetAssetType());
+
+            const int exportSetting = it->second.e.exportSetting;
+
+            ExportManifestStamp_t stamp = {};
+            if (g_ExportSettings.exportIncremental)
+            {
+                CExportManifest::StampAsset(asset, exportSetting, stamp);
+
+                if (g_exportManifest.IsUpToDate(stamp))
+                {
+                    PROFILE_COUNTER_ADD(eProfileCounter::ASSETS_EXPORT_SKIPPED, 1);
+
+                    asset->SetExportedStatus(true);
+                    return true;
+                }
+            }
+
+            PROFILE_COUNTER_ADD(eProfileCounter::ASSETS_EXPORTED, 1);
+
+            const std::chrono::steady_clock::time_point exportStart = std::chrono::steady_clock::now();
+
+            CWrittenFileTracker writtenFiles;
+            const bool exported = it->second.e.exportFunc(asset, exportSetting);
             asset->SetExportedStatus(exported);
+
+            if (g_ExportSettings.exportIncremental)
+            {
+                if (exported)
+                    g_exportManifest.Add(stamp, writtenFiles.Files(), std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - exportStart).count());
+                else
+                    g_exportManifest.Remove(stamp);
+            }
+
+            return exported;
         }
     }
+
+    // no export function, nothing to fail
+    return true;
 }
 
-FORCEINLINE void HandleExportBindingForAsset(CAsset* const asset, const bool exportDependencies)
+// returns false if the asset or any of its dependencies failed to export
+FORCEINLINE const bool HandleExportBindingForAsset(CAsset* const asset, const bool exportDependencies)
 {
     // only pak assets have dependencies so don't try to export them with other types
     if (asset->GetAssetContainerType() == CAsset::ContainerType::PAK && exportDependencies)
@@ -134,13 +176,17 @@ FORCEINLINE void HandleExportBindingForAsset(CAsset* const asset, const bool exp
         std::deque<CPakAsset*> cpyAssets;
         TraverseAssetDependencies(static_cast<CPakAsset*>(asset), cpyAssets);
 
+        bool exported = true;
         for (CPakAsset* const dependency : cpyAssets)
         {
-            HandleExportBindingForAssetEx(dependency);
+            if (!HandleExportBindingForAssetEx(dependency))
+                exported = false;
         }
+
+        return exported;
     }
-    else
-        HandleExportBindingForAssetEx(asset);
+
+    return HandleExportBindingForAssetEx(asset);
 }
 
 void HandlePakAssetExportList(std::deque<CAsset*> selectedAssets, const bool exportDependencies)
@@ -0,0 +1,1042 @@
+#include <pch.h>
+#include <core/headless.h>
+
+#include <thirdparty/imgui/misc/imgui_utility.h>
+
+#include <core/utils/cli_parser.h>
+#include <core/filehandling/load.h>
+#include <core/filehandling/export.h>
+#include <core/filehandling/assetdiff.h>
+#include <core/cache/texturestore.h>
+#include <core/cache/exportmanifest.h>
+#include <core/selftest/selftest.h>
+#include <game/rtech/assets/shader.h>
+#include <game/rtech/assets/datatable_store.h>
+
+#include <regex>
+#include <optional>
+
+extern ExportSettings_t g_ExportSettings;
+
+// usage:
+// rsx.exe -headless -in <file|dir|glob> [-in ...] [-out <dir>] [-type txtr,matl] [-name <regex>] [-guid 0x1234,@guids.txt]
+//         [-format txtr=2] [-set ExportPathsFull=1] [-threads <n>] [-deps] [-list] [-json] [-trace <file>] [-profile] [-log <file>]
+//         [-dtbl-query <expr> [-dtbl-select <list>] [-dtbl-limit <n>]] [-diff <file|dir|glob> [-diff ...]]
+// rsx.exe -headless -rebuild-shaders <dir>
+// rsx.exe -headless -selftest [filter] | -bench [filter] [-bench-scale <n>] [-seed <n>] [-json]
+static const char* const s_HeadlessUsage =
+    "usage: rsx -headless -in <file|dir|glob> [options]\n"
+    "  -in <path>          input file, directory or glob (e.g. paks/Win64/*.rpak, models/**/*.mdl), can be repeated\n"
+    "  -out <dir>          directory to export into (default: working directory)\n"
+    "  -type <list>        only export these asset types, comma separated (e.g. txtr,matl,mdl_)\n"
+    "  -name <regex>       only export assets whose name matches this regex (case insensitive)\n"
+    "  -guid <list>        only export these guids, comma separated. @file reads one guid per line\n"
+    "  -format <type=fmt>  export format for a type, by index or name (e.g. txtr=2, txtr=\"PNG (All Mips)\"), can be repeated\n"
+    "  -set <key=value>    setting override, same keys as imgui.ini [ExportSettings] and [UtilSettings] (e.g. ExportPathsFull=1, RamenCodec=4), can be repeated\n"
+    "  -threads <n>        number of threads used for parsing and exporting\n"
+    "  -deps               export asset dependencies\n"
+    "  -list               list matching assets instead of exporting them\n"
+    "  -json               print progress as one json object per line\n"
+    "  -trace <file>       record load/export stage timings and write them as a chrome trace (chrome://tracing, ui.perfetto.dev)\n"
+    "  -profile            record load/export stage timings and print a summary table at the end\n"
+    "  -log <file>         also write log messages to this file, filtered by the LogLevel and LogCategories settings\n"
+    "  -dtbl-query <expr>  query the rows of every loaded datatable instead of exporting, e.g. \"damage > 50 && weapon ~ smg\"\n"
+    "                      operators are = != < <= > >= and ~ (contains), column * matches any column\n"
+    "  -dtbl-select <list> columns to print for -dtbl-query, comma separated (default: every column)\n"
+    "  -dtbl-limit <n>     max rows printed for -dtbl-query (default: 1000)\n"
+    "  -diff <path>        files of an older build to compare -in against, same forms as -in, can be repeated\n"
+    "                      prints the assets that were added, removed or changed and only lists/exports the added and changed ones\n"
+    "  -rebuild-shaders <dir>  write the bytecode of shaders exported as \"Raw (Deduplicated)\" under dir back out per shader, nothing is loaded\n"
+    "  -selftest [filter]  run the built in checks instead of loading anything, filter matches test names with * and ? (e.g. pak.*)\n"
+    "  -bench [filter]     run the built in benchmarks, same filter as -selftest\n"
+    "  -bench-scale <n>    multiply benchmark input sizes by n (default: 1)\n"
+    "  -seed <n>           seed for the random input of -selftest and -bench (default: 1)\n"
+    "  -list-selftests     print the names of every test and benchmark\n";
+
+class CHeadlessReporter
+{
+public:
+    CHeadlessReporter(const bool json) : useJson(json) {};
+
+    void Message(const char* const event, const std::string& msg)
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+
+        if (useJson)
+            printf("{\"event\":\"%s\",\"message\":\"%s\"}\n", event, EscapeJson(msg).c_str());
+        else
+            printf("[%s] %s\n", event, msg.c_str());
+
+        fflush(stdout);
+    }
+
+    void Asset(const char* const event, const CAsset* const asset, const uint32_t index, const uint32_t total, const bool success)
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+
+        const std::string type = fourCCToString(asset->GetAssetType());
+
+        if (useJson)
+        {
+            printf("{\"event\":\"%s\",\"index\":%u,\"total\":%u,\"guid\":\"0x%llX\",\"type\":\"%s\",\"name\":\"%s\",\"success\":%s}\n",
+                event, index, total, asset->GetAssetGUID(), EscapeJson(type).c_str(), EscapeJson(asset->GetAssetName()).c_str(), success ? "true" : "false");
+        }
+        else
+        {
+            printf("[%s] %u/%u %s 0x%llX %s%s\n", event, index, total, type.c_str(), asset->GetAssetGUID(), asset->GetAssetName().data(), success ? "" : " (FAILED)");
+        }
+
+        fflush(stdout);
+    }
+
+    void Summary(const uint32_t total, const uint32_t failed, const double seconds)
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+
+        if (useJson)
+            printf("{\"event\":\"summary\",\"total\":%u,\"failed\":%u,\"seconds\":%.3f}\n", total, failed, seconds);
+        else
+            printf("[summary] %u assets, %u failed, %.3fs\n", total, failed, seconds);
+
+        fflush(stdout);
+    }
+
+    void Profile()
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+
+        const std::vector<ProfileSummary_t> summary = g_profiler.GetSummary();
+
+        if (useJson)
+        {
+            for (const ProfileSummary_t& entry : summary)
+            {
+                printf("{\"event\":\"profile\",\"name\":\"%s\",\"count\":%llu,\"totalMs\":%.3f,\"avgMs\":%.3f,\"maxMs\":%.3f}\n",
+                    EscapeJson(entry.name).c_str(), entry.count, NsToMs(entry.totalNs), NsToMs(entry.totalNs) / static_cast<double>(entry.count), NsToMs(entry.maxNs));
+            }
+
+            for (uint8_t i = 0; i < static_cast<uint8_t>(eProfileCounter::_COUNT); ++i)
+            {
+                const eProfileCounter counter = static_cast<eProfileCounter>(i);
+                printf("{\"event\":\"counter\",\"name\":\"%s\",\"value\":%llu}\n", CProfiler::GetCounterName(counter), g_profiler.GetCounter(counter));
+            }
+        }
+        else
+        {
+            printf("[profile] %-40s %10s %12s %10s %10s\n", "stage", "count", "total ms", "avg ms", "max ms");
+
+            for (const ProfileSummary_t& entry : summary)
+            {
+                printf("[profile] %-40s %10llu %12.3f %10.3f %10.3f\n",
+                    entry.name.c_str(), entry.count, NsToMs(entry.totalNs), NsToMs(entry.totalNs) / static_cast<double>(entry.count), NsToMs(entry.maxNs));
+            }
+
+            for (uint8_t i = 0; i < static_cast<uint8_t>(eProfileCounter::_COUNT); ++i)
+            {
+                const eProfileCounter counter = static_cast<eProfileCounter>(i);
+                printf("[counter] %-40s %10llu\n", CProfiler::GetCounterName(counter), g_profiler.GetCounter(counter));
+            }
+        }
+
+        fflush(stdout);
+    }
+
+    void DatatableRow(const DatatableQueryRow_t& row)
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+
+        if (useJson)
+        {
+            printf("{\"event\":\"dtbl_row\",\"guid\":\"0x%llX\",\"table\":\"%s\",\"row\":%u,\"cells\":{", row.guid, EscapeJson(row.table).c_str(), row.row);
+
+            for (size_t i = 0; i < row.cells.size(); ++i)
+                printf("%s\"%s\":\"%s\"", i ? "," : "", EscapeJson(row.cells[i].first).c_str(), EscapeJson(row.cells[i].second).c_str());
+
+            printf("}}\n");
+        }
+        else
+        {
+            printf("[dtbl_row] %s [%u]", std::string(row.table).c_str(), row.row);
+
+            for (const auto& cell : row.cells)
+                printf(" %s=%s", std::string(cell.first).c_str(), cell.second.c_str());
+
+            printf("\n");
+        }
+
+        fflush(stdout);
+    }
+
+    void DiffAsset(const AssetDiffEntry_t& entry)
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+
+        const std::string type = fourCCToString(entry.type);
+
+        if (useJson)
+        {
+            printf("{\"event\":\"diff\",\"change\":\"%s\",\"guid\":\"0x%llX\",\"type\":\"%s\",\"name\":\"%s\"}\n",
+                AssetDiffChangeToString(entry.change), entry.guid, EscapeJson(type).c_str(), EscapeJson(entry.name).c_str());
+        }
+        else
+        {
+            printf("[diff] %-7s %s 0x%llX %s\n", AssetDiffChangeToString(entry.change), type.c_str(), entry.guid, entry.name.c_str());
+        }
+
+        fflush(stdout);
+    }
+
+    void DiffType(const uint32_t type, const AssetDiffTypeStats_t& stats)
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+
+        const std::string typeName = fourCCToString(type);
+
+        if (useJson)
+        {
+            printf("{\"event\":\"diff_type\",\"type\":\"%s\",\"added\":%u,\"removed\":%u,\"changed\":%u,\"unchanged\":%u}\n",
+                EscapeJson(typeName).c_str(), stats.added, stats.removed, stats.changed, stats.unchanged);
+        }
+        else
+        {
+            printf("[diff_type] %s: %u added, %u removed, %u changed, %u unchanged\n", typeName.c_str(), stats.added, stats.removed, stats.changed, stats.unchanged);
+        }
+
+        fflush(stdout);
+    }
+
+    void SelfTest(const SelfTestResult_t& result)
+    {
+        std::unique_lock<std::mutex> lock(outputMutex);
+
+        const char* const event = result.test->kind == eSelfTestKind::BENCHMARK ? "bench" : "selftest";
+
+        if (useJson)
+        {
+            printf("{\"event\":\"%s\",\"name\":\"%s\",\"passed\":%s,\"checks\":%u,\"failures\":%u,\"seconds\":%.3f,\"metrics\":{",
+                event, EscapeJson(result.test->name).c_str(), result.passed ? "true" : "false", result.checks, result.failures, result.seconds);
+
+            for (size_t i = 0; i < result.metrics.size(); ++i)
+                printf("%s\"%s\":{\"value\":%.6g,\"unit\":\"%s\"}", i ? "," : "", EscapeJson(result.metrics[i].name).c_str(), result.metrics[i].value, EscapeJson(result.metrics[i].unit).c_str());
+
+            printf("},\"messages\":[");
+
+            for (size_t i = 0; i < result.messages.size(); ++i)
+                printf("%s\"%s\"", i ? "," : "", EscapeJson(result.messages[i]).c_str());
+
+            printf("]}\n");
+        }
+        else
+        {
+            printf("[%s] %-48s %s (%u checks, %.3fs)\n", event, result.test->name, result.passed ? "ok" : "FAILED", result.checks, result.seconds);
+
+            for (const SelfTestMetric_t& metric : result.metrics)
+                printf("[%s]     %-44s %14.3f %s\n", event, metric.name.c_str(), metric.value, metric.unit.c_str());
+
+            for (const std::string& message : result.messages)
+                printf("[%s]     %s\n", event, message.c_str());
+        }
+
+        fflush(stdout);
+    }
+
+    static std::string EscapeJson(const std::string_view str)
+    {
+        std::string out;
+        out.reserve(str.length());
+
+        for (const char c : str)
+        {
+            switch (c)
+            {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+            {
+                if (static_cast<unsigned char>(c) < 0x20)
+                    out += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+                else
+                    out += c;
+
+                break;
+            }
+            }
+        }
+
+        return out;
+    }
+
+private:
+    static const double NsToMs(const int64_t ns) { return static_cast<double>(ns) / 1000000.0; };
+
+    std::mutex outputMutex;
+    bool useJson;
+};
+
+// simple '*' and '?' matching, case insensitive as windows paths are
+const bool GlobMatch(const char* pattern, const char* str)
+{
+    const char* starPattern = nullptr;
+    const char* starStr = nullptr;
+
+    while (*str)
+    {
+        if (*pattern == '*')
+        {
+            starPattern = pattern++;
+            starStr = str;
+        }
+        else if (*pattern == '?' || tolower(static_cast<unsigned char>(*pattern)) == tolower(static_cast<unsigned char>(*str)))
+        {
+            ++pattern;
+            ++str;
+        }
+        else if (starPattern)
+        {
+            pattern = starPattern + 1;
+            str = ++starStr;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == '*')
+        ++pattern;
+
+    return *pattern == '\0';
+}
+
+void ExpandInputPath(const std::filesystem::path& launchDirectory, const std::string& input, std::vector<std::string>& filePaths)
+{
+    std::filesystem::path path(input);
+    if (path.is_relative())
+        path = launchDirectory / path;
+
+    std::error_code ec;
+    if (input.find_first_of("*?") == std::string::npos)
+    {
+        if (std::filesystem::is_regular_file(path, ec))
+        {
+            filePaths.emplace_back(path.lexically_normal().string());
+        }
+        else if (std::filesystem::is_directory(path, ec))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(path, ec))
+            {
+                if (entry.is_regular_file(ec) && IsLoadableFile(entry.path()))
+                    filePaths.emplace_back(entry.path().lexically_normal().string());
+            }
+        }
+
+        return;
+    }
+
+    const std::string pattern = path.filename().string();
+    std::filesystem::path directory = path.parent_path();
+
+    const bool recursive = directory.filename() == "**";
+    if (recursive)
+        directory = directory.parent_path();
+
+    if (directory.string().find_first_of("*?") != std::string::npos)
+    {
+        LOG_WARN(GENERAL, "wildcards are only supported in the file name of an input path: %s\n", input.c_str());
+        return;
+    }
+
+    auto matchEntry = [&](const std::filesystem::directory_entry& entry)
+        {
+            if (entry.is_regular_file(ec) && GlobMatch(pattern.c_str(), entry.path().filename().string().c_str()))
+                filePaths.emplace_back(entry.path().lexically_normal().string());
+        };
+
+    if (recursive)
+    {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, ec))
+            matchEntry(entry);
+    }
+    else
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+            matchEntry(entry);
+    }
+}
+
+void ExpandInputPaths(const std::filesystem::path& launchDirectory, const std::vector<std::string>& inputs, std::vector<std::string>& filePaths)
+{
+    for (const std::string& input : inputs)
+        ExpandInputPath(launchDirectory, input, filePaths);
+
+    // the same file can be matched by more than one glob
+    std::sort(filePaths.begin(), filePaths.end());
+    filePaths.erase(std::unique(filePaths.begin(), filePaths.end()), filePaths.end());
+}
+
+const uint32_t TypeFromString(const std::string& str)
+{
+    uint32_t type = 0u;
+    for (size_t i = 0; i < str.length() && i < 4; ++i)
+        type |= static_cast<uint32_t>(static_cast<uint8_t>(str[i])) << (i * 8);
+
+    return type;
+}
+
+void SplitList(const std::string& list, std::vector<std::string>& out)
+{
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        // trim spaces so "txtr, matl" works
+        const size_t start = item.find_first_not_of(" \t");
+        const size_t end = item.find_last_not_of(" \t\r");
+        if (start != std::string::npos)
+            out.emplace_back(item.substr(start, end - start + 1));
+    }
+}
+
+const bool ParseGuidList(const std::string& list, std::unordered_set<uint64_t>& guids)
+{
+    std::vector<std::string> items;
+    SplitList(list, items);
+
+    for (const std::string& item : items)
+    {
+        // guid list file, one per line
+        if (item[0] == '@')
+        {
+            std::ifstream file(item.substr(1));
+            if (!file.is_open())
+                return false;
+
+            std::string line;
+            while (std::getline(file, line))
+            {
+                if (!line.empty() && !ParseGuidList(line, guids))
+                    return false;
+            }
+
+            continue;
+        }
+
+        char* end = nullptr;
+        const uint64_t guid = strtoull(item.c_str(), &end, 0);
+        if (end == item.c_str() || *end != '\0')
+            return false;
+
+        guids.insert(guid);
+    }
+
+    return true;
+}
+
+static const bool ParseBoolSetting(const char* const value)
+{
+    return strcmp(value, "0") != 0 && _stricmp(value, "false") != 0;
+}
+
+// keys are kept the same as the ones saved in imgui.ini
+static const bool ApplyExportSettingOverride(const std::string& setting)
+{
+    const size_t split = setting.find('=');
+    if (split == std::string::npos)
+        return false;
+
+    const std::string key = setting.substr(0, split);
+    const char* const value = setting.c_str() + split + 1;
+
+    if (key == "ExportPathsFull")                   g_ExportSettings.exportPathsFull = ParseBoolSetting(value);
+    else if (key == "ExportAssetDeps")              g_ExportSettings.exportAssetDeps = ParseBoolSetting(value);
+    else if (key == "ExportIncremental")            g_ExportSettings.exportIncremental = ParseBoolSetting(value);
+    else if (key == "ExportTextureNameSetting")     g_ExportSettings.exportTextureNameSetting = std::min(static_cast<uint32_t>(atoi(value)), static_cast<uint32_t>(eTextureExportName::TXTR_NAME_COUNT - 1));
+    else if (key == "ExportNormalRecalcSetting")    g_ExportSettings.exportNormalRecalcSetting = std::min(static_cast<uint32_t>(atoi(value)), static_cast<uint32_t>(eNormalExportRecalc::NML_RECALC_COUNT - 1));
+    else if (key == "ExportMaterialTextures")       g_ExportSettings.exportMaterialTextures = ParseBoolSetting(value);
+    else if (key == "ExportTextureDedupe")          g_ExportSettings.exportTextureDedupe = ParseBoolSetting(value);
+    else if (key == "QCMajorVersion")               g_ExportSettings.qcMajorVersion = static_cast<uint16_t>(atoi(value));
+    else if (key == "QCMinorVersion")               g_ExportSettings.qcMinorVersion = static_cast<uint16_t>(atoi(value));
+    else if (key == "ExportRigSequences")           g_ExportSettings.exportRigSequences = ParseBoolSetting(value);
+    else if (key == "ExportModelSkin")              g_ExportSettings.exportModelSkin = ParseBoolSetting(value);
+    else if (key == "ExportTruncatedMaterials")     g_ExportSettings.exportModelMatsTruncated = ParseBoolSetting(value);
+    else if (key == "ExportSeqKeyReduction")        g_ExportSettings.exportSeqKeyReduction = ParseBoolSetting(value);
+    else if (key == "ExportSeqKeyPosTolerance")     g_ExportSettings.exportSeqKeyPosTolerance = std::max(static_cast<float>(atof(value)), 0.0f);
+    else if (key == "ExportSeqKeyRotTolerance")     g_ExportSettings.exportSeqKeyRotTolerance = std::clamp(static_cast<float>(atof(value)), 0.0f, 180.0f);
+    else if (key == "ExportSeqKeyScaleTolerance")   g_ExportSettings.exportSeqKeyScaleTolerance = std::max(static_cast<float>(atof(value)), 0.0f);
+    else if (key == "ExportAudioFlacLevel")         g_ExportSettings.exportAudioFlacLevel = std::min(static_cast<uint32_t>(atoi(value)), 8u);
+    else if (key == "ExportAudioFlacBitDepth")      g_ExportSettings.exportAudioFlacBitDepth = std::min(static_cast<uint32_t>(atoi(value)), static_cast<uint32_t>(eAudioFlacBitDepth::AUDIO_FLAC_BITS_COUNT - 1));
+    else if (key == "PreviewedSkinIndex")           g_ExportSettings.previewedSkinIndex = static_cast<uint32_t>(atoi(value));
+    else
+        return false;
+
+    return true;
+}
+
+// [utils] keys from imgui.ini
+static const bool ApplyUtilSettingOverride(const std::string& setting)
+{
+    const size_t split = setting.find('=');
+    if (split == std::string::npos)
+        return false;
+
+    const std::string key = setting.substr(0, split);
+    const char* const value = setting.c_str() + split + 1;
+
+    if (key == "ParseThreads")                      UtilsConfig->parseThreadCount = std::max(static_cast<uint32_t>(atoi(value)), 1u);
+    else if (key == "ExportThreads")                UtilsConfig->exportThreadCount = std::max(static_cast<uint32_t>(atoi(value)), 1u);
+    else if (key == "RamenCodec")
+    {
+        const uint32_t codec = static_cast<uint32_t>(atoi(value));
+        if (codec >= static_cast<uint32_t>(eRamenCodec::_COUNT))
+            return false;
+
+        g_RamenSettings.codec = static_cast<eRamenCodec>(codec);
+        g_RamenSettings.level = CRamen::DefaultCodecLevel(g_RamenSettings.codec);
+    }
+    else if (key == "RamenLevel")                   g_RamenSettings.level = atoi(value);
+    else if (key == "RamenBudgetMB")                g_RamenSettings.budgetMB = static_cast<uint32_t>(atoi(value));
+    else if (key == "RamenCacheMB")                 g_RamenSettings.cacheMB = static_cast<uint32_t>(atoi(value));
+    else if (key == "RamenSpill")                   g_RamenSettings.spill = ParseBoolSetting(value);
+    else if (key == "LogLevel")
+    {
+        const uint32_t level = static_cast<uint32_t>(atoi(value));
+        if (level >= static_cast<uint32_t>(eLogLevel::_COUNT))
+            return false;
+
+        g_logger.SetLevel(static_cast<eLogLevel>(level));
+    }
+    else if (key == "LogCategories")                g_logger.SetCategoryMask(static_cast<uint32_t>(strtoul(value, nullptr, 16)));
+    else if (key == "LogConsole")                   g_logger.SetConsoleOutput(ParseBoolSetting(value));
+    else if (key == "LogFile")                      return g_logger.SetFile(value);
+    else
+        return false;
+
+    return true;
+}
+
+// format can either be the index of the setting or its display name
+static const bool ApplyExportFormatOverride(const std::string& format)
+{
+    const size_t split = format.find('=');
+    if (split == std::string::npos)
+        return false;
+
+    const uint32_t type = TypeFromString(format.substr(0, split));
+    const std::string value = format.substr(split + 1);
+
+    const auto it = g_assetData.m_assetTypeBindings.find(type);
+    if (it == g_assetData.m_assetTypeBindings.end() || !it->second.e.exportSettingArr)
+        return false;
+
+    for (size_t i = 0; i < it->second.e.exportSettingArrSize; ++i)
+    {
+        if (_stricmp(it->second.e.exportSettingArr[i], value.c_str()) == 0)
+        {
+            it->second.e.exportSetting = static_cast<int>(i);
+            return true;
+        }
+    }
+
+    char* end = nullptr;
+    const unsigned long idx = strtoul(value.c_str(), &end, 10);
+    if (end == value.c_str() || *end != '\0' || idx >= it->second.e.exportSettingArrSize)
+        return false;
+
+    it->second.e.exportSetting = static_cast<int>(idx);
+    return true;
+}
+
+// the release build is a windows subsystem app, so it has no console unless we borrow the one we were launched from
+static void AttachParentConsole()
+{
+    const HANDLE stdOut = GetStdHandle(STD_OUTPUT_HANDLE);
+
+    // output is already redirected to a file or pipe
+    if (stdOut && stdOut != INVALID_HANDLE_VALUE && GetFileType(stdOut) != FILE_TYPE_UNKNOWN)
+        return;
+
+    if (AttachConsole(ATTACH_PARENT_PROCESS))
+    {
+        FILE* stream = nullptr;
+        freopen_s(&stream, "CONOUT$", "w", stdout);
+        freopen_s(&stream, "CONOUT$", "w", stderr);
+    }
+}
+
+const bool IsHeadlessRun(const CCommandLine* const cli)
+{
+    return cli->HasParam("-headless") != -1;
+}
+
+const int HandleHeadlessRun(const CCommandLine* const cli, const std::filesystem::path& launchDirectory)
+{
+    AttachParentConsole();
+
+    CHeadlessReporter reporter(cli->HasParam("-json") != -1);
+
+    if (cli->HasParam("-help") != -1)
+    {
+        printf("%s", s_HeadlessUsage);
+        return HEADLESS_EXIT_SUCCESS;
+    }
+
+    if (cli->HasParam("-rebuild-shaders") != -1)
+    {
+        const char* const dir = cli->GetParamArgument("-rebuild-shaders");
+        if (!dir)
+        {
+            reporter.Message("error", "-rebuild-shaders requires a directory");
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+
+        const std::filesystem::path shaderDirectory = std::filesystem::path(dir).is_relative() ? launchDirectory / dir : std::filesystem::path(dir);
+
+        uint32_t rebuiltShaders = 0u;
+        uint32_t failedShaders = 0u;
+        if (!ReconstructShaderExports(shaderDirectory, rebuiltShaders, failedShaders))
+        {
+            reporter.Message("error", std::format("'{}' is not a directory", shaderDirectory.string()));
+            return HEADLESS_EXIT_NO_INPUT;
+        }
+
+        reporter.Message("shader_blobs", std::format("rebuilt {} shaders, {} with missing blobs", rebuiltShaders, failedShaders));
+        return failedShaders > 0u ? HEADLESS_EXIT_EXPORT_FAILED : HEADLESS_EXIT_SUCCESS;
+    }
+
+    // parse everything before loading, bad arguments should fail fast
+    std::unordered_set<uint32_t> typeFilter;
+    if (const char* const types = cli->GetParamArgument("-type"))
+    {
+        std::vector<std::string> items;
+        SplitList(types, items);
+
+        for (const std::string& item : items)
+            typeFilter.insert(TypeFromString(item));
+    }
+
+    std::unordered_set<uint64_t> guidFilter;
+    if (const char* const guids = cli->GetParamArgument("-guid"))
+    {
+        if (!ParseGuidList(guids, guidFilter))
+        {
+            reporter.Message("error", std::format("invalid guid list '{}'", guids));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+    }
+
+    std::optional<std::regex> nameFilter;
+    if (const char* const name = cli->GetParamArgument("-name"))
+    {
+        try
+        {
+            nameFilter.emplace(name, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+        }
+        catch (const std::regex_error&)
+        {
+            reporter.Message("error", std::format("invalid name regex '{}'", name));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+    }
+
+    for (const std::string& setting : cli->GetParamArguments("-set"))
+    {
+        if (!ApplyExportSettingOverride(setting) && !ApplyUtilSettingOverride(setting))
+        {
+            reporter.Message("error", std::format("invalid setting '{}'", setting));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+    }
+
+    for (const std::string& format : cli->GetParamArguments("-format"))
+    {
+        if (!ApplyExportFormatOverride(format))
+        {
+            reporter.Message("error", std::format("invalid export format '{}'", format));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+    }
+
+    if (const char* const threads = cli->GetParamArgument("-threads"))
+    {
+        const uint32_t threadCount = static_cast<uint32_t>(atoi(threads));
+        if (threadCount == 0u)
+        {
+            reporter.Message("error", std::format("invalid thread count '{}'", threads));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+
+        UtilsConfig->parseThreadCount = threadCount;
+        UtilsConfig->exportThreadCount = threadCount;
+    }
+
+    std::filesystem::path tracePath;
+    if (cli->HasParam("-trace") != -1)
+    {
+        const char* const trace = cli->GetParamArgument("-trace");
+        if (!trace)
+        {
+            reporter.Message("error", "-trace requires a file path");
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+
+        tracePath = std::filesystem::path(trace).is_relative() ? launchDirectory / trace : std::filesystem::path(trace);
+    }
+
+    const bool printProfile = cli->HasParam("-profile") != -1;
+
+    if (cli->HasParam("-log") != -1)
+    {
+        const char* const log = cli->GetParamArgument("-log");
+        if (!log)
+        {
+            reporter.Message("error", "-log requires a file path");
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+
+        const std::filesystem::path logPath = std::filesystem::path(log).is_relative() ? launchDirectory / log : std::filesystem::path(log);
+        if (!g_logger.SetFile(logPath.string()))
+        {
+            reporter.Message("error", std::format("failed to open log file '{}'", logPath.string()));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+    }
+
+    if (cli->HasParam("-list-selftests") != -1)
+    {
+        for (const eSelfTestKind kind : { eSelfTestKind::TEST, eSelfTestKind::BENCHMARK })
+        {
+            std::vector<std::string> names;
+            ListSelfTests(kind, names);
+
+            for (const std::string& name : names)
+                reporter.Message(kind == eSelfTestKind::BENCHMARK ? "bench" : "selftest", name);
+        }
+
+        return HEADLESS_EXIT_SUCCESS;
+    }
+
+    // nothing is loaded for these, each test makes its own input
+    if (cli->HasParam("-selftest") != -1 || cli->HasParam("-bench") != -1)
+    {
+        const bool bench = cli->HasParam("-bench") != -1;
+        const char* const filterArg = cli->GetParamArgument(bench ? "-bench" : "-selftest");
+        const std::string filter = filterArg && filterArg[0] != '-' ? filterArg : "";
+
+        uint64_t seed = 1ull;
+        if (const char* const seedArg = cli->GetParamArgument("-seed"))
+            seed = strtoull(seedArg, nullptr, 0);
+
+        uint32_t scale = 1u;
+        if (const char* const scaleArg = cli->GetParamArgument("-bench-scale"))
+        {
+            scale = static_cast<uint32_t>(atoi(scaleArg));
+            if (scale == 0u)
+            {
+                reporter.Message("error", std::format("invalid benchmark scale '{}'", scaleArg));
+                return HEADLESS_EXIT_BAD_ARGS;
+            }
+        }
+
+        uint32_t total = 0u;
+        uint32_t failed = 0u;
+
+        const bool passed = RunSelfTests(bench ? eSelfTestKind::BENCHMARK : eSelfTestKind::TEST,
+            [&filter](const char* const name) { return filter.empty() || GlobMatch(filter.c_str(), name); }, seed, scale,
+            [&reporter, &total, &failed](const SelfTestResult_t& result)
+            {
+                ++total;
+                if (!result.passed)
+                    ++failed;
+
+                reporter.SelfTest(result);
+            });
+
+        if (total == 0u)
+        {
+            reporter.Message("error", std::format("no {} matched '{}'", bench ? "benchmarks" : "tests", filter));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+
+        reporter.Message(bench ? "bench" : "selftest", std::format("{} of {} passed", total - failed, total));
+        return passed ? HEADLESS_EXIT_SUCCESS : HEADLESS_EXIT_SELFTEST_FAILED;
+    }
+
+    const char* const dtblQuery = cli->GetParamArgument("-dtbl-query");
+    DatatableQuery_t datatableQuery;
+    if (dtblQuery)
+    {
+        std::string error;
+        if (!DatatableQuery_t::Parse(dtblQuery, datatableQuery, error))
+        {
+            reporter.Message("error", std::format("invalid datatable query '{}': {}", dtblQuery, error));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+
+        if (const char* const select = cli->GetParamArgument("-dtbl-select"))
+            SplitList(select, datatableQuery.select);
+
+        if (const char* const limit = cli->GetParamArgument("-dtbl-limit"))
+        {
+            const long long limitValue = atoll(limit);
+            if (limitValue <= 0)
+            {
+                reporter.Message("error", std::format("invalid datatable query limit '{}'", limit));
+                return HEADLESS_EXIT_BAD_ARGS;
+            }
+
+            datatableQuery.limit = static_cast<size_t>(limitValue);
+        }
+    }
+
+    std::vector<std::string> filePaths;
+    ExpandInputPaths(launchDirectory, cli->GetParamArguments("-in"), filePaths);
+
+    if (filePaths.empty())
+    {
+        reporter.Message("error", "no input files matched");
+        return HEADLESS_EXIT_NO_INPUT;
+    }
+
+    const bool diffBuilds = cli->HasParam("-diff") != -1;
+
+    std::vector<std::string> baselinePaths;
+    ExpandInputPaths(launchDirectory, cli->GetParamArguments("-diff"), baselinePaths);
+
+    if (diffBuilds && baselinePaths.empty())
+    {
+        reporter.Message("error", "no -diff files matched");
+        return HEADLESS_EXIT_NO_INPUT;
+    }
+
+    // exporters write relative to the working directory
+    std::filesystem::path outDirectory = launchDirectory;
+    if (const char* const out = cli->GetParamArgument("-out"))
+    {
+        outDirectory = std::filesystem::path(out).is_relative() ? launchDirectory / out : std::filesystem::path(out);
+
+        if (!CreateDirectories(outDirectory))
+        {
+            reporter.Message("error", std::format("failed to create output directory '{}'", outDirectory.string()));
+            return HEADLESS_EXIT_BAD_ARGS;
+        }
+    }
+
+    std::filesystem::current_path(outDirectory);
+
+    // png export goes through wic which needs com, export threads join this apartment implicitly
+    const HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+    // writes out whatever was recorded, every return past this point goes through here
+    const auto finishProfiling = [&tracePath, printProfile, &reporter]()
+        {
+            if (!g_profiler.IsEnabled())
+                return;
+
+            g_profiler.SetEnabled(false);
+
+            if (!tracePath.empty())
+            {
+                if (g_profiler.WriteChromeTrace(tracePath))
+                    reporter.Message("trace", std::format("wrote trace to '{}'", tracePath.string()));
+                else
+                    reporter.Message("error", std::format("failed to write trace to '{}'", tracePath.string()));
+            }
+
+            if (printProfile)
+                reporter.Profile();
+        };
+
+    if (!tracePath.empty() || printProfile)
+        g_profiler.SetEnabled(true);
+
+    // the old build is fingerprinted first and unloaded again, only one build is loaded at a time
+    AssetFingerprintSet_t baselineSet;
+    std::vector<std::string> diffPaths;
+    if (diffBuilds)
+    {
+        reporter.Message("diff", std::format("fingerprinting {} baseline files", baselinePaths.size()));
+
+        AssetFingerprintStats_t baselineStats = {};
+        FingerprintFileSet(baselinePaths, baselineSet, baselineStats);
+
+        reporter.Message("diff", std::format("baseline has {} assets in {} files ({} from the fingerprint index), {:.3f}s",
+            baselineSet.size(), baselineStats.files, baselineStats.cachedFiles, static_cast<double>(baselineStats.elapsedNs) / 1e9));
+
+        diffPaths = filePaths;
+    }
+
+    const auto loadStart = std::chrono::high_resolution_clock::now();
+    reporter.Message("load", std::format("loading {} files", filePaths.size()));
+
+    // paks are fingerprinted as they load, while their pages are still as they were in the file
+    SetPakFingerprintCapture(diffBuilds);
+    HandleFileLoad(std::move(filePaths));
+    SetPakFingerprintCapture(false);
+
+    const double loadSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - loadStart).count();
+    reporter.Message("load", std::format("loaded {} containers, {} assets in {:.3f}s", g_assetData.v_assetContainers.size(), g_assetData.v_assets.size(), loadSeconds));
+
+    if (g_assetData.v_assetContainers.empty())
+    {
+        reporter.Message("error", "failed to load any input files");
+        finishProfiling();
+
+        if (SUCCEEDED(comResult))
+            CoUninitialize();
+
+        return HEADLESS_EXIT_LOAD_FAILED;
+    }
+
+    if (dtblQuery)
+    {
+        g_datatableStore.Build();
+        reporter.Message("dtbl_store", std::format("{} datatables, {} rows, {} columns", g_datatableStore.NumTables(), g_datatableStore.NumRows(), g_datatableStore.NumColumns()));
+
+        DatatableQueryResult_t queryResult;
+        g_datatableStore.Query(datatableQuery, queryResult);
+
+        for (const DatatableQueryRow_t& row : queryResult.rows)
+            reporter.DatatableRow(row);
+
+        reporter.Message("dtbl_query", std::format("{} rows matched in {:.3f}ms, {} printed", queryResult.totalRows, static_cast<double>(queryResult.elapsedNs) / 1000000.0, queryResult.rows.size()));
+        finishProfiling();
+
+        if (SUCCEEDED(comResult))
+            CoUninitialize();
+
+        return HEADLESS_EXIT_SUCCESS;
+    }
+
+    // only the assets that are new or changed since the baseline are selected
+    std::unordered_set<uint64_t> diffFilter;
+    if (diffBuilds)
+    {
+        AssetFingerprintSet_t currentSet;
+        AssetFingerprintStats_t currentStats = {};
+        FingerprintLoadedFiles(diffPaths, currentSet, currentStats);
+
+        AssetDiffResult_t diff;
+        DiffAssetSets(baselineSet, currentSet, diff);
+
+        for (const AssetDiffEntry_t& entry : diff.entries)
+        {
+            reporter.DiffAsset(entry);
+
+            if (entry.change != eAssetDiffChange::REMOVED)
+                diffFilter.insert(entry.guid);
+        }
+
+        AssetDiffTypeStats_t totals = {};
+        for (const auto& [type, stats] : diff.types)
+        {
+            reporter.DiffType(type, stats);
+
+            totals.added += stats.added;
+            totals.removed += stats.removed;
+            totals.changed += stats.changed;
+            totals.unchanged += stats.unchanged;
+        }
+
+        reporter.Message("diff", std::format("{} added, {} removed, {} changed, {} unchanged. fingerprinted {} assets in {} files ({} from the fingerprint index), {:.3f}s",
+            totals.added, totals.removed, totals.changed, totals.unchanged, currentStats.assets, currentStats.files, currentStats.cachedFiles, static_cast<double>(currentStats.elapsedNs) / 1e9));
+    }
+
+    std::vector<CAsset*> selectedAssets;
+    selectedAssets.reserve(g_assetData.v_assets.size());
+
+    for (const CGlobalAssetData::AssetLookup_t& lookup : g_assetData.v_assets)
+    {
+        CAsset* const asset = lookup.m_asset;
+
+        if (!typeFilter.empty() && !typeFilter.contains(asset->GetAssetType()))
+            continue;
+
+        if (!guidFilter.empty() && !guidFilter.contains(asset->GetAssetGUID()))
+            continue;
+
+        if (diffBuilds && !diffFilter.contains(asset->GetAssetGUID()))
+            continue;
+
+        if (nameFilter.has_value() && !std::regex_search(asset->GetAssetName().begin(), asset->GetAssetName().end(), nameFilter.value()))
+            continue;
+
+        selectedAssets.push_back(asset);
+    }
+
+    const uint32_t totalAssets = static_cast<uint32_t>(selectedAssets.size());
+
+    if (cli->HasParam("-list") != -1)
+    {
+        for (uint32_t i = 0; i < totalAssets; ++i)
+            reporter.Asset("asset", selectedAssets[i], i + 1, totalAssets, true);
+
+        reporter.Summary(totalAssets, 0u, 0.0);
+        finishProfiling();
+
+        if (SUCCEEDED(comResult))
+            CoUninitialize();
+
+        return HEADLESS_EXIT_SUCCESS;
+    }
+
+    const bool exportDependencies = cli->HasParam("-deps") != -1 || g_ExportSettings.exportAssetDeps;
+
+    std::atomic<uint32_t> exportedAssets = 0u;
+    std::atomic<uint32_t> failedAssets = 0u;
+
+    CParallelTask parallelProcessTask(UtilsConfig->exportThreadCount);
+    for (CAsset* const asset : selectedAssets)
+    {
+        parallelProcessTask.addTask([asset, exportDependencies, totalAssets, &exportedAssets, &failedAssets, &reporter]
+            {
+                const bool exported = HandleExportBindingForAsset(asset, exportDependencies);
+                if (!exported)
+                    ++failedAssets;
+
+                reporter.Asset("export", asset, ++exportedAssets, totalAssets, exported);
+            }, 1u);
+    }
+
+    const auto exportStart = std::chrono::high_resolution_clock::now();
+
+    parallelProcessTask.execute();
+    parallelProcessTask.wait();
+
+    const double exportSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - exportStart).count();
+    reporter.Summary(totalAssets, failedAssets, exportSeconds);
+
+    if (g_ExportSettings.exportTextureDedupe)
+    {
+        const TextureStoreStats_t storeStats = g_textureExportStore.GetStats();
+        const uint64_t storeLookups = storeStats.hits + storeStats.misses;
+
+        reporter.Message("texture_store", std::format("{} of {} texture files reused ({:.1f}%), {:.3f}s of conversion saved, {} stored", storeStats.hits, storeLookups,
+            storeLookups ? static_cast<double>(storeStats.hits) * 100.0 / static_cast<double>(storeLookups) : 0.0, static_cast<double>(storeStats.savedNs) / 1e9, storeStats.entries));
+    }
+
+    if (g_ExportSettings.exportIncremental)
+    {
+        const ExportManifestStats_t manifestStats = g_exportManifest.GetStats();
+        const uint64_t manifestLookups = manifestStats.skipped + manifestStats.exported;
+
+        reporter.Message("export_manifest", std::format("{} of {} exports up to date and skipped ({:.1f}%), {:.3f}s of exporting saved, {} recorded", manifestStats.skipped, manifestLookups,
+            manifestLookups ? static_cast<double>(manifestStats.skipped) * 100.0 / static_cast<double>(manifestLookups) : 0.0, static_cast<double>(manifestStats.savedNs) / 1e9, manifestStats.entries));
+    }
+
+    const ShaderBlobStats_t blobStats = GetShaderBlobStats();
+    if (blobStats.blobs > 0u)
+    {
+        reporter.Message("shader_blobs", std::format("{} of {} shader blobs written ({:.1f}x dedupe), {} of {} bytes", blobStats.blobsWritten, blobStats.blobs,
+            blobStats.blobsWritten ? static_cast<double>(blobStats.blobs) / static_cast<double>(blobStats.blobsWritten) : 0.0, blobStats.bytesWritten, blobStats.bytes));
+    }
+
+    finishProfiling();
+
+    if (SUCCEEDED(comResult))
+        CoUninitialize();
+
+    return failedAssets > 0u ? HEADLESS_EXIT_EXPORT_FAILED : HEADLESS_EXIT_SUCCESS;
+}
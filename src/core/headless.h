@@ -0,0 +1,35 @@
+#pragma once
+
+class CCommandLine;
+
+// exit codes for headless runs, so batch scripts can tell what went wrong
+enum eHeadlessExitCode : int
+{
+    HEADLESS_EXIT_SUCCESS = 0,
+    HEADLESS_EXIT_BAD_ARGS = 2,         // malformed or unknown argument value
+    HEADLESS_EXIT_NO_INPUT = 3,         // no input files matched
+    HEADLESS_EXIT_LOAD_FAILED = 4,      // nothing could be loaded from the inputs
+    HEADLESS_EXIT_EXPORT_FAILED = 5,    // at least one asset failed to export
+    HEADLESS_EXIT_SELFTEST_FAILED = 6,  // a -selftest check (or a check in a -bench run) failed
+};
+
+const bool IsHeadlessRun(const CCommandLine* const cli);
+
+// loads and exports assets without creating a window or a d3d device
+// launchDirectory is the working directory the process was started in, relative paths are resolved against it
+const int HandleHeadlessRun(const CCommandLine* const cli, const std::filesystem::path& launchDirectory);
+
+
+// the argument parsing HandleHeadlessRun does, exposed for the self tests
+const bool GlobMatch(const char* pattern, const char* str);
+
+// wildcards are supported in the file name, a "**" directory before it searches recursively (e.g. "models/**/*.mdl")
+// a directory without wildcards is expanded to the loadable files in it
+void ExpandInputPath(const std::filesystem::path& launchDirectory, const std::string& input, std::vector<std::string>& filePaths);
+
+// every -in (or -diff) input expanded, sorted and without duplicates
+void ExpandInputPaths(const std::filesystem::path& launchDirectory, const std::vector<std::string>& inputs, std::vector<std::string>& filePaths);
+
+const uint32_t TypeFromString(const std::string& str);
+void SplitList(const std::string& list, std::vector<std::string>& out);
+const bool ParseGuidList(const std::string& list, std::unordered_set<uint64_t>& guids);
\ No newline at end of file
@@ -0,0 +1,628 @@
+#include <pch.h>
+#include <core/logging/logger.h>
+
+#include <share.h>
+
+CLogger g_logger;
+
+// record header in a thread's ring, followed by its arguments and then the bytes of its string arguments
+struct LogRecord_t
+{
+	uint32_t size; // of the whole record, padded to 8 bytes
+	uint16_t numArgs;
+	eLogLevel level;
+	eLogCategory category;
+	int64_t time; // nanoseconds since the logger was created
+	const char* fmt;
+};
+
+// fills the end of the ring when a record doesn't fit before it wraps, only the first 8 bytes of the header are written
+static constexpr uint16_t s_paddingRecord = 0xffff;
+
+// longer strings are cut off, keeps one message from taking most of a ring
+static constexpr size_t s_maxStringLength = 4096ull;
+
+class CLogThreadBuffer
+{
+public:
+	// 256k per thread, messages that don't fit are dropped
+	static constexpr uint64_t capacity = 1ull << 18;
+
+	CLogThreadBuffer(const uint32_t laneIndex) : lane(laneIndex), head(0ull), headPad(), tail(0ull), tailPad(), data(std::make_unique<uint8_t[]>(capacity)) {};
+
+	const uint32_t lane; // shared by every thread that has owned this buffer
+
+	// kept on separate cache lines so the owning thread and the sink don't contend on them
+	std::atomic<uint64_t> head; // only written by the owning thread
+	uint8_t headPad[64 - sizeof(std::atomic<uint64_t>)];
+	std::atomic<uint64_t> tail; // only written by the sink
+	uint8_t tailPad[64 - sizeof(std::atomic<uint64_t>)];
+
+	std::unique_ptr<uint8_t[]> data;
+};
+
+// hands the buffer back when the owning thread exits
+struct LogThreadHandle_t
+{
+	~LogThreadHandle_t()
+	{
+		if (buffer)
+			g_logger.RelieveThreadBuffer(buffer);
+	}
+
+	CLogThreadBuffer* buffer = nullptr;
+};
+
+static thread_local LogThreadHandle_t s_threadBuffer;
+
+#if defined(_DEBUG)
+static constexpr eLogLevel s_defaultLevel = eLogLevel::DBG;
+#else
+static constexpr eLogLevel s_defaultLevel = eLogLevel::WARN;
+#endif
+
+CLogger::CLogger() : m_level(s_defaultLevel), m_categoryMask(0xffffffff), m_console(true), m_epoch(std::chrono::steady_clock::now()), m_dropped(0ull), m_sinkStop(false),
+	m_file(nullptr), m_reportedDropped(0ull)
+{
+}
+
+CLogger::~CLogger()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_sinkMutex);
+		m_sinkStop = true;
+	}
+
+	m_sinkWake.notify_all();
+
+	if (m_sinkThread.joinable())
+		m_sinkThread.join();
+
+	{
+		std::unique_lock<std::mutex> lock(m_sinkMutex);
+		Drain();
+
+		if (m_file)
+			fclose(m_file);
+
+		m_file = nullptr;
+	}
+
+	for (CLogThreadBuffer* const buffer : m_buffers)
+		delete buffer;
+}
+
+const bool CLogger::SetFile(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(m_sinkMutex);
+
+	// anything already logged goes to the old file
+	Drain();
+
+	if (m_file)
+	{
+		fclose(m_file);
+		m_file = nullptr;
+	}
+
+	m_filePath = path;
+
+	if (path.empty())
+		return true;
+
+	// other processes can read it while it is being written
+	m_file = _fsopen(path.c_str(), "w", _SH_DENYWR);
+
+	return m_file != nullptr;
+}
+
+const std::string CLogger::GetFile() const
+{
+	std::unique_lock<std::mutex> lock(m_sinkMutex);
+	return m_filePath;
+}
+
+CLogThreadBuffer* CLogger::ClaimThreadBuffer()
+{
+	std::unique_lock<std::mutex> lock(m_bufferMutex);
+
+	if (!m_sinkThread.joinable())
+		m_sinkThread = std::thread(&CLogger::SinkThread, this);
+
+	if (!m_openBuffers.empty())
+	{
+		CLogThreadBuffer* const buffer = m_openBuffers.top();
+		m_openBuffers.pop();
+
+		return buffer;
+	}
+
+	CLogThreadBuffer* const buffer = new CLogThreadBuffer(static_cast<uint32_t>(m_buffers.size()));
+	m_buffers.push_back(buffer);
+
+	return buffer;
+}
+
+void CLogger::RelieveThreadBuffer(CLogThreadBuffer* const buffer)
+{
+	std::unique_lock<std::mutex> lock(m_bufferMutex);
+	m_openBuffers.push(buffer);
+}
+
+static inline const size_t LogStringLength(const char* const str)
+{
+	return str ? strnlen(str, s_maxStringLength) : 0ull;
+}
+
+void CLogger::WriteRecord(const eLogLevel level, const eLogCategory category, const char* const fmt, const LogArg_t* const args, const size_t numArgs)
+{
+	if (!s_threadBuffer.buffer)
+		s_threadBuffer.buffer = ClaimThreadBuffer();
+
+	CLogThreadBuffer* const buffer = s_threadBuffer.buffer;
+
+	uint64_t size = sizeof(LogRecord_t) + (numArgs * sizeof(LogArg_t));
+	for (size_t i = 0; i < numArgs; i++)
+	{
+		if (args[i].type == eLogArgType::STRING)
+			size += LogStringLength(args[i].s);
+	}
+
+	size = (size + 7ull) & ~7ull;
+
+	const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+	const uint64_t tail = buffer->tail.load(std::memory_order_acquire);
+
+	const uint64_t offset = head & (CLogThreadBuffer::capacity - 1);
+	const uint64_t padding = offset + size > CLogThreadBuffer::capacity ? CLogThreadBuffer::capacity - offset : 0ull;
+
+	if (numArgs >= s_paddingRecord || (head - tail) + padding + size > CLogThreadBuffer::capacity)
+	{
+		m_dropped.fetch_add(1ull, std::memory_order_relaxed);
+		return;
+	}
+
+	uint8_t* out = buffer->data.get() + offset;
+
+	if (padding)
+	{
+		LogRecord_t* const paddingRecord = reinterpret_cast<LogRecord_t*>(out);
+		paddingRecord->size = static_cast<uint32_t>(padding);
+		paddingRecord->numArgs = s_paddingRecord;
+
+		out = buffer->data.get();
+	}
+
+	LogRecord_t* const record = reinterpret_cast<LogRecord_t*>(out);
+	record->size = static_cast<uint32_t>(size);
+	record->numArgs = static_cast<uint16_t>(numArgs);
+	record->level = level;
+	record->category = category;
+	record->time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+	record->fmt = fmt;
+
+	LogArg_t* const recordArgs = reinterpret_cast<LogArg_t*>(out + sizeof(LogRecord_t));
+	char* strings = reinterpret_cast<char*>(recordArgs + numArgs);
+
+	for (size_t i = 0; i < numArgs; i++)
+	{
+		recordArgs[i] = args[i];
+
+		if (args[i].type != eLogArgType::STRING)
+			continue;
+
+		// null strings are stored with no bytes and a length of UINT64_MAX, the sink prints them as (null)
+		const size_t length = LogStringLength(args[i].s);
+		memcpy(strings, args[i].s ? args[i].s : "", length);
+
+		recordArgs[i].u = args[i].s ? length : UINT64_MAX;
+		strings += length;
+	}
+
+	const uint64_t newHead = head + padding + size;
+	buffer->head.store(newHead, std::memory_order_release);
+
+	// don't wait for the next poll when the ring is filling up
+	if (newHead - tail > CLogThreadBuffer::capacity / 2)
+		m_sinkWake.notify_one();
+}
+
+void CLogger::SinkThread()
+{
+	std::unique_lock<std::mutex> lock(m_sinkMutex);
+
+	while (!m_sinkStop)
+	{
+		m_sinkWake.wait_for(lock, std::chrono::milliseconds(10));
+		Drain();
+	}
+}
+
+void CLogger::Flush()
+{
+	std::unique_lock<std::mutex> lock(m_sinkMutex);
+	Drain();
+}
+
+// formats one value into the end of out with a printf spec
+template <class T>
+static void AppendFormatted(std::string& out, const char* const spec, const T value)
+{
+	const size_t start = out.length();
+
+	out.resize(start + 64);
+	int written = snprintf(out.data() + start, 64, spec, value);
+
+	if (written >= 64)
+	{
+		const size_t length = static_cast<size_t>(written) + 1;
+
+		out.resize(start + length);
+		written = snprintf(out.data() + start, length, spec, value);
+	}
+
+	out.resize(start + static_cast<size_t>(std::max(written, 0)));
+}
+
+static const uint64_t LogArgUnsigned(const LogArg_t& arg)
+{
+	switch (arg.type)
+	{
+	case eLogArgType::INT:
+	{
+		// back to the width it was passed with, like printf would read it
+		const uint64_t mask = arg.size >= sizeof(uint64_t) ? UINT64_MAX : (1ull << (arg.size * 8)) - 1;
+		return static_cast<uint64_t>(arg.i) & mask;
+	}
+	case eLogArgType::DOUBLE:	return static_cast<uint64_t>(arg.d);
+	default:					return arg.u;
+	}
+}
+
+static const int64_t LogArgSigned(const LogArg_t& arg)
+{
+	switch (arg.type)
+	{
+	case eLogArgType::DOUBLE:	return static_cast<int64_t>(arg.d);
+	default:					return arg.i;
+	}
+}
+
+static const double LogArgDouble(const LogArg_t& arg)
+{
+	switch (arg.type)
+	{
+	case eLogArgType::INT:		return static_cast<double>(arg.i);
+	case eLogArgType::UINT:		return static_cast<double>(arg.u);
+	case eLogArgType::DOUBLE:	return arg.d;
+	default:					return 0.0;
+	}
+}
+
+// printf with the arguments from a record, length modifiers in the format are ignored as every argument was stored widened
+static void FormatLogMessage(std::string& out, const char* fmt, const LogArg_t* const args, const size_t numArgs, const char* strings)
+{
+	size_t argIndex = 0;
+
+	while (*fmt)
+	{
+		if (*fmt != '%')
+		{
+			const char* const next = strchr(fmt, '%');
+			const size_t length = next ? static_cast<size_t>(next - fmt) : strlen(fmt);
+
+			out.append(fmt, length);
+			fmt += length;
+
+			continue;
+		}
+
+		if (fmt[1] == '%')
+		{
+			out.push_back('%');
+			fmt += 2;
+
+			continue;
+		}
+
+		const char* const specStart = fmt++;
+
+		char spec[48] = { '%' };
+		size_t specLength = 1;
+
+		// room for the conversion and its length modifier
+		const auto appendSpec = [&spec, &specLength](const char c) { if (specLength < sizeof(spec) - 4) spec[specLength++] = c; };
+		const auto appendStar = [&](const bool precision)
+			{
+				int value = argIndex < numArgs ? static_cast<int>(LogArgSigned(args[argIndex++])) : 0;
+
+				// negative precision is taken as none
+				if (precision && value < 0)
+					value = 0;
+
+				char digits[16];
+				const int numDigits = snprintf(digits, sizeof(digits), "%d", value);
+
+				for (int i = 0; i < numDigits; i++)
+					appendSpec(digits[i]);
+			};
+
+		while (*fmt && strchr("-+ #0", *fmt))
+			appendSpec(*fmt++);
+
+		if (*fmt == '*')
+		{
+			appendStar(false);
+			fmt++;
+		}
+		else
+		{
+			while (*fmt >= '0' && *fmt <= '9')
+				appendSpec(*fmt++);
+		}
+
+		int precision = -1;
+
+		if (*fmt == '.')
+		{
+			appendSpec(*fmt++);
+			precision = 0;
+
+			if (*fmt == '*')
+			{
+				const size_t precisionStart = specLength;
+				appendStar(true);
+				precision = atoi(spec + precisionStart);
+				fmt++;
+			}
+			else
+			{
+				while (*fmt >= '0' && *fmt <= '9')
+				{
+					precision = (precision * 10) + (*fmt - '0');
+					appendSpec(*fmt++);
+				}
+			}
+		}
+
+		// every argument is already 64 bit
+		while (*fmt && strchr("hljztLI", *fmt))
+		{
+			if (*fmt == 'I' && (strncmp(fmt, "I64", 3) == 0 || strncmp(fmt, "I32", 3) == 0))
+				fmt += 2;
+
+			fmt++;
+		}
+
+		const char conversion = *fmt;
+		if (!conversion)
+		{
+			out.append(specStart);
+			break;
+		}
+
+		fmt++;
+
+		if (conversion == 'n')
+			continue;
+
+		if (argIndex >= numArgs)
+		{
+			out.append(specStart, fmt - specStart);
+			continue;
+		}
+
+		const LogArg_t& arg = args[argIndex++];
+		const char* const argString = strings;
+
+		if (arg.type == eLogArgType::STRING && arg.u != UINT64_MAX)
+			strings += arg.u;
+
+		switch (conversion)
+		{
+		case 'd':
+		case 'i':
+		{
+			spec[specLength++] = 'l';
+			spec[specLength++] = 'l';
+			spec[specLength++] = conversion;
+
+			AppendFormatted(out, spec, arg.type == eLogArgType::UINT ? static_cast<int64_t>(arg.u) : LogArgSigned(arg));
+			break;
+		}
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		{
+			spec[specLength++] = 'l';
+			spec[specLength++] = 'l';
+			spec[specLength++] = conversion;
+
+			AppendFormatted(out, spec, LogArgUnsigned(arg));
+			break;
+		}
+		case 'c':
+		{
+			spec[specLength++] = conversion;
+
+			AppendFormatted(out, spec, static_cast<int>(LogArgSigned(arg)));
+			break;
+		}
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+		{
+			spec[specLength++] = conversion;
+
+			AppendFormatted(out, spec, LogArgDouble(arg));
+			break;
+		}
+		case 'p':
+		{
+			spec[specLength++] = conversion;
+
+			AppendFormatted(out, spec, arg.type == eLogArgType::POINTER ? arg.p : reinterpret_cast<const void*>(arg.u));
+			break;
+		}
+		case 's':
+		{
+			const bool isNull = arg.type != eLogArgType::STRING || arg.u == UINT64_MAX;
+
+			const char* const str = isNull ? "(null)" : argString;
+			size_t length = isNull ? 6ull : arg.u;
+
+			if (precision >= 0)
+				length = std::min(length, static_cast<size_t>(precision));
+
+			// precision is replaced with the stored length, strings in the ring aren't terminated
+			if (precision >= 0)
+			{
+				while (specLength > 1 && spec[specLength - 1] != '.')
+					specLength--;
+
+				specLength--;
+			}
+
+			spec[specLength++] = '.';
+			spec[specLength++] = '*';
+			spec[specLength++] = 's';
+			spec[specLength] = '\0';
+
+			const size_t start = out.length();
+			const size_t written = static_cast<size_t>(std::max(snprintf(nullptr, 0, spec, static_cast<int>(length), str), 0));
+
+			out.resize(start + written + 1);
+			snprintf(out.data() + start, written + 1, spec, static_cast<int>(length), str);
+			out.resize(start + written);
+
+			break;
+		}
+		default:
+		{
+			out.append(specStart, fmt - specStart);
+			break;
+		}
+		}
+	}
+}
+
+void CLogger::Drain()
+{
+	std::vector<CLogThreadBuffer*> buffers;
+	{
+		std::unique_lock<std::mutex> lock(m_bufferMutex);
+		buffers = m_buffers;
+	}
+
+	m_pendingLines.clear();
+	m_pendingText.clear();
+
+	for (CLogThreadBuffer* const buffer : buffers)
+	{
+		const uint64_t head = buffer->head.load(std::memory_order_acquire);
+		uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+
+		while (tail != head)
+		{
+			const uint8_t* const data = buffer->data.get() + (tail & (CLogThreadBuffer::capacity - 1));
+			const LogRecord_t* const record = reinterpret_cast<const LogRecord_t*>(data);
+
+			tail += record->size;
+
+			if (record->numArgs == s_paddingRecord)
+				continue;
+
+			const LogArg_t* const args = reinterpret_cast<const LogArg_t*>(data + sizeof(LogRecord_t));
+			const char* const strings = reinterpret_cast<const char*>(args + record->numArgs);
+
+			const size_t offset = m_pendingText.length();
+
+			char prefix[80];
+			const int prefixLength = snprintf(prefix, sizeof(prefix), "[%5lld.%06lld] [%-5s] [%-8s] [%2u] ",
+				record->time / 1000000000ll, (record->time / 1000ll) % 1000000ll, GetLevelName(record->level), GetCategoryName(record->category), buffer->lane);
+
+			m_pendingText.append(prefix, static_cast<size_t>(std::max(prefixLength, 0)));
+			FormatLogMessage(m_pendingText, record->fmt, args, record->numArgs, strings);
+
+			// one line per message, messages carried their own newline with the old logger
+			while (m_pendingText.length() > offset && (m_pendingText.back() == '\n' || m_pendingText.back() == '\r'))
+				m_pendingText.pop_back();
+
+			m_pendingText.push_back('\n');
+			m_pendingLines.push_back({ record->time, offset, m_pendingText.length() - offset });
+		}
+
+		buffer->tail.store(tail, std::memory_order_release);
+	}
+
+	const uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+	if (dropped != m_reportedDropped)
+	{
+		const size_t offset = m_pendingText.length();
+
+		m_pendingText.append(std::format("[log] {} messages dropped, a thread's log buffer was full\n", dropped - m_reportedDropped));
+		m_pendingLines.push_back({ INT64_MAX, offset, m_pendingText.length() - offset });
+
+		m_reportedDropped = dropped;
+	}
+
+	if (m_pendingLines.empty())
+		return;
+
+	// every buffer is ordered by itself, interleave them by time
+	std::stable_sort(m_pendingLines.begin(), m_pendingLines.end(), [](const PendingLine_t& a, const PendingLine_t& b) { return a.time < b.time; });
+
+	m_output.clear();
+	for (const PendingLine_t& line : m_pendingLines)
+		m_output.append(m_pendingText, line.offset, line.length);
+
+	if (m_console.load(std::memory_order_relaxed))
+	{
+		fwrite(m_output.data(), 1, m_output.length(), stderr);
+		fflush(stderr);
+	}
+
+	if (m_file)
+	{
+		fwrite(m_output.data(), 1, m_output.length(), m_file);
+		fflush(m_file);
+	}
+}
+
+const char* const CLogger::GetLevelName(const eLogLevel level)
+{
+	switch (level)
+	{
+	case eLogLevel::DBG:	return "debug";
+	case eLogLevel::INFO:	return "info";
+	case eLogLevel::WARN:	return "warn";
+	case eLogLevel::ERR:	return "error";
+	default:				return "unknown";
+	}
+}
+
+const char* const CLogger::GetCategoryName(const eLogCategory category)
+{
+	switch (category)
+	{
+	case eLogCategory::GENERAL:		return "general";
+	case eLogCategory::PAK:			return "pak";
+	case eLogCategory::MODEL:		return "model";
+	case eLogCategory::TEXTURE:		return "texture";
+	case eLogCategory::MATERIAL:	return "material";
+	case eLogCategory::SHADER:		return "shader";
+	case eLogCategory::AUDIO:		return "audio";
+	case eLogCategory::MAP:			return "map";
+	case eLogCategory::UI:			return "ui";
+	case eLogCategory::RENDER:		return "render";
+	case eLogCategory::CACHE:		return "cache";
+	case eLogCategory::EXPORT:		return "export";
+	default:						return "unknown";
+	}
+}
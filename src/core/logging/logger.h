@@ -1,15 +1,218 @@
 #pragma once
-#include <cstdarg>
-#include <stdio.h>
-
-#if _DEBUG
-inline void Log(const char* fmt, ...)
-{
-	va_list args;
-	va_start(args, fmt);
-	vprintf(fmt, args);
-	va_end(args);
-}
-#else
-#define Log(...) ((void)nullptr)
-#endif
\ No newline at end of file
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <condition_variable>
+#include <type_traits>
+
+// asynchronous logger, compiled in for every build
+// a message is filtered by level and category before its arguments are evaluated, one that passes copies its arguments into the calling thread's
+// ring buffer and returns, no formatting or io happens on the calling thread. a sink thread drains every ring, formats the messages in time order
+// and writes them to the console (stderr) and/or a file
+// messages written when a thread's ring is full are dropped and counted, the sink reports how many were lost
+
+enum class eLogLevel : uint8_t
+{
+	DBG,
+	INFO,
+	WARN,
+	ERR,
+
+	_COUNT,
+};
+
+enum class eLogCategory : uint8_t
+{
+	GENERAL,
+	PAK,		// containers (rpak, mbnk, bpk, bsp) and decompression
+	MODEL,		// models and animations
+	TEXTURE,
+	MATERIAL,
+	SHADER,
+	AUDIO,
+	MAP,
+	UI,			// ui assets, image and font atlases
+	RENDER,		// preview, dx and the interface
+	CACHE,
+	EXPORT,
+
+	_COUNT,
+};
+
+enum class eLogArgType : uint8_t
+{
+	INT,
+	UINT,
+	DOUBLE,
+	POINTER,
+	STRING, // copied into the ring, value is the length
+};
+
+// an argument as it is stored in the ring
+struct LogArg_t
+{
+	eLogArgType type;
+	uint8_t size; // of the original integer, so %x of a negative int prints as many digits as printf would
+
+	union
+	{
+		int64_t i;
+		uint64_t u;
+		double d;
+		const void* p;
+		const char* s; // only while writing, the sink reads the copy
+	};
+};
+
+class CLogThreadBuffer;
+struct LogThreadHandle_t;
+
+class CLogger
+{
+public:
+	CLogger();
+	~CLogger();
+
+	FORCEINLINE const bool IsEnabled(const eLogLevel level, const eLogCategory category) const
+	{
+		return level >= m_level.load(std::memory_order_relaxed) && (m_categoryMask.load(std::memory_order_relaxed) & (1u << static_cast<uint8_t>(category)));
+	};
+
+	inline const eLogLevel GetLevel() const { return m_level.load(std::memory_order_relaxed); };
+	inline void SetLevel(const eLogLevel level) { m_level.store(level < eLogLevel::_COUNT ? level : eLogLevel::ERR, std::memory_order_relaxed); };
+
+	// bit per eLogCategory
+	inline const uint32_t GetCategoryMask() const { return m_categoryMask.load(std::memory_order_relaxed); };
+	inline void SetCategoryMask(const uint32_t mask) { m_categoryMask.store(mask, std::memory_order_relaxed); };
+
+	inline const bool GetConsoleOutput() const { return m_console.load(std::memory_order_relaxed); };
+	inline void SetConsoleOutput(const bool console) { m_console.store(console, std::memory_order_relaxed); };
+
+	// empty path closes the file, the file is truncated when opened
+	const bool SetFile(const std::string& path);
+	const std::string GetFile() const;
+
+	// fmt is printf style and should be a literal, it is only read by the sink
+	template <size_t N, class... Args>
+	FORCEINLINE void Write(const eLogLevel level, const eLogCategory category, const char(&fmt)[N], const Args... args)
+	{
+		const LogArg_t packed[sizeof...(Args) + 1] = { MakeArg(args)..., {} };
+		WriteRecord(level, category, fmt, packed, sizeof...(Args));
+	}
+
+	// writes out everything logged before the call, blocks until it has been written
+	void Flush();
+
+	const uint64_t NumDropped() const { return m_dropped.load(std::memory_order_relaxed); };
+
+	static const char* const GetLevelName(const eLogLevel level);
+	static const char* const GetCategoryName(const eLogCategory category);
+
+private:
+	friend struct LogThreadHandle_t;
+
+	template <class T>
+	static FORCEINLINE const LogArg_t MakeArg(const T& value)
+	{
+		LogArg_t arg = {};
+
+		if constexpr (std::is_enum_v<T>)
+		{
+			return MakeArg(static_cast<std::underlying_type_t<T>>(value));
+		}
+		else if constexpr (std::is_same_v<T, bool>)
+		{
+			arg.type = eLogArgType::UINT;
+			arg.size = sizeof(int);
+			arg.u = value ? 1ull : 0ull;
+		}
+		else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+		{
+			arg.type = eLogArgType::INT;
+			arg.size = sizeof(T);
+			arg.i = static_cast<int64_t>(value);
+		}
+		else if constexpr (std::is_integral_v<T>)
+		{
+			arg.type = eLogArgType::UINT;
+			arg.size = sizeof(T);
+			arg.u = static_cast<uint64_t>(value);
+		}
+		else if constexpr (std::is_floating_point_v<T>)
+		{
+			arg.type = eLogArgType::DOUBLE;
+			arg.size = sizeof(double);
+			arg.d = static_cast<double>(value);
+		}
+		else if constexpr (std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>)
+		{
+			arg.type = eLogArgType::STRING;
+			arg.s = value;
+		}
+		else if constexpr (std::is_pointer_v<std::decay_t<T>> || std::is_null_pointer_v<T>)
+		{
+			arg.type = eLogArgType::POINTER;
+			arg.size = sizeof(void*);
+			arg.p = value;
+		}
+		else
+		{
+			static_assert(std::is_pointer_v<T>, "unsupported log argument, pass strings as const char*");
+		}
+
+		return arg;
+	}
+
+	void WriteRecord(const eLogLevel level, const eLogCategory category, const char* const fmt, const LogArg_t* const args, const size_t numArgs);
+
+	CLogThreadBuffer* ClaimThreadBuffer();
+	void RelieveThreadBuffer(CLogThreadBuffer* const buffer);
+
+	void SinkThread();
+	void Drain(); // m_sinkMutex must be held
+
+	std::atomic<eLogLevel> m_level;
+	std::atomic<uint32_t> m_categoryMask;
+	std::atomic<bool> m_console;
+
+	std::chrono::steady_clock::time_point m_epoch;
+	std::atomic<uint64_t> m_dropped;
+
+	// threads are short lived (one set per CParallelTask), so buffers are handed back on thread exit and reused
+	mutable std::mutex m_bufferMutex;
+	std::vector<CLogThreadBuffer*> m_buffers;
+	std::stack<CLogThreadBuffer*> m_openBuffers;
+
+	// drains and output, the sink thread is started with the first buffer
+	mutable std::mutex m_sinkMutex;
+	std::condition_variable m_sinkWake;
+	std::thread m_sinkThread;
+	bool m_sinkStop;
+
+	FILE* m_file;
+	std::string m_filePath;
+	uint64_t m_reportedDropped;
+
+	// formatted lines of a drain, kept between drains for their allocations
+	struct PendingLine_t
+	{
+		int64_t time;
+		size_t offset; // into m_pendingText
+		size_t length;
+	};
+
+	std::vector<PendingLine_t> m_pendingLines;
+	std::string m_pendingText;
+	std::string m_output;
+};
+
+extern CLogger g_logger;
+
+// LOG_WARN(MODEL, "failed to parse %s\n", name), category is a eLogCategory name
+// arguments are only evaluated when the level and category are enabled
+#define LOG_WRITE(level, category, ...) do { if (g_logger.IsEnabled(level, eLogCategory::category)) g_logger.Write(level, eLogCategory::category, __VA_ARGS__); } while (0)
+
+#define LOG_DEBUG(category, ...) LOG_WRITE(eLogLevel::DBG, category, __VA_ARGS__)
+#define LOG_INFO(category, ...) LOG_WRITE(eLogLevel::INFO, category, __VA_ARGS__)
+#define LOG_WARN(category, ...) LOG_WRITE(eLogLevel::WARN, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG_WRITE(eLogLevel::ERR, category, __VA_ARGS__)
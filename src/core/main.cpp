@@ -9,8 +9,14 @@
 #include <core/render/dx.h>
 #include <core/input/input.h>
 #include <core/cache/cachedb.h>
+#include <core/cache/texturestore.h>
+#include <core/cache/exportmanifest.h>
+#include <core/cache/fingerprintindex.h>
+#include <core/cache/streamindex.h>
+#include <core/cache/modelcache.h>
 #include <core/utils/cli_parser.h>
 #include <core/filehandling/load.h>
+#include <core/headless.h>
 
 #include <core/splash.h>
 #include <core/window.h>
@@ -158,6 +164,9 @@ int main(int argc, char* argv[])
 {
     CCommandLine cli(argc, argv);
 
+    // headless runs resolve their paths against the directory they were started from
+    const std::filesystem::path launchDirectory = std::filesystem::current_path();
+
     // we want the visual studio debugger to be able to control the working directory
 #if defined(NDEBUG)
     // this is needed to properly support drag'n'drop, it changes the current working directory to the file you drag into the exe
@@ -171,7 +180,23 @@ int main(int argc, char* argv[])
     g_CrashHandler.Init();
 #endif
 
-    g_cacheDBManager.LoadFromFile((std::filesystem::current_path() / "rsx_cache_db.bin").string());
+    const std::filesystem::path cacheDBPath = std::filesystem::current_path() / "rsx_cache_db.bin";
+    g_cacheDBManager.LoadFromFile(cacheDBPath.string());
+
+    const std::filesystem::path textureStorePath = std::filesystem::current_path() / "rsx_texture_store.bin";
+    g_textureExportStore.LoadFromFile(textureStorePath.string());
+
+    const std::filesystem::path exportManifestPath = std::filesystem::current_path() / "rsx_export_manifest.bin";
+    g_exportManifest.LoadFromFile(exportManifestPath.string());
+
+    const std::filesystem::path fingerprintIndexPath = std::filesystem::current_path() / "rsx_fingerprint_index.bin";
+    g_assetFingerprintIndex.LoadFromFile(fingerprintIndexPath.string());
+
+    const std::filesystem::path streamIndexPath = std::filesystem::current_path() / "rsx_mstr_index.bin";
+    g_milesStreamIndex.LoadFromFile(streamIndexPath.string());
+
+    const std::filesystem::path modelCachePath = std::filesystem::current_path() / "rsx_model_cache.bin";
+    g_modelCache.LoadFromFile(modelCachePath.string());
 
     // init pak asset types
     HandleAssetRegistration(&cli);
@@ -179,6 +204,22 @@ int main(int argc, char* argv[])
     // get max con-current threads.
     maxConcurrentThreads = std::max(1u, CThread::GetConCurrentThreads());
 
+    // no window, device or imgui context past this point
+    if (IsHeadlessRun(&cli))
+    {
+        const int exitCode = HandleHeadlessRun(&cli, launchDirectory);
+        g_cacheDBManager.SaveToFile(cacheDBPath.string());
+        g_textureExportStore.SaveToFile(textureStorePath.string());
+        g_exportManifest.SaveToFile(exportManifestPath.string());
+        g_assetFingerprintIndex.SaveToFile(fingerprintIndexPath.string());
+        g_milesStreamIndex.SaveToFile(streamIndexPath.string());
+        g_modelCache.SaveToFile(modelCachePath.string());
+
+        g_logger.Flush();
+
+        return exitCode;
+    }
+
 #if defined(SPLASHSCREEN)
     DrawSplashScreen(); // draw splashscreen now for 2~ seconds
 #endif // #if defined(SPLASHSCREEN)
@@ -234,13 +275,20 @@ int main(int argc, char* argv[])
         HandleRenderFrame();
     }
 
-    g_cacheDBManager.SaveToFile((std::filesystem::current_path() / "rsx_cache_db.bin").string());
+    g_cacheDBManager.SaveToFile(cacheDBPath.string());
+    g_textureExportStore.SaveToFile(textureStorePath.string());
+    g_exportManifest.SaveToFile(exportManifestPath.string());
+    g_assetFingerprintIndex.SaveToFile(fingerprintIndexPath.string());
+    g_milesStreamIndex.SaveToFile(streamIndexPath.string());
+    g_modelCache.SaveToFile(modelCachePath.string());
 
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();
 
     delete g_dxHandler;
+
+    g_logger.Flush();
 	return EXIT_SUCCESS;
 }
 
@@ -186,6 +186,8 @@ struct matrix3x4_t;
 
 void QuaternionBlend(const Quaternion& p, const Quaternion& q, float t, Quaternion& qt);
 void QuaternionBlendNoAlign(const Quaternion& p, const Quaternion& q, float t, Quaternion& qt);
+void QuaternionSlerp(const Quaternion& p, const Quaternion& q, float t, Quaternion& qt);
+void QuaternionSlerpNoAlign(const Quaternion& p, const Quaternion& q, float t, Quaternion& qt);
 
 
 
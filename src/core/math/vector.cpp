@@ -566,6 +566,62 @@ void QuaternionBlendNoAlign(const Quaternion& p, const Quaternion& q, float t, Q
 	QuaternionNormalize(qt);
 }
 
+void QuaternionSlerpNoAlign(const Quaternion& p, const Quaternion& q, float t, Quaternion& qt)
+{
+	float omega, cosom, sinom, sclp, sclq;
+	int i;
+
+	// 0.0 returns p, 1.0 return q.
+	cosom = p[0] * q[0] + p[1] * q[1] + p[2] * q[2] + p[3] * q[3];
+
+	if ((1.0f + cosom) > 0.000001f)
+	{
+		if ((1.0f - cosom) > 0.000001f)
+		{
+			omega = acosf(cosom);
+			sinom = sinf(omega);
+			sclp = sinf((1.0f - t) * omega) / sinom;
+			sclq = sinf(t * omega) / sinom;
+		}
+		else
+		{
+			sclp = 1.0f - t;
+			sclq = t;
+		}
+
+		for (i = 0; i < 4; i++)
+		{
+			qt[i] = sclp * p[i] + sclq * q[i];
+		}
+	}
+	else
+	{
+		assert(&qt != &q);
+
+		qt[0] = -q[1];
+		qt[1] = q[0];
+		qt[2] = -q[3];
+		qt[3] = q[2];
+		sclp = sinf((1.0f - t) * (0.5f * XM_PI));
+		sclq = sinf(t * (0.5f * XM_PI));
+		for (i = 0; i < 3; i++)
+		{
+			qt[i] = sclp * p[i] + sclq * qt[i];
+		}
+	}
+
+	assert(qt.IsValid());
+}
+
+void QuaternionSlerp(const Quaternion& p, const Quaternion& q, float t, Quaternion& qt)
+{
+	Quaternion q2;
+
+	// decide if one of the quaternions is backwards
+	QuaternionAlign(p, q, q2);
+	QuaternionSlerpNoAlign(p, q2, t, qt);
+}
+
 void QuaternionAlign(const Quaternion& p, const Quaternion& q, Quaternion& qt)
 {
 	int i;
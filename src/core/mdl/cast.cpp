@@ -460,6 +460,41 @@ namespace cast
 		curve->AddProperty(propType, static_cast<int>(CastPropsCurve::Key_Frame_Buffer), frameBuf, static_cast<uint32_t>(numFrames));
 	}
 
+	void CastNodeCurve::MakeCurveKeyFrames(const uint32_t* const frames, const size_t numKeys)
+	{
+		assertm(numKeys > 0, "curve should have at least one key");
+
+		// frames are sorted, the last one decides the size
+		const CastPropertyId propType = CastProperty::ValueMinSize(frames[numKeys - 1]);
+
+		CastProperty* const frameProp = curve->AddProperty(propType, static_cast<int>(CastPropsCurve::Key_Frame_Buffer), static_cast<uint32_t>(numKeys), nullptr);
+		void* const frameBuf = frameProp->GetAllocPtr();
+
+		switch (propType)
+		{
+		case CastPropertyId::Byte:
+		{
+			MakeCurveKeyFrameBuffer<uint8_t>(frameBuf, frames, numKeys);
+			break;
+		}
+		case CastPropertyId::Short:
+		{
+			MakeCurveKeyFrameBuffer<uint16_t>(frameBuf, frames, numKeys);
+			break;
+		}
+		case CastPropertyId::Integer32:
+		{
+			MakeCurveKeyFrameBuffer<uint32_t>(frameBuf, frames, numKeys);
+			break;
+		}
+		default:
+		{
+			assertm(false, "invalid frameBuffer type");
+			break;
+		}
+		}
+	}
+
 	template<class PropType> void CastNodeCurve::MakeCurveKeyValues(const PropType* const track, const size_t trackLength, const size_t numFrames, const CastPropertyId propId)
 	{
 		if (trackLength == numFrames)
@@ -590,6 +625,36 @@ namespace cast
 		delete[] trackFix;
 	}
 
+	void CastNodeCurve::MakeCurveFloatKeyed(const char* name, const float* const values, const uint32_t* const frames, const size_t numKeys, const CastPropsCurveValue type, const CastPropsCurveMode mode, const float weight)
+	{
+		cast::CastNode curveNode(cast::CastId::Curve);
+		curve = &curveNode;
+
+		curve->ReserveProperties(6);
+
+		MakeCurveName(name, type);
+		MakeCurveKeyFrames(frames, numKeys);
+		MakeCurveKeyValues<float>(values, numKeys, numKeys, CastPropertyId::Float);
+		MakeCurveMode(mode, weight);
+
+		anim->AddChild(curveNode);
+	}
+
+	void CastNodeCurve::MakeCurveQuaternionKeyed(const char* name, const Quaternion* const values, const uint32_t* const frames, const size_t numKeys, const CastPropsCurveMode mode, const float weight)
+	{
+		cast::CastNode curveNode(cast::CastId::Curve);
+		curve = &curveNode;
+
+		curve->ReserveProperties(6);
+
+		MakeCurveName(name, CastPropsCurveValue::ROT_QUAT);
+		MakeCurveKeyFrames(frames, numKeys);
+		MakeCurveKeyValues<Quaternion>(values, numKeys, numKeys, CastPropertyId::Vector4);
+		MakeCurveMode(mode, weight);
+
+		anim->AddChild(curveNode);
+	}
+
 	// CAST HEADER/EXPORTER
 	CastNode* CastExporter::GetChild(const uint64_t hash)
 	{
@@ -599,7 +664,18 @@ namespace cast
 	// export this cast to file
 	void CastExporter::ToFile() const
 	{
-		char* fileBuf = new char[castFileSize] {}; // it would be possible to get the file size before writing, but the cost probably does not outweight just allocating a big buffer
+		// it would be possible to get the file size before writing, but the cost probably does not outweight just allocating a big buffer
+		const std::unique_ptr<char[]> fileBuf(new char[castFileSize]);
+
+		ToFile(fileBuf.get(), castFileSize);
+	}
+
+	const bool CastExporter::ToFile(char* const fileBuf, const size_t size) const
+	{
+		// every header and property is written in full, the buffer does not need clearing
+		if (!fileBuf || size < castFileSize)
+			return false;
+
 		char* curpos = fileBuf;
 
 		CastHeader* castHeader = reinterpret_cast<CastHeader*>(curpos);
@@ -619,12 +695,12 @@ namespace cast
 		if (!CreateDirectories(path.parent_path()))
 		{
 			assertm(false, "failed to create directory");
-			return;
+			return false;
 		}
 
 		StreamIO out(path.string(), eStreamIOMode::Write);
 		out.write(fileBuf, curpos - fileBuf);
 
-		delete[] fileBuf;
+		return true;
 	}
 }
\ No newline at end of file
@@ -547,6 +547,10 @@ namespace cast
 		void MakeCurveVector(const char* name, const Vector* const track, const size_t trackLength, const size_t numFrames, const CastPropsCurveValue type, const CastPropsCurveMode mode, const float weight = 1.0f);
 		void MakeCurveVector(const char* name, const Vector* const track, const size_t trackLength, const void* frameBuf, const size_t numFrames, const CastPropsCurveValue type, const CastPropsCurveMode mode, const float weight = 1.0f);
 
+		// sparse curves, values are keyed at the given frames instead of every frame
+		void MakeCurveFloatKeyed(const char* name, const float* const values, const uint32_t* const frames, const size_t numKeys, const CastPropsCurveValue type, const CastPropsCurveMode mode, const float weight = 1.0f);
+		void MakeCurveQuaternionKeyed(const char* name, const Quaternion* const values, const uint32_t* const frames, const size_t numKeys, const CastPropsCurveMode mode, const float weight = 1.0f);
+
 		static void* MakeCurveKeyFrameBuffer(const size_t numFrames, CastPropertyId& propType);
 		template<class T> static inline void MakeCurveKeyFrameBuffer(void* bufPtr, const size_t numFrames)
 		{
@@ -555,11 +559,19 @@ namespace cast
 			for (size_t i = 0; i < numFrames; i++)
 				frameIndices[i] = static_cast<T>(i);
 		}
+		template<class T> static inline void MakeCurveKeyFrameBuffer(void* bufPtr, const uint32_t* const frames, const size_t numKeys)
+		{
+			T* frameIndices = reinterpret_cast<T*>(bufPtr);
+
+			for (size_t i = 0; i < numKeys; i++)
+				frameIndices[i] = static_cast<T>(frames[i]);
+		}
 
 	private:
 		inline void MakeCurveName(const char* name, const CastPropsCurveValue type);
 		inline void MakeCurveKeyFrames(const size_t numFrames);
 		inline void MakeCurveKeyFrames(const void* frameBuf, const size_t numFrames);
+		inline void MakeCurveKeyFrames(const uint32_t* const frames, const size_t numKeys);
 		template<class PropType> inline void MakeCurveKeyValues(const PropType* const track, const size_t trackLength, const size_t numFrames, const CastPropertyId propId);
 		inline void MakeCurveMode(const CastPropsCurveMode mode, const float weight);
 		
@@ -632,6 +644,7 @@ namespace cast
 		CastNode* GetChild(const int idx) { return &rootNodes.at(idx); };
 
 		void ToFile() const;
+		const bool ToFile(char* const fileBuf, const size_t size) const; // caller owned buffer of at least castFileSize, reused between files
 
 	private:
 		std::filesystem::path path;
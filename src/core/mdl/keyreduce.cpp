@@ -0,0 +1,215 @@
+#include <pch.h>
+#include <core/mdl/keyreduce.h>
+
+// greedy forward pass, each segment is grown as far as its ends still reproduce every frame between them and that end becomes the next key
+// the end is found by doubling the segment then bisecting back, every segment is checked in full so the tolerance always holds even where the
+// error isn't monotonic, it just might end a segment early
+// segmentHolds(start, end) checks every frame between start and end, nearFirst(frame) checks a frame against the first one
+template <class NearFirstFn, class SegmentFn>
+static void ReduceKeys(const size_t numFrames, std::vector<uint32_t>& keys, const NearFirstFn& nearFirst, const SegmentFn& segmentHolds)
+{
+	keys.clear();
+
+	if (!numFrames)
+		return;
+
+	keys.push_back(0u);
+
+	// constant tracks keep a single key
+	bool constant = true;
+	for (size_t i = 1; i < numFrames && constant; i++)
+		constant = nearFirst(i);
+
+	if (constant)
+		return;
+
+	const size_t lastFrame = numFrames - 1;
+	size_t start = 0;
+
+	while (start < lastFrame)
+	{
+		// neighbouring frames always hold
+		size_t good = start + 1;
+		size_t bad = 0; // none found yet
+
+		for (size_t length = 2; good < lastFrame; length <<= 1)
+		{
+			const size_t end = std::min(start + length, lastFrame);
+
+			if (!segmentHolds(start, end))
+			{
+				bad = end;
+				break;
+			}
+
+			good = end;
+		}
+
+		while (bad && bad - good > 1)
+		{
+			const size_t mid = good + ((bad - good) >> 1);
+
+			if (segmentHolds(start, mid))
+				good = mid;
+			else
+				bad = mid;
+		}
+
+		keys.push_back(static_cast<uint32_t>(good));
+		start = good;
+	}
+}
+
+static inline const float KeyFraction(const size_t start, const size_t end, const size_t frame)
+{
+	return static_cast<float>(frame - start) / static_cast<float>(end - start);
+}
+
+static inline const float VectorDistSqr(const Vector& a, const Vector& b)
+{
+	const float x = a.x - b.x;
+	const float y = a.y - b.y;
+	const float z = a.z - b.z;
+
+	return (x * x) + (y * y) + (z * z);
+}
+
+static inline void VectorLerp(const Vector& a, const Vector& b, const float t, Vector& out)
+{
+	out.x = a.x + ((b.x - a.x) * t);
+	out.y = a.y + ((b.y - a.y) * t);
+	out.z = a.z + ((b.z - a.z) * t);
+}
+
+// rotations are within tolerance when the angle between them is, the angle is 4 * asin(|a - b| / 2) with b on the same side as a
+// the chord length stays precise for the tiny angles that go through a dot product as 1 - epsilon, and it needs no trig per frame
+static inline const bool QuaternionWithin(const Quaternion& a, const Quaternion& b, const float maxChordSqr)
+{
+	const float sign = (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w) < 0.0f ? -1.0f : 1.0f;
+
+	const float x = a.x - (b.x * sign);
+	const float y = a.y - (b.y * sign);
+	const float z = a.z - (b.z * sign);
+	const float w = a.w - (b.w * sign);
+
+	return (x * x) + (y * y) + (z * z) + (w * w) <= maxChordSqr;
+}
+
+static inline const float QuaternionMaxChordSqr(const float tolerance)
+{
+	const float chord = 2.0f * sinf(std::min(tolerance, XM_PI) * 0.25f);
+
+	return chord * chord;
+}
+
+const bool VectorWithinTolerance(const Vector& a, const Vector& b, const float tolerance)
+{
+	return VectorDistSqr(a, b) <= tolerance * tolerance;
+}
+
+const bool QuaternionWithinTolerance(const Quaternion& a, const Quaternion& b, const float tolerance)
+{
+	return QuaternionWithin(a, b, QuaternionMaxChordSqr(tolerance));
+}
+
+void ReduceVectorKeys(const Vector* const values, const size_t numFrames, const float tolerance, std::vector<uint32_t>& keys)
+{
+	const float toleranceSqr = tolerance * tolerance;
+
+	ReduceKeys(numFrames, keys,
+		[values, toleranceSqr](const size_t frame)
+		{
+			return VectorDistSqr(values[frame], values[0]) <= toleranceSqr;
+		},
+		[values, toleranceSqr](const size_t start, const size_t end)
+		{
+			Vector interp;
+
+			for (size_t frame = start + 1; frame < end; frame++)
+			{
+				VectorLerp(values[start], values[end], KeyFraction(start, end, frame), interp);
+
+				if (VectorDistSqr(values[frame], interp) > toleranceSqr)
+					return false;
+			}
+
+			return true;
+		});
+}
+
+void ReduceQuaternionKeys(const Quaternion* const values, const size_t numFrames, const float tolerance, std::vector<uint32_t>& keys)
+{
+	const float maxChordSqr = QuaternionMaxChordSqr(tolerance);
+
+	ReduceKeys(numFrames, keys,
+		[values, maxChordSqr](const size_t frame)
+		{
+			return QuaternionWithin(values[frame], values[0], maxChordSqr);
+		},
+		[values, maxChordSqr](const size_t start, const size_t end)
+		{
+			Quaternion interp;
+
+			for (size_t frame = start + 1; frame < end; frame++)
+			{
+				QuaternionSlerp(values[start], values[end], KeyFraction(start, end, frame), interp);
+
+				if (!QuaternionWithin(values[frame], interp, maxChordSqr))
+					return false;
+			}
+
+			return true;
+		});
+}
+
+void ResampleVectorKeys(const Vector* const values, const std::vector<uint32_t>& keys, const size_t numFrames, Vector* const out)
+{
+	assertm(!keys.empty(), "track should have at least one key");
+
+	if (keys.size() == 1)
+	{
+		for (size_t frame = 0; frame < numFrames; frame++)
+			out[frame] = values[keys[0]];
+
+		return;
+	}
+
+	for (size_t i = 0; i < keys.size() - 1; i++)
+	{
+		const size_t start = keys[i];
+		const size_t end = keys[i + 1];
+
+		out[start] = values[start];
+
+		for (size_t frame = start + 1; frame < end; frame++)
+			VectorLerp(values[start], values[end], KeyFraction(start, end, frame), out[frame]);
+	}
+
+	out[keys.back()] = values[keys.back()];
+}
+
+void ResampleQuaternionKeys(const Quaternion* const values, const std::vector<uint32_t>& keys, const size_t numFrames, Quaternion* const out)
+{
+	assertm(!keys.empty(), "track should have at least one key");
+
+	if (keys.size() == 1)
+	{
+		for (size_t frame = 0; frame < numFrames; frame++)
+			out[frame] = values[keys[0]];
+
+		return;
+	}
+
+	for (size_t i = 0; i < keys.size() - 1; i++)
+	{
+		const size_t start = keys[i];
+		const size_t end = keys[i + 1];
+
+		out[start] = values[start];
+
+		for (size_t frame = start + 1; frame < end; frame++)
+			QuaternionSlerp(values[start], values[end], KeyFraction(start, end, frame), out[frame]);
+	}
+
+	out[keys.back()] = values[keys.back()];
+}
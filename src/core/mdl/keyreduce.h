@@ -0,0 +1,25 @@
+#pragma once
+
+// tolerances a reduced track stays within at every source frame
+struct KeyReductionTolerance_t
+{
+	float pos;		// units
+	float rot;		// radians between the source rotation and the interpolated one
+	float scale;
+};
+
+//
+// keyframe reduction for exported animation tracks
+// keys are the indices of the source frames that are kept, frames between two keys are reproduced by interpolating them (lerp, slerp for rotations)
+// the first and last frames are always keys, unless every frame is within tolerance of the first, then the first frame is the only key
+//
+void ReduceVectorKeys(const Vector* const values, const size_t numFrames, const float tolerance, std::vector<uint32_t>& keys);
+void ReduceQuaternionKeys(const Quaternion* const values, const size_t numFrames, const float tolerance, std::vector<uint32_t>& keys);
+
+// the same checks the reduction uses, for comparing a reduced track against the value a format falls back to
+const bool VectorWithinTolerance(const Vector& a, const Vector& b, const float tolerance);
+const bool QuaternionWithinTolerance(const Quaternion& a, const Quaternion& b, const float tolerance);
+
+// rebuild every frame of a reduced track from its keys, for formats that can't store sparse keys
+void ResampleVectorKeys(const Vector* const values, const std::vector<uint32_t>& keys, const size_t numFrames, Vector* const out);
+void ResampleQuaternionKeys(const Quaternion* const values, const std::vector<uint32_t>& keys, const size_t numFrames, Quaternion* const out);
@@ -188,6 +188,191 @@ void Vertex_t::ParseVertexFromVG(Vertex_t* const vert, VertexWeight_t* const wei
 
 	assertm(offset == mesh->vertCacheSize, "parsed data size differed from vertexCacheSize");
 }
+
+//
+// VG BATCH DECODE
+// whole meshes are decoded by a kernel built for their layout, so the per vertex loop doesn't branch on layout flags.
+// output matches ParseVertexFromVG, which is kept as the reference.
+//
+static constexpr __m128 s_vector64Scale = { 0.0009765625f, 0.0009765625f, 0.0009765625f, 0.0f };
+static constexpr __m128 s_vector64Bias = { 1024.0f, 1024.0f, 2048.0f, 0.0f };
+
+// same as Vector64::Unpack, every component is at most 22 bits so the int to float conversion is exact
+FORCEINLINE void UnpackVector64SIMD(Vector& out, const uint64_t packed)
+{
+	const __m128i components = _mm_set_epi32(0, static_cast<int>(packed >> 42), static_cast<int>((packed >> 21) & 0x1FFFFF), static_cast<int>(packed & 0x1FFFFF));
+	const __m128 unpacked = SubSIMD(MulSIMD(_mm_cvtepi32_ps(components), s_vector64Scale), s_vector64Bias);
+
+	_mm_storel_pi(reinterpret_cast<__m64*>(&out.x), unpacked);
+	_mm_store_ss(&out.z, _mm_movehl_ps(unpacked, unpacked));
+}
+
+// returns the number of weights written
+template <bool hasExtraWeights>
+FORCEINLINE uint8_t ParseVertexWeightsVG(VertexWeight_t* const weights, const char* const weightData, const uint8_t* const boneMap, const vvw::mstudioboneweightextra_t* const weightExtra)
+{
+	const vg::BlendWeightsPacked_s* const blendWeights = VERT_DATA(vg::BlendWeightsPacked_s, weightData, 0);
+	const vg::BlendWeightIndices_s* const blendIndices = VERT_DATA(vg::BlendWeightIndices_s, weightData, 4);
+
+	uint16_t remaining = 32767; // 'weight' remaining to assign to the last bone
+
+	if constexpr (hasExtraWeights)
+	{
+		assertm(blendIndices->boneCount < 16, "model had more than 16 bones on complex weights");
+
+		weights[0].bone = boneMap[blendIndices->bone[0]];
+		weights[0].weight = blendWeights->Weight(0);
+		remaining -= blendWeights->weight[0];
+
+		const vvw::mstudioboneweightextra_t* const extra = &weightExtra[blendWeights->Index()];
+
+		uint8_t curIdx = 1;
+		for (; curIdx < blendIndices->boneCount; curIdx++)
+		{
+			weights[curIdx].bone = boneMap[extra[curIdx - 1].bone];
+			weights[curIdx].weight = extra[curIdx - 1].Weight();
+
+			remaining -= extra[curIdx - 1].weight;
+		}
+
+		if (blendIndices->boneCount > 0)
+		{
+			weights[curIdx].bone = boneMap[blendIndices->bone[1]];
+			weights[curIdx].weight = UNPACKWEIGHT(remaining);
+
+			curIdx++;
+		}
+
+		return curIdx;
+	}
+	else
+	{
+		UNUSED(weightExtra);
+		assertm(blendIndices->boneCount < 3, "model had more than 3 bones on simple weights");
+
+		const uint8_t boneCount = blendIndices->boneCount;
+		for (uint8_t i = 0; i < boneCount; i++)
+		{
+			weights[i].bone = boneMap[blendIndices->bone[i]];
+			weights[i].weight = blendWeights->Weight(i);
+
+			remaining -= blendWeights->weight[i];
+		}
+
+		weights[boneCount].bone = boneMap[blendIndices->bone[boneCount]];
+		weights[boneCount].weight = UNPACKWEIGHT(remaining);
+
+		return boneCount + 1;
+	}
+}
+
+template <vg::eVertPositionType posType, bool hasWeights, bool hasExtraWeights, bool hasColor, bool hasTexcoord0>
+static void ParseVerticesFromVGKernel(Vertex_t* const verts, VertexWeight_t* const weights, Vector2D* const texcoords, ModelMeshData_t* const mesh, const char* const rawVertexData, const uint8_t* const boneMap, const vvw::mstudioboneweightextra_t* const weightExtra, int& weightIdx)
+{
+	constexpr int positionSize = posType == vg::eVertPositionType::VG_POS_UNPACKED ? sizeof(Vector) : posType == vg::eVertPositionType::VG_POS_PACKED64 ? sizeof(Vector64) : posType == vg::eVertPositionType::VG_POS_PACKED48 ? 0x6 : 0;
+
+	constexpr int weightOffset = positionSize;
+	constexpr int normalOffset = weightOffset + (hasWeights ? 8 : 0);
+	constexpr int colorOffset = normalOffset + sizeof(Normal32);
+	constexpr int texcoord0Offset = colorOffset + (hasColor ? sizeof(Color32) : 0);
+	constexpr int texcoordOffset = texcoord0Offset + (hasTexcoord0 ? sizeof(Vector2D) : 0);
+
+	const size_t vertSize = mesh->vertCacheSize;
+	const size_t extraTexcoordCount = mesh->texcoordCount > 1 ? static_cast<size_t>(mesh->texcoordCount - 1) : 0ull;
+
+	assertm(texcoordOffset + (extraTexcoordCount * sizeof(Vector2D)) == vertSize, "parsed data size differed from vertexCacheSize");
+	assertm(extraTexcoordCount == 0ull || nullptr != texcoords, "texcoord pointer should be valid");
+	assertm(nullptr != weights, "weight pointer should be valid");
+
+	uint16_t weightsPerVert = mesh->weightsPerVert;
+	int curWeight = weightIdx;
+
+	for (uint32_t vertIdx = 0; vertIdx < mesh->vertCount; ++vertIdx)
+	{
+		const char* const vertexData = rawVertexData + (vertIdx * vertSize);
+		Vertex_t* const vert = &verts[vertIdx];
+
+		if constexpr (posType == vg::eVertPositionType::VG_POS_UNPACKED)
+			vert->position = *VERT_DATA(Vector, vertexData, 0);
+		else if constexpr (posType == vg::eVertPositionType::VG_POS_PACKED64)
+			UnpackVector64SIMD(vert->position, *VERT_DATA(uint64_t, vertexData, 0));
+		else if constexpr (posType == vg::eVertPositionType::VG_POS_PACKED48)
+			vert->position = Vector(0.0f);
+
+		uint8_t weightCount = 1;
+		if constexpr (hasWeights)
+		{
+			weightCount = ParseVertexWeightsVG<hasExtraWeights>(&weights[curWeight], vertexData + weightOffset, boneMap, weightExtra);
+		}
+		else
+		{
+			UNUSED(boneMap);
+			UNUSED(weightExtra);
+
+			// [rika]: this can only happen when a model has one bone
+			weights[curWeight].bone = 0;
+			weights[curWeight].weight = 1.0f;
+		}
+
+		vert->weightIndex = curWeight;
+		vert->weightCount = weightCount;
+
+		curWeight += weightCount;
+		weightsPerVert = weightCount > weightsPerVert ? weightCount : weightsPerVert;
+
+		vert->normalPacked = *VERT_DATA(Normal32, vertexData, normalOffset);
+
+		if constexpr (hasColor)
+			vert->color = *VERT_DATA(Color32, vertexData, colorOffset);
+		else
+			vert->color = Color32(255, 255);
+
+		if constexpr (hasTexcoord0)
+			vert->texcoord = *VERT_DATA(Vector2D, vertexData, texcoord0Offset);
+
+		if (extraTexcoordCount > 0ull)
+			memcpy(&texcoords[vertIdx * extraTexcoordCount], vertexData + texcoordOffset, extraTexcoordCount * sizeof(Vector2D));
+	}
+
+	mesh->weightsPerVert = weightsPerVert;
+	weightIdx = curWeight;
+}
+
+// bits 0-1: position type, 2: weights, 3: extra weights, 4: color, 5: texcoord0
+typedef void(*VGVertexKernel_t)(Vertex_t* const, VertexWeight_t* const, Vector2D* const, ModelMeshData_t* const, const char* const, const uint8_t* const, const vvw::mstudioboneweightextra_t* const, int&);
+static constexpr uint32_t s_vgVertexKernelCount = 64u;
+
+template <uint32_t kernel>
+static constexpr VGVertexKernel_t VGVertexKernel()
+{
+	return &ParseVerticesFromVGKernel<static_cast<vg::eVertPositionType>(kernel & 3), (kernel & 4) != 0, (kernel & 8) != 0, (kernel & 16) != 0, (kernel & 32) != 0>;
+}
+
+template <uint32_t... kernels>
+static constexpr std::array<VGVertexKernel_t, sizeof...(kernels)> VGVertexKernelTable(std::integer_sequence<uint32_t, kernels...>)
+{
+	return { VGVertexKernel<kernels>()... };
+}
+
+static constexpr std::array<VGVertexKernel_t, s_vgVertexKernelCount> s_vgVertexKernels = VGVertexKernelTable(std::make_integer_sequence<uint32_t, s_vgVertexKernelCount>());
+
+void Vertex_t::ParseVerticesFromVG(Vertex_t* const verts, VertexWeight_t* const weights, Vector2D* const texcoords, ModelMeshData_t* const mesh, const char* const rawVertexData, const uint8_t* const boneMap, const vvw::mstudioboneweightextra_t* const weightExtra, int& weightIdx)
+{
+	const uint64_t flags = mesh->rawVertexLayoutFlags;
+
+	// note: if for some reason 'VERT_BLENDWEIGHTS_UNPACKED' is encountered, weights would not be processed.
+	assertm(!(flags & VERT_BLENDWEIGHTS_UNPACKED), "mesh had unpacked weights!");
+
+	const bool hasWeights = (flags & (VERT_BLENDINDICES | VERT_BLENDWEIGHTS_PACKED)) != 0ull;
+
+	uint32_t kernel = static_cast<uint32_t>(flags & 3);
+	kernel |= hasWeights ? 4u : 0u;
+	kernel |= hasWeights && nullptr != weightExtra ? 8u : 0u; // extra weights are only read with packed weights, don't build kernels for them otherwise
+	kernel |= flags & VERT_COLOR ? 16u : 0u;
+	kernel |= flags & VERT_TEXCOORD0 ? 32u : 0u;
+
+	s_vgVertexKernels[kernel](verts, weights, texcoords, mesh, rawVertexData, boneMap, weightExtra, weightIdx);
+}
 #undef VERT_DATA
 
 // Generic (basic data shared between them)
@@ -333,6 +518,24 @@ void ModelMeshData_t::ParseMaterial(ModelParsedData_t* const parsed, const int m
 	materialAsset = parsed->materials.at(material).asset;
 }
 
+void ReleaseModelMaterialRefs(ModelParsedData_t* const parsedData)
+{
+	for (ModelMaterialData_t& matlData : parsedData->materials)
+	{
+		if (g_assetData.IsUnloading(matlData.asset))
+			matlData.asset = nullptr;
+	}
+
+	for (ModelLODData_t& lodData : parsedData->lods)
+	{
+		for (ModelMeshData_t& meshData : lodData.meshes)
+		{
+			if (g_assetData.IsUnloading(meshData.materialAsset))
+				meshData.materialAsset = nullptr;
+		}
+	}
+}
+
 // bones
 void ParseModelBoneData_v8(ModelParsedData_t* const parsedData)
 {
@@ -564,7 +767,7 @@ void ParseModelAnimTypes_V8(ModelParsedData_t* const parsedData)
 	// technically supported but never used
 	/*if (pStudioHdr->localIkAutoPlayLockCount > 0)
 	{
-		printf("wooowowww~~!! iklocks in: %s\n", pStudioHdr->pszName());
+		LOG_DEBUG(MODEL, "wooowowww~~!! iklocks in: %s\n", pStudioHdr->pszName());
 
 		parsedData->iklocks = new ModelIKLock_t[pStudioHdr->localIkAutoPlayLockCount];
 		const r5::mstudioiklock_v8_t* const iklocks = reinterpret_cast<const r5::mstudioiklock_v8_t* const>(pStudioHdr->baseptr + pStudioHdr->localIkAutoPlayLockOffset);
@@ -1281,7 +1484,7 @@ bool ExportModelRMAX(const ModelParsedData_t* const parsedData, std::filesystem:
 			rmaxFile.AddMaterial(matlAsset->name);
 
 			// [rika]: write stub material (unused material)
-			if (!materials.contains(materialId) || !matlAsset->resourceBindings.size())
+			if (!materials.contains(materialId) || !matlAsset->ResourceBindings().size())
 				continue;
 
 			const ModelMaterialExport_t& materialExport = materials.find(materialId)->second;
@@ -1291,10 +1494,10 @@ bool ExportModelRMAX(const ModelParsedData_t* const parsedData, std::filesystem:
 			for (const TextureAssetEntry_t& entry : matlAsset->txtrAssets)
 			{
 				// [rika]: we don't have a resource binding or we don't have a name for the texture
-				if (!matlAsset->resourceBindings.count(entry.index) || !materialExport.textures.contains(entry.index))
+				if (!matlAsset->ResourceBindings().count(entry.index) || !materialExport.textures.contains(entry.index))
 					continue;
 
-				const std::string resource = matlAsset->resourceBindings.find(entry.index)->second.name;
+				const std::string resource = matlAsset->ResourceBindings().find(entry.index)->second.name;
 
 				// [rika]: do we need this resource?
 				if (!rmax::s_TextureTypeMap.count(resource))
@@ -1464,7 +1667,7 @@ bool ExportModelCast(const ModelParsedData_t* const parsedData, std::filesystem:
 
 			// [rika]: parse out our textures if we have bindings for them, don't if not
 			// [rika]: exit early if no textures
-			if (materialAsset->resourceBindings.empty())
+			if (materialAsset->ResourceBindings().empty())
 			{
 				modelNode->AddChild(matlNode);
 				continue;
@@ -1473,10 +1676,10 @@ bool ExportModelCast(const ModelParsedData_t* const parsedData, std::filesystem:
 			for (const TextureAssetEntry_t& entry : materialAsset->txtrAssets)
 			{
 				// [rika]: texture cannot be accurately identified, skip it
-				if (!materialAsset->resourceBindings.count(entry.index))
+				if (!materialAsset->ResourceBindings().count(entry.index))
 					continue;
 
-				const std::string resource(materialAsset->resourceBindings.find(entry.index)->second.name);
+				const std::string resource(materialAsset->ResourceBindings().find(entry.index)->second.name);
 
 				// [rika]: texture type isn't supported, skip it
 				if (!cast::s_TextureTypeMap.count(resource))
@@ -1486,7 +1689,7 @@ bool ExportModelCast(const ModelParsedData_t* const parsedData, std::filesystem:
 				if (!material.textures.contains(entry.index))
 				{
 					// todo: store a name in parsed data
-					//Log("Material %s for model %s did not have a valid texture pointer for res idx %i\n", materialAsset->name, name, entry.index);
+					//LOG_DEBUG(MODEL, "Material %s for model %s did not have a valid texture pointer for res idx %i\n", materialAsset->name, name, entry.index);
 
 					continue;
 				}
@@ -2400,13 +2603,163 @@ bool ExportModelQC(const ModelParsedData_t* const parsedData, std::filesystem::p
 	return true;
 }
 
+static void WriteSeqDescRMAX(const rmax::RMAXExporter& rmaxFile, SeqExportScratch_t& scratch)
+{
+	char* const buffer = scratch.Buffer();
+
+	if (buffer)
+		rmaxFile.ToFile(buffer, managedBufferSize);
+	else
+		rmaxFile.ToFile();
+}
+
+static void WriteSeqDescCast(const cast::CastExporter& cast, SeqExportScratch_t& scratch)
+{
+	char* const buffer = scratch.Buffer();
+
+	if (buffer)
+		cast.ToFile(buffer, managedBufferSize);
+	else
+		cast.ToFile();
+}
+
+SeqExportSkeleton_t::SeqExportSkeleton_t(const std::vector<ModelBone_t>* const bonesIn) : bones(bonesIn), boneCount(bonesIn ? bonesIn->size() : 0ull),
+	reduceKeys(g_ExportSettings.exportSeqKeyReduction), keyTolerance{ g_ExportSettings.exportSeqKeyPosTolerance, g_ExportSettings.exportSeqKeyRotTolerance * s_DEG2RAD_CONST, g_ExportSettings.exportSeqKeyScaleTolerance }
+{
+	bindRot.reserve(boneCount);
+
+	for (size_t i = 0; i < boneCount; i++)
+		bindRot.emplace_back(bones->at(i).quat);
+}
+
+SeqExportScratch_t::~SeqExportScratch_t()
+{
+	FreeAllocVar(smd);
+
+	if (buffer)
+		g_BufferManager.RelieveBuffer(buffer);
+}
+
+char* const SeqExportScratch_t::Buffer()
+{
+	if (!bufferClaimed)
+	{
+		buffer = g_BufferManager.ClaimBuffer();
+		bufferClaimed = true;
+	}
+
+	return buffer ? buffer->Buffer() : nullptr;
+}
+
+void ExportSequencesParallel(const uint32_t numSeqs, const std::function<void(const uint32_t, SeqExportScratch_t&)>& exportSeq)
+{
+	if (!numSeqs)
+		return;
+
+	const uint32_t threadCount = std::clamp(UtilsConfig->exportThreadCount, 1u, numSeqs);
+
+	// asset list exports already run one asset per export thread, starting more threads from each of those would give threadCount squared
+	if (threadCount == 1u || CParallelTask::isWorkerThread())
+	{
+		SeqExportScratch_t scratch;
+
+		for (uint32_t i = 0; i < numSeqs; i++)
+			exportSeq(i, scratch);
+
+		return;
+	}
+
+	std::atomic<uint32_t> seqIdx = 0;
+
+	CParallelTask parallelSeqTask(threadCount);
+
+	parallelSeqTask.addTask([numSeqs, &seqIdx, &exportSeq]
+	{
+		SeqExportScratch_t scratch;
+
+		while (seqIdx < numSeqs)
+		{
+			const uint32_t seqToExport = seqIdx++;
+			if (seqToExport >= numSeqs)
+				continue;
+
+			exportSeq(seqToExport, scratch);
+		}
+	}, threadCount);
+
+	parallelSeqTask.execute();
+	parallelSeqTask.wait();
+}
+
+// rmax can't store sparse keys, so reduced tracks are rebuilt at every frame from their keys
+// a channel that reduces to the bind pose is dropped, rmax falls back to the bone's value for channels without a track
+static const uint8_t ReduceSeqTrackRMAX(const ModelBone_t* const boneData, const animdesc_t* const animdesc, uint8_t flags, const Vector*& pos, const Quaternion*& q, const Vector*& scale,
+	const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch)
+{
+	const size_t numFrames = static_cast<size_t>(animdesc->numframes);
+	const bool canDrop = !(animdesc->flags & eStudioAnimFlags::ANIM_DELTA);
+
+	if (pos)
+	{
+		ReduceVectorKeys(pos, numFrames, skeleton.keyTolerance.pos, scratch.keys);
+
+		if (canDrop && scratch.keys.size() == 1 && VectorWithinTolerance(pos[0], boneData->pos, skeleton.keyTolerance.pos))
+		{
+			flags = static_cast<uint8_t>(flags & ~CAnimDataBone::ANIMDATA_POS);
+			pos = nullptr;
+		}
+		else
+		{
+			scratch.resampledPos.resize(numFrames);
+			ResampleVectorKeys(pos, scratch.keys, numFrames, scratch.resampledPos.data());
+			pos = scratch.resampledPos.data();
+		}
+	}
+
+	if (q)
+	{
+		ReduceQuaternionKeys(q, numFrames, skeleton.keyTolerance.rot, scratch.keys);
+
+		if (canDrop && scratch.keys.size() == 1 && QuaternionWithinTolerance(q[0], boneData->quat, skeleton.keyTolerance.rot))
+		{
+			flags = static_cast<uint8_t>(flags & ~CAnimDataBone::ANIMDATA_ROT);
+			q = nullptr;
+		}
+		else
+		{
+			scratch.resampledRot.resize(numFrames);
+			ResampleQuaternionKeys(q, scratch.keys, numFrames, scratch.resampledRot.data());
+			q = scratch.resampledRot.data();
+		}
+	}
+
+	if (scale)
+	{
+		ReduceVectorKeys(scale, numFrames, skeleton.keyTolerance.scale, scratch.keys);
+
+		if (canDrop && scratch.keys.size() == 1 && VectorWithinTolerance(scale[0], boneData->scale, skeleton.keyTolerance.scale))
+		{
+			flags = static_cast<uint8_t>(flags & ~CAnimDataBone::ANIMDATA_SCL);
+			scale = nullptr;
+		}
+		else
+		{
+			scratch.resampledScale.resize(numFrames);
+			ResampleVectorKeys(scale, scratch.keys, numFrames, scratch.resampledScale.data());
+			scale = scratch.resampledScale.data();
+		}
+	}
+
+	return flags;
+}
+
 // export a seqdesc to rmax
-bool ExportSeqDescRMAX(const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const char* const skelName, const std::vector<ModelBone_t>* const bones)
+static bool ExportSeqDescRMAX(const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch)
 {
 	const std::string fileNameBase = exportPath.stem().string();
-	const std::string skelNameBase = std::filesystem::path(skelName).stem().string();
 
-	const size_t boneCount = bones->size();
+	const std::vector<ModelBone_t>* const bones = skeleton.bones;
+	const size_t boneCount = skeleton.boneCount;
 
 	for (int animIdx = 0; animIdx < seqdesc->AnimCount(); animIdx++)
 	{
@@ -2438,7 +2791,7 @@ bool ExportSeqDescRMAX(const seqdesc_t* const seqdesc, std::filesystem::path& ex
 
 		if (anim->GetFlags() & rmax::AnimFlags_t::ANIM_EMPTY)
 		{
-			rmaxFile.ToFile();
+			WriteSeqDescRMAX(rmaxFile, scratch);
 
 			continue;
 		}
@@ -2448,10 +2801,7 @@ bool ExportSeqDescRMAX(const seqdesc_t* const seqdesc, std::filesystem::path& ex
 
 		for (int i = 0; i < boneCount; i++)
 		{
-			const uint8_t flags = animData.GetFlag(i);
-
-			anim->SetTrack(flags, static_cast<uint16_t>(i));
-			rmax::RMAXAnimTrack* const track = anim->GetTrack(i);
+			uint8_t flags = animData.GetFlag(i);
 
 			const Vector* pos = nullptr;
 			const Quaternion* q = nullptr;
@@ -2466,25 +2816,78 @@ bool ExportSeqDescRMAX(const seqdesc_t* const seqdesc, std::filesystem::path& ex
 			if (flags & CAnimDataBone::ANIMDATA_SCL)
 				scale = animData.GetBoneScaleForFrame(i, 0);
 
+			if (skeleton.reduceKeys)
+				flags = ReduceSeqTrackRMAX(&bones->at(i), animdesc, flags, pos, q, scale, skeleton, scratch);
+
+			anim->SetTrack(flags, static_cast<uint16_t>(i));
+			rmax::RMAXAnimTrack* const track = anim->GetTrack(i);
+
 			for (int frameIdx = 0; frameIdx < animdesc->numframes; frameIdx++)
 			{
 				track->AddFrame(frameIdx, &pos[frameIdx], &q[frameIdx], &scale[frameIdx]);
 			}
 		}
 
-		rmaxFile.ToFile();
+		WriteSeqDescRMAX(rmaxFile, scratch);
 	}
 
 	return true;
 }
 
+// cast curves are per channel, the track is reduced as a whole so every channel shares its keys and the tolerance is a distance like rmax and smd
+static void MakeSeqCurveVector(cast::CastNode* const animNode, const char* const name, const Vector* const track, const size_t trackLength, const void* const frameBuffer, const size_t numFrames,
+	const cast::CastPropsCurveValue type, const cast::CastPropsCurveMode mode, const float weight, const SeqExportSkeleton_t& skeleton, const float tolerance, SeqExportScratch_t& scratch)
+{
+	if (!skeleton.reduceKeys)
+	{
+		cast::CastNodeCurve curveNode(animNode);
+		curveNode.MakeCurveVector(name, track, trackLength, frameBuffer, numFrames, type, mode, weight);
+
+		return;
+	}
+
+	ReduceVectorKeys(track, trackLength, tolerance, scratch.keys);
+	scratch.keyValues.resize(scratch.keys.size());
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (size_t i = 0; i < scratch.keys.size(); i++)
+			scratch.keyValues[i] = track[scratch.keys[i]][axis];
+
+		cast::CastNodeCurve curveNode(animNode);
+		curveNode.MakeCurveFloatKeyed(name, scratch.keyValues.data(), scratch.keys.data(), scratch.keys.size(), static_cast<cast::CastPropsCurveValue>(axis + static_cast<int>(type)), mode, weight);
+	}
+}
+
+static void MakeSeqCurveQuaternion(cast::CastNode* const animNode, const char* const name, const Quaternion* const track, const size_t trackLength, const void* const frameBuffer, const size_t numFrames,
+	const cast::CastPropsCurveMode mode, const float weight, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch)
+{
+	cast::CastNodeCurve curveNode(animNode);
+
+	if (!skeleton.reduceKeys)
+	{
+		curveNode.MakeCurveQuaternion(name, track, trackLength, frameBuffer, numFrames, mode, weight);
+
+		return;
+	}
+
+	ReduceQuaternionKeys(track, trackLength, skeleton.keyTolerance.rot, scratch.keys);
+
+	scratch.keyRots.resize(scratch.keys.size());
+	for (size_t i = 0; i < scratch.keys.size(); i++)
+		scratch.keyRots[i] = track[scratch.keys[i]];
+
+	curveNode.MakeCurveQuaternionKeyed(name, scratch.keyRots.data(), scratch.keys.data(), scratch.keys.size(), mode, weight);
+}
+
 // export a seq desc to cast
-bool ExportSeqDescCast(const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const char* const skelName, const std::vector<ModelBone_t>* const bones, const uint64_t guid)
+static bool ExportSeqDescCast(const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch, const uint64_t guid)
 {
 	const std::string fileNameBase = exportPath.stem().string();
-	const std::string skelNameBase = std::filesystem::path(skelName).stem().string();
+	const uint64_t skelHash = RTech::StringToGuid(fileNameBase.c_str());
 
-	const size_t boneCount = bones->size();
+	const std::vector<ModelBone_t>* const bones = skeleton.bones;
+	const size_t boneCount = skeleton.boneCount;
 
 	for (int animIdx = 0; animIdx < seqdesc->AnimCount(); animIdx++)
 	{
@@ -2510,7 +2913,7 @@ bool ExportSeqDescCast(const seqdesc_t* const seqdesc, std::filesystem::path& ex
 		// do skeleton
 		{
 			// it would be more ideal to just feed it bones, but I don't want to deal with that mess of functions currently
-			cast::CastNode* const skelNode = animNode->AddChild(cast::CastId::Skeleton, RTech::StringToGuid(fileNameBase.c_str()));
+			cast::CastNode* const skelNode = animNode->AddChild(cast::CastId::Skeleton, skelHash);
 			skelNode->ReserveChildren(boneCount);
 
 			// uses hashes for lookup, still gets bone parents by index :clown:
@@ -2526,7 +2929,7 @@ bool ExportSeqDescCast(const seqdesc_t* const seqdesc, std::filesystem::path& ex
 		// [rika]: not touching this for now since we really don't care about empty bones on types not for re import
 		if (!(animdesc->flags & eStudioAnimFlags::ANIM_VALID) || animdesc->parsedBufferIndex == invalidNoodleIdx)
 		{
-			cast.ToFile();
+			WriteSeqDescCast(cast, scratch);
 
 			continue;
 		}
@@ -2544,6 +2947,9 @@ bool ExportSeqDescCast(const seqdesc_t* const seqdesc, std::filesystem::path& ex
 		Quaternion deltaQuat(0.0f, 0.0f, 0.0f, 1.0f);
 		Vector deltaScale(1.0f, 1.0f, 1.0f);
 
+		const size_t numFrames = static_cast<size_t>(animdesc->numframes);
+		const bool isDelta = animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? true : false;
+
 		for (int i = 0; i < boneCount; i++)
 		{
 			const ModelBone_t* const boneData = &bones->at(i);
@@ -2554,51 +2960,28 @@ bool ExportSeqDescCast(const seqdesc_t* const seqdesc, std::filesystem::path& ex
 			// weight for delta anims
 			const float animWeight = seqdesc->Weight(i);
 
+			// channels without a track hold the bind pose, or no change for delta anims
 			if (flags & CAnimDataBone::ANIMDATA_POS)
-			{
-				cast::CastNodeCurve curveNode(animNode);
-				curveNode.MakeCurveVector(boneData->name, animData.GetBonePosForFrame(i, 0), static_cast<size_t>(animdesc->numframes), frameBuffer, static_cast<size_t>(animdesc->numframes), cast::CastPropsCurveValue::POS_X, curveMode, animWeight);
-			}
+				MakeSeqCurveVector(animNode, boneData->name, animData.GetBonePosForFrame(i, 0), numFrames, frameBuffer, numFrames, cast::CastPropsCurveValue::POS_X, curveMode, animWeight, skeleton, skeleton.keyTolerance.pos, scratch);
 			else
-			{
-				const Vector* const track = animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? &deltaPos : &boneData->pos;
-
-				cast::CastNodeCurve curveNode(animNode);
-				curveNode.MakeCurveVector(boneData->name, track, 1ull, frameBuffer, static_cast<size_t>(animdesc->numframes), cast::CastPropsCurveValue::POS_X, curveMode, animWeight);
-			}
+				MakeSeqCurveVector(animNode, boneData->name, isDelta ? &deltaPos : &boneData->pos, 1ull, frameBuffer, numFrames, cast::CastPropsCurveValue::POS_X, curveMode, animWeight, skeleton, skeleton.keyTolerance.pos, scratch);
 
 			if (flags & CAnimDataBone::ANIMDATA_ROT)
-			{
-				cast::CastNodeCurve curveNode(animNode);
-				curveNode.MakeCurveQuaternion(boneData->name, animData.GetBoneQuatForFrame(i, 0), static_cast<size_t>(animdesc->numframes), frameBuffer, static_cast<size_t>(animdesc->numframes), curveMode, animWeight);
-			}
+				MakeSeqCurveQuaternion(animNode, boneData->name, animData.GetBoneQuatForFrame(i, 0), numFrames, frameBuffer, numFrames, curveMode, animWeight, skeleton, scratch);
 			else
-			{
-				const Quaternion* const track = animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? &deltaQuat : &boneData->quat;
-
-				cast::CastNodeCurve curveNode(animNode);
-				curveNode.MakeCurveQuaternion(boneData->name, track, 1ull, frameBuffer, static_cast<size_t>(animdesc->numframes), curveMode, animWeight);
-			}
+				MakeSeqCurveQuaternion(animNode, boneData->name, isDelta ? &deltaQuat : &boneData->quat, 1ull, frameBuffer, numFrames, curveMode, animWeight, skeleton, scratch);
 
 			// check if the sequence has scale data.
 			if (seqdesc->flags & 0x20000)
 			{
 				if (flags & CAnimDataBone::ANIMDATA_SCL)
-				{
-					cast::CastNodeCurve curveNode(animNode);
-					curveNode.MakeCurveVector(boneData->name, animData.GetBoneScaleForFrame(i, 0), static_cast<size_t>(animdesc->numframes), frameBuffer, static_cast<size_t>(animdesc->numframes), cast::CastPropsCurveValue::SCL_X, curveMode, animWeight);
-				}
+					MakeSeqCurveVector(animNode, boneData->name, animData.GetBoneScaleForFrame(i, 0), numFrames, frameBuffer, numFrames, cast::CastPropsCurveValue::SCL_X, curveMode, animWeight, skeleton, skeleton.keyTolerance.scale, scratch);
 				else
-				{
-					const Vector* track = animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? &deltaScale : &boneData->scale;
-
-					cast::CastNodeCurve curveNode(animNode);
-					curveNode.MakeCurveVector(boneData->name, track, 1ull, frameBuffer, static_cast<size_t>(animdesc->numframes), cast::CastPropsCurveValue::SCL_X, curveMode, animWeight);
-				}
+					MakeSeqCurveVector(animNode, boneData->name, isDelta ? &deltaScale : &boneData->scale, 1ull, frameBuffer, numFrames, cast::CastPropsCurveValue::SCL_X, curveMode, animWeight, skeleton, skeleton.keyTolerance.scale, scratch);
 			}
 		}
 
-		cast.ToFile();
+		WriteSeqDescCast(cast, scratch);
 
 		delete[] frameBuffer;
 	}
@@ -2606,27 +2989,93 @@ bool ExportSeqDescCast(const seqdesc_t* const seqdesc, std::filesystem::path& ex
 	return true;
 }
 
-bool ExportSeqDescSMD(const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const char* const skelName, const std::vector<ModelBone_t>* const bones)
+// smd lists every bone on every frame, reduced tracks are rebuilt at every frame from their keys
+// bones are filled one at a time across all frames so each track is only reduced once
+static void ExportSeqDescSMDReduced(const animdesc_t* const animdesc, const CAnimData& animData, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch)
 {
-	const std::string fileNameBase = exportPath.stem().string();
-	const std::string skelNameBase = std::filesystem::path(skelName).stem().string();
+	const std::vector<ModelBone_t>* const bones = skeleton.bones;
+	const size_t numFrames = static_cast<size_t>(animdesc->numframes);
+	const bool isDelta = animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? true : false;
 
-	const size_t boneCount = bones->size();
+	const Vector deltaPos(0.0f, 0.0f, 0.0f);
+	const RadianEuler deltaRot(0.0f, 0.0f, 0.0f);
 
-	smd::CSourceModelData* const smd = new smd::CSourceModelData(exportPath.parent_path(), bones->size(), 1ull);
+	smd::CSourceModelData* const smd = scratch.smd;
 
-	// [rika]: initialize the nodes
-	for (size_t i = 0; i < boneCount; i++)
+	for (int bone = 0; bone < skeleton.boneCount; bone++)
+	{
+		const ModelBone_t* const boneData = &bones->at(bone);
+
+		// parsed data
+		const uint8_t flags = animData.GetFlag(bone);
+
+		const Vector* pos = nullptr;
+		const Quaternion* q = nullptr;
+
+		if (flags & CAnimDataBone::ANIMDATA_POS)
+		{
+			const Vector* const track = animData.GetBonePosForFrame(bone, 0);
+
+			ReduceVectorKeys(track, numFrames, skeleton.keyTolerance.pos, scratch.keys);
+
+			scratch.resampledPos.resize(numFrames);
+			ResampleVectorKeys(track, scratch.keys, numFrames, scratch.resampledPos.data());
+			pos = scratch.resampledPos.data();
+		}
+
+		if (flags & CAnimDataBone::ANIMDATA_ROT)
+		{
+			const Quaternion* const track = animData.GetBoneQuatForFrame(bone, 0);
+
+			ReduceQuaternionKeys(track, numFrames, skeleton.keyTolerance.rot, scratch.keys);
+
+			scratch.resampledRot.resize(numFrames);
+			ResampleQuaternionKeys(track, scratch.keys, numFrames, scratch.resampledRot.data());
+			q = scratch.resampledRot.data();
+		}
+
+		const Vector& staticPos = isDelta ? deltaPos : boneData->pos;
+		const RadianEuler& staticRot = isDelta ? deltaRot : skeleton.bindRot[bone];
+
+		for (int frame = 0; frame < animdesc->numframes; frame++)
+		{
+			if (q)
+				smd->InitFrameBone(frame, bone, pos ? pos[frame] : staticPos, RadianEuler(q[frame]));
+			else
+				smd->InitFrameBone(frame, bone, pos ? pos[frame] : staticPos, staticRot);
+		}
+	}
+}
+
+static bool ExportSeqDescSMD(const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch)
+{
+	const std::vector<ModelBone_t>* const bones = skeleton.bones;
+	const size_t boneCount = skeleton.boneCount;
+
+	// [rika]: initialize the nodes, the scratch keeps them for every sequence after the first
+	if (!scratch.smd)
 	{
-		const ModelBone_t& bone = bones->at(i);
+		scratch.smd = new smd::CSourceModelData(exportPath.parent_path(), boneCount, 1ull);
+
+		for (size_t i = 0; i < boneCount; i++)
+		{
+			const ModelBone_t& bone = bones->at(i);
 
-		smd->InitNode(bone.name, static_cast<int>(i), bone.parent);
+			scratch.smd->InitNode(bone.name, static_cast<int>(i), bone.parent);
+		}
+	}
+	else
+	{
+		assertm(scratch.smd->NodeCount() == boneCount, "scratch was set up for a different skeleton");
+		scratch.smd->SetPath(exportPath.parent_path());
 	}
 
+	smd::CSourceModelData* const smd = scratch.smd;
+
 	const Vector deltaPos(0.0f, 0.0f, 0.0f);
-	const Quaternion deltaQuat(0.0f, 0.0f, 0.0f, 1.0f);
+	const RadianEuler deltaRot(0.0f, 0.0f, 0.0f);
 
-	CManagedBuffer* const buf = g_BufferManager.ClaimBuffer();
+	char* const buf = scratch.Buffer();
 
 	for (int animIdx = 0; animIdx < seqdesc->AnimCount(); animIdx++)
 	{
@@ -2649,62 +3098,69 @@ bool ExportSeqDescSMD(const seqdesc_t* const seqdesc, std::filesystem::path& exp
 		const std::unique_ptr<char[]> noodle = seqdesc->parsedData.getIdx(animdesc->parsedBufferIndex);
 		CAnimData animData(noodle.get());
 
-		for (int frame = 0; frame < animdesc->numframes; frame++)
+		if (skeleton.reduceKeys)
 		{
-			for (int bone = 0; bone < boneCount; bone++)
+			ExportSeqDescSMDReduced(animdesc, animData, skeleton, scratch);
+		}
+		else
+		{
+			for (int frame = 0; frame < animdesc->numframes; frame++)
 			{
-				const ModelBone_t* const boneData = &bones->at(bone);
-
-				// parsed data
-				const uint8_t flags = animData.GetFlag(bone);
+				for (int bone = 0; bone < boneCount; bone++)
+				{
+					const ModelBone_t* const boneData = &bones->at(bone);
 
-				const Vector* pos = nullptr;
-				const Quaternion* q = nullptr;
+					// parsed data
+					const uint8_t flags = animData.GetFlag(bone);
 
-				if (flags & CAnimDataBone::ANIMDATA_POS)
-					pos = animData.GetBonePosForFrame(bone, frame);
-				else
-					pos = animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? &deltaPos : &boneData->pos;
+					const Vector* pos = nullptr;
 
-				if (flags & CAnimDataBone::ANIMDATA_ROT)
-					q = animData.GetBoneQuatForFrame(bone, frame);
-				else
-					q = animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? &deltaQuat : &boneData->quat;
+					if (flags & CAnimDataBone::ANIMDATA_POS)
+						pos = animData.GetBonePosForFrame(bone, frame);
+					else
+						pos = animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? &deltaPos : &boneData->pos;
 
-				assertm(pos, "should not be nullptr");
-				assertm(q, "should not be nullptr");
+					assertm(pos, "should not be nullptr");
 
-				const RadianEuler rot(*q);
+					// bones without a rotation track use the rotation converted once by the skeleton
+					if (flags & CAnimDataBone::ANIMDATA_ROT)
+					{
+						const Quaternion* const q = animData.GetBoneQuatForFrame(bone, frame);
+						assertm(q, "should not be nullptr");
 
-				smd->InitFrameBone(frame, bone, *pos, rot);
+						smd->InitFrameBone(frame, bone, *pos, RadianEuler(*q));
+					}
+					else
+						smd->InitFrameBone(frame, bone, *pos, animdesc->flags & eStudioAnimFlags::ANIM_DELTA ? deltaRot : skeleton.bindRot[bone]);
+				}
 			}
 		}
 
-		smd->Write(buf->Buffer(), managedBufferSize);
+		if (buf)
+			smd->Write(buf, managedBufferSize);
+		else
+			smd->Write();
 	}
 
-	FreeAllocVar(smd);
-	g_BufferManager.RelieveBuffer(buf);
-
 	return true;
 }
 
-bool ExportSeqDesc(const int setting, const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const char* const skelName, const std::vector<ModelBone_t>* const bones, const uint64_t guid)
+bool ExportSeqDesc(const int setting, const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch, const uint64_t guid)
 {
 	switch (setting)
 	{
 
 	case eAnimSeqExportSetting::ANIMSEQ_CAST:
 	{
-		return ExportSeqDescCast(seqdesc, exportPath, skelName, bones, guid);
+		return ExportSeqDescCast(seqdesc, exportPath, skeleton, scratch, guid);
 	}
 	case eAnimSeqExportSetting::ANIMSEQ_RMAX:
 	{
-		return ExportSeqDescRMAX(seqdesc, exportPath, skelName, bones);
+		return ExportSeqDescRMAX(seqdesc, exportPath, skeleton, scratch);
 	}
 	case eAnimSeqExportSetting::ANIMSEQ_SMD:
 	{
-		return ExportSeqDescSMD(seqdesc, exportPath, skelName, bones);
+		return ExportSeqDescSMD(seqdesc, exportPath, skeleton, scratch);
 	}
 	case eAnimSeqExportSetting::ANIMSEQ_RSEQ:
 	{
@@ -2801,8 +3257,13 @@ void* PreviewParsedData(ModelPreviewInfo_t* const info, ModelParsedData_t* const
 	// [rika]: set up CDXDrawData
 	g_currentPreviewDrawData.CheckForMonitorChange();
 
-	if (assetGUID != g_currentPreviewDrawData.guid || g_currentPreviewDrawData.GetDrawData() == nullptr || info->selectedLODLevel != g_currentPreviewDrawData.activeLODLevel)
+	// the draw data points at the buffers of the model's materials, rebuild it if any assets were deleted since
+	static size_t s_drawDataUnloadGeneration = 0ull;
+
+	if (assetGUID != g_currentPreviewDrawData.guid || g_currentPreviewDrawData.GetDrawData() == nullptr || info->selectedLODLevel != g_currentPreviewDrawData.activeLODLevel
+		|| s_drawDataUnloadGeneration != g_assetData.m_unloadGeneration)
 	{
+		s_drawDataUnloadGeneration = g_assetData.m_unloadGeneration;
 		g_currentPreviewDrawData.FreeDrawData();
 
 		CDXDrawData* const drawData = new CDXDrawData();
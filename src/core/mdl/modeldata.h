@@ -5,6 +5,8 @@
 #include <game/rtech/assets/texture.h>
 #include <game/rtech/assets/material.h>
 
+#include <core/mdl/keyreduce.h>
+
 //
 // File contains data for exporting and storing 3D assets
 //
@@ -12,6 +14,12 @@
 // pre def structs
 struct ModelMeshData_t;
 class ModelParsedData_t;
+struct CManagedBuffer;
+
+namespace smd
+{
+	class CSourceModelData;
+}
 
 struct VertexWeight_t
 {
@@ -31,6 +39,7 @@ struct Vertex_t
 	uint32_t weightIndex : 24; // max weight count in a mesh is 1048576 (2^20), 24 bits gives plenty of headroom with a max value of 16777216 (2^24)
 
 	static void ParseVertexFromVG(Vertex_t* const vert, VertexWeight_t* const weights, Vector2D* const texcoords, ModelMeshData_t* const mesh, const char* const rawVertexData, const uint8_t* const boneMap, const vvw::mstudioboneweightextra_t* const weightExtra, int& weightIdx);
+	static void ParseVerticesFromVG(Vertex_t* const verts, VertexWeight_t* const weights, Vector2D* const texcoords, ModelMeshData_t* const mesh, const char* const rawVertexData, const uint8_t* const boneMap, const vvw::mstudioboneweightextra_t* const weightExtra, int& weightIdx); // whole mesh, same output as ParseVertexFromVG per vertex
 
 	// Generic (basic data shared between them)
 	static void ParseVertexFromVTX(Vertex_t* const vert, Vector2D* const texcoords, ModelMeshData_t* const mesh, const vvd::mstudiovertex_t* const pVerts, const Vector4D* const pTangs, const Color32* const pColors, const Vector2D* const pUVs, const int origId);
@@ -578,6 +587,9 @@ void ParseModelHitboxData_v16(ModelParsedData_t* const parsedData);
 
 void ParseModelDrawData(ModelParsedData_t* const parsedData, CDXDrawData* const drawData, const uint64_t lod);
 
+// clears material pointers to assets that are being unloaded, the guids and names are kept
+void ReleaseModelMaterialRefs(ModelParsedData_t* const parsedData);
+
 void ParseSeqDesc_R2(seqdesc_t* const seqdesc, const std::vector<ModelBone_t>* const bones, const r2::studiohdr_t* const pStudioHdr);
 void ParseSeqDesc_R5(seqdesc_t* const seqdesc, const std::vector<ModelBone_t>* const bones, const AnimdataFuncType_t funcType);
 
@@ -812,7 +824,53 @@ bool ExportModelCast(const ModelParsedData_t* const parsedData, std::filesystem:
 bool ExportModelSMD(const ModelParsedData_t* const parsedData, std::filesystem::path& exportPath);
 bool ExportModelQC(const ModelParsedData_t* const parsedData, std::filesystem::path& exportPath, const int setting, const int version);
 
-bool ExportSeqDesc(const int setting, const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const char* const skelName, const std::vector<ModelBone_t>* const bones, const uint64_t guid);
+// skeleton data every sequence of a model or rig is exported against, built once and only read while the sequences export
+struct SeqExportSkeleton_t
+{
+	SeqExportSkeleton_t(const std::vector<ModelBone_t>* const bonesIn);
+
+	const std::vector<ModelBone_t>* bones;
+	size_t boneCount;
+
+	std::vector<RadianEuler> bindRot; // bind pose rotations for smd, used by bones without rotation tracks
+
+	// keyframe reduction settings, taken from the export settings once so every sequence of the model agrees
+	bool reduceKeys;
+	KeyReductionTolerance_t keyTolerance;
+};
+
+// output buffers owned by one export thread, reused for every sequence that thread exports
+struct SeqExportScratch_t
+{
+	SeqExportScratch_t() : smd(nullptr), buffer(nullptr), bufferClaimed(false) {};
+	~SeqExportScratch_t();
+
+	SeqExportScratch_t(const SeqExportScratch_t&) = delete;
+	SeqExportScratch_t& operator=(const SeqExportScratch_t&) = delete;
+
+	// claimed on first use, nullptr when the buffer manager has none left and the exporters allocate their own
+	char* const Buffer();
+
+	smd::CSourceModelData* smd; // nodes are set once, frames are reset per animation
+
+	// keyframe reduction
+	std::vector<uint32_t> keys;
+	std::vector<float> keyValues;
+	std::vector<Quaternion> keyRots;
+	std::vector<Vector> resampledPos;
+	std::vector<Quaternion> resampledRot;
+	std::vector<Vector> resampledScale;
+
+private:
+	CManagedBuffer* buffer;
+	bool bufferClaimed;
+};
+
+bool ExportSeqDesc(const int setting, const seqdesc_t* const seqdesc, std::filesystem::path& exportPath, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch, const uint64_t guid);
+
+// fans sequence exports out over the export threads, or runs them all on the calling thread when it is already one of them
+// exportSeq is called once per index with the scratch of the thread running it
+void ExportSequencesParallel(const uint32_t numSeqs, const std::function<void(const uint32_t, SeqExportScratch_t&)>& exportSeq);
 
 void UpdateModelBoneMatrix(CDXDrawData* const drawData, const ModelParsedData_t* const parsedData);
 void InitModelBoneMatrix(CDXDrawData* const drawData, const ModelParsedData_t* const parsedData);
@@ -19,7 +19,7 @@ namespace qc
 		assertm(func, "writer func was invalid");
 		if (!func)
 		{
-			printf("a %s command was skipped because it didn't have a write function", cmd->info->name);
+			LOG_WARN(MODEL, "a %s command was skipped because it didn't have a write function", cmd->info->name);
 			return false;
 		}
 
@@ -1237,7 +1237,7 @@ namespace qc
 			if (s_CommandList[i].id == cmdid)
 				continue;
 
-			printf("command at %i was %i, expected %i...\n", i, s_CommandList[i].id, cmdid);
+			LOG_ERROR(MODEL, "command at %i was %i, expected %i...\n", i, s_CommandList[i].id, cmdid);
 			assertm(false, "command out of order");
 			return false;
 		}
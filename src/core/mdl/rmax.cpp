@@ -86,7 +86,16 @@ namespace rmax
 
 	bool RMAXExporter::ToFile() const
 	{
-        char* buffer = new char[maxFileSize];
+        const std::unique_ptr<char[]> buffer(new char[maxFileSize]);
+
+        return ToFile(buffer.get(), maxFileSize);
+	}
+
+	bool RMAXExporter::ToFile(char* const buffer, const size_t size) const
+	{
+        if (!buffer || size < maxFileSize)
+            return false;
+
         char* const baseptr = buffer;
         char* curpos = baseptr;
 
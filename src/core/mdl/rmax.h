@@ -377,6 +377,7 @@ namespace rmax
 		void ResetMeshData();
 
 		bool ToFile() const;
+		bool ToFile(char* const buffer, const size_t size) const; // caller owned buffer of at least maxFileSize, reused between files
 
 	private:
 		std::filesystem::path exportPath;
@@ -60,6 +60,7 @@ namespace smd
 		outPath.replace_extension(".smd");
 
 		std::ofstream out(outPath, std::ios::out);
+		CWrittenFileTracker::Record(outPath);
 
 		out << "version 1\n";
 
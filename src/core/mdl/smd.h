@@ -57,7 +57,7 @@ namespace smd
 	class CSourceModelData
 	{
 	public:
-		CSourceModelData(const std::filesystem::path& path, const size_t nodeCount, const size_t frameCount) : exportPath(path), numNodes(nodeCount), nodes(nullptr), numFrames(frameCount), frames(nullptr)
+		CSourceModelData(const std::filesystem::path& path, const size_t nodeCount, const size_t frameCount) : exportPath(path), numNodes(nodeCount), nodes(nullptr), numFrames(frameCount), frameCapacity(frameCount), frames(nullptr)
 		{
 			assertm(numNodes, "must have at least one bone");
 			assertm(numFrames, "must have at least one frame");
@@ -86,18 +86,33 @@ namespace smd
 		Triangle* const TopTri() { return &triangles.back(); }
 
 		void SetName(const std::string& name) { exportName = name; }
+		void SetPath(const std::filesystem::path& path) { exportPath = path; }
 
 		const size_t NodeCount() const { return numNodes; }
 		const size_t FrameCount() const { return numFrames; }
 
 		// so we don't have to re parse nodes
 		void ResetMeshData() { triangles.clear(); }
+		// frames are kept when they fit so their bones don't get reallocated
 		void ResetFrameData(const size_t frameCount)
 		{
+			numFrames = frameCount;
+
+			if (numFrames <= frameCapacity)
+			{
+				for (size_t i = 0; i < numFrames; i++)
+					frames[i].bones.clear();
+
+				return;
+			}
+
 			FreeAllocArray(frames);
 
-			numFrames = frameCount;
-			frames = new Frame[numFrames];
+			frameCapacity = numFrames;
+			frames = new Frame[frameCapacity];
+
+			for (size_t i = 0; i < frameCapacity; i++)
+				frames[i].bones.reserve(numNodes);
 		}
 
 		// still slow but a lot faster than the previous implementation (~5x faster)
@@ -109,6 +124,7 @@ namespace smd
 		Node* nodes;
 
 		size_t numFrames;
+		size_t frameCapacity;
 		Frame* frames;
 
 		std::vector<Triangle> triangles;
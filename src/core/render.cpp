@@ -13,17 +13,24 @@
 #include <core/input/input.h>
 
 #include <core/filehandling/export.h>
+#include <core/filehandling/assetdiff.h>
 #include <core/ui/modern_layout.h>
 
+#include <core/cache/texturestore.h>
+#include <core/cache/exportmanifest.h>
+
 #include <game/rtech/cpakfile.h>
 #include <game/rtech/assets/model.h>
 #include <game/rtech/assets/texture.h>
+#include <game/rtech/assets/datatable_store.h>
 
 extern CDXParentHandler* g_dxHandler;
 extern std::atomic<uint32_t> maxConcurrentThreads;
 
 ExportSettings_t g_ExportSettings{ .exportNormalRecalcSetting = eNormalExportRecalc::NML_RECALC_NONE, .exportTextureNameSetting = eTextureExportName::TXTR_NAME_TEXT, .exportMaterialTextures = true,
-    .exportPathsFull = false, .exportAssetDeps = false, .previewedSkinIndex = 0, .qcMajorVersion = 49, .qcMinorVersion = 0, .exportRigSequences = true, .exportModelSkin = false, .exportModelMatsTruncated = false, .exportPhysicsContentsFilter = static_cast<uint32_t>(TRACE_MASK_ALL) };
+    .exportPathsFull = false, .exportAssetDeps = false, .previewedSkinIndex = 0, .qcMajorVersion = 49, .qcMinorVersion = 0, .exportRigSequences = true, .exportModelSkin = false, .exportModelMatsTruncated = false, .exportSeqKeyReduction = false,
+    .exportSeqKeyPosTolerance = 0.01f, .exportSeqKeyRotTolerance = 0.05f, .exportSeqKeyScaleTolerance = 0.001f, .exportPhysicsContentsFilter = static_cast<uint32_t>(TRACE_MASK_ALL),
+    .exportAudioFlacLevel = 5, .exportAudioFlacBitDepth = eAudioFlacBitDepth::AUDIO_FLAC_24BIT };
 PreviewSettings_t g_PreviewSettings { .previewCullDistance = PREVIEW_CULL_DEFAULT, .previewMovementSpeed = PREVIEW_SPEED_DEFAULT };
 
 CPreviewDrawData g_currentPreviewDrawData;
@@ -65,7 +72,7 @@ struct AssetCompare_t
             switch (sort_spec->ColumnUserID)
             {
             case AssetColumn_t::AC_Type:   delta = static_cast<int64_t>(_byteswap_ulong(assetA->GetAssetType())) - _byteswap_ulong(assetB->GetAssetType());                        break; // no overflow please
-            case AssetColumn_t::AC_Name:   delta = _stricmp(assetA->GetAssetName().c_str(), assetB->GetAssetName().c_str());                        break; // no overflow please
+            case AssetColumn_t::AC_Name:   delta = _stricmp(assetA->GetAssetName().data(), assetB->GetAssetName().data());                        break; // no overflow please
             case AssetColumn_t::AC_GUID:   delta = assetA->GetAssetGUID() - assetB->GetAssetGUID();     break;
             case AssetColumn_t::AC_File:   delta = _stricmp(assetA->GetContainerFileName().c_str(), assetB->GetContainerFileName().c_str());     break;
             default: IM_ASSERT(0); break;
@@ -178,7 +185,7 @@ void CreatePakAssetDependenciesTable(CAsset* asset)
                 {
                     ImGui::AlignTextToFramePadding();
                     if (depAsset)
-                        ImGui::TextUnformatted(depAsset->GetAssetName().c_str());
+                        ImGui::TextUnformatted(depAsset->GetAssetName().data());
                     else
                         ImGui::Text("%016llX", guid.guid);
                 }
@@ -348,6 +355,31 @@ void HandleRenderFrame()
                 }
             }
 
+            if (ImGui::BeginMenu("Unload Container", !inJobAction && !g_assetData.v_assetContainers.empty()))
+            {
+                CAssetContainer* unloadContainer = nullptr;
+                for (CAssetContainer* const container : g_assetData.v_assetContainers)
+                {
+                    ImGui::PushID(container);
+                    if (ImGui::MenuItem(container->GetContainerFileName().c_str()))
+                        unloadContainer = container;
+                    ImGui::PopID();
+                }
+                ImGui::EndMenu();
+
+                if (unloadContainer)
+                {
+                    // selection, filter and preview hold asset pointers, reset them like a full unload does
+                    selectedAssets.clear();
+                    filteredAssets.clear();
+                    prevRenderInfoAsset = nullptr;
+                    previewDrawData = nullptr;
+
+                    g_assetData.UnloadContainers({ unloadContainer });
+                    g_datatableStore.Clear();
+                }
+            }
+
             ImGui::EndMenu();
         }
 
@@ -364,6 +396,17 @@ void HandleRenderFrame()
             ImGui::EndMenu();
         }
 
+        if (ImGui::BeginMenu("Tools"))
+        {
+            if (ImGui::MenuItem("Datatable Query"))
+                uiState.ShowDatatableQueryWindow(true);
+
+            if (ImGui::MenuItem("Build Diff"))
+                uiState.ShowBuildDiffWindow(true);
+
+            ImGui::EndMenu();
+        }
+
 #if _DEBUG
         IMGUI_RIGHT_ALIGN_FOR_TEXT("Avg 1.000 ms/frame (100.0 FPS)"); // [rexx]: i hate this actually
 
@@ -509,9 +552,9 @@ void HandleRenderFrame()
                 filteredAssets.clear();
                 for (auto& it : g_assetData.v_assets)
                 {
-                    const std::string& assetName = it.m_asset->GetAssetName();
+                    const std::string_view assetName = it.m_asset->GetAssetName();
 
-                    if (FilterConfig->textFilter.PassFilter(assetName.c_str()))
+                    if (FilterConfig->textFilter.PassFilter(assetName.data()))
                         filteredAssets.push_back(it);
                     else
                     {
@@ -523,7 +566,7 @@ void HandleRenderFrame()
 
                         if (end == &inputText[inputLen])
                         {
-                            if (guid == RTech::StringToGuid(assetName.c_str()))
+                            if (guid == RTech::StringToGuid(assetName.data()))
                                 filteredAssets.push_back(it);
                         }
                     }
@@ -575,7 +618,7 @@ void HandleRenderFrame()
                         if (ImGui::TableSetColumnIndex(AssetColumn_t::AC_Name))
                         {
                             const bool isSelected = std::find(selectedAssets.begin(), selectedAssets.end(), asset) != selectedAssets.end();
-                            if (ImGui::Selectable(asset->GetAssetName().c_str(), isSelected, ImGuiSelectableFlags_AllowDoubleClick))
+                            if (ImGui::Selectable(asset->GetAssetName().data(), isSelected, ImGuiSelectableFlags_AllowDoubleClick))
                             {
                                 if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
                                 {
@@ -654,7 +697,7 @@ void HandleRenderFrame()
                 ImGui::EndMenuBar();
             }
 
-            const std::string assetName = !firstAsset ? "(none)" : firstAsset->GetAssetName(); // std::format("{} ({:X})", , firstAsset->data()->guid);
+            const std::string assetName(!firstAsset ? "(none)" : firstAsset->GetAssetName()); // std::format("{} ({:X})", , firstAsset->data()->guid);
             const std::string assetGuidStr = !firstAsset ? "(none)" : std::format("{:X}", firstAsset->GetAssetGUID());
 
             ImGuiConstTextInputLeft("Asset Name", assetName.c_str(), 70);
@@ -730,6 +773,17 @@ void HandleRenderFrame()
             ImGui::SameLine();
             g_pImGuiHandler->HelpMarker("Enables exporting of all dependencies that are associated with any asset that is being exported.");
 
+            ImGui::Checkbox("Skip up to date exports", &g_ExportSettings.exportIncremental);
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Assets exported before are skipped when the file they were loaded from, the export settings they use and every file they wrote are unchanged since.\nThe exported files are remembered between sessions in \"rsx_export_manifest.bin\".");
+
+            if (g_ExportSettings.exportIncremental)
+            {
+                const ExportManifestStats_t manifestStats = g_exportManifest.GetStats();
+
+                ImGui::Text("%llu recorded, %llu skipped, %llu exported, %.1fs saved", manifestStats.entries, manifestStats.skipped, manifestStats.exported, static_cast<double>(manifestStats.savedNs) / 1e9);
+            }
+
             // texture settings
             ImGui::SeparatorText("Export (Textures)");
 
@@ -745,6 +799,19 @@ void HandleRenderFrame()
             ImGui::SameLine();
             g_pImGuiHandler->HelpMarker("Enables exporting of all textures that are associated with any material asset that is being exported.");
 
+            ImGui::Checkbox("Reuse identical texture exports", &g_ExportSettings.exportTextureDedupe);
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Textures with the same data and export options as one exported before are hard linked (or copied) from the earlier file instead of being converted again.\nThe exported files are remembered between sessions in \"rsx_texture_store.bin\".");
+
+            if (g_ExportSettings.exportTextureDedupe)
+            {
+                const TextureStoreStats_t storeStats = g_textureExportStore.GetStats();
+                const uint64_t storeLookups = storeStats.hits + storeStats.misses;
+
+                ImGui::Text("%llu stored, %llu reused (%.1f%%), %.1fs saved", storeStats.entries, storeStats.hits,
+                    storeLookups ? static_cast<double>(storeStats.hits) * 100.0 / static_cast<double>(storeLookups) : 0.0, static_cast<double>(storeStats.savedNs) / 1e9);
+            }
+
             // model settings
             ImGui::SeparatorText("Export (Models)");
 
@@ -760,6 +827,23 @@ void HandleRenderFrame()
             ImGui::SameLine();
             g_pImGuiHandler->HelpMarker("Truncates material names on SMD.");
 
+            ImGui::Checkbox("Reduce Sequence Keys", &g_ExportSettings.exportSeqKeyReduction);
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Drops sequence keys that interpolating the keys around them reproduces within the tolerances below.\n\nCAST only writes the keys that are kept, RMAX and SMD write every frame rebuilt from them.");
+
+            if (g_ExportSettings.exportSeqKeyReduction)
+            {
+                ImGui::PushItemWidth(96.0f);
+                ImGui::InputFloat("Position Tolerance", &g_ExportSettings.exportSeqKeyPosTolerance, 0.0f, 0.0f, "%.4f");
+                ImGui::InputFloat("Rotation Tolerance (Degrees)", &g_ExportSettings.exportSeqKeyRotTolerance, 0.0f, 0.0f, "%.4f");
+                ImGui::InputFloat("Scale Tolerance", &g_ExportSettings.exportSeqKeyScaleTolerance, 0.0f, 0.0f, "%.4f");
+                ImGui::PopItemWidth();
+
+                g_ExportSettings.exportSeqKeyPosTolerance = std::max(g_ExportSettings.exportSeqKeyPosTolerance, 0.0f);
+                g_ExportSettings.exportSeqKeyRotTolerance = std::clamp(g_ExportSettings.exportSeqKeyRotTolerance, 0.0f, 180.0f);
+                g_ExportSettings.exportSeqKeyScaleTolerance = std::max(g_ExportSettings.exportSeqKeyScaleTolerance, 0.0f);
+            }
+
             ImGui::PushItemWidth(48.0f);
             ImGui::InputScalar("##QCTargetMajor", ImGuiDataType_U16, reinterpret_cast<uint16_t*>(&g_ExportSettings.qcMajorVersion), nullptr, nullptr, "%u", ImGuiInputTextFlags_CharsDecimal);
             ImGui::SameLine();
@@ -783,6 +867,19 @@ void HandleRenderFrame()
             ImGui::SameLine();
             g_pImGuiHandler->HelpMarker("Filter only physics meshes containing all specified contents.");
 
+            // audio settings
+            ImGui::SeparatorText("Export (Audio)");
+
+            constexpr uint32_t minFlacLevel = 0u;
+            constexpr uint32_t maxFlacLevel = 8u;
+            ImGui::SliderScalar("FLAC Compression Level", ImGuiDataType_U32, &g_ExportSettings.exportAudioFlacLevel, &minFlacLevel, &maxFlacLevel);
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Higher levels search more predictors for smaller files at the cost of export time. Every level is lossless for the chosen bit depth.");
+
+            ImGui::Combo("FLAC Bit Depth", reinterpret_cast<int*>(&g_ExportSettings.exportAudioFlacBitDepth), s_AudioFlacBitDepthSetting, static_cast<int>(ARRAYSIZE(s_AudioFlacBitDepthSetting)));
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Decoded audio is floating point, FLAC stores integers. 24 bit keeps practically all of the decoded precision, 16 bit gives smaller files.");
+
             // ===============================================================================================================
             ImGui::SeparatorText("Threads");
 
@@ -794,6 +891,104 @@ void HandleRenderFrame()
             ImGui::SameLine();
             g_pImGuiHandler->HelpMarker("The number of CPU threads that will be used for exporting assets.\n\nA higher number of threads will usually make RSX export assets more quickly, however the increased disk usage may cause decreased performance.");
 
+            // ===============================================================================================================
+            ImGui::SeparatorText("Memory");
+
+            if (ImGui::BeginCombo("Parsed Data Codec", CRamen::GetCodecName(g_RamenSettings.codec)))
+            {
+                for (uint8_t i = 0; i < static_cast<uint8_t>(eRamenCodec::_COUNT); i++)
+                {
+                    const eRamenCodec codec = static_cast<eRamenCodec>(i);
+
+                    if (ImGui::Selectable(CRamen::GetCodecName(codec), codec == g_RamenSettings.codec))
+                    {
+                        g_RamenSettings.codec = codec;
+                        g_RamenSettings.level = CRamen::DefaultCodecLevel(codec);
+                    }
+                }
+
+                ImGui::EndCombo();
+            }
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Compression used for parsed model and animation data kept in memory. Only applies to files loaded after changing it.\n\nSelkie decompresses fastest, Leviathan and higher Zstandard levels use the least memory.");
+
+            int minLevel = 0;
+            int maxLevel = 0;
+            CRamen::CodecLevelRange(g_RamenSettings.codec, minLevel, maxLevel);
+
+            if (minLevel != maxLevel)
+            {
+                ImGui::SliderInt("Parsed Data Level", &g_RamenSettings.level, minLevel, maxLevel);
+                ImGui::SameLine();
+                g_pImGuiHandler->HelpMarker("Compression level for the selected codec, higher levels are smaller but slower to load.");
+            }
+
+            ImGui::InputScalar("Parsed Data Budget (MB)", ImGuiDataType_U32, &g_RamenSettings.budgetMB);
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Amount of compressed parsed data kept in memory, 0 for no limit.\nWith spilling enabled, the least recently used data over this budget is moved to a temporary file.");
+
+            ImGui::Checkbox("Spill parsed data to disk", &g_RamenSettings.spill);
+
+            ImGui::InputScalar("Decompressed Cache (MB)", ImGuiDataType_U32, &g_RamenSettings.cacheMB);
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Recently decompressed parsed data kept around so previewing or exporting the same model again doesn't decompress it again.");
+
+            const RamenStats_t ramenStats = CRamen::GetStats();
+            constexpr double bytesToMB = 1.0 / (1024.0 * 1024.0);
+
+            ImGui::Text("Parsed data: %.1f MB in %llu chunks, %.1f MB resident, %.1f MB spilled", static_cast<double>(ramenStats.bytesIn) * bytesToMB, ramenStats.noodles,
+                static_cast<double>(ramenStats.bytesResident) * bytesToMB, static_cast<double>(ramenStats.bytesSpilled) * bytesToMB);
+            ImGui::Text("Cache: %llu hits, %llu misses, %.1f MB, %llu spill reads, %.1f MB spill file", ramenStats.cacheHits, ramenStats.cacheMisses, static_cast<double>(ramenStats.cacheBytes) * bytesToMB,
+                ramenStats.spillReads, static_cast<double>(ramenStats.spillFileBytes) * bytesToMB);
+
+            if (ramenStats.spillFailed)
+                ImGui::TextColored(ImVec4(1.f, 0.3f, 0.3f, 1.f), "The spill file couldn't be created, parsed data stays in memory until restart.");
+
+            // ===============================================================================================================
+            ImGui::SeparatorText("Logging");
+
+            if (ImGui::BeginCombo("Log Level", CLogger::GetLevelName(g_logger.GetLevel())))
+            {
+                for (uint8_t i = 0; i < static_cast<uint8_t>(eLogLevel::_COUNT); i++)
+                {
+                    const eLogLevel level = static_cast<eLogLevel>(i);
+
+                    if (ImGui::Selectable(CLogger::GetLevelName(level), level == g_logger.GetLevel()))
+                        g_logger.SetLevel(level);
+                }
+
+                ImGui::EndCombo();
+            }
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Messages below this level are skipped before they are formatted.");
+
+            if (ImGui::BeginCombo("Log Categories", g_logger.GetCategoryMask() == 0xffffffff ? "all" : "some"))
+            {
+                for (uint8_t i = 0; i < static_cast<uint8_t>(eLogCategory::_COUNT); i++)
+                {
+                    uint32_t mask = g_logger.GetCategoryMask();
+
+                    if (ImGui::CheckboxFlags(CLogger::GetCategoryName(static_cast<eLogCategory>(i)), &mask, 1u << i))
+                        g_logger.SetCategoryMask(mask);
+                }
+
+                ImGui::EndCombo();
+            }
+
+            bool logConsole = g_logger.GetConsoleOutput();
+            if (ImGui::Checkbox("Log to console", &logConsole))
+                g_logger.SetConsoleOutput(logConsole);
+
+            static char logFile[MAX_PATH] = {};
+            if (ImGui::IsWindowAppearing())
+                strncpy_s(logFile, g_logger.GetFile().c_str(), _TRUNCATE);
+
+            ImGui::InputText("Log File", logFile, sizeof(logFile));
+            if (ImGui::IsItemDeactivatedAfterEdit())
+                g_logger.SetFile(logFile);
+            ImGui::SameLine();
+            g_pImGuiHandler->HelpMarker("Log messages are also written to this file, leave empty to only log to the console. The file is overwritten when it is opened.");
+
             // ===============================================================================================================
             ImGui::SeparatorText("Preview");
 
@@ -842,6 +1037,12 @@ void HandleRenderFrame()
         }
     } // End of legacy layout else block
 
+    if (!inJobAction && uiState.datatableQueryWindowVisible)
+        DrawDatatableQueryWindow(&uiState.datatableQueryWindowVisible);
+
+    if (!inJobAction && uiState.buildDiffWindowVisible)
+        DrawBuildDiffWindow(&uiState.buildDiffWindowVisible);
+
     ImGui::Render();
     if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
     {
@@ -111,6 +111,27 @@ ID3D11ShaderResourceView* const CTexture::GetSRV()
     return m_shaderResourceView;
 }
 
+static bool SaveImageAsPng(const DirectX::Image& image, const std::filesystem::path& exportPath)
+{
+    const HRESULT res = DirectX::SaveToWICFile(image, DirectX::WIC_FLAGS::WIC_FLAGS_FORCE_SRGB, DirectX::GetWICCodec(DirectX::WICCodecs::WIC_CODEC_PNG), exportPath.wstring().c_str(), nullptr, 
+        [](IPropertyBag2* props)
+        {
+            PROPBAG2 options{};
+            VARIANT varValues{};
+            options.pstrName = (LPOLESTR)L"FilterOption";
+            varValues.vt = VT_UI1;
+            varValues.bVal = WICPngFilterOption::WICPngFilterUp;
+
+            props->Write(1u, &options, &varValues);
+        });
+
+    if (FAILED(res))
+        return false;
+
+    CWrittenFileTracker::Record(exportPath);
+    return true;
+}
+
 bool CTexture::ExportAsPng(const std::filesystem::path& exportPath)
 {
     if (!IsValid32bppFormat())
@@ -123,24 +144,100 @@ bool CTexture::ExportAsPng(const std::filesystem::path& exportPath)
         }
     }
 
-    const HRESULT res = DirectX::SaveToWICFile(*ToScratchImage->GetImages(), DirectX::WIC_FLAGS::WIC_FLAGS_FORCE_SRGB, DirectX::GetWICCodec(DirectX::WICCodecs::WIC_CODEC_PNG), exportPath.wstring().c_str(), nullptr, 
-        [](IPropertyBag2* props)
+    return SaveImageAsPng(*ToScratchImage->GetImages(), exportPath);
+}
+
+bool CTexture::ExportAsDds(const std::filesystem::path& exportPath)
+{
+    if (FAILED(DirectX::SaveToDDSFile(ToScratchImage->GetImages(), ToScratchImage->GetImageCount(), ToScratchImage->GetMetadata(), DirectX::DDS_FLAGS::DDS_FLAGS_NONE, exportPath.wstring().c_str())))
+        return false;
+
+    CWrittenFileTracker::Record(exportPath);
+    return true;
+}
+
+// copies a rect of a 32bpp image into scratch a row at a time, optionally swapping red and blue
+static DirectX::Image CropImageRect(const DirectX::Image& src, const size_t x, const size_t y, const size_t w, const size_t h, const DXGI_FORMAT format, const bool swapRedBlue, std::vector<uint8_t>& scratch)
+{
+    const size_t rowSize = w * 4;
+    scratch.resize(rowSize * h);
+
+    for (size_t row = 0; row < h; row++)
+    {
+        const uint8_t* const srcRow = src.pixels + ((y + row) * src.rowPitch) + (x * 4);
+        uint8_t* const dstRow = scratch.data() + (row * rowSize);
+
+        if (!swapRedBlue)
         {
-            PROPBAG2 options{};
-            VARIANT varValues{};
-            options.pstrName = (LPOLESTR)L"FilterOption";
-            varValues.vt = VT_UI1;
-            varValues.bVal = WICPngFilterOption::WICPngFilterUp;
+            std::memcpy(dstRow, srcRow, rowSize);
+            continue;
+        }
 
-            props->Write(1u, &options, &varValues);
-        });
+        for (size_t i = 0; i < rowSize; i += 4)
+        {
+            dstRow[i + 0] = srcRow[i + 2];
+            dstRow[i + 1] = srcRow[i + 1];
+            dstRow[i + 2] = srcRow[i + 0];
+            dstRow[i + 3] = srcRow[i + 3];
+        }
+    }
 
-    return SUCCEEDED(res);
+    DirectX::Image image = {};
+    image.width = w;
+    image.height = h;
+    image.format = format;
+    image.rowPitch = rowSize;
+    image.slicePitch = rowSize * h;
+    image.pixels = scratch.data();
+
+    return image;
 }
 
-bool CTexture::ExportAsDds(const std::filesystem::path& exportPath)
+bool CTexture::ExportRectAsPng(const std::filesystem::path& exportPath, const size_t x, const size_t y, const size_t w, const size_t h, std::vector<uint8_t>& scratch)
+{
+    const DirectX::Image* const src = ToScratchImage->GetImage(0, 0, 0);
+    assertm(x + w <= src->width && y + h <= src->height, "rect out of bounds");
+
+    // same formats ExportAsPng writes, srgb rgba only needs its channels swapped to get there
+    switch (src->format)
+    {
+    case DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT::DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT::DXGI_FORMAT_B8G8R8X8_UNORM:
+        return SaveImageAsPng(CropImageRect(*src, x, y, w, h, src->format, false, scratch), exportPath);
+    case DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        return SaveImageAsPng(CropImageRect(*src, x, y, w, h, DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, true, scratch), exportPath);
+    default:
+    {
+        CTexture slice(nullptr, 0u, w, h, src->format, 1u, 1u);
+        slice.CopySourceTextureSlice(this, x, y, w, h, 0u, 0u);
+
+        return slice.ExportAsPng(exportPath);
+    }
+    }
+
+    unreachable();
+}
+
+bool CTexture::ExportRectAsDds(const std::filesystem::path& exportPath, const size_t x, const size_t y, const size_t w, const size_t h, std::vector<uint8_t>& scratch)
 {
-    return SUCCEEDED(DirectX::SaveToDDSFile(ToScratchImage->GetImages(), ToScratchImage->GetImageCount(), ToScratchImage->GetMetadata(), DirectX::DDS_FLAGS::DDS_FLAGS_NONE, exportPath.wstring().c_str()));
+    const DirectX::Image* const src = ToScratchImage->GetImage(0, 0, 0);
+    assertm(x + w <= src->width && y + h <= src->height, "rect out of bounds");
+
+    if (DirectX::IsCompressed(src->format) || DirectX::BitsPerPixel(src->format) != 32)
+    {
+        CTexture slice(nullptr, 0u, w, h, src->format, 1u, 1u);
+        slice.CopySourceTextureSlice(this, x, y, w, h, 0u, 0u);
+
+        return slice.ExportAsDds(exportPath);
+    }
+
+    const DirectX::Image image = CropImageRect(*src, x, y, w, h, src->format, false, scratch);
+    if (FAILED(DirectX::SaveToDDSFile(image, DirectX::DDS_FLAGS::DDS_FLAGS_NONE, exportPath.wstring().c_str())))
+        return false;
+
+    CWrittenFileTracker::Record(exportPath);
+    return true;
 }
 
 bool CTexture::ConvertToFormat(const DXGI_FORMAT format)
@@ -725,7 +822,7 @@ bool CDXParentHandler::HandleWindowChange(HWND hWnd)
         return true;
 
 #ifdef _DEBUG
-    Log("Adapter changed, rebuilding swap chain...\n");
+    LOG_INFO(RENDER, "Adapter changed, rebuilding swap chain...\n");
 #endif // _DEBUG
 
     // destroy old imgui
@@ -757,7 +854,7 @@ bool CDXParentHandler::HandleWindowChange(HWND hWnd)
     ImGui_ImplDX11_Init(g_dxHandler->GetDevice(), g_dxHandler->GetDeviceContext());
 
 #ifdef _DEBUG
-    Log("Swapchain successfully rebuilt!\n");
+    LOG_DEBUG(RENDER, "Swapchain successfully rebuilt!\n");
 #endif // DEBUG
 
     return true;
@@ -27,6 +27,11 @@ public:
     bool ConvertToFormat(const DXGI_FORMAT format);
     void CopySourceTextureSlice(CTexture* const src, const size_t x, const size_t y, const size_t w, const size_t h, const size_t offsetX, const size_t offsetY);
     void CopyRawToTexture(const char* const buf, const size_t bufSize);
+
+    // exports a rect of this texture without creating a texture for it, the rect is cropped into scratch
+    // scratch is reused between calls, so give each thread its own
+    bool ExportRectAsPng(const std::filesystem::path& exportPath, const size_t x, const size_t y, const size_t w, const size_t h, std::vector<uint8_t>& scratch);
+    bool ExportRectAsDds(const std::filesystem::path& exportPath, const size_t x, const size_t y, const size_t w, const size_t h, std::vector<uint8_t>& scratch);
     
     //inline ID3D11ShaderResourceView* const GetSRV() const { return m_shaderResourceView; };
     ID3D11ShaderResourceView* const GetSRV();
@@ -18,7 +18,7 @@ CShader* CDXShaderManager::LoadShaderFromString(const std::string& path, const s
 	if (CShader* shader = GetShaderByPath(path))
 		return shader;
 
-	Log("* loading %s shader %s from string\n", GetShaderTypeName(type), path.c_str());
+	LOG_DEBUG(RENDER, "* loading %s shader %s from string\n", GetShaderTypeName(type), path.c_str());
 
 	const std::string shortName = GetShaderTypeShortName(type);
 	const std::string entrypoint = shortName + "_main";
@@ -39,11 +39,11 @@ CShader* CDXShaderManager::LoadShaderFromString(const std::string& path, const s
 	{
 		if (errorBlob)
 		{
-			Log("** failed to compile shader '%s'\n%s", path.c_str(), static_cast<char*>(errorBlob->GetBufferPointer()));
+			LOG_ERROR(RENDER, "** failed to compile shader '%s'\n%s", path.c_str(), static_cast<char*>(errorBlob->GetBufferPointer()));
 			errorBlob->Release();
 		}
 		else
-			Log("** failed to compile shader '%s'", path.c_str());
+			LOG_ERROR(RENDER, "** failed to compile shader '%s'", path.c_str());
 
 		return nullptr;
 	}
@@ -95,7 +95,7 @@ CShader* CDXShaderManager::LoadShaderFromString(const std::string& path, const s
 	if (FAILED(hr))
 	{
 		shaderBlob->Release();
-		Log("** failed to create %s shader '%s'. HRESULT = 0x%08x", GetShaderTypeName(type), path.c_str(), hr);
+		LOG_ERROR(RENDER, "** failed to create %s shader '%s'. HRESULT = 0x%08x", GetShaderTypeName(type), path.c_str(), hr);
 
 		return nullptr;
 	}
@@ -128,11 +128,11 @@ CShader* CDXShaderManager::LoadShader(const std::string& path, eShaderType type,
 	if (CShader* shader = GetShaderByPath(path))
 		return shader;
 
-	Log("* loading %s shader %s from file\n", GetShaderTypeName(type), path.c_str());
+	LOG_DEBUG(RENDER, "* loading %s shader %s from file\n", GetShaderTypeName(type), path.c_str());
 
 	if (!std::filesystem::exists(path + ".hlsl"))
 	{
-		Log("** error: shader file not found\n");
+		LOG_ERROR(RENDER, "** error: shader file not found\n");
 		return nullptr;
 	}
 
@@ -157,11 +157,11 @@ CShader* CDXShaderManager::LoadShader(const std::string& path, eShaderType type,
 	{
 		if (errorBlob)
 		{
-			Log("** failed to compile shader '%s'\n%s", path.c_str(), static_cast<char*>(errorBlob->GetBufferPointer()));
+			LOG_ERROR(RENDER, "** failed to compile shader '%s'\n%s", path.c_str(), static_cast<char*>(errorBlob->GetBufferPointer()));
 			errorBlob->Release();
 		}
 		else
-			Log("** failed to compile shader '%s'", path.c_str());
+			LOG_ERROR(RENDER, "** failed to compile shader '%s'", path.c_str());
 
 		return nullptr;
 	}
@@ -213,7 +213,7 @@ CShader* CDXShaderManager::LoadShader(const std::string& path, eShaderType type,
 	if (FAILED(hr))
 	{
 		shaderBlob->Release();
-		Log("** failed to create %s shader '%s'. HRESULT = 0x%08x", GetShaderTypeName(type), path.c_str(), hr);
+		LOG_ERROR(RENDER, "** failed to create %s shader '%s'. HRESULT = 0x%08x", GetShaderTypeName(type), path.c_str(), hr);
 
 		return nullptr;
 	}
@@ -41,7 +41,7 @@ bool CreateD3DBuffer(
     {
         // Log error code for debugging
         // HRESULT error codes: https://docs.microsoft.com/en-us/windows/win32/direct3ddxgi/dxgi-error
-        printf("CreateD3DBuffer failed with HRESULT: 0x%08X\n", hr);
+        LOG_ERROR(RENDER, "CreateD3DBuffer failed with HRESULT: 0x%08X\n", hr);
         *pBuffer = nullptr;
         return false;
     }
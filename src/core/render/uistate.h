@@ -3,8 +3,14 @@
 class CUIState
 {
 public:
+	CUIState() : settingsWindowVisible(false), datatableQueryWindowVisible(false), buildDiffWindowVisible(false) {};
+
 	inline void ShowSettingsWindow(bool state) { settingsWindowVisible = state; };
+	inline void ShowDatatableQueryWindow(bool state) { datatableQueryWindowVisible = state; };
+	inline void ShowBuildDiffWindow(bool state) { buildDiffWindowVisible = state; };
 
 public:
 	bool settingsWindowVisible;
+	bool datatableQueryWindowVisible;
+	bool buildDiffWindowVisible;
 };
\ No newline at end of file
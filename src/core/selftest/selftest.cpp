@@ -0,0 +1,122 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <psapi.h>
+
+// function local so registrars in other translation units can't run before it exists
+static std::vector<SelfTest_t>& RegisteredSelfTests()
+{
+	static std::vector<SelfTest_t> s_tests;
+	return s_tests;
+}
+
+CSelfTestRegistrar::CSelfTestRegistrar(const char* const name, const eSelfTestKind kind, const SelfTestFunc_t func)
+{
+	RegisteredSelfTests().emplace_back(SelfTest_t{ name, kind, func });
+}
+
+void CSelfTestContext::Check(const bool passed, const char* const expr, const char* const file, const int line)
+{
+	++m_checks;
+
+	if (passed)
+		return;
+
+	++m_failures;
+
+	const std::string fileName = std::filesystem::path(file).filename().string();
+	m_messages.emplace_back(std::format("check failed: {} ({}:{})", expr, fileName, line));
+}
+
+void CSelfTestContext::Fail(const std::string& msg)
+{
+	++m_checks;
+	++m_failures;
+
+	m_messages.emplace_back(msg);
+}
+
+void CSelfTestContext::Metric(const std::string& name, const double value, const char* const unit)
+{
+	m_metrics.emplace_back(SelfTestMetric_t{ name, value, unit });
+}
+
+void CSelfTestContext::Note(const std::string& msg)
+{
+	m_messages.emplace_back(msg);
+}
+
+const size_t CSelfTestContext::ProcessMemory()
+{
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0ull;
+
+	return counters.WorkingSetSize;
+}
+
+const std::filesystem::path& CSelfTestContext::TempDirectory()
+{
+	if (!m_tempDirectory.empty())
+		return m_tempDirectory;
+
+	std::error_code ec;
+	m_tempDirectory = std::filesystem::temp_directory_path(ec) / std::format("rsx_selftest_{}_{:x}", GetCurrentProcessId(), m_rng());
+
+	CreateDirectories(m_tempDirectory);
+
+	return m_tempDirectory;
+}
+
+void CSelfTestContext::RemoveTempDirectory()
+{
+	if (m_tempDirectory.empty())
+		return;
+
+	std::error_code ec;
+	std::filesystem::remove_all(m_tempDirectory, ec);
+
+	m_tempDirectory.clear();
+}
+
+const bool RunSelfTests(const eSelfTestKind kind, const std::function<bool(const char*)>& filter, const uint64_t seed, const uint32_t scale, const std::function<void(const SelfTestResult_t&)>& report)
+{
+	std::vector<const SelfTest_t*> tests;
+	for (const SelfTest_t& test : RegisteredSelfTests())
+	{
+		if (test.kind == kind && filter(test.name))
+			tests.emplace_back(&test);
+	}
+
+	std::sort(tests.begin(), tests.end(), [](const SelfTest_t* const a, const SelfTest_t* const b) { return strcmp(a->name, b->name) < 0; });
+
+	bool allPassed = true;
+	for (const SelfTest_t* const test : tests)
+	{
+		CSelfTestContext ctx(seed, scale);
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		test->func(ctx);
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+		ctx.RemoveTempDirectory();
+
+		SelfTestResult_t result{ test, ctx.Failures() == 0u, ctx.Checks(), ctx.Failures(), seconds, ctx.Messages(), ctx.Metrics() };
+		allPassed &= result.passed;
+
+		report(result);
+	}
+
+	return allPassed;
+}
+
+void ListSelfTests(const eSelfTestKind kind, std::vector<std::string>& names)
+{
+	for (const SelfTest_t& test : RegisteredSelfTests())
+	{
+		if (test.kind == kind)
+			names.emplace_back(test.name);
+	}
+
+	std::sort(names.begin(), names.end());
+}
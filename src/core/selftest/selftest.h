@@ -0,0 +1,118 @@
+#pragma once
+#include <random>
+
+// checks and benchmarks that run inside the tool itself, through rsx -headless -selftest / -bench
+// there are no game files to rely on, every one makes its own input (synthetic data, or files written into a temp directory)
+
+enum class eSelfTestKind : uint8_t
+{
+	TEST,		// pass/fail, run by -selftest
+	BENCHMARK,	// reports metrics, run by -bench. can still fail a check
+};
+
+struct SelfTestMetric_t
+{
+	std::string name;
+	double value;
+	std::string unit;
+};
+
+class CSelfTestContext
+{
+public:
+	CSelfTestContext(const uint64_t seed, const uint32_t scale) : m_rng(seed), m_scale(scale), m_checks(0u), m_failures(0u) {};
+
+	void Check(const bool passed, const char* const expr, const char* const file, const int line);
+	void Fail(const std::string& msg);
+
+	void Metric(const std::string& name, const double value, const char* const unit);
+	void Note(const std::string& msg);
+
+	inline std::mt19937_64& Rng() { return m_rng; };
+
+	// multiplier for benchmark sizes, -bench-scale. tests ignore it
+	inline const uint32_t Scale() const { return m_scale; };
+
+	inline const uint32_t Checks() const { return m_checks; };
+	inline const uint32_t Failures() const { return m_failures; };
+	inline const std::vector<std::string>& Messages() const { return m_messages; };
+	inline const std::vector<SelfTestMetric_t>& Metrics() const { return m_metrics; };
+
+	// working set of the process, for memory benchmarks
+	static const size_t ProcessMemory();
+
+	// empty directory under the system temp directory, removed again when the run ends
+	const std::filesystem::path& TempDirectory();
+	void RemoveTempDirectory();
+
+private:
+	std::mt19937_64 m_rng;
+	uint32_t m_scale;
+
+	uint32_t m_checks;
+	uint32_t m_failures;
+
+	std::vector<std::string> m_messages;
+	std::vector<SelfTestMetric_t> m_metrics;
+
+	std::filesystem::path m_tempDirectory;
+};
+
+typedef void(*SelfTestFunc_t)(CSelfTestContext& ctx);
+
+struct SelfTest_t
+{
+	const char* name;
+	eSelfTestKind kind;
+	SelfTestFunc_t func;
+};
+
+struct SelfTestResult_t
+{
+	const SelfTest_t* test;
+	bool passed;
+	uint32_t checks;
+	uint32_t failures;
+	double seconds;
+
+	std::vector<std::string> messages;
+	std::vector<SelfTestMetric_t> metrics;
+};
+
+class CSelfTestRegistrar
+{
+public:
+	CSelfTestRegistrar(const char* const name, const eSelfTestKind kind, const SelfTestFunc_t func);
+};
+
+#define SELFTEST_CONCAT_INNER(a, b) a##b
+#define SELFTEST_CONCAT(a, b) SELFTEST_CONCAT_INNER(a, b)
+
+// registers a function for -selftest/-bench, name is matched by the filter (e.g. -selftest pak.*)
+#define REGISTER_SELFTEST(name, func) static const CSelfTestRegistrar SELFTEST_CONCAT(s_selfTest, __LINE__)(name, eSelfTestKind::TEST, func)
+#define REGISTER_BENCHMARK(name, func) static const CSelfTestRegistrar SELFTEST_CONCAT(s_selfTest, __LINE__)(name, eSelfTestKind::BENCHMARK, func)
+
+#define SELFTEST_CHECK(ctx, expr) (ctx).Check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+// runs every registered test of this kind that filter accepts, in name order
+// report is called after each one, returns false if any failed
+const bool RunSelfTests(const eSelfTestKind kind, const std::function<bool(const char*)>& filter, const uint64_t seed, const uint32_t scale, const std::function<void(const SelfTestResult_t&)>& report);
+
+// names of every registered test of this kind
+void ListSelfTests(const eSelfTestKind kind, std::vector<std::string>& names);
+
+// times a function over iterations runs, returns the fastest run in nanoseconds so one slow run doesn't skew it
+template <typename Function>
+const int64_t SelfTestTimeBest(const uint32_t iterations, Function&& func)
+{
+	int64_t best = INT64_MAX;
+
+	for (uint32_t i = 0; i < iterations; ++i)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		func();
+		best = std::min(best, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count()));
+	}
+
+	return best;
+}
@@ -0,0 +1,395 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/filehandling/assetdiff.h>
+#include <core/filehandling/load.h>
+
+#include <game/rtech/cpakfile.h>
+
+// a type nothing else registers, the tests give it a load function of their own
+static constexpr uint32_t s_diffTestAssetType = MAKEFOURCC('d', 'f', 't', 'a');
+
+struct DiffTestAsset_t
+{
+	uint64_t guid;
+	uint64_t value;			// in the asset's header, after the pointer to its data
+	std::vector<char> data;	// cpu data
+};
+
+// header size of the test type, a pointer to the asset's data and its value
+static constexpr uint32_t s_diffTestHeaderSize = sizeof(PagePtr_t) + sizeof(uint64_t);
+
+template <typename T>
+static void AppendDiffTestBytes(std::vector<char>& bytes, const T* const values, const size_t count)
+{
+	const char* const raw = reinterpret_cast<const char*>(values);
+	bytes.insert(bytes.end(), raw, raw + (sizeof(T) * count));
+}
+
+// an uncompressed v6 pak with a header page and a cpu page, the assets' data is placed in the cpu page in the order given
+static const std::vector<char> DiffTestPak(const std::vector<DiffTestAsset_t>& assets, const std::vector<size_t>& dataOrder, const uint64_t createdTime)
+{
+	const int numAssets = static_cast<int>(assets.size());
+
+	std::vector<char> dataPage;
+	std::vector<int> dataOffsets(assets.size(), 0);
+	for (const size_t idx : dataOrder)
+	{
+		dataOffsets[idx] = static_cast<int>(dataPage.size());
+		dataPage.insert(dataPage.end(), assets[idx].data.begin(), assets[idx].data.end());
+	}
+
+	std::vector<char> headerPage(static_cast<size_t>(s_diffTestHeaderSize) * assets.size(), 0);
+	std::vector<PakPointerHdr_t> pointers(assets.size());
+	std::vector<PakAsset_v6_t> pakAssets(assets.size());
+
+	for (int i = 0; i < numAssets; i++)
+	{
+		const int headerOffset = static_cast<int>(s_diffTestHeaderSize) * i;
+
+		PagePtr_t dataPtr = {};
+		dataPtr.index = 1;
+		dataPtr.offset = dataOffsets[i];
+
+		memcpy(&headerPage[headerOffset], &dataPtr, sizeof(PagePtr_t));
+		memcpy(&headerPage[headerOffset + sizeof(PagePtr_t)], &assets[i].value, sizeof(uint64_t));
+
+		pointers[i].index = 0;
+		pointers[i].offset = headerOffset;
+
+		PakAsset_v6_t& pakAsset = pakAssets[i];
+		pakAsset.guid = assets[i].guid;
+		pakAsset.headPagePtr.index = 0;
+		pakAsset.headPagePtr.offset = headerOffset;
+		pakAsset.dataPagePtr = dataPtr;
+		pakAsset.starpakOffset = -1;
+		pakAsset.headerStructSize = s_diffTestHeaderSize;
+		pakAsset.version = 1;
+		pakAsset.type = s_diffTestAssetType;
+	}
+
+	const PakSegmentHdr_t segments[2] = { { 0, 8u, static_cast<int64_t>(headerPage.size()) }, { SF_CPU, 8u, static_cast<int64_t>(dataPage.size()) } };
+	const PakPageHdr_t pages[2] = { { 0, 8, static_cast<unsigned int>(headerPage.size()) }, { 1, 8, static_cast<unsigned int>(dataPage.size()) } };
+
+	PakHdr_v6_t header = {};
+	header.magic = pakFileMagic;
+	header.version = 6;
+	header.createdTime = createdTime;
+	header.numSegments = static_cast<int>(ARRSIZE(segments));
+	header.numPages = static_cast<int>(ARRSIZE(pages));
+	header.numPointers = numAssets;
+	header.numAssets = numAssets;
+
+	std::vector<char> bytes;
+	AppendDiffTestBytes(bytes, &header, 1ull);
+	AppendDiffTestBytes(bytes, segments, ARRSIZE(segments));
+	AppendDiffTestBytes(bytes, pages, ARRSIZE(pages));
+	AppendDiffTestBytes(bytes, pointers.data(), pointers.size());
+	AppendDiffTestBytes(bytes, pakAssets.data(), pakAssets.size());
+	bytes.insert(bytes.end(), headerPage.begin(), headerPage.end());
+	bytes.insert(bytes.end(), dataPage.begin(), dataPage.end());
+
+	reinterpret_cast<PakHdr_v6_t*>(bytes.data())->size = static_cast<int64_t>(bytes.size());
+
+	return bytes;
+}
+
+static const std::string WriteDiffTestPak(const std::filesystem::path& path, const std::vector<DiffTestAsset_t>& assets, const std::vector<size_t>& dataOrder, const uint64_t createdTime)
+{
+	std::filesystem::create_directories(path.parent_path());
+
+	const std::vector<char> bytes = DiffTestPak(assets, dataOrder, createdTime);
+
+	StreamIO out;
+	if (out.open(path.string(), eStreamIOMode::Write))
+	{
+		out.write(bytes.data(), bytes.size());
+		out.close();
+	}
+
+	return path.string();
+}
+
+static std::vector<DiffTestAsset_t> DiffTestAssets(std::mt19937_64& rng, const uint64_t firstGuid, const size_t numAssets, const size_t maxDataSize)
+{
+	std::vector<DiffTestAsset_t> assets(numAssets);
+	for (size_t i = 0; i < numAssets; i++)
+	{
+		DiffTestAsset_t& asset = assets[i];
+		asset.guid = firstGuid + i;
+		asset.value = rng();
+		asset.data.resize(8ull * (1ull + (rng() % (maxDataSize / 8ull))));
+
+		for (char& byte : asset.data)
+			byte = static_cast<char>(rng());
+	}
+
+	return assets;
+}
+
+static std::vector<size_t> DiffTestOrder(const size_t numAssets, const bool reversed)
+{
+	std::vector<size_t> order(numAssets);
+	for (size_t i = 0; i < numAssets; i++)
+		order[i] = reversed ? numAssets - 1ull - i : i;
+
+	return order;
+}
+
+// stands in for a load function that fixes its header up in place, what it leaves there is different on every load
+static void LoadDiffTestAsset(CAssetContainer* const container, CAsset* const asset)
+{
+	UNUSED(container);
+
+	char* const header = reinterpret_cast<char*>(static_cast<CPakAsset*>(asset)->header());
+	const uint64_t loaded = reinterpret_cast<uint64_t>(asset);
+
+	memcpy(header + sizeof(PagePtr_t), &loaded, sizeof(uint64_t));
+}
+
+// the test type's binding for the length of a test. afterwards the files it fingerprinted are taken back out of the index and every capture is dropped
+class CDiffTestScope
+{
+public:
+	CDiffTestScope()
+	{
+		g_assetData.m_assetTypeBindings[s_diffTestAssetType] = AssetTypeBinding_t{ .type = s_diffTestAssetType, .headerAlignment = 8u, .loadFunc = LoadDiffTestAsset };
+	}
+
+	~CDiffTestScope()
+	{
+		g_assetData.m_assetTypeBindings.erase(s_diffTestAssetType);
+		ClearPakFingerprintCaptures();
+
+		for (const std::string& path : m_paths)
+			g_assetFingerprintIndex.Remove(std::filesystem::absolute(path).string());
+	}
+
+	CDiffTestScope(const CDiffTestScope&) = delete;
+	CDiffTestScope& operator=(const CDiffTestScope&) = delete;
+
+	inline void AddPaths(const std::vector<std::string>& paths) { m_paths.insert(m_paths.end(), paths.begin(), paths.end()); };
+
+private:
+	std::vector<std::string> m_paths;
+};
+
+// loads a build the way headless -diff loads its -in files and fingerprints it, then unloads it again
+static void FingerprintDiffTestBuild(const std::vector<std::string>& paths, AssetFingerprintSet_t& set, AssetFingerprintStats_t& stats)
+{
+	SetPakFingerprintCapture(true);
+	HandleFileLoad(paths);
+	SetPakFingerprintCapture(false);
+
+	FingerprintLoadedFiles(paths, set, stats);
+
+	g_assetData.ClearAssetData();
+}
+
+static const AssetDiffTypeStats_t DiffTestTotals(const AssetDiffResult_t& diff)
+{
+	AssetDiffTypeStats_t totals = {};
+	for (const auto& [type, stats] : diff.types)
+	{
+		totals.added += stats.added;
+		totals.removed += stats.removed;
+		totals.changed += stats.changed;
+		totals.unchanged += stats.unchanged;
+	}
+
+	return totals;
+}
+
+// two crafted builds of two paks each. the second build moves every asset's data, changes two assets, drops one and adds one
+// the test type's load function writes into its header on every load, so this also fails if pages were fingerprinted after load
+static void SelfTest_AssetDiff(CSelfTestContext& ctx)
+{
+	if (!g_assetData.v_assetContainers.empty())
+	{
+		ctx.Note("skipped, assets are already loaded");
+		return;
+	}
+
+	CDiffTestScope scope;
+
+	std::mt19937_64& rng = ctx.Rng();
+
+	const std::vector<DiffTestAsset_t> oldA = DiffTestAssets(rng, 0xD1FF000000000000ull, 32ull, 128ull);
+	const std::vector<DiffTestAsset_t> oldB = DiffTestAssets(rng, 0xD1FF000100000000ull, 16ull, 128ull);
+
+	std::vector<DiffTestAsset_t> newA = oldA;
+	newA[2].data[0] ^= 1;
+	newA[3].value ^= 1ull;
+	newA.erase(newA.begin() + 1);
+	newA.push_back(DiffTestAssets(rng, 0xD1FF000000001000ull, 1ull, 128ull).front());
+
+	const std::filesystem::path& temp = ctx.TempDirectory();
+	const std::vector<std::string> oldPaths = {
+		WriteDiffTestPak(temp / "baseline" / "diff_a.rpak", oldA, DiffTestOrder(oldA.size(), false), 1ull),
+		WriteDiffTestPak(temp / "baseline" / "diff_b.rpak", oldB, DiffTestOrder(oldB.size(), false), 1ull),
+	};
+
+	// b only moved its data around and was rebuilt
+	const std::vector<std::string> newPaths = {
+		WriteDiffTestPak(temp / "current" / "diff_a.rpak", newA, DiffTestOrder(newA.size(), true), 2ull),
+		WriteDiffTestPak(temp / "current" / "diff_b.rpak", oldB, DiffTestOrder(oldB.size(), true), 2ull),
+	};
+
+	scope.AddPaths(oldPaths);
+	scope.AddPaths(newPaths);
+
+	AssetFingerprintSet_t oldSet;
+	AssetFingerprintStats_t oldStats = {};
+	FingerprintFileSet(oldPaths, oldSet, oldStats);
+
+	SELFTEST_CHECK(ctx, g_assetData.v_assetContainers.empty());
+	SELFTEST_CHECK(ctx, oldSet.size() == oldA.size() + oldB.size() && oldStats.cachedFiles == 0u);
+
+	AssetFingerprintSet_t newSet;
+	AssetFingerprintStats_t newStats = {};
+	FingerprintDiffTestBuild(newPaths, newSet, newStats);
+
+	AssetDiffResult_t diff;
+	DiffAssetSets(oldSet, newSet, diff);
+
+	const AssetDiffTypeStats_t totals = DiffTestTotals(diff);
+	SELFTEST_CHECK(ctx, totals.added == 1u && totals.removed == 1u && totals.changed == 2u);
+	SELFTEST_CHECK(ctx, totals.unchanged == static_cast<uint32_t>(oldA.size() - 3ull + oldB.size()));
+
+	for (const AssetDiffEntry_t& entry : diff.entries)
+	{
+		const uint64_t expected = entry.change == eAssetDiffChange::ADDED ? newA.back().guid : entry.change == eAssetDiffChange::REMOVED ? oldA[1].guid : 0ull;
+
+		if (entry.change == eAssetDiffChange::CHANGED)
+			SELFTEST_CHECK(ctx, entry.guid == oldA[2].guid || entry.guid == oldA[3].guid);
+		else
+			SELFTEST_CHECK(ctx, entry.guid == expected);
+	}
+
+	// the baseline again, all of it from the index this time and nothing loaded
+	AssetFingerprintSet_t cachedSet;
+	AssetFingerprintStats_t cachedStats = {};
+	FingerprintFileSet(oldPaths, cachedSet, cachedStats);
+
+	AssetDiffResult_t cachedDiff;
+	DiffAssetSets(oldSet, cachedSet, cachedDiff);
+
+	SELFTEST_CHECK(ctx, cachedStats.cachedFiles == 2u && cachedDiff.entries.empty());
+
+	// a pak loaded without capture can't be fingerprinted anymore and is left out rather than compared from its loaded pages
+	g_assetFingerprintIndex.Remove(std::filesystem::absolute(newPaths[1]).string());
+
+	HandleFileLoad({ newPaths[1] });
+
+	AssetFingerprintSet_t uncapturedSet;
+	AssetFingerprintStats_t uncapturedStats = {};
+	FingerprintLoadedFiles({ newPaths[1] }, uncapturedSet, uncapturedStats);
+
+	g_assetData.ClearAssetData();
+
+	SELFTEST_CHECK(ctx, uncapturedSet.empty() && uncapturedStats.skippedFiles == 1u);
+}
+
+REGISTER_SELFTEST("diff.fingerprint", SelfTest_AssetDiff);
+
+// a baseline of several paks fingerprinted cold and then from the index, the load of the newer build with and without capture, and the diff
+static void Benchmark_AssetDiff(CSelfTestContext& ctx)
+{
+	if (!g_assetData.v_assetContainers.empty())
+	{
+		ctx.Note("skipped, assets are already loaded");
+		return;
+	}
+
+	CDiffTestScope scope;
+
+	const size_t numPaks = 8ull;
+	const size_t assetsPerPak = 2000ull * ctx.Scale();
+
+	std::mt19937_64& rng = ctx.Rng();
+
+	std::vector<std::string> oldPaths;
+	std::vector<std::string> newPaths;
+	size_t changedAssets = 0ull;
+	uint64_t buildBytes = 0ull;
+
+	for (size_t pak = 0; pak < numPaks; pak++)
+	{
+		const std::vector<DiffTestAsset_t> oldAssets = DiffTestAssets(rng, 0xD1FF100000000000ull + (pak << 32), assetsPerPak, 4096ull);
+
+		// about one in fifty changed
+		std::vector<DiffTestAsset_t> newAssets = oldAssets;
+		for (size_t i = 0; i < newAssets.size(); i += 50ull)
+		{
+			newAssets[i].data[0] ^= 1;
+			changedAssets++;
+		}
+
+		const std::string name = std::format("bench_{}.rpak", pak);
+
+		oldPaths.emplace_back(WriteDiffTestPak(ctx.TempDirectory() / "baseline" / name, oldAssets, DiffTestOrder(oldAssets.size(), false), 1ull));
+		newPaths.emplace_back(WriteDiffTestPak(ctx.TempDirectory() / "current" / name, newAssets, DiffTestOrder(newAssets.size(), true), 2ull));
+
+		buildBytes += std::filesystem::file_size(newPaths.back());
+	}
+
+	scope.AddPaths(oldPaths);
+	scope.AddPaths(newPaths);
+
+	AssetFingerprintSet_t oldSet;
+	AssetFingerprintStats_t oldStats = {};
+	FingerprintFileSet(oldPaths, oldSet, oldStats);
+
+	// again, from the index
+	AssetFingerprintSet_t cachedSet;
+	AssetFingerprintStats_t cachedStats = {};
+	FingerprintFileSet(oldPaths, cachedSet, cachedStats);
+
+	SELFTEST_CHECK(ctx, cachedStats.cachedFiles == numPaks && cachedSet.size() == oldSet.size());
+
+	// what capture adds to loading the build that is compared
+	const int64_t loadNs = SelfTestTimeBest(3u, [&]()
+		{
+			HandleFileLoad(newPaths);
+			g_assetData.ClearAssetData();
+		});
+
+	const int64_t captureLoadNs = SelfTestTimeBest(3u, [&]()
+		{
+			SetPakFingerprintCapture(true);
+			HandleFileLoad(newPaths);
+			SetPakFingerprintCapture(false);
+
+			g_assetData.ClearAssetData();
+		});
+
+	SetPakFingerprintCapture(true);
+	HandleFileLoad(newPaths);
+	SetPakFingerprintCapture(false);
+
+	AssetFingerprintSet_t newSet;
+	AssetFingerprintStats_t newStats = {};
+	AssetDiffResult_t diff;
+
+	const int64_t diffNs = SelfTestTimeBest(1u, [&]()
+		{
+			FingerprintLoadedFiles(newPaths, newSet, newStats);
+			DiffAssetSets(oldSet, newSet, diff);
+		});
+
+	g_assetData.ClearAssetData();
+
+	const AssetDiffTypeStats_t totals = DiffTestTotals(diff);
+	SELFTEST_CHECK(ctx, totals.changed == changedAssets && totals.added == 0u && totals.removed == 0u);
+
+	ctx.Metric("paks", static_cast<double>(numPaks), "");
+	ctx.Metric("assets", static_cast<double>(numPaks * assetsPerPak), "");
+	ctx.Metric("build size", static_cast<double>(buildBytes) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("baseline, loaded and fingerprinted", static_cast<double>(oldStats.elapsedNs) / 1e6, "ms");
+	ctx.Metric("baseline, from the index", static_cast<double>(cachedStats.elapsedNs) / 1e6, "ms");
+	ctx.Metric("load", static_cast<double>(loadNs) / 1e6, "ms");
+	ctx.Metric("load with capture", static_cast<double>(captureLoadNs) / 1e6, "ms");
+	ctx.Metric("fingerprint loaded build and diff", static_cast<double>(diffNs) / 1e6, "ms");
+}
+
+REGISTER_BENCHMARK("diff.fingerprint", Benchmark_AssetDiff);
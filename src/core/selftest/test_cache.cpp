@@ -0,0 +1,335 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/cache/streamindex.h>
+#include <core/cache/texturestore.h>
+#include <core/cache/exportmanifest.h>
+#include <core/cache/fingerprintindex.h>
+
+// the cache files are read whole and their strings used in place, a damaged or hand edited file must be refused, not read past its end
+
+static const std::string WriteCacheFile(CSelfTestContext& ctx, const char* const name, const std::vector<char>& bytes)
+{
+	const std::string path = (ctx.TempDirectory() / name).string();
+
+	StreamIO file;
+	if (file.open(path, eStreamIOMode::Write))
+	{
+		file.write(bytes.data(), bytes.size());
+		file.close();
+	}
+
+	return path;
+}
+
+template <typename T>
+static void AppendBytes(std::vector<char>& bytes, const T& value)
+{
+	const char* const raw = reinterpret_cast<const char*>(&value);
+	bytes.insert(bytes.end(), raw, raw + sizeof(T));
+}
+
+static std::vector<char> StreamIndexFile(const uint32_t pathOffset, const std::string_view strings)
+{
+	MilesStreamIndexHeader_t header = {};
+	header.fileVersion = MILES_STREAM_INDEX_FILE_VERSION;
+	header.numEntries = 1u;
+	header.stringTableOffset = sizeof(MilesStreamIndexHeader_t) + sizeof(MilesStreamIndexMapping_t);
+
+	MilesStreamIndexMapping_t mapping = {};
+	mapping.fileSize = 1024ull;
+	mapping.pathOffset = pathOffset;
+
+	std::vector<char> bytes;
+	AppendBytes(bytes, header);
+	AppendBytes(bytes, mapping);
+	bytes.insert(bytes.end(), strings.begin(), strings.end());
+
+	return bytes;
+}
+
+static void SelfTest_CacheStreamIndexStrings(CSelfTestContext& ctx)
+{
+	using namespace std::string_view_literals;
+
+	{
+		CMilesStreamIndex index;
+		SELFTEST_CHECK(ctx, index.LoadFromFile(WriteCacheFile(ctx, "mstr_valid.bin", StreamIndexFile(0u, "audio\\general.mstr\0"sv))));
+	}
+
+	{
+		CMilesStreamIndex index;
+		SELFTEST_CHECK(ctx, !index.LoadFromFile(WriteCacheFile(ctx, "mstr_past_end.bin", StreamIndexFile(0x10000u, "audio\\general.mstr\0"sv))));
+	}
+
+	{
+		CMilesStreamIndex index;
+		SELFTEST_CHECK(ctx, !index.LoadFromFile(WriteCacheFile(ctx, "mstr_unterminated.bin", StreamIndexFile(0u, "audio\\general.mstr"sv))));
+	}
+}
+
+REGISTER_SELFTEST("cache.streamindex.strings", SelfTest_CacheStreamIndexStrings);
+
+static const std::string WriteStreamTestFile(const std::filesystem::path& path, const uint32_t buildTag, const size_t streamSize)
+{
+	MilesStreamHeader_t header = {};
+	header.magic = MAKEFOURCC('M', 'S', 'T', 'R');
+	header.version = 2u;
+	header.streamDataOffset = sizeof(MilesStreamHeader_t);
+	header.buildTag = buildTag;
+
+	std::vector<char> bytes;
+	AppendBytes(bytes, header);
+	bytes.resize(bytes.size() + streamSize, '\0');
+
+	StreamIO file;
+	if (file.open(path.string(), eStreamIOMode::Write))
+	{
+		file.write(bytes.data(), bytes.size());
+		file.close();
+	}
+
+	return std::filesystem::absolute(path).string();
+}
+
+// reads the header of every stream in the directory the way a bank load does, keyed by path with whether it had to be read from the file
+static void ScanStreamTestFiles(CSelfTestContext& ctx, CMilesStreamIndex& index, const std::filesystem::path& dir, std::map<std::string, std::pair<uint32_t, bool>>& headers)
+{
+	headers.clear();
+
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir))
+	{
+		const uint64_t misses = index.GetMisses();
+
+		MilesStreamHeader_t header = {};
+		SELFTEST_CHECK(ctx, index.GetHeader(entry, header));
+
+		headers.emplace(std::filesystem::absolute(entry.path()).string(), std::pair{ header.buildTag, index.GetMisses() != misses });
+	}
+}
+
+// an index saved by one session and loaded by the next has to read only the streams that changed since, by size or by write time
+static void SelfTest_CacheStreamIndexRebuild(CSelfTestContext& ctx)
+{
+	constexpr uint32_t numStreams = 6u;
+	constexpr size_t streamSize = 4096ull;
+
+	const std::filesystem::path dir = ctx.TempDirectory() / "streams";
+	std::filesystem::create_directories(dir);
+
+	std::vector<std::string> paths;
+	for (uint32_t i = 0; i < numStreams; i++)
+		paths.push_back(WriteStreamTestFile(dir / std::format("general_{}.mstr", i), 100u + i, streamSize));
+
+	const std::string indexPath = (ctx.TempDirectory() / "mstr_index.bin").string();
+	std::map<std::string, std::pair<uint32_t, bool>> headers;
+
+	{
+		CMilesStreamIndex index;
+		ScanStreamTestFiles(ctx, index, dir, headers);
+
+		SELFTEST_CHECK(ctx, index.GetMisses() == numStreams && index.GetHits() == 0ull);
+		SELFTEST_CHECK(ctx, index.SaveToFile(indexPath));
+	}
+
+	{
+		CMilesStreamIndex index;
+		SELFTEST_CHECK(ctx, index.LoadFromFile(indexPath));
+		ScanStreamTestFiles(ctx, index, dir, headers);
+
+		SELFTEST_CHECK(ctx, index.GetMisses() == 0ull && index.GetHits() == numStreams);
+		SELFTEST_CHECK(ctx, headers.size() == numStreams);
+
+		for (uint32_t i = 0; i < numStreams; i++)
+			SELFTEST_CHECK(ctx, headers[paths[i]].first == 100u + i);
+	}
+
+	// a patch that grew one stream, and another rewritten in place at the same size
+	WriteStreamTestFile(dir / "general_1.mstr", 201u, streamSize * 2ull);
+
+	{
+		std::error_code ec;
+		const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(paths[4], ec);
+
+		WriteStreamTestFile(dir / "general_4.mstr", 204u, streamSize);
+		std::filesystem::last_write_time(paths[4], writeTime + std::chrono::hours(1), ec);
+
+		SELFTEST_CHECK(ctx, !ec);
+	}
+
+	{
+		CMilesStreamIndex index;
+		SELFTEST_CHECK(ctx, index.LoadFromFile(indexPath));
+		ScanStreamTestFiles(ctx, index, dir, headers);
+
+		SELFTEST_CHECK(ctx, index.GetMisses() == 2ull && index.GetHits() == numStreams - 2ull);
+
+		for (uint32_t i = 0; i < numStreams; i++)
+		{
+			const bool changed = i == 1u || i == 4u;
+			const std::pair<uint32_t, bool>& result = headers[paths[i]];
+
+			if (result.second != changed || result.first != (changed ? 200u : 100u) + i)
+				ctx.Fail(std::format("general_{}.mstr was {} with build tag {}", i, result.second ? "read again" : "taken from the index", result.first));
+		}
+	}
+}
+
+REGISTER_SELFTEST("cache.streamindex.rebuild", SelfTest_CacheStreamIndexRebuild);
+
+static std::vector<char> TextureStoreFile(const uint32_t pathOffset, const std::string_view strings)
+{
+	TextureStoreHeader_t header = {};
+	header.fileVersion = TEXTURE_STORE_FILE_VERSION;
+	header.numEntries = 1u;
+	header.stringTableOffset = sizeof(TextureStoreHeader_t) + sizeof(TextureStoreMapping_t);
+
+	TextureStoreMapping_t mapping = {};
+	mapping.key = 0x1234ull;
+	mapping.fileSize = 1024ull;
+	mapping.pathOffset = pathOffset;
+
+	std::vector<char> bytes;
+	AppendBytes(bytes, header);
+	AppendBytes(bytes, mapping);
+	bytes.insert(bytes.end(), strings.begin(), strings.end());
+
+	return bytes;
+}
+
+static void SelfTest_CacheTextureStoreStrings(CSelfTestContext& ctx)
+{
+	using namespace std::string_view_literals;
+
+	{
+		CTextureExportStore store;
+		SELFTEST_CHECK(ctx, store.LoadFromFile(WriteCacheFile(ctx, "txtr_valid.bin", TextureStoreFile(0u, "exported_files\\texture\\a.png\0"sv))));
+		SELFTEST_CHECK(ctx, store.GetStats().entries == 1ull);
+	}
+
+	{
+		CTextureExportStore store;
+		SELFTEST_CHECK(ctx, !store.LoadFromFile(WriteCacheFile(ctx, "txtr_past_end.bin", TextureStoreFile(0x10000u, "exported_files\\texture\\a.png\0"sv))));
+		SELFTEST_CHECK(ctx, store.GetStats().entries == 0ull);
+	}
+
+	{
+		CTextureExportStore store;
+		SELFTEST_CHECK(ctx, !store.LoadFromFile(WriteCacheFile(ctx, "txtr_unterminated.bin", TextureStoreFile(0u, "exported_files\\texture\\a.png"sv))));
+	}
+}
+
+REGISTER_SELFTEST("cache.texturestore.strings", SelfTest_CacheTextureStoreStrings);
+
+static std::vector<char> ExportManifestFile(const uint32_t pathOffset, const std::string_view strings)
+{
+	ExportManifestHeader_t header = {};
+	header.fileVersion = EXPORT_MANIFEST_FILE_VERSION;
+	header.numEntries = 1u;
+	header.numOutputRefs = 1u;
+	header.numOutputs = 1u;
+	header.stringTableOffset = sizeof(ExportManifestHeader_t) + sizeof(ExportManifestEntry_t) + sizeof(uint32_t) + sizeof(ExportManifestOutput_t);
+
+	ExportManifestEntry_t entry = {};
+	entry.guid = 0x1234ull;
+	entry.assetType = 'rtxt';
+	entry.numOutputRefs = 1u;
+
+	ExportManifestOutput_t output = {};
+	output.fileSize = 1024ull;
+	output.pathOffset = pathOffset;
+
+	std::vector<char> bytes;
+	AppendBytes(bytes, header);
+	AppendBytes(bytes, entry);
+	AppendBytes(bytes, 0u); // the entry's only output
+	AppendBytes(bytes, output);
+	bytes.insert(bytes.end(), strings.begin(), strings.end());
+
+	return bytes;
+}
+
+static void SelfTest_CacheExportManifestStrings(CSelfTestContext& ctx)
+{
+	using namespace std::string_view_literals;
+
+	{
+		CExportManifest manifest;
+		SELFTEST_CHECK(ctx, manifest.LoadFromFile(WriteCacheFile(ctx, "manifest_valid.bin", ExportManifestFile(0u, "exported_files\\texture\\a.png\0"sv))));
+		SELFTEST_CHECK(ctx, manifest.GetStats().entries == 1ull);
+	}
+
+	{
+		CExportManifest manifest;
+		SELFTEST_CHECK(ctx, !manifest.LoadFromFile(WriteCacheFile(ctx, "manifest_past_end.bin", ExportManifestFile(0x10000u, "exported_files\\texture\\a.png\0"sv))));
+		SELFTEST_CHECK(ctx, manifest.GetStats().entries == 0ull);
+	}
+
+	{
+		CExportManifest manifest;
+		SELFTEST_CHECK(ctx, !manifest.LoadFromFile(WriteCacheFile(ctx, "manifest_unterminated.bin", ExportManifestFile(0u, "exported_files\\texture\\a.png"sv))));
+	}
+}
+
+REGISTER_SELFTEST("cache.exportmanifest.strings", SelfTest_CacheExportManifestStrings);
+
+static std::vector<char> FingerprintIndexFile(const uint32_t pathOffset, const uint32_t sourceFileOffset, const uint32_t nameOffset, const std::string_view strings)
+{
+	FingerprintIndexHeader_t header = {};
+	header.fileVersion = FINGERPRINT_INDEX_FILE_VERSION;
+	header.numEntries = 1u;
+	header.numSourceFiles = 1u;
+	header.numAssets = 1u;
+	header.stringTableOffset = sizeof(FingerprintIndexHeader_t) + sizeof(FingerprintIndexEntry_t) + sizeof(uint32_t) + sizeof(FingerprintIndexAsset_t);
+
+	FingerprintIndexEntry_t entry = {};
+	entry.pathOffset = pathOffset;
+	entry.numSourceFiles = 1u;
+	entry.numAssets = 1u;
+
+	FingerprintIndexAsset_t asset = {};
+	asset.guid = 0x1234ull;
+	asset.fingerprint = 0x5678ull;
+	asset.type = 'rtxt';
+	asset.nameOffset = nameOffset;
+
+	std::vector<char> bytes;
+	AppendBytes(bytes, header);
+	AppendBytes(bytes, entry);
+	AppendBytes(bytes, sourceFileOffset);
+	AppendBytes(bytes, asset);
+	bytes.insert(bytes.end(), strings.begin(), strings.end());
+
+	return bytes;
+}
+
+static void SelfTest_CacheFingerprintIndexStrings(CSelfTestContext& ctx)
+{
+	using namespace std::string_view_literals;
+
+	// the input is its own source file, the asset name follows it
+	constexpr std::string_view strings = "paks\\common.rpak\0texture\\a\0"sv;
+	constexpr uint32_t nameOffset = 17u;
+
+	{
+		CAssetFingerprintIndex index;
+		SELFTEST_CHECK(ctx, index.LoadFromFile(WriteCacheFile(ctx, "fingerprint_valid.bin", FingerprintIndexFile(0u, 0u, nameOffset, strings))));
+		SELFTEST_CHECK(ctx, index.GetStats().entries == 1ull);
+	}
+
+	// every kind of string is checked, not just the entry's path
+	for (const auto& [file, pathOffset, sourceFileOffset, assetNameOffset] : { std::tuple{ "fingerprint_path.bin", 0x10000u, 0u, nameOffset },
+		std::tuple{ "fingerprint_source.bin", 0u, 0x10000u, nameOffset }, std::tuple{ "fingerprint_name.bin", 0u, 0u, 0x10000u } })
+	{
+		CAssetFingerprintIndex index;
+		SELFTEST_CHECK(ctx, !index.LoadFromFile(WriteCacheFile(ctx, file, FingerprintIndexFile(pathOffset, sourceFileOffset, assetNameOffset, strings))));
+		SELFTEST_CHECK(ctx, index.GetStats().entries == 0ull);
+	}
+
+	{
+		CAssetFingerprintIndex index;
+		SELFTEST_CHECK(ctx, !index.LoadFromFile(WriteCacheFile(ctx, "fingerprint_unterminated.bin", FingerprintIndexFile(0u, 0u, nameOffset, "paks\\common.rpak\0texture\\a"sv))));
+	}
+}
+
+REGISTER_SELFTEST("cache.fingerprintindex.strings", SelfTest_CacheFingerprintIndexStrings);
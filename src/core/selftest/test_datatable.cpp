@@ -0,0 +1,350 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <game/rtech/assets/datatable_store.h>
+
+struct DatatableTestColumn_t
+{
+	const char* name;
+	DatatableColumType_t type;
+};
+
+// weapon and damage are in every table, the rest in about half, so columns merge across tables the way they do in game data
+static constexpr DatatableTestColumn_t s_datatableTestColumns[] = {
+	{ "weapon", DatatableColumType_t::String },
+	{ "damage", DatatableColumType_t::Int },
+	{ "fire_rate", DatatableColumType_t::Float },
+	{ "ammo", DatatableColumType_t::Int },
+	{ "enabled", DatatableColumType_t::Bool },
+	{ "origin", DatatableColumType_t::Vector },
+	{ "model", DatatableColumType_t::Asset },
+	{ "class", DatatableColumType_t::String },
+	{ "spread", DatatableColumType_t::Float },
+	{ "rarity", DatatableColumType_t::Int },
+};
+
+// a v0 datatable laid out like one from a pak, row data with string pointers into the set's strings
+struct SyntheticDatatable_t
+{
+	std::vector<DatatableAssetColumn_v0_t> columns;
+	std::vector<char> rows;
+	std::unique_ptr<DatatableAsset> asset;
+};
+
+struct SyntheticDatatableSet_t
+{
+	std::vector<std::string> columnNames; // by s_datatableTestColumns index
+	std::vector<std::string> tableNames;
+	std::vector<std::string> weapons;
+	std::vector<std::string> models;
+	std::vector<std::string> classes;
+
+	std::vector<SyntheticDatatable_t> tables;
+
+	std::vector<std::pair<uint64_t, const DatatableAsset*>> StoreTables() const
+	{
+		std::vector<std::pair<uint64_t, const DatatableAsset*>> out;
+		for (size_t i = 0; i < tables.size(); i++)
+			out.emplace_back(0x1000ull + i, tables[i].asset.get());
+
+		return out;
+	}
+
+	const size_t RowDataSize() const
+	{
+		size_t size = 0ull;
+		for (const SyntheticDatatable_t& table : tables)
+			size += table.rows.size();
+
+		return size;
+	}
+};
+
+static void MakeSyntheticDatatableSet(SyntheticDatatableSet_t& set, std::mt19937_64& rng, const size_t numTables, const size_t maxRows)
+{
+	static const char* const s_weaponKinds[] = { "smg", "rifle", "shotgun", "sniper", "lmg", "pistol" };
+
+	for (const DatatableTestColumn_t& column : s_datatableTestColumns)
+		set.columnNames.emplace_back(column.name);
+
+	for (uint32_t i = 0; i < 600u; i++)
+		set.weapons.emplace_back(std::format("mp_weapon_{}_{}", s_weaponKinds[i % ARRSIZE(s_weaponKinds)], i / ARRSIZE(s_weaponKinds)));
+
+	for (uint32_t i = 0; i < 500u; i++)
+		set.models.emplace_back(std::format("mdl/weapons/w_{}.rmdl", i));
+
+	for (uint32_t i = 0; i < 50u; i++)
+		set.classes.emplace_back(std::format("class_{}", i));
+
+	for (size_t i = 0; i < numTables; i++)
+		set.tableNames.emplace_back(std::format("datatable/weapons/table_{}.rpak", i));
+
+	set.tables.resize(numTables);
+	for (size_t i = 0; i < numTables; i++)
+	{
+		SyntheticDatatable_t& table = set.tables[i];
+
+		std::vector<uint32_t> picked = { 0u, 1u };
+		for (uint32_t j = 2u; j < ARRSIZE(s_datatableTestColumns); j++)
+		{
+			if (rng() & 1ull)
+				picked.push_back(j);
+		}
+
+		int rowStride = 0;
+		for (const uint32_t j : picked)
+		{
+			const size_t size = s_DatatableColumnTypeSize[static_cast<int>(s_datatableTestColumns[j].type)];
+			const int align = static_cast<int>(std::min(size, sizeof(char*)));
+
+			rowStride = (rowStride + align - 1) & ~(align - 1);
+			table.columns.push_back({ set.columnNames[j].data(), s_datatableTestColumns[j].type, rowStride });
+			rowStride += static_cast<int>(size);
+		}
+
+		rowStride = (rowStride + 7) & ~7;
+
+		const int numRows = static_cast<int>(1ull + (rng() % maxRows));
+		table.rows.resize(static_cast<size_t>(rowStride) * numRows);
+
+		for (int row = 0; row < numRows; row++)
+		{
+			char* const rowData = table.rows.data() + (static_cast<size_t>(rowStride) * row);
+
+			for (const DatatableAssetColumn_v0_t& column : table.columns)
+			{
+				char* const data = rowData + column.rowOffset;
+				const std::string_view name(column.name);
+
+				switch (column.type)
+				{
+				case DatatableColumType_t::Bool:
+					*reinterpret_cast<bool*>(data) = (rng() & 1ull) != 0ull;
+					break;
+				case DatatableColumType_t::Int:
+					*reinterpret_cast<int*>(data) = static_cast<int>(rng() % (name == "damage" ? 200ull : 500ull));
+					break;
+				case DatatableColumType_t::Float:
+					*reinterpret_cast<float*>(data) = static_cast<float>(rng() % 10000ull) * 0.001f;
+					break;
+				case DatatableColumType_t::Vector:
+					*reinterpret_cast<Vector*>(data) = Vector(static_cast<float>(rng() % 1000ull), static_cast<float>(rng() % 1000ull), static_cast<float>(rng() % 1000ull));
+					break;
+				default:
+				{
+					const std::vector<std::string>& pool = name == "weapon" ? set.weapons : (name == "model" ? set.models : set.classes);
+					*reinterpret_cast<const char**>(data) = pool[rng() % pool.size()].c_str();
+					break;
+				}
+				}
+			}
+		}
+
+		DatatableAssetHeader_v0_t hdr = {};
+		hdr.numColumns = static_cast<int>(table.columns.size());
+		hdr.numRows = numRows;
+		hdr.columns = table.columns.data();
+		hdr.rows = table.rows.data();
+		hdr.rowStride = rowStride;
+
+		table.asset = std::make_unique<DatatableAsset>(&hdr, eDTBLVersion::VERSION_0);
+		table.asset->name = set.tableNames[i].data();
+	}
+}
+
+// a predicate checked against one value of a row's data, with the store's rules for the column types used here
+static const bool DatatableTestValueMatches(const DatatableAssetColumn* const column, const char* const data, const DatatableQueryPredicate_t& predicate)
+{
+	int compare = 0;
+
+	switch (column->type)
+	{
+	case DatatableColumType_t::Bool:
+	case DatatableColumType_t::Int:
+	case DatatableColumType_t::Float:
+	{
+		double number = 0.0;
+		const char* const valueEnd = predicate.value.data() + predicate.value.length();
+		const std::from_chars_result numberResult = std::from_chars(predicate.value.data(), valueEnd, number);
+		if (numberResult.ec != std::errc() || numberResult.ptr != valueEnd || predicate.op == eDatatableQueryOp::CONTAINS)
+			return false;
+
+		const double value = column->type == DatatableColumType_t::Float ? static_cast<double>(*reinterpret_cast<const float*>(data))
+			: (column->type == DatatableColumType_t::Int ? static_cast<double>(*reinterpret_cast<const int*>(data)) : (*reinterpret_cast<const bool*>(data) ? 1.0 : 0.0));
+
+		compare = value < number ? -1 : (value > number ? 1 : 0);
+		break;
+	}
+	case DatatableColumType_t::String:
+	case DatatableColumType_t::Asset:
+	case DatatableColumType_t::AssetNoPrecache:
+	{
+		// the test strings are lowercase, as are the values queried for
+		const std::string_view str(*reinterpret_cast<const char* const*>(data));
+		if (predicate.op == eDatatableQueryOp::CONTAINS)
+			return str.find(predicate.value) != std::string_view::npos;
+
+		compare = str.compare(predicate.value);
+		break;
+	}
+	default:
+		return false;
+	}
+
+	switch (predicate.op)
+	{
+	case eDatatableQueryOp::EQ: return compare == 0;
+	case eDatatableQueryOp::NE: return compare != 0;
+	case eDatatableQueryOp::LT: return compare < 0;
+	case eDatatableQueryOp::LE: return compare <= 0;
+	case eDatatableQueryOp::GT: return compare > 0;
+	case eDatatableQueryOp::GE: return compare >= 0;
+	default: return false;
+	}
+}
+
+// every row of every datatable read straight from its row data, what answering a query costs without the store
+static const size_t ScanSyntheticDatatables(const SyntheticDatatableSet_t& set, const DatatableQuery_t& query)
+{
+	size_t matched = 0ull;
+
+	std::vector<const DatatableAssetColumn*> predicateColumns(query.where.size());
+	for (const SyntheticDatatable_t& table : set.tables)
+	{
+		const DatatableAsset* const dtblAsset = table.asset.get();
+
+		bool hasColumns = true;
+		for (size_t i = 0; i < query.where.size(); i++)
+		{
+			predicateColumns[i] = nullptr;
+			for (int j = 0; j < dtblAsset->numColumns; j++)
+			{
+				if (query.where[i].column == dtblAsset->GetColumn(j)->name)
+					predicateColumns[i] = dtblAsset->GetColumn(j);
+			}
+
+			hasColumns &= predicateColumns[i] != nullptr;
+		}
+
+		if (!hasColumns)
+			continue;
+
+		for (int row = 0; row < dtblAsset->numRows; row++)
+		{
+			const char* const rowData = dtblAsset->GetRowPtr(row);
+
+			bool rowMatches = true;
+			for (size_t i = 0; i < query.where.size() && rowMatches; i++)
+				rowMatches = DatatableTestValueMatches(predicateColumns[i], rowData + predicateColumns[i]->rowOffset, query.where[i]);
+
+			matched += rowMatches;
+		}
+	}
+
+	return matched;
+}
+
+static constexpr const char* s_datatableTestQueries[] = {
+	"damage > 150",
+	"weapon = mp_weapon_smg_7",
+	"weapon ~ smg",
+	"model ~ w_12",
+	"damage >= 100 && fire_rate < 2.5 && class = class_3",
+	"enabled = 1 && weapon ~ sniper && ammo <= 20",
+};
+
+// store queries match every row a scan of the row data does, and the store goes stale when assets are unloaded
+static void SelfTest_DatatableStore(CSelfTestContext& ctx)
+{
+	SyntheticDatatableSet_t set;
+	MakeSyntheticDatatableSet(set, ctx.Rng(), 40ull, 2000ull);
+
+	CDatatableStore store;
+	store.BuildFromTables(set.StoreTables());
+
+	SELFTEST_CHECK(ctx, store.NumTables() == set.tables.size());
+	SELFTEST_CHECK(ctx, store.NumColumns() == ARRSIZE(s_datatableTestColumns));
+
+	DatatableQuery_t query;
+	DatatableQueryResult_t result;
+	std::string error;
+
+	for (const char* const expr : s_datatableTestQueries)
+	{
+		if (!DatatableQuery_t::Parse(expr, query, error))
+		{
+			ctx.Fail(std::format("\"{}\" didn't parse: {}", expr, error));
+			continue;
+		}
+
+		store.Query(query, result);
+
+		const size_t expected = ScanSyntheticDatatables(set, query);
+		if (result.totalRows != expected)
+			ctx.Fail(std::format("\"{}\" matched {} rows, the row data has {}", expr, result.totalRows, expected));
+
+		SELFTEST_CHECK(ctx, result.rows.size() == std::min(expected, query.limit));
+	}
+
+	// an unload that leaves the asset and container counts where they were
+	store.Build();
+	SELFTEST_CHECK(ctx, !store.IsStale());
+
+	++g_assetData.m_unloadGeneration;
+	SELFTEST_CHECK(ctx, store.IsStale());
+
+	store.Build();
+	SELFTEST_CHECK(ctx, !store.IsStale());
+}
+
+REGISTER_SELFTEST("datatable.store", SelfTest_DatatableStore);
+
+// store build cost and query latency over a few hundred datatables, against scanning every table's rows for the same query
+static void Benchmark_DatatableQuery(CSelfTestContext& ctx)
+{
+	SyntheticDatatableSet_t set;
+	MakeSyntheticDatatableSet(set, ctx.Rng(), 400ull * ctx.Scale(), 5000ull);
+
+	const std::vector<std::pair<uint64_t, const DatatableAsset*>> storeTables = set.StoreTables();
+
+	CDatatableStore store;
+	const int64_t buildNs = SelfTestTimeBest(3u, [&]() { store.BuildFromTables(storeTables); });
+
+	ctx.Metric("datatables", static_cast<double>(store.NumTables()), "");
+	ctx.Metric("rows", static_cast<double>(store.NumRows()), "");
+	ctx.Metric("row data", static_cast<double>(set.RowDataSize()) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("store", static_cast<double>(store.MemoryUsage()) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("store build", static_cast<double>(buildNs) / 1e6, "ms");
+
+	DatatableQuery_t query;
+	DatatableQueryResult_t result;
+	std::string error;
+
+	for (const char* const expr : s_datatableTestQueries)
+	{
+		if (!DatatableQuery_t::Parse(expr, query, error))
+		{
+			ctx.Fail(std::format("\"{}\" didn't parse: {}", expr, error));
+			continue;
+		}
+
+		const int64_t queryNs = SelfTestTimeBest(5u, [&]() { store.Query(query, result); });
+
+		size_t expected = 0ull;
+		const int64_t scanNs = SelfTestTimeBest(3u, [&]() { expected = ScanSyntheticDatatables(set, query); });
+
+		SELFTEST_CHECK(ctx, result.totalRows == expected);
+
+		ctx.Metric(std::format("{}, {} rows, store", expr, result.totalRows), static_cast<double>(queryNs) / 1e6, "ms");
+		ctx.Metric(std::format("{}, scan", expr), static_cast<double>(scanNs) / 1e6, "ms");
+	}
+
+	// every column of every table, no index can answer it
+	if (DatatableQuery_t::Parse("* ~ w_12", query, error))
+	{
+		const int64_t queryNs = SelfTestTimeBest(5u, [&]() { store.Query(query, result); });
+		ctx.Metric(std::format("* ~ w_12, {} rows, store", result.totalRows), static_cast<double>(queryNs) / 1e6, "ms");
+	}
+}
+
+REGISTER_BENCHMARK("datatable.query", Benchmark_DatatableQuery);
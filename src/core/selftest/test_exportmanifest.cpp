@@ -0,0 +1,446 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/cache/exportmanifest.h>
+#include <core/filehandling/load.h>
+
+#include <game/rtech/cpakfile.h>
+#include <game/rtech/assets/model.h>
+#include <game/model/sourcemodel.h>
+
+// a model with nothing but its header and name, enough for a source model asset and its container
+static const std::vector<char> ManifestTestModel(const uint32_t idx)
+{
+	const std::string name = std::format("manifest/dir_{}/model_{}.mdl", idx % 16u, idx);
+
+	std::vector<char> file(sizeof(r2::studiohdr_t), 0);
+	const size_t nameOffset = file.size();
+
+	file.insert(file.end(), name.begin(), name.end());
+	file.emplace_back('\0');
+
+	r2::studiohdr_t* const hdr = reinterpret_cast<r2::studiohdr_t*>(file.data());
+	hdr->id = MODEL_FILE_ID;
+	hdr->version = 53;
+	hdr->sznameindex = static_cast<int>(nameOffset);
+	hdr->length = static_cast<int>(file.size());
+
+	return file;
+}
+
+// opened through StreamIO, which records it with the calling thread's tracker
+static const bool WriteManifestTestFile(const std::filesystem::path& path, const std::string& text)
+{
+	StreamIO out;
+	if (!out.open(path.string(), eStreamIOMode::Write))
+		return false;
+
+	out.write(text.data(), text.length());
+	out.close();
+
+	return true;
+}
+
+// stands in for a model exporter, a text mesh of a few thousand vertices and a small qc next to it
+static const bool ExportManifestTestModel(CSourceModelAsset* const asset, const std::filesystem::path& dir)
+{
+	const uint64_t guid = asset->GetAssetGUID();
+	const std::filesystem::path base = dir / std::format("{:X}", guid);
+
+	std::string mesh = "version 1\nnodes\n0 \"root\" -1\nend\ntriangles\n";
+	for (uint32_t i = 0; i < 3000u; i++)
+	{
+		const float x = static_cast<float>((guid >> (i % 48u)) & 0xffff) * 0.01f;
+		std::format_to(std::back_inserter(mesh), "0 {:.6f} {:.6f} {:.6f} 0.000000 0.000000 1.000000 {:.6f} {:.6f}\n", x, x * 0.5f, static_cast<float>(i), x * 0.001f, static_cast<float>(i) * 0.0001f);
+	}
+
+	mesh += "end\n";
+
+	const std::string qc = std::format("$modelname \"{}\"\n$body \"body\" \"{:X}.smd\"\n", asset->GetAssetName(), guid);
+
+	return WriteManifestTestFile(base.string() + ".smd", mesh) && WriteManifestTestFile(base.string() + ".qc", qc);
+}
+
+// an export of every asset the way HandleExportBindingForAssetEx does it with incremental export on
+static const int64_t RunManifestTestExport(CExportManifest& manifest, const std::vector<CSourceModelAsset*>& assets, const std::filesystem::path& dir, const uint32_t threadCount)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	const uint32_t numAssets = static_cast<uint32_t>(assets.size());
+
+	CParallelTask task(threadCount);
+
+	std::atomic<uint32_t> assetIdx = 0u;
+	task.addTask([&]()
+		{
+			for (uint32_t i = assetIdx++; i < numAssets; i = assetIdx++)
+			{
+				CSourceModelAsset* const asset = assets[i];
+
+				ExportManifestStamp_t stamp = {};
+				CExportManifest::StampAsset(asset, 0, stamp);
+
+				if (manifest.IsUpToDate(stamp))
+					continue;
+
+				const auto exportStart = std::chrono::steady_clock::now();
+
+				CWrittenFileTracker writtenFiles;
+				if (ExportManifestTestModel(asset, dir))
+					manifest.Add(stamp, writtenFiles.Files(), std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - exportStart).count());
+				else
+					manifest.Remove(stamp);
+			}
+		}, threadCount);
+
+	task.execute();
+	task.wait();
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// a large selection exported, then exported again in a new session with the manifest the first run saved
+static void Benchmark_ExportManifest(CSelfTestContext& ctx)
+{
+	const uint32_t numAssets = 1000u * ctx.Scale();
+	const uint32_t threadCount = std::max(UtilsConfig->exportThreadCount, 1u);
+
+	const std::filesystem::path modelDir = ctx.TempDirectory() / "models";
+	const std::filesystem::path exportDir = ctx.TempDirectory() / "exported";
+
+	std::filesystem::create_directories(modelDir);
+	std::filesystem::create_directories(exportDir);
+
+	std::vector<CSourceModelAsset*> assets;
+	for (uint32_t i = 0; i < numAssets; i++)
+	{
+		const std::string path = (modelDir / std::format("model_{}.mdl", i)).string();
+		const std::vector<char> file = ManifestTestModel(i);
+
+		StreamIO out;
+		if (!out.open(path, eStreamIOMode::Write))
+			continue;
+
+		out.write(file.data(), file.size());
+		out.close();
+
+		std::vector<CSourceSequenceAsset*> sequences;
+		if (CSourceModelAsset* const model = CreateSourceModelAssets(path, sequences))
+			assets.push_back(model);
+	}
+
+	SELFTEST_CHECK(ctx, assets.size() == numAssets);
+
+	CExportManifest firstRun;
+	const int64_t fullNs = RunManifestTestExport(firstRun, assets, exportDir, threadCount);
+
+	SELFTEST_CHECK(ctx, firstRun.GetStats().exported == assets.size() && firstRun.GetStats().entries == assets.size());
+
+	const std::string manifestPath = (ctx.TempDirectory() / "export_manifest.bin").string();
+
+	bool saved = false;
+	const int64_t saveNs = SelfTestTimeBest(1u, [&]() { saved = firstRun.SaveToFile(manifestPath); });
+
+	// a new session, only what the file holds
+	CExportManifest secondRun;
+
+	bool loaded = false;
+	const int64_t loadNs = SelfTestTimeBest(1u, [&]() { loaded = secondRun.LoadFromFile(manifestPath); });
+
+	SELFTEST_CHECK(ctx, saved && loaded);
+
+	const int64_t secondNs = RunManifestTestExport(secondRun, assets, exportDir, threadCount);
+	const ExportManifestStats_t secondStats = secondRun.GetStats();
+
+	SELFTEST_CHECK(ctx, secondStats.skipped == assets.size() && secondStats.exported == 0ull);
+
+	// files edited since they were exported are exported again, nothing else is
+	uint64_t edited = 0ull;
+	for (size_t i = 0; i < assets.size(); i += 20ull)
+	{
+		StreamIO out;
+		if (!out.open((exportDir / std::format("{:X}.qc", assets[i]->GetAssetGUID())).string(), eStreamIOMode::Write))
+			continue;
+
+		out.write("// edited\n", 10ull);
+		out.close();
+
+		edited++;
+	}
+
+	const int64_t editedNs = RunManifestTestExport(secondRun, assets, exportDir, threadCount);
+	const ExportManifestStats_t editedStats = secondRun.GetStats();
+
+	SELFTEST_CHECK(ctx, editedStats.exported - secondStats.exported == edited);
+
+	// models export their material textures in the texture type's format, changing it makes them stale
+	auto txtrAssetBinding = g_assetData.m_assetTypeBindings.find('rtxt');
+	if (txtrAssetBinding != g_assetData.m_assetTypeBindings.end() && !assets.empty())
+	{
+		ExportManifestStamp_t before = {};
+		CExportManifest::StampAsset(assets.front(), 0, before);
+
+		const int savedSetting = txtrAssetBinding->second.e.exportSetting;
+		txtrAssetBinding->second.e.exportSetting = savedSetting + 1;
+
+		ExportManifestStamp_t after = {};
+		CExportManifest::StampAsset(assets.front(), 0, after);
+
+		txtrAssetBinding->second.e.exportSetting = savedSetting;
+
+		SELFTEST_CHECK(ctx, before.settingsHash != after.settingsHash);
+	}
+
+	uint64_t outputBytes = 0ull;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(exportDir))
+		outputBytes += entry.is_regular_file() ? entry.file_size() : 0ull;
+
+	for (CSourceModelAsset* const model : assets)
+	{
+		CAssetContainer* const container = model->GetContainerFile<CAssetContainer>();
+
+		delete model;
+		delete container;
+	}
+
+	ctx.Metric("assets", static_cast<double>(numAssets), "");
+	ctx.Metric("export threads", static_cast<double>(threadCount), "");
+	ctx.Metric("output", static_cast<double>(outputBytes) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("first export", static_cast<double>(fullNs) / 1e6, "ms");
+	ctx.Metric("manifest save", static_cast<double>(saveNs) / 1e6, "ms");
+	ctx.Metric("manifest load", static_cast<double>(loadNs) / 1e6, "ms");
+	ctx.Metric("second export, nothing changed", static_cast<double>(secondNs) / 1e6, "ms");
+	ctx.Metric("second export, of the first", (static_cast<double>(secondNs) / static_cast<double>(fullNs)) * 100.0, "%");
+	ctx.Metric(std::format("export with {} edited files", edited), static_cast<double>(editedNs) / 1e6, "ms");
+}
+
+REGISTER_BENCHMARK("export.manifest", Benchmark_ExportManifest);
+
+// a type nothing else registers, its assets only hold the guids of what they depend on
+static constexpr uint32_t s_manifestTestAssetType = MAKEFOURCC('m', 'f', 't', 'a');
+static constexpr uint32_t s_manifestTestMaxDependencies = 2u;
+
+// header size of the test type, a pointer to the asset's data and a guid per dependency
+static constexpr uint32_t s_manifestTestHeaderSize = sizeof(PagePtr_t) + (sizeof(uint64_t) * s_manifestTestMaxDependencies);
+
+struct ManifestTestPakAsset_t
+{
+	uint64_t guid;
+	std::vector<uint64_t> dependencies;
+};
+
+template <typename T>
+static void AppendManifestTestBytes(std::vector<char>& bytes, const T* const values, const size_t count)
+{
+	const char* const raw = reinterpret_cast<const char*>(values);
+	bytes.insert(bytes.end(), raw, raw + (sizeof(T) * count));
+}
+
+// an uncompressed v6 pak with a header page and a cpu page, every dependency guid in a header has a guid ref pointing at it
+static const std::vector<char> ManifestTestPak(const std::vector<ManifestTestPakAsset_t>& assets, const uint64_t createdTime)
+{
+	const int numAssets = static_cast<int>(assets.size());
+
+	std::vector<char> headerPage(static_cast<size_t>(s_manifestTestHeaderSize) * assets.size(), 0);
+	std::vector<char> dataPage(sizeof(uint64_t) * assets.size(), 0);
+	std::vector<PakPointerHdr_t> pointers(assets.size());
+	std::vector<PakGuidRefHdr_t> guidRefs;
+	std::vector<PakAsset_v6_t> pakAssets(assets.size());
+
+	for (int i = 0; i < numAssets; i++)
+	{
+		const ManifestTestPakAsset_t& asset = assets[i];
+		assertm(asset.dependencies.size() <= s_manifestTestMaxDependencies, "too many dependencies for the test type");
+
+		const int headerOffset = static_cast<int>(s_manifestTestHeaderSize) * i;
+
+		PagePtr_t dataPtr = {};
+		dataPtr.index = 1;
+		dataPtr.offset = static_cast<int>(sizeof(uint64_t)) * i;
+
+		memcpy(&headerPage[headerOffset], &dataPtr, sizeof(PagePtr_t));
+		memcpy(&dataPage[dataPtr.offset], &asset.guid, sizeof(uint64_t));
+
+		pointers[i].index = 0;
+		pointers[i].offset = headerOffset;
+
+		PakAsset_v6_t& pakAsset = pakAssets[i];
+		pakAsset.guid = asset.guid;
+		pakAsset.headPagePtr.index = 0;
+		pakAsset.headPagePtr.offset = headerOffset;
+		pakAsset.dataPagePtr = dataPtr;
+		pakAsset.starpakOffset = -1;
+		pakAsset.dependenciesIndex = static_cast<uint32_t>(guidRefs.size());
+		pakAsset.dependenciesCount = static_cast<uint32_t>(asset.dependencies.size());
+		pakAsset.headerStructSize = s_manifestTestHeaderSize;
+		pakAsset.version = 1;
+		pakAsset.type = s_manifestTestAssetType;
+
+		for (size_t dep = 0; dep < asset.dependencies.size(); dep++)
+		{
+			const int guidOffset = headerOffset + static_cast<int>(sizeof(PagePtr_t) + (sizeof(uint64_t) * dep));
+			memcpy(&headerPage[guidOffset], &asset.dependencies[dep], sizeof(uint64_t));
+
+			PakGuidRefHdr_t& guidRef = guidRefs.emplace_back();
+			guidRef.index = 0;
+			guidRef.offset = guidOffset;
+		}
+	}
+
+	const PakSegmentHdr_t segments[2] = { { 0, 8u, static_cast<int64_t>(headerPage.size()) }, { SF_CPU, 8u, static_cast<int64_t>(dataPage.size()) } };
+	const PakPageHdr_t pages[2] = { { 0, 8, static_cast<unsigned int>(headerPage.size()) }, { 1, 8, static_cast<unsigned int>(dataPage.size()) } };
+
+	PakHdr_v6_t header = {};
+	header.magic = pakFileMagic;
+	header.version = 6;
+	header.createdTime = createdTime;
+	header.numSegments = static_cast<int>(ARRSIZE(segments));
+	header.numPages = static_cast<int>(ARRSIZE(pages));
+	header.numPointers = numAssets;
+	header.numAssets = numAssets;
+	header.numGuidRefs = static_cast<int>(guidRefs.size());
+
+	std::vector<char> bytes;
+	AppendManifestTestBytes(bytes, &header, 1ull);
+	AppendManifestTestBytes(bytes, segments, ARRSIZE(segments));
+	AppendManifestTestBytes(bytes, pages, ARRSIZE(pages));
+	AppendManifestTestBytes(bytes, pointers.data(), pointers.size());
+	AppendManifestTestBytes(bytes, pakAssets.data(), pakAssets.size());
+	AppendManifestTestBytes(bytes, guidRefs.data(), guidRefs.size());
+	bytes.insert(bytes.end(), headerPage.begin(), headerPage.end());
+	bytes.insert(bytes.end(), dataPage.begin(), dataPage.end());
+
+	reinterpret_cast<PakHdr_v6_t*>(bytes.data())->size = static_cast<int64_t>(bytes.size());
+
+	return bytes;
+}
+
+// a rebuild of the pak, the write time is moved on so the change is seen whatever the file system's time resolution
+static const bool WriteManifestTestPak(const std::filesystem::path& path, const std::vector<ManifestTestPakAsset_t>& assets, const uint64_t createdTime)
+{
+	std::error_code ec;
+	const bool existed = std::filesystem::exists(path, ec);
+	const std::filesystem::file_time_type prevWriteTime = existed ? std::filesystem::last_write_time(path, ec) : std::filesystem::file_time_type();
+
+	const std::vector<char> bytes = ManifestTestPak(assets, createdTime);
+
+	StreamIO out;
+	if (!out.open(path.string(), eStreamIOMode::Write))
+		return false;
+
+	out.write(bytes.data(), bytes.size());
+	out.close();
+
+	if (existed)
+		std::filesystem::last_write_time(path, prevWriteTime + std::chrono::hours(1), ec);
+
+	return !ec;
+}
+
+static void LoadManifestTestAsset(CAssetContainer* const container, CAsset* const asset)
+{
+	UNUSED(container);
+	UNUSED(asset);
+}
+
+// the stamp of every test asset with the given paks loaded, 0 for one that didn't load
+static const std::unordered_map<uint64_t, uint64_t> StampManifestTestPaks(const std::vector<std::string>& paths, const std::vector<uint64_t>& guids)
+{
+	HandleFileLoad(paths);
+
+	std::unordered_map<uint64_t, uint64_t> sourceHashes;
+	for (const uint64_t guid : guids)
+	{
+		ExportManifestStamp_t stamp = {};
+		if (CPakAsset* const asset = g_assetData.FindAssetByGUID<CPakAsset>(guid))
+			CExportManifest::StampAsset(asset, 0, stamp);
+
+		sourceHashes.emplace(guid, stamp.sourceHash);
+	}
+
+	g_assetData.ClearAssetData();
+
+	return sourceHashes;
+}
+
+// three paks: a model like asset in the first depends on a texture like asset in the second, and on a material like asset next to it that depends on one in the third
+// rebuilding a dependency's pak makes everything that reaches it stale, and only that
+static void SelfTest_ExportManifestDependencies(CSelfTestContext& ctx)
+{
+	if (!g_assetData.v_assetContainers.empty())
+	{
+		ctx.Note("skipped, assets are already loaded");
+		return;
+	}
+
+	g_assetData.m_assetTypeBindings[s_manifestTestAssetType] = AssetTypeBinding_t{ .type = s_manifestTestAssetType, .headerAlignment = 8u, .loadFunc = LoadManifestTestAsset };
+
+	constexpr uint64_t modelGuid = 0x3A4F000000000001ull;
+	constexpr uint64_t materialGuid = 0x3A4F000000000002ull;
+	constexpr uint64_t textureGuid = 0x3A4F000000000003ull;
+	constexpr uint64_t shaderGuid = 0x3A4F000000000004ull;
+	constexpr uint64_t unrelatedGuid = 0x3A4F000000000005ull;
+
+	const std::vector<ManifestTestPakAsset_t> pakA = { { modelGuid, { textureGuid, materialGuid } }, { materialGuid, { shaderGuid } } };
+	const std::vector<ManifestTestPakAsset_t> pakB = { { textureGuid, {} } };
+	const std::vector<ManifestTestPakAsset_t> pakC = { { shaderGuid, {} }, { unrelatedGuid, {} } };
+
+	const std::vector<uint64_t> guids = { modelGuid, materialGuid, textureGuid, shaderGuid, unrelatedGuid };
+
+	const std::vector<std::string> paths = {
+		(ctx.TempDirectory() / "manifest_a.rpak").string(),
+		(ctx.TempDirectory() / "manifest_b.rpak").string(),
+		(ctx.TempDirectory() / "manifest_c.rpak").string(),
+	};
+
+	SELFTEST_CHECK(ctx, WriteManifestTestPak(paths[0], pakA, 1ull) && WriteManifestTestPak(paths[1], pakB, 1ull) && WriteManifestTestPak(paths[2], pakC, 1ull));
+
+	const std::unordered_map<uint64_t, uint64_t> first = StampManifestTestPaks(paths, guids);
+	const std::unordered_map<uint64_t, uint64_t> again = StampManifestTestPaks(paths, guids);
+
+	for (const uint64_t guid : guids)
+		SELFTEST_CHECK(ctx, first.at(guid) != 0ull && first.at(guid) == again.at(guid));
+
+	// the model's export is recorded, with a file it wrote for its texture
+	CExportManifest manifest;
+	const std::filesystem::path texturePath = ctx.TempDirectory() / "texture.png";
+
+	SELFTEST_CHECK(ctx, WriteManifestTestFile(texturePath, "texture"));
+
+	ExportManifestStamp_t modelStamp = { modelGuid, s_manifestTestAssetType, 0, first.at(modelGuid), 0ull };
+	manifest.Add(modelStamp, { texturePath.string() }, 1000ll);
+
+	SELFTEST_CHECK(ctx, manifest.IsUpToDate(modelStamp));
+
+	// the texture's pak is rebuilt, the model and the texture are stale, the file the model wrote is untouched
+	SELFTEST_CHECK(ctx, WriteManifestTestPak(paths[1], pakB, 2ull));
+	const std::unordered_map<uint64_t, uint64_t> textureRebuilt = StampManifestTestPaks(paths, guids);
+
+	SELFTEST_CHECK(ctx, textureRebuilt.at(modelGuid) != first.at(modelGuid));
+	SELFTEST_CHECK(ctx, textureRebuilt.at(textureGuid) != first.at(textureGuid));
+	SELFTEST_CHECK(ctx, textureRebuilt.at(materialGuid) == first.at(materialGuid));
+	SELFTEST_CHECK(ctx, textureRebuilt.at(shaderGuid) == first.at(shaderGuid));
+	SELFTEST_CHECK(ctx, textureRebuilt.at(unrelatedGuid) == first.at(unrelatedGuid));
+
+	modelStamp.sourceHash = textureRebuilt.at(modelGuid);
+	SELFTEST_CHECK(ctx, !manifest.IsUpToDate(modelStamp));
+
+	// the third pak is only reached through the material, the model depends on it all the same
+	SELFTEST_CHECK(ctx, WriteManifestTestPak(paths[2], pakC, 2ull));
+	const std::unordered_map<uint64_t, uint64_t> shaderRebuilt = StampManifestTestPaks(paths, guids);
+
+	SELFTEST_CHECK(ctx, shaderRebuilt.at(modelGuid) != textureRebuilt.at(modelGuid));
+	SELFTEST_CHECK(ctx, shaderRebuilt.at(materialGuid) != textureRebuilt.at(materialGuid));
+	SELFTEST_CHECK(ctx, shaderRebuilt.at(textureGuid) == textureRebuilt.at(textureGuid));
+
+	// without the texture's pak the model exports without its texture, that isn't the export that was recorded either
+	const std::unordered_map<uint64_t, uint64_t> textureMissing = StampManifestTestPaks({ paths[0], paths[2] }, guids);
+
+	SELFTEST_CHECK(ctx, textureMissing.at(textureGuid) == 0ull);
+	SELFTEST_CHECK(ctx, textureMissing.at(modelGuid) != shaderRebuilt.at(modelGuid));
+	SELFTEST_CHECK(ctx, textureMissing.at(materialGuid) == shaderRebuilt.at(materialGuid));
+
+	g_assetData.m_assetTypeBindings.erase(s_manifestTestAssetType);
+}
+
+REGISTER_SELFTEST("export.manifest.dependencies", SelfTest_ExportManifestDependencies);
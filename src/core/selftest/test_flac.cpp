@@ -0,0 +1,699 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <game/audio/flac.h>
+#include <game/audio/wavefile.h>
+
+// a flac decoder written from the format spec, it shares nothing with the encoder so the round trip checks the bitstream and not just the encoder against itself
+// only what a conforming stream can hold is handled, anything unexpected fails the decode
+
+class CFlacTestBitReader
+{
+public:
+	CFlacTestBitReader(const uint8_t* const data, const size_t size) : m_data(data), m_size(size), m_bitPos(0ull), m_overrun(false) {};
+
+	// up to 32 bits, msb first
+	const uint32_t Read(const uint32_t bits)
+	{
+		uint64_t value = 0ull;
+
+		for (uint32_t i = 0; i < bits; ++i)
+		{
+			const size_t byte = m_bitPos >> 3;
+			if (byte >= m_size)
+			{
+				m_overrun = true;
+				return 0u;
+			}
+
+			value = (value << 1) | ((m_data[byte] >> (7 - (m_bitPos & 7))) & 1u);
+			++m_bitPos;
+		}
+
+		return static_cast<uint32_t>(value);
+	}
+
+	const int32_t ReadSigned(const uint32_t bits)
+	{
+		const uint32_t value = Read(bits);
+		if (bits == 0 || bits == 32)
+			return static_cast<int32_t>(value);
+
+		// sign extend
+		const uint32_t signBit = 1u << (bits - 1);
+		return static_cast<int32_t>((value ^ signBit) - signBit);
+	}
+
+	const uint32_t ReadUnary()
+	{
+		uint32_t zeroes = 0u;
+		while (!m_overrun && Read(1) == 0u)
+			++zeroes;
+
+		return zeroes;
+	}
+
+	void AlignToByte() { m_bitPos = (m_bitPos + 7) & ~7ull; };
+
+	inline const size_t BytePos() const { return m_bitPos >> 3; };
+	inline const bool Overrun() const { return m_overrun; };
+
+private:
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_bitPos;
+	bool m_overrun;
+};
+
+struct FlacTestStream_t
+{
+	uint32_t minBlockSize;
+	uint32_t maxBlockSize;
+	uint32_t minFrameSize;
+	uint32_t maxFrameSize;
+	uint32_t sampleRate;
+	uint32_t channels;
+	uint32_t bitsPerSample;
+	uint64_t sampleCount;
+
+	uint32_t frameCount;
+	std::vector<int32_t> samples; // interleaved
+};
+
+// bitwise, so nothing is shared with the encoder's tables
+static const uint32_t FlacTestCrc(const uint8_t* const data, const size_t size, const uint32_t poly, const uint32_t bits)
+{
+	const uint32_t topBit = 1u << (bits - 1);
+	const uint32_t mask = (bits == 32) ? UINT32_MAX : ((1u << bits) - 1);
+
+	uint32_t crc = 0u;
+	for (size_t i = 0; i < size; ++i)
+	{
+		crc ^= static_cast<uint32_t>(data[i]) << (bits - 8);
+
+		for (int bit = 0; bit < 8; ++bit)
+			crc = ((crc & topBit) ? (crc << 1) ^ poly : crc << 1) & mask;
+	}
+
+	return crc;
+}
+
+static const bool DecodeFlacTestResidual(CFlacTestBitReader& reader, const uint32_t blockSize, const uint32_t order, int32_t* const residual)
+{
+	const uint32_t method = reader.Read(2);
+	if (method > 1)
+		return false;
+
+	const uint32_t paramBits = method == 0 ? 4 : 5;
+	const uint32_t escapeParam = (1u << paramBits) - 1;
+
+	const uint32_t partitionOrder = reader.Read(4);
+	const uint32_t partitions = 1u << partitionOrder;
+
+	if ((blockSize % partitions) != 0 || (blockSize >> partitionOrder) < order)
+		return false;
+
+	uint32_t pos = 0u;
+	for (uint32_t partition = 0; partition < partitions; ++partition)
+	{
+		const uint32_t count = (blockSize >> partitionOrder) - (partition == 0 ? order : 0);
+		const uint32_t param = reader.Read(paramBits);
+
+		if (param == escapeParam)
+		{
+			const uint32_t rawBits = reader.Read(5);
+			for (uint32_t i = 0; i < count; ++i)
+				residual[pos++] = reader.ReadSigned(rawBits);
+
+			continue;
+		}
+
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const uint64_t folded = (static_cast<uint64_t>(reader.ReadUnary()) << param) | reader.Read(param);
+			if (folded > UINT32_MAX)
+				return false;
+
+			residual[pos++] = static_cast<int32_t>(folded >> 1) ^ -static_cast<int32_t>(folded & 1);
+		}
+	}
+
+	return !reader.Overrun();
+}
+
+static const bool DecodeFlacTestSubframe(CFlacTestBitReader& reader, const uint32_t blockSize, const uint32_t bitsPerSample, int64_t* const out)
+{
+	if (reader.Read(1) != 0u)
+		return false;
+
+	const uint32_t type = reader.Read(6);
+
+	uint32_t wastedBits = 0u;
+	if (reader.Read(1))
+		wastedBits = reader.ReadUnary() + 1;
+
+	if (wastedBits >= bitsPerSample)
+		return false;
+
+	const uint32_t bps = bitsPerSample - wastedBits;
+
+	std::vector<int32_t> residual(blockSize);
+
+	if (type == 0)
+	{
+		const int32_t value = reader.ReadSigned(bps);
+		for (uint32_t i = 0; i < blockSize; ++i)
+			out[i] = value;
+	}
+	else if (type == 1)
+	{
+		for (uint32_t i = 0; i < blockSize; ++i)
+			out[i] = reader.ReadSigned(bps);
+	}
+	else if (type >= 8 && type <= 12)
+	{
+		const uint32_t order = type - 8;
+		if (order > blockSize)
+			return false;
+
+		for (uint32_t i = 0; i < order; ++i)
+			out[i] = reader.ReadSigned(bps);
+
+		if (!DecodeFlacTestResidual(reader, blockSize, order, residual.data()))
+			return false;
+
+		static constexpr int64_t s_fixedCoefs[5][4] = { {}, { 1 }, { 2, -1 }, { 3, -3, 1 }, { 4, -6, 4, -1 } };
+
+		for (uint32_t i = order; i < blockSize; ++i)
+		{
+			int64_t prediction = 0;
+			for (uint32_t j = 0; j < order; ++j)
+				prediction += s_fixedCoefs[order][j] * out[i - 1 - j];
+
+			out[i] = prediction + residual[i - order];
+		}
+	}
+	else if (type >= 32)
+	{
+		const uint32_t order = (type & 31) + 1;
+		if (order > blockSize)
+			return false;
+
+		for (uint32_t i = 0; i < order; ++i)
+			out[i] = reader.ReadSigned(bps);
+
+		const uint32_t precision = reader.Read(4) + 1;
+		if (precision == 16)
+			return false;
+
+		const int32_t shift = reader.ReadSigned(5);
+		if (shift < 0)
+			return false;
+
+		int32_t coefs[32] = {};
+		for (uint32_t i = 0; i < order; ++i)
+			coefs[i] = reader.ReadSigned(precision);
+
+		if (!DecodeFlacTestResidual(reader, blockSize, order, residual.data()))
+			return false;
+
+		for (uint32_t i = order; i < blockSize; ++i)
+		{
+			int64_t prediction = 0;
+			for (uint32_t j = 0; j < order; ++j)
+				prediction += static_cast<int64_t>(coefs[j]) * out[i - 1 - j];
+
+			out[i] = (prediction >> shift) + residual[i - order];
+		}
+	}
+	else
+	{
+		return false; // reserved
+	}
+
+	for (uint32_t i = 0; i < blockSize; ++i)
+		out[i] = out[i] * (1ll << wastedBits);
+
+	return !reader.Overrun();
+}
+
+static const bool DecodeFlacTestFrame(const std::vector<uint8_t>& file, size_t& offset, FlacTestStream_t& stream)
+{
+	CFlacTestBitReader reader(file.data() + offset, file.size() - offset);
+
+	if (reader.Read(15) != 0x7FFC) // sync code and reserved bit
+		return false;
+
+	if (reader.Read(1) != 0) // variable block size
+		return false;
+
+	const uint32_t blockSizeCode = reader.Read(4);
+	const uint32_t sampleRateCode = reader.Read(4);
+	const uint32_t channelAssignment = reader.Read(4);
+	const uint32_t sampleSizeCode = reader.Read(3);
+
+	if (reader.Read(1) != 0)
+		return false;
+
+	// frame number, coded like utf-8
+	const uint32_t lead = reader.Read(8);
+	uint32_t codedBytes = 0u;
+	while (codedBytes < 7 && (lead & (0x80u >> codedBytes)))
+		++codedBytes;
+
+	if (codedBytes == 1 || codedBytes > 6)
+		return false;
+
+	uint64_t frameNumber = codedBytes ? lead & ((1u << (7 - codedBytes)) - 1) : lead;
+	for (uint32_t i = 1; i < codedBytes; ++i)
+	{
+		const uint32_t byte = reader.Read(8);
+		if ((byte & 0xC0) != 0x80)
+			return false;
+
+		frameNumber = (frameNumber << 6) | (byte & 0x3F);
+	}
+
+	if (frameNumber != stream.frameCount)
+		return false;
+
+	uint32_t blockSize = 0u;
+	if (blockSizeCode == 1)
+		blockSize = 192;
+	else if (blockSizeCode >= 2 && blockSizeCode <= 5)
+		blockSize = 576u << (blockSizeCode - 2);
+	else if (blockSizeCode == 6)
+		blockSize = reader.Read(8) + 1;
+	else if (blockSizeCode == 7)
+		blockSize = reader.Read(16) + 1;
+	else if (blockSizeCode >= 8)
+		blockSize = 256u << (blockSizeCode - 8);
+	else
+		return false;
+
+	static constexpr uint32_t s_sampleRates[12] = { 0, 88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000 };
+
+	uint32_t sampleRate = 0u;
+	if (sampleRateCode < 12)
+		sampleRate = sampleRateCode ? s_sampleRates[sampleRateCode] : stream.sampleRate;
+	else if (sampleRateCode == 12)
+		sampleRate = reader.Read(8) * 1000;
+	else if (sampleRateCode == 13)
+		sampleRate = reader.Read(16);
+	else if (sampleRateCode == 14)
+		sampleRate = reader.Read(16) * 10;
+	else
+		return false;
+
+	static constexpr uint32_t s_sampleSizes[8] = { 0, 8, 12, 0, 16, 20, 24, 32 };
+	const uint32_t bitsPerSample = sampleSizeCode ? s_sampleSizes[sampleSizeCode] : stream.bitsPerSample;
+
+	if (sampleRate != stream.sampleRate || bitsPerSample != stream.bitsPerSample || sampleSizeCode == 3)
+		return false;
+
+	const size_t headerSize = reader.BytePos();
+	if (reader.Read(8) != FlacTestCrc(file.data() + offset, headerSize, 0x07, 8))
+		return false;
+
+	const uint32_t channels = channelAssignment < 8 ? channelAssignment + 1 : 2;
+	if (channelAssignment > 10 || channels != stream.channels)
+		return false;
+
+	// every frame but the last is the stream block size
+	const uint64_t decodedSamples = stream.samples.size() / channels;
+	if (blockSize > stream.maxBlockSize || (decodedSamples + blockSize < stream.sampleCount && blockSize != stream.maxBlockSize))
+		return false;
+
+	std::vector<int64_t> decoded[8];
+	for (uint32_t channel = 0; channel < channels; ++channel)
+	{
+		// side channels are a bit wider
+		const bool side = (channelAssignment == 8 && channel == 1) || (channelAssignment == 9 && channel == 0) || (channelAssignment == 10 && channel == 1);
+
+		decoded[channel].resize(blockSize);
+		if (!DecodeFlacTestSubframe(reader, blockSize, bitsPerSample + (side ? 1 : 0), decoded[channel].data()))
+			return false;
+	}
+
+	for (uint32_t i = 0; i < blockSize; ++i)
+	{
+		int64_t left = decoded[0][i];
+		int64_t right = channels > 1 ? decoded[1][i] : 0;
+
+		switch (channelAssignment)
+		{
+		case 8:
+			right = left - right;
+			break;
+		case 9:
+			left = left + right;
+			break;
+		case 10:
+		{
+			const int64_t mid = (left * 2) | (right & 1);
+			left = (mid + right) >> 1;
+			right = (mid - right) >> 1;
+			break;
+		}
+		default:
+			break;
+		}
+
+		for (uint32_t channel = 0; channel < channels; ++channel)
+		{
+			const int64_t sample = channel == 0 ? left : (channel == 1 ? right : decoded[channel][i]);
+			stream.samples.push_back(static_cast<int32_t>(sample));
+		}
+	}
+
+	reader.AlignToByte();
+
+	const size_t frameSize = reader.BytePos() + 2;
+	if (reader.Read(16) != FlacTestCrc(file.data() + offset, frameSize - 2, 0x8005, 16) || reader.Overrun())
+		return false;
+
+	if (frameSize < stream.minFrameSize || frameSize > stream.maxFrameSize)
+		return false;
+
+	offset += frameSize;
+	++stream.frameCount;
+
+	return true;
+}
+
+static const bool DecodeFlacTestFile(const std::vector<uint8_t>& file, FlacTestStream_t& stream)
+{
+	stream = {};
+
+	CFlacTestBitReader reader(file.data(), file.size());
+	if (reader.Read(32) != 'fLaC')
+		return false;
+
+	// metadata blocks, only the stream info is read
+	bool lastBlock = false;
+	bool hasStreamInfo = false;
+	size_t offset = 4ull;
+
+	while (!lastBlock)
+	{
+		lastBlock = reader.Read(1) != 0u;
+		const uint32_t type = reader.Read(7);
+		const uint32_t size = reader.Read(24);
+
+		if (type == 0)
+		{
+			if (size != 34)
+				return false;
+
+			stream.minBlockSize = reader.Read(16);
+			stream.maxBlockSize = reader.Read(16);
+			stream.minFrameSize = reader.Read(24);
+			stream.maxFrameSize = reader.Read(24);
+			stream.sampleRate = reader.Read(20);
+			stream.channels = reader.Read(3) + 1;
+			stream.bitsPerSample = reader.Read(5) + 1;
+			stream.sampleCount = (static_cast<uint64_t>(reader.Read(4)) << 32) | reader.Read(32);
+
+			for (uint32_t i = 0; i < 4; ++i)
+				reader.Read(32); // md5
+
+			hasStreamInfo = true;
+		}
+		else
+		{
+			for (uint32_t i = 0; i < size; ++i)
+				reader.Read(8);
+		}
+
+		if (reader.Overrun())
+			return false;
+
+		offset = reader.BytePos();
+	}
+
+	if (!hasStreamInfo || stream.minBlockSize < 16 || stream.maxBlockSize < stream.minBlockSize)
+		return false;
+
+	stream.samples.reserve(stream.sampleCount * stream.channels);
+
+	while (offset < file.size())
+	{
+		if (!DecodeFlacTestFrame(file, offset, stream))
+			return false;
+	}
+
+	return stream.samples.size() == stream.sampleCount * stream.channels;
+}
+
+static const std::vector<uint8_t> ReadFlacTestFile(const std::filesystem::path& path)
+{
+	std::vector<uint8_t> file(std::filesystem::file_size(path));
+
+	StreamIO in(path, eStreamIOMode::Read);
+	in.R()->read(reinterpret_cast<char*>(file.data()), file.size());
+
+	return file;
+}
+
+enum class eFlacTestSignal
+{
+	SILENCE,
+	TONES,		// a few harmonics with an envelope and a little noise, close to decoded game audio
+	NOISE,
+	CLIPPED,	// square wave past full scale, clamped by the quantization
+	STEP,		// long constant runs with jumps between them
+};
+
+static const std::vector<float> MakeFlacTestSignal(std::mt19937_64& rng, const eFlacTestSignal signalType, const uint32_t channels, const uint64_t sampleCount, const uint32_t sampleRate)
+{
+	std::vector<float> samples(sampleCount * channels);
+	std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+	const float baseFreq = 110.0f + static_cast<float>(rng() % 330ull);
+
+	for (uint64_t i = 0; i < sampleCount; ++i)
+	{
+		const float t = static_cast<float>(i) / static_cast<float>(sampleRate);
+
+		for (uint32_t channel = 0; channel < channels; ++channel)
+		{
+			float value = 0.0f;
+
+			switch (signalType)
+			{
+			case eFlacTestSignal::SILENCE:
+				break;
+			case eFlacTestSignal::TONES:
+			{
+				const float phase = static_cast<float>(channel) * 0.3f;
+				const float envelope = 0.5f + 0.5f * sinf(t * 0.7f);
+
+				for (int harmonic = 1; harmonic <= 4; ++harmonic)
+					value += sinf(6.2831853f * baseFreq * static_cast<float>(harmonic) * t + phase) * (0.4f / static_cast<float>(harmonic));
+
+				value = value * envelope + noise(rng) * 0.002f;
+				break;
+			}
+			case eFlacTestSignal::NOISE:
+				value = noise(rng) * 0.9f;
+				break;
+			case eFlacTestSignal::CLIPPED:
+				value = ((i / 50) & 1) ? 1.5f : -1.5f;
+				break;
+			case eFlacTestSignal::STEP:
+				value = static_cast<float>((i / 1000) % 7) * 0.1f - 0.3f * static_cast<float>(channel);
+				break;
+			}
+
+			samples[i * channels + channel] = value;
+		}
+	}
+
+	return samples;
+}
+
+// the encoder's quantization, what a decoder should give back
+static const int32_t QuantizeFlacTestSample(const float sample, const uint32_t bitsPerSample)
+{
+	const float scale = static_cast<float>(1u << (bitsPerSample - 1));
+	const float sampleMax = static_cast<float>((1 << (bitsPerSample - 1)) - 1);
+	const float sampleMin = -scale;
+
+	return static_cast<int32_t>(lrintf(std::clamp(sample * scale, sampleMin, sampleMax)));
+}
+
+static const bool EncodeFlacTestFile(const std::filesystem::path& path, const std::vector<float>& samples, const uint16_t channels, const uint32_t sampleRate, const uint32_t bitsPerSample, const uint32_t level, const uint32_t threadCount)
+{
+	const CFlacEncoder encoder(channels, sampleRate, bitsPerSample, level);
+
+	StreamIO out;
+	if (!out.open(path.string(), eStreamIOMode::Write))
+		return false;
+
+	const bool success = encoder.Encode(out, samples.data(), samples.size() / channels, threadCount);
+	out.close();
+
+	return success;
+}
+
+static void SelfTest_FlacRoundTrip(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+	const std::filesystem::path path = ctx.TempDirectory() / "roundtrip.flac";
+
+	struct FlacTestCase_t
+	{
+		eFlacTestSignal signal;
+		uint16_t channels;
+		uint64_t sampleCount;
+		uint32_t sampleRate;
+	};
+
+	// sizes around the block size and the 8/16 bit block size codes, rates with and without a header code
+	static constexpr FlacTestCase_t s_cases[] =
+	{
+		{ eFlacTestSignal::TONES, 2, 0, 48000 },
+		{ eFlacTestSignal::TONES, 1, 1, 48000 },
+		{ eFlacTestSignal::TONES, 2, 15, 44100 },
+		{ eFlacTestSignal::NOISE, 2, 256, 48000 },
+		{ eFlacTestSignal::TONES, 2, 257, 48000 },
+		{ eFlacTestSignal::TONES, 2, CFlacEncoder::s_blockSize, 48000 },
+		{ eFlacTestSignal::TONES, 2, CFlacEncoder::s_blockSize + 1, 48000 },
+		{ eFlacTestSignal::TONES, 2, 200000, 48000 },
+		{ eFlacTestSignal::TONES, 1, 100000, 22050 },
+		{ eFlacTestSignal::TONES, 6, 50000, 48000 },
+		{ eFlacTestSignal::NOISE, 8, 20000, 37800 },
+		{ eFlacTestSignal::SILENCE, 2, 20000, 48000 },
+		{ eFlacTestSignal::CLIPPED, 2, 20000, 48000 },
+		{ eFlacTestSignal::STEP, 3, 20000, 48000 },
+	};
+
+	for (const FlacTestCase_t& testCase : s_cases)
+	{
+		const std::vector<float> samples = MakeFlacTestSignal(rng, testCase.signal, testCase.channels, testCase.sampleCount, testCase.sampleRate);
+
+		for (const uint32_t bitsPerSample : { 16u, 24u })
+		{
+			for (uint32_t level = 0; level <= CFlacEncoder::s_maxCompressionLevel; ++level)
+			{
+				const std::string desc = std::format("{} channels, {} samples, signal {}, {} bit, level {}", testCase.channels, testCase.sampleCount, static_cast<int>(testCase.signal), bitsPerSample, level);
+
+				if (!EncodeFlacTestFile(path, samples, testCase.channels, testCase.sampleRate, bitsPerSample, level, 4u))
+				{
+					ctx.Fail(std::format("encode failed, {}", desc));
+					continue;
+				}
+
+				FlacTestStream_t stream;
+				if (!DecodeFlacTestFile(ReadFlacTestFile(path), stream))
+				{
+					ctx.Fail(std::format("decode failed, {}", desc));
+					continue;
+				}
+
+				SELFTEST_CHECK(ctx, stream.channels == testCase.channels && stream.sampleRate == testCase.sampleRate && stream.bitsPerSample == bitsPerSample);
+
+				size_t mismatch = SIZE_MAX;
+				for (size_t i = 0; i < samples.size() && mismatch == SIZE_MAX; ++i)
+				{
+					if (stream.samples[i] != QuantizeFlacTestSample(samples[i], bitsPerSample))
+						mismatch = i;
+				}
+
+				if (mismatch != SIZE_MAX)
+					ctx.Fail(std::format("sample {} decoded as {}, expected {}, {}", mismatch, stream.samples[mismatch], QuantizeFlacTestSample(samples[mismatch], bitsPerSample), desc));
+			}
+		}
+	}
+
+	// the thread count only changes how frames are batched, never the output
+	const std::vector<float> samples = MakeFlacTestSignal(rng, eFlacTestSignal::TONES, 2, 300000, 48000);
+
+	std::vector<uint8_t> files[2];
+	for (uint32_t i = 0; i < 2; ++i)
+	{
+		SELFTEST_CHECK(ctx, EncodeFlacTestFile(path, samples, 2, 48000, 24, 5, i == 0 ? 1u : 7u));
+		files[i] = ReadFlacTestFile(path);
+	}
+
+	SELFTEST_CHECK(ctx, files[0] == files[1]);
+}
+
+REGISTER_SELFTEST("audio.flac", SelfTest_FlacRoundTrip);
+
+// the float wav the audio export writes by default against flac at a few levels, time and size
+// there is no decoded game audio here, the tone signal stands in for it and noise is the worst case
+static void Benchmark_FlacExport(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+	const std::filesystem::path& dir = ctx.TempDirectory();
+
+	constexpr uint16_t channels = 2;
+	constexpr uint32_t sampleRate = 48000;
+
+	const uint64_t sampleCount = static_cast<uint64_t>(sampleRate) * 60ull * ctx.Scale();
+	const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (const eFlacTestSignal signalType : { eFlacTestSignal::TONES, eFlacTestSignal::NOISE })
+	{
+		const char* const signalName = signalType == eFlacTestSignal::TONES ? "tones" : "noise";
+		const std::vector<float> samples = MakeFlacTestSignal(rng, signalType, channels, sampleCount, sampleRate);
+
+		// as ExportAudioSourceAsWav writes it
+		const std::filesystem::path wavPath = dir / "bench.wav";
+		const int64_t wavNs = SelfTestTimeBest(3u, [&]()
+			{
+				const uint64_t dataSize = samples.size() * sizeof(float);
+
+				WAVEHEADER hdr;
+				hdr.size = static_cast<long>(dataSize + 36);
+				hdr.fmt.channels = channels;
+				hdr.fmt.sampleRate = sampleRate;
+				hdr.fmt.blockAlign = static_cast<uint16_t>(channels * sizeof(float));
+				hdr.fmt.bitsPerSample = static_cast<uint16_t>(sizeof(float) * 8);
+				hdr.fmt.avgBytesPerSecond = hdr.fmt.blockAlign * sampleRate;
+				hdr.data.chunkSize = static_cast<long>(dataSize);
+
+				StreamIO out(wavPath, eStreamIOMode::Write);
+				out.write(hdr);
+				out.write(reinterpret_cast<const char*>(samples.data()), dataSize);
+				out.close();
+			});
+
+		const double wavBytes = static_cast<double>(std::filesystem::file_size(wavPath));
+
+		ctx.Metric(std::format("{} wav", signalName), static_cast<double>(wavNs) / 1e6, "ms");
+		ctx.Metric(std::format("{} wav size", signalName), wavBytes / (1024.0 * 1024.0), "MiB");
+
+		for (const uint32_t level : { 0u, 5u, 8u })
+		{
+			const std::filesystem::path flacPath = dir / "bench.flac";
+
+			const int64_t flacNs = SelfTestTimeBest(3u, [&]()
+				{
+					EncodeFlacTestFile(flacPath, samples, channels, sampleRate, 24, level, threadCount);
+				});
+
+			const double flacBytes = static_cast<double>(std::filesystem::file_size(flacPath));
+
+			ctx.Metric(std::format("{} flac level {}, {} threads", signalName, level, threadCount), static_cast<double>(flacNs) / 1e6, "ms");
+			ctx.Metric(std::format("{} flac level {} size", signalName, level), flacBytes / (1024.0 * 1024.0), "MiB");
+			ctx.Metric(std::format("{} flac level {} ratio", signalName, level), flacBytes / wavBytes, "");
+
+			// the timed output still has to decode
+			FlacTestStream_t stream;
+			SELFTEST_CHECK(ctx, DecodeFlacTestFile(ReadFlacTestFile(flacPath), stream) && stream.sampleCount == sampleCount);
+		}
+
+		// single threaded, to see what the parallel batches buy
+		const std::filesystem::path flacPath = dir / "bench.flac";
+		const int64_t singleNs = SelfTestTimeBest(1u, [&]()
+			{
+				EncodeFlacTestFile(flacPath, samples, channels, sampleRate, 24, 5, 1u);
+			});
+
+		ctx.Metric(std::format("{} flac level 5, 1 thread", signalName), static_cast<double>(singleNs) / 1e6, "ms");
+	}
+}
+
+REGISTER_BENCHMARK("audio.flac", Benchmark_FlacExport);
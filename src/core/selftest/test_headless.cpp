@@ -0,0 +1,135 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/headless.h>
+#include <core/filehandling/load.h>
+#include <core/utils/cli_parser.h>
+
+static void WriteHeadlessTestFile(const std::filesystem::path& path)
+{
+	std::filesystem::create_directories(path.parent_path());
+
+	StreamIO out;
+	if (out.open(path.string(), eStreamIOMode::Write))
+	{
+		out.write("\0", 1ull);
+		out.close();
+	}
+}
+
+static const size_t ExpandedCount(const std::filesystem::path& launchDirectory, const std::vector<std::string>& inputs)
+{
+	std::vector<std::string> filePaths;
+	ExpandInputPaths(launchDirectory, inputs, filePaths);
+
+	return filePaths.size();
+}
+
+// -in globs and directories over a tree of empty files, extensions in any case are matched and then loadable
+static void SelfTest_HeadlessInputs(CSelfTestContext& ctx)
+{
+	SELFTEST_CHECK(ctx, GlobMatch("*.rpak", "common.RPAK"));
+	SELFTEST_CHECK(ctx, GlobMatch("mp_?.rpak", "mp_a.rpak"));
+	SELFTEST_CHECK(ctx, !GlobMatch("mp_?.rpak", "mp_ab.rpak"));
+	SELFTEST_CHECK(ctx, GlobMatch("*_loadscreen*", "ui_loadscreen_01.rpak"));
+	SELFTEST_CHECK(ctx, !GlobMatch("*.mbnk", "general.mstr"));
+
+	const std::filesystem::path root = ctx.TempDirectory() / "headless";
+
+	WriteHeadlessTestFile(root / "paks" / "common.rpak");
+	WriteHeadlessTestFile(root / "paks" / "UI.RPAK");
+	WriteHeadlessTestFile(root / "paks" / "notes.txt");
+	WriteHeadlessTestFile(root / "paks" / "season" / "mp_rr_desertlands.Rpak");
+	WriteHeadlessTestFile(root / "audio" / "general.MBNK");
+	WriteHeadlessTestFile(root / "audio" / "general_english.mstr");
+	WriteHeadlessTestFile(root / "models" / "weapons" / "ptpov_r97.MDL");
+
+	SELFTEST_CHECK(ctx, ExpandedCount(root, { "paks/*.rpak" }) == 2ull);
+	SELFTEST_CHECK(ctx, ExpandedCount(root, { "paks" }) == 2ull);
+	SELFTEST_CHECK(ctx, ExpandedCount(root, { "paks/**/*.rpak" }) == 3ull);
+	SELFTEST_CHECK(ctx, ExpandedCount(root, { "audio" }) == 1ull);
+	SELFTEST_CHECK(ctx, ExpandedCount(root, { "models/**/*.mdl" }) == 1ull);
+	SELFTEST_CHECK(ctx, ExpandedCount(root, { "paks/notes.txt" }) == 1ull); // named files are taken as given
+	SELFTEST_CHECK(ctx, ExpandedCount(root, { "missing/*.rpak", "paks/missing.rpak" }) == 0ull);
+
+	// the same file from a glob, its directory and its path
+	SELFTEST_CHECK(ctx, ExpandedCount(root, { "paks/*.rpak", "paks", (root / "paks" / "UI.RPAK").string() }) == 2ull);
+
+	// whatever the globs and directories matched is loaded, not dropped for its extension's case
+	std::vector<std::string> filePaths;
+	ExpandInputPaths(root, { "paks/**/*.rpak", "audio", "models/**/*.mdl" }, filePaths);
+
+	SELFTEST_CHECK(ctx, filePaths.size() == 5ull);
+	SELFTEST_CHECK(ctx, std::ranges::all_of(filePaths, [](const std::string& path) { return IsLoadableFile(path); }));
+	SELFTEST_CHECK(ctx, !IsLoadableFile("general_english.mstr") && !IsLoadableFile("rpak") && !IsLoadableFile("paks/common.rpak.bak"));
+}
+
+REGISTER_SELFTEST("headless.inputs", SelfTest_HeadlessInputs);
+
+// -type, -guid and repeated params as HandleHeadlessRun reads them
+static void SelfTest_HeadlessArguments(CSelfTestContext& ctx)
+{
+	std::vector<std::string> types;
+	SplitList("txtr, matl ,mdl_,", types);
+
+	SELFTEST_CHECK(ctx, types.size() == 3ull && types[1] == "matl");
+	SELFTEST_CHECK(ctx, TypeFromString(types[0]) == MAKEFOURCC('t', 'x', 't', 'r') && TypeFromString(types[2]) == MAKEFOURCC('m', 'd', 'l', '_'));
+	SELFTEST_CHECK(ctx, TypeFromString("ui") == MAKEFOURCC('u', 'i', 0, 0));
+
+	{
+		std::unordered_set<uint64_t> guids;
+		SELFTEST_CHECK(ctx, ParseGuidList("0x10, 42,0xFFFFFFFFFFFFFFFF", guids));
+		SELFTEST_CHECK(ctx, guids.size() == 3ull && guids.contains(16ull) && guids.contains(42ull) && guids.contains(UINT64_MAX));
+	}
+
+	for (const char* const bad : { "0xZZ", "12abc", "0x10,,nope" })
+	{
+		std::unordered_set<uint64_t> guids;
+		SELFTEST_CHECK(ctx, !ParseGuidList(bad, guids));
+	}
+
+	// a guid list file, one per line
+	const std::filesystem::path listPath = ctx.TempDirectory() / "headless_guids.txt";
+	{
+		StreamIO out;
+		if (out.open(listPath.string(), eStreamIOMode::Write))
+		{
+			const std::string list = "0x1234\n\n0xABCD, 7\n";
+			out.write(list.data(), list.length());
+			out.close();
+		}
+	}
+
+	{
+		std::unordered_set<uint64_t> guids;
+		SELFTEST_CHECK(ctx, ParseGuidList(std::format("@{}, 0x99", listPath.string()), guids));
+		SELFTEST_CHECK(ctx, guids.size() == 4ull && guids.contains(0x1234ull) && guids.contains(0xABCDull) && guids.contains(7ull) && guids.contains(0x99ull));
+	}
+
+	{
+		std::unordered_set<uint64_t> guids;
+		SELFTEST_CHECK(ctx, !ParseGuidList(std::format("@{}", (ctx.TempDirectory() / "missing.txt").string()), guids));
+	}
+
+	char arg0[] = "rsx.exe";
+	char arg1[] = "-headless";
+	char arg2[] = "-in";
+	char arg3[] = "paks/*.rpak";
+	char arg4[] = "-in";
+	char arg5[] = "audio";
+	char arg6[] = "-list";
+	char arg7[] = "-threads";
+	char* argv[] = { arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7 };
+
+	const CCommandLine cli(static_cast<int>(ARRSIZE(argv)), argv);
+
+	SELFTEST_CHECK(ctx, cli.GetParamArguments("-in") == std::vector<std::string>({ "paks/*.rpak", "audio" }));
+	SELFTEST_CHECK(ctx, cli.HasParam("-list") == 6);
+	SELFTEST_CHECK(ctx, cli.GetParamArgument("-in") == arg3);
+
+	// a param at the end has no value, HandleHeadlessRun refuses it rather than reading past argv
+	SELFTEST_CHECK(ctx, cli.HasParam("-threads") != -1 && cli.GetParamArgument("-threads") == nullptr);
+	SELFTEST_CHECK(ctx, cli.GetParamArgument("-out") == nullptr);
+}
+
+REGISTER_SELFTEST("headless.args", SelfTest_HeadlessArguments);
@@ -0,0 +1,136 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/utils/interner.h>
+
+// the same index always gives the same name
+static std::string SyntheticAssetName(const uint32_t idx)
+{
+	static const char* const s_dirs[] = { "texture/", "material/", "models/weapons/", "models/humans/", "ui/", "sound/", "effects/" };
+	static const char* const s_exts[] = { ".rpak", ".rmdl", ".dds", ".msw", ".rui" };
+
+	const uint64_t bits = (idx + 1ull) * 0x9E3779B97F4A7C15ull;
+
+	return std::format("{}{:x}/asset_{}{}", s_dirs[bits % ARRSIZE(s_dirs)], (bits >> 16) % 4096u, idx, s_exts[(bits >> 32) % ARRSIZE(s_exts)]);
+}
+
+static void SelfTest_InternerDedupe(CSelfTestContext& ctx)
+{
+	CStringInterner interner;
+
+	const std::string_view a = interner.Intern("models/weapons/r97.rmdl", true);
+	const std::string_view b = interner.Intern("models\\weapons\\r97.rmdl");
+	const std::string_view c = interner.Intern("models/weapons/r99.rmdl", true);
+
+	SELFTEST_CHECK(ctx, a == "models\\weapons\\r97.rmdl");
+	SELFTEST_CHECK(ctx, a.data() == b.data());
+	SELFTEST_CHECK(ctx, a.data() != c.data());
+	SELFTEST_CHECK(ctx, a.data()[a.length()] == '\0');
+	SELFTEST_CHECK(ctx, interner.Count() == 2ull);
+
+	// a hit mustn't claim any block space
+	const size_t memory = interner.MemoryUsage();
+	for (int i = 0; i < 100000; ++i)
+		interner.Intern("models/weapons/r97.rmdl", true);
+
+	SELFTEST_CHECK(ctx, interner.MemoryUsage() == memory);
+	SELFTEST_CHECK(ctx, interner.Count() == 2ull);
+}
+
+static void SelfTest_InternerRelease(CSelfTestContext& ctx)
+{
+	CStringInterner interner;
+
+	const std::string_view shared = interner.Intern("shared_name");
+	interner.Intern("shared_name");
+
+	// still referenced once
+	interner.Release(shared);
+	SELFTEST_CHECK(ctx, interner.Count() == 1ull);
+	SELFTEST_CHECK(ctx, interner.FreeBytes() == 0ull);
+
+	interner.Release(shared);
+	SELFTEST_CHECK(ctx, interner.Count() == 0ull);
+	SELFTEST_CHECK(ctx, interner.FreeBytes() == shared.length() + 1);
+
+	// views that aren't from this interner are ignored, even with the same text
+	const std::string other = "other_name";
+	interner.Intern(other);
+	interner.Release(std::string_view(other));
+	SELFTEST_CHECK(ctx, interner.Count() == 1ull);
+
+	// renaming back and forth reuses the released space instead of growing
+	std::string_view name = interner.Intern("asset_name_0");
+	const size_t memory = interner.MemoryUsage();
+	for (int i = 1; i < 200000; ++i)
+	{
+		const std::string_view renamed = interner.Intern(std::format("asset_name_{}", i % 2));
+		interner.Release(name);
+		name = renamed;
+	}
+
+	SELFTEST_CHECK(ctx, interner.MemoryUsage() == memory);
+	SELFTEST_CHECK(ctx, interner.Count() == 2ull);
+
+	// a released string can be interned again and is found after tombstones
+	for (int i = 0; i < 5000; ++i)
+		interner.Release(interner.Intern(std::format("temp_{}", i)));
+
+	SELFTEST_CHECK(ctx, interner.Intern("asset_name_1") == "asset_name_1");
+	SELFTEST_CHECK(ctx, interner.Count() == 2ull);
+}
+
+REGISTER_SELFTEST("interner.dedupe", SelfTest_InternerDedupe);
+REGISTER_SELFTEST("interner.release", SelfTest_InternerRelease);
+
+// the load time and memory of naming every asset of a large set, against the std::string per asset it replaced
+static void Benchmark_InternerNames(CSelfTestContext& ctx)
+{
+	const uint32_t numNames = 500000u * ctx.Scale();
+
+	std::mt19937_64& rng = ctx.Rng();
+
+	std::vector<std::string> source;
+	source.reserve(numNames);
+	for (uint32_t i = 0; i < numNames; ++i)
+		source.emplace_back(SyntheticAssetName(static_cast<uint32_t>(rng() % (numNames / 4u)))); // every name about four times, like assets shared between paks
+
+	size_t internedMemory = 0ull;
+	const size_t rssBefore = CSelfTestContext::ProcessMemory();
+	size_t rssInterned = 0ull;
+
+	const int64_t internNs = SelfTestTimeBest(3u, [&]()
+		{
+			CStringInterner interner;
+			std::vector<std::string_view> names(numNames);
+
+			for (uint32_t i = 0; i < numNames; ++i)
+				names[i] = interner.Intern(source[i], true);
+
+			internedMemory = interner.MemoryUsage();
+			rssInterned = std::max(rssInterned, CSelfTestContext::ProcessMemory());
+		});
+
+	// the heap doesn't give pages back between runs, so the strings' memory is counted rather than read from the working set
+	size_t stringMemory = 0ull;
+	const int64_t stringNs = SelfTestTimeBest(3u, [&]()
+		{
+			std::vector<std::string> names(numNames);
+
+			for (uint32_t i = 0; i < numNames; ++i)
+				names[i] = std::filesystem::path(source[i]).make_preferred().string();
+
+			stringMemory = names.size() * sizeof(std::string);
+			for (const std::string& name : names)
+				stringMemory += name.capacity() > 15ull ? name.capacity() + 1ull : 0ull; // past the small string buffer
+		});
+
+	ctx.Metric("names", static_cast<double>(numNames), "");
+	ctx.Metric("intern time", static_cast<double>(internNs) / 1e6, "ms");
+	ctx.Metric("std::string time", static_cast<double>(stringNs) / 1e6, "ms");
+	ctx.Metric("interner memory", static_cast<double>(internedMemory) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("std::string memory", static_cast<double>(stringMemory) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("rss growth while interning", static_cast<double>(rssInterned > rssBefore ? rssInterned - rssBefore : 0ull) / (1024.0 * 1024.0), "MiB");
+}
+
+REGISTER_BENCHMARK("interner.names", Benchmark_InternerNames);
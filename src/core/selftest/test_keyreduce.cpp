@@ -0,0 +1,194 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/mdl/keyreduce.h>
+
+enum class eKeyTestTrack : uint8_t
+{
+	CONSTANT,	// jitter well inside the tolerance
+	LINEAR,		// a few straight segments
+	SMOOTH,
+	NOISE,		// a random walk, steps around the tolerance
+
+	COUNT,
+};
+
+static const float KeyTestTrackValue(const eKeyTestTrack kind, const float t, const float phase, const float scale, std::mt19937_64& rng, float& walk)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	switch (kind)
+	{
+	case eKeyTestTrack::CONSTANT:
+		return phase + (unit(rng) * scale * 0.25f);
+	case eKeyTestTrack::LINEAR:
+		return phase + (std::min(t, 40.0f) * scale * 3.0f) - (std::max(t - 90.0f, 0.0f) * scale * 5.0f);
+	case eKeyTestTrack::SMOOTH:
+		return phase + (sinf((t * 0.07f) + phase) * scale * 40.0f);
+	default:
+		walk += unit(rng) * scale * 2.0f;
+		return walk;
+	}
+}
+
+// every frame of the track against the frame rebuilt from its keys, distance for vectors
+static const double MaxVectorKeyError(const std::vector<Vector>& track, const std::vector<Vector>& resampled)
+{
+	double maxError = 0.0;
+	for (size_t i = 0; i < track.size(); i++)
+	{
+		const double x = static_cast<double>(track[i].x) - resampled[i].x;
+		const double y = static_cast<double>(track[i].y) - resampled[i].y;
+		const double z = static_cast<double>(track[i].z) - resampled[i].z;
+
+		maxError = std::max(maxError, sqrt((x * x) + (y * y) + (z * z)));
+	}
+
+	return maxError;
+}
+
+// the angle of b^-1 * a, worked out in doubles so it holds for the tiny angles acos can't resolve
+static const double QuaternionKeyTestAngle(const Quaternion& a, const Quaternion& b)
+{
+	const double w = (static_cast<double>(b.w) * a.w) + (static_cast<double>(b.x) * a.x) + (static_cast<double>(b.y) * a.y) + (static_cast<double>(b.z) * a.z);
+	const double x = (static_cast<double>(b.w) * a.x) - (static_cast<double>(a.w) * b.x) - ((static_cast<double>(b.y) * a.z) - (static_cast<double>(b.z) * a.y));
+	const double y = (static_cast<double>(b.w) * a.y) - (static_cast<double>(a.w) * b.y) - ((static_cast<double>(b.z) * a.x) - (static_cast<double>(b.x) * a.z));
+	const double z = (static_cast<double>(b.w) * a.z) - (static_cast<double>(a.w) * b.z) - ((static_cast<double>(b.x) * a.y) - (static_cast<double>(b.y) * a.x));
+
+	return 2.0 * atan2(sqrt((x * x) + (y * y) + (z * z)), fabs(w));
+}
+
+static const double MaxQuaternionKeyError(const std::vector<Quaternion>& track, const std::vector<Quaternion>& resampled)
+{
+	double maxError = 0.0;
+	for (size_t i = 0; i < track.size(); i++)
+		maxError = std::max(maxError, QuaternionKeyTestAngle(track[i], resampled[i]));
+
+	return maxError;
+}
+
+static const bool KeysWellFormed(const std::vector<uint32_t>& keys, const size_t numFrames)
+{
+	if (keys.empty() || keys.front() != 0u)
+		return false;
+
+	for (size_t i = 1; i < keys.size(); i++)
+	{
+		if (keys[i] <= keys[i - 1])
+			return false;
+	}
+
+	return keys.size() == 1 || keys.back() == numFrames - 1;
+}
+
+// reduced tracks rebuilt from their keys stay within the tolerance at every source frame
+// tolerances are compared with a little slack for the float interpolation, the check itself is done in doubles
+static void SelfTest_KeyReduceMaxError(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<uint32_t> keys;
+	std::vector<Vector> track;
+	std::vector<Vector> resampledVec;
+	std::vector<Quaternion> rotTrack;
+	std::vector<Quaternion> resampledRot;
+
+	uint32_t badKeys = 0u;
+	uint32_t overTolerance = 0u;
+	uint32_t constantKept = 0u;
+	double worstVec = 0.0;
+	double worstRot = 0.0;
+
+	for (uint32_t i = 0u; i < 4000u; i++)
+	{
+		// single frame and two frame tracks included
+		const size_t numFrames = (i % 64u) < 4u ? (i % 64u) + 1ull : 3ull + (rng() % 300ull);
+		const eKeyTestTrack kind = static_cast<eKeyTestTrack>(i % static_cast<uint32_t>(eKeyTestTrack::COUNT));
+
+		const float posTolerance = 0.001f + static_cast<float>(rng() % 1000ull) * 0.0001f;
+		const float rotTolerance = 0.0005f + static_cast<float>(rng() % 1000ull) * 0.00005f;
+
+		// positions
+		{
+			float walk[3] = { 0.0f, 0.0f, 0.0f };
+			const float phase[3] = { unit(rng) * 10.0f, unit(rng) * 10.0f, unit(rng) * 10.0f };
+			const float scale = posTolerance * (kind == eKeyTestTrack::CONSTANT ? 1.0f : 0.5f + static_cast<float>(rng() % 8ull));
+
+			track.resize(numFrames);
+			for (size_t frame = 0; frame < numFrames; frame++)
+			{
+				const float t = static_cast<float>(frame);
+				track[frame] = Vector(KeyTestTrackValue(kind, t, phase[0], scale, rng, walk[0]), KeyTestTrackValue(kind, t, phase[1], scale, rng, walk[1]), KeyTestTrackValue(kind, t, phase[2], scale, rng, walk[2]));
+			}
+
+			ReduceVectorKeys(track.data(), numFrames, posTolerance, keys);
+			badKeys += !KeysWellFormed(keys, numFrames);
+
+			resampledVec.resize(numFrames);
+			ResampleVectorKeys(track.data(), keys, numFrames, resampledVec.data());
+
+			// each cast channel is keyed on the same frames, linear per channel is the same as linear on the vector
+			const double error = MaxVectorKeyError(track, resampledVec);
+			worstVec = std::max(worstVec, error / posTolerance);
+
+			if (error > (posTolerance * 1.001) + 1e-5 && overTolerance++ == 0u)
+				ctx.Fail(std::format("position track {} ({} frames, {} keys) is off by {} with a tolerance of {}", i, numFrames, keys.size(), error, posTolerance));
+
+			constantKept += kind == eKeyTestTrack::CONSTANT && keys.size() != 1;
+		}
+
+		// rotations, with the sign of some frames flipped since q and -q are the same rotation
+		{
+			float walk[3] = { 0.0f, 0.0f, 0.0f };
+			const float phase[3] = { unit(rng), unit(rng), unit(rng) };
+			const float scale = rotTolerance * (kind == eKeyTestTrack::CONSTANT ? 1.0f : 0.5f + static_cast<float>(rng() % 8ull));
+
+			rotTrack.resize(numFrames);
+			for (size_t frame = 0; frame < numFrames; frame++)
+			{
+				const float t = static_cast<float>(frame);
+				const RadianEuler rot(KeyTestTrackValue(kind, t, phase[0], scale * 0.5f, rng, walk[0]), KeyTestTrackValue(kind, t, phase[1], scale * 0.5f, rng, walk[1]), KeyTestTrackValue(kind, t, phase[2], scale * 0.5f, rng, walk[2]));
+
+				Quaternion q(rot);
+				if ((rng() % 16ull) == 0ull)
+					q = Quaternion(-q.x, -q.y, -q.z, -q.w);
+
+				rotTrack[frame] = q;
+			}
+
+			ReduceQuaternionKeys(rotTrack.data(), numFrames, rotTolerance, keys);
+			badKeys += !KeysWellFormed(keys, numFrames);
+
+			resampledRot.resize(numFrames);
+			ResampleQuaternionKeys(rotTrack.data(), keys, numFrames, resampledRot.data());
+
+			const double error = MaxQuaternionKeyError(rotTrack, resampledRot);
+			worstRot = std::max(worstRot, error / rotTolerance);
+
+			if (error > (rotTolerance * 1.001) + 1e-5 && overTolerance++ == 0u)
+				ctx.Fail(std::format("rotation track {} ({} frames, {} keys) is off by {} radians with a tolerance of {}", i, numFrames, keys.size(), error, rotTolerance));
+		}
+	}
+
+	SELFTEST_CHECK(ctx, badKeys == 0u);
+	SELFTEST_CHECK(ctx, overTolerance == 0u);
+	SELFTEST_CHECK(ctx, constantKept == 0u);
+
+	ctx.Note(std::format("worst error {:.3f} of the position tolerance, {:.3f} of the rotation tolerance", worstVec, worstRot));
+
+	// straight lines reduce to their ends, and a track is never reduced past its tolerance to the fallback value
+	track.clear();
+	for (int frame = 0; frame < 100; frame++)
+		track.emplace_back(static_cast<float>(frame) * 0.5f, 1.0f, -static_cast<float>(frame));
+
+	ReduceVectorKeys(track.data(), track.size(), 0.001f, keys);
+	SELFTEST_CHECK(ctx, keys.size() == 2ull && keys[1] == 99u);
+
+	SELFTEST_CHECK(ctx, VectorWithinTolerance(Vector(1.0f, 0.0f, 0.0f), Vector(1.0f, 0.0f, 0.0005f), 0.001f));
+	SELFTEST_CHECK(ctx, !VectorWithinTolerance(Vector(1.0f, 0.0f, 0.0f), Vector(1.0f, 0.0008f, 0.0008f), 0.001f));
+	SELFTEST_CHECK(ctx, QuaternionWithinTolerance(Quaternion(0.0f, 0.0f, 0.0f, 1.0f), Quaternion(0.0f, 0.0f, 0.0f, -1.0f), 0.0001f));
+	SELFTEST_CHECK(ctx, !QuaternionWithinTolerance(Quaternion(RadianEuler(0.0f, 0.0f, 0.0f)), Quaternion(RadianEuler(0.0f, 0.0f, 0.002f)), 0.001f));
+}
+
+REGISTER_SELFTEST("model.keyreduce", SelfTest_KeyReduceMaxError);
@@ -0,0 +1,226 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <game/rtech/assets/localisation.h>
+
+// appends a code point as utf-8
+static void AppendLocalisationTestUtf8(std::string& out, const uint32_t cp)
+{
+	if (cp < 0x80u)
+	{
+		out.push_back(static_cast<char>(cp));
+	}
+	else if (cp < 0x800u)
+	{
+		out.push_back(static_cast<char>(0xC0u | (cp >> 6)));
+		out.push_back(static_cast<char>(0x80u | (cp & 0x3Fu)));
+	}
+	else if (cp < 0x10000u)
+	{
+		out.push_back(static_cast<char>(0xE0u | (cp >> 12)));
+		out.push_back(static_cast<char>(0x80u | ((cp >> 6) & 0x3Fu)));
+		out.push_back(static_cast<char>(0x80u | (cp & 0x3Fu)));
+	}
+	else
+	{
+		out.push_back(static_cast<char>(0xF0u | (cp >> 18)));
+		out.push_back(static_cast<char>(0x80u | ((cp >> 12) & 0x3Fu)));
+		out.push_back(static_cast<char>(0x80u | ((cp >> 6) & 0x3Fu)));
+		out.push_back(static_cast<char>(0x80u | (cp & 0x3Fu)));
+	}
+}
+
+// valid utf-8 like WideCharToMultiByte gives the exporters, mostly clean runs of text with the odd character that needs escaping
+// no '\r', the reference escaper also writes a quote after it
+static const std::string RandomLocalisationString(std::mt19937_64& rng, const size_t length, const uint32_t specialOneIn)
+{
+	std::string str;
+	str.reserve(length + 4);
+
+	while (str.length() < length)
+	{
+		if ((rng() % specialOneIn) != 0ull)
+		{
+			str.push_back(static_cast<char>(0x20u + (rng() % 0x5Full))); // printable ascii, backslash included
+			continue;
+		}
+
+		switch (rng() % 6ull)
+		{
+		case 0:
+			str.push_back('\"');
+			break;
+		case 1:
+		{
+			static constexpr char s_escaped[] = { '\t', '\n', '\0', 0x7F };
+			str.push_back(s_escaped[rng() % sizeof(s_escaped)]);
+			break;
+		}
+		case 2:
+		{
+			// hex escaped control characters
+			const char c = static_cast<char>(1u + (rng() % 0x1Full));
+			if (c != '\r')
+				str.push_back(c);
+
+			break;
+		}
+		case 3:
+			AppendLocalisationTestUtf8(str, 0x80u + static_cast<uint32_t>(rng() % (0x800ull - 0x80ull)));
+			break;
+		case 4:
+		{
+			const uint32_t cp = 0x800u + static_cast<uint32_t>(rng() % (0x10000ull - 0x800ull));
+			AppendLocalisationTestUtf8(str, (cp >= 0xD800u && cp <= 0xDFFFu) ? 0x3042u : cp); // no surrogates
+			break;
+		}
+		default:
+			AppendLocalisationTestUtf8(str, 0x10000u + static_cast<uint32_t>(rng() % (0x110000ull - 0x10000ull)));
+			break;
+		}
+	}
+
+	return str;
+}
+
+static const std::string EscapeLocalisationTest(const std::string& str, const bool csv)
+{
+	std::string out;
+	EscapeLocalisationString(out, str.data(), str.length(), csv);
+
+	return out;
+}
+
+// the vector escaper against the stringstream one it replaced
+static void SelfTest_LocalisationEscape(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	uint32_t mismatches = 0u;
+	for (uint32_t i = 0u; i < 20000u; ++i)
+	{
+		// short strings stay in the scalar tail, long ones go through the 16 byte scan, dense ones escape inside most blocks
+		const size_t length = (i & 1u) ? rng() % 24ull : rng() % 512ull;
+		const std::string str = RandomLocalisationString(rng, length, (i & 2u) ? 4u : 64u);
+
+		const std::string escaped = EscapeLocalisationTest(str, false);
+		const std::string reference = EscapeLocalisationStringReference(str);
+
+		if (escaped != reference && mismatches++ == 0u)
+			ctx.Fail(std::format("string {} of {} bytes escaped as \"{}\", the reference gives \"{}\"", i, str.length(), escaped, reference));
+	}
+
+	SELFTEST_CHECK(ctx, mismatches == 0u);
+
+	// the reference writes \r\" for a carriage return, the quote was never in the string
+	SELFTEST_CHECK(ctx, EscapeLocalisationTest("a\rb", false) == "a\\rb");
+	SELFTEST_CHECK(ctx, EscapeLocalisationStringReference("a\rb") == "a\\r\\\"b");
+
+	// hex escapes aren't zero padded
+	SELFTEST_CHECK(ctx, EscapeLocalisationTest(std::string("a\x01" "b\x1F" "c\x7F", 6), false) == "a\\x1b\\x1fc\\x7f");
+
+	// nulls are dropped, also inside a block the vector scan handles
+	SELFTEST_CHECK(ctx, EscapeLocalisationTest(std::string("0123456789\0abcdefghijk", 22), false) == "0123456789abcdefghijk");
+}
+
+// quoted csv fields double their quotes, nothing else changes from the locl escaping
+static void SelfTest_LocalisationEscapeCsv(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	SELFTEST_CHECK(ctx, EscapeLocalisationTest("say \"hi\"\n", true) == "say \"\"hi\"\"\\n");
+
+	uint32_t mismatches = 0u;
+	for (uint32_t i = 0u; i < 5000u; ++i)
+	{
+		// no backslashes, one before a quote would read back the same as an escaped quote
+		std::string str = RandomLocalisationString(rng, rng() % 256ull, 8u);
+		std::ranges::replace(str, '\\', '/');
+
+		const std::string csv = EscapeLocalisationTest(str, true);
+
+		// every quote in the field is one of a pair, so a csv reader never sees the field end early
+		bool paired = true;
+		for (size_t pos = 0; pos < csv.length(); ++pos)
+		{
+			if (csv[pos] != '\"')
+				continue;
+
+			paired &= pos + 1 < csv.length() && csv[pos + 1] == '\"';
+			++pos;
+		}
+
+		// reading the field back gives the locl escaping with \" as a plain quote
+		std::string unquoted;
+		for (size_t pos = 0; pos < csv.length(); ++pos)
+		{
+			unquoted.push_back(csv[pos]);
+			pos += csv[pos] == '\"';
+		}
+
+		std::string expected = EscapeLocalisationTest(str, false);
+		for (size_t pos = expected.find("\\\""); pos != std::string::npos; pos = expected.find("\\\"", pos + 1))
+			expected.erase(pos, 1);
+
+		const bool matchesLocl = unquoted == expected;
+
+		if ((!paired || !matchesLocl) && mismatches++ == 0u)
+			ctx.Fail(std::format("string {} escaped for csv as \"{}\"", i, csv));
+	}
+
+	SELFTEST_CHECK(ctx, mismatches == 0u);
+}
+
+REGISTER_SELFTEST("localisation.escape", SelfTest_LocalisationEscape);
+REGISTER_SELFTEST("localisation.escapecsv", SelfTest_LocalisationEscapeCsv);
+
+// escape throughput of the stringstream escaper against the vector one, over locl-like text
+static void Benchmark_LocalisationEscape(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	std::vector<std::string> strings;
+	size_t totalBytes = 0ull;
+
+	while (totalBytes < (32ull << 20) * ctx.Scale())
+	{
+		// most strings are short ui labels, some are long descriptions
+		const size_t length = (rng() % 8ull) == 0ull ? 200ull + (rng() % 800ull) : 8ull + (rng() % 56ull);
+
+		strings.emplace_back(RandomLocalisationString(rng, length, 48u));
+		totalBytes += strings.back().length();
+	}
+
+	const auto throughput = [totalBytes](const int64_t ns)
+		{
+			return (static_cast<double>(totalBytes) / (1024.0 * 1024.0)) / (static_cast<double>(ns) / 1e9);
+		};
+
+	size_t referenceBytes = 0ull;
+	const int64_t referenceNs = SelfTestTimeBest(3u, [&]()
+		{
+			referenceBytes = 0ull;
+			for (const std::string& str : strings)
+				referenceBytes += EscapeLocalisationStringReference(str).length();
+		});
+
+	// one reused buffer, as the exporters do
+	std::string out;
+	out.reserve(totalBytes * 2);
+
+	const int64_t escapeNs = SelfTestTimeBest(3u, [&]()
+		{
+			out.clear();
+			for (const std::string& str : strings)
+				EscapeLocalisationString(out, str.data(), str.length());
+		});
+
+	SELFTEST_CHECK(ctx, out.length() == referenceBytes);
+
+	ctx.Metric("strings", static_cast<double>(strings.size()), "");
+	ctx.Metric("input", static_cast<double>(totalBytes) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("reference", throughput(referenceNs), "MiB/s");
+	ctx.Metric("escape", throughput(escapeNs), "MiB/s");
+}
+
+REGISTER_BENCHMARK("localisation.escape", Benchmark_LocalisationEscape);
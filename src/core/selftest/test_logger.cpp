@@ -0,0 +1,192 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+// logger settings for the length of a benchmark, a log file that is already open is written to and left open
+class CLoggerSettingsScope
+{
+public:
+	CLoggerSettingsScope() : m_level(g_logger.GetLevel()), m_categoryMask(g_logger.GetCategoryMask()), m_console(g_logger.GetConsoleOutput()), m_ownsFile(g_logger.GetFile().empty()) {};
+
+	~CLoggerSettingsScope()
+	{
+		g_logger.Flush();
+
+		g_logger.SetLevel(m_level);
+		g_logger.SetCategoryMask(m_categoryMask);
+		g_logger.SetConsoleOutput(m_console);
+
+		if (m_ownsFile)
+			g_logger.SetFile("");
+	}
+
+	CLoggerSettingsScope(const CLoggerSettingsScope&) = delete;
+	CLoggerSettingsScope& operator=(const CLoggerSettingsScope&) = delete;
+
+	inline const bool OwnsFile() const { return m_ownsFile; };
+
+private:
+	const eLogLevel m_level;
+	const uint32_t m_categoryMask;
+	const bool m_console;
+	const bool m_ownsFile;
+};
+
+// stands in for the work an export does on an asset, a hash over a buffer that stays in cache
+static const uint64_t LogBenchWork(const std::vector<uint64_t>& buffer, const uint32_t passes, uint64_t seed)
+{
+	for (uint32_t pass = 0; pass < passes; pass++)
+	{
+		for (const uint64_t value : buffer)
+			seed = (seed ^ value) * 0x100000001B3ull;
+	}
+
+	return seed;
+}
+
+struct LogBenchAsset_t
+{
+	std::string name;
+	uint64_t guid;
+};
+
+// every asset on the export threads, logging about what an export of a model does per asset
+static const int64_t RunLogBenchExport(const std::vector<LogBenchAsset_t>& assets, const std::vector<uint64_t>& buffer, const uint32_t passes, const uint32_t threadCount, std::atomic<uint64_t>& sink)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	CParallelTask task(threadCount);
+
+	std::atomic<uint32_t> assetIdx = 0u;
+	const uint32_t numAssets = static_cast<uint32_t>(assets.size());
+
+	task.addTask([&assets, &buffer, &sink, &assetIdx, passes, numAssets]
+		{
+			while (assetIdx < numAssets)
+			{
+				const uint32_t idx = assetIdx++;
+				if (idx >= numAssets)
+					continue;
+
+				const LogBenchAsset_t& asset = assets[idx];
+
+				LOG_DEBUG(EXPORT, "exporting %s (0x%llX)\n", asset.name.c_str(), asset.guid);
+
+				const uint64_t hash = LogBenchWork(buffer, passes, asset.guid);
+
+				LOG_DEBUG(MODEL, "%s: %u bones, %u lods, scale %f\n", asset.name.c_str(), static_cast<uint32_t>(hash & 0xff), static_cast<uint32_t>((hash >> 8) & 3), static_cast<float>(hash & 0xffff) / 65535.0f);
+				LOG_INFO(EXPORT, "exported %s, %llu bytes\n", asset.name.c_str(), hash & 0xfffff);
+
+				sink += hash;
+			}
+		}, threadCount);
+
+	task.execute();
+	task.wait();
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// export throughput with every message filtered out against every message written to a file, at two amounts of work per asset
+static void Benchmark_Logger(CSelfTestContext& ctx)
+{
+	CLoggerSettingsScope settings;
+
+	g_logger.SetConsoleOutput(false);
+	g_logger.SetCategoryMask(0xffffffff);
+
+	const std::filesystem::path logPath = ctx.TempDirectory() / "benchmark.log";
+	const bool logToTemp = settings.OwnsFile() && g_logger.SetFile(logPath.string());
+
+	if (settings.OwnsFile() && !logToTemp)
+		ctx.Note("couldn't open the log file, the sink only formats");
+
+	const uint32_t threadCount = std::max(UtilsConfig->exportThreadCount, 2u);
+	const size_t numAssets = 2000ull * ctx.Scale();
+
+	std::vector<LogBenchAsset_t> assets(numAssets);
+	for (size_t i = 0; i < numAssets; i++)
+		assets[i] = { std::format("mdl/weapons/bench_{}/w_bench_{}.rmdl", i % 97ull, i), ctx.Rng()() };
+
+	std::vector<uint64_t> buffer(2048);
+	for (uint64_t& value : buffer)
+		value = ctx.Rng()();
+
+	std::atomic<uint64_t> sink = 0ull;
+
+	// passes for about 50us of work
+	const int64_t passNs = std::max(SelfTestTimeBest(5u, [&]() { sink += LogBenchWork(buffer, 16u, sink); }) / 16, int64_t{ 1 });
+	const uint32_t basePasses = static_cast<uint32_t>(std::max(50000 / passNs, int64_t{ 1 }));
+
+	ctx.Metric("export threads", static_cast<double>(threadCount), "");
+	ctx.Metric("assets", static_cast<double>(numAssets), "");
+
+	const uint64_t droppedBefore = g_logger.NumDropped();
+
+	for (const uint32_t workScale : { 20u, 5u })
+	{
+		const uint32_t passes = basePasses * workScale;
+
+		int64_t disabledNs = INT64_MAX;
+		int64_t enabledNs = INT64_MAX;
+
+		// interleaved so both see the same machine
+		for (uint32_t run = 0; run < 3u; run++)
+		{
+			g_logger.SetLevel(eLogLevel::ERR);
+			disabledNs = std::min(disabledNs, RunLogBenchExport(assets, buffer, passes, threadCount, sink));
+
+			g_logger.SetLevel(eLogLevel::DBG);
+			enabledNs = std::min(enabledNs, RunLogBenchExport(assets, buffer, passes, threadCount, sink));
+
+			g_logger.Flush();
+		}
+
+		const double workUs = static_cast<double>(passNs) * passes / 1e3;
+		const double overhead = ((static_cast<double>(enabledNs) / static_cast<double>(disabledNs)) - 1.0) * 100.0;
+
+		ctx.Metric(std::format("~{:.0f}us per asset, logging off", workUs), static_cast<double>(numAssets) / (static_cast<double>(disabledNs) / 1e9), "assets/s");
+		ctx.Metric(std::format("~{:.0f}us per asset, 3 messages per asset", workUs), static_cast<double>(numAssets) / (static_cast<double>(enabledNs) / 1e9), "assets/s");
+		ctx.Metric(std::format("~{:.0f}us per asset, logging overhead", workUs), overhead, "%");
+	}
+
+	// what a message costs the thread writing it, the sink is flushed between batches so the ring never fills
+	constexpr uint32_t batchSize = 1000u;
+
+	g_logger.SetLevel(eLogLevel::DBG);
+
+	int64_t writeNs = INT64_MAX;
+	for (uint32_t batch = 0; batch < 20u; batch++)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < batchSize; i++)
+			LOG_DEBUG(EXPORT, "exporting %s (0x%llX)\n", assets[i % numAssets].name.c_str(), assets[i % numAssets].guid);
+
+		writeNs = std::min(writeNs, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+
+		g_logger.Flush();
+	}
+
+	ctx.Metric("write, per message", static_cast<double>(writeNs) / batchSize, "ns");
+	ctx.Metric("dropped", static_cast<double>(g_logger.NumDropped() - droppedBefore), "messages");
+
+	// everything that wasn't dropped reached the file
+	if (logToTemp)
+	{
+		g_logger.Flush();
+
+		std::ifstream log(logPath);
+
+		size_t numLines = 0ull;
+		std::string line;
+		while (std::getline(log, line))
+			numLines++;
+
+		const size_t written = (numAssets * 3ull * 3ull * 2ull) + (batchSize * 20ull);
+		SELFTEST_CHECK(ctx, numLines + (g_logger.NumDropped() - droppedBefore) >= written);
+	}
+
+	ctx.Note(std::format("checksum {:x}", sink.load()));
+}
+
+REGISTER_BENCHMARK("log.throughput", Benchmark_Logger);
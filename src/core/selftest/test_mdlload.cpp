@@ -0,0 +1,363 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/filehandling/load.h>
+
+#include <game/rtech/assets/model.h>
+#include <game/model/sourcemodel.h>
+
+// the same index always gives the same model, with numSequences sequences and padded out to about fileSize bytes
+static const std::vector<char> SyntheticSourceModel(const uint32_t idx, const int numSequences, const size_t fileSize)
+{
+	const std::string name = std::format("synthetic/dir_{}/model_{}.mdl", idx % 32u, idx);
+
+	std::vector<std::string> labels;
+	for (int i = 0; i < numSequences; ++i)
+		labels.emplace_back(std::format("seq_{}_{}", idx, i));
+
+	const size_t seqOffset = sizeof(r2::studiohdr_t);
+	std::vector<char> file(seqOffset + sizeof(r2::mstudioseqdesc_t) * numSequences, 0);
+
+	const auto addString = [&file](const std::string& str)
+		{
+			const size_t offset = file.size();
+			file.insert(file.end(), str.begin(), str.end());
+			file.emplace_back('\0');
+
+			return offset;
+		};
+
+	const size_t nameOffset = addString(name);
+
+	for (int i = 0; i < numSequences; ++i)
+	{
+		const size_t descOffset = seqOffset + sizeof(r2::mstudioseqdesc_t) * i;
+		const size_t labelOffset = addString(labels[i]);
+
+		// taken after the insert, which may have moved the buffer
+		reinterpret_cast<r2::mstudioseqdesc_t*>(file.data() + descOffset)->szlabelindex = static_cast<int>(labelOffset - descOffset);
+	}
+
+	// stands in for the bone, mesh and animation data the build doesn't read
+	if (file.size() < fileSize)
+		file.resize(fileSize, 0);
+
+	r2::studiohdr_t* const hdr = reinterpret_cast<r2::studiohdr_t*>(file.data());
+	hdr->id = MODEL_FILE_ID;
+	hdr->version = 53;
+	hdr->sznameindex = static_cast<int>(nameOffset);
+	hdr->length = static_cast<int>(file.size());
+	hdr->numlocalseq = numSequences;
+	hdr->localseqindex = static_cast<int>(seqOffset);
+
+	return file;
+}
+
+static const std::string WriteSourceModel(const std::filesystem::path& dir, const uint32_t idx, const std::vector<char>& file)
+{
+	const std::string path = (dir / std::format("model_{}.mdl", idx)).string();
+
+	StreamIO out;
+	if (out.open(path, eStreamIOMode::Write))
+	{
+		out.write(file.data(), file.size());
+		out.close();
+	}
+
+	return path;
+}
+
+static void DeleteSourceModelAssets(CSourceModelAsset* const model, std::vector<CSourceSequenceAsset*>& sequences)
+{
+	// the container holds the sequence names, it goes last
+	CAssetContainer* const container = model->GetContainerFile<CAssetContainer>();
+
+	for (CSourceSequenceAsset* const sequence : sequences)
+		delete sequence;
+
+	sequences.clear();
+
+	delete model;
+	delete container;
+}
+
+static void SelfTest_SourceModelBuild(CSelfTestContext& ctx)
+{
+	const std::string path = WriteSourceModel(ctx.TempDirectory(), 7u, SyntheticSourceModel(7u, 5, 4096ull));
+
+	std::vector<CSourceSequenceAsset*> sequences;
+	CSourceModelAsset* const model = CreateSourceModelAssets(path, sequences);
+
+	SELFTEST_CHECK(ctx, model != nullptr);
+	if (!model)
+		return;
+
+	SELFTEST_CHECK(ctx, model->GetAssetGUID() == RTech::StringToGuid("synthetic/dir_7/model_7.mdl"));
+	SELFTEST_CHECK(ctx, sequences.size() == 5ull);
+
+	// the same paths the old per sequence std::format built
+	for (size_t i = 0; i < sequences.size(); ++i)
+	{
+		const std::string expected = std::format("{}/synthetic/dir_7/model_7/seq_7_{}.seq", s_AssetTypePaths.find(AssetType_t::SEQ)->second, i);
+
+		SELFTEST_CHECK(ctx, sequences[i]->GetAssetName() == std::filesystem::path(expected).make_preferred().string());
+		SELFTEST_CHECK(ctx, sequences[i]->GetAssetGUID() == RTech::StringToGuid(expected.c_str()));
+		SELFTEST_CHECK(ctx, sequences[i]->GetRigGUID() == model->GetAssetGUID());
+	}
+
+	DeleteSourceModelAssets(model, sequences);
+}
+
+REGISTER_SELFTEST("model.mdlbuild", SelfTest_SourceModelBuild);
+
+// building a models directory's worth of mdl assets: the old serial read, format and re-find against the mapped, parallel build
+// load functions aren't timed, they need the asset bindings of a running tool
+static void Benchmark_SourceModelLoad(CSelfTestContext& ctx)
+{
+	const uint32_t numFiles = 2000u * ctx.Scale();
+
+	std::mt19937_64& rng = ctx.Rng();
+	const std::filesystem::path& dir = ctx.TempDirectory();
+
+	std::vector<std::string> paths;
+	paths.reserve(numFiles);
+
+	size_t totalBytes = 0ull;
+	for (uint32_t i = 0; i < numFiles; ++i)
+	{
+		// most models have a few sequences, animation rigs have hundreds
+		const int numSequences = (rng() % 16ull) == 0ull ? 100 + static_cast<int>(rng() % 300ull) : static_cast<int>(rng() % 24ull);
+		const std::vector<char> file = SyntheticSourceModel(i, numSequences, 16384ull + (rng() % (192ull * 1024ull)));
+
+		totalBytes += file.size();
+		paths.emplace_back(WriteSourceModel(dir, i, file));
+	}
+
+	const char* const seqPrefix = s_AssetTypePaths.find(AssetType_t::SEQ)->second;
+
+	std::vector<CSourceModelAsset*> models;
+	std::vector<std::vector<CSourceSequenceAsset*>> sequences;
+
+	const auto freeAll = [&]()
+		{
+			for (size_t i = 0; i < models.size(); ++i)
+			{
+				if (models[i])
+					DeleteSourceModelAssets(models[i], sequences[i]);
+			}
+
+			models.clear();
+			sequences.clear();
+		};
+
+	// the loader before it was pipelined, one thread reading each file whole and every asset found again by guid afterwards
+	size_t serialFound = 0ull;
+	const int64_t serialNs = SelfTestTimeBest(3u, [&]()
+		{
+			std::vector<CGlobalAssetData::AssetLookup_t> assets;
+			std::vector<uint64_t> guids;
+
+			models.assign(numFiles, nullptr);
+			sequences.assign(numFiles, {});
+
+			for (uint32_t i = 0; i < numFiles; ++i)
+			{
+				const size_t fileSize = std::filesystem::file_size(paths[i]);
+				std::unique_ptr<char[]> fileBuf = std::make_unique<char[]>(fileSize);
+
+				StreamIO fileIn(paths[i], eStreamIOMode::Read);
+				fileIn.R()->read(fileBuf.get(), fileSize);
+
+				const studiohdr_short_t* const pStudioHdr = reinterpret_cast<const studiohdr_short_t* const>(fileBuf.get());
+
+				CSourceModelAsset* const srcMdlAsset = new CSourceModelAsset(pStudioHdr);
+				srcMdlAsset->GetContainerFile<CSourceModelSource>()->SetFilePath(paths[i]);
+
+				assets.push_back({ srcMdlAsset->GetAssetGUID(), srcMdlAsset });
+				guids.push_back(srcMdlAsset->GetAssetGUID());
+
+				const r2::studiohdr_t* const pLocalHdr = reinterpret_cast<const r2::studiohdr_t*>(srcMdlAsset->GetAssetData());
+				const std::filesystem::path srcMdlPath = pStudioHdr->pszName();
+				const std::string basePath(std::format("{}/{}/{}", seqPrefix, srcMdlPath.parent_path().string(), srcMdlPath.stem().string()));
+
+				for (int seq = 0; seq < pLocalHdr->numlocalseq; ++seq)
+				{
+					const r2::mstudioseqdesc_t* const pSeqdesc = pLocalHdr->pSeqdesc(seq);
+					const std::string seqPath = std::format("{}/{}.seq", basePath, pSeqdesc->pszLabel());
+
+					CSourceSequenceAsset* const srcSeqAsset = new CSourceSequenceAsset(srcMdlAsset, pSeqdesc, seqPath);
+
+					assets.push_back({ srcSeqAsset->GetAssetGUID(), srcSeqAsset });
+					guids.push_back(srcSeqAsset->GetAssetGUID());
+					sequences[i].push_back(srcSeqAsset);
+				}
+
+				models[i] = srcMdlAsset;
+			}
+
+			serialFound = 0ull;
+			for (const uint64_t guid : guids)
+				serialFound += std::ranges::find(assets, guid, &CGlobalAssetData::AssetLookup_t::m_guid) != assets.end();
+
+			freeAll();
+		});
+
+	// the build step of HandleMDLLoad, one file at a time off a shared index
+	const auto parallelBuild = [&](const uint32_t workers)
+		{
+			models.assign(numFiles, nullptr);
+			sequences.assign(numFiles, {});
+
+			CParallelTask task(workers);
+
+			std::atomic<uint32_t> fileIdx = 0u;
+			task.addTask([&]()
+				{
+					for (uint32_t i = fileIdx++; i < numFiles; i = fileIdx++)
+						models[i] = CreateSourceModelAssets(paths[i], sequences[i]);
+				}, workers);
+
+			task.execute();
+			task.wait();
+		};
+
+	const int64_t mappedNs = SelfTestTimeBest(3u, [&]()
+		{
+			parallelBuild(1u);
+			freeAll();
+		});
+
+	const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 2u);
+
+	size_t builtAssets = 0ull;
+	const int64_t parallelNs = SelfTestTimeBest(3u, [&]()
+		{
+			parallelBuild(threadCount);
+
+			builtAssets = 0ull;
+			for (size_t i = 0; i < models.size(); ++i)
+				builtAssets += models[i] ? 1ull + sequences[i].size() : 0ull;
+
+			freeAll();
+		});
+
+	SELFTEST_CHECK(ctx, serialFound == builtAssets);
+
+	ctx.Metric("files", static_cast<double>(numFiles), "");
+	ctx.Metric("assets", static_cast<double>(builtAssets), "");
+	ctx.Metric("corpus size", static_cast<double>(totalBytes) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("serial read + re-find", static_cast<double>(serialNs) / 1e6, "ms");
+	ctx.Metric("mapped build, 1 thread", static_cast<double>(mappedNs) / 1e6, "ms");
+	ctx.Metric(std::format("mapped build, {} threads", threadCount), static_cast<double>(parallelNs) / 1e6, "ms");
+}
+
+REGISTER_BENCHMARK("model.mdlload", Benchmark_SourceModelLoad);
+
+// loaded the way HandleMDLLoad registers its models, without the load functions
+static void LoadSourceModelContainers(const std::vector<std::string>& paths, std::vector<CAssetContainer*>& containers)
+{
+	for (const std::string& path : paths)
+	{
+		std::vector<CSourceSequenceAsset*> sequences;
+		CSourceModelAsset* const model = CreateSourceModelAssets(path, sequences);
+		if (!model)
+			continue;
+
+		g_assetData.v_assets.emplace_back(model->GetAssetGUID(), model);
+		g_assetData.v_assetContainers.emplace_back(model->GetContainerFile<CAssetContainer>());
+
+		for (CSourceSequenceAsset* const sequence : sequences)
+			g_assetData.v_assets.emplace_back(sequence->GetAssetGUID(), sequence);
+
+		containers.push_back(model->GetContainerFile<CAssetContainer>());
+	}
+}
+
+// containers loaded and unloaded over and over give their memory back, the working set after each unload stays near where it started
+// one container stays loaded throughout so every unload but the last goes through the selective path rather than clearing everything
+static void SelfTest_ContainerUnloadMemory(CSelfTestContext& ctx)
+{
+	if (!g_assetData.v_assetContainers.empty())
+	{
+		ctx.Note("skipped, assets are already loaded");
+		return;
+	}
+
+	constexpr uint32_t numFiles = 48u;
+	constexpr uint32_t numCycles = 8u;
+	constexpr size_t fileSize = 2ull * 1024ull * 1024ull; // past the size the heap hands back to the os when freed
+
+	std::vector<std::string> paths;
+	for (uint32_t i = 0; i < numFiles; ++i)
+		paths.emplace_back(WriteSourceModel(ctx.TempDirectory(), i, SyntheticSourceModel(i, 8 + static_cast<int>(i % 16u), fileSize)));
+
+	std::vector<CAssetContainer*> resident;
+	LoadSourceModelContainers({ paths.front() }, resident);
+
+	SELFTEST_CHECK(ctx, resident.size() == 1ull);
+	if (resident.size() != 1ull)
+		return;
+
+	const size_t residentAssets = g_assetData.v_assets.size();
+	const std::vector<std::string> cyclePaths(paths.begin() + 1, paths.end());
+
+	// every other container, then the rest
+	const auto unloadCycle = [](const std::vector<CAssetContainer*>& containers)
+		{
+			std::vector<CAssetContainer*> halves[2];
+			for (size_t i = 0; i < containers.size(); ++i)
+				halves[i & 1].push_back(containers[i]);
+
+			return g_assetData.UnloadContainers(halves[0]) + g_assetData.UnloadContainers(halves[1]);
+		};
+
+	// the first cycle leaves the allocator's own bookkeeping behind, it isn't counted
+	{
+		std::vector<CAssetContainer*> containers;
+		LoadSourceModelContainers(cyclePaths, containers);
+		unloadCycle(containers);
+	}
+
+	const size_t baseline = CSelfTestContext::ProcessMemory();
+	const size_t generationBefore = g_assetData.m_unloadGeneration;
+
+	size_t peak = baseline;
+	size_t worstAfterUnload = baseline;
+	size_t unloadedAssets = 0ull;
+	uint32_t leftovers = 0u;
+
+	for (uint32_t cycle = 0; cycle < numCycles; ++cycle)
+	{
+		std::vector<CAssetContainer*> containers;
+		LoadSourceModelContainers(cyclePaths, containers);
+
+		peak = std::max(peak, CSelfTestContext::ProcessMemory());
+
+		unloadedAssets += unloadCycle(containers);
+		worstAfterUnload = std::max(worstAfterUnload, CSelfTestContext::ProcessMemory());
+
+		leftovers += g_assetData.v_assets.size() != residentAssets || g_assetData.v_assetContainers.size() != 1ull;
+	}
+
+	SELFTEST_CHECK(ctx, leftovers == 0u);
+	SELFTEST_CHECK(ctx, g_assetData.m_unloadGeneration == generationBefore + (numCycles * 2u));
+	SELFTEST_CHECK(ctx, g_assetData.v_assetContainers.front() == resident.front());
+
+	// loading has to have cost something for the check to mean anything, the copied headers alone are a file each
+	const size_t growth = peak - baseline;
+	const size_t allowed = std::max(growth / 10ull, 8ull * 1024ull * 1024ull);
+
+	SELFTEST_CHECK(ctx, growth >= (cyclePaths.size() * fileSize) / 2ull);
+	SELFTEST_CHECK(ctx, worstAfterUnload - baseline <= allowed);
+
+	// the last container clears everything
+	g_assetData.UnloadContainers(resident);
+
+	SELFTEST_CHECK(ctx, g_assetData.v_assets.empty() && g_assetData.v_assetContainers.empty());
+
+	ctx.Metric("assets unloaded", static_cast<double>(unloadedAssets), "");
+	ctx.Metric("working set growth when loaded", static_cast<double>(growth) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("working set left after unloading", static_cast<double>(worstAfterUnload - baseline) / (1024.0 * 1024.0), "MiB");
+}
+
+REGISTER_SELFTEST("asset.unloadmemory", SelfTest_ContainerUnloadMemory);
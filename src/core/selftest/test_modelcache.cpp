@@ -0,0 +1,363 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/mdl/modeldata.h>
+#include <core/cache/modelcache.h>
+
+extern CBufferManager g_BufferManager;
+
+// stands in for a model's vertex data in its pak, vg meshes with packed positions, normals and one texcoord
+struct ModelCacheTestModel_t
+{
+	uint64_t guid;
+	uint32_t meshCount;
+	uint32_t vertsPerMesh;
+
+	std::vector<char> vertexData;
+};
+
+static constexpr uint16_t s_modelCacheTestVertSize = 8 + sizeof(Normal32) + sizeof(Vector2D);
+
+static ModelCacheTestModel_t MakeModelCacheTestModel(const uint64_t guid, const uint32_t meshCount, const uint32_t vertsPerMesh, std::mt19937_64& rng)
+{
+	ModelCacheTestModel_t model = { guid, meshCount, vertsPerMesh, {} };
+
+	model.vertexData.resize(static_cast<size_t>(meshCount) * vertsPerMesh * s_modelCacheTestVertSize);
+	for (char& byte : model.vertexData)
+		byte = static_cast<char>(rng());
+
+	return model;
+}
+
+static const uint64_t ModelCacheTestHash(const ModelCacheTestModel_t& model)
+{
+	return CModelCache::HashData(model.vertexData.data(), model.vertexData.size(), model.guid);
+}
+
+// the vertex parse the way the pak model parsers do it, every mesh decoded and handed to the ramen as mesh data
+static void ParseModelCacheTestModel(const ModelCacheTestModel_t& model, ModelParsedData_t* const parsedData)
+{
+	ModelLODData_t& lodData = parsedData->lods.emplace_back();
+	lodData.switchPoint = 0.0f;
+	lodData.meshes.resize(model.meshCount);
+
+	ModelModelData_t& modelData = lodData.models.emplace_back();
+	modelData.name = std::format("body_{:X}", model.guid);
+	modelData.meshes = lodData.meshes.data();
+
+	const uint32_t indexCount = (model.vertsPerMesh - 2u) * 3u;
+
+	std::vector<Vertex_t> vertices(model.vertsPerMesh);
+	std::vector<VertexWeight_t> weights(model.vertsPerMesh);
+	std::vector<uint16_t> indices(indexCount);
+	uint8_t boneMap[256] = {};
+
+	for (uint32_t i = 0; i < indexCount / 3u; i++)
+	{
+		indices[i * 3u] = 0u;
+		indices[(i * 3u) + 1u] = static_cast<uint16_t>(i + 1u);
+		indices[(i * 3u) + 2u] = static_cast<uint16_t>(i + 2u);
+	}
+
+	for (uint32_t meshIdx = 0; meshIdx < model.meshCount; meshIdx++)
+	{
+		ModelMeshData_t& meshData = lodData.meshes.at(meshIdx);
+
+		meshData.bodyPartIndex = 0;
+		meshData.rawVertexLayoutFlags = static_cast<uint64_t>(vg::eVertPositionType::VG_POS_PACKED64) | VERT_NORMAL_PACKED | VERT_TEXCOORDn_FMT(0, 2);
+		meshData.vertCacheSize = s_modelCacheTestVertSize;
+		meshData.vertCount = model.vertsPerMesh;
+		meshData.indexCount = indexCount;
+		meshData.ParseTexcoords();
+
+		int weightIdx = 0;
+		const char* const rawVertexData = model.vertexData.data() + (static_cast<size_t>(meshIdx) * model.vertsPerMesh * s_modelCacheTestVertSize);
+		Vertex_t::ParseVerticesFromVG(vertices.data(), weights.data(), nullptr, &meshData, rawVertexData, boneMap, nullptr, weightIdx);
+
+		meshData.weightsCount = weightIdx;
+
+		CManagedBuffer* const buffer = g_BufferManager.ClaimBuffer();
+
+		CMeshData* const meshVertexData = reinterpret_cast<CMeshData*>(buffer->Buffer());
+		meshVertexData->InitWriter();
+
+		meshVertexData->AddIndices(indices.data(), meshData.indexCount);
+		meshVertexData->AddVertices(vertices.data(), meshData.vertCount);
+		meshVertexData->AddWeights(weights.data(), meshData.weightsCount);
+
+		meshData.ParseMaterial(parsedData, 0);
+
+		meshVertexData->DestroyWriter();
+
+		meshData.meshVertexDataIndex = parsedData->meshVertexData.size();
+		parsedData->meshVertexData.addBack(reinterpret_cast<char*>(meshVertexData), meshVertexData->GetSize());
+
+		g_BufferManager.RelieveBuffer(buffer);
+
+		lodData.vertexCount += meshData.vertCount;
+		lodData.indexCount += meshData.indexCount;
+		lodData.texcoordsPerVert = std::max(lodData.texcoordsPerVert, static_cast<uint16_t>(meshData.texcoordCount));
+
+		modelData.meshCount++;
+		modelData.vertCount += meshData.vertCount;
+	}
+
+	ModelBodyPart_t& bodyPart = parsedData->bodyParts.emplace_back();
+	bodyPart.SetName("body");
+	bodyPart.modelIndex = 0;
+	bodyPart.numModels = 1;
+}
+
+// a fresh parsed data with what the studio header parse leaves before the vertex data, the one material the meshes point at
+static std::unique_ptr<ModelParsedData_t> ModelCacheTestParsedData()
+{
+	std::unique_ptr<ModelParsedData_t> parsedData = std::make_unique<ModelParsedData_t>();
+	parsedData->materials.emplace_back();
+
+	return parsedData;
+}
+
+// restores the model from the cache, or parses and adds it the way ParseModelVertexDataCached does
+static const bool LoadModelCacheTestModel(CModelCache& cache, const ModelCacheTestModel_t& model, ModelParsedData_t* const parsedData)
+{
+	const uint64_t contentHash = ModelCacheTestHash(model);
+
+	if (cache.Restore(model.guid, contentHash, parsedData))
+		return true;
+
+	ParseModelCacheTestModel(model, parsedData);
+	cache.Add(model.guid, contentHash, parsedData);
+
+	return false;
+}
+
+// the restored data has to be what a fresh parse of the current source gives, down to the decompressed mesh data
+static const bool ModelCacheTestMatches(const ModelCacheTestModel_t& model, const ModelParsedData_t* const parsedData)
+{
+	std::unique_ptr<ModelParsedData_t> expected = ModelCacheTestParsedData();
+	ParseModelCacheTestModel(model, expected.get());
+
+	if (parsedData->lods.size() != expected->lods.size() || parsedData->bodyParts.size() != expected->bodyParts.size() || parsedData->meshVertexData.size() != expected->meshVertexData.size())
+		return false;
+
+	for (size_t lodIdx = 0; lodIdx < expected->lods.size(); lodIdx++)
+	{
+		const ModelLODData_t& lod = parsedData->lods[lodIdx];
+		const ModelLODData_t& expectedLod = expected->lods[lodIdx];
+
+		if (lod.vertexCount != expectedLod.vertexCount || lod.indexCount != expectedLod.indexCount || lod.meshes.size() != expectedLod.meshes.size() || lod.models.size() != expectedLod.models.size())
+			return false;
+
+		for (size_t modelIdx = 0; modelIdx < expectedLod.models.size(); modelIdx++)
+		{
+			const ModelModelData_t& restoredModel = lod.models[modelIdx];
+			if (restoredModel.name != expectedLod.models[modelIdx].name || restoredModel.meshCount != expectedLod.models[modelIdx].meshCount || restoredModel.meshes != lod.meshes.data())
+				return false;
+		}
+
+		for (size_t meshIdx = 0; meshIdx < expectedLod.meshes.size(); meshIdx++)
+		{
+			const ModelMeshData_t& mesh = lod.meshes[meshIdx];
+			const ModelMeshData_t& expectedMesh = expectedLod.meshes[meshIdx];
+
+			if (mesh.meshVertexDataIndex != expectedMesh.meshVertexDataIndex || mesh.rawVertexLayoutFlags != expectedMesh.rawVertexLayoutFlags || mesh.vertCount != expectedMesh.vertCount
+				|| mesh.indexCount != expectedMesh.indexCount || mesh.weightsCount != expectedMesh.weightsCount || mesh.texcoordCount != expectedMesh.texcoordCount || mesh.materialId != expectedMesh.materialId)
+				return false;
+
+			// sections are compared on their own, the alignment between them isn't written
+			const std::unique_ptr<char[]> data = parsedData->meshVertexData.getIdx(mesh.meshVertexDataIndex);
+			const std::unique_ptr<char[]> expectedData = expected->meshVertexData.getIdx(expectedMesh.meshVertexDataIndex);
+
+			const CMeshData* const meshData = reinterpret_cast<const CMeshData*>(data.get());
+			const CMeshData* const expectedMeshData = reinterpret_cast<const CMeshData*>(expectedData.get());
+
+			if (!meshData || !expectedMeshData || meshData->GetSize() != expectedMeshData->GetSize()
+				|| memcmp(meshData->GetIndices(), expectedMeshData->GetIndices(), expectedMesh.indexCount * sizeof(uint16_t)) != 0
+				|| memcmp(meshData->GetVertices(), expectedMeshData->GetVertices(), expectedMesh.vertCount * sizeof(Vertex_t)) != 0
+				|| memcmp(meshData->GetWeights(), expectedMeshData->GetWeights(), expectedMesh.weightsCount * sizeof(VertexWeight_t)) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static void PatchModelCacheFile(const std::string& path, const std::function<void(std::vector<char>&)>& patch)
+{
+	std::vector<char> bytes;
+	{
+		StreamIO file;
+		if (!file.open(path, eStreamIOMode::Read))
+			return;
+
+		bytes.resize(file.size());
+		file.read(bytes.data(), bytes.size());
+	}
+
+	patch(bytes);
+
+	StreamIO file;
+	if (file.open(path, eStreamIOMode::Write))
+	{
+		file.write(bytes.data(), bytes.size());
+		file.close();
+	}
+}
+
+static void SelfTest_ModelCache(CSelfTestContext& ctx)
+{
+	std::vector<ModelCacheTestModel_t> models;
+	for (uint64_t i = 0; i < 4ull; i++)
+		models.push_back(MakeModelCacheTestModel(0x1000ull + i, 3u, 300u, ctx.Rng()));
+
+	const std::string cachePath = (ctx.TempDirectory() / "model_cache.bin").string();
+
+	// one session, the cache loaded, every model restored or parsed, then saved for the next
+	const auto runSession = [&](uint32_t& sessionRestored, uint32_t& sessionMatching, const bool expectLoad)
+		{
+			CModelCache cache;
+			SELFTEST_CHECK(ctx, cache.LoadFromFile(cachePath) == expectLoad);
+
+			sessionRestored = 0u;
+			sessionMatching = 0u;
+
+			for (const ModelCacheTestModel_t& model : models)
+			{
+				std::unique_ptr<ModelParsedData_t> parsedData = ModelCacheTestParsedData();
+
+				sessionRestored += LoadModelCacheTestModel(cache, model, parsedData.get());
+				sessionMatching += ModelCacheTestMatches(model, parsedData.get());
+			}
+
+			SELFTEST_CHECK(ctx, cache.SaveToFile(cachePath));
+		};
+
+	const uint32_t numModels = static_cast<uint32_t>(models.size());
+	uint32_t restored = 0u, matching = 0u;
+
+	runSession(restored, matching, true);
+	SELFTEST_CHECK(ctx, restored == 0u && matching == numModels);
+
+	runSession(restored, matching, true);
+	SELFTEST_CHECK(ctx, restored == numModels && matching == numModels);
+
+	// a model whose source changed since the cache was written has to be parsed from the new data
+	{
+		models[1].vertexData[17] ^= 0x5a;
+
+		runSession(restored, matching, true);
+		SELFTEST_CHECK(ctx, restored == numModels - 1u && matching == numModels);
+
+		runSession(restored, matching, true);
+		SELFTEST_CHECK(ctx, restored == numModels && matching == numModels);
+	}
+
+	// a cache written by a build with different vertex parsing is dropped whole
+	{
+		PatchModelCacheFile(cachePath, [](std::vector<char>& bytes)
+			{
+				ModelCacheHeader_t header = {};
+				memcpy(&header, bytes.data(), sizeof(header));
+
+				header.fileVersion = MODEL_CACHE_FILE_VERSION + 1;
+				memcpy(bytes.data(), &header, sizeof(header));
+			});
+
+		runSession(restored, matching, false);
+		SELFTEST_CHECK(ctx, restored == 0u && matching == numModels);
+
+		runSession(restored, matching, true);
+		SELFTEST_CHECK(ctx, restored == numModels && matching == numModels);
+	}
+
+	// a byte flipped inside one entry's compressed mesh data, which reading the entry alone wouldn't notice
+	{
+		uint64_t damagedGuid = 0ull;
+
+		PatchModelCacheFile(cachePath, [&damagedGuid](std::vector<char>& bytes)
+			{
+				ModelCacheMapping_t mapping = {};
+				memcpy(&mapping, bytes.data() + sizeof(ModelCacheHeader_t), sizeof(mapping));
+
+				damagedGuid = mapping.guid;
+				bytes[mapping.dataOffset + mapping.dataSize - 8ull] ^= 0x5a;
+			});
+
+		runSession(restored, matching, true);
+		SELFTEST_CHECK(ctx, damagedGuid != 0ull && restored == numModels - 1u && matching == numModels);
+
+		runSession(restored, matching, true);
+		SELFTEST_CHECK(ctx, restored == numModels && matching == numModels);
+	}
+
+	// a file cut short, the entries past the end are parsed again and the rest still restored
+	{
+		PatchModelCacheFile(cachePath, [](std::vector<char>& bytes)
+			{
+				bytes.resize(bytes.size() - 64ull);
+			});
+
+		runSession(restored, matching, true);
+		SELFTEST_CHECK(ctx, restored == numModels - 1u && matching == numModels);
+
+		runSession(restored, matching, true);
+		SELFTEST_CHECK(ctx, restored == numModels && matching == numModels);
+	}
+}
+
+REGISTER_SELFTEST("model.cache", SelfTest_ModelCache);
+
+// parsing a set of models against restoring them from a cache saved by an earlier session
+static void Benchmark_ModelCache(CSelfTestContext& ctx)
+{
+	const uint32_t numModels = 64u * ctx.Scale();
+
+	std::vector<ModelCacheTestModel_t> models;
+	for (uint32_t i = 0; i < numModels; i++)
+		models.push_back(MakeModelCacheTestModel(0x1000ull + i, 4u + (i % 5u), 2048u, ctx.Rng()));
+
+	const std::string cachePath = (ctx.TempDirectory() / "model_cache.bin").string();
+
+	uint32_t coldRestored = 0u;
+	const auto coldStart = std::chrono::steady_clock::now();
+	{
+		CModelCache cache;
+		cache.LoadFromFile(cachePath);
+
+		for (const ModelCacheTestModel_t& model : models)
+		{
+			std::unique_ptr<ModelParsedData_t> parsedData = ModelCacheTestParsedData();
+			coldRestored += LoadModelCacheTestModel(cache, model, parsedData.get());
+		}
+
+		SELFTEST_CHECK(ctx, cache.SaveToFile(cachePath));
+	}
+	const int64_t coldNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - coldStart).count();
+
+	uint32_t warmRestored = 0u;
+	const auto warmStart = std::chrono::steady_clock::now();
+	{
+		CModelCache cache;
+		cache.LoadFromFile(cachePath);
+
+		for (const ModelCacheTestModel_t& model : models)
+		{
+			std::unique_ptr<ModelParsedData_t> parsedData = ModelCacheTestParsedData();
+			warmRestored += LoadModelCacheTestModel(cache, model, parsedData.get());
+		}
+	}
+	const int64_t warmNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - warmStart).count();
+
+	SELFTEST_CHECK(ctx, coldRestored == 0u && warmRestored == numModels);
+
+	std::error_code ec;
+	const uintmax_t cacheSize = std::filesystem::file_size(cachePath, ec);
+
+	ctx.Metric("models", static_cast<double>(numModels), "");
+	ctx.Metric("cache file", static_cast<double>(cacheSize) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("cold parse (includes saving)", static_cast<double>(coldNs) / 1e6, "ms");
+	ctx.Metric("warm cache hit", static_cast<double>(warmNs) / 1e6, "ms");
+	ctx.Metric("speedup", warmNs ? static_cast<double>(coldNs) / warmNs : 0.0, "x");
+}
+
+REGISTER_BENCHMARK("model.cache", Benchmark_ModelCache);
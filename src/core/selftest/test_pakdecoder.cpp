@@ -0,0 +1,799 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <game/rtech/utils/utils.h>
+#include <game/rtech/utils/pakdecoder.h>
+
+#include <bit>
+#include <deque>
+
+// codes are read back out of the reference decoder's lut, so the test streams don't depend on CPakDecoder's own tables
+struct PakLzCode_t
+{
+	uint32_t code;
+	uint32_t bits;
+};
+
+struct PakLzLengthCode_t
+{
+	uint32_t code;
+	uint32_t base;
+	uint32_t bits;
+};
+
+static constexpr size_t s_lutTokenBits = 512ull;
+static constexpr size_t s_lutDistanceLow = 1024ull;
+static constexpr size_t s_lutDistanceBits = 1088ull;
+static constexpr size_t s_lutLongLengthBase = 1152ull;
+static constexpr size_t s_lutLongLengthBits = 1216ull;
+static constexpr size_t s_lutShortLengthBase = 1232ull;
+static constexpr size_t s_lutShortLengthBits = 1240ull;
+static constexpr size_t s_lutLongLiteral = 1248ull;
+
+// prefix codes are read lsb first, so the code of an entry is the low bits of any lookup index that maps to it
+static const bool FindTokenCode(const uint32_t table, const int value, PakLzCode_t& code)
+{
+	for (uint32_t i = 0u; i < 256u; ++i)
+	{
+		if (static_cast<int8_t>(s_PakFileCompressionLUT[(table * 256u) + i]) != value)
+			continue;
+
+		code.bits = s_PakFileCompressionLUT[s_lutTokenBits + (table * 256u) + i];
+		code.code = i & ((1u << code.bits) - 1u);
+		return true;
+	}
+
+	return false;
+}
+
+static const PakLzCode_t FindDistanceLowCode(const uint32_t low)
+{
+	for (uint32_t i = 0u; i < 64u; ++i)
+	{
+		if (s_PakFileCompressionLUT[s_lutDistanceLow + i] != low)
+			continue;
+
+		const uint32_t bits = s_PakFileCompressionLUT[s_lutDistanceBits + i];
+		return { i & ((1u << bits) - 1u), bits };
+	}
+
+	assertm(false, "distance low part has no code");
+	return { 0u, 0u };
+}
+
+// short codes 1-7, or 0 followed by a 4 bit long code
+static const PakLzLengthCode_t FindLengthCode(const uint32_t length, bool& isLong)
+{
+	for (uint32_t i = 1u; i < 8u; ++i)
+	{
+		const uint32_t base = s_PakFileCompressionLUT[s_lutShortLengthBase + i];
+		const uint32_t bits = s_PakFileCompressionLUT[s_lutShortLengthBits + i];
+
+		if (length >= base && length - base < (1u << bits))
+		{
+			isLong = false;
+			return { i, base, bits };
+		}
+	}
+
+	for (uint32_t i = 0u; i < 16u; ++i)
+	{
+		uint32_t base;
+		memcpy(&base, s_PakFileCompressionLUT + s_lutLongLengthBase + (i * sizeof(uint32_t)), sizeof(uint32_t));
+
+		const uint32_t bits = s_PakFileCompressionLUT[s_lutLongLengthBits + i];
+
+		if (length >= base && length - base < (1u << bits))
+		{
+			isLong = true;
+			return { i, base, bits };
+		}
+	}
+
+	assertm(false, "length is too long to encode");
+	isLong = false;
+	return { 0u, 0u, 0u };
+}
+
+// writes pak lz streams by following the decoder's bit window and input position token by token, so every bit lands where the decoder reads it
+// tokens are picked at random, the decoded bytes follow from them
+class CPakLzTestEncoder
+{
+public:
+	CPakLzTestEncoder(std::mt19937_64& rng, const size_t headerSize, const uint32_t inputChunkBits, const uint32_t outputChunkBits) : m_rng(rng), m_headerSize(headerSize),
+		m_inputChunkBits(inputChunkBits), m_outputChunkBits(outputChunkBits), m_inPos(0ull), m_bitsUsed(0u), m_failed(false)
+	{
+	};
+
+	// chunk bits of 64 have no chunks, stream holds headerSize bytes of random header followed by the stream
+	// returns false if the stream can't be represented (a segment's compressed size doesn't fit its size field)
+	const bool Encode(const size_t plainSize, const uint32_t matchPercent, std::vector<char>& plain, std::vector<char>& stream);
+
+private:
+	void EnsureStream(const uint64_t size) { if (m_stream.size() < size) m_stream.resize(size, 0); };
+
+	// the bytes [inPos, inPos + count) join the back of the window
+	void AppendWindowBytes(const uint32_t count)
+	{
+		EnsureStream(m_inPos + count);
+
+		for (uint32_t i = 0u; i < count * 8u; ++i)
+			m_window.emplace_back((m_inPos * 8ull) + i);
+
+		m_inPos += count;
+	}
+
+	void Refill()
+	{
+		AppendWindowBytes(m_bitsUsed >> 3);
+		m_bitsUsed &= 7u;
+	}
+
+	void Emit(const uint64_t value, const uint32_t count)
+	{
+		if (m_window.size() < count)
+		{
+			m_failed = true;
+			return;
+		}
+
+		for (uint32_t i = 0u; i < count; ++i)
+		{
+			const uint64_t bit = m_window.front();
+			m_window.pop_front();
+
+			if ((value >> i) & 1ull)
+				m_stream[bit >> 3] |= static_cast<char>(1u << (bit & 7ull));
+		}
+
+		m_bitsUsed += count;
+	}
+
+	void EmitCode(const PakLzCode_t& code) { Emit(code.code, code.bits); };
+
+	void EmitLength(const uint32_t length, const bool isMatch)
+	{
+		bool isLong = false;
+		const PakLzLengthCode_t code = FindLengthCode(length, isLong);
+
+		if (isLong)
+		{
+			Emit(0u, 3u);
+			Emit(code.code, 4u);
+
+			// the longest lengths of a match top the window up by a byte first
+			if (isMatch && m_bitsUsed + code.bits >= 64u)
+			{
+				AppendWindowBytes(1u);
+				m_bitsUsed -= 8u;
+			}
+		}
+		else
+		{
+			Emit(code.code, 3u);
+		}
+
+		Emit(length - code.base, code.bits);
+	}
+
+	void EmitDistance(const uint32_t distance)
+	{
+		const uint32_t value = distance + 16u;
+		const uint32_t high = value >> 4;
+		const uint32_t exponent = static_cast<uint32_t>(std::bit_width(high)) - 1u;
+
+		if (exponent < 15u)
+		{
+			Emit(exponent, 4u);
+		}
+		else
+		{
+			Emit(15u, 4u);
+			Emit(exponent - 15u, 2u);
+		}
+
+		EmitCode(FindDistanceLowCode(value & 15u));
+		Emit(high - (1u << exponent), exponent);
+	}
+
+	void Match(const uint32_t afterLiteral, const uint32_t distance, const uint32_t length);
+	void Literal(const uint32_t afterLiteral, const uint32_t length, const bool isLong, const uint32_t base);
+
+	// returns true if it wrote a literal run
+	const bool PickToken(const uint32_t afterLiteral, const uint64_t segmentOutputEnd, const uint32_t matchPercent);
+
+	std::mt19937_64& m_rng;
+
+	size_t m_headerSize;
+	uint32_t m_inputChunkBits;
+	uint32_t m_outputChunkBits;
+
+	uint64_t m_inputChunkMask;
+	uint64_t m_outputChunkMask;
+	uint64_t m_decompSize;
+
+	std::vector<char> m_stream;
+	std::vector<char> m_output; // decoded stream, header included
+
+	std::deque<uint64_t> m_window; // stream bit of each valid window bit, lowest first
+	uint64_t m_inPos;
+	uint64_t m_outPos;
+	uint32_t m_bitsUsed;
+
+	bool m_failed;
+};
+
+void CPakLzTestEncoder::Match(const uint32_t afterLiteral, const uint32_t distance, const uint32_t length)
+{
+	// matches under 8 back and past 16 long use the long token, overlapping ones store their length 13 longer
+	const bool isLong = distance < 8u || length > 16u;
+
+	PakLzCode_t token = {};
+	FindTokenCode(afterLiteral, isLong ? 17 : static_cast<int>(length), token);
+
+	EmitCode(token);
+	EmitDistance(distance);
+
+	if (isLong)
+		EmitLength(length - (distance < 8u ? 4u : 17u), true);
+
+	for (uint32_t i = 0u; i < length; ++i)
+		m_output[m_outPos + i] = m_output[m_outPos + i - distance];
+
+	m_outPos += length;
+}
+
+void CPakLzTestEncoder::Literal(const uint32_t afterLiteral, const uint32_t length, const bool isLong, const uint32_t base)
+{
+	PakLzCode_t token = {};
+	FindTokenCode(afterLiteral, isLong ? -static_cast<int>(s_PakFileCompressionLUT[s_lutLongLiteral + afterLiteral]) : -static_cast<int>(length), token);
+
+	EmitCode(token);
+
+	if (isLong)
+		EmitLength(length - base, false);
+
+	EnsureStream(m_inPos + length);
+
+	// half of the runs come from a small alphabet so later matches have something to find
+	const bool smallAlphabet = m_rng() & 1ull;
+	for (uint32_t i = 0u; i < length; ++i)
+	{
+		const char value = static_cast<char>(smallAlphabet ? 'a' + (m_rng() % 4ull) : m_rng());
+
+		m_stream[m_inPos + i] = value;
+		m_output[m_outPos + i] = value;
+	}
+
+	m_inPos += length;
+	m_outPos += length;
+}
+
+const bool CPakLzTestEncoder::PickToken(const uint32_t afterLiteral, const uint64_t segmentOutputEnd, const uint32_t matchPercent)
+{
+	const uint64_t remaining = segmentOutputEnd - m_outPos;
+	const uint64_t history = m_outPos - m_headerSize;
+
+	if (remaining >= 4ull && history >= 1ull && (m_rng() % 100ull) < matchPercent)
+	{
+		// distances stay under 1MB, longer ones could run the window out of bits with the longest lengths
+		const uint64_t maxDistance = std::min<uint64_t>(history, 1ull << 20);
+
+		uint32_t distance = 0u;
+		if (maxDistance < 8ull || (m_rng() % 4ull) == 0ull)
+		{
+			distance = static_cast<uint32_t>(1ull + (m_rng() % std::min<uint64_t>(maxDistance, 7ull)));
+		}
+		else
+		{
+			// log uniform, so near and far matches both show up
+			const uint32_t maxBits = static_cast<uint32_t>(std::bit_width(maxDistance));
+			const uint64_t upper = std::min<uint64_t>(maxDistance, (1ull << (4u + (m_rng() % (maxBits - 2u)))) - 1ull);
+			distance = static_cast<uint32_t>(8ull + (m_rng() % (upper - 7ull)));
+		}
+
+		uint64_t length = 0ull;
+		switch (m_rng() % 8ull)
+		{
+		case 0: length = 17ull + (m_rng() % 512ull); break;
+		case 1: length = 17ull + (m_rng() % 200000ull); break;
+		default: length = 4ull + (m_rng() % 13ull); break;
+		}
+
+		Match(afterLiteral, distance, static_cast<uint32_t>(std::min(length, remaining)));
+		return false;
+	}
+
+	// literals don't run into the padding at the end of an input chunk
+	const uint64_t chunkRoom = (m_inPos | m_inputChunkMask) - m_inPos + 1ull;
+	const uint64_t maxLength = std::min(remaining, chunkRoom);
+
+	// the long literal's own length only counts away from the end of a chunk or the stream
+	const bool nearEnd = (~m_inPos & m_inputChunkMask) < 15ull || (~m_outPos & m_outputChunkMask) < 15ull || m_decompSize - m_outPos < 16ull;
+	const uint32_t base = afterLiteral ? 1u : (nearEnd ? 1u : 17u);
+
+	uint64_t length = 0ull;
+	switch (m_rng() % 8ull)
+	{
+	case 0: length = 17ull + (m_rng() % 1024ull); break;
+	case 1: length = 17ull + (m_rng() % 150000ull); break;
+	default: length = 1ull + (m_rng() % 16ull); break;
+	}
+
+	length = std::min(length, maxLength);
+
+	// after a literal only the long token is left, otherwise short tokens cover 1-16 and the long one anything from its base
+	bool isLong = true;
+	if (!afterLiteral && length <= 16ull)
+		isLong = length >= base && (m_rng() & 1ull);
+
+	Literal(afterLiteral, static_cast<uint32_t>(length), isLong, base);
+	return true;
+}
+
+const bool CPakLzTestEncoder::Encode(const size_t plainSize, const uint32_t matchPercent, std::vector<char>& plain, std::vector<char>& stream)
+{
+	m_stream.assign(m_headerSize, 0);
+	for (char& c : m_stream)
+		c = static_cast<char>(m_rng());
+
+	m_decompSize = m_headerSize + plainSize;
+	m_output.assign(m_decompSize, 0);
+
+	m_inputChunkMask = m_inputChunkBits >= 64u ? ~0ull : (1ull << m_inputChunkBits) - 1ull;
+	m_outputChunkMask = m_outputChunkBits >= 64u ? ~0ull : (1ull << m_outputChunkBits) - 1ull;
+
+	const uint32_t sizeFieldBytes = m_inputChunkMask == ~0ull ? 0u : (m_inputChunkBits >> 3) + 1u;
+
+	// header: decoded size with its top bit implied, then the chunk sizes
+	m_window.clear();
+	m_inPos = m_headerSize;
+	m_bitsUsed = 64u;
+	m_failed = false;
+
+	Refill();
+
+	const uint32_t sizeBits = static_cast<uint32_t>(std::bit_width(m_decompSize)) - 1u;
+	Emit(sizeBits, 6u);
+	Emit(m_decompSize & ((1ull << sizeBits) - 1ull), sizeBits);
+	Refill();
+
+	const uint32_t chunkBits = ((m_outputChunkBits & 0x7Fu) << 6) | (m_inputChunkBits & 0x3Fu);
+	Emit(chunkBits, 13u);
+	Refill();
+
+	std::vector<uint64_t> sizeFields;
+	std::vector<uint64_t> segmentInputEnds;
+
+	sizeFields.emplace_back(m_inPos);
+	AppendWindowBytes(0u);
+	EnsureStream(m_inPos + sizeFieldBytes);
+	m_inPos += sizeFieldBytes;
+
+	uint64_t inputChunkLimit = m_inputChunkMask - 6ull;
+
+	const bool multiSegment = m_decompSize - 1ull > m_outputChunkMask;
+	uint64_t segmentOutputEnd = multiSegment ? m_outputChunkMask + 1ull : m_decompSize;
+
+	m_outPos = m_headerSize;
+	uint32_t afterLiteral = 0u;
+
+	for (;;)
+	{
+		while (m_outPos < segmentOutputEnd)
+		{
+			if (m_bitsUsed)
+				Refill();
+
+			afterLiteral = PickToken(afterLiteral, segmentOutputEnd, matchPercent) ? 1u : 0u;
+
+			if (m_failed)
+				return false;
+
+			if (m_outPos == segmentOutputEnd)
+				break;
+
+			// skip the padding at the end of an input chunk
+			if (m_inPos >= inputChunkLimit)
+			{
+				const uint64_t chunkStart = ~m_inputChunkMask & (m_inPos + 7ull);
+				assertm(chunkStart >= m_inPos, "token ran past its input chunk");
+
+				EnsureStream(chunkStart);
+				for (uint64_t i = m_inPos; i < chunkStart; ++i)
+					m_stream[i] = static_cast<char>(m_rng());
+
+				m_inPos = chunkStart;
+				inputChunkLimit += m_inputChunkMask + 1ull;
+			}
+		}
+
+		segmentInputEnds.emplace_back(m_inPos);
+
+		if (m_outPos == m_decompSize)
+			break;
+
+		// next segment, mirrors CPakDecoder::AdvanceSegment
+		uint64_t pos = m_inPos;
+
+		const uint64_t chunkRemaining = m_inputChunkMask & (0ull - pos);
+		const bool nextChunk = sizeFieldBytes > chunkRemaining;
+
+		if (nextChunk)
+			pos += chunkRemaining;
+
+		Emit(1u, 1u); // stop bit
+
+		if (nextChunk && pos > inputChunkLimit)
+			inputChunkLimit += m_inputChunkMask + 1ull;
+
+		sizeFields.emplace_back(pos);
+		pos += sizeFieldBytes;
+
+		segmentOutputEnd = std::min<uint64_t>(m_outPos + m_outputChunkMask + 1ull, m_decompSize);
+
+		if (pos >= inputChunkLimit)
+		{
+			pos = ~m_inputChunkMask & (pos + 7ull);
+			inputChunkLimit += m_inputChunkMask + 1ull;
+		}
+
+		EnsureStream(pos);
+		m_inPos = pos;
+	}
+
+	if (m_failed)
+		return false;
+
+	m_stream.resize(m_inPos);
+
+	// each segment's size field holds its input size, the decoder adds them up into where each segment ends
+	if (sizeFieldBytes)
+	{
+		uint64_t decoderEnd = 0ull;
+
+		for (size_t i = 0; i < segmentInputEnds.size(); ++i)
+		{
+			const bool last = i + 1 == segmentInputEnds.size();
+
+			uint64_t size = segmentInputEnds[i] - decoderEnd;
+			if (i == 0 && multiSegment)
+				size += sizeFieldBytes;
+			else if (i > 0 && last)
+				size -= sizeFieldBytes;
+
+			if (sizeFieldBytes < 8u && size >> (sizeFieldBytes * 8u))
+				return false;
+
+			memcpy(m_stream.data() + sizeFields[i], &size, sizeFieldBytes);
+			decoderEnd = segmentInputEnds[i];
+		}
+	}
+
+	plain.assign(m_output.begin() + m_headerSize, m_output.end());
+	stream = std::move(m_stream);
+
+	return true;
+}
+
+// the size of a v8 pak header, the decoded stream starts after it
+static constexpr size_t s_pakHeaderSize = 128ull;
+
+static const bool EncodeTestStream(std::mt19937_64& rng, const size_t plainSize, const size_t headerSize, const uint32_t inputChunkBits, const uint32_t outputChunkBits, std::vector<char>& plain, std::vector<char>& stream)
+{
+	CPakLzTestEncoder encoder(rng, headerSize, inputChunkBits, outputChunkBits);
+	return encoder.Encode(plainSize, static_cast<uint32_t>(rng() % 90ull), plain, stream);
+}
+
+// single segment, single segment read in input chunks, or segments of (1 << outputChunkBits) decoded bytes
+static void PickChunkBits(std::mt19937_64& rng, const uint32_t kind, uint32_t& inputChunkBits, uint32_t& outputChunkBits)
+{
+	inputChunkBits = 64u;
+	outputChunkBits = 64u;
+
+	if (kind == 0u)
+		return;
+
+	// one unbounded segment needs a three byte size field to hold the whole stream
+	if (kind == 1u)
+	{
+		inputChunkBits = 16u + static_cast<uint32_t>(rng() % 4ull);
+		return;
+	}
+
+	// two byte size fields, segments have to compress to under 64KB
+	inputChunkBits = 10u + static_cast<uint32_t>(rng() % 6ull);
+	outputChunkBits = 12u + static_cast<uint32_t>(rng() % 4ull);
+}
+
+static const bool DecodeReference(const std::vector<char>& stream, const size_t headerSize, std::vector<char>& output)
+{
+	// the reference reads a word past the input and copies in 16 byte blocks past the output
+	std::vector<char> input(stream.size() + 32ull, 0);
+	memcpy(input.data(), stream.data(), stream.size());
+
+	RTech::PakDecompressContext_t context = {};
+	const size_t decodeSize = RTech::InitPakDecoder(&context, reinterpret_cast<const uint8_t*>(input.data()), PAK_DECODE_MASK, stream.size(), 0ull, headerSize);
+
+	output.assign(decodeSize + CPakDecoder::s_outputPadding, 0);
+	context.m_outputMask = PAK_DECODE_MASK;
+	context.m_outputBuf = reinterpret_cast<uint64_t>(output.data());
+
+	if (!RTech::DecompressPakFile(&context, stream.size(), decodeSize))
+		return false;
+
+	output.resize(decodeSize);
+	return true;
+}
+
+static constexpr size_t s_canarySize = 64ull;
+static constexpr char s_canary = static_cast<char>(0xCD);
+
+// decodes into a buffer with a canary past its padding, streams that claim more than maxSize are rejected up front
+// sliceSize 0 reads the input in place, otherwise it is pushed in random slices of up to sliceSize bytes
+static const CPakDecoder::eStatus DecodeStream(const char* const data, const size_t size, const size_t headerSize, const size_t sliceSize, std::mt19937_64& rng, const size_t maxSize, std::vector<char>& output, bool& overrun)
+{
+	CPakDecoder decoder;
+	size_t pushed = 0ull;
+
+	overrun = false;
+
+	const auto push = [&]() -> bool
+	{
+		if (pushed >= size)
+			return false;
+
+		const size_t slice = std::min<size_t>(size - pushed, 1ull + (rng() % sliceSize));
+		decoder.PushInput(data + pushed, slice);
+		pushed += slice;
+
+		return true;
+	};
+
+	if (!sliceSize)
+		decoder.SetInput(data, size);
+
+	size_t decodeSize = 0ull;
+	while ((decodeSize = decoder.ReadHeader(size, headerSize)) == 0ull)
+	{
+		if (!sliceSize || !push())
+			return CPakDecoder::eStatus::CORRUPT;
+	}
+
+	if (decodeSize > maxSize)
+		return CPakDecoder::eStatus::CORRUPT;
+
+	output.assign(decodeSize + CPakDecoder::s_outputPadding + s_canarySize, s_canary);
+	decoder.SetOutput(output.data(), decodeSize + CPakDecoder::s_outputPadding);
+
+	CPakDecoder::eStatus status = CPakDecoder::eStatus::NEED_INPUT;
+	while ((status = decoder.Decode()) == CPakDecoder::eStatus::NEED_INPUT)
+	{
+		if (!sliceSize || !push())
+			break;
+	}
+
+	overrun = std::any_of(output.end() - s_canarySize, output.end(), [](const char c) { return c != s_canary; });
+	output.resize(decodeSize);
+
+	return status;
+}
+
+static const bool DecodedEquals(const std::vector<char>& output, const size_t headerSize, const std::vector<char>& plain)
+{
+	return output.size() == headerSize + plain.size() && std::equal(plain.begin(), plain.end(), output.begin() + headerSize);
+}
+
+// random streams through the reference decoder and CPakDecoder, read in place and pushed in slices
+static void SelfTest_PakLzDecode(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	std::vector<char> plain;
+	std::vector<char> stream;
+	std::vector<char> output;
+
+	for (uint32_t i = 0u; i < 60u; ++i)
+	{
+		const size_t headerSize = (i & 1u) ? s_pakHeaderSize : 0ull;
+		const size_t plainSize = 1ull + (rng() % (i < 9u ? 64ull : 256ull * 1024ull));
+
+		uint32_t inputChunkBits = 0u;
+		uint32_t outputChunkBits = 0u;
+		PickChunkBits(rng, i % 3u, inputChunkBits, outputChunkBits);
+
+		if (!EncodeTestStream(rng, plainSize, headerSize, inputChunkBits, outputChunkBits, plain, stream))
+		{
+			ctx.Fail(std::format("stream {}: test encoder failed ({} bytes, chunk bits {}/{})", i, plainSize, inputChunkBits, outputChunkBits));
+			continue;
+		}
+
+		const std::string desc = std::format("stream {} ({} -> {} bytes, header {}, chunk bits {}/{})", i, plainSize, stream.size(), headerSize, inputChunkBits, outputChunkBits);
+
+		// the test encoder against the reference first, a mismatch here is the encoder's
+		const bool referenceOk = DecodeReference(stream, headerSize, output) && DecodedEquals(output, headerSize, plain);
+		ctx.Check(referenceOk, (desc + ": reference decoder matches the test encoder").c_str(), __FILE__, __LINE__);
+
+		if (!referenceOk)
+			continue;
+
+		const std::unique_ptr<char[]> input(new char[stream.size()]);
+		memcpy(input.get(), stream.data(), stream.size());
+
+		bool overrun = false;
+		const bool inPlaceOk = DecodeStream(input.get(), stream.size(), headerSize, 0ull, rng, SIZE_MAX, output, overrun) == CPakDecoder::eStatus::DONE && !overrun && DecodedEquals(output, headerSize, plain);
+		ctx.Check(inPlaceOk, (desc + ": in place decode matches the reference").c_str(), __FILE__, __LINE__);
+
+		const size_t sliceSize = 1ull + (rng() % 70000ull);
+		const bool slicedOk = DecodeStream(input.get(), stream.size(), headerSize, sliceSize, rng, SIZE_MAX, output, overrun) == CPakDecoder::eStatus::DONE && !overrun && DecodedEquals(output, headerSize, plain);
+		ctx.Check(slicedOk, (desc + std::format(": decode from {} byte slices matches the reference", sliceSize)).c_str(), __FILE__, __LINE__);
+	}
+}
+
+// damaged and random streams have to come back as corrupt or decoded, without writing past the output
+static void SelfTest_PakLzCorrupt(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	std::vector<char> plain;
+	std::vector<char> stream;
+	std::vector<char> output;
+
+	uint32_t corrupt = 0u;
+
+	for (uint32_t i = 0u; i < 600u; ++i)
+	{
+		const size_t headerSize = (i & 1u) ? s_pakHeaderSize : 0ull;
+
+		uint32_t inputChunkBits = 0u;
+		uint32_t outputChunkBits = 0u;
+		PickChunkBits(rng, i % 3u, inputChunkBits, outputChunkBits);
+
+		if (!EncodeTestStream(rng, 1ull + (rng() % 20000ull), headerSize, inputChunkBits, outputChunkBits, plain, stream))
+			continue;
+
+		switch (rng() % 4ull)
+		{
+		case 0: // flipped bits
+		{
+			const uint32_t flips = 1u + static_cast<uint32_t>(rng() % 8ull);
+			for (uint32_t flip = 0u; flip < flips; ++flip)
+				stream[rng() % stream.size()] ^= static_cast<char>(1u << (rng() % 8ull));
+
+			break;
+		}
+		case 1: // overwritten range
+		{
+			const size_t start = rng() % stream.size();
+			const size_t end = std::min<size_t>(stream.size(), start + 1ull + (rng() % 64ull));
+
+			for (size_t pos = start; pos < end; ++pos)
+				stream[pos] = static_cast<char>(rng());
+
+			break;
+		}
+		case 2: // truncated
+		{
+			stream.resize(rng() % stream.size());
+			break;
+		}
+		case 3: // noise
+		{
+			stream.resize(rng() % 4096ull);
+			for (char& c : stream)
+				c = static_cast<char>(rng());
+
+			break;
+		}
+		}
+
+		// exactly sized, so reads past the end are caught by a checked build
+		const std::unique_ptr<char[]> input(new char[std::max<size_t>(stream.size(), 1ull)]);
+		memcpy(input.get(), stream.data(), stream.size());
+
+		for (const size_t sliceSize : { 0ull, 1ull + (rng() % 4096ull) })
+		{
+			bool overrun = false;
+			const CPakDecoder::eStatus status = DecodeStream(input.get(), stream.size(), headerSize, sliceSize, rng, 64ull << 20, output, overrun);
+
+			if (status == CPakDecoder::eStatus::CORRUPT)
+				corrupt++;
+
+			const std::string desc = std::format("stream {} (slices {})", i, sliceSize);
+			ctx.Check(!overrun, (desc + ": nothing written past the output padding").c_str(), __FILE__, __LINE__);
+			ctx.Check(status != CPakDecoder::eStatus::NEED_INPUT, (desc + ": no more input wanted once all of it was pushed").c_str(), __FILE__, __LINE__);
+		}
+	}
+
+	ctx.Note(std::format("{} of the damaged decodes were reported corrupt", corrupt));
+}
+
+REGISTER_SELFTEST("pak.lzdecode", SelfTest_PakLzDecode);
+REGISTER_SELFTEST("pak.lzcorrupt", SelfTest_PakLzCorrupt);
+
+// decode throughput of the reference decoder against CPakDecoder reading in place and from 4MB slices, like a pak file stream
+static void Benchmark_PakLzDecode(CSelfTestContext& ctx)
+{
+	const size_t plainSize = (16ull << 20) * ctx.Scale();
+
+	struct BenchStream_t
+	{
+		const char* name;
+		uint32_t inputChunkBits;
+		uint32_t outputChunkBits;
+	};
+
+	static const BenchStream_t s_streams[] =
+	{
+		{ "single segment", 64u, 64u },
+		{ "256KB segments", 16u, 18u },
+	};
+
+	std::vector<char> plain;
+	std::vector<char> stream;
+	std::vector<char> output;
+
+	for (const BenchStream_t& bench : s_streams)
+	{
+		CPakLzTestEncoder encoder(ctx.Rng(), s_pakHeaderSize, bench.inputChunkBits, bench.outputChunkBits);
+		if (!encoder.Encode(plainSize, 60u, plain, stream))
+		{
+			ctx.Fail(std::format("{}: test encoder failed", bench.name));
+			continue;
+		}
+
+		const double decodedMB = static_cast<double>(plainSize) / (1024.0 * 1024.0);
+
+		bool referenceOk = true;
+		const int64_t referenceNs = SelfTestTimeBest(3u, [&]() { referenceOk &= DecodeReference(stream, s_pakHeaderSize, output) && DecodedEquals(output, s_pakHeaderSize, plain); });
+
+		bool inPlaceOk = true;
+		const int64_t inPlaceNs = SelfTestTimeBest(3u, [&]()
+			{
+				bool overrun = false;
+				inPlaceOk &= DecodeStream(stream.data(), stream.size(), s_pakHeaderSize, 0ull, ctx.Rng(), SIZE_MAX, output, overrun) == CPakDecoder::eStatus::DONE && !overrun;
+			});
+		inPlaceOk &= DecodedEquals(output, s_pakHeaderSize, plain);
+
+		// fixed slices rather than random ones, the way CPakFile::DecodeFileStream reads
+		bool slicedOk = true;
+		const int64_t slicedNs = SelfTestTimeBest(3u, [&]()
+			{
+				CPakDecoder decoder;
+				size_t pushed = 0ull;
+
+				while (decoder.ReadHeader(stream.size(), s_pakHeaderSize) == 0ull && pushed < stream.size())
+				{
+					const size_t slice = std::min<size_t>(stream.size() - pushed, 4ull << 20);
+					decoder.PushInput(stream.data() + pushed, slice);
+					pushed += slice;
+				}
+
+				output.assign(decoder.DecodedSize() + CPakDecoder::s_outputPadding, 0);
+				decoder.SetOutput(output.data(), output.size());
+
+				CPakDecoder::eStatus status = CPakDecoder::eStatus::NEED_INPUT;
+				while ((status = decoder.Decode()) == CPakDecoder::eStatus::NEED_INPUT && pushed < stream.size())
+				{
+					const size_t slice = std::min<size_t>(stream.size() - pushed, 4ull << 20);
+					decoder.PushInput(stream.data() + pushed, slice);
+					pushed += slice;
+				}
+
+				slicedOk &= status == CPakDecoder::eStatus::DONE;
+				output.resize(decoder.DecodedSize());
+			});
+		slicedOk &= DecodedEquals(output, s_pakHeaderSize, plain);
+
+		SELFTEST_CHECK(ctx, referenceOk);
+		SELFTEST_CHECK(ctx, inPlaceOk);
+		SELFTEST_CHECK(ctx, slicedOk);
+
+		ctx.Metric(std::format("{} compressed", bench.name), static_cast<double>(stream.size()) / (1024.0 * 1024.0), "MiB");
+		ctx.Metric(std::format("{} reference", bench.name), decodedMB / (static_cast<double>(referenceNs) / 1e9), "MiB/s");
+		ctx.Metric(std::format("{} in place", bench.name), decodedMB / (static_cast<double>(inPlaceNs) / 1e9), "MiB/s");
+		ctx.Metric(std::format("{} 4MB slices", bench.name), decodedMB / (static_cast<double>(slicedNs) / 1e9), "MiB/s");
+	}
+}
+
+REGISTER_BENCHMARK("pak.lzdecode", Benchmark_PakLzDecode);
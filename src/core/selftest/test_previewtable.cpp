@@ -0,0 +1,295 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/ui/previewtable.h>
+#include <thirdparty/imgui/imgui_internal.h>
+
+// an imgui context of its own with no renderer behind it, frames are built through to draw data so they cost what the tool pays before the gpu
+class CPreviewFrameHarness
+{
+public:
+	CPreviewFrameHarness() : m_previous(ImGui::GetCurrentContext()), m_context(ImGui::CreateContext())
+	{
+		ImGui::SetCurrentContext(m_context);
+
+		ImGuiIO& io = ImGui::GetIO();
+		io.IniFilename = nullptr;
+		io.DisplaySize = ImVec2(1600.0f, 900.0f);
+		io.DeltaTime = 1.0f / 60.0f;
+		io.Fonts->Build();
+	}
+
+	~CPreviewFrameHarness()
+	{
+		ImGui::DestroyContext(m_context);
+		ImGui::SetCurrentContext(m_previous);
+	}
+
+	CPreviewFrameHarness(const CPreviewFrameHarness&) = delete;
+	CPreviewFrameHarness& operator=(const CPreviewFrameHarness&) = delete;
+
+	template <class DrawFn>
+	void Frame(const DrawFn& draw)
+	{
+		ImGui::NewFrame();
+
+		ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+		ImGui::SetNextWindowSize(ImGui::GetIO().DisplaySize);
+
+		if (ImGui::Begin("Preview", nullptr, ImGuiWindowFlags_NoDecoration))
+			draw();
+
+		ImGui::End();
+		ImGui::Render();
+	}
+
+	// as if the header of a column was clicked, the table is the only one the context has seen
+	void SetSort(const int column, const ImGuiSortDirection direction)
+	{
+		ImGuiContext& g = *GImGui;
+
+		g.CurrentTable = g.Tables.GetByIndex(0);
+		ImGui::TableSetColumnSortDirection(column, direction, false);
+		g.CurrentTable = nullptr;
+	}
+
+private:
+	ImGuiContext* const m_previous;
+	ImGuiContext* const m_context;
+};
+
+static void FillSortTestTable(CPreviewTable& table, std::mt19937_64& rng, std::vector<double>& values, const size_t numRows)
+{
+	table.Reset(numRows);
+	table.AddColumn("Value", ePreviewColumnSort::NUMBER);
+	table.AddColumn("Name", ePreviewColumnSort::TEXT);
+
+	values.clear();
+	for (size_t i = 0; i < numRows; i++)
+	{
+		const double value = static_cast<double>(rng() % 100000ull);
+		values.push_back(value);
+
+		table.AddCellFormat(value, "{}", value);
+		table.AddCellFormat(0.0, "row_{}", i);
+	}
+}
+
+static const bool SortedDescending(const CPreviewTable& table, const std::vector<double>& values)
+{
+	const std::vector<uint32_t>& rows = table.VisibleRows();
+
+	if (rows.size() != values.size())
+		return false;
+
+	for (size_t i = 1; i < rows.size(); i++)
+	{
+		if (values[rows[i - 1]] < values[rows[i]])
+			return false;
+	}
+
+	return true;
+}
+
+// the sort picked for one asset holds for the next one shown in the same table, imgui doesn't flag its specs dirty for new rows
+static void SelfTest_PreviewTableSort(CSelfTestContext& ctx)
+{
+	CPreviewFrameHarness harness;
+	CPreviewTable table;
+
+	std::vector<double> values;
+	FillSortTestTable(table, ctx.Rng(), values, 500ull);
+
+	const auto draw = [&table]() { table.Draw("SortTest", ImVec2(0.0f, 0.0f)); };
+
+	harness.Frame(draw);
+
+	// unsorted, rows as added
+	SELFTEST_CHECK(ctx, table.VisibleRows().size() == 500ull && table.VisibleRows()[1] == 1u);
+
+	harness.SetSort(0, ImGuiSortDirection_Descending);
+	harness.Frame(draw);
+
+	SELFTEST_CHECK(ctx, SortedDescending(table, values));
+
+	// another asset selected
+	FillSortTestTable(table, ctx.Rng(), values, 300ull);
+	harness.Frame(draw);
+
+	SELFTEST_CHECK(ctx, SortedDescending(table, values));
+
+	// and back to the order rows were added in
+	harness.SetSort(0, ImGuiSortDirection_None);
+	harness.Frame(draw);
+
+	SELFTEST_CHECK(ctx, table.VisibleRows().size() == 300ull && table.VisibleRows()[299] == 299u);
+}
+
+REGISTER_SELFTEST("ui.previewtable.sort", SelfTest_PreviewTableSort);
+
+// a datatable like table: int, float, vector, string and bool columns
+struct PreviewBenchRow_t
+{
+	int integer;
+	float number;
+	Vector vec;
+	const char* text;
+	bool flag;
+};
+
+static constexpr int s_previewBenchColumns = 12;
+
+// the preview before it was virtualized, every cell of every row submitted and formatted every frame
+static void DrawPreviewTableReference(const std::vector<PreviewBenchRow_t>& rows)
+{
+	constexpr ImGuiTableFlags tableFlags =
+		ImGuiTableFlags_Resizable | ImGuiTableFlags_Hideable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders
+		| ImGuiTableFlags_ScrollY | ImGuiTableFlags_ScrollX | ImGuiTableFlags_SizingFixedFit;
+
+	if (ImGui::BeginTable("Datatable", s_previewBenchColumns, tableFlags, ImVec2(0.0f, 0.0f)))
+	{
+		for (int i = 0; i < s_previewBenchColumns; i++)
+			ImGui::TableSetupColumn(std::format("column_{}", i).c_str(), ImGuiTableColumnFlags_NoResize | ImGuiTableColumnFlags_WidthFixed, 0.0f, i);
+
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableHeadersRow();
+
+		for (int i = 0; i < static_cast<int>(rows.size()); i++)
+		{
+			ImGui::PushID(i);
+			ImGui::TableNextRow(ImGuiTableRowFlags_None, 0.0f);
+
+			const PreviewBenchRow_t& row = rows[i];
+
+			for (int j = 0; j < s_previewBenchColumns; j++)
+			{
+				if (!ImGui::TableSetColumnIndex(j))
+					continue;
+
+				switch (j % 5)
+				{
+				case 0:
+					ImGui::Text("%i", row.integer);
+					break;
+				case 1:
+					ImGui::Text("%f", row.number);
+					break;
+				case 2:
+					ImGui::Text("%f, %f, %f", row.vec.x, row.vec.y, row.vec.z);
+					break;
+				case 3:
+					ImGui::TextUnformatted(row.text);
+					break;
+				default:
+					ImGui::TextUnformatted(row.flag ? "true" : "false");
+					break;
+				}
+			}
+
+			ImGui::PopID();
+		}
+
+		ImGui::EndTable();
+	}
+}
+
+static void BuildPreviewBenchTable(CPreviewTable& table, const std::vector<PreviewBenchRow_t>& rows)
+{
+	static constexpr ePreviewColumnSort s_sorts[5] = { ePreviewColumnSort::NUMBER, ePreviewColumnSort::NUMBER, ePreviewColumnSort::NONE, ePreviewColumnSort::TEXT, ePreviewColumnSort::NUMBER };
+
+	table.Reset(rows.size());
+
+	for (int i = 0; i < s_previewBenchColumns; i++)
+		table.AddColumn(std::format("column_{}", i).c_str(), s_sorts[i % 5]);
+
+	for (const PreviewBenchRow_t& row : rows)
+	{
+		for (int j = 0; j < s_previewBenchColumns; j++)
+		{
+			switch (j % 5)
+			{
+			case 0:
+				table.AddCellFormat(static_cast<double>(row.integer), "{}", row.integer);
+				break;
+			case 1:
+				table.AddCellFormat(static_cast<double>(row.number), "{:f}", row.number);
+				break;
+			case 2:
+				table.AddCellFormat(0.0, "{:f}, {:f}, {:f}", row.vec.x, row.vec.y, row.vec.z);
+				break;
+			case 3:
+				table.AddCell(row.text);
+				break;
+			default:
+				table.AddCell(row.flag ? "true" : "false", row.flag ? 1.0 : 0.0);
+				break;
+			}
+		}
+	}
+}
+
+// per frame cost of a large datatable preview, the old every cell submission against the virtualized table
+static void Benchmark_PreviewTable(CSelfTestContext& ctx)
+{
+	const size_t numRows = 50000ull * ctx.Scale();
+
+	std::mt19937_64& rng = ctx.Rng();
+
+	std::vector<std::string> names;
+	for (uint32_t i = 0; i < 1024u; i++)
+		names.emplace_back(std::format("weapon_{}_mod_{}", rng() % 4096ull, i));
+
+	std::vector<PreviewBenchRow_t> rows(numRows);
+	for (PreviewBenchRow_t& row : rows)
+	{
+		row.integer = static_cast<int>(rng() % 100000ull) - 50000;
+		row.number = static_cast<float>(rng() % 1000000ull) * 0.001f;
+		row.vec = Vector(static_cast<float>(rng() % 1000ull), static_cast<float>(rng() % 1000ull), static_cast<float>(rng() % 1000ull));
+		row.text = names[rng() % names.size()].c_str();
+		row.flag = (rng() & 1ull) != 0ull;
+	}
+
+	int64_t referenceNs = 0ll;
+	{
+		CPreviewFrameHarness referenceHarness;
+		referenceNs = SelfTestTimeBest(3u, [&]() { referenceHarness.Frame([&rows]() { DrawPreviewTableReference(rows); }); });
+	}
+
+	CPreviewTable table;
+	const int64_t buildNs = SelfTestTimeBest(3u, [&]() { BuildPreviewBenchTable(table, rows); });
+
+	// its own context, the sort is set on the first table a context has
+	CPreviewFrameHarness harness;
+	const auto draw = [&table]() { table.Draw("Datatable", ImVec2(0.0f, 0.0f)); };
+
+	// the first frame after a build sorts and filters
+	harness.Frame(draw);
+
+	constexpr uint32_t framesPerRun = 100u;
+	const int64_t tableNs = SelfTestTimeBest(3u, [&]()
+		{
+			for (uint32_t i = 0; i < framesPerRun; i++)
+				harness.Frame(draw);
+		});
+
+	// a header click on the text column, the frame it lands on sorts every row
+	ImGuiSortDirection direction = ImGuiSortDirection_Ascending;
+	const int64_t sortFrameNs = SelfTestTimeBest(3u, [&]()
+		{
+			harness.SetSort(3, direction);
+			harness.Frame(draw);
+
+			direction = direction == ImGuiSortDirection_Ascending ? ImGuiSortDirection_Descending : ImGuiSortDirection_Ascending;
+		});
+
+	SELFTEST_CHECK(ctx, table.VisibleRows().size() == numRows);
+
+	ctx.Metric("rows", static_cast<double>(numRows), "");
+	ctx.Metric("columns", static_cast<double>(s_previewBenchColumns), "");
+	ctx.Metric("every cell, per frame", static_cast<double>(referenceNs) / 1e6, "ms");
+	ctx.Metric("table build, once per asset", static_cast<double>(buildNs) / 1e6, "ms");
+	ctx.Metric("table, per frame", static_cast<double>(tableNs) / (1e6 * framesPerRun), "ms");
+	ctx.Metric("table, frame with a text sort", static_cast<double>(sortFrameNs) / 1e6, "ms");
+}
+
+REGISTER_BENCHMARK("ui.previewtable", Benchmark_PreviewTable);
@@ -0,0 +1,394 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+// partly repetitive so the codecs have something to do, the same index always gives the same bytes
+static void FillNoodleData(char* const buf, const size_t size, const uint32_t idx)
+{
+	uint64_t state = (idx + 1ull) * 0x9E3779B97F4A7C15ull;
+	for (size_t i = 0; i < size; ++i)
+	{
+		if ((i & 63) == 0)
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+		buf[i] = static_cast<char>((i & 32) ? (state >> 56) : (state >> ((i & 7) * 8)));
+	}
+}
+
+static const bool NoodleMatches(const std::unique_ptr<char[]>& data, const size_t size, const uint32_t idx)
+{
+	if (!data)
+		return false;
+
+	std::unique_ptr<char[]> expected = std::make_unique<char[]>(size);
+	FillNoodleData(expected.get(), size, idx);
+
+	return memcmp(data.get(), expected.get(), size) == 0;
+}
+
+// settings are global, put them back however the test ends
+class CRamenSettingsScope
+{
+public:
+	CRamenSettingsScope(const uint32_t budgetMB, const uint32_t cacheMB) : m_saved(g_RamenSettings)
+	{
+		g_RamenSettings.codec = eRamenCodec::SELKIE;
+		g_RamenSettings.level = CRamen::DefaultCodecLevel(eRamenCodec::SELKIE);
+		g_RamenSettings.budgetMB = budgetMB;
+		g_RamenSettings.cacheMB = cacheMB;
+		g_RamenSettings.spill = true;
+	}
+
+	~CRamenSettingsScope()
+	{
+		g_RamenSettings = m_saved;
+	}
+
+private:
+	RamenSettings_t m_saved;
+};
+
+static void SelfTest_RamenSpill(CSelfTestContext& ctx)
+{
+	constexpr size_t noodleSize = 256ull * 1024ull;
+	constexpr uint32_t noodleCount = 64u;
+	constexpr uint64_t budget = 2ull * 1024ull * 1024ull;
+
+	CRamenSettingsScope settings(static_cast<uint32_t>(budget >> 20), 0u);
+	const RamenStats_t before = CRamen::GetStats();
+
+	std::unique_ptr<char[]> buf = std::make_unique<char[]>(noodleSize);
+	{
+		CRamen ramen;
+		for (uint32_t i = 0; i < noodleCount; ++i)
+		{
+			FillNoodleData(buf.get(), noodleSize, i);
+			ramen.addBack(buf.get(), noodleSize);
+		}
+
+		const RamenStats_t added = CRamen::GetStats();
+		if (added.spillFailed)
+		{
+			ctx.Fail("spill file couldn't be created");
+			return;
+		}
+
+		SELFTEST_CHECK(ctx, added.bytesSpilled > before.bytesSpilled);
+		SELFTEST_CHECK(ctx, added.bytesResident - before.bytesResident <= budget);
+
+		// every noodle comes back intact, spilled or not, and stays within the budget after being read back
+		for (uint32_t pass = 0; pass < 2u; ++pass)
+		{
+			for (uint32_t i = 0; i < noodleCount; ++i)
+				SELFTEST_CHECK(ctx, NoodleMatches(ramen.getIdx(i), noodleSize, i));
+		}
+
+		const RamenStats_t read = CRamen::GetStats();
+		SELFTEST_CHECK(ctx, read.spillReads > added.spillReads);
+		SELFTEST_CHECK(ctx, read.bytesResident - before.bytesResident <= budget);
+
+		// read back noodles keep their one range in the file, spilling them again doesn't append another copy
+		SELFTEST_CHECK(ctx, read.spillFileBytes - before.spillFileBytes <= (read.bytesResident + read.bytesSpilled) - (before.bytesResident + before.bytesSpilled));
+
+		// the budget is also enforced when it is lowered after the noodles were added
+		g_RamenSettings.budgetMB = 1u;
+		for (uint32_t i = 0; i < noodleCount; ++i)
+			SELFTEST_CHECK(ctx, NoodleMatches(ramen.getIdx(i), noodleSize, i));
+
+		SELFTEST_CHECK(ctx, CRamen::GetStats().bytesResident - before.bytesResident <= 1024ull * 1024ull);
+	}
+
+	const RamenStats_t cleared = CRamen::GetStats();
+	SELFTEST_CHECK(ctx, cleared.noodles == before.noodles);
+	SELFTEST_CHECK(ctx, cleared.bytesSpilled == before.bytesSpilled);
+	SELFTEST_CHECK(ctx, cleared.spillFileBytes <= before.spillFileBytes);
+}
+
+static void SelfTest_RamenSpillReuse(CSelfTestContext& ctx)
+{
+	constexpr size_t noodleSize = 128ull * 1024ull;
+
+	CRamenSettingsScope settings(1u, 0u);
+	const RamenStats_t before = CRamen::GetStats();
+
+	std::unique_ptr<char[]> buf = std::make_unique<char[]>(noodleSize);
+
+	// a long lived set of noodles with short lived ones coming and going, like paks being loaded and unloaded
+	CRamen longLived;
+	for (uint32_t i = 0; i < 32u; ++i)
+	{
+		FillNoodleData(buf.get(), noodleSize, i);
+		longLived.addBack(buf.get(), noodleSize);
+	}
+
+	std::mt19937_64& rng = ctx.Rng();
+
+	uint64_t highWater = 0ull;
+	for (uint32_t round = 0; round < 50u; ++round)
+	{
+		CRamen shortLived;
+		for (uint32_t i = 0; i < 32u; ++i)
+		{
+			const uint32_t idx = 1000u + round * 32u + i;
+
+			const size_t size = noodleSize - (rng() % 4096u);
+
+			FillNoodleData(buf.get(), size, idx);
+			shortLived.addBack(buf.get(), size);
+		}
+
+		highWater = std::max(highWater, CRamen::GetStats().spillFileBytes);
+	}
+
+	// freed ranges are reused, the file doesn't grow with every round
+	SELFTEST_CHECK(ctx, highWater - before.spillFileBytes < 3ull * 64ull * noodleSize);
+
+	for (uint32_t i = 0; i < 32u; ++i)
+		SELFTEST_CHECK(ctx, NoodleMatches(longLived.getIdx(i), noodleSize, i));
+
+	longLived.clear();
+	SELFTEST_CHECK(ctx, CRamen::GetStats().spillFileBytes <= before.spillFileBytes);
+}
+
+REGISTER_SELFTEST("ramen.spill", SelfTest_RamenSpill);
+REGISTER_SELFTEST("ramen.spillreuse", SelfTest_RamenSpillReuse);
+
+// concurrent reads of different noodles, which all went through one lock before the store was sharded
+static void Benchmark_RamenAccess(CSelfTestContext& ctx)
+{
+	constexpr size_t noodleSize = 64ull * 1024ull;
+	const uint32_t noodleCount = 512u * ctx.Scale();
+	const uint32_t readsPerThread = 4096u * ctx.Scale();
+
+	CRamenSettingsScope settings(0u, 0u);
+
+	std::unique_ptr<char[]> buf = std::make_unique<char[]>(noodleSize);
+
+	CRamen ramen;
+	for (uint32_t i = 0; i < noodleCount; ++i)
+	{
+		FillNoodleData(buf.get(), noodleSize, i);
+		ramen.addBack(buf.get(), noodleSize);
+	}
+
+	const auto readAll = [&](const uint32_t threadCount)
+		{
+			std::atomic<uint32_t> failed = 0u;
+
+			const int64_t ns = SelfTestTimeBest(3u, [&]()
+				{
+					std::atomic<uint32_t> threadIdx = 0u;
+
+					CParallelTask parallelTask(threadCount);
+					parallelTask.addTask([&]()
+						{
+							uint64_t state = (++threadIdx) * 0x9E3779B97F4A7C15ull;
+							for (uint32_t i = 0; i < readsPerThread; ++i)
+							{
+								state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+								if (!ramen.getIdx((state >> 33) % noodleCount))
+									failed++;
+							}
+						}, threadCount);
+
+					parallelTask.execute();
+					parallelTask.wait();
+				});
+
+			SELFTEST_CHECK(ctx, failed == 0u);
+
+			return (static_cast<double>(readsPerThread) * threadCount) / (static_cast<double>(ns) / 1e9);
+		};
+
+	const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 2u);
+
+	ctx.Metric("reads/s, 1 thread", readAll(1u), "");
+	ctx.Metric(std::format("reads/s, {} threads", threadCount), readAll(threadCount), "");
+
+	// the same reads with most of the noodles in the spill file
+	// nothing is spilled yet, the reads themselves bring each shard down to the new budget
+	g_RamenSettings.budgetMB = 4u;
+
+	const RamenStats_t before = CRamen::GetStats();
+	ctx.Metric(std::format("reads/s, {} threads, spilled", threadCount), readAll(threadCount), "");
+
+	const RamenStats_t after = CRamen::GetStats();
+	ctx.Metric("spill reads", static_cast<double>(after.spillReads - before.spillReads), "");
+	ctx.Metric("spill file", static_cast<double>(after.spillFileBytes) / (1024.0 * 1024.0), "MiB");
+}
+
+REGISTER_BENCHMARK("ramen.access", Benchmark_RamenAccess);
+
+// parsed vertex data as a model holds it: position, packed normal, uv, and bone weights and indices
+struct RamenBenchVertex_t
+{
+	float position[3];
+	uint32_t normal;
+	float uv[2];
+	uint8_t weights[4];
+	uint8_t bones[4];
+};
+
+// a smooth surface, neighbouring vertices are close in position, normal and uv and share their bones
+static std::vector<char> RamenBenchVertices(const size_t numVertices)
+{
+	const size_t width = 256ull;
+
+	std::vector<char> data(numVertices * sizeof(RamenBenchVertex_t));
+	RamenBenchVertex_t* const vertices = reinterpret_cast<RamenBenchVertex_t*>(data.data());
+
+	for (size_t i = 0; i < numVertices; i++)
+	{
+		const float x = static_cast<float>(i % width);
+		const float y = static_cast<float>(i / width);
+		const float height = sinf(x * 0.05f) * cosf(y * 0.07f) * 12.0f;
+
+		RamenBenchVertex_t& vertex = vertices[i];
+		vertex.position[0] = x * 0.5f;
+		vertex.position[1] = y * 0.5f;
+		vertex.position[2] = height;
+
+		const uint32_t nx = static_cast<uint32_t>((cosf(x * 0.05f) * 0.5f + 0.5f) * 1023.0f);
+		const uint32_t ny = static_cast<uint32_t>((sinf(y * 0.07f) * 0.5f + 0.5f) * 1023.0f);
+		vertex.normal = nx | (ny << 10) | (1u << 30);
+
+		vertex.uv[0] = x / static_cast<float>(width);
+		vertex.uv[1] = y / static_cast<float>(width);
+
+		const uint8_t bone = static_cast<uint8_t>((i / width) / 16ull);
+		const uint8_t blend = static_cast<uint8_t>(((i / width) % 16ull) * 16ull);
+
+		vertex.weights[0] = static_cast<uint8_t>(255u - blend);
+		vertex.weights[1] = blend;
+		vertex.weights[2] = 0u;
+		vertex.weights[3] = 0u;
+
+		vertex.bones[0] = bone;
+		vertex.bones[1] = static_cast<uint8_t>(bone + 1u);
+		vertex.bones[2] = 0u;
+		vertex.bones[3] = 0u;
+	}
+
+	return data;
+}
+
+// a decoded animation track per bone: rotation, translation and scale for every frame
+struct RamenBenchBoneFrame_t
+{
+	float rotation[4];
+	float translation[3];
+	float scale;
+};
+
+// frames move a little from one to the next, a third of the bones don't move at all and none of them scale
+static std::vector<char> RamenBenchAnimation(const size_t numFrames, const size_t numBones)
+{
+	std::vector<char> data(numFrames * numBones * sizeof(RamenBenchBoneFrame_t));
+	RamenBenchBoneFrame_t* const frames = reinterpret_cast<RamenBenchBoneFrame_t*>(data.data());
+
+	for (size_t bone = 0; bone < numBones; bone++)
+	{
+		const float phase = static_cast<float>(bone) * 0.37f;
+		const bool animated = (bone % 3ull) != 0ull;
+
+		for (size_t frame = 0; frame < numFrames; frame++)
+		{
+			const float t = animated ? static_cast<float>(frame) * 0.03f + phase : phase;
+			const float angle = sinf(t) * 0.5f;
+
+			RamenBenchBoneFrame_t& out = frames[bone * numFrames + frame];
+			out.rotation[0] = 0.0f;
+			out.rotation[1] = sinf(angle);
+			out.rotation[2] = 0.0f;
+			out.rotation[3] = cosf(angle);
+
+			out.translation[0] = static_cast<float>(bone) * 2.0f;
+			out.translation[1] = animated ? cosf(t) * 0.25f : 0.0f;
+			out.translation[2] = 0.0f;
+
+			out.scale = 1.0f;
+		}
+	}
+
+	return data;
+}
+
+// compression ratio against encode and decode speed for each codec, over the kinds of data parsed assets keep in noodles
+static void Benchmark_RamenCodecs(CSelfTestContext& ctx)
+{
+	constexpr size_t noodleSize = 256ull * 1024ull;
+	static const char* const s_codecNames[] = { "none", "selkie", "kraken", "leviathan", "zstd" };
+	static_assert(ARRSIZE(s_codecNames) == static_cast<size_t>(eRamenCodec::_COUNT));
+
+	CRamenSettingsScope settings(0u, 0u);
+
+	const std::pair<const char*, std::vector<char>> payloads[] = {
+		{ "vertices", RamenBenchVertices(131072ull * ctx.Scale()) },
+		{ "animation", RamenBenchAnimation(1024ull * ctx.Scale(), 128ull) },
+	};
+
+	for (const auto& [payloadName, payload] : payloads)
+	{
+		const size_t numNoodles = (payload.size() + noodleSize - 1ull) / noodleSize;
+		const double payloadMiB = static_cast<double>(payload.size()) / (1024.0 * 1024.0);
+
+		ctx.Metric(std::format("{} payload", payloadName), payloadMiB, "MiB");
+
+		for (uint8_t i = 0; i < static_cast<uint8_t>(eRamenCodec::_COUNT); i++)
+		{
+			const eRamenCodec codec = static_cast<eRamenCodec>(i);
+
+			g_RamenSettings.codec = codec;
+			g_RamenSettings.level = CRamen::DefaultCodecLevel(codec);
+
+			// the last run's noodles are kept for the reads, the previous ones are freed outside the timed part
+			CRamen ramen;
+			uint64_t storedBytes = 0ull;
+			int64_t encodeNs = INT64_MAX;
+
+			for (uint32_t run = 0; run < 3u; run++)
+			{
+				CRamen added;
+				const uint64_t residentBefore = CRamen::GetStats().bytesResident;
+
+				const auto start = std::chrono::high_resolution_clock::now();
+
+				for (size_t n = 0; n < numNoodles; n++)
+				{
+					const size_t offset = n * noodleSize;
+					added.addBack(const_cast<char*>(payload.data()) + offset, std::min(noodleSize, payload.size() - offset));
+				}
+
+				encodeNs = std::min(encodeNs, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count()));
+				storedBytes = CRamen::GetStats().bytesResident - residentBefore;
+
+				ramen.move(added);
+			}
+
+			// the decompressed cache is off, every read decodes
+			const int64_t decodeNs = SelfTestTimeBest(3u, [&]()
+				{
+					for (size_t n = 0; n < numNoodles; n++)
+						ramen.getIdx(n);
+				});
+
+			bool intact = true;
+			for (size_t n = 0; n < numNoodles; n++)
+			{
+				const size_t offset = n * noodleSize;
+				const std::unique_ptr<char[]> data = ramen.getIdx(n);
+
+				intact &= data && memcmp(data.get(), payload.data() + offset, std::min(noodleSize, payload.size() - offset)) == 0;
+			}
+
+			SELFTEST_CHECK(ctx, intact);
+
+			const std::string name = std::format("{}, {}", payloadName, s_codecNames[i]);
+			ctx.Metric(name + ", ratio", (static_cast<double>(storedBytes) / static_cast<double>(payload.size())) * 100.0, "%");
+			ctx.Metric(name + ", encode", payloadMiB / (static_cast<double>(encodeNs) / 1e9), "MiB/s");
+			ctx.Metric(name + ", decode", payloadMiB / (static_cast<double>(decodeNs) / 1e9), "MiB/s");
+		}
+	}
+}
+
+REGISTER_BENCHMARK("ramen.codecs", Benchmark_RamenCodecs);
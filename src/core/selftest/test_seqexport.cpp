@@ -0,0 +1,321 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/mdl/modeldata.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
+
+// a rig and its sequences as the parsers leave them: bone and animdesc records in one block with their names after them, parsed frames in each sequence's ramen
+struct SyntheticSeqSet_t
+{
+	std::vector<char> studio;
+	std::vector<ModelBone_t> bones;
+	std::vector<std::unique_ptr<seqdesc_t>> seqs;
+	size_t frames;
+};
+
+static void MakeSyntheticSeqSet(SyntheticSeqSet_t& set, std::mt19937_64& rng, const int boneCount, const int numSeqs)
+{
+	const size_t animOffset = sizeof(r2::mstudiobone_t) * boneCount;
+	set.studio.assign(animOffset + sizeof(r2::mstudioanimdesc_t) * numSeqs, 0);
+
+	const auto addString = [&set](const std::string& str)
+		{
+			const size_t offset = set.studio.size();
+			set.studio.insert(set.studio.end(), str.begin(), str.end());
+			set.studio.emplace_back('\0');
+
+			return offset;
+		};
+
+	set.bones.reserve(boneCount);
+
+	std::vector<size_t> boneNames;
+	for (int i = 0; i < boneCount; ++i)
+		boneNames.emplace_back(addString(std::format("def_bone_{}", i)));
+
+	std::vector<size_t> seqNames;
+	for (int i = 0; i < numSeqs; ++i)
+		seqNames.emplace_back(addString(std::format("synthetic_seq_{}", i)));
+
+	// names are in, the records don't move any more
+	for (int i = 0; i < boneCount; ++i)
+	{
+		r2::mstudiobone_t* const bone = reinterpret_cast<r2::mstudiobone_t*>(set.studio.data()) + i;
+		bone->sznameindex = static_cast<int>(boneNames[i] - (sizeof(r2::mstudiobone_t) * i));
+		bone->parent = i - 1 - static_cast<int>(i > 4 ? rng() % 4ull : 0ull); // short chains off a spine
+		bone->pos = Vector(static_cast<float>(rng() % 16ull), 0.0f, 2.0f);
+		bone->rot = RadianEuler(0.0f, 0.0f, static_cast<float>(rng() % 628ull) * 0.01f);
+		bone->quat = Quaternion(bone->rot);
+		bone->scale = Vector(1.0f);
+
+		set.bones.emplace_back(bone);
+	}
+
+	set.frames = 0ull;
+
+	std::vector<char> noodle;
+	for (int i = 0; i < numSeqs; ++i)
+	{
+		const size_t descOffset = animOffset + sizeof(r2::mstudioanimdesc_t) * i;
+		r2::mstudioanimdesc_t* const desc = reinterpret_cast<r2::mstudioanimdesc_t*>(set.studio.data() + descOffset);
+
+		const int numFrames = 30 + static_cast<int>(rng() % 91ull);
+		const bool hasScale = (rng() % 8ull) == 0ull;
+
+		desc->sznameindex = static_cast<int>(seqNames[i] - descOffset);
+		desc->fps = 30.0f;
+		desc->flags = (rng() % 4ull) == 0ull ? eStudioAnimFlags::ANIM_DELTA : eStudioAnimFlags::ANIM_LOOPING;
+		desc->numframes = numFrames;
+
+		std::unique_ptr<seqdesc_t> seq = std::make_unique<seqdesc_t>();
+		seq->baseptr = nullptr;
+		seq->szlabel = desc->pszName();
+		seq->szactivityname = "";
+		seq->flags = hasScale ? 0x20000 : 0;
+		seq->weightlistindex = 3; // all ones
+
+		animdesc_t& animdesc = seq->anims.emplace_back(desc);
+
+		// smooth curves, with a share of bones that hold still so key reduction has something to drop
+		CAnimData animData(boneCount, numFrames);
+		animData.ReserveVector();
+
+		for (int bone = 0; bone < boneCount; ++bone)
+		{
+			const uint64_t kind = rng() % 4ull;
+			const float freq = 0.05f + static_cast<float>(rng() % 100ull) * 0.002f;
+
+			CAnimDataBone& animBone = animData.GetBone(bone);
+			animBone.SetFlags(static_cast<uint8_t>(CAnimDataBone::ANIMDATA_ROT | (kind == 0ull ? CAnimDataBone::ANIMDATA_POS : 0) | (hasScale ? CAnimDataBone::ANIMDATA_SCL : 0)));
+
+			for (int frame = 0; frame < numFrames; ++frame)
+			{
+				const float t = kind == 3ull ? 0.0f : static_cast<float>(frame) * freq;
+				const Vector pos(set.bones[bone].pos.x + sinf(t) * 4.0f, set.bones[bone].pos.y, set.bones[bone].pos.z + cosf(t));
+
+				animBone.SetFrame(frame, pos, Quaternion(RadianEuler(sinf(t) * 0.5f, cosf(t * 0.5f) * 0.25f, set.bones[bone].rot.z)), Vector(1.0f + sinf(t) * 0.1f));
+			}
+		}
+
+		noodle.resize(16ull + (sizeof(size_t) + 1ull + 32ull) * boneCount + (sizeof(Vector) * 2ull + sizeof(Quaternion)) * boneCount * numFrames);
+		animdesc.parsedBufferIndex = seq->parsedData.addBack(noodle.data(), animData.ToMemory(noodle.data()));
+
+		set.frames += static_cast<size_t>(numFrames);
+		set.seqs.emplace_back(std::move(seq));
+	}
+}
+
+// the export thread count is a global setting, put it back however the test ends
+class CExportThreadCountScope
+{
+public:
+	CExportThreadCountScope(const uint32_t threadCount) : m_saved(UtilsConfig->exportThreadCount)
+	{
+		UtilsConfig->exportThreadCount = threadCount;
+	}
+
+	~CExportThreadCountScope()
+	{
+		UtilsConfig->exportThreadCount = m_saved;
+	}
+
+private:
+	uint32_t m_saved;
+};
+
+// called from an export thread every sequence runs on that thread, from anywhere else they are spread over the export threads
+static void SelfTest_SeqExportNested(CSelfTestContext& ctx)
+{
+	constexpr uint32_t numSeqs = 64u;
+	constexpr uint32_t workers = 4u;
+
+	CExportThreadCountScope threadCount(workers);
+
+	std::mutex mutex;
+	std::unordered_set<std::thread::id> threads;
+	std::atomic<uint32_t> exported = 0u;
+
+	const auto exportSeq = [&](const uint32_t seqIdx, SeqExportScratch_t& scratch)
+		{
+			UNUSED(seqIdx);
+			UNUSED(scratch);
+
+			std::unique_lock<std::mutex> lock(mutex);
+			threads.insert(std::this_thread::get_id());
+			++exported;
+		};
+
+	// an asset list export, each worker exporting the sequences of one model
+	CParallelTask task(workers);
+	task.addTask([&exportSeq]()
+		{
+			ExportSequencesParallel(numSeqs, exportSeq);
+		}, workers);
+
+	task.execute();
+	task.wait();
+
+	SELFTEST_CHECK(ctx, exported == numSeqs * workers);
+	SELFTEST_CHECK(ctx, threads.size() <= workers);
+
+	// a single model exported from any other thread still fans out, and never onto the calling thread
+	threads.clear();
+	exported = 0u;
+
+	ExportSequencesParallel(numSeqs, exportSeq);
+
+	SELFTEST_CHECK(ctx, exported == numSeqs);
+	SELFTEST_CHECK(ctx, !threads.contains(std::this_thread::get_id()));
+}
+
+REGISTER_SELFTEST("model.seqexport.nested", SelfTest_SeqExportNested);
+
+// exporting one rig's sequences: one at a time with the skeleton and output buffers set up again for each, as the old per sequence export did,
+// against the skeleton built once and shared by threads that each keep their buffers
+static void Benchmark_SeqExport(CSelfTestContext& ctx)
+{
+	const int boneCount = 128;
+	const int numSeqs = 250 * static_cast<int>(ctx.Scale());
+
+	SyntheticSeqSet_t set;
+	MakeSyntheticSeqSet(set, ctx.Rng(), boneCount, numSeqs);
+
+	const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 2u);
+
+	ctx.Metric("bones", static_cast<double>(boneCount), "");
+	ctx.Metric("sequences", static_cast<double>(numSeqs), "");
+	ctx.Metric("frames", static_cast<double>(set.frames), "");
+
+	static constexpr std::pair<int, const char*> s_formats[] = { { eAnimSeqExportSetting::ANIMSEQ_CAST, "cast" }, { eAnimSeqExportSetting::ANIMSEQ_SMD, "smd" } };
+
+	for (const auto& [formatSetting, formatName] : s_formats)
+	{
+		const int setting = formatSetting; // lambdas can't capture a structured binding
+		const std::filesystem::path dir = ctx.TempDirectory() / formatName;
+		std::filesystem::create_directories(dir);
+
+		const auto exportSeq = [&set, &dir, setting](const uint32_t seqIdx, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch)
+			{
+				const seqdesc_t* const seqdesc = set.seqs[seqIdx].get();
+
+				std::filesystem::path seqPath(dir / "temp");
+				seqPath.replace_filename(seqdesc->szlabel);
+
+				return ExportSeqDesc(setting, seqdesc, seqPath, skeleton, scratch, RTech::StringToGuid(seqdesc->szlabel));
+			};
+
+		uint32_t failed = 0u;
+		const int64_t perSeqNs = SelfTestTimeBest(2u, [&]()
+			{
+				for (int i = 0; i < numSeqs; ++i)
+				{
+					const SeqExportSkeleton_t skeleton(&set.bones);
+					SeqExportScratch_t scratch;
+
+					failed += !exportSeq(static_cast<uint32_t>(i), skeleton, scratch);
+				}
+			});
+
+		const auto sharedExport = [&](const uint32_t workers)
+			{
+				CExportThreadCountScope threadCountScope(workers);
+
+				const SeqExportSkeleton_t skeleton(&set.bones);
+
+				std::atomic<uint32_t> sharedFailed = 0u;
+				ExportSequencesParallel(static_cast<uint32_t>(numSeqs), [&](const uint32_t seqIdx, SeqExportScratch_t& scratch)
+					{
+						sharedFailed += !exportSeq(seqIdx, skeleton, scratch);
+					});
+
+				failed += sharedFailed;
+			};
+
+		const int64_t sharedNs = SelfTestTimeBest(2u, [&]() { sharedExport(1u); });
+		const int64_t parallelNs = SelfTestTimeBest(2u, [&]() { sharedExport(threadCount); });
+
+		SELFTEST_CHECK(ctx, failed == 0u);
+
+		// one file per sequence, each only has the one animation
+		size_t files = 0ull;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir))
+			files += entry.is_regular_file();
+
+		SELFTEST_CHECK(ctx, files == static_cast<size_t>(numSeqs));
+
+		ctx.Metric(std::format("{}, per sequence setup", formatName), static_cast<double>(perSeqNs) / 1e6, "ms");
+		ctx.Metric(std::format("{}, shared skeleton, 1 thread", formatName), static_cast<double>(sharedNs) / 1e6, "ms");
+		ctx.Metric(std::format("{}, shared skeleton, {} threads", formatName, threadCount), static_cast<double>(parallelNs) / 1e6, "ms");
+	}
+}
+
+REGISTER_BENCHMARK("model.seqexport", Benchmark_SeqExport);
+
+// the same rig exported with every key and with keys reduced at the export settings' tolerances, files written and time taken
+static void Benchmark_SeqExportKeyReduction(CSelfTestContext& ctx)
+{
+	const int boneCount = 128;
+	const int numSeqs = 150 * static_cast<int>(ctx.Scale());
+
+	SyntheticSeqSet_t set;
+	MakeSyntheticSeqSet(set, ctx.Rng(), boneCount, numSeqs);
+
+	const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 2u);
+	CExportThreadCountScope threadCountScope(threadCount);
+
+	ctx.Metric("sequences", static_cast<double>(numSeqs), "");
+	ctx.Metric("frames", static_cast<double>(set.frames), "");
+
+	static constexpr std::pair<int, const char*> s_formats[] = { { eAnimSeqExportSetting::ANIMSEQ_CAST, "cast" }, { eAnimSeqExportSetting::ANIMSEQ_RMAX, "rmax" }, { eAnimSeqExportSetting::ANIMSEQ_SMD, "smd" } };
+
+	for (const auto& [formatSetting, formatNameBinding] : s_formats)
+	{
+		// lambdas can't capture a structured binding
+		const int setting = formatSetting;
+		const char* const formatName = formatNameBinding;
+
+		const auto exportAll = [&](const bool reduceKeys, uint64_t& bytes)
+			{
+				const std::filesystem::path dir = ctx.TempDirectory() / std::format("{}_{}", formatName, reduceKeys ? "reduced" : "full");
+				std::filesystem::create_directories(dir);
+
+				SeqExportSkeleton_t skeleton(&set.bones);
+				skeleton.reduceKeys = reduceKeys;
+
+				std::atomic<uint32_t> failed = 0u;
+				const int64_t ns = SelfTestTimeBest(2u, [&]()
+					{
+						ExportSequencesParallel(static_cast<uint32_t>(numSeqs), [&](const uint32_t seqIdx, SeqExportScratch_t& scratch)
+							{
+								const seqdesc_t* const seqdesc = set.seqs[seqIdx].get();
+
+								std::filesystem::path seqPath(dir / "temp");
+								seqPath.replace_filename(seqdesc->szlabel);
+
+								failed += !ExportSeqDesc(setting, seqdesc, seqPath, skeleton, scratch, RTech::StringToGuid(seqdesc->szlabel));
+							});
+					});
+
+				SELFTEST_CHECK(ctx, failed == 0u);
+
+				bytes = 0ull;
+				for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dir))
+					bytes += entry.is_regular_file() ? entry.file_size() : 0ull;
+
+				return ns;
+			};
+
+		uint64_t fullBytes = 0ull;
+		uint64_t reducedBytes = 0ull;
+
+		const int64_t fullNs = exportAll(false, fullBytes);
+		const int64_t reducedNs = exportAll(true, reducedBytes);
+
+		ctx.Metric(std::format("{}, every key", formatName), static_cast<double>(fullBytes) / (1024.0 * 1024.0), "MiB");
+		ctx.Metric(std::format("{}, reduced", formatName), static_cast<double>(reducedBytes) / (1024.0 * 1024.0), "MiB");
+		ctx.Metric(std::format("{}, every key", formatName), static_cast<double>(fullNs) / 1e6, "ms");
+		ctx.Metric(std::format("{}, reduced", formatName), static_cast<double>(reducedNs) / 1e6, "ms");
+	}
+}
+
+REGISTER_BENCHMARK("model.seqexport.keyreduce", Benchmark_SeqExportKeyReduction);
@@ -0,0 +1,580 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <game/rtech/cpakfile.h>
+#include <game/rtech/assets/shader.h>
+
+// a pixel shader's dxbc with only what the reflection reads: an rdef with bound resources and constant buffers, and a stand in for the bytecode
+static const std::vector<char> SyntheticShaderDXBC(std::mt19937_64& rng)
+{
+	static constexpr const char* s_textureNames[] = { "albedoTexture", "normalTexture", "glossTexture", "specTexture", "emissiveTexture", "aoTexture", "cavityTexture", "opacityMultiplyTexture",
+		"detailTexture", "detailNormalTexture", "scatterThicknessTexture", "transmittanceTintTexture", "uvDistortionTexture", "uvDistortion2Texture", "emissiveMultiplyTexture", "anisoSpecDirTexture" };
+
+	struct ConstBufferDesc_t
+	{
+		const char* name;
+		uint32_t varCount;
+	};
+
+	const ConstBufferDesc_t constBuffers[] = { { "CBufCommonPerCamera", 12u }, { "CBufUberStatic", 20u + static_cast<uint32_t>(rng() % 40ull) }, { "CBufModelInstance", 8u } };
+	const uint32_t textureCount = 8u + static_cast<uint32_t>(rng() % 9ull);
+	const uint32_t samplerCount = 2u;
+
+	uint32_t varCount = 0u;
+	for (const ConstBufferDesc_t& buffer : constBuffers)
+		varCount += buffer.varCount;
+
+	const uint32_t resourceCount = samplerCount + textureCount + static_cast<uint32_t>(ARRSIZE(constBuffers));
+
+	// rdef tables, then the strings they point at
+	const uint32_t constBufferOffset = sizeof(RDEFBlobHeader);
+	const uint32_t constOffset = constBufferOffset + static_cast<uint32_t>(sizeof(RDefConstBuffer) * ARRSIZE(constBuffers));
+	const uint32_t typeOffset = constOffset + static_cast<uint32_t>(sizeof(RDEFConst) * varCount);
+	const uint32_t resourceOffset = typeOffset + static_cast<uint32_t>(sizeof(RDEFType) * varCount);
+
+	std::vector<char> rdef(resourceOffset + sizeof(RDEFResourceBinding) * resourceCount, 0);
+
+	const auto addString = [&rdef](const std::string& str)
+		{
+			const uint32_t offset = static_cast<uint32_t>(rdef.size());
+			rdef.insert(rdef.end(), str.begin(), str.end());
+			rdef.emplace_back('\0');
+
+			return offset;
+		};
+
+	std::vector<RDEFResourceBinding> resources;
+	for (uint32_t i = 0; i < samplerCount; ++i)
+		resources.push_back({ addString(std::format("sampler{}", i)), D3D_SIT_SAMPLER, {}, {}, 0u, i, 1u, {} });
+
+	for (uint32_t i = 0; i < textureCount; ++i)
+		resources.push_back({ addString(s_textureNames[i % ARRSIZE(s_textureNames)]), D3D_SIT_TEXTURE, D3D_RETURN_TYPE_FLOAT, D3D10_SRV_DIMENSION_TEXTURE2D, UINT32_MAX, i, 1u, {} });
+
+	std::vector<RDefConstBuffer> buffers;
+	std::vector<RDEFConst> consts;
+	std::vector<RDEFType> types;
+
+	for (uint32_t i = 0; i < ARRSIZE(constBuffers); ++i)
+	{
+		const ConstBufferDesc_t& desc = constBuffers[i];
+
+		resources.push_back({ addString(desc.name), D3D_SIT_CBUFFER, {}, {}, 0u, i, 1u, {} });
+		buffers.push_back({ addString(desc.name), desc.varCount, constOffset + static_cast<uint32_t>(sizeof(RDEFConst) * consts.size()), desc.varCount * 16u, D3D10_CT_CBUFFER, {} });
+
+		for (uint32_t var = 0; var < desc.varCount; ++var)
+		{
+			const uint16_t columns = static_cast<uint16_t>(1u + (rng() % 4ull));
+			const D3D_SHADER_VARIABLE_TYPE varType = (rng() % 4ull) == 0ull ? D3D_SVT_INT : D3D_SVT_FLOAT;
+
+			RDEFType type = {};
+			type.Class = static_cast<uint16_t>(columns == 1 ? D3D_SVC_SCALAR : D3D_SVC_VECTOR);
+			type.Type = static_cast<uint16_t>(varType);
+			type.Rows = 1;
+			type.Columns = columns;
+
+			RDEFConst constVar = {};
+			constVar.NameOffset = addString(std::format("c_var{}_{}", i, var));
+			constVar.StartOffset = var * 16u;
+			constVar.Size = columns * 4u;
+			constVar.TypeOffset = typeOffset + static_cast<uint32_t>(sizeof(RDEFType) * types.size());
+
+			types.push_back(type);
+			consts.push_back(constVar);
+		}
+	}
+
+	RDEFBlobHeader header = {};
+	header.ConstBufferCount = static_cast<uint32_t>(buffers.size());
+	header.ConstBufferOffset = constBufferOffset;
+	header.BoundResourceCount = static_cast<uint32_t>(resources.size());
+	header.BoundResourceOffset = resourceOffset;
+	header.VersionMajor = 5;
+	header.ShaderType = PixelShader;
+	header.CreatorOffset = addString("Microsoft (R) HLSL Shader Compiler");
+
+	memcpy(rdef.data(), &header, sizeof(header));
+	memcpy(rdef.data() + constBufferOffset, buffers.data(), sizeof(RDefConstBuffer) * buffers.size());
+	memcpy(rdef.data() + constOffset, consts.data(), sizeof(RDEFConst) * consts.size());
+	memcpy(rdef.data() + typeOffset, types.data(), sizeof(RDEFType) * types.size());
+	memcpy(rdef.data() + resourceOffset, resources.data(), sizeof(RDEFResourceBinding) * resources.size());
+
+	// the container: header, blob offsets, the bytecode stand in, then the rdef
+	constexpr uint32_t blobCount = 2u;
+	const uint32_t codeSize = 256u + static_cast<uint32_t>(rng() % 2048ull);
+
+	const uint32_t codeOffset = sizeof(DXBCHeader) + (sizeof(uint32_t) * blobCount);
+	const uint32_t rdefOffset = codeOffset + sizeof(DXBCBlobHeader) + codeSize;
+
+	std::vector<char> dxbc(rdefOffset + sizeof(DXBCBlobHeader) + rdef.size(), 0);
+
+	DXBCHeader* const hdr = reinterpret_cast<DXBCHeader*>(dxbc.data());
+	hdr->DXBCHeaderFourCC = DXBC_FOURCC_NAME;
+	hdr->Version = { 1, 0 };
+	hdr->ContainerSizeInBytes = static_cast<uint32_t>(dxbc.size());
+	hdr->BlobCount = blobCount;
+
+	const uint32_t blobOffsets[blobCount] = { codeOffset, rdefOffset };
+	memcpy(dxbc.data() + sizeof(DXBCHeader), blobOffsets, sizeof(blobOffsets));
+
+	const DXBCBlobHeader codeBlob = { (('X' << 24) + ('E' << 16) + ('H' << 8) + 'S'), codeSize };
+	const DXBCBlobHeader rdefBlob = { DXBC_FOURCC_RDEF, static_cast<uint32_t>(rdef.size()) };
+
+	memcpy(dxbc.data() + codeOffset, &codeBlob, sizeof(codeBlob));
+	memcpy(dxbc.data() + rdefOffset, &rdefBlob, sizeof(rdefBlob));
+	memcpy(dxbc.data() + rdefOffset + sizeof(DXBCBlobHeader), rdef.data(), rdef.size());
+
+	return dxbc;
+}
+
+// what PostLoadMaterialAsset did before the reflection was shared, every material scanning the blobs again and keeping its own copies
+static std::map<uint32_t, ShaderResource> ResourceBindingsPerMaterial(const ShaderAsset* const shaderAsset, const D3D_SHADER_INPUT_TYPE inputType)
+{
+	std::map<uint32_t, ShaderResource> bindings;
+
+	const DXBCHeader* const hdr = reinterpret_cast<DXBCHeader*>(shaderAsset->data);
+	for (uint32_t blobIdx = 0; blobIdx < hdr->BlobCount; blobIdx++)
+	{
+		const DXBCBlobHeader* const blob = hdr->pBlob(blobIdx);
+		if (!blob->isRDEF())
+			continue;
+
+		RDEFBlobHeader* rdefBlob = blob->pRDEFBlob();
+		for (uint32_t resIdx = 0; resIdx < rdefBlob->BoundResourceCount; resIdx++)
+		{
+			RDEFResourceBinding* resource = rdefBlob->pBoundResource(resIdx);
+			if (resource->Type != inputType)
+				continue;
+
+			const ShaderResource tmp(resource->Name(rdefBlob), *resource);
+			bindings.emplace(resource->BindPoint, tmp);
+		}
+
+		break;
+	}
+
+	return bindings;
+}
+
+static std::vector<TmpConstBufVar> ConstBufVarsPerMaterial(const ShaderAsset* const shaderAsset, const char* constBufName)
+{
+	std::vector<TmpConstBufVar> vars;
+
+	const DXBCHeader* const hdr = reinterpret_cast<DXBCHeader*>(shaderAsset->data);
+	for (uint32_t blobIdx = 0; blobIdx < hdr->BlobCount; blobIdx++)
+	{
+		const DXBCBlobHeader* const blob = hdr->pBlob(blobIdx);
+		if (!blob->isRDEF())
+			continue;
+
+		RDEFBlobHeader* rdefBlob = blob->pRDEFBlob();
+		for (uint32_t constBufIdx = 0; constBufIdx < rdefBlob->ConstBufferCount; constBufIdx++)
+		{
+			const RDefConstBuffer* const constBuf = rdefBlob->pConstBuffer(constBufIdx);
+			if (strncmp(constBufName, constBuf->Name(rdefBlob), 64))
+				continue;
+
+			for (uint32_t constIdx = 0; constIdx < constBuf->ConstCount; constIdx++)
+			{
+				const RDEFConst* const constVar = constBuf->pConst(rdefBlob, constIdx);
+				const RDEFType* const constType = constVar->pType(rdefBlob);
+
+				const TmpConstBufVar tmp(constVar->Name(rdefBlob), static_cast<D3D_SHADER_VARIABLE_TYPE>(constType->Type), constVar->Size);
+				vars.push_back(tmp);
+			}
+
+			break;
+		}
+
+		break;
+	}
+
+	return vars;
+}
+
+// heap use of a std::map, a node holds three links and two flags besides the value
+template <typename Map>
+static const size_t ShaderTestMapMemory(const Map& map)
+{
+	return map.size() * (sizeof(typename Map::value_type) + (4 * sizeof(void*)));
+}
+
+// material post load against shaders shared between thousands of materials, the old per material parse and copy against the shared reflection
+static void Benchmark_ShaderReflection(CSelfTestContext& ctx)
+{
+	const uint32_t numShaders = 300u;
+	const uint32_t numMaterials = 20000u * ctx.Scale();
+
+	std::mt19937_64& rng = ctx.Rng();
+
+	std::vector<std::vector<char>> shaderData;
+	shaderData.reserve(numShaders);
+	for (uint32_t i = 0; i < numShaders; ++i)
+		shaderData.emplace_back(SyntheticShaderDXBC(rng));
+
+	// a few shadersets are used by most materials
+	std::vector<uint32_t> materialShaders(numMaterials);
+	for (uint32_t& shader : materialShaders)
+		shader = (rng() % 2ull) == 0ull ? static_cast<uint32_t>(rng() % 16ull) : static_cast<uint32_t>(rng() % numShaders);
+
+	// shader assets as the loader leaves them, GetShaderReflection only needs the extra data
+	std::vector<std::unique_ptr<CPakAsset>> shaderAssets;
+	const auto createShaderAssets = [&]()
+		{
+			shaderAssets.clear();
+
+			for (std::vector<char>& data : shaderData)
+			{
+				ShaderAsset* const shaderAsset = new ShaderAsset();
+				shaderAsset->type = eShaderType::Pixel;
+				shaderAsset->data = data.data();
+				shaderAsset->dataSize = static_cast<int>(data.size());
+
+				std::unique_ptr<CPakAsset>& asset = shaderAssets.emplace_back(std::make_unique<CPakAsset>());
+				asset->setExtraData(shaderAsset);
+			}
+		};
+
+	// the shaders never created a d3d shader, they must not release one
+	const auto freeShaderAssets = [&]()
+		{
+			for (const std::unique_ptr<CPakAsset>& asset : shaderAssets)
+				reinterpret_cast<ShaderAsset*>(asset->extraData())->data = nullptr;
+
+			shaderAssets.clear();
+		};
+
+	const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	const auto postLoadMaterials = [&](const std::function<void(const uint32_t)>& postLoad)
+		{
+			CParallelTask task(threadCount);
+
+			std::atomic<uint32_t> materialIdx = 0u;
+			task.addTask([&]()
+				{
+					for (uint32_t i = materialIdx++; i < numMaterials; i = materialIdx++)
+						postLoad(i);
+				}, threadCount);
+
+			task.execute();
+			task.wait();
+		};
+
+	createShaderAssets();
+
+	struct MaterialCopies_t
+	{
+		std::map<uint32_t, ShaderResource> resourceBindings;
+		std::vector<TmpConstBufVar> cpuDataBuf;
+	};
+
+	std::vector<MaterialCopies_t> copies(numMaterials);
+	const int64_t copyNs = SelfTestTimeBest(3u, [&]()
+		{
+			postLoadMaterials([&](const uint32_t i)
+				{
+					const ShaderAsset* const shaderAsset = reinterpret_cast<const ShaderAsset*>(shaderAssets[materialShaders[i]]->extraData());
+
+					copies[i].resourceBindings = ResourceBindingsPerMaterial(shaderAsset, D3D10_SIT_TEXTURE);
+					copies[i].cpuDataBuf = ConstBufVarsPerMaterial(shaderAsset, "CBufUberStatic");
+				});
+		});
+
+	size_t copyMemory = sizeof(MaterialCopies_t) * numMaterials;
+	for (const MaterialCopies_t& copy : copies)
+		copyMemory += ShaderTestMapMemory(copy.resourceBindings) + (copy.cpuDataBuf.capacity() * sizeof(TmpConstBufVar));
+
+	// every run starts from shaders that haven't been parsed yet
+	std::vector<std::shared_ptr<const ShaderReflection_t>> shared(numMaterials);
+	const int64_t sharedNs = SelfTestTimeBest(3u, [&]()
+		{
+			freeShaderAssets();
+			createShaderAssets();
+
+			postLoadMaterials([&](const uint32_t i)
+				{
+					shared[i] = GetShaderReflection(shaderAssets[materialShaders[i]].get());
+				});
+		});
+
+	size_t sharedMemory = sizeof(std::shared_ptr<const ShaderReflection_t>) * numMaterials;
+	for (const std::unique_ptr<CPakAsset>& asset : shaderAssets)
+	{
+		const ShaderReflection_t* const reflection = reinterpret_cast<const ShaderAsset*>(asset->extraData())->reflection.get();
+		if (!reflection)
+			continue;
+
+		sharedMemory += sizeof(ShaderReflection_t) + ShaderTestMapMemory(reflection->bindings) + (reflection->constBuffers.capacity() * sizeof(ShaderConstBuffer_t));
+
+		for (const auto& it : reflection->bindings)
+			sharedMemory += ShaderTestMapMemory(it.second);
+
+		for (const ShaderConstBuffer_t& buffer : reflection->constBuffers)
+			sharedMemory += buffer.vars.capacity() * sizeof(TmpConstBufVar);
+
+		for (const std::string& name : reflection->names)
+			sharedMemory += sizeof(std::string) + (name.capacity() > 15ull ? name.capacity() + 1ull : 0ull);
+	}
+
+	// the shared reflection gives every material what its own copies held
+	uint32_t mismatches = 0u;
+	for (uint32_t i = 0; i < numMaterials; ++i)
+	{
+		const std::map<uint32_t, ShaderResource>& bindings = shared[i]->Bindings(D3D10_SIT_TEXTURE);
+		const std::vector<TmpConstBufVar>& vars = shared[i]->ConstBufVars("CBufUberStatic");
+
+		bool same = bindings.size() == copies[i].resourceBindings.size() && vars.size() == copies[i].cpuDataBuf.size();
+
+		for (auto it = bindings.begin(), copyIt = copies[i].resourceBindings.cbegin(); same && it != bindings.end(); ++it, ++copyIt)
+			same = it->first == copyIt->first && !strcmp(it->second.name, copyIt->second.name);
+
+		for (size_t var = 0; same && var < vars.size(); ++var)
+			same = !strcmp(vars[var].name, copies[i].cpuDataBuf[var].name) && vars[var].type == copies[i].cpuDataBuf[var].type && vars[var].size == copies[i].cpuDataBuf[var].size;
+
+		mismatches += same ? 0u : 1u;
+	}
+
+	SELFTEST_CHECK(ctx, mismatches == 0u);
+
+	// materials keep the reflection once the shader's pak is unloaded, its names can't point into the shader data
+	const auto reflectionNames = [](const ShaderReflection_t& reflection)
+		{
+			std::string names;
+			for (const auto& it : reflection.Bindings(D3D10_SIT_TEXTURE))
+				names.append(it.second.name).push_back(';');
+
+			for (const TmpConstBufVar& var : reflection.ConstBufVars("CBufUberStatic"))
+				names.append(var.name).push_back(';');
+
+			return names;
+		};
+
+	std::vector<std::string> namesBefore(numMaterials);
+	for (uint32_t i = 0; i < numMaterials; ++i)
+		namesBefore[i] = reflectionNames(*shared[i]);
+
+	freeShaderAssets();
+	for (std::vector<char>& data : shaderData)
+		std::fill(data.begin(), data.end(), '\0');
+
+	uint32_t lostNames = 0u;
+	for (uint32_t i = 0; i < numMaterials; ++i)
+		lostNames += reflectionNames(*shared[i]) != namesBefore[i];
+
+	SELFTEST_CHECK(ctx, lostNames == 0u);
+
+	shared.clear();
+
+	ctx.Metric("shaders", static_cast<double>(numShaders), "");
+	ctx.Metric("materials", static_cast<double>(numMaterials), "");
+	ctx.Metric(std::format("per material parse and copy, {} threads", threadCount), static_cast<double>(copyNs) / 1e6, "ms");
+	ctx.Metric(std::format("shared reflection, {} threads", threadCount), static_cast<double>(sharedNs) / 1e6, "ms");
+	ctx.Metric("per material copies memory", static_cast<double>(copyMemory) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("shared reflection memory", static_cast<double>(sharedMemory) / (1024.0 * 1024.0), "MiB");
+}
+
+REGISTER_BENCHMARK("shader.reflection", Benchmark_ShaderReflection);
+
+// stand in bytecode, only the bytes matter to the export
+static const std::vector<char> ShaderTestBlob(std::mt19937_64& rng, const size_t size)
+{
+	std::vector<char> blob(size);
+	for (char& c : blob)
+		c = static_cast<char>(rng() & 0xFFull);
+
+	return blob;
+}
+
+static std::unique_ptr<ShaderAsset> ShaderTestAsset(const std::vector<const std::vector<char>*>& buffers)
+{
+	std::unique_ptr<ShaderAsset> shaderAsset = std::make_unique<ShaderAsset>();
+	shaderAsset->type = eShaderType::Pixel;
+	shaderAsset->numShaders = static_cast<int>(buffers.size());
+
+	for (size_t i = 0; i < buffers.size(); ++i)
+	{
+		const std::vector<char>* const buf = buffers[i];
+		shaderAsset->shaderBuffers.push_back({ buf ? buf->data() : nullptr, buf ? static_cast<int>(buf->size()) : 0, static_cast<int>(i), !buf, !buf, false });
+	}
+
+	return shaderAsset;
+}
+
+static const bool ShaderTestFileMatches(const std::filesystem::path& path, const std::vector<char>& expected)
+{
+	std::error_code ec;
+	if (std::filesystem::file_size(path, ec) != expected.size() || ec)
+		return false;
+
+	std::shared_ptr<char[]> data;
+	return FileSystem::ReadFileData(path.string(), &data) && memcmp(data.get(), expected.data(), expected.size()) == 0;
+}
+
+static const std::vector<std::filesystem::path> ShaderTestBlobFiles(const std::filesystem::path& blobDirectory)
+{
+	std::vector<std::filesystem::path> files;
+
+	std::error_code ec;
+	for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(blobDirectory, ec))
+	{
+		if (file.is_regular_file())
+			files.push_back(file.path());
+	}
+
+	return files;
+}
+
+// identical bytecode from different shaders, and from different copies in memory, ends up as one blob file
+static void SelfTest_ShaderDedupe(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	const std::vector<char> blobA = ShaderTestBlob(rng, 1024ull);
+	const std::vector<char> blobB = ShaderTestBlob(rng, 3000ull);
+	const std::vector<char> blobC = ShaderTestBlob(rng, 1024ull);
+	const std::vector<char> copyA = blobA;
+
+	std::vector<std::unique_ptr<ShaderAsset>> shaderAssets;
+	shaderAssets.emplace_back(ShaderTestAsset({ &blobA, &blobB, &copyA }));
+	shaderAssets.emplace_back(ShaderTestAsset({ &blobB, &blobC }));
+	shaderAssets.emplace_back(ShaderTestAsset({ &copyA, nullptr, &blobC }));
+
+	const std::filesystem::path shaderDirectory = ctx.TempDirectory() / "shaders";
+	const std::filesystem::path blobDirectory = shaderDirectory / "_blobs";
+	std::filesystem::create_directories(shaderDirectory);
+
+	const auto exportAll = [&]()
+		{
+			for (size_t i = 0; i < shaderAssets.size(); ++i)
+			{
+				std::filesystem::path exportPath = shaderDirectory / std::format("shader_{}", i);
+				SELFTEST_CHECK(ctx, ExportDeduplicatedShaderAsset(shaderAssets[i].get(), exportPath, blobDirectory));
+			}
+		};
+
+	const ShaderBlobStats_t before = GetShaderBlobStats();
+	exportAll();
+	const ShaderBlobStats_t first = GetShaderBlobStats();
+
+	SELFTEST_CHECK(ctx, first.blobs - before.blobs == 7ull);
+	SELFTEST_CHECK(ctx, first.blobsWritten - before.blobsWritten == 3ull);
+	SELFTEST_CHECK(ctx, first.bytesWritten - before.bytesWritten == blobA.size() + blobB.size() + blobC.size());
+
+	const std::vector<std::filesystem::path> blobFiles = ShaderTestBlobFiles(blobDirectory);
+	SELFTEST_CHECK(ctx, blobFiles.size() == 3ull);
+
+	for (const std::filesystem::path& blobFile : blobFiles)
+	{
+		if (!ShaderTestFileMatches(blobFile, blobA) && !ShaderTestFileMatches(blobFile, blobB) && !ShaderTestFileMatches(blobFile, blobC))
+			ctx.Fail(std::format("blob {} isn't any of the exported blobs", blobFile.filename().string()));
+	}
+
+	// exporting the same shaders again writes nothing new
+	exportAll();
+	const ShaderBlobStats_t second = GetShaderBlobStats();
+
+	SELFTEST_CHECK(ctx, second.blobs - first.blobs == 7ull);
+	SELFTEST_CHECK(ctx, second.blobsWritten == first.blobsWritten);
+	SELFTEST_CHECK(ctx, ShaderTestBlobFiles(blobDirectory).size() == 3ull);
+
+	// and the jsons point every shader at the right blob
+	uint32_t rebuiltShaders = 0u, failedShaders = 0u;
+	SELFTEST_CHECK(ctx, ReconstructShaderExports(shaderDirectory, rebuiltShaders, failedShaders));
+	SELFTEST_CHECK(ctx, rebuiltShaders == 3u && failedShaders == 0u);
+
+	const std::vector<std::vector<const std::vector<char>*>> expected = { { &blobA, &blobB, &blobA }, { &blobB, &blobC }, { &blobA, nullptr, &blobC } };
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		for (size_t idx = 0; idx < expected[i].size(); ++idx)
+		{
+			const std::filesystem::path rebuiltPath = shaderDirectory / std::format("shader_{}_{}.fxc", i, idx);
+
+			if (expected[i][idx] ? !ShaderTestFileMatches(rebuiltPath, *expected[i][idx]) : std::filesystem::exists(rebuiltPath))
+				ctx.Fail(std::format("{} doesn't match the shader's bytecode", rebuiltPath.filename().string()));
+		}
+	}
+}
+
+REGISTER_SELFTEST("shader.dedupe", SelfTest_ShaderDedupe);
+
+// shadersets export every permutation, most of which are shared with other shaders, raw against the deduplicated export
+static void Benchmark_ShaderDedupeExport(CSelfTestContext& ctx)
+{
+	const uint32_t numShaders = 200u * ctx.Scale();
+	constexpr uint32_t permutations = 16u;
+	constexpr uint32_t numBlobs = 400u;
+	constexpr uint32_t numCommon = 32u;
+
+	std::mt19937_64& rng = ctx.Rng();
+
+	std::vector<std::vector<char>> blobs;
+	blobs.reserve(numBlobs);
+	for (uint32_t i = 0; i < numBlobs; ++i)
+		blobs.emplace_back(ShaderTestBlob(rng, 512ull + (rng() % 16384ull)));
+
+	std::unordered_set<uint32_t> usedBlobs;
+	std::vector<std::unique_ptr<ShaderAsset>> shaderAssets;
+	shaderAssets.reserve(numShaders);
+
+	for (uint32_t i = 0; i < numShaders; ++i)
+	{
+		std::vector<const std::vector<char>*> buffers;
+		for (uint32_t perm = 0; perm < permutations; ++perm)
+		{
+			const uint32_t blobIdx = (rng() % 10ull) < 6ull ? static_cast<uint32_t>(rng() % numCommon) : static_cast<uint32_t>(rng() % numBlobs);
+
+			usedBlobs.insert(blobIdx);
+			buffers.push_back(&blobs[blobIdx]);
+		}
+
+		shaderAssets.emplace_back(ShaderTestAsset(buffers));
+	}
+
+	const std::filesystem::path rawDirectory = ctx.TempDirectory() / "raw";
+	const std::filesystem::path dedupeDirectory = ctx.TempDirectory() / "dedupe";
+	const std::filesystem::path blobDirectory = dedupeDirectory / "_blobs";
+
+	std::filesystem::create_directories(rawDirectory);
+	std::filesystem::create_directories(dedupeDirectory);
+
+	const auto rawStart = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < numShaders; ++i)
+	{
+		std::filesystem::path exportPath = rawDirectory / std::format("shader_{}", i);
+		ExportRawShaderAsset(shaderAssets[i].get(), exportPath);
+	}
+
+	const int64_t rawNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - rawStart).count();
+
+	const ShaderBlobStats_t before = GetShaderBlobStats();
+	const auto dedupeStart = std::chrono::steady_clock::now();
+
+	bool exported = true;
+	for (uint32_t i = 0; i < numShaders; ++i)
+	{
+		std::filesystem::path exportPath = dedupeDirectory / std::format("shader_{}", i);
+		exported &= ExportDeduplicatedShaderAsset(shaderAssets[i].get(), exportPath, blobDirectory);
+	}
+
+	const int64_t dedupeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - dedupeStart).count();
+	const ShaderBlobStats_t after = GetShaderBlobStats();
+
+	const uint64_t rawBytes = after.bytes - before.bytes;
+	const uint64_t bytesWritten = after.bytesWritten - before.bytesWritten;
+
+	SELFTEST_CHECK(ctx, exported);
+	SELFTEST_CHECK(ctx, after.blobs - before.blobs == static_cast<uint64_t>(numShaders) * permutations);
+	SELFTEST_CHECK(ctx, after.blobsWritten - before.blobsWritten == usedBlobs.size());
+	SELFTEST_CHECK(ctx, ShaderTestBlobFiles(blobDirectory).size() == usedBlobs.size());
+
+	ctx.Metric("shaders", static_cast<double>(numShaders), "");
+	ctx.Metric("blobs", static_cast<double>(after.blobs - before.blobs), "");
+	ctx.Metric("distinct blobs", static_cast<double>(usedBlobs.size()), "");
+	ctx.Metric("raw bytes", static_cast<double>(rawBytes) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("bytes written", static_cast<double>(bytesWritten) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("written of raw", rawBytes ? static_cast<double>(bytesWritten) * 100.0 / static_cast<double>(rawBytes) : 0.0, "%");
+	ctx.Metric("raw export", static_cast<double>(rawNs) / 1e6, "ms");
+	ctx.Metric("deduplicated export", static_cast<double>(dedupeNs) / 1e6, "ms");
+	ctx.Metric("speedup", dedupeNs ? static_cast<double>(rawNs) / dedupeNs : 0.0, "x");
+}
+
+REGISTER_BENCHMARK("shader.dedupe.export", Benchmark_ShaderDedupeExport);
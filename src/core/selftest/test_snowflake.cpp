@@ -0,0 +1,596 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <game/rtech/utils/utils.h>
+#include <game/rtech/utils/snowflake.h>
+#include <thirdparty/zstd/common/xxhash.h>
+
+#include <bit>
+
+// there is no snowflake encoder, test streams are a valid header followed by random bytes
+// a random body still decodes to something or is found to be corrupt, so decoders can be compared on whatever decodes
+// streams only come from rng() itself, std::mt19937_64 gives the same sequence everywhere so the golden streams are stable
+
+// a corrupt stream can read this far past its end before it is caught, test buffers are zero padded by it
+static constexpr size_t s_snowflakeTestPadding = 1024ull;
+
+struct SnowflakeTestParams_t
+{
+	uint32_t sizeBits;     // decoded size is (random sizeBits bits | (1 << sizeBits)) - 1
+	uint32_t blockBits;    // blocks of 512 << blockBits decoded bytes
+	uint32_t posMask;      // literal position mask index
+	uint32_t codeTable;    // 0 starts the literal models evenly spread, otherwise from coded literal lengths
+	uint32_t firstMatches; // matches in the first block, later block headers come from the random body
+};
+
+// snowflake bits are read lsb first
+static void PutSnowflakeBits(std::vector<char>& stream, uint64_t& pos, const uint64_t value, const uint32_t count)
+{
+	for (uint32_t i = 0u; i < count; ++i, ++pos)
+	{
+		if ((pos >> 3) >= stream.size())
+			stream.resize((pos >> 3) + 1ull, 0);
+
+		if ((value >> i) & 1ull)
+			stream[pos >> 3] |= static_cast<char>(1u << (pos & 7ull));
+	}
+}
+
+// a complete prefix code over the lengths 4 to maxCodeLength no deeper than 7 bits, then every literal's length in that code
+static void PutSnowflakeCodeLengths(std::mt19937_64& rng, const uint32_t maxCodeLength, std::vector<char>& stream, uint64_t& pos)
+{
+	// split random leaves of a one leaf tree until there are enough of them
+	std::vector<uint32_t> depths = { 0u };
+	const size_t wanted = 2ull + (rng() % (maxCodeLength - 4u));
+
+	while (depths.size() < wanted)
+	{
+		std::vector<size_t> splittable;
+		for (size_t i = 0; i < depths.size(); ++i)
+		{
+			if (depths[i] < 7u)
+				splittable.emplace_back(i);
+		}
+
+		if (splittable.empty())
+			break;
+
+		const size_t leaf = splittable[rng() % splittable.size()];
+		depths[leaf]++;
+		depths.emplace_back(depths[leaf]);
+	}
+
+	// shuffled by hand, std::shuffle differs between standard libraries
+	std::vector<uint32_t> values;
+	for (uint32_t value = 4u; value <= maxCodeLength; ++value)
+		values.emplace_back(value);
+
+	for (size_t i = values.size() - 1; i > 0; --i)
+		std::swap(values[i], values[rng() % (i + 1)]);
+
+	uint32_t lengths[16] = {};
+	for (size_t i = 0; i < depths.size(); ++i)
+		lengths[values[i]] = depths[i];
+
+	for (uint32_t value = 0u; value <= maxCodeLength; ++value)
+		PutSnowflakeBits(stream, pos, lengths[value], 3u);
+
+	// codes are handed out the way the decoder does, splitting the closest shorter free code when a length has none
+	uint16_t nextCode[8] = { 0u, 0xFFFFu, 0xFFFFu, 0xFFFFu, 0xFFFFu, 0xFFFFu, 0xFFFFu, 0xFFFFu };
+	uint16_t codes[16] = {};
+	std::vector<uint32_t> used;
+
+	for (uint32_t value = 0u; value <= maxCodeLength; ++value)
+	{
+		const uint32_t length = lengths[value];
+		if (!length)
+			continue;
+
+		uint16_t code = nextCode[length];
+		nextCode[length] = 0xFFFFu;
+
+		if (code == 0xFFFFu)
+		{
+			uint32_t shorter = length - 1u;
+			while (nextCode[shorter] == 0xFFFFu)
+				--shorter;
+
+			code = nextCode[shorter];
+			nextCode[shorter] = 0xFFFFu;
+
+			for (uint32_t step = 1u << shorter; shorter != length; step *= 2u)
+				nextCode[++shorter] = static_cast<uint16_t>(code + step);
+		}
+
+		codes[value] = code;
+		used.emplace_back(value);
+	}
+
+	for (uint32_t i = 0u; i < 256u; ++i)
+	{
+		const uint32_t value = used[rng() % used.size()];
+		PutSnowflakeBits(stream, pos, codes[value], lengths[value]);
+	}
+}
+
+// stream is the header and up to maxBodySize random bytes, followed by zeroed padding that isn't part of it
+// returns the stream size, decompSize is set to the size the header gives
+static const size_t MakeSnowflakeStream(std::mt19937_64& rng, const SnowflakeTestParams_t& params, const size_t maxBodySize, std::vector<char>& stream, uint64_t& decompSize)
+{
+	stream.clear();
+	uint64_t pos = 0ull;
+
+	PutSnowflakeBits(stream, pos, params.sizeBits, 6u);
+
+	const uint64_t sizeLow = rng() & ((1ull << params.sizeBits) - 1ull);
+	PutSnowflakeBits(stream, pos, sizeLow, params.sizeBits);
+
+	decompSize = (sizeLow | (1ull << params.sizeBits)) - 1ull;
+
+	// filled in once the body size is known
+	const uint32_t streamSizeBits = static_cast<uint32_t>(std::bit_width((decompSize >> 6) + 100ull + decompSize));
+	uint64_t streamSizePos = pos;
+	pos += streamSizeBits;
+
+	PutSnowflakeBits(stream, pos, params.blockBits, 4u);
+	PutSnowflakeBits(stream, pos, rng() & 15ull, 4u); // unused block size
+	PutSnowflakeBits(stream, pos, params.posMask, 2u);
+	PutSnowflakeBits(stream, pos, params.codeTable, 3u);
+
+	if (params.codeTable)
+		PutSnowflakeCodeLengths(rng, params.codeTable | 8u, stream, pos);
+
+	// first block header, the match count and both range decoder states
+	PutSnowflakeBits(stream, pos, params.firstMatches, params.blockBits + 8u);
+
+	for (uint32_t i = 0u; i < 2u; ++i)
+	{
+		const uint32_t stateBits = static_cast<uint32_t>(rng() & 31ull) | 32u;
+
+		PutSnowflakeBits(stream, pos, stateBits & 31u, 5u);
+		PutSnowflakeBits(stream, pos, rng() & ((1ull << stateBits) - 1ull), stateBits);
+	}
+
+	// the body starts at the next dword
+	stream.resize(((pos + 31ull) >> 5) * 4ull, 0);
+
+	const size_t maxStreamSize = static_cast<size_t>((1ull << streamSizeBits) - 1ull);
+	const size_t streamSize = std::min(stream.size() + maxBodySize, maxStreamSize);
+
+	for (size_t i = stream.size(); i < streamSize; ++i)
+		stream.emplace_back(static_cast<char>(rng()));
+
+	PutSnowflakeBits(stream, streamSizePos, streamSize, streamSizeBits);
+
+	stream.resize(streamSize + s_snowflakeTestPadding, 0);
+	return streamSize;
+}
+
+static void PickSnowflakeParams(std::mt19937_64& rng, SnowflakeTestParams_t& params)
+{
+	params.sizeBits = 6u + static_cast<uint32_t>(rng() % 9ull);
+	params.blockBits = static_cast<uint32_t>(rng() % 3ull);
+	params.posMask = static_cast<uint32_t>(rng() & 3ull);
+	params.codeTable = (rng() % 3ull) == 0ull ? 1u + static_cast<uint32_t>(rng() % 7ull) : 0u;
+	params.firstMatches = static_cast<uint32_t>((rng() % 4ull) == 0ull ? rng() % 256ull : rng() % 4ull);
+
+	// stored streams, under 64 bytes
+	if ((rng() % 20ull) == 0ull)
+		params.sizeBits = static_cast<uint32_t>(rng() % 6ull);
+}
+
+// the decompiled decoder CSnowflakeDecoder replaced, set up the way DecompressStreamedBuffer used to
+// returns how much it decoded, it doesn't report failure
+static const uint64_t DecodeReference(const std::vector<char>& stream, const size_t streamSize, std::vector<char>& output)
+{
+	std::unique_ptr<char[]> decompState = std::make_unique<char[]>(0x25000);
+	int64_t* const state = reinterpret_cast<int64_t*>(decompState.get());
+
+	RTech::InitSnowflakeDecompState(reinterpret_cast<int64_t>(state), reinterpret_cast<int64_t>(stream.data()), streamSize);
+
+	const uint64_t decompSize = state[0x48D3];
+	const uint32_t blockSize = reinterpret_cast<const uint32_t*>(state)[0x91A4];
+	reinterpret_cast<uint32_t*>(state)[0x91A2] = 0u;
+
+	output.assign(decompSize + s_snowflakeTestPadding, 0);
+
+	state[0x48D4] = std::min<uint64_t>(decompSize, blockSize);
+	state[0x48DA] = reinterpret_cast<int64_t>(output.data());
+	state[0x48DB] = 0;
+
+	RTech::DecompressSnowflake(reinterpret_cast<int64_t>(state), streamSize, decompSize);
+
+	output.resize(decompSize);
+	return state[0x48DB];
+}
+
+// the whole stream and output up front
+static const CSnowflakeDecoder::eStatus DecodeOneShot(CSnowflakeDecoder& decoder, const std::vector<char>& stream, const size_t streamSize, std::vector<char>& output)
+{
+	const size_t decompSize = decoder.ReadHeader(stream.data(), streamSize);
+	if (decompSize == 0ull)
+		return CSnowflakeDecoder::eStatus::CORRUPT;
+
+	output.assign(decompSize, 0);
+	decoder.SetOutput(output.data(), output.size());
+
+	return decoder.Decode(streamSize);
+}
+
+// the input arrives in random steps and the output starts small, growing into a new buffer whenever it runs out
+static const CSnowflakeDecoder::eStatus DecodeChunked(CSnowflakeDecoder& decoder, std::mt19937_64& rng, const std::vector<char>& stream, const size_t streamSize, std::vector<char>& output)
+{
+	size_t inputAvailable = std::min<size_t>(streamSize, 320ull + (rng() % 4096ull));
+
+	size_t decompSize = 0ull;
+	while ((decompSize = decoder.ReadHeader(stream.data(), inputAvailable)) == 0ull)
+	{
+		if (inputAvailable == streamSize)
+			return CSnowflakeDecoder::eStatus::CORRUPT;
+
+		inputAvailable = streamSize;
+	}
+
+	output.assign(1ull + (rng() % decompSize), 0);
+	decoder.SetOutput(output.data(), output.size());
+
+	for (;;)
+	{
+		const CSnowflakeDecoder::eStatus status = decoder.Decode(inputAvailable);
+
+		if (status == CSnowflakeDecoder::eStatus::NEED_INPUT)
+		{
+			if (inputAvailable == streamSize)
+				return status;
+
+			inputAvailable = std::min<size_t>(streamSize, inputAvailable + 1ull + (rng() % 8192ull));
+		}
+		else if (status == CSnowflakeDecoder::eStatus::NEED_OUTPUT)
+		{
+			std::vector<char> larger(std::min<size_t>(decompSize, output.size() + 1ull + (rng() % 8192ull)), 0);
+			memcpy(larger.data(), output.data(), decoder.DecodedSize());
+
+			output = std::move(larger);
+			decoder.SetOutput(output.data(), output.size());
+		}
+		else
+		{
+			return status;
+		}
+	}
+}
+
+static const bool SameOutput(const std::vector<char>& a, const std::vector<char>& b, const size_t size)
+{
+	return a.size() >= size && b.size() >= size && memcmp(a.data(), b.data(), size) == 0;
+}
+
+static void SelfTest_SnowflakeDecode(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	CSnowflakeDecoder decoder;
+
+	std::vector<char> stream;
+	std::vector<char> expected;
+	std::vector<char> output;
+
+	uint32_t compared = 0u;
+
+	for (uint32_t i = 0u; i < 2000u; ++i)
+	{
+		SnowflakeTestParams_t params = {};
+		PickSnowflakeParams(rng, params);
+
+		uint64_t decompSize = 0ull;
+		const size_t streamSize = MakeSnowflakeStream(rng, params, 64ull * 1024ull, stream, decompSize);
+
+		const bool useAVX2 = (i & 1u) != 0u;
+		decoder.SetUseAVX2(useAVX2);
+
+		if (DecodeOneShot(decoder, stream, streamSize, expected) != CSnowflakeDecoder::eStatus::DONE)
+			continue;
+
+		if (decoder.DecodedSize() != decompSize)
+		{
+			ctx.Fail(std::format("stream {}: decoded {} of {} bytes", i, decoder.DecodedSize(), decompSize));
+			continue;
+		}
+
+		// the other vector path
+		decoder.SetUseAVX2(!useAVX2);
+		ctx.Check(DecodeOneShot(decoder, stream, streamSize, output) == CSnowflakeDecoder::eStatus::DONE && SameOutput(output, expected, decompSize),
+			std::format("stream {}: sse and avx2 decodes differ", i).c_str(), __FILE__, __LINE__);
+
+		ctx.Check(DecodeChunked(decoder, rng, stream, streamSize, output) == CSnowflakeDecoder::eStatus::DONE && SameOutput(output, expected, decompSize),
+			std::format("stream {}: chunked decode differs from one shot", i).c_str(), __FILE__, __LINE__);
+
+		// the reference reports a stored stream's size as 0 but decodes it all the same
+		const uint64_t referenceSize = DecodeReference(stream, streamSize, output);
+		ctx.Check((referenceSize == decompSize || decompSize < 64ull) && SameOutput(output, expected, decompSize),
+			std::format("stream {}: differs from the reference decoder ({} bytes, block bits {}, code table {})", i, decompSize, params.blockBits, params.codeTable).c_str(), __FILE__, __LINE__);
+
+		++compared;
+	}
+
+	// random bodies are mostly found corrupt, but plenty still decode
+	SELFTEST_CHECK(ctx, compared >= 200u);
+	ctx.Note(std::format("{} of 2000 streams decoded and matched against the reference", compared));
+}
+
+struct SnowflakeGolden_t
+{
+	uint64_t seed;
+	SnowflakeTestParams_t params;
+	uint64_t decompSize;
+	uint64_t hash; // XXH64 of the decoded stream
+};
+
+// seeds of streams that decode, hashes of what the decompiled reference decoder made of them
+// multi block, single block with and without matches, coded literal lengths, each position mask and a stored stream
+static const SnowflakeGolden_t s_snowflakeGolden[] =
+{
+	{ 0x38ull, { 10u, 0u, 0u, 0u, 0u }, 1030ull, 0xc61d4a236da3ceacull },
+	{ 0x1ull, { 10u, 1u, 0u, 0u, 0u }, 1895ull, 0x006d5afc7540f791ull },
+	{ 0x2e8ull, { 12u, 4u, 1u, 0u, 2u }, 4603ull, 0xccb81029a183b59full },
+	{ 0x6bull, { 13u, 5u, 2u, 0u, 1u }, 13607ull, 0xa84ca57968ba9df9ull },
+	{ 0x1ull, { 11u, 3u, 3u, 3u, 0u }, 3943ull, 0x0b6bc81d1e9c3d2aull },
+	{ 0xa0ull, { 14u, 6u, 1u, 7u, 3u }, 22277ull, 0x473b12f65dbfcf4bull },
+	{ 0x2123ull, { 9u, 1u, 2u, 5u, 4u }, 628ull, 0xc1fc71378e79103aull },
+	{ 0xa06ull, { 12u, 4u, 0u, 1u, 6u }, 5723ull, 0xbac6e242933f9d49ull },
+	{ 0x1ull, { 4u, 0u, 0u, 0u, 0u }, 23ull, 0xbf5798aec867298eull }, // stored
+};
+
+static void SelfTest_SnowflakeGolden(CSelfTestContext& ctx)
+{
+	CSnowflakeDecoder decoder;
+
+	std::vector<char> stream;
+	std::vector<char> output;
+
+	for (const SnowflakeGolden_t& golden : s_snowflakeGolden)
+	{
+		std::mt19937_64 rng(golden.seed);
+
+		uint64_t decompSize = 0ull;
+		const size_t streamSize = MakeSnowflakeStream(rng, golden.params, 64ull * 1024ull, stream, decompSize);
+
+		for (const bool useAVX2 : { false, true })
+		{
+			decoder.SetUseAVX2(useAVX2);
+
+			const bool done = DecodeOneShot(decoder, stream, streamSize, output) == CSnowflakeDecoder::eStatus::DONE;
+			ctx.Check(done && decompSize == golden.decompSize && XXH64(output.data(), decompSize, 0ull) == golden.hash,
+				std::format("golden stream {:x} decodes differently ({})", golden.seed, useAVX2 ? "avx2" : "sse").c_str(), __FILE__, __LINE__);
+		}
+	}
+}
+
+// damaged streams never decode out of bounds and are reported as failures, not as zero filled buffers
+static void SelfTest_SnowflakeCorrupt(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	CSnowflakeDecoder decoder;
+
+	std::vector<char> stream;
+	std::vector<char> output;
+
+	uint32_t failed = 0u;
+
+	for (uint32_t i = 0u; i < 600u; ++i)
+	{
+		SnowflakeTestParams_t params = {};
+		PickSnowflakeParams(rng, params);
+		params.codeTable = (i & 1u) ? 1u + static_cast<uint32_t>(rng() % 7ull) : 0u;
+
+		uint64_t decompSize = 0ull;
+		const size_t streamSize = MakeSnowflakeStream(rng, params, 64ull * 1024ull, stream, decompSize);
+
+		// a header cut short is read from exactly that many bytes and rejected, or fits and gives the same size
+		{
+			const size_t cut = static_cast<size_t>(rng() % 300ull);
+			std::unique_ptr<char[]> truncated = std::make_unique<char[]>(std::max<size_t>(cut, 1ull));
+			memcpy(truncated.get(), stream.data(), cut);
+
+			const size_t size = decoder.ReadHeader(truncated.get(), cut);
+			ctx.Check(size == 0ull || size == decompSize, std::format("stream {}: header cut to {} bytes read as {} bytes", i, cut, size).c_str(), __FILE__, __LINE__);
+		}
+
+		// damage the body, or cut the stream short
+		std::vector<char> damaged(stream.begin(), stream.begin() + streamSize);
+		switch (rng() % 3ull)
+		{
+		case 0:
+			for (uint32_t flip = 0u; flip < 8u; ++flip)
+				damaged[rng() % damaged.size()] ^= static_cast<char>(1u << (rng() % 8ull));
+			break;
+		case 1:
+			damaged.resize(damaged.size() - (rng() % damaged.size()));
+			break;
+		default:
+			for (size_t pos = rng() % damaged.size(), end = std::min<size_t>(damaged.size(), pos + 64ull); pos < end; ++pos)
+				damaged[pos] = static_cast<char>(rng());
+			break;
+		}
+
+		// exactly the damaged size, nothing past bufSize may be read
+		uint64_t bufSize = damaged.size();
+		std::unique_ptr<char[]> buf = std::make_unique<char[]>(damaged.size());
+		memcpy(buf.get(), damaged.data(), damaged.size());
+
+		std::unique_ptr<char[]> decoded = RTech::DecompressStreamedBuffer(std::move(buf), bufSize, eCompressionType::SNOWFLAKE);
+
+		if (!decoded)
+		{
+			ctx.Check(bufSize == 0ull, std::format("stream {}: failed decode left a size of {}", i, bufSize).c_str(), __FILE__, __LINE__);
+			++failed;
+			continue;
+		}
+
+		// anything that decodes has to match what the decoder makes of the same bytes
+		damaged.resize(damaged.size() + s_snowflakeTestPadding, 0);
+		const bool done = DecodeOneShot(decoder, damaged, damaged.size() - s_snowflakeTestPadding, output) == CSnowflakeDecoder::eStatus::DONE;
+		ctx.Check(done && bufSize == decoder.DecodedSize() && SameOutput(output, std::vector<char>(decoded.get(), decoded.get() + bufSize), bufSize),
+			std::format("stream {}: decoded buffer doesn't match the decoder", i).c_str(), __FILE__, __LINE__);
+	}
+
+	ctx.Note(std::format("{} of 600 damaged streams were reported as failed", failed));
+}
+
+REGISTER_SELFTEST("snowflake.decode", SelfTest_SnowflakeDecode);
+REGISTER_SELFTEST("snowflake.golden", SelfTest_SnowflakeGolden);
+REGISTER_SELFTEST("snowflake.corrupt", SelfTest_SnowflakeCorrupt);
+
+// decode throughput of the reference against both vector paths, and with a decoder per thread
+static void Benchmark_SnowflakeDecode(CSelfTestContext& ctx)
+{
+	std::mt19937_64& rng = ctx.Rng();
+
+	struct BenchStream_t
+	{
+		std::vector<char> data;
+		size_t size;
+		uint64_t decompSize;
+	};
+
+	// one block of nothing but literals decodes whatever the body is, like most texture data it's all literal models
+	std::vector<BenchStream_t> literalStreams(ctx.Scale());
+	for (BenchStream_t& stream : literalStreams)
+	{
+		const SnowflakeTestParams_t params = { 23u, 15u, 2u, 3u, 0u };
+		stream.size = MakeSnowflakeStream(rng, params, 24ull << 20, stream.data, stream.decompSize);
+	}
+
+	// small streams with matches, only the ones that decode, past a few blocks the random block headers practically never do
+	std::vector<BenchStream_t> smallStreams;
+	{
+		CSnowflakeDecoder decoder;
+		std::vector<char> output;
+
+		uint64_t total = 0ull;
+		while (total < (8ull << 20) * ctx.Scale())
+		{
+			SnowflakeTestParams_t params = {};
+			PickSnowflakeParams(rng, params);
+			params.sizeBits = 9u + static_cast<uint32_t>(rng() % 3ull);
+
+			BenchStream_t stream = {};
+			stream.size = MakeSnowflakeStream(rng, params, 64ull * 1024ull, stream.data, stream.decompSize);
+
+			if (DecodeOneShot(decoder, stream.data, stream.size, output) != CSnowflakeDecoder::eStatus::DONE)
+				continue;
+
+			total += stream.decompSize;
+			smallStreams.emplace_back(std::move(stream));
+		}
+	}
+
+	std::vector<char> output;
+	std::unique_ptr<char[]> referenceState = std::make_unique<char[]>(0x25000);
+
+	const auto throughput = [](const std::vector<BenchStream_t>& streams, const int64_t ns)
+		{
+			uint64_t bytes = 0ull;
+			for (const BenchStream_t& stream : streams)
+				bytes += stream.decompSize;
+
+			return (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (static_cast<double>(ns) / 1e9);
+		};
+
+	const auto benchSet = [&](const char* const name, const std::vector<BenchStream_t>& streams)
+		{
+			uint64_t largest = 0ull;
+			for (const BenchStream_t& stream : streams)
+				largest = std::max(largest, stream.decompSize);
+
+			output.assign(largest + s_snowflakeTestPadding, 0);
+
+			bool referenceOk = true;
+			const int64_t referenceNs = SelfTestTimeBest(3u, [&]()
+				{
+					for (const BenchStream_t& stream : streams)
+					{
+						memset(referenceState.get(), 0, 0x25000);
+						int64_t* const state = reinterpret_cast<int64_t*>(referenceState.get());
+
+						RTech::InitSnowflakeDecompState(reinterpret_cast<int64_t>(state), reinterpret_cast<int64_t>(stream.data.data()), stream.size);
+
+						reinterpret_cast<uint32_t*>(state)[0x91A2] = 0u;
+						state[0x48D4] = std::min<uint64_t>(stream.decompSize, reinterpret_cast<const uint32_t*>(state)[0x91A4]);
+						state[0x48DA] = reinterpret_cast<int64_t>(output.data());
+						state[0x48DB] = 0;
+
+						RTech::DecompressSnowflake(reinterpret_cast<int64_t>(state), stream.size, stream.decompSize);
+						referenceOk &= static_cast<uint64_t>(state[0x48DB]) == stream.decompSize;
+					}
+				});
+
+			SELFTEST_CHECK(ctx, referenceOk);
+			ctx.Metric(std::format("{} reference", name), throughput(streams, referenceNs), "MiB/s");
+
+			CSnowflakeDecoder decoder;
+
+			for (const bool useAVX2 : { false, true })
+			{
+				if (useAVX2 && !CSnowflakeDecoder::HasAVX2())
+					continue;
+
+				decoder.SetUseAVX2(useAVX2);
+
+				bool decoderOk = true;
+				const int64_t ns = SelfTestTimeBest(3u, [&]()
+					{
+						for (const BenchStream_t& stream : streams)
+						{
+							decoderOk &= decoder.ReadHeader(stream.data.data(), stream.size) == stream.decompSize;
+							decoder.SetOutput(output.data(), output.size());
+							decoderOk &= decoder.Decode(stream.size) == CSnowflakeDecoder::eStatus::DONE;
+						}
+					});
+
+				SELFTEST_CHECK(ctx, decoderOk);
+				ctx.Metric(std::format("{} {}", name, useAVX2 ? "avx2" : "sse"), throughput(streams, ns), "MiB/s");
+			}
+
+			// a decoder and output per thread, the streams are shared out between them
+			const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 2u);
+
+			std::atomic<uint32_t> failures = 0u;
+			const int64_t threadedNs = SelfTestTimeBest(3u, [&]()
+				{
+					std::atomic<size_t> next = 0ull;
+
+					CParallelTask parallelTask(threadCount);
+					parallelTask.addTask([&]()
+						{
+							static thread_local CSnowflakeDecoder threadDecoder;
+							std::vector<char> threadOutput(largest, 0);
+
+							for (size_t idx = next++; idx < streams.size(); idx = next++)
+							{
+								const BenchStream_t& stream = streams[idx];
+
+								threadDecoder.ReadHeader(stream.data.data(), stream.size);
+								threadDecoder.SetOutput(threadOutput.data(), threadOutput.size());
+
+								if (threadDecoder.Decode(stream.size) != CSnowflakeDecoder::eStatus::DONE)
+									failures++;
+							}
+						}, threadCount);
+
+					parallelTask.execute();
+					parallelTask.wait();
+				});
+
+			SELFTEST_CHECK(ctx, failures == 0u);
+			ctx.Metric(std::format("{} {} threads", name, threadCount), throughput(streams, threadedNs), "MiB/s");
+		};
+
+	benchSet("literal stream", literalStreams);
+	benchSet("small streams", smallStreams);
+
+	ctx.Metric("small stream count", static_cast<double>(smallStreams.size()), "");
+}
+
+REGISTER_BENCHMARK("snowflake.decode", Benchmark_SnowflakeDecode);
@@ -0,0 +1,169 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/render/dx.h>
+#include <core/cache/texturestore.h>
+
+// bc1 mip with a gradient across it and noisy indices, what most diffuse mips in a pak decode from
+static std::vector<char> TextureStoreTestMip(const uint32_t width, const uint32_t height, const uint32_t idx)
+{
+	const uint32_t blocksWide = width / 4u;
+	const uint32_t blocksHigh = height / 4u;
+
+	std::vector<char> mip(static_cast<size_t>(blocksWide) * blocksHigh * 8ull);
+
+	uint64_t state = (idx + 1ull) * 0x9E3779B97F4A7C15ull;
+	for (uint32_t y = 0; y < blocksHigh; y++)
+	{
+		for (uint32_t x = 0; x < blocksWide; x++)
+		{
+			state = state * 6364136223846793005ull + 1442695040888963407ull;
+
+			const uint16_t r = static_cast<uint16_t>(((x * 31u) / blocksWide + idx) & 31u);
+			const uint16_t g = static_cast<uint16_t>(((y * 63u) / blocksHigh + idx * 3u) & 63u);
+			const uint16_t b = static_cast<uint16_t>((idx * 7u) & 31u);
+
+			const uint16_t color0 = static_cast<uint16_t>((r << 11) | (g << 5) | b);
+			const uint16_t color1 = static_cast<uint16_t>(color0 >> 1);
+			const uint32_t indices = static_cast<uint32_t>(state >> 32);
+
+			char* const block = mip.data() + ((static_cast<size_t>(y) * blocksWide + x) * 8ull);
+			memcpy(block, &color0, sizeof(color0));
+			memcpy(block + 2, &color1, sizeof(color1));
+			memcpy(block + 4, &indices, sizeof(indices));
+		}
+	}
+
+	return mip;
+}
+
+// a batch export the way ExportTextureMip does it, with the store the mip bytes are keyed before anything is decoded
+static const int64_t RunTextureStoreTestExport(CTextureExportStore* const store, const std::vector<std::vector<char>>& mips, const std::vector<uint32_t>& picks, const uint32_t width, const uint32_t height,
+	const std::filesystem::path& dir, const uint32_t threadCount, std::atomic<uint32_t>& failed)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	const uint32_t numExports = static_cast<uint32_t>(picks.size());
+	constexpr DXGI_FORMAT format = DXGI_FORMAT_BC1_UNORM;
+	constexpr char extension[] = "png";
+
+	CParallelTask task(threadCount);
+
+	std::atomic<uint32_t> exportIdx = 0u;
+	task.addTask([&]()
+		{
+			for (uint32_t i = exportIdx++; i < numExports; i = exportIdx++)
+			{
+				const std::vector<char>& mip = mips[picks[i]];
+				const std::filesystem::path exportPath = dir / std::format("texture_{}.png", i);
+
+				uint64_t storeKey = 0ull;
+				if (store)
+				{
+					storeKey = CTextureExportStore::HashData(extension, strlen(extension), 0ull);
+					storeKey = CTextureExportStore::HashValue(format, storeKey);
+					storeKey = CTextureExportStore::HashValue(width, storeKey);
+					storeKey = CTextureExportStore::HashValue(height, storeKey);
+					storeKey = CTextureExportStore::HashData(mip.data(), mip.size(), storeKey);
+
+					if (store->TryReuse(storeKey, exportPath))
+						continue;
+				}
+
+				const auto encodeStart = std::chrono::steady_clock::now();
+
+				CTexture texture(mip.data(), mip.size(), width, height, format, 1u, 1u);
+				if (!texture.ExportAsPng(exportPath))
+				{
+					++failed;
+					continue;
+				}
+
+				if (store)
+					store->Add(storeKey, exportPath, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - encodeStart).count());
+			}
+		}, threadCount);
+
+	task.execute();
+	task.wait();
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// a selection where most exports are a handful of shared textures (detail maps, blank normals) and the rest are seen once or twice
+static void Benchmark_TextureStoreBatch(CSelfTestContext& ctx)
+{
+	constexpr uint32_t width = 512u;
+	constexpr uint32_t height = 512u;
+
+	const uint32_t numUnique = 24u * ctx.Scale();
+	const uint32_t numExports = 10u * numUnique;
+	const uint32_t numCommon = std::max(numUnique / 8u, 1u);
+	const uint32_t threadCount = std::max(UtilsConfig->exportThreadCount, 1u);
+
+	// png export goes through wic, headless only sets com up after the tests ran
+	const HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	std::vector<std::vector<char>> mips;
+	mips.reserve(numUnique);
+
+	for (uint32_t i = 0; i < numUnique; i++)
+		mips.push_back(TextureStoreTestMip(width, height, i));
+
+	std::vector<uint32_t> picks(numExports);
+	std::uniform_int_distribution<uint32_t> commonDist(0u, numCommon - 1u);
+	std::uniform_int_distribution<uint32_t> anyDist(0u, numUnique - 1u);
+	std::uniform_int_distribution<uint32_t> roll(0u, 99u);
+
+	for (uint32_t i = 0; i < numExports; i++)
+		picks[i] = i < numUnique ? i : (roll(ctx.Rng()) < 75u ? commonDist(ctx.Rng()) : anyDist(ctx.Rng()));
+
+	const std::filesystem::path plainDir = ctx.TempDirectory() / "plain";
+	const std::filesystem::path storeDir = ctx.TempDirectory() / "store";
+
+	std::filesystem::create_directories(plainDir);
+	std::filesystem::create_directories(storeDir);
+
+	std::atomic<uint32_t> failed = 0u;
+
+	const int64_t plainNs = RunTextureStoreTestExport(nullptr, mips, picks, width, height, plainDir, threadCount, failed);
+
+	CTextureExportStore store;
+	const int64_t storeNs = RunTextureStoreTestExport(&store, mips, picks, width, height, storeDir, threadCount, failed);
+
+	const TextureStoreStats_t stats = store.GetStats();
+
+	SELFTEST_CHECK(ctx, failed == 0u);
+	SELFTEST_CHECK(ctx, stats.hits + stats.misses == numExports);
+	SELFTEST_CHECK(ctx, stats.misses >= numUnique);
+	SELFTEST_CHECK(ctx, stats.entries == numUnique);
+
+	// a reused export has to match the file the plain run encoded for that texture
+	for (uint32_t i = numUnique; i < std::min(numUnique + 32u, numExports); i++)
+	{
+		const std::string name = std::format("texture_{}.png", i);
+
+		std::error_code plainEc, storeEc;
+		const uintmax_t plainSize = std::filesystem::file_size(plainDir / name, plainEc);
+		const uintmax_t storeSize = std::filesystem::file_size(storeDir / name, storeEc);
+
+		if (plainEc || storeEc || plainSize != storeSize)
+		{
+			ctx.Fail(std::format("{} differs from the export it reused", name));
+			break;
+		}
+	}
+
+	ctx.Metric("exports", static_cast<double>(numExports), "");
+	ctx.Metric("unique textures", static_cast<double>(numUnique), "");
+	ctx.Metric("hit rate", numExports ? (static_cast<double>(stats.hits) / numExports) * 100.0 : 0.0, "%");
+	ctx.Metric("without store", static_cast<double>(plainNs) / 1e6, "ms");
+	ctx.Metric("with store", static_cast<double>(storeNs) / 1e6, "ms");
+	ctx.Metric("encode time saved", static_cast<double>(stats.savedNs) / 1e6, "ms");
+	ctx.Metric("speedup", storeNs ? static_cast<double>(plainNs) / storeNs : 0.0, "x");
+
+	if (SUCCEEDED(comResult))
+		CoUninitialize();
+}
+
+REGISTER_BENCHMARK("cache.texturestore.batch", Benchmark_TextureStoreBatch);
@@ -0,0 +1,164 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/render/dx.h>
+#include <game/rtech/assets/ui_image.h>
+
+// every block holds its own source index, so a block in the wrong place shows which one it is
+static std::unique_ptr<char[]> UIImageTestBlocks(const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x, const uint32_t seed)
+{
+	const uint32_t numBlocks = widthBlocks * heightBlocks;
+	std::unique_ptr<char[]> buf = std::make_unique<char[]>(static_cast<size_t>(numBlocks) * bpp2x);
+
+	for (uint32_t block = 0u; block < numBlocks; block++)
+	{
+		char* const dst = buf.get() + (static_cast<size_t>(block) * bpp2x);
+		for (uint32_t i = 0u; i < bpp2x; i += sizeof(uint32_t))
+		{
+			const uint32_t value = (block * 0x9E3779B9u) ^ (seed + i);
+			memcpy(dst + i, &value, sizeof(value));
+		}
+	}
+
+	return buf;
+}
+
+static std::unique_ptr<CTexture> UIImageTestTexture(const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x)
+{
+	std::unique_ptr<CTexture> texture = std::make_unique<CTexture>(nullptr, 0u, widthBlocks * 4u, heightBlocks * 4u, bpp2x == 8u ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC7_UNORM, 1u, 1u);
+	memset(texture->GetPixels(), 0, texture->GetSlicePitch());
+
+	return texture;
+}
+
+// the tiling as it was before the table, every block through the formula and dropped if it lands outside the texture
+static void UIImageTileByFormula(char* const dst, const size_t dstSize, const char* const src, const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x)
+{
+	for (uint32_t y = 0u; y < heightBlocks; y++)
+	{
+		for (uint32_t x = 0u; x < widthBlocks; x++)
+		{
+			const size_t destination = static_cast<size_t>(UIImageTiledBlockIndex(x, y, widthBlocks)) * bpp2x;
+			if (destination + bpp2x > dstSize)
+				continue;
+
+			memcpy(dst + destination, src + ((static_cast<size_t>(y) * widthBlocks + x) * bpp2x), bpp2x);
+		}
+	}
+}
+
+static void SelfTest_UIImageTiling(CSelfTestContext& ctx)
+{
+	// heights that aren't a multiple of 8 leave a partial last band, below 8 there is no whole band for a table at all
+	constexpr uint32_t widths[] = { 8u, 16u, 24u, 64u, 72u, 128u };
+	constexpr uint32_t heights[] = { 1u, 5u, 8u, 13u, 16u, 27u, 40u, 64u };
+
+	for (const uint32_t bpp2x : { 8u, 16u })
+	{
+		for (const uint32_t widthBlocks : widths)
+		{
+			for (const uint32_t heightBlocks : heights)
+			{
+				const size_t tiledSize = static_cast<size_t>(widthBlocks) * heightBlocks * bpp2x;
+				const std::unique_ptr<char[]> src = UIImageTestBlocks(widthBlocks, heightBlocks, bpp2x, widthBlocks ^ (heightBlocks << 8));
+
+				std::vector<char> expected(tiledSize);
+				UIImageTileByFormula(expected.data(), tiledSize, src.get(), widthBlocks, heightBlocks, bpp2x);
+
+				const std::unique_ptr<CTexture> texture = DoTilingWork(UIImageTestTexture(widthBlocks, heightBlocks, bpp2x), src, tiledSize, widthBlocks, heightBlocks, bpp2x);
+
+				if (!texture || memcmp(texture->GetPixels(), expected.data(), tiledSize) != 0)
+					ctx.Fail(std::format("tiling {}x{} blocks of {} bytes doesn't match the formula", widthBlocks, heightBlocks, bpp2x));
+			}
+		}
+	}
+}
+
+REGISTER_SELFTEST("uiimage.tiling", SelfTest_UIImageTiling);
+
+struct UIImageTestImage_t
+{
+	std::unique_ptr<CTexture> texture;
+	std::unique_ptr<char[]> src;
+
+	uint32_t widthBlocks;
+	uint32_t heightBlocks;
+	uint32_t bpp2x;
+};
+
+// an atlas worth of ui images, mostly small icons with a few larger ones, bc1 and bc7 mixed
+static void Benchmark_UIImageTiling(CSelfTestContext& ctx)
+{
+	const uint32_t numImages = 4000u * ctx.Scale();
+
+	constexpr uint32_t sizes[] = { 8u, 8u, 8u, 16u, 16u, 24u, 32u, 64u };
+	std::uniform_int_distribution<uint32_t> sizeDist(0u, static_cast<uint32_t>(ARRSIZE(sizes)) - 1u);
+	std::uniform_int_distribution<uint32_t> formatDist(0u, 3u);
+
+	std::vector<UIImageTestImage_t> images(numImages);
+	size_t totalBytes = 0ull;
+
+	for (uint32_t i = 0u; i < numImages; i++)
+	{
+		UIImageTestImage_t& image = images[i];
+		image.widthBlocks = sizes[sizeDist(ctx.Rng())];
+		image.heightBlocks = sizes[sizeDist(ctx.Rng())];
+		image.bpp2x = formatDist(ctx.Rng()) == 0u ? 16u : 8u;
+
+		image.texture = UIImageTestTexture(image.widthBlocks, image.heightBlocks, image.bpp2x);
+		image.src = UIImageTestBlocks(image.widthBlocks, image.heightBlocks, image.bpp2x, i);
+
+		totalBytes += static_cast<size_t>(image.widthBlocks) * image.heightBlocks * image.bpp2x;
+	}
+
+	// the first pass also builds the tables for every size in the atlas
+	const auto firstStart = std::chrono::steady_clock::now();
+	for (UIImageTestImage_t& image : images)
+		image.texture = DoTilingWork(std::move(image.texture), image.src, static_cast<size_t>(image.widthBlocks) * image.heightBlocks * image.bpp2x, image.widthBlocks, image.heightBlocks, image.bpp2x);
+
+	const int64_t firstNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - firstStart).count();
+
+	const int64_t tableNs = SelfTestTimeBest(3u, [&]()
+		{
+			for (UIImageTestImage_t& image : images)
+				image.texture = DoTilingWork(std::move(image.texture), image.src, static_cast<size_t>(image.widthBlocks) * image.heightBlocks * image.bpp2x, image.widthBlocks, image.heightBlocks, image.bpp2x);
+		});
+
+	std::vector<char> tiled;
+	const int64_t formulaNs = SelfTestTimeBest(3u, [&]()
+		{
+			for (UIImageTestImage_t& image : images)
+			{
+				const size_t tiledSize = static_cast<size_t>(image.widthBlocks) * image.heightBlocks * image.bpp2x;
+
+				tiled.resize(tiledSize);
+				UIImageTileByFormula(tiled.data(), tiledSize, image.src.get(), image.widthBlocks, image.heightBlocks, image.bpp2x);
+			}
+		});
+
+	for (const UIImageTestImage_t& image : images)
+	{
+		const size_t tiledSize = static_cast<size_t>(image.widthBlocks) * image.heightBlocks * image.bpp2x;
+
+		tiled.assign(tiledSize, 0);
+		UIImageTileByFormula(tiled.data(), tiledSize, image.src.get(), image.widthBlocks, image.heightBlocks, image.bpp2x);
+
+		if (!image.texture || memcmp(image.texture->GetPixels(), tiled.data(), tiledSize) != 0)
+		{
+			ctx.Fail(std::format("tiling {}x{} blocks of {} bytes doesn't match the formula", image.widthBlocks, image.heightBlocks, image.bpp2x));
+			break;
+		}
+	}
+
+	const double megabytes = static_cast<double>(totalBytes) / (1024.0 * 1024.0);
+
+	ctx.Metric("images", static_cast<double>(numImages), "");
+	ctx.Metric("tiled data", megabytes, "MiB");
+	ctx.Metric("first pass (builds tables)", static_cast<double>(firstNs) / 1e6, "ms");
+	ctx.Metric("table", static_cast<double>(tableNs) / 1e6, "ms");
+	ctx.Metric("per block formula", static_cast<double>(formulaNs) / 1e6, "ms");
+	ctx.Metric("table throughput", tableNs ? megabytes / (static_cast<double>(tableNs) / 1e9) : 0.0, "MiB/s");
+	ctx.Metric("speedup", tableNs ? static_cast<double>(formulaNs) / tableNs : 0.0, "x");
+}
+
+REGISTER_BENCHMARK("uiimage.atlastiling", Benchmark_UIImageTiling);
@@ -0,0 +1,285 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <core/mdl/modeldata.h>
+
+// synthetic vg meshes for every layout ParseVerticesFromVG has a kernel for, checked against ParseVertexFromVG
+
+struct VGTestLayout_t
+{
+	vg::eVertPositionType posType;
+	bool weights;
+	bool extraWeights;
+	bool color;
+	bool texcoord0;
+	int extraTexcoords; // texcoord2 and texcoord3, only with texcoord0
+};
+
+struct VGTestMesh_t
+{
+	ModelMeshData_t mesh;
+	std::vector<char> vertexData;
+	std::vector<vvw::mstudioboneweightextra_t> weightExtra;
+	uint8_t boneMap[256];
+};
+
+static void MakeVGTestMesh(VGTestMesh_t& out, const VGTestLayout_t& layout, const uint32_t vertCount, std::mt19937_64& rng)
+{
+	ModelMeshData_t& mesh = out.mesh;
+
+	mesh.rawVertexLayoutFlags = static_cast<uint64_t>(layout.posType) | VERT_NORMAL_PACKED;
+	mesh.rawVertexLayoutFlags |= layout.weights ? (VERT_BLENDINDICES | VERT_BLENDWEIGHTS_PACKED) : 0ull;
+	mesh.rawVertexLayoutFlags |= layout.color ? VERT_COLOR : 0ull;
+	mesh.rawVertexLayoutFlags |= layout.texcoord0 ? VERT_TEXCOORDn_FMT(0, 2) : 0ull;
+	mesh.rawVertexLayoutFlags |= layout.texcoord0 && layout.extraTexcoords > 0 ? VERT_TEXCOORDn_FMT(2, 2) : 0ull;
+	mesh.rawVertexLayoutFlags |= layout.texcoord0 && layout.extraTexcoords > 1 ? VERT_TEXCOORDn_FMT(3, 2) : 0ull;
+	mesh.ParseTexcoords();
+
+	static constexpr int s_positionSizes[4] = { 0, sizeof(Vector), sizeof(Vector64), 0x6 };
+	const int positionSize = s_positionSizes[static_cast<int>(layout.posType)];
+
+	mesh.vertCount = vertCount;
+	mesh.vertCacheSize = static_cast<uint16_t>(positionSize + (layout.weights ? 8 : 0) + sizeof(Normal32) + (layout.color ? sizeof(Color32) : 0) + (mesh.texcoordCount * sizeof(Vector2D)));
+
+	for (uint8_t& bone : out.boneMap)
+		bone = static_cast<uint8_t>(rng());
+
+	const bool extraWeights = layout.weights && layout.extraWeights;
+	if (extraWeights)
+	{
+		out.weightExtra.resize(4096);
+		for (vvw::mstudioboneweightextra_t& extra : out.weightExtra)
+		{
+			extra.weight = static_cast<short>(rng() % 2048u);
+			extra.bone = static_cast<short>(rng() % 256u);
+		}
+	}
+
+	std::uniform_real_distribution<float> floats(-1000.0f, 1000.0f);
+
+	out.vertexData.resize(static_cast<size_t>(vertCount) * mesh.vertCacheSize);
+	for (uint32_t i = 0; i < vertCount; ++i)
+	{
+		char* const vert = &out.vertexData[static_cast<size_t>(i) * mesh.vertCacheSize];
+		int offset = 0;
+
+		if (layout.posType == vg::eVertPositionType::VG_POS_UNPACKED)
+		{
+			const Vector pos(floats(rng), floats(rng), floats(rng));
+			memcpy(vert + offset, &pos, sizeof(Vector));
+		}
+		else
+		{
+			for (int j = 0; j < positionSize; ++j)
+				vert[offset + j] = static_cast<char>(rng());
+		}
+
+		offset += positionSize;
+
+		if (layout.weights)
+		{
+			vg::BlendWeightsPacked_s blendWeights = {};
+			vg::BlendWeightIndices_s blendIndices = {};
+
+			blendIndices.bone[0] = static_cast<uint8_t>(rng());
+			blendIndices.bone[1] = static_cast<uint8_t>(rng());
+			blendIndices.bone[2] = static_cast<uint8_t>(rng());
+
+			blendWeights.weight[0] = static_cast<uint16_t>(rng() % 16384u);
+
+			if (extraWeights)
+			{
+				blendIndices.boneCount = static_cast<uint8_t>(rng() % 16u);
+				blendWeights.weight[1] = static_cast<uint16_t>(rng() % (out.weightExtra.size() - 16u)); // index of the extra weights
+			}
+			else
+			{
+				blendIndices.boneCount = static_cast<uint8_t>(rng() % 3u);
+				blendWeights.weight[1] = static_cast<uint16_t>(rng() % 16384u);
+			}
+
+			memcpy(vert + offset, &blendWeights, sizeof(blendWeights));
+			memcpy(vert + offset + 4, &blendIndices, sizeof(blendIndices));
+			offset += 8;
+		}
+
+		// normal, color and texcoords are copied through as they are
+		for (int j = offset; j < mesh.vertCacheSize; ++j)
+			vert[j] = static_cast<char>(rng());
+	}
+}
+
+struct VGTestOutput_t
+{
+	std::vector<Vertex_t> verts;
+	std::vector<VertexWeight_t> weights;
+	std::vector<Vector2D> texcoords;
+	int weightCount;
+	uint16_t weightsPerVert;
+};
+
+static void ResetVGTestOutput(VGTestOutput_t& out, const ModelMeshData_t& mesh)
+{
+	out.verts.resize(mesh.vertCount);
+	out.weights.resize(static_cast<size_t>(mesh.vertCount) * 16u);
+	out.texcoords.resize(static_cast<size_t>(mesh.vertCount) * std::max(mesh.texcoordCount - 1, 1));
+
+	// fields a layout doesn't have are left alone by both decoders, zero them so they compare equal
+	memset(out.verts.data(), 0, out.verts.size() * sizeof(Vertex_t));
+	memset(out.weights.data(), 0, out.weights.size() * sizeof(VertexWeight_t));
+	memset(out.texcoords.data(), 0, out.texcoords.size() * sizeof(Vector2D));
+
+	out.weightCount = 0;
+	out.weightsPerVert = 0;
+}
+
+static void DecodeVGReference(VGTestOutput_t& out, VGTestMesh_t& test)
+{
+	ModelMeshData_t& mesh = test.mesh;
+	mesh.weightsPerVert = 0;
+
+	const vvw::mstudioboneweightextra_t* const weightExtra = test.weightExtra.empty() ? nullptr : test.weightExtra.data();
+
+	int weightIdx = 0;
+	for (uint32_t vertIdx = 0; vertIdx < mesh.vertCount; ++vertIdx)
+	{
+		const char* const vertexData = test.vertexData.data() + (static_cast<size_t>(vertIdx) * mesh.vertCacheSize);
+		Vector2D* const texcoords = mesh.texcoordCount > 1 ? &out.texcoords[vertIdx * (mesh.texcoordCount - 1)] : nullptr;
+		Vertex_t::ParseVertexFromVG(&out.verts[vertIdx], &out.weights[weightIdx], texcoords, &mesh, vertexData, test.boneMap, weightExtra, weightIdx);
+	}
+
+	out.weightCount = weightIdx;
+	out.weightsPerVert = mesh.weightsPerVert;
+}
+
+static void DecodeVGBatch(VGTestOutput_t& out, VGTestMesh_t& test)
+{
+	ModelMeshData_t& mesh = test.mesh;
+	mesh.weightsPerVert = 0;
+
+	const vvw::mstudioboneweightextra_t* const weightExtra = test.weightExtra.empty() ? nullptr : test.weightExtra.data();
+
+	int weightIdx = 0;
+	Vertex_t::ParseVerticesFromVG(out.verts.data(), out.weights.data(), mesh.texcoordCount > 1 ? out.texcoords.data() : nullptr, &mesh, test.vertexData.data(), test.boneMap, weightExtra, weightIdx);
+
+	out.weightCount = weightIdx;
+	out.weightsPerVert = mesh.weightsPerVert;
+}
+
+static const std::string VGTestLayoutName(const VGTestLayout_t& layout)
+{
+	static const char* const s_posNames[4] = { "nopos", "pos", "pos64", "pos48" };
+
+	return std::format("{}{}{}{}{}", s_posNames[static_cast<int>(layout.posType)], layout.weights ? (layout.extraWeights ? "+extraweights" : "+weights") : "",
+		layout.color ? "+color" : "", layout.texcoord0 ? "+uv0" : "", layout.extraTexcoords > 0 ? std::format("+{}uv", layout.extraTexcoords) : "");
+}
+
+// every kernel, plus the extra texcoord counts that take the block copy
+static std::vector<VGTestLayout_t> AllVGTestLayouts()
+{
+	std::vector<VGTestLayout_t> layouts;
+	for (uint32_t kernel = 0; kernel < 64u; ++kernel)
+	{
+		const bool weights = (kernel & 4u) != 0u;
+		const bool extraWeights = (kernel & 8u) != 0u;
+		const bool texcoord0 = (kernel & 32u) != 0u;
+
+		// extra weights are only read with packed weights
+		if (extraWeights && !weights)
+			continue;
+
+		for (int extraTexcoords = 0; extraTexcoords <= (texcoord0 ? 2 : 0); ++extraTexcoords)
+			layouts.emplace_back(VGTestLayout_t{ static_cast<vg::eVertPositionType>(kernel & 3u), weights, extraWeights, (kernel & 16u) != 0u, texcoord0, extraTexcoords });
+	}
+
+	return layouts;
+}
+
+static void SelfTest_VGMeshDecode(CSelfTestContext& ctx)
+{
+	const std::vector<VGTestLayout_t> layouts = AllVGTestLayouts();
+	SELFTEST_CHECK(ctx, layouts.size() == 96ull);
+
+	for (const VGTestLayout_t& layout : layouts)
+	{
+		VGTestMesh_t test;
+		MakeVGTestMesh(test, layout, 257u, ctx.Rng()); // odd count so no kernel can assume pairs
+
+		VGTestOutput_t reference, batch;
+		ResetVGTestOutput(reference, test.mesh);
+		ResetVGTestOutput(batch, test.mesh);
+
+		DecodeVGReference(reference, test);
+		DecodeVGBatch(batch, test);
+
+		const bool vertsMatch = memcmp(reference.verts.data(), batch.verts.data(), reference.verts.size() * sizeof(Vertex_t)) == 0;
+		const bool texcoordsMatch = memcmp(reference.texcoords.data(), batch.texcoords.data(), reference.texcoords.size() * sizeof(Vector2D)) == 0;
+
+		bool weightsMatch = reference.weightCount == batch.weightCount && reference.weightsPerVert == batch.weightsPerVert;
+		for (int i = 0; weightsMatch && i < reference.weightCount; ++i)
+		{
+			weightsMatch = reference.weights[i].bone == batch.weights[i].bone
+				&& memcmp(&reference.weights[i].weight, &batch.weights[i].weight, sizeof(float)) == 0;
+		}
+
+		if (!vertsMatch || !texcoordsMatch || !weightsMatch)
+			ctx.Fail(std::format("{}: batch decode differs from ParseVertexFromVG (verts {}, texcoords {}, weights {})", VGTestLayoutName(layout), vertsMatch, texcoordsMatch, weightsMatch));
+	}
+}
+
+REGISTER_SELFTEST("model.vgdecode", SelfTest_VGMeshDecode);
+
+// vertices per second of the batch decode against the per vertex reference, over every layout
+static void Benchmark_VGMeshDecode(CSelfTestContext& ctx)
+{
+	const uint32_t vertCount = 16384u * ctx.Scale();
+
+	// layouts seen in shipped v8 to v16 models, reported on their own
+	const VGTestLayout_t common[] = {
+		{ vg::eVertPositionType::VG_POS_PACKED64, true, false, false, true, 0 },	// props
+		{ vg::eVertPositionType::VG_POS_PACKED64, true, true, false, true, 1 },		// characters, weapons
+		{ vg::eVertPositionType::VG_POS_PACKED64, false, false, true, true, 1 },	// static geometry with lightmap uvs
+		{ vg::eVertPositionType::VG_POS_UNPACKED, true, true, true, true, 2 },		// foliage
+	};
+
+	const auto measure = [&](const VGTestLayout_t& layout, int64_t& referenceNs, int64_t& batchNs)
+		{
+			VGTestMesh_t test;
+			MakeVGTestMesh(test, layout, vertCount, ctx.Rng());
+
+			VGTestOutput_t out;
+			ResetVGTestOutput(out, test.mesh);
+
+			referenceNs = SelfTestTimeBest(5u, [&]() { DecodeVGReference(out, test); });
+			batchNs = SelfTestTimeBest(5u, [&]() { DecodeVGBatch(out, test); });
+		};
+
+	const auto vertsPerSecond = [vertCount](const int64_t ns, const size_t meshes) { return (static_cast<double>(vertCount) * static_cast<double>(meshes)) / (static_cast<double>(ns) / 1e9) / 1e6; };
+
+	for (const VGTestLayout_t& layout : common)
+	{
+		int64_t referenceNs = 0, batchNs = 0;
+		measure(layout, referenceNs, batchNs);
+
+		const std::string name = VGTestLayoutName(layout);
+		ctx.Metric(std::format("{} reference", name), vertsPerSecond(referenceNs, 1ull), "Mverts/s");
+		ctx.Metric(std::format("{} batch", name), vertsPerSecond(batchNs, 1ull), "Mverts/s");
+	}
+
+	const std::vector<VGTestLayout_t> layouts = AllVGTestLayouts();
+
+	int64_t totalReferenceNs = 0, totalBatchNs = 0;
+	for (const VGTestLayout_t& layout : layouts)
+	{
+		int64_t referenceNs = 0, batchNs = 0;
+		measure(layout, referenceNs, batchNs);
+
+		totalReferenceNs += referenceNs;
+		totalBatchNs += batchNs;
+	}
+
+	ctx.Metric(std::format("all {} layouts reference", layouts.size()), vertsPerSecond(totalReferenceNs, layouts.size()), "Mverts/s");
+	ctx.Metric(std::format("all {} layouts batch", layouts.size()), vertsPerSecond(totalBatchNs, layouts.size()), "Mverts/s");
+}
+
+REGISTER_BENCHMARK("model.vgdecode", Benchmark_VGMeshDecode);
@@ -0,0 +1,199 @@
+#include <pch.h>
+#include <core/selftest/selftest.h>
+
+#include <game/rtech/assets/wrap.h>
+#include <thirdparty/oodle/oodle2.h>
+
+// vertex lump like records, the same offset always gives the same bytes so the export can be checked without keeping the lump around
+static void FillWrapTestLump(char* const buf, const size_t offset, const size_t size)
+{
+	struct Record_t
+	{
+		float x;
+		float y;
+		float z;
+		uint32_t normalIdx;
+	};
+
+	assertm((offset % sizeof(Record_t)) == 0 && (size % sizeof(Record_t)) == 0, "lump pieces have to be whole records");
+
+	Record_t* const records = reinterpret_cast<Record_t*>(buf);
+	const size_t first = offset / sizeof(Record_t);
+
+	for (size_t i = 0; i < size / sizeof(Record_t); ++i)
+	{
+		const uint64_t idx = first + i;
+		const uint64_t hash = (idx * 0x9E3779B97F4A7C15ull) >> 40;
+
+		records[i].x = static_cast<float>(idx & 1023ull) * 16.0f;
+		records[i].y = static_cast<float>((idx >> 10) & 1023ull) * 16.0f;
+		records[i].z = static_cast<float>(hash & 255ull) * 0.25f;
+		records[i].normalIdx = static_cast<uint32_t>(hash & 4095ull);
+	}
+}
+
+static const bool WrapTestExportMatches(const std::string& path, const size_t lumpSize)
+{
+	StreamIO file;
+	if (!file.open(path, eStreamIOMode::Read) || file.size() != lumpSize)
+		return false;
+
+	constexpr size_t chunkSize = 4ull * 1024 * 1024;
+	std::unique_ptr<char[]> expected = std::make_unique<char[]>(chunkSize);
+	std::unique_ptr<char[]> exported = std::make_unique<char[]>(chunkSize);
+
+	for (size_t offset = 0; offset < lumpSize; offset += chunkSize)
+	{
+		const size_t size = std::min(chunkSize, lumpSize - offset);
+
+		FillWrapTestLump(expected.get(), offset, size);
+
+		if (!file.read(exported.get(), size) || memcmp(expected.get(), exported.get(), size) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+// ProcessMemory is the working set right now, a thread polls it so the peak during an export is caught
+class CWrapTestPeakMemory
+{
+public:
+	CWrapTestPeakMemory() : m_baseline(CSelfTestContext::ProcessMemory()), m_peak(m_baseline), m_stop(false),
+		m_thread([this]()
+			{
+				while (!m_stop)
+				{
+					m_peak = std::max(m_peak.load(), CSelfTestContext::ProcessMemory());
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}) {};
+
+	// growth of the working set over the baseline at its highest
+	const size_t Finish()
+	{
+		m_stop = true;
+		m_thread.join();
+
+		return std::max(m_peak.load(), CSelfTestContext::ProcessMemory()) - m_baseline;
+	}
+
+private:
+	size_t m_baseline;
+	std::atomic<size_t> m_peak;
+	std::atomic<bool> m_stop;
+
+	std::thread m_thread;
+};
+
+// the export as it was before the data was streamed, the stored data read whole and decompressed into a second buffer
+static const bool WriteWrapTestWhole(const std::string& path, const uint64_t offset, const uint64_t storedSize, const uint64_t outSize, const bool isCompressed, StreamIO& out)
+{
+	StreamIO file;
+	if (!file.open(path, eStreamIOMode::Read))
+		return false;
+
+	std::unique_ptr<char[]> stored = std::make_unique<char[]>(storedSize);
+	file.seek(offset);
+
+	if (!file.read(stored.get(), storedSize))
+		return false;
+
+	file.close();
+
+	if (!isCompressed)
+	{
+		out.write(stored.get(), storedSize);
+		return true;
+	}
+
+	std::unique_ptr<char[]> decompressed = std::make_unique<char[]>(outSize);
+	if (OodleLZ_Decompress(stored.get(), storedSize, decompressed.get(), outSize) != static_cast<OO_SINTa>(outSize))
+		return false;
+
+	out.write(decompressed.get(), outSize);
+	return true;
+}
+
+// a starpak with one large lump stored compressed and the same lump stored as it is, each exported streamed and whole
+static void Benchmark_WrapLargeLump(CSelfTestContext& ctx)
+{
+	const size_t lumpSize = 96ull * 1024 * 1024 * ctx.Scale();
+	constexpr uint64_t starpakHeaderSize = 4096ull;
+
+	const std::string starpakPath = (ctx.TempDirectory() / "wrap_lumps.starpak").string();
+
+	uint64_t compressedSize = 0ull;
+	{
+		std::unique_ptr<char[]> lump = std::make_unique<char[]>(lumpSize);
+		FillWrapTestLump(lump.get(), 0ull, lumpSize);
+
+		std::unique_ptr<char[]> compressed = std::make_unique<char[]>(static_cast<size_t>(OodleLZ_GetCompressedBufferSizeNeeded(OodleLZ_Compressor_Kraken, lumpSize)));
+		const OO_SINTa compSize = OodleLZ_Compress(OodleLZ_Compressor_Kraken, lump.get(), lumpSize, compressed.get(), OodleLZ_CompressionLevel_SuperFast);
+
+		SELFTEST_CHECK(ctx, compSize != OODLELZ_FAILED && static_cast<size_t>(compSize) < lumpSize);
+		if (compSize == OODLELZ_FAILED)
+			return;
+
+		compressedSize = static_cast<uint64_t>(compSize);
+
+		const std::unique_ptr<char[]> header = std::make_unique<char[]>(starpakHeaderSize);
+		memset(header.get(), 0, starpakHeaderSize);
+
+		StreamIO starpak;
+		if (!starpak.open(starpakPath, eStreamIOMode::Write))
+		{
+			ctx.Fail("couldn't write the test starpak");
+			return;
+		}
+
+		starpak.write(header.get(), starpakHeaderSize);
+		starpak.write(compressed.get(), compressedSize);
+		starpak.write(lump.get(), lumpSize);
+		starpak.close();
+	}
+
+	ctx.Metric("lump size", static_cast<double>(lumpSize) / (1024.0 * 1024.0), "MiB");
+	ctx.Metric("compressed size", static_cast<double>(compressedSize) / (1024.0 * 1024.0), "MiB");
+
+	typedef const bool(*WrapTestWriter_t)(const std::string&, const uint64_t, const uint64_t, const uint64_t, const bool, StreamIO&);
+
+	for (const bool isCompressed : { true, false })
+	{
+		const uint64_t offset = isCompressed ? starpakHeaderSize : starpakHeaderSize + compressedSize;
+		const uint64_t storedSize = isCompressed ? compressedSize : lumpSize;
+
+		for (const auto& [method, writer] : { std::pair<const char*, WrapTestWriter_t>{ "streamed", WriteWrapFileData }, std::pair<const char*, WrapTestWriter_t>{ "whole", WriteWrapTestWhole } })
+		{
+			const std::string exportPath = (ctx.TempDirectory() / std::format("lump_{}_{}.bsp_lump", isCompressed ? "compressed" : "stored", method)).string();
+
+			CWrapTestPeakMemory peakMemory;
+			const auto start = std::chrono::steady_clock::now();
+
+			bool written = false;
+			{
+				StreamIO out;
+				if (out.open(exportPath, eStreamIOMode::Write))
+				{
+					written = writer(starpakPath, offset, storedSize, lumpSize, isCompressed, out);
+					out.close();
+				}
+			}
+
+			const int64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			const size_t peak = peakMemory.Finish();
+
+			if (!written || !WrapTestExportMatches(exportPath, lumpSize))
+				ctx.Fail(std::format("{} export of the {} lump doesn't match the lump", method, isCompressed ? "compressed" : "stored"));
+
+			std::error_code ec;
+			std::filesystem::remove(exportPath, ec);
+
+			const std::string name = std::format("{} lump, {}", isCompressed ? "compressed" : "stored", method);
+			ctx.Metric(name + " peak working set growth", static_cast<double>(peak) / (1024.0 * 1024.0), "MiB");
+			ctx.Metric(name + " time", static_cast<double>(elapsedNs) / 1e6, "ms");
+		}
+	}
+}
+
+REGISTER_BENCHMARK("wrap.largelump", Benchmark_WrapLargeLump);
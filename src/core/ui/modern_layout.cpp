@@ -21,6 +21,7 @@
 #include <game/rtech/cpakfile.h>
 #include <game/rtech/assets/texture.h>
 #include <game/rtech/assets/material.h>
+#include <game/rtech/assets/datatable_store.h>
 #include <core/mdl/modeldata.h>
 #include <core/input/input.h>
 #include <core/render/dxshader.h>
@@ -49,6 +50,16 @@ namespace ModernUI
 {
     LayoutManager* g_pModernLayout = nullptr;
 
+    // true once for each caller after assets have been deleted, for the statics below that are keyed by asset pointer
+    static bool AssetsUnloadedSince(size_t& unloadGeneration)
+    {
+        if (unloadGeneration == g_assetData.m_unloadGeneration)
+            return false;
+
+        unloadGeneration = g_assetData.m_unloadGeneration;
+        return true;
+    }
+
     LayoutManager::LayoutManager()
     {
         // Initialize all panels as visible except console
@@ -227,6 +238,27 @@ namespace ModernUI
                         RefreshAssetTree();
                     }
                 }
+                if (ImGui::BeginMenu("Unload Container", !inJobAction && !g_assetData.v_assetContainers.empty()))
+                {
+                    CAssetContainer* unloadContainer = nullptr;
+                    for (CAssetContainer* const container : g_assetData.v_assetContainers)
+                    {
+                        ImGui::PushID(container);
+                        if (ImGui::MenuItem(container->GetContainerFileName().c_str()))
+                            unloadContainer = container;
+                        ImGui::PopID();
+                    }
+                    ImGui::EndMenu();
+
+                    if (unloadContainer)
+                    {
+                        m_selectedAssets.clear();
+                        previewDrawData = nullptr;
+                        g_assetData.UnloadContainers({ unloadContainer });
+                        g_datatableStore.Clear();
+                        RefreshAssetTree();
+                    }
+                }
                 ImGui::Separator();
                 if (ImGui::MenuItem("Exit", "Alt+F4"))
                 {
@@ -245,6 +277,8 @@ namespace ModernUI
                 ImGui::MenuItem("Material Preview", nullptr, &m_panelVisible[static_cast<int>(PanelType::MaterialPreview)]);
                 ImGui::MenuItem("Properties", nullptr, &m_panelVisible[static_cast<int>(PanelType::Properties)]);
                 ImGui::MenuItem("Console", nullptr, &m_panelVisible[static_cast<int>(PanelType::Console)]);
+                ImGui::MenuItem("Datatable Query", nullptr, &g_dxHandler->GetUIState().datatableQueryWindowVisible);
+                ImGui::MenuItem("Build Diff", nullptr, &g_dxHandler->GetUIState().buildDiffWindowVisible);
                 ImGui::Separator();
                 
                 extern bool g_useModernLayout;
@@ -635,7 +669,7 @@ namespace ModernUI
         CAsset* primaryAsset = m_selectedAssets[0];
 
         // Get asset info
-        std::string assetName = primaryAsset->GetAssetName();
+        std::string assetName(primaryAsset->GetAssetName());
         std::string guidStr = std::format("{:016X}", primaryAsset->GetAssetGUID());
         uint32_t assetType = primaryAsset->GetAssetType();
         char typeBytes[5] = {0};
@@ -747,7 +781,7 @@ namespace ModernUI
                 ImGui::SameLine();
                 ImGui::SetNextItemWidth(-1);
                 static char shaderBuffer[256];
-                std::string shaderName = material->shaderSetAsset ? material->shaderSetAsset->GetAssetName() : "Not loaded";
+                std::string shaderName(material->shaderSetAsset ? material->shaderSetAsset->GetAssetName() : "Not loaded");
                 strncpy_s(shaderBuffer, shaderName.c_str(), sizeof(shaderBuffer) - 1);
                 ImGui::InputText("##MaterialShader", shaderBuffer, sizeof(shaderBuffer), ImGuiInputTextFlags_ReadOnly);
             
@@ -779,7 +813,7 @@ namespace ModernUI
                             bool hasData = texturePakAsset && texturePakAsset->extraData() != nullptr;
                             ImGui::PushStyleColor(ImGuiCol_Text, hasData ? ImVec4(0.8f, 0.8f, 0.8f, 1.0f) : ImVec4(0.6f, 0.4f, 0.4f, 1.0f));
                             
-                            ImGui::Text("Slot %d: %s", entry.index, entry.asset->GetAssetName().c_str());
+                            ImGui::Text("Slot %d: %s", entry.index, entry.asset->GetAssetName().data());
                             
                             if (hasData) {
                                 TextureAsset* txtr = reinterpret_cast<TextureAsset*>(texturePakAsset->extraData());
@@ -1066,7 +1100,7 @@ namespace ModernUI
             
             try {
                 // Basic asset name (safest operation)
-                std::string assetName = asset->GetAssetName();
+                std::string assetName(asset->GetAssetName());
                 ImGui::Text("Name: %s", assetName.empty() ? "Unknown" : assetName.c_str());
             } catch (...) {
                 ImGui::Text("Name: <Error reading name>");
@@ -1719,7 +1753,7 @@ namespace ModernUI
                 
                 for (CAsset* asset : assets)
                 {
-                    std::string assetLower = asset->GetAssetName();
+                    std::string assetLower(asset->GetAssetName());
                     std::transform(assetLower.begin(), assetLower.end(), assetLower.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
                     
                     if (assetLower.find(searchLower) != std::string::npos)
@@ -1763,7 +1797,7 @@ namespace ModernUI
                         // Add padding for better visual separation
                         ImGui::AlignTextToFramePadding();
                         
-                        if (ImGui::Selectable(asset->GetAssetName().c_str(), isSelected,
+                        if (ImGui::Selectable(asset->GetAssetName().data(), isSelected,
                                             ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowItemOverlap))
                         {
                             if (!ImGui::GetIO().KeyCtrl)
@@ -1802,7 +1836,7 @@ namespace ModernUI
                             }
                             if (ImGui::MenuItem("Copy Name"))
                             {
-                                ImGui::SetClipboardText(asset->GetAssetName().c_str());
+                                ImGui::SetClipboardText(asset->GetAssetName().data());
                             }
                             if (ImGui::MenuItem("Copy GUID"))
                             {
@@ -1915,6 +1949,14 @@ namespace ModernUI
 
         // Try to create and display the actual texture
         static std::unordered_map<void*, std::shared_ptr<CTexture>> renderedTextures;
+
+        static size_t textureCacheGeneration = 0ull;
+        if (AssetsUnloadedSince(textureCacheGeneration))
+        {
+            textureCache.clear();
+            renderedTextures.clear();
+            lastAsset = nullptr;
+        }
         
         auto textureIt = renderedTextures.find(pakAsset);
         std::shared_ptr<CTexture> displayTexture = nullptr;
@@ -2024,7 +2066,7 @@ namespace ModernUI
             ImGui::BeginGroup();
             {
                 // Asset name
-                ImGui::Text("%s", textureAsset->GetAssetName().c_str());
+                ImGui::Text("%s", textureAsset->GetAssetName().data());
                 
                 // Quick info in one line
                 ImGui::SameLine();
@@ -2058,6 +2100,13 @@ namespace ModernUI
             // Create render texture and display it
             static std::unordered_map<void*, std::shared_ptr<CTexture>> textureCache;
             static std::unordered_map<void*, float> zoomLevels;
+
+            static size_t textureCacheGeneration = 0ull;
+            if (AssetsUnloadedSince(textureCacheGeneration))
+            {
+                textureCache.clear();
+                zoomLevels.clear();
+            }
             
             auto textureIt = textureCache.find(pakAsset);
             std::shared_ptr<CTexture> displayTexture = nullptr;
@@ -2219,6 +2268,11 @@ namespace ModernUI
                 if (bindingIt != g_assetData.m_assetTypeBindings.end() && bindingIt->second.previewFunc)
                 {
                     static CAsset* lastPreviewedAsset = nullptr;
+
+                    static size_t previewGeneration = 0ull;
+                    if (AssetsUnloadedSince(previewGeneration))
+                        lastPreviewedAsset = nullptr;
+
                     const bool isFirstFrame = (lastPreviewedAsset != modelAsset);
                     
                     // Force first frame periodically to reload textures when debugging
@@ -2314,7 +2368,7 @@ namespace ModernUI
         // Model status line
         if (hasModelSelected && modelAsset)
         {
-            std::string modelInfo = "Model: " + modelAsset->GetAssetName();
+            std::string modelInfo = std::format("Model: {}", modelAsset->GetAssetName());
             bool modelLoaded = (previewDrawData != nullptr);
             
             if (modelLoaded) {
@@ -2912,7 +2966,7 @@ namespace ModernUI
                     uint32_t assetType = firstAsset->GetAssetType();
                     
                     // Show current asset info
-                    ImGui::Text("Selected: %s", firstAsset->GetAssetName().c_str());
+                    ImGui::Text("Selected: %s", firstAsset->GetAssetName().data());
                     
                     // Check for model types: 'MDL_', 'MDL', 'ARIG', 'ASEQ', 'ASQD', 'ANIR', 'SEQ', 'rmdl'
                     if (assetType == 0x5F6C646D || // 'mdl_'  
@@ -3000,6 +3054,11 @@ namespace ModernUI
             if (bindingIt != g_assetData.m_assetTypeBindings.end() && bindingIt->second.previewFunc) {
                 // Use the existing preview system
                 static std::unordered_map<CAsset*, bool> firstFrameMap;
+
+                static size_t firstFrameGeneration = 0ull;
+                if (AssetsUnloadedSince(firstFrameGeneration))
+                    firstFrameMap.clear();
+
                 bool isFirstFrame = (firstFrameMap.find(modelAsset) == firstFrameMap.end());
                 if (isFirstFrame) {
                     firstFrameMap[modelAsset] = true;
@@ -3136,7 +3195,7 @@ namespace ModernUI
             }
 
             // Display material header
-            ImGui::Text("Material: %s", materialAsset->GetAssetName().c_str());
+            ImGui::Text("Material: %s", materialAsset->GetAssetName().data());
             ImGui::Separator();
 
             // Basic material info
@@ -3162,6 +3221,13 @@ namespace ModernUI
                         // Popup state variables
                         static bool showTexturePopup = false;
                         static CAsset* popupTexture = nullptr;
+
+                        static size_t popupGeneration = 0ull;
+                        if (AssetsUnloadedSince(popupGeneration))
+                        {
+                            showTexturePopup = false;
+                            popupTexture = nullptr;
+                        }
                         
                         if (material->txtrAssets.empty()) {
                             ImGui::TextDisabled("No textures found in this material");
@@ -3208,8 +3274,8 @@ namespace ModernUI
                                     }
 
                                     if (ImGui::TableSetColumnIndex(3)) {
-                                        if (material->resourceBindings.count(entry.index)) {
-                                            ImGui::TextUnformatted(material->resourceBindings.at(entry.index).name);
+                                        if (material->ResourceBindings().count(entry.index)) {
+                                            ImGui::TextUnformatted(material->ResourceBindings().at(entry.index).name);
                                         } else {
                                             ImGui::TextDisabled("[unknown]");
                                         }
@@ -3249,13 +3315,13 @@ namespace ModernUI
                                             std::string buttonId = std::format("View##texture_{}", i);
                                             if (ImGui::Button(buttonId.c_str(), ImVec2(50, 0))) {
                                                 // Debug output
-                                                printf("View button clicked for texture: %s\n", entry.asset->GetAssetName().c_str());
+                                                LOG_DEBUG(RENDER, "View button clicked for texture: %s\n", entry.asset->GetAssetName().data());
                                                 
                                                 // Open texture popup
                                                 popupTexture = entry.asset;
                                                 showTexturePopup = true;
                                                 
-                                                printf("Popup state set: showTexturePopup=%d, popupTexture=%p\n", 
+                                                LOG_DEBUG(RENDER, "Popup state set: showTexturePopup=%d, popupTexture=%p\n", 
                                                     showTexturePopup, popupTexture);
                                             }
                                         } else {
@@ -3282,7 +3348,7 @@ namespace ModernUI
                                                 const TextureAsset* texAsset = reinterpret_cast<const TextureAsset*>(pakTexture->extraData());
                                                 if (texAsset) {
                                                     // Header
-                                                    ImGui::Text("Texture: %s", popupTexture->GetAssetName().c_str());
+                                                    ImGui::Text("Texture: %s", popupTexture->GetAssetName().data());
                                                     ImGui::Separator();
                                                     
                                                     // Content area with reserved space for close button
@@ -3985,7 +4051,7 @@ void LayoutManager::RenderMaterialSpherePreview(const void* materialData, CAsset
         }
 
         // Create new tab with just the filename
-        std::string fullPath = asset->GetAssetName();
+        std::string fullPath(asset->GetAssetName());
         std::string tabName;
 
         if (!fullPath.empty()) {
@@ -4156,7 +4222,7 @@ void LayoutManager::RenderMaterialSpherePreview(const void* materialData, CAsset
             default:
                 {
                     // Show basic asset info
-                    ImGui::Text("Asset: %s", tab.asset->GetAssetName().c_str());
+                    ImGui::Text("Asset: %s", tab.asset->GetAssetName().data());
                     ImGui::Text("Type: 0x%08X", tab.asset->GetAssetType());
 
                     // Try to show some content if possible
@@ -4227,7 +4293,7 @@ bool ModernUI::LayoutManager::CreateSkyboxResources()
     };
 
     m_modelViewerState.skyboxIndexCount = ARRAYSIZE(indices);
-    Log("Created skybox cube: %zu vertices, %zu indices\n", ARRAYSIZE(vertices), ARRAYSIZE(indices));
+    LOG_DEBUG(RENDER, "Created skybox cube: %zu vertices, %zu indices\n", ARRAYSIZE(vertices), ARRAYSIZE(indices));
 
     // Create vertex buffer
     D3D11_BUFFER_DESC vbDesc = {};
@@ -4257,7 +4323,7 @@ bool ModernUI::LayoutManager::CreateSkyboxResources()
     std::string basePath = "cubemap\\";
     std::vector<std::string> faceFiles = { "px.png", "nx.png", "py.png", "ny.png", "pz.png", "nz.png" };
 
-    Log("Loading cubemap from: %s\n", basePath.c_str());
+    LOG_DEBUG(RENDER, "Loading cubemap from: %s\n", basePath.c_str());
 
     // Load all face images
     std::vector<DirectX::ScratchImage> faceImages(6);
@@ -4270,7 +4336,7 @@ bool ModernUI::LayoutManager::CreateSkyboxResources()
 
         hr = DirectX::LoadFromWICFile(wFilePath.c_str(), DirectX::WIC_FLAGS_FORCE_RGB, nullptr, faceImages[face]);
         if (FAILED(hr)) {
-            Log("Failed to load skybox face: %s (HRESULT: 0x%08X)\n", filePath.c_str(), hr);
+            LOG_WARN(RENDER, "Failed to load skybox face: %s (HRESULT: 0x%08X)\n", filePath.c_str(), hr);
             allFacesLoaded = false;
             break;
         }
@@ -4280,12 +4346,12 @@ bool ModernUI::LayoutManager::CreateSkyboxResources()
             const DirectX::TexMetadata& metadata = faceImages[face].GetMetadata();
             width = static_cast<UINT>(metadata.width);
             height = static_cast<UINT>(metadata.height);
-            Log("Loaded skybox face %s: %dx%d, format: %d\n", faceFiles[face].c_str(), width, height, (int)metadata.format);
+            LOG_DEBUG(RENDER, "Loaded skybox face %s: %dx%d, format: %d\n", faceFiles[face].c_str(), width, height, (int)metadata.format);
         }
     }
 
     if (!allFacesLoaded || width == 0) {
-        Log("Failed to load all cubemap faces, creating fallback colored cubemap\n");
+        LOG_WARN(RENDER, "Failed to load all cubemap faces, creating fallback colored cubemap\n");
         
         // Create fallback colored cubemap
         width = height = 512;
@@ -4322,7 +4388,7 @@ bool ModernUI::LayoutManager::CreateSkyboxResources()
         hr = device->CreateTexture2D(&desc, subresources.data(), &m_modelViewerState.skyboxTexture);
         if (FAILED(hr)) return false;
         
-        Log("Created fallback colored cubemap\n");
+        LOG_INFO(RENDER, "Created fallback colored cubemap\n");
     }
     else {
         // Create cubemap from loaded images
@@ -4349,7 +4415,7 @@ bool ModernUI::LayoutManager::CreateSkyboxResources()
         hr = device->CreateTexture2D(&desc, subresources.data(), &m_modelViewerState.skyboxTexture);
         if (FAILED(hr)) return false;
 
-        Log("Successfully loaded cubemap (%dx%d) with %d faces\n", width, height, 6);
+        LOG_DEBUG(RENDER, "Successfully loaded cubemap (%dx%d) with %d faces\n", width, height, 6);
     }
 
     // Create shader resource view for cubemap
@@ -4361,18 +4427,18 @@ bool ModernUI::LayoutManager::CreateSkyboxResources()
 
     hr = device->CreateShaderResourceView(m_modelViewerState.skyboxTexture, &srvDesc, &m_modelViewerState.skyboxSRV);
     if (FAILED(hr)) {
-        Log("Failed to create skybox SRV with custom descriptor (HRESULT: 0x%08X), trying default...\n", hr);
+        LOG_WARN(RENDER, "Failed to create skybox SRV with custom descriptor (HRESULT: 0x%08X), trying default...\n", hr);
         
         // Try with default descriptor (nullptr)
         hr = device->CreateShaderResourceView(m_modelViewerState.skyboxTexture, nullptr, &m_modelViewerState.skyboxSRV);
         if (FAILED(hr)) {
-            Log("Failed to create skybox SRV with default descriptor (HRESULT: 0x%08X)\n", hr);
+            LOG_ERROR(RENDER, "Failed to create skybox SRV with default descriptor (HRESULT: 0x%08X)\n", hr);
             return false;
         }
-        Log("Successfully created skybox SRV with default descriptor\n");
+        LOG_DEBUG(RENDER, "Successfully created skybox SRV with default descriptor\n");
     }
 
-    Log("Skybox resources created successfully - SRV: %p\n", m_modelViewerState.skyboxSRV);
+    LOG_DEBUG(RENDER, "Skybox resources created successfully - SRV: %p\n", m_modelViewerState.skyboxSRV);
     return true;
 }
 
@@ -4399,7 +4465,7 @@ void ModernUI::LayoutManager::DestroySkyboxResources()
 void ModernUI::LayoutManager::RenderSkybox(ID3D11DeviceContext* context)
 {
     if (!m_modelViewerState.skyboxSRV || !m_modelViewerState.skyboxVertexBuffer || !m_modelViewerState.skyboxIndexBuffer) {
-        Log("Skybox render failed - missing resources: SRV=%p, VB=%p, IB=%p\n", 
+        LOG_ERROR(RENDER, "Skybox render failed - missing resources: SRV=%p, VB=%p, IB=%p\n", 
             m_modelViewerState.skyboxSRV, m_modelViewerState.skyboxVertexBuffer, m_modelViewerState.skyboxIndexBuffer);
         return;
     }
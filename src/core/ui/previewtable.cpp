@@ -0,0 +1,252 @@
+#include <pch.h>
+#include <core/ui/previewtable.h>
+
+#include <thirdparty/imgui/imgui_internal.h>
+
+void CPreviewTable::Reset(const size_t numRowsHint)
+{
+	m_columns.clear();
+
+	m_text.clear();
+	m_cellOffsets.clear();
+	m_cellOffsets.push_back(0ull);
+	m_numRows = 0ull;
+
+	m_rowColours.clear();
+
+	m_sortedRows.clear();
+	m_visibleRows.clear();
+
+	m_filterInput[0] = '\0';
+	m_sortDirty = true;
+	m_filterDirty = true;
+
+	m_sortedRows.reserve(numRowsHint);
+	m_visibleRows.reserve(numRowsHint);
+}
+
+void CPreviewTable::AddColumn(const char* const name, const ePreviewColumnSort sort)
+{
+	assertm(m_numRows == 0ull && m_cellOffsets.size() == 1, "columns should be added before any cells");
+
+	m_columns.push_back({ name, sort, {} });
+}
+
+void CPreviewTable::AddCell(const char* const text, const double sortValue)
+{
+	AddCell(text, strlen(text), sortValue);
+}
+
+void CPreviewTable::AddCell(const char* const text, const size_t length, const double sortValue)
+{
+	m_text.append(text, length);
+	EndCell(sortValue);
+}
+
+void CPreviewTable::EndCell(const double sortValue)
+{
+	assertm(!m_columns.empty(), "cells need columns");
+
+	const size_t column = (m_cellOffsets.size() - 1) % NumColumns();
+
+	if (m_columns[column].sort == ePreviewColumnSort::NUMBER)
+		m_columns[column].values.push_back(sortValue);
+
+	// the clipper expects every row to be one line high
+	std::replace_if(m_text.begin() + m_cellOffsets.back(), m_text.end(), [](const char c) { return c == '\n' || c == '\r'; }, ' ');
+
+	m_cellOffsets.push_back(m_text.length());
+
+	// last cell of the row, it can now be shown
+	if (column == NumColumns() - 1)
+	{
+		m_sortedRows.push_back(static_cast<uint32_t>(m_numRows));
+		m_numRows++;
+
+		m_sortDirty = true;
+		m_filterDirty = true;
+	}
+}
+
+void CPreviewTable::SetRowColour(const ImU32 colour)
+{
+	// zero is no colour
+	m_rowColours.resize(m_numRows + 1, 0u);
+	m_rowColours[m_numRows] = colour;
+}
+
+void CPreviewTable::Sort(const ImGuiTableSortSpecs* const sortSpecs)
+{
+	PROFILE_SCOPE("preview table sort");
+
+	// back to the order the rows were added in, then sorted stable so ties keep it
+	for (uint32_t i = 0; i < m_sortedRows.size(); i++)
+		m_sortedRows[i] = i;
+
+	if (sortSpecs->SpecsCount > 0)
+	{
+		std::stable_sort(m_sortedRows.begin(), m_sortedRows.end(), [this, sortSpecs](const uint32_t a, const uint32_t b)
+			{
+				for (int i = 0; i < sortSpecs->SpecsCount; i++)
+				{
+					const ImGuiTableColumnSortSpecs* const spec = &sortSpecs->Specs[i];
+					const size_t column = static_cast<size_t>(spec->ColumnUserID);
+
+					int delta = 0;
+
+					switch (m_columns[column].sort)
+					{
+					case ePreviewColumnSort::NUMBER:
+					{
+						const double valueA = m_columns[column].values[a];
+						const double valueB = m_columns[column].values[b];
+
+						delta = valueA < valueB ? -1 : (valueA > valueB ? 1 : 0);
+						break;
+					}
+					case ePreviewColumnSort::TEXT:
+					{
+						const size_t cellA = (a * NumColumns()) + column;
+						const size_t cellB = (b * NumColumns()) + column;
+
+						const std::string_view textA(CellText(cellA), CellTextEnd(cellA));
+						const std::string_view textB(CellText(cellB), CellTextEnd(cellB));
+
+						delta = textA.compare(textB);
+						break;
+					}
+					case ePreviewColumnSort::NONE:
+					default:
+						break;
+					}
+
+					if (delta)
+						return spec->SortDirection == ImGuiSortDirection_Ascending ? delta < 0 : delta > 0;
+				}
+
+				return false;
+			});
+	}
+
+	m_filterDirty = true;
+}
+
+// case insensitive match against any cell of the row
+void CPreviewTable::ApplyFilter()
+{
+	PROFILE_SCOPE("preview table filter");
+
+	m_visibleRows.clear();
+
+	const size_t filterLength = strlen(m_filterInput);
+
+	if (!filterLength)
+	{
+		m_visibleRows.assign(m_sortedRows.begin(), m_sortedRows.end());
+		m_filterDirty = false;
+
+		return;
+	}
+
+	for (const uint32_t row : m_sortedRows)
+	{
+		const size_t firstCell = row * NumColumns();
+
+		for (size_t cell = firstCell; cell < firstCell + NumColumns(); cell++)
+		{
+			if (ImStristr(CellText(cell), CellTextEnd(cell), m_filterInput, m_filterInput + filterLength))
+			{
+				m_visibleRows.push_back(row);
+				break;
+			}
+		}
+	}
+
+	m_filterDirty = false;
+}
+
+void CPreviewTable::Draw(const char* const id, const ImVec2& size)
+{
+	PROFILE_SCOPE("preview table draw");
+
+	if (m_columns.empty())
+		return;
+
+	ImGui::PushID(id);
+
+	if (ImGui::InputTextWithHint("##Filter", "Filter", m_filterInput, sizeof(m_filterInput)))
+		m_filterDirty = true;
+
+	if (m_filterDirty)
+		ApplyFilter();
+
+	ImGui::SameLine();
+	ImGui::Text("%llu / %llu rows", m_visibleRows.size(), m_numRows);
+
+	const bool sortable = std::ranges::any_of(m_columns, [](const Column_t& column) { return column.sort != ePreviewColumnSort::NONE; });
+
+	// tristate so the rows can go back to the order they were added in
+	const ImGuiTableFlags tableFlags =
+		ImGuiTableFlags_Resizable | ImGuiTableFlags_Hideable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders
+		| ImGuiTableFlags_ScrollY | ImGuiTableFlags_ScrollX | ImGuiTableFlags_SizingFixedFit
+		| (sortable ? ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti | ImGuiTableFlags_SortTristate : ImGuiTableFlags_None);
+
+	const int numColumns = static_cast<int>(NumColumns());
+
+	if (ImGui::BeginTable(id, numColumns, tableFlags, size))
+	{
+		for (int i = 0; i < numColumns; i++)
+		{
+			const ImGuiTableColumnFlags sortFlags = m_columns[i].sort == ePreviewColumnSort::NONE ? ImGuiTableColumnFlags_NoSort : ImGuiTableColumnFlags_None;
+			ImGui::TableSetupColumn(m_columns[i].name.c_str(), ImGuiTableColumnFlags_WidthFixed | sortFlags, 0.0f, static_cast<ImGuiID>(i));
+		}
+
+		ImGui::TableSetupScrollFreeze(0, 1);
+
+		ImGuiTableSortSpecs* const sortSpecs = ImGui::TableGetSortSpecs();
+
+		// a new table keeps the sort the user picked for the last one
+		if (sortSpecs && (sortSpecs->SpecsDirty || m_sortDirty))
+		{
+			Sort(sortSpecs);
+			ApplyFilter();
+
+			sortSpecs->SpecsDirty = false;
+			m_sortDirty = false;
+		}
+
+		ImGui::TableHeadersRow();
+
+		// only the rows in view are submitted, and only the columns in view within them
+		ImGuiListClipper clipper;
+		clipper.Begin(static_cast<int>(m_visibleRows.size()));
+		while (clipper.Step())
+		{
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+			{
+				const size_t row = m_visibleRows[i];
+				const size_t firstCell = row * NumColumns();
+
+				const ImU32 colour = row < m_rowColours.size() ? m_rowColours[row] : 0u;
+
+				if (colour)
+					ImGui::PushStyleColor(ImGuiCol_Text, colour);
+
+				ImGui::TableNextRow();
+
+				for (int j = 0; j < numColumns; j++)
+				{
+					if (ImGui::TableSetColumnIndex(j))
+						ImGui::TextUnformatted(CellText(firstCell + j), CellTextEnd(firstCell + j));
+				}
+
+				if (colour)
+					ImGui::PopStyleColor();
+			}
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::PopID();
+}
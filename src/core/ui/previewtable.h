@@ -0,0 +1,74 @@
+#pragma once
+#include <thirdparty/imgui/imgui.h>
+
+enum class ePreviewColumnSort : uint8_t
+{
+	NONE,
+	TEXT,	// by the cell text
+	NUMBER,	// by the value passed with the cell
+};
+
+// virtualized table for previewing large tabular and text assets
+// every cell is formatted once when the asset is selected and kept back to back in one buffer, drawing only touches the rows and columns in view
+// sorting and filtering never move the cells, they rebuild a permutation of row indices when the sort specs or the filter change
+class CPreviewTable
+{
+public:
+	CPreviewTable() : m_numRows(0ull), m_sortDirty(false), m_filterDirty(false), m_filterInput() {};
+
+	// drops the previous table, columns are then set up once and rows added left to right
+	void Reset(const size_t numRowsHint);
+	void AddColumn(const char* const name, const ePreviewColumnSort sort);
+
+	void AddCell(const char* const text, const double sortValue = 0.0);
+	void AddCell(const char* const text, const size_t length, const double sortValue = 0.0);
+
+	template <class... Args>
+	void AddCellFormat(const double sortValue, const std::format_string<Args...> fmt, Args&&... args)
+	{
+		std::format_to(std::back_inserter(m_text), fmt, std::forward<Args>(args)...);
+		EndCell(sortValue);
+	}
+
+	// for text that is appended straight into the buffer, finish the cell with EndCell
+	inline std::string& CellBuffer() { return m_text; };
+	void EndCell(const double sortValue = 0.0);
+
+	// text colour for the row currently being added, rows without one use the style colour
+	void SetRowColour(const ImU32 colour);
+
+	void Draw(const char* const id, const ImVec2& size);
+
+	inline const size_t NumRows() const { return m_numRows; };
+	inline const std::vector<uint32_t>& VisibleRows() const { return m_visibleRows; }; // in the order they are drawn
+
+private:
+	struct Column_t
+	{
+		std::string name;
+		ePreviewColumnSort sort;
+		std::vector<double> values; // per row, only for NUMBER columns
+	};
+
+	inline const size_t NumColumns() const { return m_columns.size(); };
+	inline const char* const CellText(const size_t cell) const { return m_text.data() + m_cellOffsets[cell]; };
+	inline const char* const CellTextEnd(const size_t cell) const { return m_text.data() + m_cellOffsets[cell + 1]; };
+
+	void Sort(const ImGuiTableSortSpecs* const sortSpecs);
+	void ApplyFilter();
+
+	std::vector<Column_t> m_columns;
+
+	std::string m_text;
+	std::vector<size_t> m_cellOffsets; // one per cell plus the end, a cell's text runs up to the next offset
+	size_t m_numRows;
+
+	std::vector<ImU32> m_rowColours; // empty unless a row was given one
+
+	std::vector<uint32_t> m_sortedRows;
+	std::vector<uint32_t> m_visibleRows; // sorted rows that pass the filter
+
+	bool m_sortDirty; // rows were added since the last sort, imgui only flags the specs dirty when they change
+	bool m_filterDirty;
+	char m_filterInput[128];
+};
@@ -44,8 +44,13 @@ public:
 #if defined(ASSERTS)
 		assertm(openSlots.empty() == false, "at least one slot should always be open");
 #endif
+		PROFILE_COUNTER_ADD(eProfileCounter::BUFFER_CLAIMS, 1);
+
 		if (openSlots.empty())
+		{
+			PROFILE_COUNTER_ADD(eProfileCounter::BUFFER_CLAIM_FAILURES, 1);
 			return nullptr;
+		}
 
 		std::unique_lock<std::mutex> lock(bufferMutex);
 		const uint8_t index = openSlots.top();
@@ -46,6 +46,30 @@ public:
 		return argv[idx];
 	}
 
+	// get the value that follows a param (e.g. "-threads 4"), nullptr if the param or its value is missing
+	const char* const GetParamArgument(const char* const param) const
+	{
+		assert(param);
+		const int idx = HasParam(param);
+		return (idx != -1 && (idx + 1) < argc) ? argv[idx + 1] : nullptr;
+	}
+
+	// get the values of a param that can be passed more than once (e.g. "-in a.rpak -in b.rpak")
+	const std::vector<std::string> GetParamArguments(const char* const param) const
+	{
+		assert(param);
+		std::vector<std::string> values;
+		for (int i = 1; i < (argc - 1); ++i)
+		{
+			if (strcmp(argv[i], param) == 0)
+			{
+				values.emplace_back(argv[++i]);
+			}
+		}
+
+		return values;
+	}
+
 	inline const int GetArgC() const
 	{
 		return argc;
@@ -7,10 +7,12 @@ struct ExportSettings_t
     uint32_t exportTextureNameSetting;
 
     bool exportMaterialTextures;
+    bool exportTextureDedupe; // reuse previously exported files for textures with identical data, see CTextureExportStore
 
     // misc
     bool exportPathsFull;
     bool exportAssetDeps;
+    bool exportIncremental; // skip assets whose last export is still current, see CExportManifest
 
     // model settings
     uint32_t previewedSkinIndex;
@@ -22,12 +24,21 @@ struct ExportSettings_t
     bool exportRigSequences;        // export sequences with a model or rig
     bool exportModelSkin;           // export the selected skin for a model
     bool exportModelMatsTruncated;  // truncate material names in model files
-    bool _unusedPadModel;
+    bool exportSeqKeyReduction;     // drop sequence keys that interpolating their neighbours reproduces, see keyreduce.h
+
+    // sequence keyframe reduction tolerances
+    float exportSeqKeyPosTolerance;     // units
+    float exportSeqKeyRotTolerance;     // degrees
+    float exportSeqKeyScaleTolerance;
 
     // model physics settings
     uint32_t exportPhysicsContentsFilter;
     bool exportPhysicsFilterExclusive;
     bool exportPhysicsFilterAND;
+
+    // audio settings
+    uint32_t exportAudioFlacLevel;     // flac compression level, 0-8
+    uint32_t exportAudioFlacBitDepth;  // see eAudioFlacBitDepth
 };
 
 enum eNormalExportRecalc : uint32_t
@@ -64,6 +75,20 @@ static const char* s_TextureExportNameSetting[eTextureExportName::TXTR_NAME_COUN
     "Semantic",
 };
 
+enum eAudioFlacBitDepth : uint32_t
+{
+    AUDIO_FLAC_16BIT,
+    AUDIO_FLAC_24BIT,
+
+    AUDIO_FLAC_BITS_COUNT,
+};
+
+static const char* s_AudioFlacBitDepthSetting[eAudioFlacBitDepth::AUDIO_FLAC_BITS_COUNT] =
+{
+    "16 bit",
+    "24 bit",
+};
+
 // preview settings
 #define PREVIEW_CULL_DEFAULT    1000.0f
 #define PREVIEW_CULL_MIN        256.0f // map max size
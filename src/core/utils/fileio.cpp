@@ -31,6 +31,99 @@ bool RestoreCurrentWorkingDirectory()
     return true;
 }
 
+static thread_local CWrittenFileTracker* s_writtenFileTracker = nullptr;
+
+CWrittenFileTracker::CWrittenFileTracker() : m_prev(s_writtenFileTracker)
+{
+    s_writtenFileTracker = this;
+}
+
+CWrittenFileTracker::~CWrittenFileTracker()
+{
+    s_writtenFileTracker = m_prev;
+}
+
+void CWrittenFileTracker::Record(const std::filesystem::path& path)
+{
+    CWrittenFileTracker* const tracker = s_writtenFileTracker;
+    if (!tracker)
+        return;
+
+    std::string file = path.string();
+
+    std::lock_guard lock(tracker->m_fileMutex);
+    if (std::find(tracker->m_files.begin(), tracker->m_files.end(), file) == tracker->m_files.end())
+        tracker->m_files.emplace_back(std::move(file));
+}
+
+CWrittenFileTracker* const CWrittenFileTracker::Current()
+{
+    return s_writtenFileTracker;
+}
+
+void CWrittenFileTracker::SetCurrent(CWrittenFileTracker* const tracker)
+{
+    s_writtenFileTracker = tracker;
+}
+
+const std::vector<std::string> CWrittenFileTracker::Files() const
+{
+    std::lock_guard lock(m_fileMutex);
+    return m_files;
+}
+
+const bool CMappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    m_file = file;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping)
+    {
+        Close();
+        return false;
+    }
+
+    m_data = reinterpret_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data)
+    {
+        Close();
+        return false;
+    }
+
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void CMappedFile::Close()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    if (m_file)
+        CloseHandle(m_file);
+
+    m_file = nullptr;
+    m_mapping = nullptr;
+    m_data = nullptr;
+    m_size = 0ull;
+}
+
 namespace FileSystem
 {
 
@@ -7,6 +7,34 @@ enum class eStreamIOMode : uint8_t
     Write
 };
 
+// collects the files opened for writing by the thread that created it, and by the workers of any CParallelTask run from that thread
+// exporters don't report the files they write, this is how the export manifest learns them
+class CWrittenFileTracker
+{
+public:
+    CWrittenFileTracker();
+    ~CWrittenFileTracker();
+
+    CWrittenFileTracker(const CWrittenFileTracker&) = delete;
+    CWrittenFileTracker& operator=(const CWrittenFileTracker&) = delete;
+
+    // adds the path to the calling thread's tracker, does nothing if it has none
+    static void Record(const std::filesystem::path& path);
+
+    // for handing a tracker to worker threads
+    static CWrittenFileTracker* const Current();
+    static void SetCurrent(CWrittenFileTracker* const tracker);
+
+    // paths in the order they were first written, without duplicates
+    const std::vector<std::string> Files() const;
+
+private:
+    CWrittenFileTracker* m_prev;
+
+    mutable std::mutex m_fileMutex;
+    std::vector<std::string> m_files;
+};
+
 class StreamIO
 {
 public:
@@ -38,6 +66,10 @@ public:
             {
                 currentMode = eStreamIOMode::None;
             }
+            else
+            {
+                CWrittenFileTracker::Record(path);
+            }
         }
         // Read mode
         else if (mode == eStreamIOMode::Read)
@@ -167,12 +199,16 @@ public:
         }
     }
 
-    void read(char* const buf, const size_t size)
+    // returns false if the file ended (or failed) before size bytes were read
+    const bool read(char* const buf, const size_t size)
     {
         if (checkReadabilityStatus())
         {
             reader.read(buf, size);
+            return static_cast<size_t>(reader.gcount()) == size;
         }
+
+        return size == 0ull;
     }
 
     const std::string readString()
@@ -275,6 +311,32 @@ private:
     eStreamIOMode currentMode;
 };
 
+// read only view of a whole file, the view is unmapped when this goes out of scope
+// empty or missing files fail to open
+class CMappedFile
+{
+public:
+    CMappedFile() : m_file(nullptr), m_mapping(nullptr), m_data(nullptr), m_size(0ull) {};
+    CMappedFile(const std::filesystem::path& path) : CMappedFile() { Open(path); };
+    ~CMappedFile() { Close(); };
+
+    CMappedFile(const CMappedFile&) = delete;
+    CMappedFile& operator=(const CMappedFile&) = delete;
+
+    const bool Open(const std::filesystem::path& path);
+    void Close();
+
+    inline const bool IsOpen() const { return m_data != nullptr; };
+    inline const char* const Data() const { return m_data; };
+    inline const size_t Size() const { return m_size; };
+
+private:
+    void* m_file;
+    void* m_mapping;
+    const char* m_data;
+    size_t m_size;
+};
+
 bool CreateDirectories(const std::filesystem::path& exportPath);
 bool RestoreCurrentWorkingDirectory();
 
@@ -0,0 +1,180 @@
+#include <pch.h>
+
+#include <core/utils/interner.h>
+
+// claims size bytes, from a released range if one fits or the end of the current block
+char* const CStringInterner::Allocate(const size_t size)
+{
+    if (const auto it = m_freeRanges.lower_bound(size); it != m_freeRanges.end())
+    {
+        const size_t rangeSize = it->first;
+        char* const range = it->second;
+
+        m_freeRanges.erase(it);
+        m_freeBytes -= rangeSize;
+
+        // the rest of a bigger range stays free
+        if (rangeSize > size)
+        {
+            m_freeRanges.emplace(rangeSize - size, range + size);
+            m_freeBytes += rangeSize - size;
+        }
+
+        return range;
+    }
+
+    if (m_blocks.empty() || m_blockUsed + size > m_blockSize)
+    {
+        // oversized strings get a block of their own
+        m_blockSize = std::max(s_blockSize, size);
+        m_blockUsed = 0ull;
+
+        m_blocks.emplace_back(std::make_unique<char[]>(m_blockSize));
+        m_blockBytes += m_blockSize;
+    }
+
+    char* const dest = m_blocks.back().get() + m_blockUsed;
+    m_blockUsed += size;
+
+    return dest;
+}
+
+void CStringInterner::GrowTable()
+{
+    // only grows when the live strings fill it, a table that is full of tombstones is rebuilt at the same size
+    const size_t newSize = m_table.empty() ? s_initialTableSize : ((m_count + 1) * 2 > m_table.size() ? m_table.size() << 1 : m_table.size());
+    std::vector<Entry_t> newTable(newSize, Entry_t{ nullptr, 0u, 0u, 0u });
+
+    for (const Entry_t& entry : m_table)
+    {
+        if (!IsLive(entry))
+            continue;
+
+        size_t slot = entry.hash & (newSize - 1);
+        while (newTable[slot].str)
+            slot = (slot + 1) & (newSize - 1);
+
+        newTable[slot] = entry;
+    }
+
+    m_table = std::move(newTable);
+    m_tombstones = 0ull;
+}
+
+const std::string_view CStringInterner::Intern(const std::string_view str, const bool normalizeSeparators)
+{
+    const size_t length = str.length();
+    assertm(length < UINT32_MAX, "string too long to intern");
+
+    // hash as the string will be stored, so lookups don't need a copy
+    uint32_t hash = 2166136261u; // fnv-1a
+    for (size_t i = 0; i < length; ++i)
+    {
+        const char c = (normalizeSeparators && str[i] == '/') ? '\\' : str[i];
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+
+    const auto matches = [&str, length, normalizeSeparators](const char* const existing)
+        {
+            for (size_t i = 0; i < length; ++i)
+            {
+                const char c = (normalizeSeparators && str[i] == '/') ? '\\' : str[i];
+                if (existing[i] != c)
+                    return false;
+            }
+
+            return true;
+        };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if ((m_count + m_tombstones + 1) * 2 > m_table.size())
+        GrowTable();
+
+    const size_t mask = m_table.size() - 1;
+    size_t slot = hash & mask;
+    size_t insertSlot = SIZE_MAX;
+
+    while (const char* const existing = m_table[slot].str)
+    {
+        if (existing == s_tombstone)
+        {
+            if (insertSlot == SIZE_MAX)
+                insertSlot = slot;
+        }
+        else if (m_table[slot].hash == hash && m_table[slot].length == length && matches(existing))
+        {
+            m_table[slot].refs++;
+            return std::string_view(existing, length);
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    if (insertSlot == SIZE_MAX)
+        insertSlot = slot;
+    else
+        m_tombstones--;
+
+    char* const dest = Allocate(length + 1);
+    for (size_t i = 0; i < length; ++i)
+        dest[i] = (normalizeSeparators && str[i] == '/') ? '\\' : str[i];
+
+    dest[length] = '\0';
+
+    m_table[insertSlot] = { dest, static_cast<uint32_t>(length), hash, 1u };
+    m_count++;
+
+    return std::string_view(dest, length);
+}
+
+void CStringInterner::Release(const std::string_view str)
+{
+    uint32_t hash = 2166136261u;
+    for (const char c : str)
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    if (m_table.empty())
+        return;
+
+    const size_t mask = m_table.size() - 1;
+    size_t slot = hash & mask;
+
+    while (const char* const existing = m_table[slot].str)
+    {
+        // same storage, not just the same text, a view into another interner's block isn't ours to free
+        if (existing != s_tombstone && existing == str.data() && m_table[slot].length == str.length())
+        {
+            Entry_t& entry = m_table[slot];
+            if (--entry.refs > 0u)
+                return;
+
+            m_freeRanges.emplace(str.length() + 1, const_cast<char*>(existing));
+            m_freeBytes += str.length() + 1;
+
+            entry = { s_tombstone, 0u, 0u, 0u };
+            m_count--;
+            m_tombstones++;
+
+            return;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+}
+
+const size_t CStringInterner::MemoryUsage() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    return m_blockBytes + (m_table.capacity() * sizeof(Entry_t));
+}
+
+const size_t CStringInterner::FreeBytes() const
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    return m_freeBytes;
+}
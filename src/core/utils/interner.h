@@ -0,0 +1,64 @@
+#pragma once
+
+// stores strings back to back in large blocks instead of one heap allocation per string, identical strings are stored once
+// interned strings are null terminated and stay valid until the interner is destroyed or every reference to them is released,
+// so each asset container owns one
+class CStringInterner
+{
+public:
+    CStringInterner() : m_blockUsed(0ull), m_blockSize(0ull), m_blockBytes(0ull), m_freeBytes(0ull), m_count(0ull), m_tombstones(0ull) {};
+    ~CStringInterner() = default;
+
+    CStringInterner(const CStringInterner&) = delete;
+    CStringInterner& operator=(const CStringInterner&) = delete;
+
+    // normalizeSeparators replaces '/' with '\\' while copying, same result as std::filesystem::path::make_preferred on windows
+    // every call adds a reference to the returned string
+    const std::string_view Intern(const std::string_view str, const bool normalizeSeparators = false);
+
+    // drops a reference taken by Intern, the space of a string nothing references anymore is reused by later strings
+    // strings that didn't come from this interner are ignored
+    void Release(const std::string_view str);
+
+    const size_t Count() const { return m_count; };
+    const size_t MemoryUsage() const;
+
+    // bytes in blocks that were released and not reused yet
+    const size_t FreeBytes() const;
+
+private:
+    struct Entry_t
+    {
+        const char* str;
+        uint32_t length;
+        uint32_t hash;
+        uint32_t refs;
+    };
+
+    char* const Allocate(const size_t size);
+    void GrowTable();
+
+    static const bool IsLive(const Entry_t& entry) { return entry.str && entry.str != s_tombstone; };
+
+    static constexpr size_t s_blockSize = 64ull * 1024ull;
+    static constexpr size_t s_initialTableSize = 1024ull;
+
+    // marks a released slot, probing continues past it
+    static constexpr const char* s_tombstone = "";
+
+    mutable std::mutex m_mutex;
+
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    size_t m_blockUsed;
+    size_t m_blockSize;
+    size_t m_blockBytes; // total size of every block
+
+    // released ranges by size, reused best fit before the current block grows
+    std::multimap<size_t, char*> m_freeRanges;
+    size_t m_freeBytes;
+
+    // open addressing, power of two sized and kept at most half full (tombstones included)
+    std::vector<Entry_t> m_table;
+    size_t m_count;
+    size_t m_tombstones;
+};
@@ -0,0 +1,203 @@
+#include <pch.h>
+
+#include <core/utils/profiler.h>
+#include <game/rtech/utils/utils.h>
+
+CProfiler g_profiler;
+
+class CProfileThreadBuffer
+{
+public:
+    // 32k events per thread, once full the oldest events are overwritten
+    static constexpr uint64_t capacity = 1ull << 15;
+
+    CProfileThreadBuffer(const uint32_t laneIndex) : lane(laneIndex), written(0ull), events(std::make_unique<ProfileEvent_t[]>(capacity)) {};
+
+    // only the owning thread writes, readers only look at events below 'written'
+    FORCEINLINE void Add(const ProfileEvent_t& event)
+    {
+        const uint64_t index = written.load(std::memory_order_relaxed);
+        events[index & (capacity - 1)] = event;
+        written.store(index + 1, std::memory_order_release);
+    }
+
+    const uint32_t lane; // tid in the trace, shared by every thread that has owned this buffer
+    std::atomic<uint64_t> written;
+    std::unique_ptr<ProfileEvent_t[]> events;
+};
+
+// hands the buffer back when the owning thread exits
+struct ProfileThreadHandle_t
+{
+    ~ProfileThreadHandle_t()
+    {
+        if (buffer)
+            g_profiler.RelieveThreadBuffer(buffer);
+    }
+
+    CProfileThreadBuffer* buffer = nullptr;
+};
+
+static thread_local ProfileThreadHandle_t s_threadBuffer;
+
+CProfiler::~CProfiler()
+{
+    for (CProfileThreadBuffer* const buffer : m_buffers)
+        delete buffer;
+}
+
+void CProfiler::SetEnabled(const bool enabled)
+{
+    if (enabled)
+    {
+        std::unique_lock<std::mutex> lock(m_bufferMutex);
+
+        for (CProfileThreadBuffer* const buffer : m_buffers)
+            buffer->written.store(0ull, std::memory_order_relaxed);
+
+        for (std::atomic<uint64_t>& counter : m_counters)
+            counter.store(0ull, std::memory_order_relaxed);
+
+        m_epoch = std::chrono::steady_clock::now();
+    }
+
+    m_enabled.store(enabled, std::memory_order_release);
+}
+
+CProfileThreadBuffer* CProfiler::ClaimThreadBuffer()
+{
+    std::unique_lock<std::mutex> lock(m_bufferMutex);
+
+    if (!m_openBuffers.empty())
+    {
+        CProfileThreadBuffer* const buffer = m_openBuffers.top();
+        m_openBuffers.pop();
+
+        return buffer;
+    }
+
+    CProfileThreadBuffer* const buffer = new CProfileThreadBuffer(static_cast<uint32_t>(m_buffers.size()));
+    m_buffers.push_back(buffer);
+
+    return buffer;
+}
+
+void CProfiler::RelieveThreadBuffer(CProfileThreadBuffer* const buffer)
+{
+    std::unique_lock<std::mutex> lock(m_bufferMutex);
+    m_openBuffers.push(buffer);
+}
+
+void CProfiler::AddEvent(const char* const name, const uint32_t type, const int64_t start, const int64_t duration)
+{
+    if (!s_threadBuffer.buffer)
+        s_threadBuffer.buffer = ClaimThreadBuffer();
+
+    s_threadBuffer.buffer->Add({ name, type, start, duration });
+}
+
+const char* const CProfiler::GetCounterName(const eProfileCounter counter)
+{
+    switch (counter)
+    {
+    case eProfileCounter::BYTES_DECOMPRESSED:       return "bytes_decompressed";
+    case eProfileCounter::ASSETS_LOADED:            return "assets_loaded";
+    case eProfileCounter::ASSETS_POSTLOADED:        return "assets_postloaded";
+    case eProfileCounter::ASSETS_EXPORTED:          return "assets_exported";
+    case eProfileCounter::ASSETS_EXPORT_SKIPPED:    return "assets_export_skipped";
+    case eProfileCounter::BUFFER_CLAIMS:            return "buffer_claims";
+    case eProfileCounter::BUFFER_CLAIM_FAILURES:    return "buffer_claim_failures";
+    case eProfileCounter::RAMEN_BYTES_IN:           return "ramen_bytes_in";
+    case eProfileCounter::RAMEN_BYTES_OUT:          return "ramen_bytes_out";
+    default:                                        return "unknown";
+    }
+}
+
+static const std::string ProfileEventName(const ProfileEvent_t& event)
+{
+    if (event.type == 0u)
+        return event.name;
+
+    return std::format("{} {}", event.name, fourCCToString(event.type));
+}
+
+// calls func for every event still held in the ring buffers
+template <typename Function>
+static void ForEachProfileEvent(const std::vector<CProfileThreadBuffer*>& buffers, Function&& func)
+{
+    for (const CProfileThreadBuffer* const buffer : buffers)
+    {
+        const uint64_t written = buffer->written.load(std::memory_order_acquire);
+        const uint64_t first = written > CProfileThreadBuffer::capacity ? written - CProfileThreadBuffer::capacity : 0ull;
+
+        for (uint64_t i = first; i < written; ++i)
+            func(buffer->lane, buffer->events[i & (CProfileThreadBuffer::capacity - 1)]);
+    }
+}
+
+std::vector<ProfileSummary_t> CProfiler::GetSummary() const
+{
+    std::unordered_map<std::string, ProfileSummary_t> entries;
+
+    {
+        std::unique_lock<std::mutex> lock(m_bufferMutex);
+
+        ForEachProfileEvent(m_buffers, [&entries](const uint32_t lane, const ProfileEvent_t& event)
+            {
+                UNUSED(lane);
+
+                const std::string name = ProfileEventName(event);
+                ProfileSummary_t& entry = entries.try_emplace(name, ProfileSummary_t{ name, 0ull, 0ll, 0ll }).first->second;
+
+                entry.count++;
+                entry.totalNs += event.duration;
+                entry.maxNs = std::max(entry.maxNs, event.duration);
+            });
+    }
+
+    std::vector<ProfileSummary_t> summary;
+    summary.reserve(entries.size());
+
+    for (auto& it : entries)
+        summary.push_back(std::move(it.second));
+
+    std::sort(summary.begin(), summary.end(), [](const ProfileSummary_t& a, const ProfileSummary_t& b) { return a.totalNs > b.totalNs; });
+
+    return summary;
+}
+
+const bool CProfiler::WriteChromeTrace(const std::filesystem::path& path) const
+{
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+
+    {
+        std::unique_lock<std::mutex> lock(m_bufferMutex);
+
+        ForEachProfileEvent(m_buffers, [&out, &first](const uint32_t lane, const ProfileEvent_t& event)
+            {
+                // names are literals or fourccs, neither need escaping
+                out << std::format("{}{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                    first ? "" : ",\n", ProfileEventName(event), event.name, lane, static_cast<double>(event.start) / 1000.0, static_cast<double>(event.duration) / 1000.0);
+
+                first = false;
+            });
+    }
+
+    out << "\n],\"otherData\":{";
+
+    for (uint8_t i = 0; i < static_cast<uint8_t>(eProfileCounter::_COUNT); ++i)
+    {
+        const eProfileCounter counter = static_cast<eProfileCounter>(i);
+        out << std::format("{}\"{}\":\"{}\"", i == 0 ? "" : ",", GetCounterName(counter), GetCounter(counter));
+    }
+
+    out << "}}\n";
+
+    return !out.fail();
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+
+// timers and counters for the load and export stages
+// every thread records into its own ring buffer, nothing is shared while recording besides the counters
+// output is a chrome trace (chrome://tracing, ui.perfetto.dev) and a summary table
+// without PROFILER defined every macro below compiles to nothing, when defined but not enabled a scope costs one relaxed load
+
+enum class eProfileCounter : uint8_t
+{
+    BYTES_DECOMPRESSED,     // decompressed output of pakfiles and streamed buffers
+    ASSETS_LOADED,
+    ASSETS_POSTLOADED,
+    ASSETS_EXPORTED,
+    ASSETS_EXPORT_SKIPPED,  // up to date in the export manifest
+    BUFFER_CLAIMS,          // CBufferManager::ClaimBuffer calls
+    BUFFER_CLAIM_FAILURES,  // claims with no open slot, these would otherwise wait on a buffer
+    RAMEN_BYTES_IN,
+    RAMEN_BYTES_OUT,
+
+    _COUNT,
+};
+
+struct ProfileEvent_t
+{
+    const char* name;   // should be a literal, it is only read when writing the output
+    uint32_t type;      // asset type of the event, zero if none. events are grouped by name and type
+    int64_t start;      // nanoseconds since the profiler was enabled
+    int64_t duration;
+};
+
+struct ProfileSummary_t
+{
+    std::string name;
+    uint64_t count;
+    int64_t totalNs;
+    int64_t maxNs;
+};
+
+class CProfileThreadBuffer;
+struct ProfileThreadHandle_t;
+
+class CProfiler
+{
+public:
+    CProfiler() : m_enabled(false), m_epoch(std::chrono::steady_clock::now()) {};
+    ~CProfiler();
+
+    FORCEINLINE const bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); };
+
+    // enabling clears anything recorded previously
+    void SetEnabled(const bool enabled);
+
+    FORCEINLINE const int64_t Now() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count(); };
+
+    void AddEvent(const char* const name, const uint32_t type, const int64_t start, const int64_t duration);
+    FORCEINLINE void AddCounter(const eProfileCounter counter, const uint64_t value)
+    {
+        if (IsEnabled())
+            m_counters[static_cast<uint8_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    const uint64_t GetCounter(const eProfileCounter counter) const { return m_counters[static_cast<uint8_t>(counter)].load(std::memory_order_relaxed); };
+    static const char* const GetCounterName(const eProfileCounter counter);
+
+    // these should be called when no work is being recorded, events still being written can be missed
+    std::vector<ProfileSummary_t> GetSummary() const;
+    const bool WriteChromeTrace(const std::filesystem::path& path) const;
+
+private:
+    friend struct ProfileThreadHandle_t;
+
+    CProfileThreadBuffer* ClaimThreadBuffer();
+    void RelieveThreadBuffer(CProfileThreadBuffer* const buffer);
+
+    std::atomic<bool> m_enabled;
+    std::chrono::steady_clock::time_point m_epoch;
+
+    std::atomic<uint64_t> m_counters[static_cast<uint8_t>(eProfileCounter::_COUNT)] = {};
+
+    // threads are short lived (one set per CParallelTask), so buffers are handed back on thread exit and reused
+    mutable std::mutex m_bufferMutex;
+    std::vector<CProfileThreadBuffer*> m_buffers;
+    std::stack<CProfileThreadBuffer*> m_openBuffers;
+};
+
+extern CProfiler g_profiler;
+
+class CProfileScope
+{
+public:
+    CProfileScope(const char* const name, const uint32_t type = 0u) : m_name(name), m_type(type), m_start(g_profiler.IsEnabled() ? g_profiler.Now() : -1ll) {};
+    ~CProfileScope()
+    {
+        if (m_start >= 0ll)
+            g_profiler.AddEvent(m_name, m_type, m_start, g_profiler.Now() - m_start);
+    }
+
+    CProfileScope(const CProfileScope&) = delete;
+    CProfileScope& operator=(const CProfileScope&) = delete;
+
+private:
+    const char* const m_name;
+    const uint32_t m_type;
+    const int64_t m_start;
+};
+
+// adds a value to a counter when leaving the scope, for sizes that are only known once a function returns
+class CProfileCounterScope
+{
+public:
+    CProfileCounterScope(const eProfileCounter counter, const uint64_t& value) : m_counter(counter), m_value(value) {};
+    ~CProfileCounterScope() { g_profiler.AddCounter(m_counter, m_value); };
+
+    CProfileCounterScope(const CProfileCounterScope&) = delete;
+    CProfileCounterScope& operator=(const CProfileCounterScope&) = delete;
+
+private:
+    const eProfileCounter m_counter;
+    const uint64_t& m_value;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#if defined(PROFILER)
+#define PROFILE_SCOPE(name) const CProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_SCOPE_TYPE(name, type) const CProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name, static_cast<uint32_t>(type))
+#define PROFILE_COUNTER_ADD(counter, value) g_profiler.AddCounter(counter, static_cast<uint64_t>(value))
+#define PROFILE_COUNTER_ADD_ON_EXIT(counter, value) const CProfileCounterScope PROFILE_CONCAT(profileCounter, __LINE__)(counter, value)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_SCOPE_TYPE(name, type)
+#define PROFILE_COUNTER_ADD(counter, value)
+#define PROFILE_COUNTER_ADD_ON_EXIT(counter, value)
+#endif // #if defined(PROFILER)
@@ -1,43 +1,703 @@
 #include <pch.h>
 
+#include <list>
+#include <map>
+
 #include <core/utils/ramen.h>
 #include <thirdparty/oodle/oodle2.h>
+#include <thirdparty/zstd/zstd.h>
 #include <game/rtech/utils/utils.h>
- 
-constexpr OodleLZ_Compressor noodleCompressor = OodleLZ_Compressor_Kraken;
-constexpr OodleLZ_CompressionLevel noodleCompressionLevel = OodleLZ_CompressionLevel_VeryFast;
 
+RamenSettings_t g_RamenSettings = { eRamenCodec::KRAKEN, OodleLZ_CompressionLevel_VeryFast, 0u, 64u, false };
+
+//
+// CODECS
+//
+static const OodleLZ_Compressor NoodleOodleCompressor(const eRamenCodec codec)
+{
+	switch (codec)
+	{
+	case eRamenCodec::SELKIE:		return OodleLZ_Compressor_Selkie;
+	case eRamenCodec::KRAKEN:		return OodleLZ_Compressor_Kraken;
+	case eRamenCodec::LEVIATHAN:	return OodleLZ_Compressor_Leviathan;
+	default:						return OodleLZ_Compressor_Invalid;
+	}
+}
+
+static const size_t NoodleCompressBound(const eRamenCodec codec, const size_t size)
+{
+	switch (codec)
+	{
+	case eRamenCodec::NONE:
+		return size;
+	case eRamenCodec::ZSTD:
+		return ZSTD_compressBound(size);
+	default:
+		return static_cast<size_t>(OodleLZ_GetCompressedBufferSizeNeeded(NoodleOodleCompressor(codec), size));
+	}
+}
+
+// returns the compressed size, zero on failure
+static const size_t NoodleCompress(const eRamenCodec codec, const int level, const char* const src, const size_t srcSize, char* const dst, const size_t dstCapacity)
+{
+	switch (codec)
+	{
+	case eRamenCodec::NONE:
+	{
+		memcpy(dst, src, srcSize);
+		return srcSize;
+	}
+	case eRamenCodec::ZSTD:
+	{
+		const size_t compSize = ZSTD_compress(dst, dstCapacity, src, srcSize, level);
+		return ZSTD_isError(compSize) ? 0ull : compSize;
+	}
+	default:
+	{
+		const OO_SINTa compSize = OodleLZ_Compress(NoodleOodleCompressor(codec), src, srcSize, dst, static_cast<OodleLZ_CompressionLevel>(level));
+		return compSize == OODLELZ_FAILED ? 0ull : static_cast<size_t>(compSize);
+	}
+	}
+}
+
+static const bool NoodleDecompress(const eRamenCodec codec, const char* const src, const size_t srcSize, char* const dst, const size_t dstSize)
+{
+	switch (codec)
+	{
+	case eRamenCodec::NONE:
+	{
+		memcpy(dst, src, dstSize);
+		return true;
+	}
+	case eRamenCodec::ZSTD:
+	{
+		const size_t decompSize = ZSTD_decompress(dst, dstSize, src, srcSize);
+		return !ZSTD_isError(decompSize) && decompSize == dstSize;
+	}
+	default:
+	{
+		const OO_SINTa decompSize = OodleLZ_Decompress(src, srcSize, dst, dstSize);
+		return decompSize != OODLELZ_FAILED && static_cast<size_t>(decompSize) == dstSize;
+	}
+	}
+}
+
+//
+// NOODLE STORE
+// tracks every live noodle for the memory budget, the spill file and the decompressed cache
+//
+class CNoodleStore
+{
+public:
+	CNoodleStore() : spillFile(INVALID_HANDLE_VALUE), spillEnd(0ull), spillFileSize(0ull), spillFailed(false), nextId(0ull), stats() {};
+
+	const uint64_t NextId() { return ++nextId; };
+
+	void Add(CRamen::CNoodle* const noodle);
+	void Remove(CRamen::CNoodle* const noodle);
+
+	std::unique_ptr<char[]> Read(CRamen::CNoodle* const noodle);
+	std::unique_ptr<char[]> ReadCompressed(CRamen::CNoodle* const noodle);
+
+	const RamenStats_t GetStats() const
+	{
+		RamenStats_t out = {};
+		out.noodles = stats.noodles;
+		out.bytesIn = stats.bytesIn;
+		out.bytesResident = stats.bytesResident;
+		out.bytesSpilled = stats.bytesSpilled;
+		out.cacheHits = stats.cacheHits;
+		out.cacheMisses = stats.cacheMisses;
+		out.cacheBytes = stats.cacheBytes;
+		out.spillReads = stats.spillReads;
+		out.spillFileBytes = stats.spillFileBytes;
+		out.spillFailed = spillFailed;
+
+		return out;
+	}
+
+private:
+	struct CacheEntry_t
+	{
+		uint64_t id;
+		size_t size;
+		std::unique_ptr<char[]> data;
+	};
+
+	// noodles are spread over the shards by id, each shard has its own lock, lru, and share of the budget and cache
+	// so readers of different noodles rarely wait on each other
+	struct Shard_t
+	{
+		Shard_t() : lruHead(nullptr), lruTail(nullptr), bytesResident(0ull), cacheBytes(0ull) {};
+
+		std::mutex mutex;
+
+		// most recently used at the head, only resident noodles are linked
+		CRamen::CNoodle* lruHead;
+		CRamen::CNoodle* lruTail;
+		uint64_t bytesResident;
+
+		std::list<CacheEntry_t> cache; // most recently used at the front
+		std::unordered_map<uint64_t, std::list<CacheEntry_t>::iterator> cacheLookup;
+		size_t cacheBytes;
+	};
+
+	// counters are shared by every shard
+	struct AtomicStats_t
+	{
+		std::atomic<uint64_t> noodles;
+		std::atomic<uint64_t> bytesIn;
+		std::atomic<uint64_t> bytesResident;
+		std::atomic<uint64_t> bytesSpilled;
+		std::atomic<uint64_t> cacheHits;
+		std::atomic<uint64_t> cacheMisses;
+		std::atomic<uint64_t> cacheBytes;
+		std::atomic<uint64_t> spillReads;
+		std::atomic<uint64_t> spillFileBytes;
+	};
+
+	static constexpr size_t s_shardCount = 8ull;
+	static constexpr uint64_t s_spillTruncateSize = 32ull * 1024ull * 1024ull; // free space at the end of the spill file before it is cut off
+
+	inline Shard_t& ShardFor(const CRamen::CNoodle* const noodle) { return shards[noodle->id % s_shardCount]; };
+
+	void LinkFront(Shard_t& shard, CRamen::CNoodle* const noodle);
+	void Unlink(Shard_t& shard, CRamen::CNoodle* const noodle);
+
+	const bool Load(Shard_t& shard, CRamen::CNoodle* const noodle);
+	void SpillOverBudget(Shard_t& shard);
+	const bool SpillNoodle(Shard_t& shard, CRamen::CNoodle* const noodle);
+	const bool ReadSpilledNoodle(const CRamen::CNoodle* const noodle, char* const out) const;
+
+	const bool AllocateSpill(const uint64_t size, uint64_t& offset);
+	void FreeSpill(const uint64_t offset, const uint64_t size);
+
+	void CachePut(Shard_t& shard, const uint64_t id, const char* const data, const size_t size);
+	void CacheErase(Shard_t& shard, const uint64_t id);
+	void CacheTrim(Shard_t& shard, const size_t limit);
+
+	Shard_t shards[s_shardCount];
+
+	// spill file and its free ranges, only ever taken while holding a shard's lock, never the other way around
+	std::mutex spillMutex;
+	HANDLE spillFile;
+	uint64_t spillEnd;
+	uint64_t spillFileSize;
+	std::map<uint64_t, uint64_t> spillFreeByOffset; // offset, size
+	std::multimap<uint64_t, uint64_t> spillFreeBySize; // size, offset
+	std::atomic<bool> spillFailed; // the spill file couldn't be created, spilling stays off for the rest of the process
+
+	std::atomic<uint64_t> nextId;
+
+	AtomicStats_t stats;
+};
+
+// never destroyed, noodles held by assets can outlive static destruction
+static CNoodleStore* const s_noodleStore = new CNoodleStore;
+
+void CNoodleStore::LinkFront(Shard_t& shard, CRamen::CNoodle* const noodle)
+{
+	noodle->lruPrev = nullptr;
+	noodle->lruNext = shard.lruHead;
+
+	if (shard.lruHead)
+		shard.lruHead->lruPrev = noodle;
+
+	shard.lruHead = noodle;
+
+	if (!shard.lruTail)
+		shard.lruTail = noodle;
+}
+
+void CNoodleStore::Unlink(Shard_t& shard, CRamen::CNoodle* const noodle)
+{
+	if (noodle->lruPrev)
+		noodle->lruPrev->lruNext = noodle->lruNext;
+	else
+		shard.lruHead = noodle->lruNext;
+
+	if (noodle->lruNext)
+		noodle->lruNext->lruPrev = noodle->lruPrev;
+	else
+		shard.lruTail = noodle->lruPrev;
+
+	noodle->lruPrev = nullptr;
+	noodle->lruNext = nullptr;
+}
+
+void CNoodleStore::Add(CRamen::CNoodle* const noodle)
+{
+	Shard_t& shard = ShardFor(noodle);
+	std::unique_lock<std::mutex> lock(shard.mutex);
+
+	LinkFront(shard, noodle);
+	shard.bytesResident += noodle->compressedSize;
+
+	stats.noodles++;
+	stats.bytesIn += noodle->decompressedSize;
+	stats.bytesResident += noodle->compressedSize;
+
+	SpillOverBudget(shard);
+}
+
+void CNoodleStore::Remove(CRamen::CNoodle* const noodle)
+{
+	Shard_t& shard = ShardFor(noodle);
+	std::unique_lock<std::mutex> lock(shard.mutex);
+
+	assertm(noodle->readers == 0u, "noodle destroyed while being read");
+
+	if (noodle->spilled)
+	{
+		stats.bytesSpilled -= noodle->compressedSize;
+	}
+	else
+	{
+		Unlink(shard, noodle);
+		shard.bytesResident -= noodle->compressedSize;
+		stats.bytesResident -= noodle->compressedSize;
+	}
+
+	if (noodle->spillBacked)
+		FreeSpill(noodle->spillOffset, noodle->compressedSize);
+
+	stats.noodles--;
+	stats.bytesIn -= noodle->decompressedSize;
+
+	CacheErase(shard, noodle->id);
+}
+
+void CNoodleStore::SpillOverBudget(Shard_t& shard)
+{
+	if (!g_RamenSettings.spill || g_RamenSettings.budgetMB == 0u || spillFailed)
+		return;
+
+	const uint64_t budget = (static_cast<uint64_t>(g_RamenSettings.budgetMB) * 1024ull * 1024ull) / s_shardCount;
+
+	CRamen::CNoodle* noodle = shard.lruTail;
+	while (noodle && shard.bytesResident > budget)
+	{
+		CRamen::CNoodle* const prev = noodle->lruPrev;
+
+		// noodles being read have to stay in memory
+		if (noodle->readers == 0u && !SpillNoodle(shard, noodle))
+			return;
+
+		noodle = prev;
+	}
+}
+
+const bool CNoodleStore::SpillNoodle(Shard_t& shard, CRamen::CNoodle* const noodle)
+{
+	// a noodle that was read back still has its copy in the file, dropping it again needs no write
+	if (!noodle->spillBacked)
+	{
+		uint64_t offset = 0ull;
+		if (!AllocateSpill(noodle->compressedSize, offset))
+			return false;
+
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFull);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+		DWORD written = 0;
+		if (!WriteFile(spillFile, noodle->data, static_cast<DWORD>(noodle->compressedSize), &written, &overlapped) || written != noodle->compressedSize)
+		{
+			LOG_ERROR(CACHE, "failed to write noodle to ramen spill file\n");
+			FreeSpill(offset, noodle->compressedSize);
+
+			return false;
+		}
+
+		noodle->spillOffset = offset;
+		noodle->spillBacked = true;
+	}
+
+	Unlink(shard, noodle);
+
+	delete[] noodle->data;
+	noodle->data = nullptr;
+	noodle->spilled = true;
+
+	shard.bytesResident -= noodle->compressedSize;
+	stats.bytesResident -= noodle->compressedSize;
+	stats.bytesSpilled += noodle->compressedSize;
+
+	return true;
+}
+
+// positional reads don't touch shared state, so this is done without any lock
+const bool CNoodleStore::ReadSpilledNoodle(const CRamen::CNoodle* const noodle, char* const out) const
+{
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = static_cast<DWORD>(noodle->spillOffset & 0xFFFFFFFFull);
+	overlapped.OffsetHigh = static_cast<DWORD>(noodle->spillOffset >> 32);
+
+	DWORD read = 0;
+	return ReadFile(spillFile, out, static_cast<DWORD>(noodle->compressedSize), &read, &overlapped) && read == noodle->compressedSize;
+}
+
+// makes a pinned noodle resident and most recently used, spilled noodles are read back from the file
+// the file range is kept until the noodle is destroyed, so other readers of the same noodle can still read it
+const bool CNoodleStore::Load(Shard_t& shard, CRamen::CNoodle* const noodle)
+{
+	{
+		std::unique_lock<std::mutex> lock(shard.mutex);
+
+		if (!noodle->spilled)
+		{
+			Unlink(shard, noodle);
+			LinkFront(shard, noodle);
+
+			return true;
+		}
+	}
+
+	stats.spillReads++;
+
+	std::unique_ptr<char[]> data = std::make_unique<char[]>(noodle->compressedSize);
+	if (!ReadSpilledNoodle(noodle, data.get()))
+	{
+		assert(false);
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(shard.mutex);
+
+	// another reader may have brought it back already
+	if (noodle->spilled)
+	{
+		noodle->data = data.release();
+		noodle->spilled = false;
+
+		LinkFront(shard, noodle);
+
+		shard.bytesResident += noodle->compressedSize;
+		stats.bytesResident += noodle->compressedSize;
+		stats.bytesSpilled -= noodle->compressedSize;
+	}
+
+	return true;
+}
+
+std::unique_ptr<char[]> CNoodleStore::Read(CRamen::CNoodle* const noodle)
+{
+	Shard_t& shard = ShardFor(noodle);
+	std::unique_ptr<char[]> out = std::make_unique<char[]>(noodle->decompressedSize);
+
+	{
+		std::unique_lock<std::mutex> lock(shard.mutex);
+
+		if (const auto it = shard.cacheLookup.find(noodle->id); it != shard.cacheLookup.end())
+		{
+			memcpy(out.get(), it->second->data.get(), noodle->decompressedSize);
+			shard.cache.splice(shard.cache.begin(), shard.cache, it->second);
+
+			stats.cacheHits++;
+			return out;
+		}
+
+		stats.cacheMisses++;
+
+		// pinned, so it can't be spilled while we decompress outside of the lock
+		noodle->readers++;
+	}
+
+	if (!Load(shard, noodle))
+	{
+		out.reset();
+	}
+	else if (!NoodleDecompress(noodle->codec, noodle->data, noodle->compressedSize, out.get(), noodle->decompressedSize))
+	{
+		assert(false); // odd, report in debug
+		out.reset();
+	}
+
+	std::unique_lock<std::mutex> lock(shard.mutex);
+	noodle->readers--;
+
+	if (out)
+		CachePut(shard, noodle->id, out.get(), noodle->decompressedSize);
+
+	// reading it back can take the shard over budget, or the budget was lowered since it was added
+	SpillOverBudget(shard);
+
+	return out;
+}
+
+std::unique_ptr<char[]> CNoodleStore::ReadCompressed(CRamen::CNoodle* const noodle)
+{
+	Shard_t& shard = ShardFor(noodle);
+	std::unique_ptr<char[]> out = std::make_unique<char[]>(noodle->compressedSize);
+
+	{
+		std::unique_lock<std::mutex> lock(shard.mutex);
+		noodle->readers++;
+	}
+
+	if (Load(shard, noodle))
+		memcpy(out.get(), noodle->data, noodle->compressedSize);
+	else
+		out.reset();
+
+	std::unique_lock<std::mutex> lock(shard.mutex);
+	noodle->readers--;
+
+	SpillOverBudget(shard);
+
+	return out;
+}
+
+// best fit from the freed ranges, the end of the file otherwise
+const bool CNoodleStore::AllocateSpill(const uint64_t size, uint64_t& offset)
+{
+	std::unique_lock<std::mutex> lock(spillMutex);
+
+	if (spillFile == INVALID_HANDLE_VALUE)
+	{
+		char tempDir[MAX_PATH] = {};
+		GetTempPathA(MAX_PATH, tempDir);
+
+		const std::string spillPath = std::format("{}rsx_ramen_{}.tmp", tempDir, GetCurrentProcessId());
+
+		// deleted by the os once the process is gone, however it exits
+		spillFile = CreateFileA(spillPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+
+		if (spillFile == INVALID_HANDLE_VALUE)
+		{
+			LOG_WARN(CACHE, "failed to create ramen spill file '%s', disabling spill\n", spillPath.c_str());
+			spillFailed = true;
+
+			return false;
+		}
+	}
+
+	if (const auto it = spillFreeBySize.lower_bound(size); it != spillFreeBySize.end())
+	{
+		const uint64_t rangeSize = it->first;
+		offset = it->second;
+
+		spillFreeBySize.erase(it);
+		spillFreeByOffset.erase(offset);
+
+		// the rest of a bigger range stays free
+		if (rangeSize > size)
+		{
+			spillFreeByOffset.emplace(offset + size, rangeSize - size);
+			spillFreeBySize.emplace(rangeSize - size, offset + size);
+		}
+
+		return true;
+	}
+
+	offset = spillEnd;
+	spillEnd += size;
+
+	spillFileSize = std::max(spillFileSize, spillEnd);
+	stats.spillFileBytes = spillFileSize;
+
+	return true;
+}
+
+// merges with the neighbouring free ranges, free space at the end of the file is given back
+void CNoodleStore::FreeSpill(const uint64_t offset, const uint64_t size)
+{
+	std::unique_lock<std::mutex> lock(spillMutex);
+
+	const auto eraseBySize = [this](const uint64_t rangeOffset, const uint64_t rangeSize)
+		{
+			const auto range = spillFreeBySize.equal_range(rangeSize);
+			for (auto it = range.first; it != range.second; ++it)
+			{
+				if (it->second == rangeOffset)
+				{
+					spillFreeBySize.erase(it);
+					return;
+				}
+			}
+		};
+
+	uint64_t start = offset;
+	uint64_t end = offset + size;
+
+	if (const auto next = spillFreeByOffset.find(end); next != spillFreeByOffset.end())
+	{
+		end += next->second;
+
+		eraseBySize(next->first, next->second);
+		spillFreeByOffset.erase(next);
+	}
+
+	if (auto prev = spillFreeByOffset.lower_bound(start); prev != spillFreeByOffset.begin())
+	{
+		--prev;
+
+		if (prev->first + prev->second == start)
+		{
+			start = prev->first;
+
+			eraseBySize(prev->first, prev->second);
+			spillFreeByOffset.erase(prev);
+		}
+	}
+
+	if (end == spillEnd)
+	{
+		spillEnd = start;
+
+		// cut in chunks rather than on every free, noodles tend to go all at once when a pak is unloaded
+		if (spillFileSize - spillEnd >= s_spillTruncateSize || (spillEnd == 0ull && spillFileSize > 0ull))
+		{
+			LARGE_INTEGER newSize = {};
+			newSize.QuadPart = static_cast<LONGLONG>(spillEnd);
+
+			if (SetFilePointerEx(spillFile, newSize, nullptr, FILE_BEGIN) && SetEndOfFile(spillFile))
+			{
+				spillFileSize = spillEnd;
+				stats.spillFileBytes = spillFileSize;
+			}
+		}
+
+		return;
+	}
+
+	spillFreeByOffset.emplace(start, end - start);
+	spillFreeBySize.emplace(end - start, start);
+}
+
+void CNoodleStore::CachePut(Shard_t& shard, const uint64_t id, const char* const data, const size_t size)
+{
+	const size_t limit = (static_cast<size_t>(g_RamenSettings.cacheMB) * 1024ull * 1024ull) / s_shardCount;
+
+	// big noodles would push everything else out
+	if (size > (limit >> 1) || shard.cacheLookup.contains(id))
+	{
+		CacheTrim(shard, limit);
+		return;
+	}
+
+	CacheEntry_t entry = { id, size, std::make_unique<char[]>(size) };
+	memcpy(entry.data.get(), data, size);
+
+	shard.cache.push_front(std::move(entry));
+	shard.cacheLookup.emplace(id, shard.cache.begin());
+	shard.cacheBytes += size;
+	stats.cacheBytes += size;
+
+	CacheTrim(shard, limit);
+}
+
+void CNoodleStore::CacheErase(Shard_t& shard, const uint64_t id)
+{
+	if (const auto it = shard.cacheLookup.find(id); it != shard.cacheLookup.end())
+	{
+		shard.cacheBytes -= it->second->size;
+		stats.cacheBytes -= it->second->size;
+
+		shard.cache.erase(it->second);
+		shard.cacheLookup.erase(it);
+	}
+}
+
+void CNoodleStore::CacheTrim(Shard_t& shard, const size_t limit)
+{
+	while (shard.cacheBytes > limit && !shard.cache.empty())
+	{
+		shard.cacheBytes -= shard.cache.back().size;
+		stats.cacheBytes -= shard.cache.back().size;
+
+		shard.cacheLookup.erase(shard.cache.back().id);
+		shard.cache.pop_back();
+	}
+}
+
+//
+// NOODLE
+//
+CRamen::CNoodle::CNoodle(char* const buf, const size_t compSize, const size_t decompSize, const eRamenCodec noodleCodec) : data(buf), compressedSize(compSize), decompressedSize(decompSize),
+	id(s_noodleStore->NextId()), spillOffset(0ull), lruPrev(nullptr), lruNext(nullptr), readers(0u), spilled(false), spillBacked(false), codec(noodleCodec)
+{
+	s_noodleStore->Add(this);
+}
+
+CRamen::CNoodle::~CNoodle()
+{
+	s_noodleStore->Remove(this);
+
+	if (data)
+	{
+		delete[] data;
+		data = nullptr;
+	}
+}
+
+//
+// RAMEN
+//
 const size_t CRamen::addIdx(const size_t index, char* const buf, const size_t bufSize)
 {
 	if (index > noodleSize)
 	{
-		Log(__FUNCTION__ " tried to add chunk non sequentially, not supported so an invalid index is returned...\n");
+		LOG_ERROR(CACHE, __FUNCTION__ " tried to add chunk non sequentially, not supported so an invalid index is returned...\n");
 		return invalidNoodleIdx;
 	}
 
 	ensureCapacity(noodleSize + 1);
 
-	const size_t compSizeRequired = OodleLZ_GetCompressedBufferSizeNeeded(noodleCompressor, bufSize); // this will not be the actual compressed size which is not ideal
+	PROFILE_SCOPE("ramen compress");
+	PROFILE_COUNTER_ADD(eProfileCounter::RAMEN_BYTES_IN, bufSize);
+
+	// read once, settings can be changed from the ui while loading
+	const eRamenCodec codec = g_RamenSettings.codec;
+	const int level = g_RamenSettings.level;
+
+	const size_t compSizeRequired = NoodleCompressBound(codec, bufSize); // this will not be the actual compressed size which is not ideal
 	char* const compBuf = new char[compSizeRequired];
-	const size_t compSize = OodleLZ_Compress(noodleCompressor, buf, bufSize, compBuf, noodleCompressionLevel);
-	if (compSize == OODLELZ_FAILED)
+	const size_t compSize = NoodleCompress(codec, level, buf, bufSize, compBuf, compSizeRequired);
+
+	// failed or didn't shrink, store a plain copy. buf belongs to the caller
+	if (codec == eRamenCodec::NONE || compSize == 0ull || compSize >= bufSize)
 	{
-		assert(false); // odd, report in debug
+		assertm(codec == eRamenCodec::NONE || compSize != 0ull, "noodle compression failed"); // odd, report in debug
 
-		delete[] compBuf;
-		noodles[index] = new CNoodle(buf, 0ull, bufSize, false);
+		char* rawBuf = compBuf;
+		if (codec != eRamenCodec::NONE)
+		{
+			delete[] compBuf;
+
+			rawBuf = new char[bufSize];
+			memcpy(rawBuf, buf, bufSize);
+		}
+
+		PROFILE_COUNTER_ADD(eProfileCounter::RAMEN_BYTES_OUT, bufSize);
+
+		noodles[index] = new CNoodle(rawBuf, bufSize, bufSize, eRamenCodec::NONE);
 
 		noodleSize++;
 
 		return index;
 	}
 
-	// oodle demands more memory than it actually uses, fix up.
+	// compressors demand more memory than they actually use, fix up.
 	char* const compBufShrink = new char[compSize];
 	memcpy(compBufShrink, compBuf, compSize);
 	delete[] compBuf;
 
-	noodles[index] = new CNoodle(compBufShrink, compSize, bufSize, true);
+	PROFILE_COUNTER_ADD(eProfileCounter::RAMEN_BYTES_OUT, compSize);
+
+	noodles[index] = new CNoodle(compBufShrink, compSize, bufSize, codec);
+
+	noodleSize++;
+
+	return index;
+}
+
+const size_t CRamen::addCompressed(char* const buf, const size_t compSize, const size_t decompSize, const eRamenCodec codec)
+{
+	ensureCapacity(noodleSize + 1);
+
+	const size_t index = noodleSize;
+	noodles[index] = new CNoodle(buf, compSize, decompSize, codec);
 
 	noodleSize++;
 
@@ -49,25 +709,74 @@ std::unique_ptr<char[]> CRamen::getIdx(const size_t index) const
 	if (capacity == 0)
 		return nullptr;
 
-	CNoodle* const thisChunk = noodles[index];
-	std::unique_ptr<char[]> out = std::make_unique<char[]>(thisChunk->decompressedSize);
-	if (thisChunk->isCompressed)
-	{
-		const size_t decompSize = OodleLZ_Decompress(thisChunk->data, thisChunk->compressedSize, out.get(), thisChunk->decompressedSize);
-		if (decompSize == OODLELZ_FAILED)
-		{
-			assert(false);
-			return nullptr;
-		}
+	return s_noodleStore->Read(noodles[index]);
+}
 
-		assert(decompSize == thisChunk->decompressedSize);
-		return out;
+std::unique_ptr<char[]> CRamen::getCompressedIdx(const size_t index) const
+{
+	if (capacity == 0)
+		return nullptr;
+
+	return s_noodleStore->ReadCompressed(noodles[index]);
+}
+
+const RamenStats_t CRamen::GetStats()
+{
+	return s_noodleStore->GetStats();
+}
+
+const char* const CRamen::GetCodecName(const eRamenCodec codec)
+{
+	switch (codec)
+	{
+	case eRamenCodec::NONE:			return "None";
+	case eRamenCodec::SELKIE:		return "Oodle Selkie (fastest)";
+	case eRamenCodec::KRAKEN:		return "Oodle Kraken";
+	case eRamenCodec::LEVIATHAN:	return "Oodle Leviathan (smallest)";
+	case eRamenCodec::ZSTD:			return "Zstandard";
+	default:						return "Invalid";
 	}
-	else
+}
+
+const int CRamen::DefaultCodecLevel(const eRamenCodec codec)
+{
+	switch (codec)
 	{
-		memcpy(out.get(), thisChunk->data, thisChunk->decompressedSize);
-		return out;
+	case eRamenCodec::SELKIE:
+	case eRamenCodec::KRAKEN:
+		return OodleLZ_CompressionLevel_VeryFast;
+	case eRamenCodec::LEVIATHAN:
+		return OodleLZ_CompressionLevel_Normal;
+	case eRamenCodec::ZSTD:
+		return 3; // ZSTD_CLEVEL_DEFAULT
+	default:
+		return 0;
 	}
+}
 
-	unreachable();
-}
\ No newline at end of file
+void CRamen::CodecLevelRange(const eRamenCodec codec, int& min, int& max)
+{
+	switch (codec)
+	{
+	case eRamenCodec::SELKIE:
+	case eRamenCodec::KRAKEN:
+	case eRamenCodec::LEVIATHAN:
+	{
+		min = OodleLZ_CompressionLevel_Min;
+		max = OodleLZ_CompressionLevel_Max;
+		break;
+	}
+	case eRamenCodec::ZSTD:
+	{
+		min = 1;
+		max = 19; // 20+ are ultra levels, far too slow for this
+		break;
+	}
+	default:
+	{
+		min = 0;
+		max = 0;
+		break;
+	}
+	}
+}
@@ -2,6 +2,43 @@
 
 static constexpr size_t invalidNoodleIdx = 0xFFFFFFFFFFFFFFFF;
 
+// codec used for newly added noodles, existing noodles keep the codec they were compressed with
+enum class eRamenCodec : uint8_t
+{
+	NONE,		// plain copy
+	SELKIE,		// oodle selkie, lz4 class, fastest decode
+	KRAKEN,		// oodle kraken
+	LEVIATHAN,	// oodle leviathan, best ratio for slower encode
+	ZSTD,
+
+	_COUNT,
+};
+
+struct RamenSettings_t
+{
+	eRamenCodec codec;
+	int level;			// oodle compression level or zstd level, see CRamen::DefaultCodecLevel
+	uint32_t budgetMB;	// noodle memory kept resident before the least recently used noodles spill, 0 for no budget
+	uint32_t cacheMB;	// recently decompressed noodles kept around for repeated reads (previews), 0 to disable
+	bool spill;			// spill to a temp file when over budget, without this the budget is only reported
+};
+
+extern RamenSettings_t g_RamenSettings;
+
+struct RamenStats_t
+{
+	uint64_t noodles;			// live noodles
+	uint64_t bytesIn;			// decompressed size of live noodles
+	uint64_t bytesResident;		// compressed size of live noodles held in memory
+	uint64_t bytesSpilled;		// compressed size of live noodles in the spill file
+	uint64_t cacheHits;
+	uint64_t cacheMisses;
+	uint64_t cacheBytes;
+	uint64_t spillReads;
+	uint64_t spillFileBytes;	// size of the spill file, freed ranges are reused and free space at the end is cut off
+	bool spillFailed;			// the spill file couldn't be created, nothing is spilled until the process restarts
+};
+
 class CRamen
 {
 public:
@@ -9,20 +46,26 @@ public:
 	{
 	public:
 		CNoodle() = delete; // no default constructor.
-		CNoodle(char* const buf, const size_t compSize, const size_t decompSize, bool isComp) : data(buf), compressedSize(compSize), decompressedSize(decompSize), isCompressed(isComp) {};
-		inline ~CNoodle()
-		{
-			if (data)
-			{
-				delete[] data;
-				data = nullptr;
-			}
-		}
+		CNoodle(char* const buf, const size_t compSize, const size_t decompSize, const eRamenCodec noodleCodec);
+		~CNoodle();
 
-		char* data;
+		CNoodle(const CNoodle&) = delete;
+		CNoodle& operator=(const CNoodle&) = delete;
+
+		char* data; // null while spilled
 		size_t compressedSize;
 		size_t decompressedSize;
-		bool isCompressed;
+		uint64_t id; // unique for the process, keys the decompressed cache
+
+		// spill bookkeeping, owned by the noodle store
+		uint64_t spillOffset;
+		CNoodle* lruPrev;
+		CNoodle* lruNext;
+		uint32_t readers;
+		bool spilled; // not in memory, only in the spill file
+		bool spillBacked; // owns a range of the spill file, kept after it is read back so spilling it again is free
+
+		eRamenCodec codec;
 	};
 
 	inline CRamen() : noodles(nullptr), capacity(0ull), noodleSize(0ull) {};
@@ -75,11 +118,15 @@ public:
 	}
 
 	inline const size_t addBack(char* const buf, const size_t bufSize)
-	{ 
+	{
 		return addIdx(noodleSize, buf, bufSize);
 	}
 
+	// adds a noodle that is already compressed, the noodle takes ownership of buf
+	const size_t addCompressed(char* const buf, const size_t compSize, const size_t decompSize, const eRamenCodec codec);
+
 	std::unique_ptr<char[]> getIdx(const size_t index) const;
+	std::unique_ptr<char[]> getCompressedIdx(const size_t index) const; // copy of the compressed bytes, as stored
 	inline std::unique_ptr<char[]> getBack() const
 	{
 		return getIdx(noodleSize - 1ull);
@@ -159,6 +206,11 @@ public:
 		return (noodles + noodleSize);
 	}
 
+	static const RamenStats_t GetStats();
+	static const char* const GetCodecName(const eRamenCodec codec);
+	static const int DefaultCodecLevel(const eRamenCodec codec);
+	static void CodecLevelRange(const eRamenCodec codec, int& min, int& max);
+
 private:
 	const size_t addIdx(const size_t index, char* const buf, const size_t size);
 
@@ -186,4 +238,4 @@ private:
 	CNoodle** noodles;
 	size_t capacity;
 	size_t noodleSize;
-};
\ No newline at end of file
+};
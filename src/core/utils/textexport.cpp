@@ -0,0 +1,25 @@
+#include <pch.h>
+#include <core/utils/textexport.h>
+
+std::string& GetTextExportBuffer()
+{
+    static thread_local std::string s_textExportBuffer;
+
+    s_textExportBuffer.clear();
+    return s_textExportBuffer;
+}
+
+const bool WriteTextExportFile(const std::filesystem::path& exportPath, const std::string& text)
+{
+    StreamIO out;
+    if (!out.open(exportPath.string(), eStreamIOMode::Write))
+    {
+        assertm(false, "Failed to open file for write.");
+        return false;
+    }
+
+    out.write(text.data(), text.size());
+    out.close();
+
+    return true;
+}
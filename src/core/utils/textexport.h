@@ -0,0 +1,25 @@
+#pragma once
+#include <charconv>
+
+// text exports are built in memory and written out with a single write
+// the buffer is kept per thread and cleared on each call, so its capacity is reused by every export on that thread
+std::string& GetTextExportBuffer();
+
+const bool WriteTextExportFile(const std::filesystem::path& exportPath, const std::string& text);
+
+// appends value as lowercase hex without leading zeroes, same as streaming it with std::hex
+inline void AppendTextExportHex(std::string& out, const uint64_t value)
+{
+    char buf[16];
+    const std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), value, 16);
+
+    out.append(buf, res.ptr);
+}
+
+inline void AppendTextExportInt(std::string& out, const int value)
+{
+    char buf[16];
+    const std::to_chars_result res = std::to_chars(buf, buf + sizeof(buf), value);
+
+    out.append(buf, res.ptr);
+}
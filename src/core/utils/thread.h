@@ -90,9 +90,17 @@ public:
 
     void execute()
     {
+        // files written by the tasks belong to whatever is tracking the thread that runs them
+        CWrittenFileTracker* const fileTracker = CWrittenFileTracker::Current();
+
         for (uint32_t i = 0; i < maxConcurrentThreads; ++i)
         {
-            threads.emplace_back([this]() { this->workerThread(); });
+            threads.emplace_back([this, fileTracker]()
+                {
+                    CWrittenFileTracker::SetCurrent(fileTracker);
+                    s_isWorkerThread = true;
+                    this->workerThread();
+                });
         }
     }
 
@@ -106,6 +114,12 @@ public:
         threads.clear();
     }
 
+    // true on threads run by a parallel task
+    static const bool isWorkerThread()
+    {
+        return s_isWorkerThread;
+    }
+
     const uint32_t getRemainingTasks()
     {
         std::unique_lock<std::mutex> lock(queueMutex);
@@ -118,8 +132,12 @@ private:
     std::mutex queueMutex;
     uint32_t maxConcurrentThreads;
 
+    static inline thread_local bool s_isWorkerThread = false;
+
     void workerThread()
     {
+        PROFILE_SCOPE("parallel task worker");
+
         while (true)
         {
             std::function<void()> task;
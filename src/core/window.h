@@ -2,6 +2,7 @@
 
 const POINT GetCenterOfNearestScreen(const POINT& windowSize);
 
+const bool ShowOpenFileDialog(const HWND windowHandle, std::vector<std::string>& filePaths);
 void HandleOpenFileDialog(const HWND windowHandle);
 void HandleModelDialog(const HWND windowHandle);
 
@@ -1,6 +1,7 @@
 #include "pch.h"
 
 #include <game/asset.h>
+#include <game/rtech/cpakfile.h>
 #include <misc/imgui_utility.h>
 #include "rtech/utils/utils.h"
 
@@ -22,6 +23,8 @@ static std::vector<uint32_t> postLoadOrder =
 
 void CGlobalAssetData::ProcessAssetsPostLoad()
 {
+    PROFILE_SCOPE("process post load");
+
     struct TypeRange_t
     {
         uint32_t type;
@@ -83,6 +86,10 @@ void CGlobalAssetData::ProcessAssetsPostLoad()
                             continue;
 
                         AssetLookup_t* const pAssetLookup = &this->v_assets[assetToProcess];
+
+                        PROFILE_SCOPE_TYPE("postload", range.type);
+                        PROFILE_COUNTER_ADD(eProfileCounter::ASSETS_POSTLOADED, 1);
+
                         // temp
                         it->second.postLoadFunc(pAssetLookup->m_asset->GetContainerFile<CAssetContainer>(), pAssetLookup->m_asset);
                     }
@@ -115,6 +122,9 @@ void CGlobalAssetData::ProcessAssetsPostLoad()
                     AssetLookup_t* const pAssetLookup = &this->v_assets[assetToProcess];
                     if (auto it = m_assetTypeBindings.find(pAssetLookup->m_asset->GetAssetType()); it != m_assetTypeBindings.end() && it->second.postLoadFunc)
                     {
+                        PROFILE_SCOPE_TYPE("postload", it->first);
+                        PROFILE_COUNTER_ADD(eProfileCounter::ASSETS_POSTLOADED, 1);
+
                         //it->second.postLoadFunc(pAssetLookup->m_asset->pak(), pAssetLookup->m_asset);
                         // temp
                         it->second.postLoadFunc(pAssetLookup->m_asset->GetContainerFile<CAssetContainer>(), pAssetLookup->m_asset);
@@ -131,4 +141,121 @@ void CGlobalAssetData::ProcessAssetsPostLoad()
     //std::sort(m_pakAssets.begin(), m_pakAssets.end(), [](const CGlobalAssetData::AssetLookup_t& a, const CGlobalAssetData::AssetLookup_t& b) { return _stricmp(a.m_asset->name().c_str(), b.m_asset->name().c_str()); });
 }
 
+size_t CGlobalAssetData::UnloadContainers(const std::vector<CAssetContainer*>& containers)
+{
+    PROFILE_SCOPE("unload containers");
+
+    const std::unordered_set<const void*> unloadContainers(containers.begin(), containers.end());
+
+    // patch master is shared by every pak, it only goes with the last container
+    if (std::ranges::all_of(v_assetContainers, [&unloadContainers](const CAssetContainer* const container) { return unloadContainers.contains(container); }))
+    {
+        const size_t assetCount = v_assets.size();
+        ClearAssetData();
+
+        return assetCount;
+    }
+
+    // gather what is going away, other assets can point at a pak asset's extra data directly (parent models and rigs of animseqs)
+    size_t unloadCount = 0ull;
+    for (const AssetLookup_t& lookup : v_assets)
+    {
+        if (!unloadContainers.contains(lookup.m_asset->GetContainerFile()))
+            continue;
+
+        m_unloadingPtrs.insert(lookup.m_asset);
+
+        if (lookup.m_asset->GetAssetContainerType() == CAsset::ContainerType::PAK)
+            m_unloadingPtrs.insert(static_cast<CPakAsset*>(lookup.m_asset)->extraData());
+
+        unloadCount++;
+    }
+
+    // clear references from the assets that stay before anything is deleted
+    for (const AssetLookup_t& lookup : v_assets)
+    {
+        if (m_unloadingPtrs.contains(lookup.m_asset))
+            continue;
+
+        if (auto it = m_assetTypeBindings.find(lookup.m_asset->GetAssetType()); it != m_assetTypeBindings.end() && it->second.releaseRefsFunc)
+            it->second.releaseRefsFunc(lookup.m_asset);
+    }
+
+    std::erase_if(v_assets, [this](const AssetLookup_t& lookup)
+        {
+            if (!m_unloadingPtrs.contains(lookup.m_asset))
+                return false;
+
+            delete lookup.m_asset;
+            return true;
+        });
+
+    v_assets.shrink_to_fit();
+    m_unloadingPtrs.clear();
+
+    // pak buffers, starpak entries, miles stream files and bluepoint chunks are all owned by their container
+    std::erase_if(v_assetContainers, [this, &unloadContainers](CAssetContainer* const container)
+        {
+            if (!unloadContainers.contains(container))
+                return false;
+
+            if (container->GetContainerType() == CAsset::ContainerType::PAK)
+            {
+                const CPakFile* const pak = static_cast<const CPakFile*>(container);
+
+                // allow the pak to be loaded again
+                m_pakLoadStatusMap.erase(pak->header()->crc);
+
+                for (const uint64_t crc : pak->patchCrcs())
+                    m_pakLoadStatusMap.erase(crc);
+            }
+
+            LOG_INFO(PAK, "unloaded %s\n", container->GetContainerFileName().c_str());
+
+            delete container;
+            return true;
+        });
+
+    v_assetContainers.shrink_to_fit();
+
+    ++m_unloadGeneration;
+
+    return unloadCount;
+}
+
+CStringInterner* const CAsset::GetNameInterner() const
+{
+    // assets are rarely named before they have a container, these names live as long as the process
+    static CStringInterner s_containerlessNames;
+
+    return m_containerFile ? static_cast<CAssetContainer*>(m_containerFile)->GetAssetNameInterner() : &s_containerlessNames;
+}
+
+void CAsset::SetAssetName(const std::string_view name, bool addToCache)
+{
+    CStringInterner* const interner = GetNameInterner();
+
+    // renaming gives the old name's space back to the container once no other asset uses it
+    const std::string_view oldName = m_assetName;
+    m_assetName = interner->Intern(name, true);
+    interner->Release(oldName);
+
+    if (addToCache)
+        g_cacheDBManager.Add(std::string(name));
+}
+
+void CAsset::SetAssetNameFromCache()
+{
+    CCacheEntry entry;
+
+    if (g_cacheDBManager.LookupGuid(GetAssetGUID(), &entry))
+    {
+        CStringInterner* const interner = GetNameInterner();
+
+        const std::string_view oldName = m_assetName;
+        m_assetName = interner->Intern(entry.origString, true);
+        interner->Release(oldName);
+    }
+}
+
 CGlobalAssetData g_assetData;
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <core/utils/interner.h>
 #include <game/rtech/utils/utils.h>
 
 
@@ -252,7 +253,8 @@ public:
 	virtual ~CAsset() {};
 
 	// Get the display name for this asset.
-	const std::string& GetAssetName() const { return m_assetName; }
+	// names are interned by the container and always null terminated, so data() can be used as a c string.
+	const std::string_view GetAssetName() const { return m_assetName; }
 	const AssetVersion_t& GetAssetVersion() const { return m_assetVersion; }
 	virtual const uint64_t GetAssetGUID() const = 0;
 
@@ -276,21 +278,9 @@ public:
 
 	// setters
 
-	void SetAssetName(const std::string& name, bool addToCache=false)
-	{
-		m_assetName = std::filesystem::path(name).make_preferred().string();
-
-		if (addToCache)
-			g_cacheDBManager.Add(name);
-	};
-
-	void SetAssetNameFromCache()
-	{
-		CCacheEntry entry;
-
-		if (g_cacheDBManager.LookupGuid(GetAssetGUID(), &entry))
-			m_assetName = std::filesystem::path(entry.origString).make_preferred().string();
-	}
+	// the container should be set before the name, as it owns the name's storage
+	void SetAssetName(const std::string_view name, bool addToCache=false);
+	void SetAssetNameFromCache();
 
 	void SetAssetVersion(const AssetVersion_t& version)
 	{
@@ -320,7 +310,9 @@ public:
 	}
 
 private:
-	std::string m_assetName;
+	CStringInterner* const GetNameInterner() const;
+
+	std::string_view m_assetName = "";
 	AssetVersion_t m_assetVersion;
 
 	bool m_exported;
@@ -328,7 +320,7 @@ private:
 protected:
 	void* m_assetData;
 
-	void* m_containerFile;
+	void* m_containerFile = nullptr;
 };
 
 class CAssetContainer
@@ -340,6 +332,15 @@ public:
 
 	virtual const ContainerType GetContainerType() const = 0;
 
+	// Get the name of the file this container was loaded from.
+	virtual std::string GetContainerFileName() const = 0;
+	virtual std::filesystem::path GetContainerFilePath() const = 0;
+
+	CStringInterner* const GetAssetNameInterner() { return &m_assetNames; };
+
+private:
+	// storage for the names of every asset in this container
+	CStringInterner m_assetNames;
 };
 
 // functions for asset loading.
@@ -351,6 +352,9 @@ typedef void* (*AssetPreviewFunc_t)(CAsset* const asset, const bool firstFrameFo
 // functions around exporting the asset.
 typedef bool(*AssetExportFunc_t)(CAsset* const asset, const int setting);
 
+// functions for clearing an asset's pointers to assets that are being unloaded, see CGlobalAssetData::IsUnloading.
+typedef void(*AssetReleaseRefsFunc_t)(CAsset* const asset);
+
 #define REGISTER_TYPE(type) g_assetData.m_assetTypeBindings[type.type] = type
 
 struct AssetTypeBinding_t
@@ -368,6 +372,9 @@ struct AssetTypeBinding_t
 		const char** exportSettingArr;
 		size_t exportSettingArrSize;
 	} e;
+
+	// only needed by types that keep pointers to other assets (or their extra data) after post load
+	AssetReleaseRefsFunc_t releaseRefsFunc;
 };
 
 class CGlobalAssetData
@@ -391,6 +398,12 @@ public:
 
 	CAssetContainer* m_pakPatchMaster;
 
+	// bumped whenever assets are deleted, anything caching by asset pointer should drop its cache when this changes
+	size_t m_unloadGeneration;
+
+	// assets of the containers being unloaded and the extra data of the pak assets among them, only filled during UnloadContainers
+	std::unordered_set<const void*> m_unloadingPtrs;
+
 	CAsset* const FindAssetByGUID(const uint64_t guid)
 	{
 		const auto it = std::ranges::find(v_assets, guid, &AssetLookup_t::m_guid);
@@ -407,6 +420,9 @@ public:
 			? static_cast<T*>(it->m_asset) : nullptr;
 	}
 
+	// true for an asset, or the extra data of a pak asset, that UnloadContainers is about to delete
+	inline const bool IsUnloading(const void* const ptr) const { return ptr && m_unloadingPtrs.contains(ptr); }
+
 	void ClearAssetData()
 	{
 		for (const auto& lookup : v_assets)
@@ -431,8 +447,14 @@ public:
 
 		m_patchMasterEntries.clear();
 		m_pakLoadStatusMap.clear();
+
+		++m_unloadGeneration;
 	}
 
+	// deletes the containers and every asset they own, other assets have their references to them cleared first
+	// returns the number of assets deleted
+	size_t UnloadContainers(const std::vector<CAssetContainer*>& containers);
+
 	void ProcessAssetsPostLoad();
 };
 
@@ -0,0 +1,979 @@
+#include <pch.h>
+#include <game/audio/flac.h>
+#include <array>
+
+// what each compression level searches, higher levels try more predictors and rice partitions
+struct FlacLevel_t
+{
+	bool stereoDecorrelation;
+	uint32_t maxLpcOrder; // 0 only uses fixed predictors
+	bool exhaustiveLpcOrder; // try every lpc order instead of the estimated best one
+	uint32_t maxPartitionOrder;
+};
+
+static constexpr FlacLevel_t s_flacLevels[CFlacEncoder::s_maxCompressionLevel + 1] =
+{
+	{ false, 0, false, 3 },
+	{ true, 0, false, 3 },
+	{ true, 0, false, 4 },
+	{ true, 6, false, 4 },
+	{ true, 8, false, 4 },
+	{ true, 8, false, 5 },
+	{ true, 8, false, 6 },
+	{ true, 12, false, 6 },
+	{ true, 12, true, 8 },
+};
+
+static constexpr uint32_t s_flacMaxLpcOrder = 12u;
+static constexpr uint32_t s_flacMaxPartitionOrder = 8u;
+
+enum class eFlacSubframeType : uint8_t
+{
+	CONSTANT,
+	VERBATIM,
+	FIXED,
+	LPC,
+};
+
+enum eFlacChannelAssignment : uint32_t
+{
+	FLAC_CHANNELS_INDEPENDENT = 0, // + channel count - 1
+	FLAC_CHANNELS_LEFT_SIDE = 8,
+	FLAC_CHANNELS_RIGHT_SIDE = 9,
+	FLAC_CHANNELS_MID_SIDE = 10,
+};
+
+struct FlacSubframe_t
+{
+	eFlacSubframeType type;
+	uint32_t bitsPerSample;
+	uint32_t order;
+
+	// lpc
+	uint32_t precision;
+	int32_t shift;
+	int32_t coefs[s_flacMaxLpcOrder];
+
+	uint32_t partitionOrder;
+	uint32_t riceParams[1 << s_flacMaxPartitionOrder];
+
+	uint64_t bits; // size of the whole subframe
+
+	const int32_t* samples;
+	std::vector<int32_t> residual; // starts at sample [order]
+};
+
+struct FlacFrameScratch_t
+{
+	std::vector<int32_t> channels[CFlacEncoder::s_maxChannels + 2]; // mid and side are after the two stereo channels
+	FlacSubframe_t subframes[CFlacEncoder::s_maxChannels + 2];
+
+	std::vector<int32_t> candidate; // residual being tried against the best one so far
+	std::vector<double> window;
+	std::vector<double> windowed;
+	uint64_t partitionSums[1 << s_flacMaxPartitionOrder];
+};
+
+//
+// BIT WRITING
+//
+class CFlacBitWriter
+{
+public:
+	CFlacBitWriter(std::vector<uint8_t>& out) : m_out(out), m_acc(0ull), m_bits(0u) {};
+
+	// up to 32 bits, msb first
+	FORCEINLINE void Write(const uint32_t value, const uint32_t bits)
+	{
+		m_acc = (m_acc << bits) | (static_cast<uint64_t>(value) & ((1ull << bits) - 1));
+		m_bits += bits;
+
+		while (m_bits >= 8)
+		{
+			m_bits -= 8;
+			m_out.push_back(static_cast<uint8_t>(m_acc >> m_bits));
+		}
+	}
+
+	FORCEINLINE void WriteSigned(const int32_t value, const uint32_t bits)
+	{
+		Write(static_cast<uint32_t>(value), bits);
+	}
+
+	FORCEINLINE void WriteUnary(uint32_t zeroes)
+	{
+		while (zeroes >= 32)
+		{
+			Write(0u, 32);
+			zeroes -= 32;
+		}
+
+		Write(1u, zeroes + 1);
+	}
+
+	FORCEINLINE void WriteRice(const int32_t value, const uint32_t param)
+	{
+		const uint32_t folded = (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+
+		WriteUnary(folded >> param);
+
+		if (param)
+			Write(folded, param);
+	}
+
+	void AlignToByte()
+	{
+		if (m_bits)
+			Write(0u, 8 - m_bits);
+	}
+
+private:
+	std::vector<uint8_t>& m_out;
+	uint64_t m_acc;
+	uint32_t m_bits;
+};
+
+//
+// CRC
+//
+static const std::array<uint8_t, 256> s_flacCrc8Table = []()
+{
+	std::array<uint8_t, 256> table = {};
+
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		uint32_t crc = i;
+		for (uint32_t bit = 0; bit < 8; ++bit)
+			crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+
+		table[i] = static_cast<uint8_t>(crc);
+	}
+
+	return table;
+}();
+
+static const std::array<uint16_t, 256> s_flacCrc16Table = []()
+{
+	std::array<uint16_t, 256> table = {};
+
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		uint32_t crc = i << 8;
+		for (uint32_t bit = 0; bit < 8; ++bit)
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x8005) : (crc << 1);
+
+		table[i] = static_cast<uint16_t>(crc);
+	}
+
+	return table;
+}();
+
+static const uint8_t FlacCrc8(const uint8_t* const data, const size_t size)
+{
+	uint8_t crc = 0;
+	for (size_t i = 0; i < size; ++i)
+		crc = s_flacCrc8Table[crc ^ data[i]];
+
+	return crc;
+}
+
+static const uint16_t FlacCrc16(const uint8_t* const data, const size_t size)
+{
+	uint16_t crc = 0;
+	for (size_t i = 0; i < size; ++i)
+		crc = static_cast<uint16_t>((crc << 8) ^ s_flacCrc16Table[(crc >> 8) ^ data[i]]);
+
+	return crc;
+}
+
+//
+// RESIDUAL
+//
+static FORCEINLINE const uint32_t FoldResidual(const int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+// estimated size of a rice coded partition, returns the best parameter through param
+static const uint64_t EstimateRicePartition(const uint64_t sum, const uint32_t count, uint32_t& param)
+{
+	if (!count)
+	{
+		param = 0u;
+		return 0ull;
+	}
+
+	// the best parameter is close to log2 of the mean
+	uint32_t guess = 0u;
+	const uint64_t mean = sum / count;
+	if (mean > 0)
+	{
+		unsigned long highBit = 0;
+		_BitScanReverse64(&highBit, mean);
+		guess = static_cast<uint32_t>(highBit);
+	}
+
+	uint64_t bestBits = UINT64_MAX;
+	for (uint32_t k = guess > 0 ? guess - 1 : 0; k <= std::min(guess + 1, 30u); ++k)
+	{
+		const uint64_t bits = static_cast<uint64_t>(count) * (k + 1) + (sum >> k);
+		if (bits < bestBits)
+		{
+			bestBits = bits;
+			param = k;
+		}
+	}
+
+	return bestBits;
+}
+
+// picks the partition order and rice parameters for a residual, returns the size of the coded residual
+static const uint64_t ChooseRiceParameters(const int32_t* const residual, const uint32_t blockSize, const uint32_t order, const uint32_t maxPartitionOrder, FlacSubframe_t& subframe, FlacFrameScratch_t& scratch)
+{
+	// partitions have to split the block evenly and the first one has to hold more than the warmup samples
+	uint32_t partitionOrder = std::min(maxPartitionOrder, s_flacMaxPartitionOrder);
+	while (partitionOrder > 0 && ((blockSize & ((1u << partitionOrder) - 1)) != 0 || (blockSize >> partitionOrder) <= order))
+		--partitionOrder;
+
+	uint64_t* const sums = scratch.partitionSums;
+
+	// sums for the highest order, lower orders merge neighbouring partitions
+	{
+		const uint32_t partitions = 1u << partitionOrder;
+		const uint32_t partitionSize = blockSize >> partitionOrder;
+
+		uint32_t sample = order;
+		for (uint32_t i = 0; i < partitions; ++i)
+		{
+			const uint32_t end = (i + 1) * partitionSize;
+
+			uint64_t sum = 0ull;
+			for (; sample < end; ++sample)
+				sum += FoldResidual(residual[sample - order]);
+
+			sums[i] = sum;
+		}
+	}
+
+	uint64_t bestBits = UINT64_MAX;
+	uint32_t params[1 << s_flacMaxPartitionOrder] = {};
+
+	for (int32_t p = static_cast<int32_t>(partitionOrder); p >= 0; --p)
+	{
+		const uint32_t partitions = 1u << p;
+		const uint32_t partitionSize = blockSize >> p;
+
+		uint64_t bits = 2 + 4; // coding method and partition order
+		uint32_t maxParam = 0u;
+
+		for (uint32_t i = 0; i < partitions; ++i)
+		{
+			const uint32_t count = i == 0 ? partitionSize - order : partitionSize;
+
+			bits += EstimateRicePartition(sums[i], count, params[i]);
+			maxParam = std::max(maxParam, params[i]);
+		}
+
+		// parameters over 14 need the 5 bit coding method
+		bits += static_cast<uint64_t>(partitions) * (maxParam > 14 ? 5 : 4);
+
+		if (bits < bestBits)
+		{
+			bestBits = bits;
+
+			subframe.partitionOrder = static_cast<uint32_t>(p);
+			std::memcpy(subframe.riceParams, params, sizeof(uint32_t) * partitions);
+		}
+
+		// merge pairs for the next order down
+		for (uint32_t i = 0; i < partitions / 2; ++i)
+			sums[i] = sums[i * 2] + sums[i * 2 + 1];
+	}
+
+	return bestBits;
+}
+
+static void WriteResidual(CFlacBitWriter& writer, const FlacSubframe_t& subframe, const uint32_t blockSize)
+{
+	const uint32_t partitions = 1u << subframe.partitionOrder;
+	const uint32_t partitionSize = blockSize >> subframe.partitionOrder;
+
+	uint32_t maxParam = 0u;
+	for (uint32_t i = 0; i < partitions; ++i)
+		maxParam = std::max(maxParam, subframe.riceParams[i]);
+
+	const uint32_t paramBits = maxParam > 14 ? 5 : 4;
+
+	writer.Write(paramBits == 5 ? 1 : 0, 2);
+	writer.Write(subframe.partitionOrder, 4);
+
+	const int32_t* residual = subframe.residual.data();
+	for (uint32_t i = 0; i < partitions; ++i)
+	{
+		const uint32_t count = i == 0 ? partitionSize - subframe.order : partitionSize;
+		const uint32_t param = subframe.riceParams[i];
+
+		writer.Write(param, paramBits);
+
+		for (uint32_t sample = 0; sample < count; ++sample)
+			writer.WriteRice(residual[sample], param);
+
+		residual += count;
+	}
+}
+
+//
+// PREDICTION
+//
+static void ComputeFixedResidual(const int32_t* const s, const uint32_t blockSize, const uint32_t order, int32_t* const residual)
+{
+	switch (order)
+	{
+	case 0:
+		for (uint32_t i = 0; i < blockSize; ++i)
+			residual[i] = s[i];
+		break;
+	case 1:
+		for (uint32_t i = 1; i < blockSize; ++i)
+			residual[i - 1] = s[i] - s[i - 1];
+		break;
+	case 2:
+		for (uint32_t i = 2; i < blockSize; ++i)
+			residual[i - 2] = s[i] - 2 * s[i - 1] + s[i - 2];
+		break;
+	case 3:
+		for (uint32_t i = 3; i < blockSize; ++i)
+			residual[i - 3] = s[i] - 3 * s[i - 1] + 3 * s[i - 2] - s[i - 3];
+		break;
+	case 4:
+		for (uint32_t i = 4; i < blockSize; ++i)
+			residual[i - 4] = s[i] - 4 * s[i - 1] + 6 * s[i - 2] - 4 * s[i - 3] + s[i - 4];
+		break;
+	default:
+		unreachable();
+	}
+}
+
+// the fixed order with the smallest total residual
+static const uint32_t ChooseFixedOrder(const int32_t* const s, const uint32_t blockSize)
+{
+	const uint32_t maxOrder = std::min(4u, blockSize - 1);
+
+	uint64_t totals[5] = {};
+	for (uint32_t i = 4; i < blockSize; ++i)
+	{
+		const int64_t e0 = s[i];
+		const int64_t e1 = e0 - s[i - 1];
+		const int64_t e2 = e1 - (static_cast<int64_t>(s[i - 1]) - s[i - 2]);
+		const int64_t e3 = e2 - (static_cast<int64_t>(s[i - 1]) - 2ll * s[i - 2] + s[i - 3]);
+		const int64_t e4 = e3 - (static_cast<int64_t>(s[i - 1]) - 3ll * s[i - 2] + 3ll * s[i - 3] - s[i - 4]);
+
+		totals[0] += static_cast<uint64_t>(std::abs(e0));
+		totals[1] += static_cast<uint64_t>(std::abs(e1));
+		totals[2] += static_cast<uint64_t>(std::abs(e2));
+		totals[3] += static_cast<uint64_t>(std::abs(e3));
+		totals[4] += static_cast<uint64_t>(std::abs(e4));
+	}
+
+	uint32_t best = 0u;
+	for (uint32_t order = 1; order <= maxOrder; ++order)
+	{
+		if (totals[order] < totals[best])
+			best = order;
+	}
+
+	return best;
+}
+
+// tukey(0.5) window, same as the reference encoder's default
+static void BuildWindow(std::vector<double>& window, const uint32_t blockSize)
+{
+	if (window.size() == blockSize)
+		return;
+
+	window.resize(blockSize);
+
+	constexpr double p = 0.5;
+	const uint32_t taper = static_cast<uint32_t>(p / 2.0 * blockSize);
+
+	for (uint32_t i = 0; i < blockSize; ++i)
+		window[i] = 1.0;
+
+	if (taper > 1)
+	{
+		for (uint32_t i = 0; i < taper; ++i)
+		{
+			const double w = 0.5 - 0.5 * cos(3.14159265358979323846 * i / (taper - 1));
+
+			window[i] = w;
+			window[blockSize - 1 - i] = w;
+		}
+	}
+}
+
+// levinson-durbin, coefs[order - 1] holds the predictor for each order and errors the remaining error
+static void ComputeLpcCoefficients(const double* const autoc, const uint32_t maxOrder, double coefs[s_flacMaxLpcOrder][s_flacMaxLpcOrder], double* const errors)
+{
+	double lpc[s_flacMaxLpcOrder] = {};
+	double err = autoc[0];
+
+	for (uint32_t i = 0; i < maxOrder; ++i)
+	{
+		double r = -autoc[i + 1];
+		for (uint32_t j = 0; j < i; ++j)
+			r -= lpc[j] * autoc[i - j];
+
+		r /= err;
+
+		lpc[i] = r;
+
+		uint32_t j = 0;
+		for (; j < (i >> 1); ++j)
+		{
+			const double tmp = lpc[j];
+			lpc[j] += r * lpc[i - 1 - j];
+			lpc[i - 1 - j] += r * tmp;
+		}
+
+		if (i & 1)
+			lpc[j] += lpc[j] * r;
+
+		err *= (1.0 - r * r);
+
+		for (j = 0; j <= i; ++j)
+			coefs[i][j] = -lpc[j];
+
+		errors[i] = err;
+	}
+}
+
+static const bool QuantizeLpcCoefficients(const double* const coefs, const uint32_t order, const uint32_t precision, int32_t* const quantized, int32_t& shift)
+{
+	double cmax = 0.0;
+	for (uint32_t i = 0; i < order; ++i)
+		cmax = std::max(cmax, std::abs(coefs[i]));
+
+	if (cmax <= 0.0)
+		return false;
+
+	const int32_t qmax = (1 << (precision - 1)) - 1;
+	const int32_t qmin = -(1 << (precision - 1));
+
+	int log2cmax = 0;
+	frexp(cmax, &log2cmax);
+	--log2cmax;
+
+	shift = static_cast<int32_t>(precision) - log2cmax - 2;
+
+	// negative shifts aren't allowed
+	if (shift < 0)
+		return false;
+
+	shift = std::min(shift, 15);
+
+	// carry the rounding error into the next coefficient
+	double error = 0.0;
+	for (uint32_t i = 0; i < order; ++i)
+	{
+		error += coefs[i] * static_cast<double>(1 << shift);
+
+		const int32_t q = std::clamp(static_cast<int32_t>(lround(error)), qmin, qmax);
+		quantized[i] = q;
+
+		error -= q;
+	}
+
+	return true;
+}
+
+// false if a residual doesn't fit in 32 bits
+static const bool ComputeLpcResidual(const int32_t* const s, const uint32_t blockSize, const int32_t* const coefs, const uint32_t order, const int32_t shift, int32_t* const residual)
+{
+	for (uint32_t i = order; i < blockSize; ++i)
+	{
+		int64_t sum = 0;
+		for (uint32_t j = 0; j < order; ++j)
+			sum += static_cast<int64_t>(coefs[j]) * s[i - j - 1];
+
+		const int64_t res = s[i] - (sum >> shift);
+		if (res < INT32_MIN || res > INT32_MAX)
+			return false;
+
+		residual[i - order] = static_cast<int32_t>(res);
+	}
+
+	return true;
+}
+
+static const double ExpectedBitsPerResidual(const double error, const uint32_t blockSize)
+{
+	if (error <= 0.0)
+		return 0.0;
+
+	const double bits = 0.5 * log2(0.5 / blockSize * error);
+	return bits > 0.0 ? bits : 0.0;
+}
+
+//
+// ENCODER
+//
+CFlacEncoder::CFlacEncoder(const uint16_t channels, const uint32_t sampleRate, const uint32_t bitsPerSample, const uint32_t compressionLevel) :
+	m_channels(channels), m_sampleRate(sampleRate), m_bitsPerSample(bitsPerSample), m_compressionLevel(std::min(compressionLevel, s_maxCompressionLevel))
+{
+	assertm(IsSupportedBitDepth(bitsPerSample), "unsupported flac bit depth");
+}
+
+void CFlacEncoder::AnalyseSubframe(const int32_t* const samples, const uint32_t blockSize, const uint32_t bitsPerSample, FlacSubframe_t& subframe, FlacFrameScratch_t& scratch) const
+{
+	const FlacLevel_t& level = s_flacLevels[m_compressionLevel];
+
+	subframe.samples = samples;
+	subframe.bitsPerSample = bitsPerSample;
+	subframe.order = 0u;
+
+	// silence and dc
+	if (std::all_of(samples + 1, samples + blockSize, [first = samples[0]](const int32_t sample) { return sample == first; }))
+	{
+		subframe.type = eFlacSubframeType::CONSTANT;
+		subframe.bits = 8 + bitsPerSample;
+
+		return;
+	}
+
+	subframe.type = eFlacSubframeType::VERBATIM;
+	subframe.bits = 8 + static_cast<uint64_t>(blockSize) * bitsPerSample;
+
+	subframe.residual.resize(blockSize);
+	scratch.candidate.resize(blockSize);
+
+	FlacSubframe_t candidate;
+
+	// fixed
+	{
+		const uint32_t order = ChooseFixedOrder(samples, blockSize);
+		ComputeFixedResidual(samples, blockSize, order, scratch.candidate.data());
+
+		const uint64_t bits = 8 + static_cast<uint64_t>(order) * bitsPerSample + ChooseRiceParameters(scratch.candidate.data(), blockSize, order, level.maxPartitionOrder, candidate, scratch);
+		if (bits < subframe.bits)
+		{
+			subframe.type = eFlacSubframeType::FIXED;
+			subframe.order = order;
+			subframe.bits = bits;
+			subframe.partitionOrder = candidate.partitionOrder;
+			std::memcpy(subframe.riceParams, candidate.riceParams, sizeof(uint32_t) << candidate.partitionOrder);
+
+			std::swap(subframe.residual, scratch.candidate);
+		}
+	}
+
+	// lpc
+	const uint32_t maxLpcOrder = std::min(level.maxLpcOrder, blockSize - 1);
+	if (maxLpcOrder == 0)
+		return;
+
+	BuildWindow(scratch.window, blockSize);
+	scratch.windowed.resize(blockSize);
+
+	for (uint32_t i = 0; i < blockSize; ++i)
+		scratch.windowed[i] = samples[i] * scratch.window[i];
+
+	double autoc[s_flacMaxLpcOrder + 1] = {};
+	for (uint32_t lag = 0; lag <= maxLpcOrder; ++lag)
+	{
+		double sum = 0.0;
+		for (uint32_t i = lag; i < blockSize; ++i)
+			sum += scratch.windowed[i] * scratch.windowed[i - lag];
+
+		autoc[lag] = sum;
+	}
+
+	if (autoc[0] == 0.0)
+		return;
+
+	double coefs[s_flacMaxLpcOrder][s_flacMaxLpcOrder] = {};
+	double errors[s_flacMaxLpcOrder] = {};
+	ComputeLpcCoefficients(autoc, maxLpcOrder, coefs, errors);
+
+	const uint32_t precision = bitsPerSample <= 17 ? 12u : 15u;
+
+	uint32_t firstOrder = 1u;
+	uint32_t lastOrder = maxLpcOrder;
+
+	if (!level.exhaustiveLpcOrder)
+	{
+		// estimate the best order from the prediction error
+		double bestBits = std::numeric_limits<double>::max();
+		for (uint32_t order = 1; order <= maxLpcOrder; ++order)
+		{
+			const double bits = ExpectedBitsPerResidual(errors[order - 1], blockSize) * (blockSize - order) + static_cast<double>(order) * (bitsPerSample + precision);
+			if (bits < bestBits)
+			{
+				bestBits = bits;
+				firstOrder = order;
+			}
+		}
+
+		lastOrder = firstOrder;
+	}
+
+	for (uint32_t order = firstOrder; order <= lastOrder; ++order)
+	{
+		int32_t shift = 0;
+		if (!QuantizeLpcCoefficients(coefs[order - 1], order, precision, candidate.coefs, shift))
+			continue;
+
+		if (!ComputeLpcResidual(samples, blockSize, candidate.coefs, order, shift, scratch.candidate.data()))
+			continue;
+
+		const uint64_t bits = 8 + static_cast<uint64_t>(order) * (bitsPerSample + precision) + 4 + 5 + ChooseRiceParameters(scratch.candidate.data(), blockSize, order, level.maxPartitionOrder, candidate, scratch);
+		if (bits < subframe.bits)
+		{
+			subframe.type = eFlacSubframeType::LPC;
+			subframe.order = order;
+			subframe.bits = bits;
+			subframe.precision = precision;
+			subframe.shift = shift;
+			std::memcpy(subframe.coefs, candidate.coefs, sizeof(int32_t) * order);
+			subframe.partitionOrder = candidate.partitionOrder;
+			std::memcpy(subframe.riceParams, candidate.riceParams, sizeof(uint32_t) << candidate.partitionOrder);
+
+			std::swap(subframe.residual, scratch.candidate);
+		}
+	}
+}
+
+static void WriteSubframe(CFlacBitWriter& writer, const FlacSubframe_t& subframe, const uint32_t blockSize)
+{
+	const uint32_t bps = subframe.bitsPerSample;
+
+	// zero padding bit, type and no wasted bits
+	switch (subframe.type)
+	{
+	case eFlacSubframeType::CONSTANT:
+	{
+		writer.Write(0b00000000, 8);
+		writer.WriteSigned(subframe.samples[0], bps);
+
+		return;
+	}
+	case eFlacSubframeType::VERBATIM:
+	{
+		writer.Write(0b00000010, 8);
+
+		for (uint32_t i = 0; i < blockSize; ++i)
+			writer.WriteSigned(subframe.samples[i], bps);
+
+		return;
+	}
+	case eFlacSubframeType::FIXED:
+	{
+		writer.Write((0b001000 | subframe.order) << 1, 8);
+
+		for (uint32_t i = 0; i < subframe.order; ++i)
+			writer.WriteSigned(subframe.samples[i], bps);
+
+		WriteResidual(writer, subframe, blockSize);
+
+		return;
+	}
+	case eFlacSubframeType::LPC:
+	{
+		writer.Write((0b100000 | (subframe.order - 1)) << 1, 8);
+
+		for (uint32_t i = 0; i < subframe.order; ++i)
+			writer.WriteSigned(subframe.samples[i], bps);
+
+		writer.Write(subframe.precision - 1, 4);
+		writer.WriteSigned(subframe.shift, 5);
+
+		for (uint32_t i = 0; i < subframe.order; ++i)
+			writer.WriteSigned(subframe.coefs[i], subframe.precision);
+
+		WriteResidual(writer, subframe, blockSize);
+
+		return;
+	}
+	}
+
+	unreachable();
+}
+
+static const uint32_t FlacSampleRateCode(const uint32_t sampleRate)
+{
+	switch (sampleRate)
+	{
+	case 88200: return 1;
+	case 176400: return 2;
+	case 192000: return 3;
+	case 8000: return 4;
+	case 16000: return 5;
+	case 22050: return 6;
+	case 24000: return 7;
+	case 32000: return 8;
+	case 44100: return 9;
+	case 48000: return 10;
+	case 96000: return 11;
+	default: return 0; // taken from the stream info
+	}
+}
+
+void CFlacEncoder::EncodeFrame(std::vector<uint8_t>& out, const float* const samples, const uint32_t blockSize, const uint32_t frameIndex, FlacFrameScratch_t& scratch) const
+{
+	const FlacLevel_t& level = s_flacLevels[m_compressionLevel];
+
+	// quantize
+	const float scale = static_cast<float>(1u << (m_bitsPerSample - 1));
+	const int32_t sampleMax = static_cast<int32_t>(1u << (m_bitsPerSample - 1)) - 1;
+	const int32_t sampleMin = -static_cast<int32_t>(1u << (m_bitsPerSample - 1));
+
+	for (uint32_t channel = 0; channel < m_channels; ++channel)
+	{
+		std::vector<int32_t>& channelSamples = scratch.channels[channel];
+		channelSamples.resize(blockSize);
+
+		for (uint32_t i = 0; i < blockSize; ++i)
+		{
+			const float sample = std::clamp(samples[static_cast<size_t>(i) * m_channels + channel] * scale, static_cast<float>(sampleMin), static_cast<float>(sampleMax));
+			channelSamples[i] = static_cast<int32_t>(lrintf(sample));
+		}
+	}
+
+	uint32_t channelAssignment = FLAC_CHANNELS_INDEPENDENT + m_channels - 1;
+	const FlacSubframe_t* subframes[2] = {};
+
+	if (m_channels == 2 && level.stereoDecorrelation)
+	{
+		const std::vector<int32_t>& left = scratch.channels[0];
+		const std::vector<int32_t>& right = scratch.channels[1];
+		std::vector<int32_t>& mid = scratch.channels[2];
+		std::vector<int32_t>& side = scratch.channels[3];
+
+		mid.resize(blockSize);
+		side.resize(blockSize);
+
+		for (uint32_t i = 0; i < blockSize; ++i)
+		{
+			mid[i] = (left[i] + right[i]) >> 1;
+			side[i] = left[i] - right[i];
+		}
+
+		AnalyseSubframe(left.data(), blockSize, m_bitsPerSample, scratch.subframes[0], scratch);
+		AnalyseSubframe(right.data(), blockSize, m_bitsPerSample, scratch.subframes[1], scratch);
+		AnalyseSubframe(mid.data(), blockSize, m_bitsPerSample, scratch.subframes[2], scratch);
+		AnalyseSubframe(side.data(), blockSize, m_bitsPerSample + 1, scratch.subframes[3], scratch);
+
+		const FlacSubframe_t& l = scratch.subframes[0];
+		const FlacSubframe_t& r = scratch.subframes[1];
+		const FlacSubframe_t& m = scratch.subframes[2];
+		const FlacSubframe_t& s = scratch.subframes[3];
+
+		const uint64_t costs[4] = { l.bits + r.bits, l.bits + s.bits, s.bits + r.bits, m.bits + s.bits };
+		const size_t best = static_cast<size_t>(std::distance(std::begin(costs), std::min_element(std::begin(costs), std::end(costs))));
+
+		switch (best)
+		{
+		case 0:
+			channelAssignment = FLAC_CHANNELS_INDEPENDENT + 1;
+			subframes[0] = &l;
+			subframes[1] = &r;
+			break;
+		case 1:
+			channelAssignment = FLAC_CHANNELS_LEFT_SIDE;
+			subframes[0] = &l;
+			subframes[1] = &s;
+			break;
+		case 2:
+			channelAssignment = FLAC_CHANNELS_RIGHT_SIDE;
+			subframes[0] = &s;
+			subframes[1] = &r;
+			break;
+		case 3:
+			channelAssignment = FLAC_CHANNELS_MID_SIDE;
+			subframes[0] = &m;
+			subframes[1] = &s;
+			break;
+		default:
+			unreachable();
+		}
+	}
+	else
+	{
+		for (uint32_t channel = 0; channel < m_channels; ++channel)
+			AnalyseSubframe(scratch.channels[channel].data(), blockSize, m_bitsPerSample, scratch.subframes[channel], scratch);
+	}
+
+	const size_t frameStart = out.size();
+	CFlacBitWriter writer(out);
+
+	// header
+	uint32_t blockSizeCode = 7; // 16 bit size at the end of the header
+	if (blockSize == s_blockSize)
+		blockSizeCode = 12; // 4096
+	else if (blockSize <= 256)
+		blockSizeCode = 6; // 8 bit size at the end of the header
+
+	const uint32_t sampleRateCode = FlacSampleRateCode(m_sampleRate);
+
+	writer.Write(0xFFF8, 16); // sync code, fixed block size
+	writer.Write(blockSizeCode, 4);
+	writer.Write(sampleRateCode, 4);
+	writer.Write(channelAssignment, 4);
+	writer.Write(m_bitsPerSample == 16 ? 0b100 : 0b110, 3);
+	writer.Write(0, 1);
+
+	// frame number, coded like utf-8
+	if (frameIndex < 0x80)
+	{
+		writer.Write(frameIndex, 8);
+	}
+	else
+	{
+		uint32_t continuationBytes = 1;
+		while (continuationBytes < 5 && frameIndex >= (1u << (5 * continuationBytes + 6)))
+			++continuationBytes;
+
+		const uint32_t leadBits = 6 - continuationBytes;
+		const uint32_t leadMarker = (0xFF00u >> (continuationBytes + 1)) & 0xFF;
+
+		writer.Write(leadMarker | ((frameIndex >> (6 * continuationBytes)) & ((1u << leadBits) - 1)), 8);
+
+		for (int32_t i = static_cast<int32_t>(continuationBytes) - 1; i >= 0; --i)
+			writer.Write(0x80 | ((frameIndex >> (6 * i)) & 0x3F), 8);
+	}
+
+	if (blockSizeCode == 6)
+		writer.Write(blockSize - 1, 8);
+	else if (blockSizeCode == 7)
+		writer.Write(blockSize - 1, 16);
+
+	writer.Write(FlacCrc8(out.data() + frameStart, out.size() - frameStart), 8);
+
+	// subframes
+	if (subframes[0])
+	{
+		WriteSubframe(writer, *subframes[0], blockSize);
+		WriteSubframe(writer, *subframes[1], blockSize);
+	}
+	else
+	{
+		for (uint32_t channel = 0; channel < m_channels; ++channel)
+			WriteSubframe(writer, scratch.subframes[channel], blockSize);
+	}
+
+	writer.AlignToByte();
+	writer.Write(FlacCrc16(out.data() + frameStart, out.size() - frameStart), 16);
+}
+
+void CFlacEncoder::WriteStreamInfo(std::vector<uint8_t>& out, const uint64_t sampleCount, const uint32_t minFrameSize, const uint32_t maxFrameSize) const
+{
+	CFlacBitWriter writer(out);
+
+	const uint32_t blockSize = static_cast<uint32_t>(std::clamp(sampleCount, static_cast<uint64_t>(16), static_cast<uint64_t>(s_blockSize)));
+
+	writer.Write('fLaC', 32);
+
+	writer.Write(1, 1); // last metadata block
+	writer.Write(0, 7); // stream info
+	writer.Write(34, 24);
+
+	writer.Write(blockSize, 16);
+	writer.Write(blockSize, 16);
+	writer.Write(minFrameSize, 24);
+	writer.Write(maxFrameSize, 24);
+	writer.Write(m_sampleRate, 20);
+	writer.Write(m_channels - 1, 3);
+	writer.Write(m_bitsPerSample - 1, 5);
+	writer.Write(static_cast<uint32_t>(sampleCount >> 32), 4);
+	writer.Write(static_cast<uint32_t>(sampleCount), 32);
+
+	// md5 left empty
+	for (uint32_t i = 0; i < 4; ++i)
+		writer.Write(0, 32);
+}
+
+const bool CFlacEncoder::Encode(StreamIO& out, const float* const samples, const uint64_t sampleCount, const uint32_t threadCount) const
+{
+	if (m_channels == 0 || m_channels > s_maxChannels || !IsSupportedBitDepth(m_bitsPerSample))
+		return false;
+
+	std::vector<uint8_t> header;
+	WriteStreamInfo(header, sampleCount, 0, 0);
+
+	out.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+	const uint32_t frameCount = static_cast<uint32_t>((sampleCount + s_blockSize - 1) / s_blockSize);
+
+	// frames are encoded a batch at a time so only one batch of output is held in memory
+	const uint32_t workerCount = std::max(threadCount, 1u);
+	const uint32_t batchSize = workerCount * 16;
+
+	std::vector<std::vector<uint8_t>> frames(batchSize);
+	std::vector<FlacFrameScratch_t> scratch(workerCount);
+
+	uint32_t minFrameSize = UINT32_MAX;
+	uint32_t maxFrameSize = 0u;
+
+	for (uint32_t batchStart = 0; batchStart < frameCount; batchStart += batchSize)
+	{
+		const uint32_t batchCount = std::min(batchSize, frameCount - batchStart);
+		const uint32_t batchThreads = std::min(workerCount, batchCount);
+
+		std::atomic<uint32_t> frameIdx = 0;
+		std::atomic<uint32_t> scratchIdx = 0;
+
+		const auto encodeFrames = [&]
+		{
+			FlacFrameScratch_t& threadScratch = scratch[scratchIdx++];
+
+			while (frameIdx < batchCount)
+			{
+				const uint32_t frameToProcess = frameIdx++;
+				if (frameToProcess >= batchCount)
+					continue;
+
+				const uint32_t frameIndex = batchStart + frameToProcess;
+				const uint64_t firstSample = static_cast<uint64_t>(frameIndex) * s_blockSize;
+				const uint32_t blockSize = static_cast<uint32_t>(std::min(static_cast<uint64_t>(s_blockSize), sampleCount - firstSample));
+
+				std::vector<uint8_t>& frame = frames[frameToProcess];
+				frame.clear();
+
+				EncodeFrame(frame, samples + firstSample * m_channels, blockSize, frameIndex, threadScratch);
+			}
+		};
+
+		if (batchThreads > 1)
+		{
+			CParallelTask parallelFrameTask(batchThreads);
+			parallelFrameTask.addTask(encodeFrames, batchThreads);
+			parallelFrameTask.execute();
+			parallelFrameTask.wait();
+		}
+		else
+		{
+			encodeFrames();
+		}
+
+		for (uint32_t i = 0; i < batchCount; ++i)
+		{
+			const std::vector<uint8_t>& frame = frames[i];
+
+			minFrameSize = std::min(minFrameSize, static_cast<uint32_t>(frame.size()));
+			maxFrameSize = std::max(maxFrameSize, static_cast<uint32_t>(frame.size()));
+
+			out.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+		}
+	}
+
+	// frame sizes are only known now
+	if (frameCount)
+	{
+		header.clear();
+		WriteStreamInfo(header, sampleCount, minFrameSize, maxFrameSize);
+
+		out.seek(0);
+		out.write(reinterpret_cast<const char*>(header.data()), header.size());
+	}
+
+	return true;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+struct FlacFrameScratch_t;
+struct FlacSubframe_t;
+
+// flac encoder for exported audio
+// frames don't depend on each other, so batches of frames are encoded in parallel and written out in order as each batch finishes
+// the md5 in the stream info is left empty, which flac allows for encoders that don't compute it
+class CFlacEncoder
+{
+public:
+	static constexpr uint32_t s_maxCompressionLevel = 8u;
+	static constexpr uint32_t s_maxChannels = 8u;
+	static constexpr uint32_t s_blockSize = 4096u;
+
+	CFlacEncoder(const uint16_t channels, const uint32_t sampleRate, const uint32_t bitsPerSample, const uint32_t compressionLevel);
+
+	// samples are interleaved floats in [-1, 1], they are rounded to bitsPerSample
+	const bool Encode(StreamIO& out, const float* const samples, const uint64_t sampleCount, const uint32_t threadCount) const;
+
+	static const bool IsSupportedBitDepth(const uint32_t bitsPerSample) { return bitsPerSample == 16 || bitsPerSample == 24; };
+
+private:
+	void WriteStreamInfo(std::vector<uint8_t>& out, const uint64_t sampleCount, const uint32_t minFrameSize, const uint32_t maxFrameSize) const;
+	void EncodeFrame(std::vector<uint8_t>& out, const float* const samples, const uint32_t blockSize, const uint32_t frameIndex, FlacFrameScratch_t& scratch) const;
+	void AnalyseSubframe(const int32_t* const samples, const uint32_t blockSize, const uint32_t bitsPerSample, FlacSubframe_t& subframe, FlacFrameScratch_t& scratch) const;
+
+	uint16_t m_channels;
+	uint32_t m_sampleRate;
+	uint32_t m_bitsPerSample;
+	uint32_t m_compressionLevel;
+};
@@ -2,7 +2,11 @@
 #include "miles.h"
 
 #include <game/audio/wavefile.h>
+#include <game/audio/flac.h>
 #include <game/rtech/utils/utils.h>
+#include <core/cache/streamindex.h>
+
+#include <thirdparty/imgui/misc/imgui_utility.h>
 
 std::string CMilesAudioBank::GetStreamingFileNameForSource(const MilesSource_t* source) const
 {
@@ -42,6 +46,27 @@ bool CMilesAudioBank::IsValidSource(const MilesSource_t* source) const
 	return true;
 }
 
+const CMappedFile* const CMilesAudioBank::GetStreamFileForSource(const MilesSource_t* source)
+{
+	const uint32_t key = (static_cast<uint32_t>(source->languageIdx) << 16) | source->patchIdx;
+
+	std::lock_guard lock(m_streamFileMutex);
+
+	if (const auto it = m_streamFiles.find(key); it != m_streamFiles.end())
+		return it->second.get();
+
+	// get the bank's path and replace the filename
+	// with the stream file name for this source
+	std::filesystem::path streamPath(m_filePath);
+	streamPath.replace_filename(GetStreamingFileNameForSource(source));
+
+	std::unique_ptr<CMappedFile> streamFile = std::make_unique<CMappedFile>(streamPath);
+	if (!streamFile->IsOpen() || streamFile->Size() < sizeof(MilesStreamHeader_t))
+		return nullptr;
+
+	return m_streamFiles.emplace(key, std::move(streamFile)).first->second.get();
+}
+
 void CMilesAudioBank::DiscoverStreamingFiles()
 {
 	const std::filesystem::path filePath(m_filePath);
@@ -51,17 +76,21 @@ void CMilesAudioBank::DiscoverStreamingFiles()
 
 	this->m_streamStates = 0;
 
+	const uint64_t indexHits = g_milesStreamIndex.GetHits();
+	const uint64_t indexMisses = g_milesStreamIndex.GetMisses();
+
 	for (auto& it : std::filesystem::directory_iterator(dirPath))
 	{
 		if (it.is_regular_file())
 		{
 			if (it.path().extension() == ".mstr")
 			{
-				//Log("MSTR: Checking %s\n", it.path().string().c_str());
-				StreamIO stream(it.path(), eStreamIOMode::Read);
+				//LOG_DEBUG(AUDIO, "MSTR: Checking %s\n", it.path().string().c_str());
 
-				MilesStreamHeader_t header = stream.read<MilesStreamHeader_t>();
-				stream.close();
+				// unchanged files come from the index without being opened
+				MilesStreamHeader_t header = {};
+				if (!g_milesStreamIndex.GetHeader(it, header))
+					continue;
 
 				// Require 'CSTR' magic and "version" 2
 				// It's not clear if the 2 is actually a version, but it lines up
@@ -96,7 +125,7 @@ void CMilesAudioBank::DiscoverStreamingFiles()
 		}
 	}
 
-	Log("MBNK: Finished discovering streams.\n");
+	LOG_INFO(AUDIO, "MBNK: Finished discovering streams (%llu indexed, %llu read).\n", g_milesStreamIndex.GetHits() - indexHits, g_milesStreamIndex.GetMisses() - indexMisses);
 }
 
 const bool CMilesAudioBank::ParseFromHeader()
@@ -125,7 +154,7 @@ const bool CMilesAudioBank::ParseFromHeader()
 
 		this->DiscoverStreamingFiles();
 
-		Log("MBNK: Parsing sources...\n");
+		LOG_DEBUG(AUDIO, "MBNK: Parsing sources...\n");
 		for (uint32_t i = 0; i < this->sourceCount; ++i)
 		{
 			const MilesSource_v28_t* const source = reinterpret_cast<MilesSource_v28_t*>(reinterpret_cast<char*>(this->audioSources) + (i * sizeof(MilesSource_v28_t)));
@@ -167,7 +196,7 @@ const bool CMilesAudioBank::ParseFromHeader()
 
 		this->DiscoverStreamingFiles();
 
-		Log("MBNK: Parsing sources...\n");
+		LOG_DEBUG(AUDIO, "MBNK: Parsing sources...\n");
 		for (uint32_t i = 0; i < this->sourceCount; ++i)
 		{
 			const MilesSource_v39_t* const source = reinterpret_cast<MilesSource_v39_t*>(reinterpret_cast<char*>(this->audioSources) + (i * sizeof(MilesSource_v39_t)));
@@ -199,7 +228,7 @@ const bool CMilesAudioBank::ParseFromHeader()
 
 const bool CMilesAudioBank::ParseFile(const std::string& path)
 {
-	Log("MBNK: Trying to load file: %s\n", path.c_str());
+	LOG_DEBUG(AUDIO, "MBNK: Trying to load file: %s\n", path.c_str());
 
 	m_filePath = path;
 
@@ -219,11 +248,11 @@ const bool CMilesAudioBank::ParseFile(const std::string& path)
 
 	if (!this->ParseFromHeader())
 	{
-		Log("MBNK: Tried to parse unimplemented file version %i.\n", hdrShort->version);
+		LOG_WARN(AUDIO, "MBNK: Tried to parse unimplemented file version %i.\n", hdrShort->version);
 		return false;
 	}
 
-	Log("MBNK: Loaded bank \"%s\" with %u sources and %u events.\n", this->stringTable, this->sourceCount, this->eventCount);
+	LOG_INFO(AUDIO, "MBNK: Loaded bank \"%s\" with %u sources and %u events.\n", this->stringTable, this->sourceCount, this->eventCount);
 
 	return true;
 }
@@ -232,6 +261,17 @@ extern ExportSettings_t g_ExportSettings;
 
 constexpr const char* PATH_PREFIX_ASRC = "audio";
 
+// copies from the mapped stream file, anything past the end of the file reads as zeroes
+static void ReadStreamData(MilesASIUserData_t* userData, char* buffer, size_t length)
+{
+	const size_t available = userData->streamPos < userData->streamSize ? std::min(length, static_cast<size_t>(userData->streamSize - userData->streamPos)) : 0ull;
+
+	memcpy(buffer, userData->streamData + userData->streamPos, available);
+	memset(buffer + available, 0, length - available);
+
+	userData->streamPos += length;
+}
+
 uint32_t ReadAudioStream(char* buffer, size_t length, MilesASIUserData_t* userData)
 {
 	size_t totalRead = 0;
@@ -240,28 +280,85 @@ uint32_t ReadAudioStream(char* buffer, size_t length, MilesASIUserData_t* userDa
 	{
 		auto Diff = userData->headerSize - userData->dataRead;
 		auto MinDiff = std::min(length, Diff);
-		userData->streamReader->read(buffer, MinDiff);
+		ReadStreamData(userData, buffer, MinDiff);
 		userData->dataRead += MinDiff;
 		totalRead += MinDiff;
 
 		if (userData->dataRead >= userData->headerSize)
-			userData->streamReader->seek(userData->audioStreamOffset);
+			userData->streamPos = userData->audioStreamOffset;
 	}
 
 	uint64_t LengthToRead = length - totalRead;
 	LengthToRead = std::min(userData->audioStreamSize, LengthToRead);
 
-	userData->streamReader->read(buffer + totalRead, LengthToRead);
+	ReadStreamData(userData, buffer + totalRead, LengthToRead);
 	totalRead += LengthToRead;
 	userData->audioStreamSize -= LengthToRead;
 
 	return (uint32_t)totalRead;
 }
 
-bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
+enum eAudioSourceExportSetting
+{
+	ASRC_WAV,	// 32 bit float wav, as decoded
+	ASRC_FLAC,	// lossless compressed, quantized to the flac bit depth setting
+};
+
+static const bool ExportAudioSourceAsWav(const std::filesystem::path& exportPath, const std::vector<float>& interleavedBuffer, const uint16_t channels, const uint32_t sampleRate, const uint32_t samplesCount)
 {
-	UNUSED(setting);
+	StreamIO outFile(exportPath, eStreamIOMode::Write);
+
+	WAVEHEADER hdr;
+
+
+	outFile.write(hdr);
+	outFile.write(reinterpret_cast<const char*>(interleavedBuffer.data()), interleavedBuffer.size() * sizeof(float));
+
+	const uint64_t DataSize = interleavedBuffer.size() * sizeof(float);
+	hdr.size = static_cast<long>(DataSize + 36);
+
+	hdr.fmt.channels = channels;
+	hdr.fmt.sampleRate = sampleRate;
+	hdr.fmt.blockAlign = static_cast<uint16_t>(DataSize / samplesCount);
+	hdr.fmt.bitsPerSample = static_cast<uint16_t>(((DataSize * 8) / samplesCount) / channels);
+
+	hdr.data.chunkSize = static_cast<long>(DataSize);
+
+	hdr.fmt.avgBytesPerSecond = hdr.fmt.blockAlign * sampleRate;
+
+	outFile.seek(0);
+	outFile.write(hdr);
+	outFile.close();
+
+	return true;
+}
+
+static const bool ExportAudioSourceAsFlac(const std::filesystem::path& exportPath, const std::vector<float>& interleavedBuffer, const uint16_t channels, const uint32_t sampleRate, const uint32_t samplesCount)
+{
+	if (channels > CFlacEncoder::s_maxChannels)
+	{
+		LOG_WARN(AUDIO, "MILES: FLAC can't hold %u channels, export \"%s\" as WAV instead.\n", channels, exportPath.filename().string().c_str());
+		return false;
+	}
+
+	const uint32_t bitsPerSample = g_ExportSettings.exportAudioFlacBitDepth == eAudioFlacBitDepth::AUDIO_FLAC_16BIT ? 16u : 24u;
+	const CFlacEncoder encoder(channels, sampleRate, bitsPerSample, g_ExportSettings.exportAudioFlacLevel);
 
+	StreamIO outFile;
+	if (!outFile.open(exportPath.string(), eStreamIOMode::Write))
+	{
+		assertm(false, "Failed to open file for write.");
+		return false;
+	}
+
+	const bool success = encoder.Encode(outFile, interleavedBuffer.data(), samplesCount, UtilsConfig->exportThreadCount);
+	outFile.close();
+
+	return success;
+}
+
+bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
+{
 	CMilesAudioAsset* audioAsset = static_cast<CMilesAudioAsset*>(asset);
 	CMilesAudioBank* audioBank = asset->GetContainerFile<CMilesAudioBank>();
 
@@ -282,25 +379,27 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 	}
 
 	exportPath.append(asrcPath.filename().string());
-	exportPath.replace_extension("wav");
+	exportPath.replace_extension(setting == eAudioSourceExportSetting::ASRC_FLAC ? "flac" : "wav");
 
 	MilesSource_t* source = reinterpret_cast<MilesSource_t*>(audioAsset->GetAssetData());
 
-	// get the bank's path and replace the filename
-	// with the stream file name that we've just put together
-	std::filesystem::path streamPath(audioBank->GetFilePath());
-	streamPath.replace_filename(audioAsset->GetContainerFileName());
-
-	// Data Reading
-	StreamIO streamFile(streamPath, eStreamIOMode::Read);
-
-	MilesStreamHeader_t streamFileHeader = streamFile.read<MilesStreamHeader_t>();
+	// Data Reading, the stream file is shared with every other source in it
+	const CMappedFile* const streamFile = audioBank->GetStreamFileForSource(source);
+	if (!streamFile)
+	{
+		LOG_ERROR(AUDIO, "MILES: Failed to open stream file \"%s\".\n", audioAsset->GetContainerFileName().c_str());
+		return false;
+	}
 
-	streamFile.seek(source->streamHeaderOffset);
+	const MilesStreamHeader_t* const streamFileHeader = reinterpret_cast<const MilesStreamHeader_t*>(streamFile->Data());
 
-	char* sourceStreamHeaderData = new char[source->streamHeaderSize];
+	if (source->streamHeaderOffset + source->streamHeaderSize > streamFile->Size())
+	{
+		LOG_WARN(AUDIO, "MILES: Source header is outside of stream file \"%s\".\n", audioAsset->GetContainerFileName().c_str());
+		return false;
+	}
 
-	streamFile.read(sourceStreamHeaderData, source->streamHeaderSize);
+	const char* const sourceStreamHeaderData = streamFile->Data() + source->streamHeaderOffset;
 
 	std::vector<char> decodedAudioData;
 
@@ -323,7 +422,7 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 
 	if (!decoder)
 	{
-		Log("MILES: Unsupported audio format.\n");
+		LOG_WARN(AUDIO, "MILES: Unsupported audio format.\n");
 		return false;
 	}
 
@@ -343,17 +442,17 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 	uint16_t channels;
 	uint32_t sampleRate;
 	uint32_t samplesCount;
-	ASI_stream_parse_metadata(sourceStreamHeaderData, source->streamHeaderSize, &channels, &sampleRate, &samplesCount, (int*)&parsedMetadata, nullptr);
-
-	streamFile.seek(source->streamHeaderOffset);
+	ASI_stream_parse_metadata(const_cast<char*>(sourceStreamHeaderData), source->streamHeaderSize, &channels, &sampleRate, &samplesCount, (int*)&parsedMetadata, nullptr);
 
 	std::vector<char> container(parsedMetadata.minSizeToOpenStream, 0);
 
 	MilesASIUserData_t userData = {
-		&streamFile,
+		streamFile->Data(),
+		streamFile->Size(),
+		source->streamHeaderOffset,
 		0,
 		source->streamHeaderSize,
-		streamFileHeader.streamDataOffset + source->streamDataOffset
+		streamFileHeader->streamDataOffset + source->streamDataOffset
 	};
 
 	size_t containerSize = container.size();
@@ -419,7 +518,7 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 
 			if (decodeBytesConsumed == 0)
 			{
-				printf("Finished decoding.\n");
+				LOG_DEBUG(AUDIO, "Finished decoding.\n");
 				//break;
 			}
 
@@ -469,41 +568,29 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 		}
 		else
 		{
-			//printf("Received blockSize = 0xFFFF after %lld decoded samples\n", totalFramesDecoded);
+			//LOG_DEBUG(AUDIO, "Received blockSize = 0xFFFF after %lld decoded samples\n", totalFramesDecoded);
 			break;
 		}
 
 	}
 
-	StreamIO outFile(exportPath, eStreamIOMode::Write);
-
-	WAVEHEADER hdr;
-
-
-	outFile.write(hdr);
-	outFile.write(reinterpret_cast<char*>(interleavedBuffer.data()), interleavedBuffer.size() * sizeof(float));
-
-	const uint64_t DataSize = interleavedBuffer.size() * sizeof(float);
-	hdr.size = static_cast<long>(DataSize + 36);
-
-	hdr.fmt.channels = channels;
-	hdr.fmt.sampleRate = sampleRate;
-	hdr.fmt.blockAlign = static_cast<uint16_t>(DataSize / samplesCount);
-	hdr.fmt.bitsPerSample = static_cast<uint16_t>(((DataSize * 8) / samplesCount) / channels);
-
-	hdr.data.chunkSize = static_cast<long>(DataSize);
-
-	hdr.fmt.avgBytesPerSecond = hdr.fmt.blockAlign * sampleRate;
-
-	outFile.seek(0);
-	outFile.write(hdr);
-	outFile.close();
+	switch (setting)
+	{
+	case eAudioSourceExportSetting::ASRC_WAV:
+		return ExportAudioSourceAsWav(exportPath, interleavedBuffer, channels, sampleRate, samplesCount);
+	case eAudioSourceExportSetting::ASRC_FLAC:
+		return ExportAudioSourceAsFlac(exportPath, interleavedBuffer, channels, sampleRate, samplesCount);
+	default:
+		assertm(false, "Export setting is not handled.");
+		return false;
+	}
 
-	return true;
+	unreachable();
 }
 
 void InitAudioSourceAssetType()
 {
+	static const char* settings[] = { "WAV", "FLAC" };
 	AssetTypeBinding_t type =
 	{
 		.type = 'crsa',
@@ -511,7 +598,7 @@ void InitAudioSourceAssetType()
 		.loadFunc = nullptr,
 		.postLoadFunc = nullptr,
 		.previewFunc = nullptr,
-		.e = { ExportAudioSourceAsset, 0, nullptr, 0ull },
+		.e = { ExportAudioSourceAsset, 0, settings, ARRSIZE(settings) },
 	};
 
 	REGISTER_TYPE(type);
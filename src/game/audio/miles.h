@@ -13,7 +13,9 @@ union OffsetPtr_t
 
 struct MilesASIUserData_t
 {
-	StreamIO* streamReader;
+	const char* streamData; // mapped stream file
+	uint64_t streamSize;
+	uint64_t streamPos;
 	uint64_t dataRead;
 	uint64_t headerSize;
 	uint64_t audioStreamOffset;
@@ -287,6 +289,8 @@ public:
 	const bool ParseFile(const std::string& path);
 
 	const std::string& GetFilePath() const { return m_filePath; }
+	std::string GetContainerFileName() const { return std::filesystem::path(m_filePath).filename().string(); }
+	std::filesystem::path GetContainerFilePath() const { return m_filePath; }
 
 	// the base name for the bank is always at the start of the string table
 	const char* GetBankStem() const { return stringTable; };
@@ -301,6 +305,10 @@ public:
 	}
 
 	bool IsValidSource(const MilesSource_t* source) const;
+
+	// stream files are mapped once per (language, patch) and shared by every source exported from them
+	// returns nullptr if the stream file for this source can't be opened
+	const CMappedFile* const GetStreamFileForSource(const MilesSource_t* source);
 private:
 
 	void DiscoverStreamingFiles();
@@ -312,6 +320,10 @@ private:
 	std::map<uint16_t, uint32_t> m_localisedStreamStates;
 	uint32_t m_streamStates;
 
+	// open stream files, keyed by language index in the high and patch index in the low 16 bits
+	std::map<uint32_t, std::unique_ptr<CMappedFile>> m_streamFiles;
+	std::mutex m_streamFileMutex;
+
 	std::string m_filePath;
 
 	std::shared_ptr<char[]> m_fileBuf;
@@ -372,13 +384,13 @@ class CMilesAudioAsset : public CAsset
 public:
 	CMilesAudioAsset(const std::string& assetName, void* assetData, CMilesAudioBank* bank)
 	{
+		SetContainerFile(bank);
 		SetAssetName(assetName);
 		m_assetGuid = 0;
 		
 		SetAssetVersion({});
 
 		SetInternalAssetData(assetData);
-		SetContainerFile(bank);
 	}
 
 	~CMilesAudioAsset()
@@ -124,6 +124,8 @@ public:
     void SetFileName(const char* fileName) { strncpy_s(m_fileName, 64, fileName, strnlen_s(fileName, 64)); }
     void SetFilePath(const std::filesystem::path& path) { m_filePath = path; }
     const char* const GetFileName() const { return m_fileName; }
+    std::string GetContainerFileName() const { return m_fileName; }
+    std::filesystem::path GetContainerFilePath() const { return m_filePath; }
     const std::filesystem::path& GetFilePath() const { return m_filePath; }
 
     inline const int Version() const { return m_version; }
@@ -211,7 +213,7 @@ public:
 
         m_unk_8 = file->unk_8;
         //if (m_unk_8)
-        //    Log("bpkfile unk_8 %lx\n", m_unk_8);
+        //    LOG_DEBUG(PAK, "bpkfile unk_8 %lx\n", m_unk_8);
     }
 
     inline const int GetCompSize() const { return m_dataSizeCompressed; }
@@ -5,9 +5,10 @@
 #include <core/render/dx.h>
 #include <game/rtech/assets/material.h>
 #include <game/rtech/assets/texture.h>
+#include <game/rtech/assets/wrap.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
 
 extern CDXParentHandler* g_dxHandler;
-extern std::unique_ptr<char[]> GetWrapAssetData(CAsset* const asset, uint64_t* outSize);
 
 void GetShadersForVertexLump(int vertexType, CShader** vertexShaderOut, CShader** pixelShaderOut)
 {
@@ -293,6 +294,15 @@ void CBSPData::PopulateFromPakAsset(CPakAsset* pakAsset, void* bspData)
 	// the lumps are in separate wrap assets
 	if (header->flags & 1)
 	{
+		struct LumpFetch_t
+		{
+			uint8_t lumpId;
+			CAsset* asset;
+			WrapAssetDataView_t data;
+		};
+
+		std::vector<LumpFetch_t> lumps;
+
 		for (uint8_t i = 0; i < header->lastLump; ++i)
 		{
 			if (header->lumps[i].filelen != 0)
@@ -304,10 +314,47 @@ void CBSPData::PopulateFromPakAsset(CPakAsset* pakAsset, void* bspData)
 				CAsset* lumpAsset = g_assetData.FindAssetByGUID(lumpAssetGuid);
 
 				if (lumpAsset)
-					SetLumpData(i, GetWrapAssetData(lumpAsset, nullptr));
+					lumps.push_back({ i, lumpAsset, {} });
 				else
-					printf("no asset %s?\n", lumpAssetName.c_str());
+					LOG_WARN(MAP, "no asset %s?\n", lumpAssetName.c_str());
+			}
+		}
+
+		// lumps are spread over starpaks and mostly compressed, fetch them all at once
+		const uint32_t lumpCount = static_cast<uint32_t>(lumps.size());
+		const uint32_t threadCount = std::clamp(UtilsConfig->parseThreadCount, 1u, std::max(lumpCount, 1u));
+
+		CParallelTask parallelLumpTask(threadCount);
+
+		std::atomic<uint32_t> lumpIdx = 0;
+		parallelLumpTask.addTask([&lumps, lumpCount, &lumpIdx]
+		{
+			while (lumpIdx < lumpCount)
+			{
+				const uint32_t lumpToProcess = lumpIdx++;
+				if (lumpToProcess >= lumpCount)
+					continue;
+
+				WrapAssetDataView_t& view = lumps[lumpToProcess].data;
+				if (!GetWrapAssetDataView(lumps[lumpToProcess].asset, view) || view.owned)
+					continue;
+
+				// uncompressed lumps point into pak memory, the bsp data can outlive the lump paks so they are copied
+				std::shared_ptr<char[]> copy(new char[view.size]);
+				std::memcpy(copy.get(), view.data, view.size);
+
+				view.owned = std::move(copy);
+				view.data = view.owned.get();
 			}
+		}, threadCount);
+
+		parallelLumpTask.execute();
+		parallelLumpTask.wait();
+
+		for (LumpFetch_t& lump : lumps)
+		{
+			if (lump.data.owned)
+				SetLumpData(lump.lumpId, std::move(lump.data.owned));
 		}
 	}
 
@@ -102,7 +102,7 @@ public:
 	{
 		if (!m_lumpData.contains(static_cast<uint8_t>(lumpId)))
 		{
-			Log("WARNING: BSP for map \"%s\" attempted to use lump %04x but no such data exists.\n", m_mapName.c_str(), lumpId);
+			LOG_WARN(MAP, "WARNING: BSP for map \"%s\" attempted to use lump %04x but no such data exists.\n", m_mapName.c_str(), lumpId);
 			
 			return nullptr;
 		}
@@ -114,7 +114,7 @@ public:
 	{
 		if (!m_lumpSizes.contains(static_cast<uint8_t>(lumpId)))
 		{
-			//Log("WARNING: BSP for map \"%s\" attempted to get size for lump %04x but no such lump exists.\n", m_mapName.c_str(), lumpId);
+			//LOG_DEBUG(MAP, "WARNING: BSP for map \"%s\" attempted to get size for lump %04x but no such lump exists.\n", m_mapName.c_str(), lumpId);
 
 			return 0;
 		}
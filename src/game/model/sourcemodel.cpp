@@ -382,11 +382,7 @@ void LoadSourceModelAsset(CAssetContainer* container, CAsset* asset)
     {
         r1::studiohdr_t* const pStudioHdr = reinterpret_cast<r1::studiohdr_t* const>(srcMdlAsset->GetAssetData());
 
-        CManagedBuffer* buffer = g_BufferManager.ClaimBuffer();
-
-        looseData = new StudioLooseData_t(srcMdlSource->GetFilePath(), pStudioHdr->pszName(), buffer->Buffer());
-
-        g_BufferManager.RelieveBuffer(buffer);
+        looseData = new StudioLooseData_t(srcMdlSource->GetFilePath(), pStudioHdr->pszName());
 
         // these are now managed by the asset
         srcMdlAsset->SetExtraData(looseData->VertBuf(), CSourceModelAsset::SRCMDL_VERT);
@@ -569,6 +565,14 @@ bool ExportSourceModelAsset(CAsset* const asset, const int setting)
     unreachable();
 }
 
+static void ReleaseRefsSourceModelAsset(CAsset* const asset)
+{
+    CSourceModelAsset* const srcMdlAsset = static_cast<CSourceModelAsset* const>(asset);
+
+    if (srcMdlAsset->GetParsedData())
+        ReleaseModelMaterialRefs(srcMdlAsset->GetParsedData());
+}
+
 void InitSourceModelAssetType()
 {
     AssetTypeBinding_t type =
@@ -579,6 +583,7 @@ void InitSourceModelAssetType()
         .postLoadFunc = PostLoadSourceModelAsset,
         .previewFunc = PreviewSourceModelAsset,
         .e = { ExportSourceModelAsset, 0, nullptr, 0ull },
+        .releaseRefsFunc = ReleaseRefsSourceModelAsset,
     };
 
     REGISTER_TYPE(type);
@@ -722,7 +727,10 @@ bool ExportSourceSequenceAsset(CAsset* const asset, const int setting)
 
     std::filesystem::path exportPathCop = exportPath;
 
-    return ExportSeqDesc(settingFixup, srcSeqAsset->GetSequence(), exportPath, srcMdlAsset->GetAssetName().c_str(), bones, asset->GetAssetGUID());
+    const SeqExportSkeleton_t skeleton(bones);
+    SeqExportScratch_t scratch;
+
+    return ExportSeqDesc(settingFixup, srcSeqAsset->GetSequence(), exportPath, skeleton, scratch, asset->GetAssetGUID());
 }
 
 void InitSourceSequenceAssetType()
@@ -4,7 +4,7 @@
 class CSourceModelSource : public CAssetContainer
 {
 public:
-    CSourceModelSource() {};
+    CSourceModelSource() : m_fileName("") {};
     ~CSourceModelSource() = default;
 
     const CAsset::ContainerType GetContainerType() const
@@ -15,6 +15,8 @@ public:
     void SetFileName(const char* fileName) { m_fileName = fileName; }
 	void SetFilePath(const std::filesystem::path& path) { m_filePath = path; }
     const char* const GetFileName() const { return m_fileName; }
+    std::string GetContainerFileName() const { return m_fileName; }
+    std::filesystem::path GetContainerFilePath() const { return m_filePath; }
 	const std::filesystem::path& GetFilePath() const { return m_filePath; }
 
 private:
@@ -101,14 +103,16 @@ public:
 
 private:
 	uint64_t m_assetGuid;
-	char* m_assetDataExtra[ExtraData::SRCMDL_COUNT];
+
+	// filled by the load function, empty until then so an asset that never loaded can still be deleted
+	char* m_assetDataExtra[ExtraData::SRCMDL_COUNT] = {};
 
 	ModelParsedData_t* m_modelParsed;
-	StudioLooseData_t* m_modelLoose;
-	char* m_modelName;
+	StudioLooseData_t* m_modelLoose = nullptr;
+	char* m_modelName = nullptr;
 
-	char** m_modelSkinNames;
-	int m_numModelSkinNames;
+	char** m_modelSkinNames = nullptr;
+	int m_numModelSkinNames = 0;
 
 	int m_numSequences;
 	uint64_t* m_sequences;
@@ -162,10 +166,10 @@ private:
 	const void* m_assetSequenceData;
 
 	uint64_t m_assetGuid;
-	seqdesc_t* m_sequence;
+	seqdesc_t* m_sequence = nullptr;
 	bool m_animationParsed;
 
-	const std::vector<ModelBone_t>* m_rig;
+	const std::vector<ModelBone_t>* m_rig = nullptr;
 	uint64_t m_rigGuid;
 
 	void SetUnparsed() { m_animationParsed = false; }
@@ -232,14 +232,18 @@ bool ExportAnimRigAsset(CAsset* const asset, const int setting)
         auto aseqAssetBinding = g_assetData.m_assetTypeBindings.find('qesa');
         assertm(aseqAssetBinding != g_assetData.m_assetTypeBindings.end(), "Unable to find asset type binding for \"aseq\" assets");
 
-        for (int i = 0; i < parsedData->NumLocalSeq(); i++)
+        const int seqSetting = aseqAssetBinding->second.e.exportSetting;
+        const SeqExportSkeleton_t skeleton(animRigAsset->GetRig());
+
+        ExportSequencesParallel(static_cast<uint32_t>(parsedData->NumLocalSeq()), [parsedData, &outputPath, seqSetting, &skeleton](const uint32_t seqIdx, SeqExportScratch_t& scratch)
         {
-            const seqdesc_t* const seqdesc = parsedData->LocalSeq(i);
+            const seqdesc_t* const seqdesc = parsedData->LocalSeq(static_cast<int>(seqIdx));
 
-            outputPath.replace_filename(seqdesc->szlabel);
+            std::filesystem::path seqPath(outputPath);
+            seqPath.replace_filename(seqdesc->szlabel);
 
-            ExportSeqDesc(aseqAssetBinding->second.e.exportSetting, seqdesc, outputPath, animRigAsset->name, animRigAsset->GetRig(), RTech::StringToGuid(seqdesc->szlabel));
-        }
+            ExportSeqDesc(seqSetting, seqdesc, seqPath, skeleton, scratch, RTech::StringToGuid(seqdesc->szlabel));
+        });
     }
 
     // rmax & cast just export the skeleton for now, perhaps in the future we could also export IK?
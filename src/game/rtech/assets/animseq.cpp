@@ -192,7 +192,7 @@ static bool ExportRawAnimSeqAsset(CPakAsset* const asset, const AnimSeqAsset* co
 
 			if (dependencyAsset)
 			{
-				std::string dependencyAssetName = dependencyAsset->GetAssetName();
+				std::string dependencyAssetName(dependencyAsset->GetAssetName());
 				FixSlashes(dependencyAssetName); // Needs to be called because json can't take un-escaped '\'
 
 				out << "\t\t\"" << dependencyAssetName << "\"" << commaChar << "\n";
@@ -211,6 +211,16 @@ static bool ExportRawAnimSeqAsset(CPakAsset* const asset, const AnimSeqAsset* co
 }
 
 bool ExportAnimSeqAsset(CPakAsset* const asset, const int setting, const AnimSeqAsset* const animSeqAsset, const std::filesystem::path& exportPath, const char* const skelName, const std::vector<ModelBone_t>* const bones)
+{
+	UNUSED(skelName);
+
+	const SeqExportSkeleton_t skeleton(bones);
+	SeqExportScratch_t scratch;
+
+	return ExportAnimSeqAsset(asset, setting, animSeqAsset, exportPath, skeleton, scratch);
+}
+
+bool ExportAnimSeqAsset(CPakAsset* const asset, const int setting, const AnimSeqAsset* const animSeqAsset, const std::filesystem::path& exportPath, const SeqExportSkeleton_t& skeleton, SeqExportScratch_t& scratch)
 {
 	std::filesystem::path exportPathCop = exportPath;
 
@@ -223,7 +233,7 @@ bool ExportAnimSeqAsset(CPakAsset* const asset, const int setting, const AnimSeq
 	case eAnimSeqExportSetting::ANIMSEQ_RMAX:
 	case eAnimSeqExportSetting::ANIMSEQ_SMD:
 	{
-		return ExportSeqDesc(setting, &animSeqAsset->seqdesc, exportPathCop, skelName, bones, asset->guid());
+		return ExportSeqDesc(setting, &animSeqAsset->seqdesc, exportPathCop, skeleton, scratch, asset->guid());
 	}
 	//	exporting asset
 	case eAnimSeqExportSetting::ANIMSEQ_RSEQ:
@@ -240,6 +250,8 @@ bool ExportAnimSeqAsset(CPakAsset* const asset, const int setting, const AnimSeq
 
 bool ExportAnimSeqFromAsset(const std::filesystem::path& exportPath, const std::string& stem, const char* const name, const int numAnimSeqs, const AssetGuid_t* const animSeqs, const std::vector<ModelBone_t>* const bones)
 {
+	UNUSED(name);
+
 	auto aseqAssetBinding = g_assetData.m_assetTypeBindings.find('qesa');
 
 	assertm(aseqAssetBinding != g_assetData.m_assetTypeBindings.end(), "Unable to find asset type binding for \"aseq\" assets");
@@ -255,8 +267,10 @@ bool ExportAnimSeqFromAsset(const std::filesystem::path& exportPath, const std::
 			return false;
 		}
 
-		std::atomic<uint32_t> remainingSeqs = 0; // we don't actually need thread safe here
-		const ProgressBarEvent_t* const seqExportProgress = g_pImGuiHandler->AddProgressBarEvent("Exporting Sequences..", static_cast<uint32_t>(numAnimSeqs), &remainingSeqs, true);
+		// resolve every sequence up front, the exports below only read from them
+		std::vector<std::pair<CPakAsset*, const AnimSeqAsset*>> seqsToExport;
+		seqsToExport.reserve(static_cast<size_t>(numAnimSeqs));
+
 		for (int i = 0; i < numAnimSeqs; i++)
 		{
 			const uint64_t guid = animSeqs[i].guid;
@@ -265,7 +279,7 @@ bool ExportAnimSeqFromAsset(const std::filesystem::path& exportPath, const std::
 
 			if (nullptr == animSeq)
 			{
-				Log("RMDL EXPORT: animseq asset 0x%llX was not loaded, skipping...\n", guid);
+				LOG_WARN(MODEL, "RMDL EXPORT: animseq asset 0x%llX was not loaded, skipping...\n", guid);
 
 				continue;
 			}
@@ -276,12 +290,31 @@ bool ExportAnimSeqFromAsset(const std::filesystem::path& exportPath, const std::
 			if (!animSeqAsset->animationParsed)
 				continue;
 
-			outputPath.replace_filename(std::filesystem::path(animSeqAsset->name).filename());
+			seqsToExport.emplace_back(animSeq, animSeqAsset);
+		}
+
+		const int setting = aseqAssetBinding->second.e.exportSetting;
+		const uint32_t numSeqsToExport = static_cast<uint32_t>(seqsToExport.size());
+
+		// the skeleton is the same for every sequence, the threads share it
+		const SeqExportSkeleton_t skeleton(bones);
+
+		std::atomic<uint32_t> remainingSeqs = 0;
+		const ProgressBarEvent_t* const seqExportProgress = g_pImGuiHandler->AddProgressBarEvent("Exporting Sequences..", numSeqsToExport, &remainingSeqs, true);
+
+		ExportSequencesParallel(numSeqsToExport, [&seqsToExport, &outputPath, setting, &skeleton, &remainingSeqs](const uint32_t seqIdx, SeqExportScratch_t& scratch)
+		{
+			CPakAsset* const animSeq = seqsToExport[seqIdx].first;
+			const AnimSeqAsset* const animSeqAsset = seqsToExport[seqIdx].second;
+
+			std::filesystem::path seqPath(outputPath);
+			seqPath.replace_filename(std::filesystem::path(animSeqAsset->name).filename());
 
-			ExportAnimSeqAsset(animSeq, aseqAssetBinding->second.e.exportSetting, animSeqAsset, outputPath, name, bones);
+			ExportAnimSeqAsset(animSeq, setting, animSeqAsset, seqPath, skeleton, scratch);
 
 			++remainingSeqs;
-		}
+		});
+
 		g_pImGuiHandler->FinishProgressBarEvent(seqExportProgress);
 	}
 
@@ -351,6 +384,26 @@ bool ExportAnimSeqAsset(CAsset* const asset, const int setting)
 	return ExportAnimSeqAsset(pakAsset, setting, animSeqAsset, exportPath, skeletonName, bones);
 }
 
+static void ReleaseRefsAnimSeqAsset(CAsset* const asset)
+{
+	CPakAsset* const pakAsset = static_cast<CPakAsset*>(asset);
+
+	AnimSeqAsset* const seqAsset = reinterpret_cast<AnimSeqAsset*>(pakAsset->extraData());
+	if (!seqAsset)
+		return;
+
+	if (g_assetData.IsUnloading(seqAsset->parentModel))
+		seqAsset->parentModel = nullptr;
+
+	if (g_assetData.IsUnloading(seqAsset->parentRig))
+		seqAsset->parentRig = nullptr;
+
+	// parsed animation data is only exportable against the skeleton it was parsed with
+	// the asqd pointers in the seqdesc are only read while parsing, so they are left alone
+	if (!seqAsset->parentModel && !seqAsset->parentRig)
+		seqAsset->animationParsed = false;
+}
+
 void InitAnimSeqAssetType()
 {
 	AssetTypeBinding_t type =
@@ -361,6 +414,7 @@ void InitAnimSeqAssetType()
 		.postLoadFunc = PostLoadAnimSeqAsset,
 		.previewFunc = PreviewAnimSeqAsset,
 		.e = { ExportAnimSeqAsset, 0, s_AnimSeqExportSettingNames, ARRSIZE(s_AnimSeqExportSettingNames) },
+		.releaseRefsFunc = ReleaseRefsAnimSeqAsset,
 	};
 
 	REGISTER_TYPE(type);
@@ -1,5 +1,6 @@
 #include <pch.h>
 #include <game/rtech/assets/datatable.h>
+#include <core/ui/previewtable.h>
 #include <thirdparty/imgui/imgui.h>
 
 void LoadDatatableAsset(CAssetContainer* const pak, CAsset* const asset)
@@ -36,109 +37,109 @@ void LoadDatatableAsset(CAssetContainer* const pak, CAsset* const asset)
 
 void* PreviewDatatableAsset(CAsset* const asset, const bool firstFrameForAsset)
 {
-    UNUSED(firstFrameForAsset);
-
     CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
 
     const DatatableAsset* const dtblAsset = reinterpret_cast<DatatableAsset*>(pakAsset->extraData());
     assertm(dtblAsset, "Extra data should be valid at this point.");
 
-    ImGui::TextUnformatted(std::format("Datatable: {} (0x{:X})", nullptr != dtblAsset->name ? dtblAsset->name : "null name", asset->GetAssetGUID()).c_str());
-    ImGui::Text("Columns: %i Rows: %i", dtblAsset->numColumns, dtblAsset->numRows);
+    static CPreviewTable previewTable;
 
-    constexpr ImGuiTableFlags tableFlags =
-        ImGuiTableFlags_Resizable  | ImGuiTableFlags_Hideable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders
-        | ImGuiTableFlags_ScrollY | ImGuiTableFlags_ScrollX | ImGuiTableFlags_SizingFixedFit;
+    if (firstFrameForAsset)
+    {
+        PROFILE_SCOPE("datatable preview build");
 
-    const ImVec2 outerSize = ImVec2(0.f, 0.f);
+        previewTable.Reset(dtblAsset->numRows);
 
-    if (ImGui::BeginTable("Datatable", dtblAsset->numColumns, tableFlags, outerSize))
-    {
         for (int i = 0; i < dtblAsset->numColumns; i++)
         {
-            ImGui::TableSetupColumn(dtblAsset->GetColumn(i)->name, ImGuiTableColumnFlags_NoResize | ImGuiTableColumnFlags_WidthFixed, 0.0f, i);
-        }
-        ImGui::TableSetupScrollFreeze(0, 1);
+            const DatatableAssetColumn* const column = dtblAsset->GetColumn(i);
 
-        ImGui::TableHeadersRow();
+            switch (column->type)
+            {
+            case DatatableColumType_t::Bool:
+            case DatatableColumType_t::Int:
+            case DatatableColumType_t::Float:
+                previewTable.AddColumn(column->name, ePreviewColumnSort::NUMBER);
+                break;
+            default:
+                previewTable.AddColumn(column->name, ePreviewColumnSort::TEXT);
+                break;
+            }
+        }
 
         for (int i = 0; i < dtblAsset->numRows; i++)
         {
-            ImGui::PushID(i); // id of this line ?
-
-            ImGui::TableNextRow(ImGuiTableRowFlags_None, 0.0f);
-
             const char* const row = dtblAsset->GetRowPtr(i);
 
             for (int j = 0; j < dtblAsset->numColumns; j++)
             {
-                if (ImGui::TableSetColumnIndex(j))
+                const DatatableAssetColumn* const column = dtblAsset->GetColumn(j);
+
+                switch (column->type)
+                {
+                case DatatableColumType_t::Bool:
                 {
-                    const DatatableAssetColumn* const column = dtblAsset->GetColumn(j);
+                    const bool& data = *reinterpret_cast<const bool* const>(row + column->rowOffset);
+                    previewTable.AddCell(data ? "true" : "false", data ? 1.0 : 0.0);
 
-                    switch (column->type)
-                    {
-                    case DatatableColumType_t::Bool:
-                    {
-                        const bool& data = *reinterpret_cast<const bool* const>(row + column->rowOffset);
-                        ImGui::TextUnformatted(data ? "true" : "false");
+                    break;
+                }
+                case DatatableColumType_t::Int:
+                {
+                    const int& data = *reinterpret_cast<const int* const>(row + column->rowOffset);
+                    previewTable.AddCellFormat(static_cast<double>(data), "{}", data);
 
-                        break;
-                    }
-                    case DatatableColumType_t::Int:
-                    {
-                        const int& data = *reinterpret_cast<const int* const>(row + column->rowOffset);
-                        ImGui::Text("%i", data);
+                    break;
+                }
+                case DatatableColumType_t::Float:
+                {
+                    const float& data = *reinterpret_cast<const float* const>(row + column->rowOffset);
+                    previewTable.AddCellFormat(static_cast<double>(data), "{:f}", data);
 
-                        break;
-                    }
-                    case DatatableColumType_t::Float:
-                    {
-                        const float& data = *reinterpret_cast<const float* const>(row + column->rowOffset);
-                        ImGui::Text("%f", data);
+                    break;
+                }
+                case DatatableColumType_t::Vector:
+                {
+                    const Vector* const data = reinterpret_cast<const Vector* const>(row + column->rowOffset);
+                    previewTable.AddCellFormat(0.0, "{:f}, {:f}, {:f}", data->x, data->y, data->z);
 
-                        break;
-                    }
-                    case DatatableColumType_t::Vector:
+                    break;
+                }
+                case DatatableColumType_t::String:
+                case DatatableColumType_t::Asset:
+                case DatatableColumType_t::AssetNoPrecache:
+                {
+                    const char* const data = *reinterpret_cast<const char* const* const>(row + column->rowOffset);
+
+                    // catch excluded data
+                    if (data[0] == 0xf)
                     {
-                        const Vector* const data = reinterpret_cast<const Vector* const>(row + column->rowOffset);
-                        ImGui::Text("%f, %f, %f", data->x, data->y, data->z);
+                        previewTable.AddCell("!!DATA EXCLUDED!!");
 
                         break;
                     }
-                    case DatatableColumType_t::String:
-                    case DatatableColumType_t::Asset:
-                    case DatatableColumType_t::AssetNoPrecache:
-                    {
-                        const char* const data = *reinterpret_cast<const char* const* const>(row + column->rowOffset);
-
-                        // catch excluded data
-                        if (data[0] == 0xf)
-                        {
-                            ImGui::TextUnformatted("!!DATA EXCLUDED!!");
 
-                            break;
-                        }
+                    previewTable.AddCell(data);
 
-                        ImGui::TextUnformatted(data);    
+                    break;
+                }
+                default:
+                {
+                    assertm(false, "invalid datatable type");
+                    previewTable.AddCell("");
 
-                        break;
-                    }
-                    default:
-                    {
-                        assertm(false, "invalid datatable type");
-                        break;
-                    }
-                    }
+                    break;
+                }
                 }
             }
-
-            ImGui::PopID(); // no longer working on this id
         }
-
-        ImGui::EndTable();
     }
 
+    ImGui::TextUnformatted(std::format("Datatable: {} (0x{:X})", nullptr != dtblAsset->name ? dtblAsset->name : "null name", asset->GetAssetGUID()).c_str());
+    ImGui::Text("Columns: %i Rows: %i", dtblAsset->numColumns, dtblAsset->numRows);
+
+    previewTable.Draw("Datatable", ImVec2(0.f, 0.f));
+
     return nullptr;
 }
 
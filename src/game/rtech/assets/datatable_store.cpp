@@ -0,0 +1,915 @@
+#include <pch.h>
+#include <game/rtech/assets/datatable_store.h>
+#include <core/ui/previewtable.h>
+#include <thirdparty/imgui/imgui.h>
+#include <thirdparty/imgui/imgui_internal.h>
+
+#include <charconv>
+#include <numeric>
+
+CDatatableStore g_datatableStore;
+
+static std::string ToLowerString(const std::string_view str)
+{
+    std::string out(str);
+    std::transform(out.begin(), out.end(), out.begin(), [](const unsigned char c) { return static_cast<char>(tolower(c)); });
+
+    return out;
+}
+
+//
+// QUERY PARSING
+//
+static void SkipQuerySpaces(const std::string_view expr, size_t& pos)
+{
+    while (pos < expr.length() && isspace(static_cast<unsigned char>(expr[pos])))
+        pos++;
+}
+
+static const bool IsQueryOpChar(const char c)
+{
+    return c == '=' || c == '!' || c == '<' || c == '>' || c == '~';
+}
+
+// quoted, or everything up to a space (or an operator, for column names)
+static const bool ParseQueryToken(const std::string_view expr, size_t& pos, std::string& token, const bool stopAtOp)
+{
+    token.clear();
+
+    if (pos >= expr.length())
+        return false;
+
+    if (expr[pos] == '"')
+    {
+        const size_t end = expr.find('"', pos + 1);
+        if (end == std::string_view::npos)
+            return false;
+
+        token = expr.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+
+        return true;
+    }
+
+    const size_t start = pos;
+    while (pos < expr.length() && !isspace(static_cast<unsigned char>(expr[pos])) && !(stopAtOp && IsQueryOpChar(expr[pos])))
+    {
+        // "a&&b" without spaces
+        if (expr[pos] == '&' && pos + 1 < expr.length() && expr[pos + 1] == '&')
+            break;
+
+        pos++;
+    }
+
+    token = expr.substr(start, pos - start);
+
+    return !token.empty();
+}
+
+static const bool ParseQueryOp(const std::string_view expr, size_t& pos, eDatatableQueryOp& op)
+{
+    // longest first
+    static const std::pair<const char*, eDatatableQueryOp> s_ops[] =
+    {
+        { "==", eDatatableQueryOp::EQ },
+        { "!=", eDatatableQueryOp::NE },
+        { "<=", eDatatableQueryOp::LE },
+        { ">=", eDatatableQueryOp::GE },
+        { "=", eDatatableQueryOp::EQ },
+        { "<", eDatatableQueryOp::LT },
+        { ">", eDatatableQueryOp::GT },
+        { "~", eDatatableQueryOp::CONTAINS },
+    };
+
+    for (const auto& it : s_ops)
+    {
+        const size_t length = strlen(it.first);
+
+        if (expr.substr(pos, length) == it.first)
+        {
+            op = it.second;
+            pos += length;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const bool DatatableQuery_t::Parse(const std::string_view expr, DatatableQuery_t& query, std::string& error)
+{
+    query.where.clear();
+
+    size_t pos = 0ull;
+    SkipQuerySpaces(expr, pos);
+
+    // empty matches every row
+    while (pos < expr.length())
+    {
+        DatatableQueryPredicate_t predicate;
+
+        if (!ParseQueryToken(expr, pos, predicate.column, true))
+        {
+            error = std::format("expected a column name at {}", pos);
+            return false;
+        }
+
+        SkipQuerySpaces(expr, pos);
+
+        if (!ParseQueryOp(expr, pos, predicate.op))
+        {
+            error = std::format("expected an operator after '{}' at {}", predicate.column, pos);
+            return false;
+        }
+
+        SkipQuerySpaces(expr, pos);
+
+        if (!ParseQueryToken(expr, pos, predicate.value, false))
+        {
+            error = std::format("expected a value after '{}' at {}", predicate.column, pos);
+            return false;
+        }
+
+        query.where.push_back(std::move(predicate));
+
+        SkipQuerySpaces(expr, pos);
+
+        if (pos >= expr.length())
+            break;
+
+        if (expr.substr(pos, 2) == "&&")
+            pos += 2;
+        else if (pos + 3 < expr.length() && ToLowerString(expr.substr(pos, 3)) == "and" && isspace(static_cast<unsigned char>(expr[pos + 3])))
+            pos += 3;
+        else
+        {
+            error = std::format("expected '&&' or 'and' at {}", pos);
+            return false;
+        }
+
+        SkipQuerySpaces(expr, pos);
+    }
+
+    return true;
+}
+
+//
+// STORE
+//
+void CDatatableStore::Clear()
+{
+    m_interner.reset();
+    m_strings.clear();
+    m_stringIds.clear();
+
+    m_columns.clear();
+    m_columnsByKey.clear();
+    m_tables.clear();
+
+    m_numRows = 0u;
+
+    m_builtAssetCount = 0ull;
+    m_builtContainerCount = 0ull;
+    m_builtUnloadGeneration = 0ull;
+}
+
+const bool CDatatableStore::IsStale() const
+{
+    // an unload followed by a load can leave both counts where they were, the generation still moves
+    return m_builtUnloadGeneration != g_assetData.m_unloadGeneration || m_builtAssetCount != g_assetData.v_assets.size() || m_builtContainerCount != g_assetData.v_assetContainers.size();
+}
+
+const size_t CDatatableStore::MemoryUsage() const
+{
+    size_t size = m_interner ? m_interner->MemoryUsage() : 0ull;
+
+    size += m_strings.capacity() * sizeof(std::string_view);
+
+    for (const Column_t& column : m_columns)
+    {
+        size += (column.rows.capacity() + column.strings.capacity() + column.sorted.capacity()) * sizeof(uint32_t);
+        size += column.ints.capacity() * sizeof(int32_t);
+        size += column.floats.capacity() * sizeof(float);
+        size += column.vectors.capacity() * sizeof(Vector);
+    }
+
+    for (const Table_t& table : m_tables)
+        size += table.columns.capacity() * sizeof(TableColumn_t);
+
+    return size;
+}
+
+const uint32_t CDatatableStore::InternString(const std::string_view str)
+{
+    const auto it = m_stringIds.find(str);
+    if (it != m_stringIds.end())
+        return it->second;
+
+    const std::string_view interned = m_interner->Intern(str);
+    const uint32_t id = static_cast<uint32_t>(m_strings.size());
+
+    m_strings.push_back(interned);
+    m_stringIds.emplace(interned, id);
+
+    return id;
+}
+
+void CDatatableStore::IngestTable(const uint64_t guid, const DatatableAsset* const dtblAsset, std::unordered_map<std::string, uint32_t>& columnIds)
+{
+    Table_t& table = m_tables.emplace_back();
+    table.guid = guid;
+    table.name = m_strings[InternString(dtblAsset->name ? dtblAsset->name : "")];
+    table.firstRow = m_numRows;
+    table.numRows = static_cast<uint32_t>(dtblAsset->numRows);
+    table.columns.reserve(dtblAsset->numColumns);
+
+    for (int i = 0; i < dtblAsset->numColumns; i++)
+    {
+        const DatatableAssetColumn* const dtblColumn = dtblAsset->GetColumn(i);
+
+        // left out of the table altogether, a table's rows are found in each of its columns by offset so every column needs a value for every row
+        if (dtblColumn->type < DatatableColumType_t::Bool || dtblColumn->type >= DatatableColumType_t::_COUNT)
+        {
+            assertm(false, "invalid datatable type");
+            continue;
+        }
+
+        // columns are merged by name and type
+        std::string key = ToLowerString(dtblColumn->name ? dtblColumn->name : "");
+        const std::string typedKey = std::format("{}:{}", key, static_cast<int>(dtblColumn->type));
+
+        auto it = columnIds.find(typedKey);
+        if (it == columnIds.end())
+        {
+            const uint32_t id = static_cast<uint32_t>(m_columns.size());
+
+            Column_t& column = m_columns.emplace_back();
+            column.name = m_strings[InternString(dtblColumn->name ? dtblColumn->name : "")];
+            column.type = dtblColumn->type;
+            column.key = key;
+
+            m_columnsByKey[std::move(key)].push_back(id);
+            it = columnIds.emplace(typedKey, id).first;
+        }
+
+        Column_t& column = m_columns[it->second];
+        table.columns.push_back({ it->second, static_cast<uint32_t>(column.rows.size()) });
+
+        for (int j = 0; j < dtblAsset->numRows; j++)
+        {
+            const char* const data = dtblAsset->GetRowPtr(j) + dtblColumn->rowOffset;
+
+            column.rows.push_back(table.firstRow + static_cast<uint32_t>(j));
+
+            switch (dtblColumn->type)
+            {
+            case DatatableColumType_t::Bool:
+                column.ints.push_back(*reinterpret_cast<const bool* const>(data) ? 1 : 0);
+                break;
+            case DatatableColumType_t::Int:
+                column.ints.push_back(*reinterpret_cast<const int* const>(data));
+                break;
+            case DatatableColumType_t::Float:
+                column.floats.push_back(*reinterpret_cast<const float* const>(data));
+                break;
+            case DatatableColumType_t::Vector:
+                column.vectors.push_back(*reinterpret_cast<const Vector* const>(data));
+                break;
+            case DatatableColumType_t::String:
+            case DatatableColumType_t::Asset:
+            case DatatableColumType_t::AssetNoPrecache:
+            {
+                const char* const str = *reinterpret_cast<const char* const* const>(data);
+
+                // catch excluded data
+                column.strings.push_back(InternString(str[0] == 0xf ? "!!DATA EXCLUDED!!" : str));
+                break;
+            }
+            default:
+                unreachable(); // checked above
+            }
+        }
+    }
+
+    m_numRows += table.numRows;
+}
+
+const double CDatatableStore::NumberAt(const Column_t& column, const uint32_t value) const
+{
+    return column.type == DatatableColumType_t::Float ? static_cast<double>(column.floats[value]) : static_cast<double>(column.ints[value]);
+}
+
+void CDatatableStore::BuildIndex(Column_t& column) const
+{
+    column.sorted.clear();
+
+    switch (column.type)
+    {
+    case DatatableColumType_t::Bool:
+    case DatatableColumType_t::Int:
+    {
+        column.sorted.resize(column.ints.size());
+        std::iota(column.sorted.begin(), column.sorted.end(), 0u);
+        std::stable_sort(column.sorted.begin(), column.sorted.end(), [&column](const uint32_t a, const uint32_t b) { return column.ints[a] < column.ints[b]; });
+
+        break;
+    }
+    case DatatableColumType_t::Float:
+    {
+        // nan has no order, it can't match a comparison anyway
+        column.sorted.reserve(column.floats.size());
+        for (uint32_t i = 0; i < column.floats.size(); i++)
+        {
+            if (!std::isnan(column.floats[i]))
+                column.sorted.push_back(i);
+        }
+
+        std::stable_sort(column.sorted.begin(), column.sorted.end(), [&column](const uint32_t a, const uint32_t b) { return column.floats[a] < column.floats[b]; });
+
+        break;
+    }
+    case DatatableColumType_t::String:
+    case DatatableColumType_t::Asset:
+    case DatatableColumType_t::AssetNoPrecache:
+    {
+        column.sorted.resize(column.strings.size());
+        std::iota(column.sorted.begin(), column.sorted.end(), 0u);
+        std::stable_sort(column.sorted.begin(), column.sorted.end(), [&column](const uint32_t a, const uint32_t b) { return column.strings[a] < column.strings[b]; });
+
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void CDatatableStore::Build()
+{
+    std::vector<std::pair<uint64_t, const DatatableAsset*>> datatables;
+
+    for (const CGlobalAssetData::AssetLookup_t& lookup : g_assetData.v_assets)
+    {
+        if (lookup.m_asset->GetAssetType() != 'lbtd' || lookup.m_asset->GetAssetContainerType() != CAsset::ContainerType::PAK)
+            continue;
+
+        const DatatableAsset* const dtblAsset = reinterpret_cast<const DatatableAsset*>(static_cast<CPakAsset*>(lookup.m_asset)->extraData());
+        if (!dtblAsset)
+            continue;
+
+        datatables.emplace_back(lookup.m_guid, dtblAsset);
+    }
+
+    BuildFromTables(datatables);
+
+    m_builtAssetCount = g_assetData.v_assets.size();
+    m_builtContainerCount = g_assetData.v_assetContainers.size();
+    m_builtUnloadGeneration = g_assetData.m_unloadGeneration;
+}
+
+void CDatatableStore::BuildFromTables(const std::vector<std::pair<uint64_t, const DatatableAsset*>>& datatables)
+{
+    PROFILE_SCOPE("datatable store build");
+
+    Clear();
+
+    m_interner = std::make_unique<CStringInterner>();
+
+    std::unordered_map<std::string, uint32_t> columnIds;
+
+    for (const auto& [guid, dtblAsset] : datatables)
+        IngestTable(guid, dtblAsset, columnIds);
+
+    // the indexes don't depend on each other
+    const uint32_t columnCount = static_cast<uint32_t>(m_columns.size());
+    const uint32_t threadCount = std::clamp(UtilsConfig->parseThreadCount, 1u, std::max(columnCount, 1u));
+
+    CParallelTask parallelIndexTask(threadCount);
+
+    std::atomic<uint32_t> columnIdx = 0;
+    parallelIndexTask.addTask([this, columnCount, &columnIdx]
+        {
+            while (columnIdx < columnCount)
+            {
+                const uint32_t columnToIndex = columnIdx++;
+                if (columnToIndex >= columnCount)
+                    continue;
+
+                BuildIndex(m_columns[columnToIndex]);
+            }
+        }, threadCount);
+
+    parallelIndexTask.execute();
+    parallelIndexTask.wait();
+}
+
+//
+// QUERY
+//
+struct CDatatableStore::PreparedPredicate_t
+{
+    const DatatableQueryPredicate_t* predicate;
+
+    std::vector<uint32_t> columns; // store columns it applies to, sorted
+
+    bool isNumber;
+    double number;
+
+    bool hasStringId;
+    uint32_t stringId;
+
+    std::vector<bool> containsIds; // by string id, only for a contains predicate matched through the whole store
+
+    size_t estimate; // values that match, or that have to be scanned when there is no index for it
+};
+
+// three way compare result against the query value
+static const bool CompareMatches(const eDatatableQueryOp op, const int compare)
+{
+    switch (op)
+    {
+    case eDatatableQueryOp::EQ: return compare == 0;
+    case eDatatableQueryOp::NE: return compare != 0;
+    case eDatatableQueryOp::LT: return compare < 0;
+    case eDatatableQueryOp::LE: return compare <= 0;
+    case eDatatableQueryOp::GT: return compare > 0;
+    case eDatatableQueryOp::GE: return compare >= 0;
+    default: return false;
+    }
+}
+
+void CDatatableStore::PreparePredicate(const DatatableQueryPredicate_t& predicate, PreparedPredicate_t& prepared) const
+{
+    prepared.predicate = &predicate;
+
+    const char* const valueEnd = predicate.value.data() + predicate.value.length();
+    const std::from_chars_result numberResult = std::from_chars(predicate.value.data(), valueEnd, prepared.number);
+    prepared.isNumber = numberResult.ec == std::errc() && numberResult.ptr == valueEnd;
+
+    const std::string lowerValue = ToLowerString(predicate.value);
+    if (!prepared.isNumber && (lowerValue == "true" || lowerValue == "false"))
+    {
+        prepared.isNumber = true;
+        prepared.number = lowerValue == "true" ? 1.0 : 0.0;
+    }
+
+    const auto stringIt = m_stringIds.find(predicate.value);
+    prepared.hasStringId = stringIt != m_stringIds.end();
+    prepared.stringId = prepared.hasStringId ? stringIt->second : 0u;
+
+    if (predicate.column == "*")
+    {
+        prepared.columns.resize(m_columns.size());
+        std::iota(prepared.columns.begin(), prepared.columns.end(), 0u);
+    }
+    else if (const auto columnIt = m_columnsByKey.find(ToLowerString(predicate.column)); columnIt != m_columnsByKey.end())
+    {
+        prepared.columns = columnIt->second;
+        std::sort(prepared.columns.begin(), prepared.columns.end());
+    }
+
+    prepared.estimate = 0ull;
+    for (const uint32_t column : prepared.columns)
+        prepared.estimate += EstimateColumn(m_columns[column], prepared);
+}
+
+// range of the column's sorted values equal to the query value, false when the index can't answer the predicate
+const bool CDatatableStore::IndexRange(const Column_t& column, const PreparedPredicate_t& prepared, IndexIt& lower, IndexIt& upper) const
+{
+    const eDatatableQueryOp op = prepared.predicate->op;
+
+    switch (column.type)
+    {
+    case DatatableColumType_t::Bool:
+    case DatatableColumType_t::Int:
+    case DatatableColumType_t::Float:
+    {
+        if (!prepared.isNumber || op == eDatatableQueryOp::CONTAINS)
+            return false;
+
+        const double number = prepared.number;
+
+        lower = std::lower_bound(column.sorted.begin(), column.sorted.end(), number, [this, &column](const uint32_t value, const double n) { return NumberAt(column, value) < n; });
+        upper = std::upper_bound(lower, column.sorted.end(), number, [this, &column](const double n, const uint32_t value) { return n < NumberAt(column, value); });
+
+        return true;
+    }
+    case DatatableColumType_t::String:
+    case DatatableColumType_t::Asset:
+    case DatatableColumType_t::AssetNoPrecache:
+    {
+        // ids aren't in text order, only equality can use them
+        if (!prepared.hasStringId || (op != eDatatableQueryOp::EQ && op != eDatatableQueryOp::NE))
+            return false;
+
+        const uint32_t stringId = prepared.stringId;
+
+        lower = std::lower_bound(column.sorted.begin(), column.sorted.end(), stringId, [&column](const uint32_t value, const uint32_t id) { return column.strings[value] < id; });
+        upper = std::upper_bound(lower, column.sorted.end(), stringId, [&column](const uint32_t id, const uint32_t value) { return id < column.strings[value]; });
+
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+const size_t CDatatableStore::EstimateColumn(const Column_t& column, const PreparedPredicate_t& prepared) const
+{
+    IndexIt lower, upper;
+    if (IndexRange(column, prepared, lower, upper))
+    {
+        const size_t below = static_cast<size_t>(std::distance(column.sorted.cbegin(), lower));
+        const size_t equal = static_cast<size_t>(std::distance(lower, upper));
+        const size_t above = static_cast<size_t>(std::distance(upper, column.sorted.cend()));
+
+        switch (prepared.predicate->op)
+        {
+        case eDatatableQueryOp::EQ: return equal;
+        case eDatatableQueryOp::NE: return below + above;
+        case eDatatableQueryOp::LT: return below;
+        case eDatatableQueryOp::LE: return below + equal;
+        case eDatatableQueryOp::GT: return above;
+        case eDatatableQueryOp::GE: return equal + above;
+        default: return 0ull;
+        }
+    }
+
+    // every other string comparison scans the column, anything else can't match
+    if (DataTable_IsStringType(column.type))
+        return prepared.predicate->op == eDatatableQueryOp::EQ ? 0ull : column.strings.size();
+
+    return 0ull;
+}
+
+const bool CDatatableStore::ValueMatches(const Column_t& column, const uint32_t value, const PreparedPredicate_t& prepared) const
+{
+    const eDatatableQueryOp op = prepared.predicate->op;
+
+    switch (column.type)
+    {
+    case DatatableColumType_t::Bool:
+    case DatatableColumType_t::Int:
+    case DatatableColumType_t::Float:
+    {
+        if (!prepared.isNumber)
+            return false;
+
+        // nan is left out of the index, so it matches nothing here either
+        const double number = NumberAt(column, value);
+        if (std::isnan(number))
+            return false;
+
+        return CompareMatches(op, number < prepared.number ? -1 : (number > prepared.number ? 1 : 0));
+    }
+    case DatatableColumType_t::String:
+    case DatatableColumType_t::Asset:
+    case DatatableColumType_t::AssetNoPrecache:
+    {
+        const uint32_t id = column.strings[value];
+
+        switch (op)
+        {
+        case eDatatableQueryOp::EQ:
+            return prepared.hasStringId && id == prepared.stringId;
+        case eDatatableQueryOp::NE:
+            return !prepared.hasStringId || id != prepared.stringId;
+        case eDatatableQueryOp::CONTAINS:
+        {
+            if (!prepared.containsIds.empty())
+                return prepared.containsIds[id];
+
+            const std::string_view str = m_strings[id];
+            const std::string& needle = prepared.predicate->value;
+
+            return ImStristr(str.data(), str.data() + str.length(), needle.data(), needle.data() + needle.length()) != nullptr;
+        }
+        default:
+            return CompareMatches(op, m_strings[id].compare(prepared.predicate->value));
+        }
+    }
+    default:
+        return false;
+    }
+}
+
+const bool CDatatableStore::RowMatches(const Table_t& table, const uint32_t localRow, const PreparedPredicate_t& prepared) const
+{
+    for (const TableColumn_t& tableColumn : table.columns)
+    {
+        if (!std::binary_search(prepared.columns.begin(), prepared.columns.end(), tableColumn.column))
+            continue;
+
+        if (ValueMatches(m_columns[tableColumn.column], tableColumn.firstValue + localRow, prepared))
+            return true;
+    }
+
+    return false;
+}
+
+// adds the store row of every value that matches, in value order
+void CDatatableStore::MatchColumn(const Column_t& column, const PreparedPredicate_t& prepared, std::vector<uint32_t>& rows) const
+{
+    const auto addRange = [&column, &rows](const IndexIt begin, const IndexIt end)
+        {
+            for (auto it = begin; it != end; ++it)
+                rows.push_back(column.rows[*it]);
+        };
+
+    IndexIt lower, upper;
+    if (IndexRange(column, prepared, lower, upper))
+    {
+        switch (prepared.predicate->op)
+        {
+        case eDatatableQueryOp::EQ: addRange(lower, upper); break;
+        case eDatatableQueryOp::NE: addRange(column.sorted.begin(), lower); addRange(upper, column.sorted.end()); break;
+        case eDatatableQueryOp::LT: addRange(column.sorted.begin(), lower); break;
+        case eDatatableQueryOp::LE: addRange(column.sorted.begin(), upper); break;
+        case eDatatableQueryOp::GT: addRange(upper, column.sorted.end()); break;
+        case eDatatableQueryOp::GE: addRange(lower, column.sorted.end()); break;
+        default: break;
+        }
+
+        return;
+    }
+
+    if (!EstimateColumn(column, prepared))
+        return;
+
+    for (uint32_t i = 0; i < column.rows.size(); i++)
+    {
+        if (ValueMatches(column, i, prepared))
+            rows.push_back(column.rows[i]);
+    }
+}
+
+const uint32_t CDatatableStore::TableForRow(const uint32_t row) const
+{
+    const auto it = std::upper_bound(m_tables.begin(), m_tables.end(), row, [](const uint32_t r, const Table_t& table) { return r < table.firstRow; });
+    assertm(it != m_tables.begin(), "row should be in a table");
+
+    return static_cast<uint32_t>(std::distance(m_tables.begin(), it) - 1);
+}
+
+const std::string CDatatableStore::FormatValue(const Column_t& column, const uint32_t value) const
+{
+    switch (column.type)
+    {
+    case DatatableColumType_t::Bool:
+        return column.ints[value] ? "true" : "false";
+    case DatatableColumType_t::Int:
+        return std::to_string(column.ints[value]);
+    case DatatableColumType_t::Float:
+        return std::format("{}", column.floats[value]);
+    case DatatableColumType_t::Vector:
+        return std::format("<{},{},{}>", column.vectors[value].x, column.vectors[value].y, column.vectors[value].z);
+    case DatatableColumType_t::String:
+    case DatatableColumType_t::Asset:
+    case DatatableColumType_t::AssetNoPrecache:
+        return std::string(m_strings[column.strings[value]]);
+    default:
+        return std::string();
+    }
+}
+
+void CDatatableStore::Query(const DatatableQuery_t& query, DatatableQueryResult_t& result) const
+{
+    PROFILE_SCOPE("datatable store query");
+
+    const auto start = std::chrono::steady_clock::now();
+
+    result.rows.clear();
+    result.totalRows = 0ull;
+
+    std::vector<PreparedPredicate_t> predicates(query.where.size());
+    for (size_t i = 0; i < query.where.size(); i++)
+        PreparePredicate(query.where[i], predicates[i]);
+
+    // the most selective predicate is matched through the store, the others are only checked on the rows it matched
+    std::stable_sort(predicates.begin(), predicates.end(), [](const PreparedPredicate_t& a, const PreparedPredicate_t& b) { return a.estimate < b.estimate; });
+
+    const bool matchAll = predicates.empty();
+
+    // store rows that matched, in store order
+    std::vector<uint32_t> matched;
+
+    if (!matchAll)
+    {
+        PreparedPredicate_t& first = predicates.front();
+
+        // contains is checked once per unique string instead of once per value
+        if (first.predicate->op == eDatatableQueryOp::CONTAINS)
+        {
+            const std::string& needle = first.predicate->value;
+
+            first.containsIds.resize(m_strings.size(), false);
+            for (uint32_t i = 0; i < m_strings.size(); i++)
+                first.containsIds[i] = ImStristr(m_strings[i].data(), m_strings[i].data() + m_strings[i].length(), needle.data(), needle.data() + needle.length()) != nullptr;
+        }
+
+        std::vector<uint32_t> rows;
+        rows.reserve(first.estimate);
+
+        for (const uint32_t column : first.columns)
+            MatchColumn(m_columns[column], first, rows);
+
+        // rows come out in value order and a row can match through more than one column, large sets are put back in order through a bitmap
+        if (rows.size() > m_numRows / 32u)
+        {
+            std::vector<bool> marked(m_numRows, false);
+            for (const uint32_t row : rows)
+                marked[row] = true;
+
+            matched.reserve(rows.size());
+            for (uint32_t row = 0; row < m_numRows; row++)
+            {
+                if (marked[row])
+                    matched.push_back(row);
+            }
+        }
+        else
+        {
+            std::sort(rows.begin(), rows.end());
+            rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+            matched.swap(rows);
+        }
+
+        if (predicates.size() > 1)
+        {
+            std::erase_if(matched, [this, &predicates](const uint32_t row)
+                {
+                    const Table_t& table = m_tables[TableForRow(row)];
+                    const uint32_t localRow = row - table.firstRow;
+
+                    for (size_t i = 1; i < predicates.size(); i++)
+                    {
+                        if (!RowMatches(table, localRow, predicates[i]))
+                            return true;
+                    }
+
+                    return false;
+                });
+        }
+    }
+
+    result.totalRows = matchAll ? m_numRows : matched.size();
+
+    std::vector<std::string> selectKeys;
+    for (const std::string& select : query.select)
+        selectKeys.push_back(ToLowerString(select));
+
+    const size_t numResults = std::min(result.totalRows, query.limit);
+    result.rows.reserve(numResults);
+
+    for (size_t i = 0; i < numResults; i++)
+    {
+        const uint32_t row = matchAll ? static_cast<uint32_t>(i) : matched[i];
+        const Table_t& table = m_tables[TableForRow(row)];
+        const uint32_t localRow = row - table.firstRow;
+
+        DatatableQueryRow_t& out = result.rows.emplace_back();
+        out.guid = table.guid;
+        out.table = table.name;
+        out.row = localRow;
+
+        if (selectKeys.empty())
+        {
+            out.cells.reserve(table.columns.size());
+
+            for (const TableColumn_t& tableColumn : table.columns)
+            {
+                const Column_t& column = m_columns[tableColumn.column];
+                out.cells.emplace_back(column.name, FormatValue(column, tableColumn.firstValue + localRow));
+            }
+
+            continue;
+        }
+
+        for (const std::string& key : selectKeys)
+        {
+            const auto it = std::ranges::find_if(table.columns, [this, &key](const TableColumn_t& tableColumn) { return m_columns[tableColumn.column].key == key; });
+
+            if (it == table.columns.end())
+                continue;
+
+            const Column_t& column = m_columns[it->column];
+            out.cells.emplace_back(column.name, FormatValue(column, it->firstValue + localRow));
+        }
+    }
+
+    result.elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+//
+// UI
+//
+void DrawDatatableQueryWindow(bool* const open)
+{
+    static char queryInput[512] = {};
+    static char selectInput[256] = {};
+    static int limit = 1000;
+
+    static std::string error;
+    static DatatableQueryResult_t result = {};
+    static bool hasResult = false;
+    static CPreviewTable resultTable;
+
+    ImGui::SetNextWindowSize(ImVec2(900.f, 500.f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Datatable Query", open))
+    {
+        ImGui::End();
+        return;
+    }
+
+    if (g_datatableStore.IsStale())
+        ImGui::TextUnformatted("Datatables will be ingested on the next query.");
+    else
+        ImGui::Text("%llu datatables, %u rows, %llu columns (%.1f MiB)", g_datatableStore.NumTables(), g_datatableStore.NumRows(), g_datatableStore.NumColumns(), static_cast<double>(g_datatableStore.MemoryUsage()) / (1024.0 * 1024.0));
+
+    bool run = ImGui::InputTextWithHint("Where", "damage > 50 && weapon ~ smg, * = asset/name", queryInput, sizeof(queryInput), ImGuiInputTextFlags_EnterReturnsTrue);
+    run |= ImGui::InputTextWithHint("Select", "columns to show, comma separated (default: all)", selectInput, sizeof(selectInput), ImGuiInputTextFlags_EnterReturnsTrue);
+
+    ImGui::SetNextItemWidth(120.f);
+    ImGui::InputInt("Limit", &limit);
+    limit = std::max(limit, 1);
+
+    ImGui::SameLine();
+    run |= ImGui::Button("Run");
+
+    if (run)
+    {
+        DatatableQuery_t query;
+        query.limit = static_cast<size_t>(limit);
+
+        if (DatatableQuery_t::Parse(queryInput, query, error))
+        {
+            error.clear();
+
+            std::stringstream selectStream(selectInput);
+            for (std::string column; std::getline(selectStream, column, ',');)
+            {
+                column.erase(0, column.find_first_not_of(" \t"));
+                column.erase(column.find_last_not_of(" \t") + 1);
+
+                if (!column.empty())
+                    query.select.push_back(std::move(column));
+            }
+
+            if (g_datatableStore.IsStale())
+                g_datatableStore.Build();
+
+            g_datatableStore.Query(query, result);
+            hasResult = true;
+
+            // selected columns get a column each, otherwise a row's columns depend on its datatable
+            resultTable.Reset(result.rows.size());
+            resultTable.AddColumn("Datatable", ePreviewColumnSort::TEXT);
+            resultTable.AddColumn("Row", ePreviewColumnSort::NUMBER);
+
+            if (query.select.empty())
+                resultTable.AddColumn("Values", ePreviewColumnSort::TEXT);
+
+            for (const std::string& column : query.select)
+                resultTable.AddColumn(column.c_str(), ePreviewColumnSort::TEXT);
+
+            for (const DatatableQueryRow_t& row : result.rows)
+            {
+                resultTable.AddCell(row.table.data(), row.table.length());
+                resultTable.AddCellFormat(static_cast<double>(row.row), "{}", row.row);
+
+                if (query.select.empty())
+                {
+                    std::string& values = resultTable.CellBuffer();
+                    for (size_t i = 0; i < row.cells.size(); i++)
+                    {
+                        values.append(i ? ", " : "");
+                        values.append(row.cells[i].first);
+                        values.append(": ");
+                        values.append(row.cells[i].second);
+                    }
+
+                    resultTable.EndCell();
+                    continue;
+                }
+
+                for (const std::string& column : query.select)
+                {
+                    const auto it = std::ranges::find_if(row.cells, [&column](const std::pair<std::string_view, std::string>& cell) { return _stricmp(std::string(cell.first).c_str(), column.c_str()) == 0; });
+                    resultTable.AddCell(it != row.cells.end() ? it->second.c_str() : "");
+                }
+            }
+        }
+    }
+
+    if (!error.empty())
+        ImGui::TextColored(ImVec4(1.f, 0.3f, 0.3f, 1.f), "%s", error.c_str());
+
+    if (hasResult)
+    {
+        ImGui::Text("%llu rows matched in %.3f ms, showing %llu", result.totalRows, static_cast<double>(result.elapsedNs) / 1000000.0, result.rows.size());
+        resultTable.Draw("Query Results", ImVec2(0.f, 0.f));
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include <game/rtech/assets/datatable.h>
+#include <core/utils/interner.h>
+
+enum class eDatatableQueryOp : uint8_t
+{
+	EQ,			// =, ==
+	NE,			// !=
+	LT,			// <
+	LE,			// <=
+	GT,			// >
+	GE,			// >=
+	CONTAINS,	// ~, case insensitive substring, strings only
+};
+
+struct DatatableQueryPredicate_t
+{
+	std::string column; // case insensitive, '*' matches every column
+	eDatatableQueryOp op;
+	std::string value;
+};
+
+struct DatatableQuery_t
+{
+	DatatableQuery_t() : limit(1000ull) {};
+
+	// predicates joined by "&&" or "and", e.g. damage > 50 && weapon ~ "smg"
+	// values can be quoted, column names too if they have spaces
+	static const bool Parse(const std::string_view expr, DatatableQuery_t& query, std::string& error);
+
+	std::vector<DatatableQueryPredicate_t> where; // every one has to match
+	std::vector<std::string> select; // columns to return, empty for every column of the row's datatable
+	size_t limit;
+};
+
+struct DatatableQueryRow_t
+{
+	uint64_t guid;
+	std::string_view table;
+	uint32_t row; // within its datatable
+	std::vector<std::pair<std::string_view, std::string>> cells; // column name and value, selected columns missing from the datatable are left out
+};
+
+struct DatatableQueryResult_t
+{
+	std::vector<DatatableQueryRow_t> rows; // at most the query limit
+	size_t totalRows; // rows that matched
+	int64_t elapsedNs;
+};
+
+// columnar store of every loaded datatable, for querying rows across all of them at once
+// columns with the same name and type are merged across datatables, each one keeps its values in a typed vector along with the store row of every
+// value, strings are interned and stored as ids. every column but vectors also keeps its value indices ordered by value, so number comparisons and
+// string equality are a binary search, other string comparisons scan the ids
+// a query matches its most selective predicate through the store and checks the rest on those rows only, only the rows returned are formatted
+// not thread safe, build and query from the same thread
+class CDatatableStore
+{
+public:
+	CDatatableStore() : m_numRows(0u), m_builtAssetCount(0ull), m_builtContainerCount(0ull), m_builtUnloadGeneration(0ull) {};
+
+	// ingests every loaded datatable, anything stored before is dropped
+	void Build();
+	void Clear();
+
+	// ingests the given datatables instead of the loaded ones, IsStale only means something after Build
+	void BuildFromTables(const std::vector<std::pair<uint64_t, const DatatableAsset*>>& datatables);
+
+	// assets were loaded or unloaded since the last build
+	const bool IsStale() const;
+
+	void Query(const DatatableQuery_t& query, DatatableQueryResult_t& result) const;
+
+	inline const size_t NumTables() const { return m_tables.size(); };
+	inline const size_t NumColumns() const { return m_columns.size(); };
+	inline const uint32_t NumRows() const { return m_numRows; };
+	const size_t MemoryUsage() const;
+
+private:
+	struct Column_t
+	{
+		std::string_view name;
+		std::string key; // lowercase name, for matching query columns
+		DatatableColumType_t type;
+
+		std::vector<uint32_t> rows; // store row of each value
+
+		// only the vector for the column's type is filled
+		std::vector<int32_t> ints; // bool and int
+		std::vector<float> floats;
+		std::vector<Vector> vectors;
+		std::vector<uint32_t> strings; // string ids, for every string type
+
+		std::vector<uint32_t> sorted; // value indices ordered by value, nan floats are left out
+	};
+
+	struct TableColumn_t
+	{
+		uint32_t column;
+		uint32_t firstValue; // index of the table's first row in the column
+	};
+
+	struct Table_t
+	{
+		uint64_t guid;
+		std::string_view name;
+		uint32_t firstRow; // store row of the table's first row
+		uint32_t numRows;
+		std::vector<TableColumn_t> columns; // in datatable order
+	};
+
+	struct PreparedPredicate_t;
+	using IndexIt = std::vector<uint32_t>::const_iterator;
+
+	const uint32_t InternString(const std::string_view str);
+	void IngestTable(const uint64_t guid, const DatatableAsset* const dtblAsset, std::unordered_map<std::string, uint32_t>& columnIds); // columnIds by lowercase name and type
+	void BuildIndex(Column_t& column) const;
+
+	const double NumberAt(const Column_t& column, const uint32_t value) const;
+
+	void PreparePredicate(const DatatableQueryPredicate_t& predicate, PreparedPredicate_t& prepared) const;
+	const bool IndexRange(const Column_t& column, const PreparedPredicate_t& predicate, IndexIt& lower, IndexIt& upper) const;
+	const size_t EstimateColumn(const Column_t& column, const PreparedPredicate_t& predicate) const;
+	const bool ValueMatches(const Column_t& column, const uint32_t value, const PreparedPredicate_t& predicate) const;
+	const bool RowMatches(const Table_t& table, const uint32_t localRow, const PreparedPredicate_t& predicate) const;
+	void MatchColumn(const Column_t& column, const PreparedPredicate_t& predicate, std::vector<uint32_t>& rows) const;
+
+	const uint32_t TableForRow(const uint32_t row) const;
+	const std::string FormatValue(const Column_t& column, const uint32_t value) const;
+
+	std::unique_ptr<CStringInterner> m_interner;
+	std::vector<std::string_view> m_strings; // by id
+	std::unordered_map<std::string_view, uint32_t> m_stringIds;
+
+	std::vector<Column_t> m_columns;
+	std::unordered_map<std::string, std::vector<uint32_t>> m_columnsByKey; // every column with a name, any type
+	std::vector<Table_t> m_tables; // ordered by first row
+
+	uint32_t m_numRows;
+
+	size_t m_builtAssetCount;
+	size_t m_builtContainerCount;
+	size_t m_builtUnloadGeneration;
+};
+
+extern CDatatableStore g_datatableStore;
+
+void DrawDatatableQueryWindow(bool* const open);
@@ -36,7 +36,7 @@ std::string R_GetImpactDefinitionAsString(const WepnData_v1_t* const key, const
         else
         {
             retVal += "\"unk\" // " + std::string(val->key) + ": unknown. rawval: " + std::format("{:X}", val->value.rawVal);
-            Log("unknown var type: %s %i %llX\n", val->key, val->valueType, val->value.rawVal);
+            LOG_WARN(GENERAL, "unknown var type: %s %i %llX\n", val->key, val->valueType, val->value.rawVal);
         }
         retVal += "\"\n";
     }
@@ -2,6 +2,12 @@
 #include <game/rtech/assets/localisation.h>
 #include <game/rtech/cpakfile.h>
 
+#include <core/utils/textexport.h>
+#include <core/ui/previewtable.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
+
+#include <emmintrin.h>
+
 extern ExportSettings_t g_ExportSettings;
 
 void LoadLocalisationAsset(CAssetContainer* pak, CAsset* asset)
@@ -19,7 +25,105 @@ void LoadLocalisationAsset(CAssetContainer* pak, CAsset* asset)
     pakAsset->setExtraData(loclAsset);
 }
 
-std::string EscapeLocalisationString(const std::string& str)
+// control characters, quotes and delete can't go into a locl string as they are
+// anything over ascii is part of a utf-8 sequence and is copied as is
+static FORCEINLINE const bool IsLocalisationEscapeChar(const unsigned char c)
+{
+    return c < 0x20 || c == '\"' || c == 0x7F;
+}
+
+// returns true if the character had to be hex escaped
+static const bool AppendLocalisationEscape(std::string& out, const unsigned char c, const bool csv)
+{
+    switch (c)
+    {
+    case '\0':
+        return false;
+    case '\t':
+        out.append("\\t", 2);
+        return false;
+    case '\n':
+        out.append("\\n", 2);
+        return false;
+    case '\r':
+        out.append("\\r", 2);
+        return false;
+    case '\"':
+        // csv fields are quoted, a quote inside one is doubled (rfc 4180)
+        out.append(csv ? "\"\"" : "\\\"", 2);
+        return false;
+    default:
+    {
+        // not zero padded
+        out.append("\\x", 2);
+        AppendTextExportHex(out, c);
+
+        return true;
+    }
+    }
+
+    unreachable();
+}
+
+// escapes a utf-8 string for a locl file and appends it to out
+// clean runs are found 16 bytes at a time and copied in one go
+// returns the number of non printable characters that were hex escaped
+size_t EscapeLocalisationString(std::string& out, const char* const str, const size_t length, const bool csv)
+{
+    const __m128i ctrlMax = _mm_set1_epi8(0x1F);
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i del = _mm_set1_epi8(0x7F);
+
+    size_t hexEscaped = 0ull;
+    size_t runStart = 0ull;
+    size_t i = 0ull;
+
+    while (i + 16 <= length)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+
+        const __m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(chars, ctrlMax), chars); // chars <= 0x1F
+        const __m128i special = _mm_or_si128(ctrl, _mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, del)));
+
+        const int mask = _mm_movemask_epi8(special);
+        if (!mask)
+        {
+            i += 16;
+            continue;
+        }
+
+        unsigned long index = 0;
+        _BitScanForward(&index, static_cast<unsigned long>(mask));
+        i += index;
+
+        out.append(str + runStart, i - runStart);
+        hexEscaped += AppendLocalisationEscape(out, static_cast<unsigned char>(str[i]), csv);
+
+        runStart = ++i;
+    }
+
+    for (; i < length; ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(str[i]);
+        if (!IsLocalisationEscapeChar(c))
+            continue;
+
+        out.append(str + runStart, i - runStart);
+        hexEscaped += AppendLocalisationEscape(out, c, csv);
+
+        runStart = i + 1;
+    }
+
+    out.append(str + runStart, length - runStart);
+
+    return hexEscaped;
+}
+
+// the escaper EscapeLocalisationString replaced, kept for the differential selftest against it (localisation.escape)
+// '\r' falls through into the quote case, and a lead byte that isn't valid utf-8 never advances, only valid utf-8 can be given to it
+// the per character log is left out, the exporters log a count of hex escapes instead
+#pragma warning(push, 0)
+std::string EscapeLocalisationStringReference(const std::string& str)
 {
     std::stringstream outStream;
 
@@ -71,10 +175,7 @@ std::string EscapeLocalisationString(const std::string& str)
         default:
         {
             if (!std::isprint(c))
-            {
-                Log("non printable char @ %i/%lld\n", i, str.length());
                 outStream << std::hex << std::setfill('0') << std::setw(2) << "\\x" << (int)c;
-            }
             else
                 outStream << c;
 
@@ -85,39 +186,133 @@ std::string EscapeLocalisationString(const std::string& str)
 
     return outStream.str();
 }
+#pragma warning(pop)
 
-static const char* const s_PathPrefixLOCL = s_AssetTypePaths.find(AssetType_t::LOCL)->second;
-bool ExportLocalisationAsset(CAsset* const asset, const int setting)
+// converts a locl string to utf-8 and appends it escaped, utf8 is scratch space for the conversion
+static size_t AppendLocalisationString(std::string& out, const wchar_t* const str, std::string& utf8, const bool csv = false)
 {
-    UNUSED(setting);
+    const int wideLength = static_cast<int>(wcslen(str));
+    if (!wideLength)
+        return 0ull;
 
-    CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
+    // a utf-16 unit is at most 3 bytes of utf-8, surrogate pairs are 4 bytes for 2 units
+    utf8.resize(static_cast<size_t>(wideLength) * 3);
 
-    // Create exported path + asset path.
-    std::filesystem::path exportPath = std::filesystem::current_path().append(EXPORT_DIRECTORY_NAME); // 
-    const std::filesystem::path localizationPath(asset->GetAssetName());
+    // windows utf-16 support sucks so convert to multibyte utf8
+    const int utf8Length = WideCharToMultiByte(CP_UTF8, 0, str, wideLength, utf8.data(), static_cast<int>(utf8.length()), (LPCCH)NULL, NULL);
 
-    // truncate paths?
-    if (g_ExportSettings.exportPathsFull)
-        exportPath.append(localizationPath.parent_path().string());
-    else
-        exportPath.append(s_PathPrefixLOCL);
+    return EscapeLocalisationString(out, utf8.data(), static_cast<size_t>(std::max(utf8Length, 0)), csv);
+}
 
-    if (!CreateDirectories(exportPath))
+static void LogHexEscapes(const char* const fileName, const size_t hexEscaped)
+{
+    if (hexEscaped)
+        LOG_WARN(GENERAL, "LOCL: escaped %lld non printable chars in \"%s\"\n", hexEscaped, fileName);
+}
+
+static bool ExportLOCLLocalisationAsset(const LocalisationAsset* const loclAsset, std::filesystem::path& exportPath)
+{
+    exportPath.append(loclAsset->fileName); // likely quicker than "exportPath.append(localizationPath.stem().string());"
+    exportPath.replace_extension(".locl");
+
+    std::string& out = GetTextExportBuffer();
+    std::string utf8;
+
+    out.reserve(loclAsset->numEntries * 64);
+
+    out.append("\"");
+    out.append(loclAsset->fileName);
+    out.append("\"\n{\n");
+
+    size_t hexEscaped = 0ull;
+    for (size_t i = 0; i < loclAsset->numEntries; ++i)
     {
-        assertm(false, "Failed to create asset type directory.");
-        return false;
+        const LocalisationEntry_t* const entry = &loclAsset->entries[i];
+
+        if (entry->hash == 0)
+            continue;
+
+        out.append("\t\"");
+        AppendTextExportHex(out, entry->hash);
+        out.append("\" \"");
+        hexEscaped += AppendLocalisationString(out, &loclAsset->strings[entry->stringStartIndex], utf8);
+        out.append("\"\n");
     }
 
+    out.append("}");
+
+    LogHexEscapes(loclAsset->fileName, hexEscaped);
+
+    return WriteTextExportFile(exportPath, out);
+}
+
+// strings are shown escaped like in locl files, so control characters stay visible and every entry is one line
+static void* PreviewLocalisationAsset(CAsset* const asset, const bool firstFrameForAsset)
+{
+    CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
+
     const LocalisationAsset* const loclAsset = reinterpret_cast<LocalisationAsset*>(pakAsset->extraData());
+    assertm(loclAsset, "Extra data should be valid at this point.");
 
-    exportPath.append(loclAsset->fileName); // likely quicker than "exportPath.append(localizationPath.stem().string());"
-    exportPath.replace_extension(".locl");
+    static CPreviewTable previewTable;
+
+    if (firstFrameForAsset)
+    {
+        PROFILE_SCOPE("localisation preview build");
+
+        std::string utf8;
+
+        previewTable.Reset(loclAsset->numEntries);
+        previewTable.AddColumn("Hash", ePreviewColumnSort::TEXT); // zero padded, sorts the same as the value
+        previewTable.AddColumn("String", ePreviewColumnSort::TEXT);
+
+        for (size_t i = 0; i < loclAsset->numEntries; ++i)
+        {
+            const LocalisationEntry_t* const entry = &loclAsset->entries[i];
+
+            if (entry->hash == 0)
+                continue;
+
+            previewTable.AddCellFormat(0.0, "{:016X}", entry->hash);
+
+            AppendLocalisationString(previewTable.CellBuffer(), &loclAsset->strings[entry->stringStartIndex], utf8);
+            previewTable.EndCell();
+        }
+    }
+
+    ImGui::TextUnformatted(std::format("Localisation: {} (0x{:X})", loclAsset->fileName, asset->GetAssetGUID()).c_str());
+
+    previewTable.Draw("Localisation Table", ImVec2(0.f, 0.f));
+
+    return nullptr;
+}
+
+// one language's escaped strings back to back, with their entries sorted by hash
+struct LocalisationColumn_t
+{
+    struct Entry_t
+    {
+        uint64_t hash;
+        size_t offset;
+        size_t length;
+    };
+
+    const LocalisationAsset* asset;
+
+    std::string text;
+    std::vector<Entry_t> entries;
+};
+
+static void BuildLocalisationColumn(LocalisationColumn_t& column)
+{
+    const LocalisationAsset* const loclAsset = column.asset;
 
-    std::ofstream ofs(exportPath, std::ios::out | std::ios::binary);
+    std::string utf8;
 
-    ofs << "\"" << loclAsset->fileName << "\"\n{\n";
+    column.text.reserve(loclAsset->numEntries * 48);
+    column.entries.reserve(loclAsset->numEntries);
 
+    size_t hexEscaped = 0ull;
     for (size_t i = 0; i < loclAsset->numEntries; ++i)
     {
         const LocalisationEntry_t* const entry = &loclAsset->entries[i];
@@ -125,35 +320,200 @@ bool ExportLocalisationAsset(CAsset* const asset, const int setting)
         if (entry->hash == 0)
             continue;
 
-        const std::wstring wideString = &loclAsset->strings[entry->stringStartIndex];
+        const size_t offset = column.text.length();
+        hexEscaped += AppendLocalisationString(column.text, &loclAsset->strings[entry->stringStartIndex], utf8, true);
+
+        column.entries.push_back({ entry->hash, offset, column.text.length() - offset });
+    }
+
+    std::ranges::stable_sort(column.entries, {}, &LocalisationColumn_t::Entry_t::hash);
+
+    LogHexEscapes(loclAsset->fileName, hexEscaped);
+}
+
+// every loaded language in one csv, one row per hash and one column per language
+// every field is quoted with quotes inside it doubled (rfc 4180), everything else is escaped the same way as in locl files so each row stays on one line
+static bool ExportCombinedLocalisationAssets(std::filesystem::path& exportPath)
+{
+    exportPath.append("localization_combined.csv");
+
+    // gather the languages, the first asset loaded for each name is used
+    std::vector<LocalisationColumn_t> columns;
+    std::vector<uint64_t> guids;
+
+    for (const CGlobalAssetData::AssetLookup_t& lookup : g_assetData.v_assets)
+    {
+        if (lookup.m_asset->GetAssetType() != 'lcol' || lookup.m_asset->GetAssetContainerType() != CAsset::ContainerType::PAK)
+            continue;
+
+        const LocalisationAsset* const loclAsset = reinterpret_cast<const LocalisationAsset*>(static_cast<CPakAsset*>(lookup.m_asset)->extraData());
+        if (!loclAsset)
+            continue;
+
+        if (std::ranges::any_of(columns, [loclAsset](const LocalisationColumn_t& column) { return !strcmp(column.asset->fileName, loclAsset->fileName); }))
+            continue;
+
+        columns.push_back({ loclAsset });
+        guids.push_back(lookup.m_guid);
+    }
+
+    std::ranges::sort(columns, [](const LocalisationColumn_t& a, const LocalisationColumn_t& b) { return strcmp(a.asset->fileName, b.asset->fileName) < 0; });
+    std::ranges::sort(guids);
+
+    // exporting every locl asset asks for the same file once per asset, only write it once for the same set of languages
+    static std::map<std::filesystem::path, std::vector<uint64_t>> s_combinedExports;
+    static std::mutex s_combinedExportMutex;
+
+    std::lock_guard lock(s_combinedExportMutex);
+
+    if (const auto it = s_combinedExports.find(exportPath); it != s_combinedExports.end() && it->second == guids && std::filesystem::exists(exportPath))
+    {
+        // still an output of this asset
+        CWrittenFileTracker::Record(exportPath);
+        return true;
+    }
+
+    // each language is converted on its own thread
+    const uint32_t columnCount = static_cast<uint32_t>(columns.size());
+    const uint32_t threadCount = std::clamp(UtilsConfig->exportThreadCount, 1u, std::max(columnCount, 1u));
+
+    CParallelTask parallelColumnTask(threadCount);
+
+    std::atomic<uint32_t> columnIdx = 0;
+    parallelColumnTask.addTask([&columns, columnCount, &columnIdx]
+    {
+        while (columnIdx < columnCount)
+        {
+            const uint32_t columnToProcess = columnIdx++;
+            if (columnToProcess >= columnCount)
+                continue;
+
+            BuildLocalisationColumn(columns[columnToProcess]);
+        }
+    }, threadCount);
+
+    parallelColumnTask.execute();
+    parallelColumnTask.wait();
+
+    // every hash that is in any language
+    std::vector<uint64_t> hashes;
+    for (const LocalisationColumn_t& column : columns)
+    {
+        for (const LocalisationColumn_t::Entry_t& entry : column.entries)
+            hashes.push_back(entry.hash);
+    }
+
+    std::ranges::sort(hashes);
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+    std::string& out = GetTextExportBuffer();
+
+    size_t textSize = 0ull;
+    for (const LocalisationColumn_t& column : columns)
+        textSize += column.text.length();
+
+    out.reserve(textSize + (hashes.size() * (columns.size() + 1) * 4) + (hashes.size() * 16));
+
+    // add header row
+    out.append("\"hash\"");
+    for (const LocalisationColumn_t& column : columns)
+    {
+        out.append(",\"");
+        EscapeLocalisationString(out, column.asset->fileName, strlen(column.asset->fileName), true);
+        out.append("\"");
+    }
+    out.append("\n");
+
+    // entries are sorted, so each column is walked once alongside the rows
+    std::vector<size_t> cursors(columns.size(), 0ull);
+
+    for (const uint64_t hash : hashes)
+    {
+        out.append("\"");
+        AppendTextExportHex(out, hash);
+        out.append("\"");
+
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            const LocalisationColumn_t& column = columns[i];
+            size_t& cursor = cursors[i];
+
+            while (cursor < column.entries.size() && column.entries[cursor].hash < hash)
+                ++cursor;
+
+            out.append(",\"");
 
-        std::string multiByteString;
-        multiByteString.resize(wideString.length() * 2);    // some utf-8 characters are actually more than one byte, up to four bytes. if we don't have enough space, WideCharToMultiByte will not finish its conversion, causing their to be incomplete strings.
-                                                            // only allowing for characters up to two bytes currently as it seems to be sufficient
+            if (cursor < column.entries.size() && column.entries[cursor].hash == hash)
+                out.append(column.text, column.entries[cursor].offset, column.entries[cursor].length);
 
-        // windows utf-16 support sucks so convert to multibyte utf8
-        WideCharToMultiByte(CP_UTF8, 0, wideString.c_str(), static_cast<int>(wideString.length()), &multiByteString[0], static_cast<int>(multiByteString.length()), (LPCCH)NULL, NULL);
+            out.append("\"");
+        }
 
-        ofs << "\t\"" << std::hex << entry->hash << "\" \"" << EscapeLocalisationString(multiByteString).c_str() << "\"\n"; // use the .c_str() function here now so it gets null terminated properly (if there's extra data or it's cut off, there will no longer be a [NUL] character in the file.
+        out.append("\n");
     }
 
-    ofs << "}";
+    if (!WriteTextExportFile(exportPath, out))
+        return false;
 
-    ofs.close();
+    s_combinedExports.insert_or_assign(exportPath, std::move(guids));
 
     return true;
 }
 
+enum eLocalisationExportSetting
+{
+    LOCL_LOCL,  // one locl file per language
+    LOCL_CSV,   // every loaded language in one csv
+};
+
+static const char* const s_PathPrefixLOCL = s_AssetTypePaths.find(AssetType_t::LOCL)->second;
+bool ExportLocalisationAsset(CAsset* const asset, const int setting)
+{
+    CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
+
+    // Create exported path + asset path.
+    std::filesystem::path exportPath = std::filesystem::current_path().append(EXPORT_DIRECTORY_NAME); // 
+    const std::filesystem::path localizationPath(asset->GetAssetName());
+
+    // truncate paths?
+    if (g_ExportSettings.exportPathsFull)
+        exportPath.append(localizationPath.parent_path().string());
+    else
+        exportPath.append(s_PathPrefixLOCL);
+
+    if (!CreateDirectories(exportPath))
+    {
+        assertm(false, "Failed to create asset type directory.");
+        return false;
+    }
+
+    const LocalisationAsset* const loclAsset = reinterpret_cast<LocalisationAsset*>(pakAsset->extraData());
+
+    switch (setting)
+    {
+    case eLocalisationExportSetting::LOCL_LOCL:
+        return ExportLOCLLocalisationAsset(loclAsset, exportPath);
+    case eLocalisationExportSetting::LOCL_CSV:
+        return ExportCombinedLocalisationAssets(exportPath);
+    default:
+        assertm(false, "Export setting is not handled.");
+        return false;
+    }
+
+    unreachable();
+}
+
 void InitLoclAssetType()
 {
+    static const char* settings[] = { "LOCL", "CSV (All Languages)" };
     AssetTypeBinding_t type =
     {
         .type = 'lcol',
         .headerAlignment = 8,
         .loadFunc = LoadLocalisationAsset,
         .postLoadFunc = nullptr,
-        .previewFunc = nullptr,
-        .e = { ExportLocalisationAsset, 0, nullptr, 0ull },
+        .previewFunc = PreviewLocalisationAsset,
+        .e = { ExportLocalisationAsset, 0, settings, ARRSIZE(settings) },
     };
 
     REGISTER_TYPE(type);
@@ -34,4 +34,10 @@ struct LocalisationAsset
     wchar_t* strings;
 
     std::string getName() { return fileName; };
-};
\ No newline at end of file
+};
+// escapes a utf-8 string for a locl file and appends it to out, returns the number of hex escaped characters
+// csv doubles quotes instead of backslash escaping them, for a quoted csv field
+size_t EscapeLocalisationString(std::string& out, const char* const str, const size_t length, const bool csv = false);
+
+// the old stringstream escaper, only for comparing against
+std::string EscapeLocalisationStringReference(const std::string& str);
@@ -50,7 +50,7 @@ const MaterialShaderType_t GetTypeFromLegacyMaterial(std::filesystem::path& mate
         return type;
     }
 
-    Log("** failed to find type for material %s\n", materialPath.string().c_str());
+    LOG_WARN(MATERIAL, "** failed to find type for material %s\n", materialPath.string().c_str());
 
     return MaterialShaderType_t::_TYPE_LEGACY;
 }
@@ -69,7 +69,7 @@ const MaterialShaderType_t GetTypeFromMaterialName(const std::filesystem::path&
         return type;
     }
 
-    Log("** failed to find type for material %s\n", materialPath.string().c_str());
+    LOG_WARN(MATERIAL, "** failed to find type for material %s\n", materialPath.string().c_str());
 
     // [rika]: bad! bad! these materials should(should) be 'gen' but we can't really check that!
     // material\code_private\ui_mrt.rpak
@@ -247,8 +247,7 @@ void PostLoadMaterialAsset(CAssetContainer* const container, CAsset* const asset
 
         if (shdsAsset->pixelShaderAsset)
         {
-            materialAsset->resourceBindings = ResourceBindingFromDXBlob(shdsAsset->pixelShaderAsset, D3D10_SIT_TEXTURE);
-            materialAsset->cpuDataBuf = ConstBufVarFromDXBlob(shdsAsset->pixelShaderAsset, "CBufUberStatic");
+            materialAsset->shaderReflection = GetShaderReflection(shdsAsset->pixelShaderAsset);
         }
     }
 
@@ -270,7 +269,7 @@ void PostLoadMaterialAsset(CAssetContainer* const container, CAsset* const asset
         materialAsset->txtrAssets.push_back(TextureAssetEntry_t(textureAsset, static_cast<uint32_t>(i)));
     }
 
-    if (materialAsset->cpuData)
+    if (materialAsset->cpuData && g_dxHandler)
     {
         CreateD3DBuffer(g_dxHandler->GetDevice(),
             &materialAsset->uberStaticBuffer, materialAsset->cpuDataSize,
@@ -457,8 +456,8 @@ void* PreviewMaterialAsset(CAsset* const asset, const bool firstFrameForAsset)
             else
                 previewTextureData.textureName = std::format("0x{:X}", previewTextureData.textureAssetGuid);
 
-            if (materialAsset->resourceBindings.count(entry.index))
-                previewTextureData.resourceBindingName = materialAsset->resourceBindings.at(entry.index).name;
+            if (materialAsset->ResourceBindings().count(entry.index))
+                previewTextureData.resourceBindingName = materialAsset->ResourceBindings().at(entry.index).name;
             else
             {
                 flags |= MaterialTexturePreviewData_t::eTextureStateFlags::TEXSF_RES_UNKNOWN;
@@ -491,12 +490,12 @@ void* PreviewMaterialAsset(CAsset* const asset, const bool firstFrameForAsset)
         g_pImGuiHandler->HelpMarker(s_MaterialShaderTypeHelpText);
     }
 
-    ImGui::Text("Shaderset: %s (0x%llx)", materialAsset->shaderSetAsset ? materialAsset->shaderSetAsset->GetAssetName().c_str() : "unloaded", materialAsset->shaderSet);
+    ImGui::Text("Shaderset: %s (0x%llx)", materialAsset->shaderSetAsset ? materialAsset->shaderSetAsset->GetAssetName().data() : "unloaded", materialAsset->shaderSet);
 
     // [rika]: does this material use a snapshot?
     if (materialAsset->snapshotMaterial != 0)
     {
-        ImGui::Text("Material Snapshot: %s (0x%llx)", materialAsset->snapshotAsset ? materialAsset->snapshotAsset->GetAssetName().c_str() : "unloaded", materialAsset->snapshotMaterial);
+        ImGui::Text("Material Snapshot: %s (0x%llx)", materialAsset->snapshotAsset ? materialAsset->snapshotAsset->GetAssetName().data() : "unloaded", materialAsset->snapshotMaterial);
         ImGui::SameLine();
         g_pImGuiHandler->HelpMarker("If a material uses a snapshot, the snapshot needs to be loaded for DX States preview to be accurate.\n");
     }
@@ -690,7 +689,7 @@ bool ExportStructMaterialAsset(const MaterialAsset* const materialAsset, std::fi
     ss << "struct CBufUberStatic\n{\n";
 
     char* ptr = reinterpret_cast<char*>(materialAsset->cpuData);
-    for (auto& it : materialAsset->cpuDataBuf)
+    for (auto& it : materialAsset->CpuDataBuf())
     {
         ss << "\t";
 
@@ -791,9 +790,9 @@ static void RemoveRenderPassSuffix(std::string& textureName)
 // [rika]: generate the best possible texture name from the provided data
 static inline void TextureNameGenerated(MaterialTextureExportInfo_s& info, const MaterialAsset* const materialAsset, const std::string& materialStem, const uint32_t entryIdx, const eTextureType txtrType)
 {
-    if (materialAsset->resourceBindings.count(entryIdx))
+    if (materialAsset->ResourceBindings().count(entryIdx))
     {
-        info.exportName = std::format("{}_{}", materialStem, materialAsset->resourceBindings.at(entryIdx).name);
+        info.exportName = std::format("{}_{}", materialStem, materialAsset->ResourceBindings().at(entryIdx).name);
         return;
     }
 
@@ -808,7 +807,7 @@ static inline void TextureNameGenerated(MaterialTextureExportInfo_s& info, const
 }
 
 // [rika]: handle parsing a valid texture path
-static inline void TextureNameReal(MaterialTextureExportInfo_s& info, const std::string& name, const bool useFullPaths)
+static inline void TextureNameReal(MaterialTextureExportInfo_s& info, const std::string_view name, const bool useFullPaths)
 {
     const std::filesystem::path tmp(name);
 
@@ -975,6 +974,7 @@ bool ExportMaterialStruct(const MaterialAsset* const materialAsset,
 
     exportPath.replace_extension(".json");
     std::ofstream ofs(exportPath, std::ios::out);
+    CWrittenFileTracker::Record(exportPath);
 
     // [rika]: some material names (notably r2 materials) use '\\' instead of '/'
     std::string materialName(materialAsset->name);
@@ -1073,8 +1073,8 @@ bool ExportMaterialStruct(const MaterialAsset* const materialAsset,
 
         const char* toPrint = nullptr;
 
-        if (materialAsset->resourceBindings.count(entry.index))
-            toPrint = materialAsset->resourceBindings.at(entry.index).name;
+        if (materialAsset->ResourceBindings().count(entry.index))
+            toPrint = materialAsset->ResourceBindings().at(entry.index).name;
         else if (!textureInfo.empty() && textureInfo.count(entry.index))
         {
             const MaterialTextureExportInfo_s& info = textureInfo.at(entry.index);
@@ -1207,6 +1207,29 @@ bool ExportMaterialAsset(CAsset* const asset, const int setting)
     unreachable();
 }
 
+static void ReleaseRefsMaterialAsset(CAsset* const asset)
+{
+    CPakAsset* const pakAsset = static_cast<CPakAsset*>(asset);
+
+    MaterialAsset* const materialAsset = reinterpret_cast<MaterialAsset*>(pakAsset->extraData());
+    if (!materialAsset)
+        return;
+
+    if (g_assetData.IsUnloading(materialAsset->snapshotAsset))
+        materialAsset->snapshotAsset = nullptr;
+
+    // the reflection owns copies of its names, it outlives the shader
+    if (g_assetData.IsUnloading(materialAsset->shaderSetAsset))
+        materialAsset->shaderSetAsset = nullptr;
+
+    // entries are kept for their index, they show as unloaded textures
+    for (TextureAssetEntry_t& entry : materialAsset->txtrAssets)
+    {
+        if (g_assetData.IsUnloading(entry.asset))
+            entry.asset = nullptr;
+    }
+}
+
 void InitMaterialAssetType()
 {
     static const char* settings[] = { "Base (Textures)", "Uber (Raw)", "Uber (Struct)" }; // [rika]: I'm not a super big fan of these setting names, especially since the first one can do nothing in some cases.
@@ -1218,6 +1241,7 @@ void InitMaterialAssetType()
         .postLoadFunc = PostLoadMaterialAsset,
         .previewFunc = PreviewMaterialAsset,
         .e = { ExportMaterialAsset, 0, settings, ARRSIZE(settings) },
+        .releaseRefsFunc = ReleaseRefsMaterialAsset,
     };
 
     REGISTER_TYPE(type);
@@ -740,6 +740,11 @@ public:
 		numRenderTargets = D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT;
 	};
 
+	~MaterialAsset()
+	{
+		DX_RELEASE_PTR(uberStaticBuffer);
+	};
+
 	uint64_t snapshotMaterial;
 
 	uint64_t guid; // guid of this material asset
@@ -782,20 +787,27 @@ public:
 	uint8_t uberBufferFlags;
 	//
 
-	ID3D11Buffer* uberStaticBuffer;
+	ID3D11Buffer* uberStaticBuffer = nullptr; // created in post load
 	void* cpuData;
 	int cpuDataSize;
-	std::vector<TmpConstBufVar> cpuDataBuf; // should this be done on export?
 
 	CPakAsset* shaderSetAsset;
 	CPakAsset* snapshotAsset;
 	std::vector<TextureAssetEntry_t> txtrAssets;
-	std::map<uint32_t, ShaderResource> resourceBindings; // this is how we get suffixes, could have some reliabity issues
+	std::shared_ptr<const ShaderReflection_t> shaderReflection; // pixel shader reflection, shared with every material using the shader
+
+	// texture bindings of the pixel shader, this is how we get suffixes, could have some reliabity issues
+	inline const std::map<uint32_t, ShaderResource>& ResourceBindings() const { return shaderReflection ? shaderReflection->Bindings(D3D10_SIT_TEXTURE) : s_noResourceBindings; }
+	inline const std::vector<TmpConstBufVar>& CpuDataBuf() const { return shaderReflection ? shaderReflection->ConstBufVars("CBufUberStatic") : s_noCpuDataBuf; }
 
 	uint8_t numRenderTargets;
 
 	// parse snapshot
 	void ParseSnapshot();
+
+private:
+	static inline const std::map<uint32_t, ShaderResource> s_noResourceBindings;
+	static inline const std::vector<TmpConstBufVar> s_noCpuDataBuf;
 };
 
 void MatPreview_DXState(const MaterialDXState_t& dxState, const uint8_t dxStateId, const uint8_t numRenderTargets);
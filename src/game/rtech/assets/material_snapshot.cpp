@@ -60,7 +60,7 @@ void* PreviewMaterialSnapshotAsset(CAsset* const asset, const bool firstFrameFor
     const MaterialSnapshotAsset* const snapshotAsset = reinterpret_cast<const MaterialSnapshotAsset* const>(pakAsset->extraData());
     assertm(snapshotAsset, "Extra data should be valid at this point.");
 
-    ImGui::Text("Shaderset: %s (0x%llx)", snapshotAsset->shaderSetAsset ? snapshotAsset->shaderSetAsset->GetAssetName().c_str() : "unloaded", snapshotAsset->shaderSet);
+    ImGui::Text("Shaderset: %s (0x%llx)", snapshotAsset->shaderSetAsset ? snapshotAsset->shaderSetAsset->GetAssetName().data() : "unloaded", snapshotAsset->shaderSet);
 
     if (ImGui::TreeNode("DX States"))
     {
@@ -72,6 +72,15 @@ void* PreviewMaterialSnapshotAsset(CAsset* const asset, const bool firstFrameFor
     return nullptr;
 }
 
+static void ReleaseRefsMaterialSnapshotAsset(CAsset* const asset)
+{
+    CPakAsset* const pakAsset = static_cast<CPakAsset*>(asset);
+
+    MaterialSnapshotAsset* const snapshotAsset = reinterpret_cast<MaterialSnapshotAsset*>(pakAsset->extraData());
+    if (snapshotAsset && g_assetData.IsUnloading(snapshotAsset->shaderSetAsset))
+        snapshotAsset->shaderSetAsset = nullptr;
+}
+
 void InitMaterialSnapshotAssetType()
 {
     AssetTypeBinding_t type =
@@ -82,6 +91,7 @@ void InitMaterialSnapshotAssetType()
         .postLoadFunc = PostLoadMaterialSnapshotAsset,
         .previewFunc = PreviewMaterialSnapshotAsset,
         .e = { nullptr, 0, nullptr, 0ull },
+        .releaseRefsFunc = ReleaseRefsMaterialSnapshotAsset,
     };
 
     REGISTER_TYPE(type);
@@ -8,6 +8,7 @@
 #include <game/rtech/utils/bvh/bvh.h>
 #include <game/rtech/utils/bsp/bspflags.h>
 
+#include <core/cache/modelcache.h>
 #include <core/render/dx.h>
 #include <thirdparty/imgui/imgui.h>
 #include <thirdparty/imgui/misc/imgui_utility.h>
@@ -17,13 +18,21 @@
 extern CBufferManager g_BufferManager;
 extern ExportSettings_t g_ExportSettings;
 
-static void ParseModelVertexData_v8(CPakAsset* const asset, ModelAsset* const modelAsset)
+// vertex data a model is parsed from, fetched before parsing so it can be hashed for the model cache
+struct ModelVertexSource_t
 {
-    UNUSED(asset);
+    std::unique_ptr<char[]> streamed;
+    char* data;
+    uint64_t size;
+};
+
+static void ParseModelVertexData_v8(ModelAsset* const modelAsset, const ModelVertexSource_t& source)
+{
+    UNUSED(source); // vtx, vvd, vvc and vvw are read in place
 
     if (!modelAsset->vertexComponentData)
     {
-        Log("%s loaded with no vertex data\n", modelAsset->name);
+        LOG_WARN(MODEL, "%s loaded with no vertex data\n", modelAsset->name);
         return;
     }
 
@@ -216,14 +225,14 @@ static void ParseModelVertexData_v8(CPakAsset* const asset, ModelAsset* const mo
 
 const uint8_t s_VertexDataBaseBoneMap[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
 
-static void ParseModelVertexData_v9(CPakAsset* const asset, ModelAsset* const modelAsset)
+static void ParseModelVertexData_v9(ModelAsset* const modelAsset, const ModelVertexSource_t& source)
 {
-    const std::unique_ptr<char[]> pStreamed = modelAsset->vertexStreamingData.size > 0 ? asset->getStarPakData(modelAsset->vertexStreamingData.offset, modelAsset->vertexStreamingData.size, false) : nullptr; // probably smarter to check the size inside getStarPakData but whatever!
-    char* const pDataBuffer = pStreamed.get() ? pStreamed.get() : modelAsset->staticStreamingData;
+    const std::unique_ptr<char[]>& pStreamed = source.streamed;
+    char* const pDataBuffer = source.data;
 
     if (!pDataBuffer)
     {
-        Log("%s loaded with no vertex data\n", modelAsset->name);
+        LOG_WARN(MODEL, "%s loaded with no vertex data\n", modelAsset->name);
         return;
     }
 
@@ -336,12 +345,7 @@ static void ParseModelVertexData_v9(CPakAsset* const asset, ModelAsset* const mo
                     meshVertexData->AddWeights(nullptr, 0);
 
                     int weightIdx = 0;
-                    for (unsigned int vertIdx = 0; vertIdx < mesh->vertCount; ++vertIdx)
-                    {
-                        const char* const vertexData = rawVertexData + (vertIdx * mesh->vertCacheSize);
-                        Vector2D* const texcoords = meshData.texcoordCount > 1 ? &meshVertexData->GetTexcoords()[vertIdx * (meshData.texcoordCount - 1)] : nullptr;
-                        Vertex_t::ParseVertexFromVG(&meshVertexData->GetVertices()[vertIdx], &meshVertexData->GetWeights()[weightIdx], texcoords, &meshData, vertexData, boneMap, weights, weightIdx);
-                    }
+                    Vertex_t::ParseVerticesFromVG(meshVertexData->GetVertices(), meshVertexData->GetWeights(), meshData.texcoordCount > 1 ? meshVertexData->GetTexcoords() : nullptr, &meshData, rawVertexData, boneMap, weights, weightIdx);
                     meshData.weightsCount = weightIdx;
                     meshVertexData->AddWeights(nullptr, meshData.weightsCount);
 
@@ -376,14 +380,14 @@ static void ParseModelVertexData_v9(CPakAsset* const asset, ModelAsset* const mo
     parsedData->meshVertexData.shrink();
 }
 
-static void ParseModelVertexData_v12_1(CPakAsset* const asset, ModelAsset* const modelAsset)
+static void ParseModelVertexData_v12_1(ModelAsset* const modelAsset, const ModelVertexSource_t& source)
 {
-    const std::unique_ptr<char[]> pStreamed = modelAsset->vertexStreamingData.size > 0 ? asset->getStarPakData(modelAsset->vertexStreamingData.offset, modelAsset->vertexStreamingData.size, false) : nullptr; // probably smarter to check the size inside getStarPakData but whatever!
-    char* const pDataBuffer = pStreamed.get() ? pStreamed.get() : modelAsset->staticStreamingData;
+    const std::unique_ptr<char[]>& pStreamed = source.streamed;
+    char* const pDataBuffer = source.data;
 
     if (!pDataBuffer)
     {
-        Log("%s loaded with no vertex data\n", modelAsset->name);
+        LOG_WARN(MODEL, "%s loaded with no vertex data\n", modelAsset->name);
         return;
     }
 
@@ -494,12 +498,7 @@ static void ParseModelVertexData_v12_1(CPakAsset* const asset, ModelAsset* const
                         meshVertexData->AddWeights(nullptr, 0);
 
                         int weightIdx = 0;
-                        for (int vertIdx = 0; vertIdx < mesh->vertCount; ++vertIdx)
-                        {
-                            char* const vertexData = rawVertexData + (vertIdx * mesh->vertCacheSize);
-                            Vector2D* const texcoords = meshData.texcoordCount > 1 ? &meshVertexData->GetTexcoords()[vertIdx * (meshData.texcoordCount - 1)] : nullptr;
-                            Vertex_t::ParseVertexFromVG(&meshVertexData->GetVertices()[vertIdx], &meshVertexData->GetWeights()[weightIdx], texcoords, &meshData, vertexData, boneMap, weights, weightIdx);
-                        }
+                        Vertex_t::ParseVerticesFromVG(meshVertexData->GetVertices(), meshVertexData->GetWeights(), meshData.texcoordCount > 1 ? meshVertexData->GetTexcoords() : nullptr, &meshData, rawVertexData, boneMap, weights, weightIdx);
                         meshData.weightsCount = weightIdx;
                         meshVertexData->AddWeights(nullptr, meshData.weightsCount);
 
@@ -538,14 +537,14 @@ static void ParseModelVertexData_v12_1(CPakAsset* const asset, ModelAsset* const
     parsedData->meshVertexData.shrink();
 }
 
-static void ParseModelVertexData_v14(CPakAsset* const asset, ModelAsset* const modelAsset)
+static void ParseModelVertexData_v14(ModelAsset* const modelAsset, const ModelVertexSource_t& source)
 {
-    const std::unique_ptr<char[]> pStreamed = modelAsset->vertexStreamingData.size > 0 ? asset->getStarPakData(modelAsset->vertexStreamingData.offset, modelAsset->vertexStreamingData.size, false) : nullptr; // probably smarter to check the size inside getStarPakData but whatever!
-    char* const pDataBuffer = pStreamed.get() ? pStreamed.get() : modelAsset->staticStreamingData;
+    const std::unique_ptr<char[]>& pStreamed = source.streamed;
+    char* const pDataBuffer = source.data;
 
     if (!pDataBuffer)
     {
-        Log("%s loaded with no vertex data\n", modelAsset->name);
+        LOG_WARN(MODEL, "%s loaded with no vertex data\n", modelAsset->name);
         return;
     }
 
@@ -657,12 +656,7 @@ static void ParseModelVertexData_v14(CPakAsset* const asset, ModelAsset* const m
                         meshVertexData->AddWeights(nullptr, 0);
 
                         int weightIdx = 0;
-                        for (unsigned int vertIdx = 0; vertIdx < mesh->vertCount; ++vertIdx)
-                        {
-                            char* const vertexData = rawVertexData + (vertIdx * mesh->vertCacheSize);
-                            Vector2D* const texcoords = meshData.texcoordCount > 1 ? &meshVertexData->GetTexcoords()[vertIdx * (meshData.texcoordCount - 1)] : nullptr;
-                            Vertex_t::ParseVertexFromVG(&meshVertexData->GetVertices()[vertIdx], &meshVertexData->GetWeights()[weightIdx], texcoords, &meshData, vertexData, boneMap, weights, weightIdx);
-                        }
+                        Vertex_t::ParseVerticesFromVG(meshVertexData->GetVertices(), meshVertexData->GetWeights(), meshData.texcoordCount > 1 ? meshVertexData->GetTexcoords() : nullptr, &meshData, rawVertexData, boneMap, weights, weightIdx);
                         meshData.weightsCount = weightIdx;
                         meshVertexData->AddWeights(nullptr, meshData.weightsCount);
 
@@ -701,14 +695,14 @@ static void ParseModelVertexData_v14(CPakAsset* const asset, ModelAsset* const m
     parsedData->meshVertexData.shrink();
 }
 
-static void ParseModelVertexData_v16(CPakAsset* const asset, ModelAsset* const modelAsset)
+static void ParseModelVertexData_v16(ModelAsset* const modelAsset, const ModelVertexSource_t& source)
 {
-    const std::unique_ptr<char[]> pStreamed = modelAsset->vertexStreamingData.size > 0 ? asset->getStarPakData(modelAsset->vertexStreamingData.offset, modelAsset->vertexStreamingData.size, false) : nullptr; // probably smarter to check the size inside getStarPakData but whatever!
-    char* const pDataBuffer = pStreamed.get() ? pStreamed.get() : modelAsset->staticStreamingData;
+    const std::unique_ptr<char[]>& pStreamed = source.streamed;
+    char* const pDataBuffer = source.data;
 
     if (!pDataBuffer)
     {
-        Log("%s loaded with no vertex data\n", modelAsset->name);
+        LOG_WARN(MODEL, "%s loaded with no vertex data\n", modelAsset->name);
         return;
     }
 
@@ -754,6 +748,12 @@ static void ParseModelVertexData_v16(CPakAsset* const asset, ModelAsset* const m
             break;
         }
 
+        if (!dcmpBuf)
+        {
+            LOG_WARN(MODEL, "%s has a corrupt vertex group (%i)\n", modelAsset->name, groupIdx);
+            return;
+        }
+
         const vg::rev4::VertexGroupHeader_t* grouphdr = reinterpret_cast<vg::rev4::VertexGroupHeader_t*>(dcmpBuf.get());
 
         uint8_t lodIdx = 0;
@@ -847,12 +847,7 @@ static void ParseModelVertexData_v16(CPakAsset* const asset, ModelAsset* const m
                         meshVertexData->AddWeights(nullptr, 0);
 
                         int weightIdx = 0;
-                        for (unsigned int vertIdx = 0; vertIdx < mesh->vertCount; ++vertIdx)
-                        {
-                            char* const vertexData = rawVertexData + (vertIdx * mesh->vertCacheSize);
-                            Vector2D* const texcoords = meshData.texcoordCount > 1 ? &meshVertexData->GetTexcoords()[vertIdx * (meshData.texcoordCount - 1)] : nullptr;
-                            Vertex_t::ParseVertexFromVG(&meshVertexData->GetVertices()[vertIdx], &meshVertexData->GetWeights()[weightIdx], texcoords, &meshData, vertexData, boneMap, weights, weightIdx);
-                        }
+                        Vertex_t::ParseVerticesFromVG(meshVertexData->GetVertices(), meshVertexData->GetWeights(), meshData.texcoordCount > 1 ? meshVertexData->GetTexcoords() : nullptr, &meshData, rawVertexData, boneMap, weights, weightIdx);
                         meshData.weightsCount = weightIdx;
                         meshVertexData->AddWeights(nullptr, meshData.weightsCount);
 
@@ -944,6 +939,52 @@ static void ParseModelTextureData_v16(ModelParsedData_t* const parsedData)
         parsedData->skins.emplace_back(pStudioHdr->pSkinName_V16(i), pStudioHdr->pSkinFamily(i));
 }
 
+static void GetModelVertexSource(CPakAsset* const asset, ModelAsset* const modelAsset, ModelVertexSource_t& source)
+{
+    // v8 still has the individual vertex components
+    if (modelAsset->version == eMDLVersion::VERSION_8)
+    {
+        source.data = modelAsset->vertexComponentData;
+        source.size = modelAsset->vertexComponentData ? modelAsset->componentDataSize : 0ull;
+
+        return;
+    }
+
+    source.streamed = modelAsset->vertexStreamingData.size > 0 ? asset->getStarPakData(modelAsset->vertexStreamingData.offset, modelAsset->vertexStreamingData.size, false) : nullptr; // probably smarter to check the size inside getStarPakData but whatever!
+    source.data = source.streamed.get() ? source.streamed.get() : modelAsset->staticStreamingData;
+    source.size = source.streamed.get() ? modelAsset->vertexStreamingData.size : (source.data ? modelAsset->streamingDataSize : 0ull);
+}
+
+// vertex parsing decodes and compresses every mesh, models parsed from the same data in an earlier session are restored from the model cache instead
+static void ParseModelVertexDataCached(CPakAsset* const asset, ModelAsset* const modelAsset, void(*parseFunc)(ModelAsset* const, const ModelVertexSource_t&))
+{
+    ModelVertexSource_t source = {};
+    GetModelVertexSource(asset, modelAsset, source);
+
+    // the preview keeps raw vertex data per mesh, which isn't cached
+#if !defined(ADVANCED_MODEL_PREVIEW)
+    if (source.data && source.size > 0ull)
+    {
+        ModelParsedData_t* const parsedData = modelAsset->GetParsedData();
+        const studiohdr_generic_t* const pStudioHdr = parsedData->pStudioHdr();
+
+        uint64_t contentHash = CModelCache::HashData(&modelAsset->version, sizeof(eMDLVersion), 0ull);
+        contentHash = CModelCache::HashData(pStudioHdr->baseptr, static_cast<size_t>(pStudioHdr->length), contentHash);
+        contentHash = CModelCache::HashData(source.data, source.size, contentHash);
+
+        if (g_modelCache.Restore(asset->GetAssetGUID(), contentHash, parsedData))
+            return;
+
+        parseFunc(modelAsset, source);
+        g_modelCache.Add(asset->GetAssetGUID(), contentHash, parsedData);
+
+        return;
+    }
+#endif // #if !defined(ADVANCED_MODEL_PREVIEW)
+
+    parseFunc(modelAsset, source);
+}
+
 void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
 {
     UNUSED(pak);
@@ -965,7 +1006,7 @@ void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
         ParseModelAttachmentData_v8(mdlAsset->GetParsedData());
         ParseModelHitboxData_v8(mdlAsset->GetParsedData());
         ParseModelTextureData_v8(mdlAsset->GetParsedData());
-        ParseModelVertexData_v8(pakAsset, mdlAsset);
+        ParseModelVertexDataCached(pakAsset, mdlAsset, ParseModelVertexData_v8);
         ParseModelAnimTypes_V8(mdlAsset->GetParsedData());
         break;
     }
@@ -981,7 +1022,7 @@ void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
         ParseModelAttachmentData_v8(mdlAsset->GetParsedData());
         ParseModelHitboxData_v8(mdlAsset->GetParsedData());
         ParseModelTextureData_v8(mdlAsset->GetParsedData());
-        ParseModelVertexData_v9(pakAsset, mdlAsset);
+        ParseModelVertexDataCached(pakAsset, mdlAsset, ParseModelVertexData_v9);
         ParseModelAnimTypes_V8(mdlAsset->GetParsedData());
         break;
     }
@@ -998,7 +1039,7 @@ void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
         ParseModelAttachmentData_v8(mdlAsset->GetParsedData());
         ParseModelHitboxData_v8(mdlAsset->GetParsedData());
         ParseModelTextureData_v8(mdlAsset->GetParsedData());
-        ParseModelVertexData_v12_1(pakAsset, mdlAsset);
+        ParseModelVertexDataCached(pakAsset, mdlAsset, ParseModelVertexData_v12_1);
         ParseModelAnimTypes_V8(mdlAsset->GetParsedData());
         break;
     }
@@ -1012,7 +1053,7 @@ void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
         ParseModelAttachmentData_v8(mdlAsset->GetParsedData());
         ParseModelHitboxData_v8(mdlAsset->GetParsedData());
         ParseModelTextureData_v8(mdlAsset->GetParsedData());
-        ParseModelVertexData_v12_1(pakAsset, mdlAsset);
+        ParseModelVertexDataCached(pakAsset, mdlAsset, ParseModelVertexData_v12_1);
         ParseModelAnimTypes_V8(mdlAsset->GetParsedData());
         break;
     }
@@ -1027,7 +1068,7 @@ void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
         ParseModelAttachmentData_v8(mdlAsset->GetParsedData());
         ParseModelHitboxData_v8(mdlAsset->GetParsedData());
         ParseModelTextureData_v8(mdlAsset->GetParsedData());
-        ParseModelVertexData_v14(pakAsset, mdlAsset);
+        ParseModelVertexDataCached(pakAsset, mdlAsset, ParseModelVertexData_v14);
         ParseModelAnimTypes_V8(mdlAsset->GetParsedData());
         break;
     }
@@ -1042,7 +1083,7 @@ void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
         ParseModelAttachmentData_v16(mdlAsset->GetParsedData());
         ParseModelHitboxData_v16(mdlAsset->GetParsedData());
         ParseModelTextureData_v16(mdlAsset->GetParsedData());
-        ParseModelVertexData_v16(pakAsset, mdlAsset);
+        ParseModelVertexDataCached(pakAsset, mdlAsset, ParseModelVertexData_v16);
         ParseModelAnimTypes_V16(mdlAsset->GetParsedData());
         break;
     }
@@ -1056,7 +1097,7 @@ void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
         ParseModelAttachmentData_v16(mdlAsset->GetParsedData());
         ParseModelHitboxData_v16(mdlAsset->GetParsedData());
         ParseModelTextureData_v16(mdlAsset->GetParsedData());
-        ParseModelVertexData_v16(pakAsset, mdlAsset);
+        ParseModelVertexDataCached(pakAsset, mdlAsset, ParseModelVertexData_v16);
         ParseModelAnimTypes_V16(mdlAsset->GetParsedData());
         break;
     }
@@ -1071,7 +1112,7 @@ void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
         ParseModelAttachmentData_v16(mdlAsset->GetParsedData());
         ParseModelHitboxData_v16(mdlAsset->GetParsedData());
         ParseModelTextureData_v16(mdlAsset->GetParsedData());
-        ParseModelVertexData_v16(pakAsset, mdlAsset);
+        ParseModelVertexDataCached(pakAsset, mdlAsset, ParseModelVertexData_v16);
         ParseModelAnimTypes_V16(mdlAsset->GetParsedData());
         break;
     }
@@ -1314,6 +1355,8 @@ static bool ExportModelStreamedData(const ModelAsset* const modelAsset, std::fil
 
                 size_t dataSizeDecompressed = group.dataSizeDecompressed;
                 dcmpBuf = RTech::DecompressStreamedBuffer(std::move(dcmpBuf), dataSizeDecompressed, group.dataCompression);
+                if (!dcmpBuf)
+                    return false;
 
                 memcpy_s(pPos, group.dataSizeDecompressed, dcmpBuf.get(), group.dataSizeDecompressed);
 
@@ -1598,14 +1641,18 @@ bool ExportModelAsset(CAsset* const asset, const int setting)
         auto aseqAssetBinding = g_assetData.m_assetTypeBindings.find('qesa');
         assertm(aseqAssetBinding != g_assetData.m_assetTypeBindings.end(), "Unable to find asset type binding for \"aseq\" assets");
 
-        for (int i = 0; i < parsedData->NumLocalSeq(); i++)
+        const int seqSetting = aseqAssetBinding->second.e.exportSetting;
+        const SeqExportSkeleton_t skeleton(modelAsset->GetRig());
+
+        ExportSequencesParallel(static_cast<uint32_t>(parsedData->NumLocalSeq()), [parsedData, &outputPath, seqSetting, &skeleton](const uint32_t seqIdx, SeqExportScratch_t& scratch)
         {
-            const seqdesc_t* const seqdesc = parsedData->LocalSeq(i);
+            const seqdesc_t* const seqdesc = parsedData->LocalSeq(static_cast<int>(seqIdx));
 
-            outputPath.replace_filename(seqdesc->szlabel);
+            std::filesystem::path seqPath(outputPath);
+            seqPath.replace_filename(seqdesc->szlabel);
 
-            ExportSeqDesc(aseqAssetBinding->second.e.exportSetting, seqdesc, outputPath, modelAsset->name, modelAsset->GetRig(), RTech::StringToGuid(seqdesc->szlabel));
-        }
+            ExportSeqDesc(seqSetting, seqdesc, seqPath, skeleton, scratch, RTech::StringToGuid(seqdesc->szlabel));
+        });
     }
 
     exportPath.append(std::format("{}.rmdl", modelStem));
@@ -1659,6 +1706,15 @@ bool ExportModelAsset(CAsset* const asset, const int setting)
     unreachable();
 }
 
+static void ReleaseRefsModelAsset(CAsset* const asset)
+{
+    CPakAsset* const pakAsset = static_cast<CPakAsset*>(asset);
+
+    ModelAsset* const modelAsset = reinterpret_cast<ModelAsset*>(pakAsset->extraData());
+    if (modelAsset)
+        ReleaseModelMaterialRefs(&modelAsset->parsedData);
+}
+
 void InitModelAssetType()
 {
     AssetTypeBinding_t type =
@@ -1669,6 +1725,7 @@ void InitModelAssetType()
         .postLoadFunc = PostLoadModelAsset,
         .previewFunc = PreviewModelAsset,
         .e = { ExportModelAsset, 0, s_ModelExportSettingNames, ARRSIZE(s_ModelExportSettingNames) },
+        .releaseRefsFunc = ReleaseRefsModelAsset,
     };
 
     REGISTER_TYPE(type);
@@ -1,6 +1,7 @@
 #include <pch.h>
 #include <game/rtech/assets/rson.h>
 #include <game/rtech/cpakfile.h>
+#include <core/ui/previewtable.h>
 #include <thirdparty/imgui/imgui.h>
 
 extern ExportSettings_t g_ExportSettings;
@@ -45,20 +46,37 @@ void PostLoadRSONAsset(CAssetContainer* const container, CAsset* const asset)
 
 void* PreviewRSONAsset(CAsset* const asset, const bool firstFrameForAsset)
 {
-    UNUSED(firstFrameForAsset);
-
 	CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
 
     const RSONAsset* const rsonAsset = reinterpret_cast<RSONAsset*>(pakAsset->extraData());
     assertm(rsonAsset, "Extra data should be valid at this point.");
 
-    ImGui::Text("Root node type: 0x%x", rsonAsset->type);
+    // one row per line so only the lines in view are drawn
+    static CPreviewTable previewTable;
 
-    if (ImGui::BeginChild("RSON Preview", ImVec2(-1, -1), true, ImGuiWindowFlags_HorizontalScrollbar))
+    if (firstFrameForAsset)
     {
-        ImGui::TextUnformatted(rsonAsset->rawText.c_str());
+        const std::string_view text(rsonAsset->rawText);
+
+        previewTable.Reset(static_cast<size_t>(std::ranges::count(text, '\n')) + 1);
+        previewTable.AddColumn("Line", ePreviewColumnSort::NONE);
+        previewTable.AddColumn("Text", ePreviewColumnSort::NONE);
+
+        size_t lineStart = 0ull;
+        for (size_t line = 1; lineStart < text.length(); line++)
+        {
+            const size_t lineEnd = std::min(text.find('\n', lineStart), text.length());
+
+            previewTable.AddCellFormat(0.0, "{}", line);
+            previewTable.AddCell(text.data() + lineStart, lineEnd - lineStart);
+
+            lineStart = lineEnd + 1;
+        }
     }
-    ImGui::EndChild();
+
+    ImGui::Text("Root node type: 0x%x", rsonAsset->type);
+
+    previewTable.Draw("RSON Preview", ImVec2(0.f, 0.f));
 
     return nullptr;
 }
@@ -294,7 +294,7 @@ bool ExportSettingsAsset(CAsset* const asset, const int setting)
 
 	CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
 
-	printf("Exporting settings asset \"%s\"\n", asset->GetAssetName().c_str());
+	LOG_DEBUG(EXPORT, "Exporting settings asset \"%s\"\n", asset->GetAssetName().data());
 
 	std::string stringStream;
 
@@ -344,6 +344,15 @@ static void* PreviewSettingsAsset(CAsset* const asset, const bool firstFrameForA
 	return nullptr;
 }
 
+static void ReleaseRefsSettingsAsset(CAsset* const asset)
+{
+	CPakAsset* const pakAsset = static_cast<CPakAsset*>(asset);
+
+	SettingsAsset* const settingsAsset = reinterpret_cast<SettingsAsset*>(pakAsset->extraData());
+	if (settingsAsset && g_assetData.IsUnloading(settingsAsset->layoutAsset))
+		settingsAsset->layoutAsset = nullptr;
+}
+
 void InitSettingsAssetType()
 {
 	AssetTypeBinding_t type =
@@ -354,6 +363,7 @@ void InitSettingsAssetType()
 		.postLoadFunc = PostLoadSettingsAsset,
 		.previewFunc = PreviewSettingsAsset,
 		.e = { ExportSettingsAsset, 0, nullptr, 0ull },
+		.releaseRefsFunc = ReleaseRefsSettingsAsset,
 	};
 
 	REGISTER_TYPE(type);
@@ -4,6 +4,7 @@
 #include <game/rtech/utils/utils.h>
 
 #include <imgui.h>
+#include <thirdparty/zstd/common/xxhash.h>
 
 extern CDXParentHandler* g_dxHandler;
 
@@ -273,7 +274,7 @@ ID3D11InputLayout* Shader_CreateInputLayoutFromFlags(const uint64_t inputFlags,
 
 	if (FAILED(hr))
 	{
-		Log("Failed to create input layout for flags %016llX\n", inputFlags);
+		LOG_ERROR(SHADER, "Failed to create input layout for flags %016llX\n", inputFlags);
 		return nullptr;
 	}
 	return inputLayout;
@@ -369,7 +370,7 @@ void PostLoadShaderAsset(CAssetContainer* const pak, CAsset* const asset)
 					// shdr->shaderInstances[v12] = shdr->shaderInstances[2 * ~bytecodeLen];
 					// add ref with "shdr->shaderInstances[v12]->AddRef();" if operator= doesn't catch it.
 
-					//Log("%s shader %i is a ref. %i %i\n", asset->name().c_str(), i, bufferLen, ~bufferLen);
+					//LOG_DEBUG(SHADER, "%s shader %i is a ref. %i %i\n", asset->name().c_str(), i, bufferLen, ~bufferLen);
 				}
 				else
 				{
@@ -419,6 +420,15 @@ void PostLoadShaderAsset(CAssetContainer* const pak, CAsset* const asset)
 
 	}
 
+	// no device when running headless, shader objects are only needed for preview
+	if (!g_dxHandler)
+	{
+		if (!shaderAsset->name)
+			pakAsset->SetAssetNameFromCache();
+
+		return;
+	}
+
 	// Always create D3D11 shader objects for better material rendering (not just with ADVANCED_MODEL_PREVIEW)
 	HRESULT hr = E_INVALIDARG;
 
@@ -461,7 +471,7 @@ void PostLoadShaderAsset(CAssetContainer* const pak, CAsset* const asset)
 
 	if (FAILED(hr))
 	{
-		Log("failed to create %s shader for asset %s (0x%08X)\n", GetShaderTypeName(shaderAsset->type), asset->GetAssetName().c_str(), hr);
+		LOG_ERROR(SHADER, "failed to create %s shader for asset %s (0x%08X)\n", GetShaderTypeName(shaderAsset->type), asset->GetAssetName().data(), hr);
 	}
 
 	if(!shaderAsset->name)
@@ -518,12 +528,21 @@ enum eShaderAssetExportSetting
 {
 	Raw,
 	MSW, // MultiShaderWrapper
+	RawDeduplicated, // raw bytecode in a shared content addressed directory, referenced by the json
 };
 
-static void ExportShaderMetaData(const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath)
+// bytecode blobs referenced by a deduplicated export
+struct ShaderBlobManifest_t
+{
+	std::string blobDirectory; // relative to the json
+	std::vector<std::pair<int, std::string>> blobs; // shader index, blob file name
+};
+
+static void ExportShaderMetaData(const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath, const ShaderBlobManifest_t* const blobManifest = nullptr)
 {
 	exportPath.replace_extension(".json");
 	std::ofstream ofs(exportPath, std::ios::out);
+	CWrittenFileTracker::Record(exportPath);
 
 	ofs << "{\n";
 
@@ -574,7 +593,26 @@ static void ExportShaderMetaData(const ShaderAsset* const shaderAsset, std::file
 		i++;
 	}
 
-	ofs << "\t]\n";
+	if (!blobManifest)
+	{
+		ofs << "\t]\n";
+		ofs << "}\n";
+
+		return;
+	}
+
+	// one line per blob, ReconstructShaderExports reads these back
+	ofs << "\t],\n";
+	ofs << "\t\"blobDirectory\": \"" << blobManifest->blobDirectory << "\",\n";
+	ofs << "\t\"blobs\": {\n";
+
+	for (size_t blobIdx = 0; blobIdx < blobManifest->blobs.size(); blobIdx++)
+	{
+		const char* const commaChar = blobIdx != (blobManifest->blobs.size() - 1) ? "," : "";
+		ofs << "\t\t\"" << std::dec << blobManifest->blobs.at(blobIdx).first << "\": \"" << blobManifest->blobs.at(blobIdx).second << "\"" << commaChar << "\n";
+	}
+
+	ofs << "\t}\n";
 	ofs << "}\n";
 }
 
@@ -599,6 +637,174 @@ bool ExportRawShaderAsset(const ShaderAsset* const shaderAsset, std::filesystem:
 	return true;
 }
 
+// permutations are shared between shaders and paks, each distinct blob is written once per export directory
+static std::mutex s_shaderBlobMutex;
+static std::unordered_set<std::string> s_shaderBlobsWritten; // blob paths written this session
+static ShaderBlobStats_t s_shaderBlobStats;
+
+const ShaderBlobStats_t GetShaderBlobStats()
+{
+	std::lock_guard lock(s_shaderBlobMutex);
+	return s_shaderBlobStats;
+}
+
+bool ExportDeduplicatedShaderAsset(const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath, const std::filesystem::path& blobDirectory)
+{
+	if (!CreateDirectories(blobDirectory))
+	{
+		assertm(false, "Failed to create shader blob directory.");
+		return false;
+	}
+
+	ShaderBlobManifest_t blobManifest;
+	blobManifest.blobDirectory = std::filesystem::relative(blobDirectory, exportPath.parent_path()).generic_string();
+
+	for (auto& buf : shaderAsset->shaderBuffers)
+	{
+		if (!buf.buffer || buf.bufferSize <= 0)
+			continue;
+
+		// size in the name as well, a 64 bit hash alone is a bit thin for this many blobs
+		const uint64_t hash = XXH64(buf.buffer, static_cast<size_t>(buf.bufferSize), 0ull);
+		std::string blobName = std::format("{:016X}{:08X}.fxc", hash, buf.bufferSize);
+
+		const std::filesystem::path blobPath = blobDirectory / blobName;
+
+		bool writeBlob = false;
+
+		{
+			std::lock_guard lock(s_shaderBlobMutex);
+
+			s_shaderBlobStats.blobs++;
+			s_shaderBlobStats.bytes += buf.bufferSize;
+
+			// blobs from an earlier export into the same directory count as written
+			if (s_shaderBlobsWritten.insert(blobPath.string()).second)
+			{
+				std::error_code ec;
+				writeBlob = std::filesystem::file_size(blobPath, ec) != static_cast<uintmax_t>(buf.bufferSize) || ec;
+			}
+
+			if (writeBlob)
+			{
+				s_shaderBlobStats.blobsWritten++;
+				s_shaderBlobStats.bytesWritten += buf.bufferSize;
+			}
+		}
+
+		if (writeBlob)
+		{
+			StreamIO out(blobPath, eStreamIOMode::Write);
+			out.write(buf.buffer, buf.bufferSize);
+		}
+
+		blobManifest.blobs.emplace_back(buf.shaderIdx, std::move(blobName));
+	}
+
+	ExportShaderMetaData(shaderAsset, exportPath, &blobManifest);
+
+	return true;
+}
+
+// reads a line of the form "key": "value" (the value quotes are optional)
+static const bool ParseShaderManifestLine(const std::string& line, std::string& key, std::string& value)
+{
+	const size_t keyStart = line.find('"');
+	const size_t keyEnd = keyStart != std::string::npos ? line.find('"', keyStart + 1) : std::string::npos;
+	const size_t colon = keyEnd != std::string::npos ? line.find(':', keyEnd) : std::string::npos;
+
+	if (colon == std::string::npos)
+		return false;
+
+	key = line.substr(keyStart + 1, keyEnd - keyStart - 1);
+
+	const size_t valueStart = line.find('"', colon);
+	const size_t valueEnd = valueStart != std::string::npos ? line.find('"', valueStart + 1) : std::string::npos;
+
+	value = valueEnd != std::string::npos ? line.substr(valueStart + 1, valueEnd - valueStart - 1) : std::string();
+	return true;
+}
+
+const bool ReconstructShaderExports(const std::filesystem::path& directory, uint32_t& rebuiltShaders, uint32_t& failedShaders)
+{
+	rebuiltShaders = 0u;
+	failedShaders = 0u;
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(directory, ec))
+		return false;
+
+	for (const std::filesystem::directory_entry& file : std::filesystem::recursive_directory_iterator(directory, ec))
+	{
+		if (!file.is_regular_file() || file.path().extension() != ".json")
+			continue;
+
+		std::ifstream ifs(file.path(), std::ios::in);
+
+		std::string blobDirectory;
+		std::vector<std::pair<std::string, std::string>> blobs;
+
+		bool inBlobs = false;
+		std::string line, key, value;
+		while (std::getline(ifs, line))
+		{
+			if (inBlobs)
+			{
+				if (line.find('}') != std::string::npos)
+					break;
+
+				if (ParseShaderManifestLine(line, key, value))
+					blobs.emplace_back(key, value);
+
+				continue;
+			}
+
+			if (!ParseShaderManifestLine(line, key, value))
+				continue;
+
+			if (key == "blobDirectory")
+				blobDirectory = value;
+			else if (key == "blobs")
+				inBlobs = true;
+		}
+
+		// plain shader json, or some other json in the directory
+		if (!inBlobs)
+			continue;
+
+		const std::string fileStem = file.path().stem().string();
+		const std::filesystem::path blobPath = file.path().parent_path() / blobDirectory;
+
+		bool failed = false;
+		for (const auto& blob : blobs)
+		{
+			const uintmax_t blobSize = std::filesystem::file_size(blobPath / blob.second, ec);
+
+			std::shared_ptr<char[]> blobData;
+			if (ec || !FileSystem::ReadFileData((blobPath / blob.second).string(), &blobData))
+			{
+				LOG_WARN(SHADER, "SHDR: Missing blob \"%s\" for shader \"%s\"\n", blob.second.c_str(), file.path().string().c_str());
+				failed = true;
+
+				continue;
+			}
+
+			std::filesystem::path exportPath = file.path();
+			exportPath.replace_filename(std::format("{}_{}.fxc", fileStem, blob.first));
+
+			StreamIO out(exportPath, eStreamIOMode::Write);
+			out.write(blobData.get(), static_cast<size_t>(blobSize));
+		}
+
+		if (failed)
+			++failedShaders;
+		else
+			++rebuiltShaders;
+	}
+
+	return true;
+}
+
 #include <core/shaderexp/multishader.h>
 
 void ConstructMSWShader(CMultiShaderWrapperIO::Shader_t& shader, const ShaderAsset* const shaderAsset)
@@ -612,7 +818,7 @@ void ConstructMSWShader(CMultiShaderWrapperIO::Shader_t& shader, const ShaderAss
 	size_t i = 0;
 	for (auto& buf : shaderAsset->shaderBuffers)
 	{
-		//Log("%i = %p %i\n", i, buf.buffer, buf.bufferSize);
+		//LOG_DEBUG(SHADER, "%i = %p %i\n", i, buf.buffer, buf.bufferSize);
 
 		const uint64_t inputFlags1 = shaderAsset->inputFlags[i];
 		const uint64_t inputFlags2 = shaderAsset->inputFlags[i + 1];
@@ -656,7 +862,11 @@ bool ExportMSWShaderAsset(const ShaderAsset* const shaderAsset, std::filesystem:
 	ConstructMSWShader(shader, shaderAsset);
 
 	writer.SetShader(&shader);
-	return writer.WriteFile(exportPath.string().c_str());
+	if (!writer.WriteFile(exportPath.string().c_str()))
+		return false;
+
+	CWrittenFileTracker::Record(exportPath);
+	return true;
 }
 
 static const char* const s_PathPrefixSHDR = s_AssetTypePaths.find(AssetType_t::SHDR)->second;
@@ -670,12 +880,13 @@ bool ExportShaderAsset(CAsset* const asset, const int setting)
 	// shaders with no data/invalid type need to be skipped until we properly handle them
 	if (shaderAsset->type >= eShaderType::Invalid)
 	{
-		Log("Tried to export %s with invalid shader type, skipping...\n");
+		LOG_WARN(SHADER, "Tried to export %s with invalid shader type, skipping...\n", asset->GetAssetName().data());
 		return false;
 	}
 
 	// Create exported path + asset path.
-	std::filesystem::path exportPath = std::filesystem::current_path().append(EXPORT_DIRECTORY_NAME);
+	const std::filesystem::path exportRoot = std::filesystem::current_path().append(EXPORT_DIRECTORY_NAME);
+	std::filesystem::path exportPath = exportRoot;
 	const std::filesystem::path shaderPath(asset->GetAssetName());
 
 	if (g_ExportSettings.exportPathsFull)
@@ -703,6 +914,14 @@ bool ExportShaderAsset(CAsset* const asset, const int setting)
 		// NOTE: this func changes the value of exportPath!!
 		return ExportMSWShaderAsset(shaderAsset, exportPath);
 	}
+	case eShaderAssetExportSetting::RawDeduplicated:
+	{
+		// shared by every shader, regardless of the path setting, under the same export root as the json
+		const std::filesystem::path blobDirectory = exportRoot / s_PathPrefixSHDR / "_blobs";
+
+		// NOTE: this func changes the value of exportPath!!
+		return ExportDeduplicatedShaderAsset(shaderAsset, exportPath, blobDirectory);
+	}
 	default:
 	{
 		assertm(false, "Export setting is not handled.");
@@ -715,7 +934,7 @@ bool ExportShaderAsset(CAsset* const asset, const int setting)
 
 void InitShaderAssetType()
 {
-	static const char* settings[] = { "Raw", "MSW" };
+	static const char* settings[] = { "Raw", "MSW", "Raw (Deduplicated)" };
 	AssetTypeBinding_t type =
 	{
 		.type = 'rdhs',
@@ -729,20 +948,17 @@ void InitShaderAssetType()
 	REGISTER_TYPE(type);
 }
 
-std::map<uint32_t, ShaderResource> ResourceBindingFromDXBlob(CPakAsset* const asset, D3D_SHADER_INPUT_TYPE inputType)
+static std::shared_ptr<const ShaderReflection_t> ParseShaderReflection(const ShaderAsset* const shaderAsset)
 {
-	const ShaderAsset* const shaderAsset = reinterpret_cast<ShaderAsset*>(asset->extraData());
-	assertm(shaderAsset, "Extra asset data should be valid at this point.");
-
-	std::map<uint32_t, ShaderResource> bindings;
+	std::shared_ptr<ShaderReflection_t> reflection = std::make_shared<ShaderReflection_t>();
 
 	if (!shaderAsset->data)
-		return bindings;
+		return reflection;
 
 	const DXBCHeader* const hdr = reinterpret_cast<DXBCHeader*>(shaderAsset->data);
 
 	if (!hdr->isValid())
-		return bindings;
+		return reflection;
 
 	for (uint32_t blobIdx = 0; blobIdx < hdr->BlobCount; blobIdx++)
 	{
@@ -755,62 +971,67 @@ std::map<uint32_t, ShaderResource> ResourceBindingFromDXBlob(CPakAsset* const as
 		for (uint32_t resIdx = 0; resIdx < rdefBlob->BoundResourceCount; resIdx++)
 		{
 			RDEFResourceBinding* resource = rdefBlob->pBoundResource(resIdx);
-			if (resource->Type != inputType)
-				continue;
 
-			const ShaderResource tmp(resource->Name(rdefBlob), *resource);
-			bindings.emplace(resource->BindPoint, tmp);
+			const ShaderResource tmp(reflection->KeepName(resource->Name(rdefBlob)), *resource);
+			reflection->bindings[resource->Type].emplace(resource->BindPoint, tmp);
 		}
 
-		break;
-	}
-
-	return bindings;
-}
-
-std::vector<TmpConstBufVar> ConstBufVarFromDXBlob(CPakAsset* const asset, const char* constBufName)
-{
-	const ShaderAsset* const shaderAsset = reinterpret_cast<ShaderAsset*>(asset->extraData());
-	assertm(shaderAsset, "Extra asset data should be valid at this point.");
-
-	std::vector<TmpConstBufVar> vars;
-
-	if (!shaderAsset->data)
-		return vars;
-
-	const DXBCHeader* const hdr = reinterpret_cast<DXBCHeader*>(shaderAsset->data);
-
-	if (!hdr->isValid())
-		return vars;
-
-	for (uint32_t blobIdx = 0; blobIdx < hdr->BlobCount; blobIdx++)
-	{
-		const DXBCBlobHeader* const blob = hdr->pBlob(blobIdx);
-
-		if (!blob->isRDEF())
-			continue;
-
-		RDEFBlobHeader* rdefBlob = blob->pRDEFBlob();
+		reflection->constBuffers.reserve(rdefBlob->ConstBufferCount);
 		for (uint32_t constBufIdx = 0; constBufIdx < rdefBlob->ConstBufferCount; constBufIdx++)
 		{
 			const RDefConstBuffer* const constBuf = rdefBlob->pConstBuffer(constBufIdx);
-			if (strncmp(constBufName, constBuf->Name(rdefBlob), 64))
-				continue;
+
+			ShaderConstBuffer_t& buffer = reflection->constBuffers.emplace_back(ShaderConstBuffer_t{ reflection->KeepName(constBuf->Name(rdefBlob)), {} });
+			buffer.vars.reserve(constBuf->ConstCount);
 
 			for (uint32_t constIdx = 0; constIdx < constBuf->ConstCount; constIdx++)
 			{
 				const RDEFConst* const constVar = constBuf->pConst(rdefBlob, constIdx);
 				const RDEFType* const constType = constVar->pType(rdefBlob);
 
-				const TmpConstBufVar tmp(constVar->Name(rdefBlob), static_cast<D3D_SHADER_VARIABLE_TYPE>(constType->Type), constVar->Size);
-				vars.push_back(tmp);
+				buffer.vars.emplace_back(reflection->KeepName(constVar->Name(rdefBlob)), static_cast<D3D_SHADER_VARIABLE_TYPE>(constType->Type), constVar->Size);
 			}
-
-			break;
 		}
 
 		break;
 	}
 
-	return vars;
-}
\ No newline at end of file
+	return reflection;
+}
+
+const std::shared_ptr<const ShaderReflection_t>& GetShaderReflection(CPakAsset* const asset)
+{
+	ShaderAsset* const shaderAsset = reinterpret_cast<ShaderAsset*>(asset->extraData());
+	assertm(shaderAsset, "Extra asset data should be valid at this point.");
+
+	// materials sharing a shader post load in parallel, only the first one parses
+	std::call_once(shaderAsset->reflectionOnce, [shaderAsset]() { shaderAsset->reflection = ParseShaderReflection(shaderAsset); });
+
+	return shaderAsset->reflection;
+}
+
+const std::map<uint32_t, ShaderResource>& ShaderReflection_t::Bindings(const D3D_SHADER_INPUT_TYPE inputType) const
+{
+	static const std::map<uint32_t, ShaderResource> s_emptyBindings;
+
+	const auto it = bindings.find(inputType);
+	return it != bindings.end() ? it->second : s_emptyBindings;
+}
+
+const std::vector<TmpConstBufVar>& ShaderReflection_t::ConstBufVars(const char* const constBufName) const
+{
+	static const std::vector<TmpConstBufVar> s_emptyVars;
+
+	for (const ShaderConstBuffer_t& buffer : constBuffers)
+	{
+		if (!strncmp(constBufName, buffer.name, 64))
+			return buffer.vars;
+	}
+
+	return s_emptyVars;
+}
+
+const char* const ShaderReflection_t::KeepName(const char* const name)
+{
+	return names.emplace_back(name ? name : "").c_str();
+}
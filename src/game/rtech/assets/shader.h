@@ -1,5 +1,6 @@
 #pragma once
 #include <d3d11.h>
+#include <deque>
 #include "core/render/dx.h"
 
 struct ShaderAssetHeader_v8_t
@@ -105,6 +106,8 @@ struct ShaderBufEntry_t
     bool isRef : 1;
 };
 
+struct ShaderReflection_t;
+
 class ShaderAsset
 {
 public:
@@ -269,6 +272,10 @@ public:
 
     std::vector<ShaderBufEntry_t> shaderBuffers;
     std::vector<std::string> compilerStrings;
+
+    // parsed from the rdef on first use, see GetShaderReflection
+    std::once_flag reflectionOnce;
+    std::shared_ptr<const ShaderReflection_t> reflection;
 };
 
 // dxbc
@@ -420,7 +427,47 @@ struct TmpConstBufVar
     uint32_t size;
 };
 
+struct ShaderConstBuffer_t
+{
+    const char* name;
+    std::vector<TmpConstBufVar> vars;
+};
+
+// every bound resource and constant buffer of a shader, read from the rdef once and shared by everything using the shader
+// names point into the reflection's own copies, materials keep it after the shader's pak is unloaded
+struct ShaderReflection_t
+{
+    std::map<D3D_SHADER_INPUT_TYPE, std::map<uint32_t, ShaderResource>> bindings; // by bind point, bind points are per resource type
+    std::vector<ShaderConstBuffer_t> constBuffers;
+
+    std::deque<std::string> names; // deque so the names handed out don't move as more are added
+
+    const char* const KeepName(const char* const name);
+
+    const std::map<uint32_t, ShaderResource>& Bindings(const D3D_SHADER_INPUT_TYPE inputType) const;
+    const std::vector<TmpConstBufVar>& ConstBufVars(const char* const constBufName) const;
+};
+
 class CPakAsset; // hate u
 
-std::map<uint32_t, ShaderResource> ResourceBindingFromDXBlob(CPakAsset* const asset, D3D_SHADER_INPUT_TYPE inputType);
-std::vector<TmpConstBufVar> ConstBufVarFromDXBlob(CPakAsset* const asset, const char* constBufName);
\ No newline at end of file
+struct ShaderBlobStats_t
+{
+    uint64_t blobs; // bytecode blobs exported with deduplication
+    uint64_t blobsWritten; // distinct blobs, the ones actually written
+    uint64_t bytes;
+    uint64_t bytesWritten;
+};
+
+const ShaderBlobStats_t GetShaderBlobStats();
+
+// NOTE: both change exportPath to the json they wrote
+bool ExportRawShaderAsset(const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath);
+// each distinct bytecode blob is written once to blobDirectory, the json references it there
+bool ExportDeduplicatedShaderAsset(const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath, const std::filesystem::path& blobDirectory);
+
+// writes the bytecode of every deduplicated shader json found under directory back out next to it, as the raw export would
+// returns false if directory doesn't exist
+const bool ReconstructShaderExports(const std::filesystem::path& directory, uint32_t& rebuiltShaders, uint32_t& failedShaders);
+
+// parses the shader's reflection on the first call, safe to call from multiple threads
+const std::shared_ptr<const ShaderReflection_t>& GetShaderReflection(CPakAsset* const asset);
\ No newline at end of file
@@ -100,10 +100,10 @@ void PostLoadShaderSetAsset(CAssetContainer* const pak, CAsset* const asset)
 		pakAsset->SetAssetNameFromCache();
 
 	//if (shdsAsset->vertexShader && !shdsAsset->vertexShaderAsset)
-	//	Log("Shaderset has vertex shader but it is not loaded.\n");
+	//	LOG_WARN(SHADER, "Shaderset has vertex shader but it is not loaded.\n");
 
 	//if (shdsAsset->pixelShader && !shdsAsset->pixelShader)
-	//	Log("Shaderset has pixel shader but it is not loaded.\n");
+	//	LOG_WARN(SHADER, "Shaderset has pixel shader but it is not loaded.\n");
 }
 
 void* PreviewShaderSetAsset(CAsset* const asset, const bool firstFrameForAsset)
@@ -201,7 +201,11 @@ static bool ExportMSWShaderSetAsset(const ShaderSetAsset* const shaderSetAsset,
 		shaderSetAsset->numPixelShaderTextures, shaderSetAsset->numVertexShaderTextures, shaderSetAsset->numSamplers,
 		static_cast<uint8_t>(shaderSetAsset->firstResourceBindPoint), static_cast<uint8_t>(shaderSetAsset->numResources));
 
-	return writer.WriteFile(exportPath.string().c_str());
+	if (!writer.WriteFile(exportPath.string().c_str()))
+		return false;
+
+	CWrittenFileTracker::Record(exportPath);
+	return true;
 }
 
 static const char* const s_PathPrefixSHDR = s_AssetTypePaths.find(AssetType_t::SHDS)->second;
@@ -247,6 +251,21 @@ bool ExportShaderSetAsset(CAsset* const asset, const int setting)
 	unreachable();
 }
 
+static void ReleaseRefsShaderSetAsset(CAsset* const asset)
+{
+	CPakAsset* const pakAsset = static_cast<CPakAsset*>(asset);
+
+	ShaderSetAsset* const shdsAsset = reinterpret_cast<ShaderSetAsset*>(pakAsset->extraData());
+	if (!shdsAsset)
+		return;
+
+	if (g_assetData.IsUnloading(shdsAsset->vertexShaderAsset))
+		shdsAsset->vertexShaderAsset = nullptr;
+
+	if (g_assetData.IsUnloading(shdsAsset->pixelShaderAsset))
+		shdsAsset->pixelShaderAsset = nullptr;
+}
+
 void InitShaderSetAssetType()
 {
 	static const char* settings[] = { "MSW", "MSW (Packed)" };
@@ -258,6 +277,7 @@ void InitShaderSetAssetType()
 		.postLoadFunc = PostLoadShaderSetAsset,
 		.previewFunc = PreviewShaderSetAsset,
 		.e = { ExportShaderSetAsset, 0, settings, ARRSIZE(settings) },
+		.releaseRefsFunc = ReleaseRefsShaderSetAsset,
 	};
 
 	REGISTER_TYPE(type);
@@ -1,5 +1,7 @@
 #include <pch.h>
 #include <game/rtech/assets/subtitles.h>
+#include <core/utils/textexport.h>
+#include <core/ui/previewtable.h>
 
 #include <thirdparty/imgui/imgui.h>
 
@@ -90,8 +92,6 @@ void PostLoadSubtitlesAsset(CAssetContainer* const pak, CAsset* const asset)
 
 void* PreviewSubtitlesAsset(CAsset* const asset, const bool firstFrameForAsset)
 {
-	UNUSED(firstFrameForAsset);
-
 	CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
 
     assertm(asset, "Asset should be valid.");
@@ -105,53 +105,24 @@ void* PreviewSubtitlesAsset(CAsset* const asset, const bool firstFrameForAsset)
     SubtitlesAsset* const subtitlesAsset = reinterpret_cast<SubtitlesAsset*>(pakAsset->extraData());
     assertm(subtitlesAsset, "Extra data should be valid at this point.");
 
-    constexpr ImGuiTableFlags tableFlags =
-        ImGuiTableFlags_Resizable | ImGuiTableFlags_Reorderable | ImGuiTableFlags_Hideable
-        | ImGuiTableFlags_Sortable | ImGuiTableFlags_SortMulti
-        | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders
-        | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
-
-    const ImVec2 outerSize = ImVec2(0.f, ImGui::GetTextLineHeightWithSpacing() * 12.f);
+    static CPreviewTable previewTable;
 
-    if (ImGui::BeginTable("Arg Table", 2, tableFlags, outerSize))
+    if (firstFrameForAsset)
     {
-        ImGui::TableSetupColumn("Hash", ImGuiTableColumnFlags_NoResize | ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoHide, 0.0f, 0);
-        ImGui::TableSetupColumn("Subtitle", ImGuiTableColumnFlags_NoResize | ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_NoHide, 0.0f, 1);
-        ImGui::TableSetupScrollFreeze(1, 1);
-
-        //ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs(); // get the sorting settings from this table
+        previewTable.Reset(subtitlesAsset->parsed.size());
+        previewTable.AddColumn("Hash", ePreviewColumnSort::NUMBER);
+        previewTable.AddColumn("Subtitle", ePreviewColumnSort::TEXT);
 
-        ImGui::TableHeadersRow();
-
-        ImGuiListClipper clipper;
-        clipper.Begin(static_cast<int>(subtitlesAsset->parsed.size()));
-        while (clipper.Step())
+        for (const SubtitlesEntry& entry : subtitlesAsset->parsed)
         {
-            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
-            {
-                ImGui::PushID(i); 
-
-				const SubtitlesEntry& entry = subtitlesAsset->parsed.at(i);
-
-                ImGui::TableNextRow(ImGuiTableRowFlags_None, 0.0f);
-
-				ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(entry.clr.x, entry.clr.y, entry.clr.z, 1.f));
-                if (ImGui::TableSetColumnIndex(0))
-					ImGui::Text("0x%x", entry.hash);
-
-				if (ImGui::TableSetColumnIndex(1))
-					ImGui::TextUnformatted(entry.subtitle);
-
-				ImGui::PopStyleColor();
-
-                ImGui::PopID(); // no longer working on this id
-
-            }
+            previewTable.SetRowColour(ImGui::ColorConvertFloat4ToU32(ImVec4(entry.clr.x, entry.clr.y, entry.clr.z, 1.f)));
+            previewTable.AddCellFormat(static_cast<double>(entry.hash), "0x{:x}", entry.hash);
+            previewTable.AddCell(entry.subtitle);
         }
-
-        ImGui::EndTable();
     }
 
+    previewTable.Draw("Subtitle Table", ImVec2(0.f, 0.f));
+
     return nullptr;
 }
 
@@ -159,52 +130,42 @@ static bool ExportTXTSubtitlesAsset(const SubtitlesAsset* const subtitlesAsset,
 {
 	exportPath.replace_extension(".txt");
 
-	StreamIO out;
-	if (!out.open(exportPath.string(), eStreamIOMode::Write))
-	{
-		assertm(false, "Failed to open file for write.");
-		return false;
-	}
-
-	std::ofstream& stream = *out.W();
+	std::string& out = GetTextExportBuffer();
 
 	for (auto& entry : subtitlesAsset->parsed)
 	{
-		stream << entry.subtitle << "\n";
+		out.append(entry.subtitle);
+		out.append("\n");
 	}
 
-	out.close();
-
-	return true;
+	return WriteTextExportFile(exportPath, out);
 }
 
 static bool ExportCSVSubtitlesAsset(const SubtitlesAsset* const subtitlesAsset, std::filesystem::path& exportPath)
 {
 	exportPath.replace_extension(".csv");
 
-	StreamIO out;
-	if (!out.open(exportPath.string(), eStreamIOMode::Write))
-	{
-		assertm(false, "Failed to open file for write.");
-		return false;
-	}
-
-	std::ofstream& stream = *out.W();
+	std::string& out = GetTextExportBuffer();
 
 	// add header row
-	stream << "\"hash\",\"color\",\"subtitle\"\n";
-
-	char fmt[128]{};
+	out.append("\"hash\",\"color\",\"subtitle\"\n");
 
 	for (auto& entry : subtitlesAsset->parsed)
 	{
-        sprintf_s(fmt, 128, "\"%x\",\"%i,%i,%i\",\"", entry.hash, static_cast<int>(entry.clr.x), static_cast<int>(entry.clr.y), static_cast<int>(entry.clr.z));
-		stream << fmt << entry.subtitle << "\"\n";
+		out.append("\"");
+		AppendTextExportHex(out, entry.hash);
+		out.append("\",\"");
+		AppendTextExportInt(out, static_cast<int>(entry.clr.x));
+		out.append(",");
+		AppendTextExportInt(out, static_cast<int>(entry.clr.y));
+		out.append(",");
+		AppendTextExportInt(out, static_cast<int>(entry.clr.z));
+		out.append("\",\"");
+		out.append(entry.subtitle);
+		out.append("\"\n");
 	}
 
-	out.close();
-
-	return true;
+	return WriteTextExportFile(exportPath, out);
 }
 
 enum eSubtitlesExportSetting
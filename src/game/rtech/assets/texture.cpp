@@ -1,6 +1,7 @@
 #include <pch.h>
 #include <game/rtech/assets/texture.h>
 #include <core/render/dx.h>
+#include <core/cache/texturestore.h>
 #include <thirdparty/imgui/imgui.h>
 
 extern CDXParentHandler* g_dxHandler;
@@ -66,7 +67,7 @@ void LoadTextureAsset(CAssetContainer* const pak, CAsset* const asset)
 
 #ifdef _DEBUG
     if (txtrAsset->type != _UNUSED && s_TextureTypeMap.count(txtrAsset->type) == 0)
-        Log("found texture '%s' with unknown texture type: %i\n", asset->GetAssetName().c_str(), txtrAsset->type);
+        LOG_WARN(TEXTURE, "found texture '%s' with unknown texture type: %i\n", asset->GetAssetName().data(), txtrAsset->type);
 #endif // _DEBUG
 
     txtrAsset->totalMipLevels = (txtrAsset->optStreamedMipLevels + txtrAsset->streamedMipLevels + txtrAsset->permanentMipLevels);
@@ -805,6 +806,71 @@ inline void NormalRecalc(const bool isNormal, CTexture* texture)
     }
 }
 
+// seeds a texture export store key with everything besides the mip bytes that changes the exported file
+static const uint64_t TextureStoreSeed(const TextureAsset* const txtrAsset, const char* const extension, const bool isNormal)
+{
+    const uint32_t normalRecalc = isNormal ? g_ExportSettings.exportNormalRecalcSetting : eNormalExportRecalc::NML_RECALC_NONE;
+
+    uint64_t key = CTextureExportStore::HashData(extension, strlen(extension), 0ull);
+    key = CTextureExportStore::HashValue(txtrAsset->imgFormat, key);
+    key = CTextureExportStore::HashValue(normalRecalc, key);
+
+    return key;
+}
+
+// hashes the mip as it is stored in the pak, so a reused export also skips decompressing and unswizzling it
+static const uint64_t TextureStoreHashMip(const TextureMip_t* const mip, const char* const rawData, const uint64_t seed)
+{
+    uint64_t key = CTextureExportStore::HashValue(mip->width, seed);
+    key = CTextureExportStore::HashValue(mip->height, key);
+    key = CTextureExportStore::HashValue(mip->slicePitch, key);
+    key = CTextureExportStore::HashValue(mip->compType, key);
+    key = CTextureExportStore::HashValue(mip->swizzle, key);
+
+    return CTextureExportStore::HashData(rawData, mip->sizeSingle, key);
+}
+
+static const int64_t TextureStoreElapsedNs(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// exports a single mip from one entry of the texture array to its own file
+static bool ExportTextureMip(CPakAsset* const asset, const TextureAsset* const txtrAsset, const TextureMip_t* const mip, const size_t arrayIdx, const std::filesystem::path& exportPath, const bool isNormal, const bool asDds)
+{
+    const DXGI_FORMAT format = s_PakToDxgiFormat[txtrAsset->imgFormat];
+    std::unique_ptr<char[]> txtrData = GetTextureRawDataForMip(asset, mip, arrayIdx);
+
+    const bool useStore = g_ExportSettings.exportTextureDedupe && txtrData;
+    uint64_t storeKey = 0ull;
+
+    if (useStore)
+    {
+        storeKey = TextureStoreHashMip(mip, txtrData.get(), TextureStoreSeed(txtrAsset, asDds ? "dds" : "png", isNormal));
+
+        if (g_textureExportStore.TryReuse(storeKey, exportPath))
+            return true;
+    }
+
+    const std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+
+    txtrData = DecodeTextureMipData(mip, format, std::move(txtrData));
+    if (!txtrData)
+        return false;
+
+    std::unique_ptr<CTexture> exportTexture = std::make_unique<CTexture>(txtrData.get(), mip->slicePitch, mip->width, mip->height, format, 1u, 1u);
+
+    NormalRecalc(isNormal, exportTexture.get());
+
+    if (!(asDds ? exportTexture->ExportAsDds(exportPath) : exportTexture->ExportAsPng(exportPath)))
+        return false;
+
+    if (useStore)
+        g_textureExportStore.Add(storeKey, exportPath, TextureStoreElapsedNs(encodeStart));
+
+    return true;
+}
+
 bool ExportPngTextureAsset(CPakAsset* const asset, const TextureAsset* const txtrAsset, std::filesystem::path& exportPath, const int setting, const bool isNormal)
 {
     // Add extension | replace the .rpak ext.
@@ -820,7 +886,6 @@ bool ExportPngTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
         {
             // Grab highest mip.
             const TextureMip_t* const mip = &txtrAsset->mipArray[txtrAsset->mipArray.size() - 1];
-            std::unique_ptr<char[]> txtrData = GetTextureDataForMip(asset, mip, s_PakToDxgiFormat[txtrAsset->imgFormat], arrayIdx);
 
             if (txtrAsset->arraySize > 1)
             {
@@ -828,11 +893,7 @@ bool ExportPngTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
                 exportPath.replace_filename(fileName).concat(suffix);
             }
 
-            std::unique_ptr<CTexture> exportTexture = std::make_unique<CTexture>(txtrData.get(), mip->slicePitch, mip->width, mip->height, s_PakToDxgiFormat[txtrAsset->imgFormat], 1u, 1u);
-
-            NormalRecalc(isNormal, exportTexture.get());
-
-            if (!exportTexture->ExportAsPng(exportPath))
+            if (!ExportTextureMip(asset, txtrAsset, mip, arrayIdx, exportPath, isNormal, false))
                 return false;
         }
 
@@ -849,17 +910,11 @@ bool ExportPngTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
                 if (!mip->isLoaded)
                     return false;
                 
-                std::unique_ptr<char[]> txtrData = GetTextureDataForMip(asset, mip, s_PakToDxgiFormat[txtrAsset->imgFormat], arrayIdx);
-
                 // Label levels properly.
                 std::string suffix = txtrAsset->arraySize > 1 ? std::format("_{:03}_level{}.png", arrayIdx, i) : std::format("_level{}.png", i);
                 exportPath.replace_filename(fileName).concat(suffix);
 
-                std::unique_ptr<CTexture> exportTexture = std::make_unique<CTexture>(txtrData.get(), mip->slicePitch, mip->width, mip->height, s_PakToDxgiFormat[txtrAsset->imgFormat], 1u, 1u);
-
-                NormalRecalc(isNormal, exportTexture.get());
-
-                if (!exportTexture->ExportAsPng(exportPath))
+                if (!ExportTextureMip(asset, txtrAsset, mip, arrayIdx, exportPath, isNormal, false))
                     return false;
             }
         }
@@ -894,6 +949,7 @@ static void ExportTextureMetaData(const TextureAsset* const txtrAsset, std::file
 {
     exportPath.replace_extension(".json");
     std::ofstream ofs(exportPath, std::ios::out);
+    CWrittenFileTracker::Record(exportPath);
 
     ofs << "{\n";
 
@@ -951,7 +1007,6 @@ bool ExportDdsTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
         {
             // Grab highest mip.
             const TextureMip_t* const mip = &txtrAsset->mipArray[txtrAsset->mipArray.size() - 1];
-            std::unique_ptr<char[]> txtrData = GetTextureDataForMip(asset, mip, s_PakToDxgiFormat[txtrAsset->imgFormat], arrayIdx);
 
             if (txtrAsset->arraySize > 1)
             {
@@ -959,11 +1014,7 @@ bool ExportDdsTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
                 exportPath.replace_filename(fileName).concat(suffix);
             }
 
-            std::unique_ptr<CTexture> exportTexture = std::make_unique<CTexture>(txtrData.get(), mip->slicePitch, mip->width, mip->height, s_PakToDxgiFormat[txtrAsset->imgFormat], 1u, 1u);
-
-            NormalRecalc(isNormal, exportTexture.get());
-
-            if (!exportTexture->ExportAsDds(exportPath))
+            if (!ExportTextureMip(asset, txtrAsset, mip, arrayIdx, exportPath, isNormal, true))
                 return false;
         }
 
@@ -980,17 +1031,11 @@ bool ExportDdsTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
                 if (!mip->isLoaded)
                     return false;
 
-                std::unique_ptr<char[]> txtrData = GetTextureDataForMip(asset, mip, s_PakToDxgiFormat[txtrAsset->imgFormat], arrayIdx);
-
                 // Label levels properly.
                 std::string suffix = txtrAsset->arraySize > 1 ? std::format("_{:03}_level{}.dds", arrayIdx, i) : std::format("_level{}.dds", i);
                 exportPath.replace_filename(fileName).concat(suffix);
 
-                std::unique_ptr<CTexture> exportTexture = std::make_unique<CTexture>(txtrData.get(), mip->slicePitch, mip->width, mip->height, s_PakToDxgiFormat[txtrAsset->imgFormat], 1u, 1u);
-
-                NormalRecalc(isNormal, exportTexture.get());
-
-                if (!exportTexture->ExportAsDds(exportPath))
+                if (!ExportTextureMip(asset, txtrAsset, mip, arrayIdx, exportPath, isNormal, true))
                     return false;
             }
         }
@@ -999,12 +1044,23 @@ bool ExportDdsTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
     }
     case eTextureExportSetting::DDS_MM:
     {
-        std::unique_ptr<char[]> txtrData(new char[txtrAsset->dataSizeUnaligned * txtrAsset->arraySize] {});
-        char* pCurrent = txtrData.get(); // current position inside txtrData
+        const size_t mipCount = txtrAsset->mipArray.size();
+
+        // read every mip before decoding any of them so the texture export store can be checked first
+        std::vector<std::unique_ptr<char[]>> rawMips;
+        rawMips.reserve(txtrAsset->arraySize * mipCount);
+
+        bool useStore = g_ExportSettings.exportTextureDedupe;
+        uint64_t storeKey = TextureStoreSeed(txtrAsset, "dds_mm", isNormal);
+
+        if (useStore)
+        {
+            storeKey = CTextureExportStore::HashValue(txtrAsset->arraySize, storeKey);
+            storeKey = CTextureExportStore::HashValue(mipCount, storeKey);
+        }
 
         for (size_t arrayIdx = 0; arrayIdx < txtrAsset->arraySize; arrayIdx++)
         {
-            const size_t mipCount = txtrAsset->mipArray.size();
             for (size_t i = 0; i < mipCount; ++i) // cycle through all mips
             {
                 const TextureMip_t* const mip = &txtrAsset->mipArray[mipCount - 1 - i];
@@ -1012,7 +1068,31 @@ bool ExportDdsTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
                 if (!mip->isLoaded)
                     return false;
 
-                std::unique_ptr<char[]> mipData = GetTextureDataForMip(asset, mip, s_PakToDxgiFormat[txtrAsset->imgFormat], arrayIdx);
+                std::unique_ptr<char[]>& rawData = rawMips.emplace_back(GetTextureRawDataForMip(asset, mip, arrayIdx));
+
+                useStore = useStore && rawData;
+                if (useStore)
+                    storeKey = TextureStoreHashMip(mip, rawData.get(), storeKey);
+            }
+        }
+
+        if (useStore && g_textureExportStore.TryReuse(storeKey, exportPath))
+            return true;
+
+        const std::chrono::steady_clock::time_point encodeStart = std::chrono::steady_clock::now();
+
+        std::unique_ptr<char[]> txtrData(new char[txtrAsset->dataSizeUnaligned * txtrAsset->arraySize] {});
+        char* pCurrent = txtrData.get(); // current position inside txtrData
+
+        for (size_t arrayIdx = 0; arrayIdx < txtrAsset->arraySize; arrayIdx++)
+        {
+            for (size_t i = 0; i < mipCount; ++i) // cycle through all mips
+            {
+                const TextureMip_t* const mip = &txtrAsset->mipArray[mipCount - 1 - i];
+
+                std::unique_ptr<char[]> mipData = DecodeTextureMipData(mip, s_PakToDxgiFormat[txtrAsset->imgFormat], std::move(rawMips[(arrayIdx * mipCount) + i]));
+                if (!mipData)
+                    return false;
 
                 memcpy_s(pCurrent, mip->slicePitch, mipData.get(), mip->slicePitch); // copy this mip's data into txtr data
                 pCurrent += mip->slicePitch; // adjust our current position
@@ -1026,6 +1106,9 @@ bool ExportDdsTextureAsset(CPakAsset* const asset, const TextureAsset* const txt
         if (!exportTexture->ExportAsDds(exportPath))
             return false;
 
+        if (useStore)
+            g_textureExportStore.Add(storeKey, exportPath, TextureStoreElapsedNs(encodeStart));
+
         return true;
     }
     case eTextureExportSetting::DDS_MD:
@@ -1231,7 +1314,7 @@ std::unique_ptr<char[]> UnswizleSwitch(const TextureMip_t* const mip, const DXGI
 }
 #endif
 
-std::unique_ptr<char[]> GetTextureDataForMip(CPakAsset* const asset, const TextureMip_t* const mip, const DXGI_FORMAT format, const size_t arrayIndex)
+std::unique_ptr<char[]> GetTextureRawDataForMip(CPakAsset* const asset, const TextureMip_t* const mip, const size_t arrayIndex)
 {
     // [rika]: I swapped back to size (from slicePitch) because it's the size of the mip on disk, and we just create a new buffer anyways if it's compressed. saves some allocation of bytes.
     std::unique_ptr<char[]> txtrData;
@@ -1258,10 +1341,19 @@ std::unique_ptr<char[]> GetTextureDataForMip(CPakAsset* const asset, const Textu
         break;
     }
 
+    return txtrData;
+}
+
+std::unique_ptr<char[]> DecodeTextureMipData(const TextureMip_t* const mip, const DXGI_FORMAT format, std::unique_ptr<char[]> txtrData)
+{
     if (mip->compType != eCompressionType::NONE)
     {
         uint64_t slicePitch = mip->slicePitch;
         txtrData = RTech::DecompressStreamedBuffer(std::move(txtrData), slicePitch, mip->compType);
+
+        // corrupt stream
+        if (!txtrData)
+            return nullptr;
     }
 
     if (mip->swizzle != eTextureSwizzle::SWIZZLE_NONE)
@@ -1286,4 +1378,9 @@ std::unique_ptr<char[]> GetTextureDataForMip(CPakAsset* const asset, const Textu
     }
 
     return std::move(txtrData);
-}
\ No newline at end of file
+}
+
+std::unique_ptr<char[]> GetTextureDataForMip(CPakAsset* const asset, const TextureMip_t* const mip, const DXGI_FORMAT format, const size_t arrayIndex)
+{
+    return DecodeTextureMipData(mip, format, GetTextureRawDataForMip(asset, mip, arrayIndex));
+}
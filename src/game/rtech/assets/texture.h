@@ -1092,5 +1092,7 @@ enum eTextureExportSetting
 
 bool ExportPngTextureAsset(CPakAsset* const asset, const TextureAsset* const txtrAsset, std::filesystem::path& exportPath, const int setting, const bool isNormal);
 bool ExportDdsTextureAsset(CPakAsset* const asset, const TextureAsset* const txtrAsset, std::filesystem::path& exportPath, const int setting, const bool isNormal);
+std::unique_ptr<char[]> GetTextureRawDataForMip(CPakAsset* const asset, const TextureMip_t* const mip, const size_t arrayIndex = 0); // mip as stored in the pak
+std::unique_ptr<char[]> DecodeTextureMipData(const TextureMip_t* const mip, const DXGI_FORMAT format, std::unique_ptr<char[]> txtrData); // decompress and unswizzle
 std::unique_ptr<char[]> GetTextureDataForMip(CPakAsset* const asset, const TextureMip_t* const mip, const DXGI_FORMAT format, const size_t arrayIndex = 0);
 std::shared_ptr<CTexture> CreateTextureFromMip(CPakAsset* const asset, const TextureMip_t* const mip, const DXGI_FORMAT format, const size_t arrayIdx = 0);
\ No newline at end of file
@@ -54,7 +54,7 @@ const uint32_t UIFontHeader::TextureFromUnicodeMap(int unicode) const
         return fallbackTextureIndex;
 
     // if the fallback also fails, print an error message and return an invalid texture index
-    Log("Font %s doesn't even have question mark \"?\"\n", name);
+    LOG_WARN(UI, "Font %s doesn't even have question mark \"?\"\n", name);
 
     return FONT_TEXTURE_IDX_INVALID;
 }
@@ -86,7 +86,7 @@ const uint32_t UIFontHeader::TextureFromUnicode(int unicode) const
         unicode = FONT_UTF16_BOX;
     }
 
-    Log("Font %s doesn't have the code point U+%04X which is required to display a missing glyph.\n", name, FONT_UTF16_BOX);
+    LOG_WARN(UI, "Font %s doesn't have the code point U+%04X which is required to display a missing glyph.\n", name, FONT_UTF16_BOX);
 
     return FONT_TEXTURE_IDX_INVALID;
 }
@@ -117,7 +117,7 @@ const uint32_t UIFontHeader::TextureFromGlyph(int glyph) const
         glyph = LOBYTE(errorGlyph) << 16; // 
     }
 
-    Log("Font %s doesn't have the glyph index %u which is required to display a missing glyph.\n", name, 0u);
+    LOG_WARN(UI, "Font %s doesn't have the glyph index %u which is required to display a missing glyph.\n", name, 0u);
 
     return FONT_TEXTURE_IDX_INVALID;
 }
@@ -202,7 +202,7 @@ void UIFontHeader::SetCharacterForImages(const UIFontAtlasAsset* const fontAsset
         // note: on v6 everything gets bound to the '?' glyph, causing it to display the incorrect code.
         if (image->utf16 != -1)
         {
-            //Log("image %u had existing character binding, current: %x new: %x\n", idx, image->utf16, j);
+            //LOG_DEBUG(UI, "image %u had existing character binding, current: %x new: %x\n", idx, image->utf16, j);
             continue;
         }
 
@@ -368,10 +368,13 @@ void PostLoadUIFontAtlasAsset(CAssetContainer* const pak, CAsset* const asset)
     }
 
     std::unique_ptr<char[]> txtrData = GetTextureDataForMip(textureAsset, highestMip, fontAsset->txtrFormat); // parse texture through this mip function instead of copying, that way if swizzling is present it gets fixed.
+    if (!txtrData)
+        return;
 
 	// Only raw needs SRV.
 	fontAsset->txtrRaw = std::make_shared<CTexture>(txtrData.get(), highestMip->slicePitch, highestMip->width, highestMip->height, fontAsset->txtrFormat, 1u, 1u);
-	fontAsset->txtrRaw->CreateShaderResourceView(g_dxHandler->GetDevice());
+	if (g_dxHandler)
+		fontAsset->txtrRaw->CreateShaderResourceView(g_dxHandler->GetDevice());
 
 	// Convert to respective srgb non srgb format for texture slicing later.
 	fontAsset->txtrConverted = std::make_shared<CTexture>(txtrData.get(), highestMip->slicePitch, highestMip->width, highestMip->height, fontAsset->txtrFormat, 1u, 1u);
@@ -569,7 +572,7 @@ void* PreviewUIFontAtlasAsset(CAsset* const asset, const bool firstFrameForAsset
 
     const ImVec2 outerSize = ImVec2(0.f, ImGui::GetTextLineHeightWithSpacing() * 12.f);
 
-    ImGui::TextUnformatted(std::format("Atlas: {} (0x{:X})", pakAsset->GetAssetName().c_str(), pakAsset->data()->guid).c_str());
+    ImGui::TextUnformatted(std::format("Atlas: {} (0x{:X})", pakAsset->GetAssetName().data(), pakAsset->data()->guid).c_str());
 
     if (fontAsset->fontCount > 1)
     {
@@ -161,8 +161,10 @@ void LoadUIImageAsset(CAssetContainer* const pak, CAsset* const asset)
                     tableData = RTech::DecompressStreamedBuffer(std::move(tableData), bufSize, uiAsset->compType);
                 }
 
+                // missing or corrupt, the tiles stay zeroed
                 assertm(tableData, "Failed to get starpak data?");
-                memcpy_s(tilePoints.get(), tileTableSize, tableData.get(), tileTableSize);
+                if (tableData)
+                    memcpy_s(tilePoints.get(), tileTableSize, tableData.get(), tileTableSize);
             }
             else
             {
@@ -226,56 +228,170 @@ void PostLoadUIImageAsset(CAssetContainer* container, CAsset* asset)
         pakAsset->SetAssetNameFromCache();
 }
 
-// Or swizzle work..
-std::unique_ptr<CTexture> DoTilingWork(std::unique_ptr<CTexture> texture, std::unique_ptr<char[]> const& buf, const size_t bufSize, const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x)
-{    
-    uint64_t tileOffset = 0ull;
+// destination block of the tile at (x, y), the tiling is three levels of 2x2 interleaving
+const uint32_t UIImageTiledBlockIndex(const uint32_t x, const uint32_t y, const uint32_t widthBlocks)
+{
+    uint32_t mx = x;
+    uint32_t my = y;
+
+    // --- 2 ---
+    int power = 2;
+    int b_2 = (mx / 2 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
+        2 + (widthBlocks / power) * ((mx / 2 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
+        2 * (widthBlocks / power) * ((mx / 2 + my * (widthBlocks / power)) / (2 * (widthBlocks / power)));
+
+    int c_2 = mx % 2 + 2 * (b_2 % (widthBlocks / power));
+    mx = b_2 / (widthBlocks / power);
+    my = c_2 / 4;
+    c_2 %= 4;
+
+    // --- 4 ---
+    power = 4;
+    int b_4 = (my + mx / 2 * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
+        2 + (widthBlocks / power) * ((my + mx / 2 * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
+        2 * (widthBlocks / power) * ((my + mx / 2 * (widthBlocks / power)) / (2 * (widthBlocks / power)));
+
+    int c_4 = mx % 2 + 2 * (b_4 / (widthBlocks / power));
+    mx = b_4 / (widthBlocks / power);
+    my = c_4 / 4;
+    c_4 %= 4;
+
+    // --- 8 ---
+    power = 8;
+    int b_8 = ((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
+        2 + (widthBlocks / power) * (((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
+        2 * (widthBlocks / power) * (((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) / (2 * (widthBlocks / power)));
+
+    my = (c_4 + 4 * ((int)b_8 / (widthBlocks / power)));
+    mx = (c_2 + 4 * (b_4 % (widthBlocks / 4))) % 8 + 8 * (uint32_t)(b_8 % (widthBlocks / power));
+
+    return my * widthBlocks + mx;
+}
+
+// the tiling moves blocks in horizontal pairs, so the table holds the source block of every destination pair in row order
+// it only covers whole bands of 8 rows, which the tiling keeps to themselves. tables only depend on the block dimensions and are shared by every image of that size
+// nullptr if the blocks don't pair up or leave the bands, that isn't the layout this was written for
+static std::shared_ptr<const std::vector<uint32_t>> GetUIImageTilingTable(const uint32_t widthBlocks, const uint32_t bandRows)
+{
+    static std::map<uint64_t, std::shared_ptr<const std::vector<uint32_t>>> s_tilingTables;
+    static std::mutex s_tilingTableMutex;
+
+    const uint64_t key = (static_cast<uint64_t>(widthBlocks) << 32) | bandRows;
+
+    {
+        std::lock_guard<std::mutex> lock(s_tilingTableMutex);
+
+        if (const auto it = s_tilingTables.find(key); it != s_tilingTables.end())
+            return it->second;
+    }
+
+    const uint32_t numBlocks = widthBlocks * bandRows;
+    std::shared_ptr<std::vector<uint32_t>> table = std::make_shared<std::vector<uint32_t>>(numBlocks >> 1, UINT32_MAX);
+
+    uint32_t srcBlock = 0u;
+    for (uint32_t y = 0u; y < bandRows && table; y++)
+    {
+        for (uint32_t x = 0u; x < widthBlocks; x += 2, srcBlock += 2)
+        {
+            const uint32_t dstBlock = UIImageTiledBlockIndex(x, y, widthBlocks);
+
+            // checked in release too, a table built from a broken assumption would scramble every image of this size
+            if ((dstBlock & 1u) || dstBlock >= numBlocks || UIImageTiledBlockIndex(x + 1, y, widthBlocks) != dstBlock + 1 || table->at(dstBlock >> 1) != UINT32_MAX)
+            {
+                LOG_ERROR(UI, "ui image tiling for %ux%u blocks doesn't move blocks in pairs, using the per block path\n", widthBlocks, bandRows);
+
+                table.reset();
+                break;
+            }
+
+            table->at(dstBlock >> 1) = srcBlock;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s_tilingTableMutex);
+    return s_tilingTables.emplace(key, std::move(table)).first->second;
+}
+
+// writes the destination a row at a time, gathering each pair of blocks from the source
+template <size_t blockSize>
+static void CopyTiledRows(char* const dst, const char* const src, const uint32_t* const table, const uint32_t widthBlocks, const uint32_t heightBlocks)
+{
+    constexpr size_t pairSize = blockSize * 2;
+
+    const uint32_t pairsPerRow = widthBlocks >> 1;
+    const size_t rowSize = static_cast<size_t>(widthBlocks) * blockSize;
+
     for (uint32_t y = 0u; y < heightBlocks; y++)
+    {
+        char* const row = dst + (y * rowSize);
+        const uint32_t* const rowTable = table + (static_cast<size_t>(y) * pairsPerRow);
+
+        for (uint32_t pair = 0u; pair < pairsPerRow; pair++)
+            std::memcpy(row + (pair * pairSize), src + (rowTable[pair] * blockSize), pairSize);
+    }
+}
+
+// one block at a time straight from the formula, for rows the table doesn't cover
+// blocks that land outside the texture are dropped
+static void CopyTiledBlocks(char* const dst, const size_t dstSize, const char* const src, const uint32_t widthBlocks, const uint32_t firstRow, const uint32_t lastRow, const uint32_t bpp2x)
+{
+    for (uint32_t y = firstRow; y < lastRow; y++)
     {
         for (uint32_t x = 0u; x < widthBlocks; x++)
         {
-            uint32_t mx = x;
-            uint32_t my = y;
-
-            // --- 2 ---
-            int power = 2;
-            int b_2 = (mx / 2 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
-                2 + (widthBlocks / power) * ((mx / 2 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
-                2 * (widthBlocks / power) * ((mx / 2 + my * (widthBlocks / power)) / (2 * (widthBlocks / power)));
-
-            int c_2 = mx % 2 + 2 * (b_2 % (widthBlocks / power));
-            mx = b_2 / (widthBlocks / power);
-            my = c_2 / 4;
-            c_2 %= 4;
-
-            // --- 4 ---
-            power = 4;
-            int b_4 = (my + mx / 2 * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
-                2 + (widthBlocks / power) * ((my + mx / 2 * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
-                2 * (widthBlocks / power) * ((my + mx / 2 * (widthBlocks / power)) / (2 * (widthBlocks / power)));
-
-            int c_4 = mx % 2 + 2 * (b_4 / (widthBlocks / power));
-            mx = b_4 / (widthBlocks / power);
-            my = c_4 / 4;
-            c_4 %= 4;
-
-            // --- 8 ---
-            power = 8;
-            int b_8 = ((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
-                2 + (widthBlocks / power) * (((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
-                2 * (widthBlocks / power) * (((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) / (2 * (widthBlocks / power)));
-
-            my = (c_4 + 4 * ((int)b_8 / (widthBlocks / power)));
-            mx = (c_2 + 4 * (b_4 % (widthBlocks / 4))) % 8 + 8 * (uint32_t)(b_8 % (widthBlocks / power));
-
-            const uint64_t destination = static_cast<uint64_t>(bpp2x * (my * widthBlocks + mx));
-            assertm(destination < texture->GetSlicePitch(), "destination greater than our texture size?");
-
-            assertm(tileOffset < bufSize, "offset greater than our buf?");
-            memcpy_s(texture->GetPixels() + destination, texture->GetSlicePitch() - destination, buf.get() + tileOffset, bpp2x); // Same as above, account for max size in dest buf based on copy location.
-            tileOffset += bpp2x;
+            const size_t destination = static_cast<size_t>(UIImageTiledBlockIndex(x, y, widthBlocks)) * bpp2x;
+            if (destination + bpp2x > dstSize)
+                continue;
+
+            std::memcpy(dst + destination, src + ((static_cast<size_t>(y) * widthBlocks + x) * bpp2x), bpp2x);
         }
     }
+}
+
+// Or swizzle work..
+// ui images are made of 32x32 pixel blocks, 8x8 bc blocks each, so the sizes from CreateBC1/BC7TextureForUIImageAsset are always multiples of 8
+// the tiling interleaves within bands of 8 rows, a partial last band is still copied block by block. the width has to be a multiple of 8, the formula divides by width / 8
+std::unique_ptr<CTexture> DoTilingWork(std::unique_ptr<CTexture> texture, std::unique_ptr<char[]> const& buf, const size_t bufSize, const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x)
+{
+    const size_t tiledSize = static_cast<size_t>(widthBlocks) * heightBlocks * bpp2x;
+
+    if (!widthBlocks || !heightBlocks || (widthBlocks % 8) != 0 || tiledSize > bufSize || tiledSize > texture->GetSlicePitch())
+    {
+        LOG_ERROR(UI, "can't tile a ui image of %ux%u blocks, leaving it untiled\n", widthBlocks, heightBlocks);
+        return std::move(texture);
+    }
+
+    char* const pixels = reinterpret_cast<char*>(texture->GetPixels());
+
+    const uint32_t bandRows = heightBlocks & ~7u;
+    const std::shared_ptr<const std::vector<uint32_t>> table = bandRows ? GetUIImageTilingTable(widthBlocks, bandRows) : nullptr;
+
+    if (!table)
+    {
+        CopyTiledBlocks(pixels, tiledSize, buf.get(), widthBlocks, 0u, heightBlocks, bpp2x);
+        return std::move(texture);
+    }
+
+    switch (bpp2x)
+    {
+    case 8u: // bc1
+        CopyTiledRows<8u>(pixels, buf.get(), table->data(), widthBlocks, bandRows);
+        break;
+    case 16u: // bc7
+        CopyTiledRows<16u>(pixels, buf.get(), table->data(), widthBlocks, bandRows);
+        break;
+    default:
+    {
+        const uint32_t pairsPerRow = widthBlocks >> 1;
+        for (uint32_t pair = 0u; pair < pairsPerRow * bandRows; pair++)
+            std::memcpy(pixels + (static_cast<size_t>(pair) * bpp2x * 2), buf.get() + (static_cast<size_t>(table->at(pair)) * bpp2x), bpp2x * 2);
+
+        break;
+    }
+    }
+
+    if (bandRows != heightBlocks)
+        CopyTiledBlocks(pixels, tiledSize, buf.get(), widthBlocks, bandRows, heightBlocks, bpp2x);
 
     return std::move(texture);
 }
@@ -298,7 +414,8 @@ std::unique_ptr<CTexture> CreateBC1TextureForUIImageAsset(CPakAsset* const asset
             uint64_t bufSize = uiAsset->streamedSize;
             streamedData = RTech::DecompressStreamedBuffer(std::move(streamedData), bufSize, uiAsset->compType);
         }
-        assertm(streamedData, "invalid table data after decode.");
+        if (!streamedData)
+            return nullptr; // corrupt stream
 
         bc1Data = streamedData.get();
     }
@@ -367,7 +484,8 @@ std::unique_ptr<CTexture> CreateBC7TextureForUIImageAsset(CPakAsset* const asset
             uint64_t bufSize = uiAsset->streamedSize;
             streamedData = RTech::DecompressStreamedBuffer(std::move(streamedData), bufSize, uiAsset->compType);
         }
-        assertm(streamedData, "invalid table data after decode.");
+        if (!streamedData)
+            return nullptr; // corrupt stream
 
         bc7Data = streamedData.get();
     }
@@ -430,7 +548,8 @@ std::shared_ptr<CTexture> CreateTextureForImage(CPakAsset* const asset, UIImageA
         tasks.addTask([resData, &bc1Texture, asset, uiAsset, doStreaming, doTiling]
         {
             bc1Texture = CreateBC1TextureForUIImageAsset(asset, uiAsset, resData, doStreaming, doTiling);
-            bc1Texture->ConvertToFormat(DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM);
+            if (bc1Texture)
+                bc1Texture->ConvertToFormat(DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM);
         }, 1u);
     }
  
@@ -439,16 +558,21 @@ std::shared_ptr<CTexture> CreateTextureForImage(CPakAsset* const asset, UIImageA
         tasks.addTask([resData, &bc7Texture, asset, uiAsset, doStreaming, doTiling]
         {
             bc7Texture = CreateBC7TextureForUIImageAsset(asset, uiAsset, resData, doStreaming, doTiling);
-            bc7Texture->ConvertToFormat(DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM);
+            if (bc7Texture)
+                bc7Texture->ConvertToFormat(DXGI_FORMAT::DXGI_FORMAT_R8G8B8A8_UNORM);
         }, 1u);
     }
 
     tasks.execute();
     tasks.wait();
 
+    // one of the tile sets failed to decode
+    if ((resData->numBc1Tiles && !bc1Texture) || (resData->numBc7Tiles && !bc7Texture))
+        return nullptr;
+
     if (!bc1Texture && !bc7Texture)
     {
-        //Log("ERROR: failed to export ui image asset %llX. image had no tiles.\n", asset->data()->guid);
+        //LOG_WARN(UI, "ERROR: failed to export ui image asset %llX. image had no tiles.\n", asset->data()->guid);
         //assertm(false, "no bc1 and no bc7??????????");
         return nullptr;
     }
@@ -686,7 +810,7 @@ static bool ExportPngUIImageAsset(CPakAsset* const asset, UIImageAsset* const ui
             return uiTexture->ExportAsPng(exportPath);
         else
         {
-            Log("Failed to export ui image asset '%s'. Received nullptr for extracted texture.\n", asset->GetAssetName().c_str());
+            LOG_ERROR(UI, "Failed to export ui image asset '%s'. Received nullptr for extracted texture.\n", asset->GetAssetName().data());
             return false;
         }
     }
@@ -698,7 +822,7 @@ static bool ExportPngUIImageAsset(CPakAsset* const asset, UIImageAsset* const ui
             return uiTexture->ExportAsPng(exportPath);
         else
         {
-            Log("Failed to export ui image asset '%s'. Received nullptr for extracted texture.\n", asset->GetAssetName().c_str());
+            LOG_ERROR(UI, "Failed to export ui image asset '%s'. Received nullptr for extracted texture.\n", asset->GetAssetName().data());
             return false;
         }
     }
@@ -726,7 +850,7 @@ static bool ExportDdsUIImageAsset(CPakAsset* const asset, UIImageAsset* const ui
             return uiTexture->ExportAsDds(exportPath);
         else
         {
-            Log("Failed to export ui image asset '%s'. Received nullptr for extracted texture.\n", asset->GetAssetName().c_str());
+            LOG_ERROR(UI, "Failed to export ui image asset '%s'. Received nullptr for extracted texture.\n", asset->GetAssetName().data());
             return false;
         }
     }
@@ -738,7 +862,7 @@ static bool ExportDdsUIImageAsset(CPakAsset* const asset, UIImageAsset* const ui
             return uiTexture->ExportAsDds(exportPath);
         else
         {
-            Log("Failed to export ui image asset '%s'. Received nullptr for extracted texture.\n", asset->GetAssetName().c_str());
+            LOG_ERROR(UI, "Failed to export ui image asset '%s'. Received nullptr for extracted texture.\n", asset->GetAssetName().data());
             return false;
         }
     }
@@ -145,6 +145,12 @@ public:
 	eCompressionType compType;
 };
 
+class CTexture;
+
+// ui image blocks are stored tiled, DoTilingWork puts a texture's blocks in linear order
+const uint32_t UIImageTiledBlockIndex(const uint32_t x, const uint32_t y, const uint32_t widthBlocks);
+std::unique_ptr<CTexture> DoTilingWork(std::unique_ptr<CTexture> texture, std::unique_ptr<char[]> const& buf, const size_t bufSize, const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x);
+
 constexpr __declspec(align(16)) uint8_t UIImageTileBc1[512] =
 {
 	0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0xFF, 0xFF,
@@ -4,6 +4,7 @@
 
 #include <core/render/dx.h>
 #include <thirdparty/imgui/imgui.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
 
 extern CDXParentHandler* g_dxHandler;
 extern ExportSettings_t g_ExportSettings;
@@ -154,10 +155,13 @@ void PostLoadUIImageAtlasAsset(CAssetContainer* const pak, CAsset* const asset)
     }
 
     std::unique_ptr<char[]> txtrData = GetTextureDataForMip(textureAsset, highestMip, uiAsset->format); // parse texture through this mip function instead of copying, that way if swizzling is present it gets fixed.
+    if (!txtrData)
+        return;
 
     // Only raw needs SRV.
     uiAsset->rawTxtr = std::make_shared<CTexture>(txtrData.get(), highestMip->slicePitch, highestMip->width, highestMip->height, uiAsset->format, 1u, 1u);
-    uiAsset->rawTxtr->CreateShaderResourceView(g_dxHandler->GetDevice());
+    if (g_dxHandler)
+        uiAsset->rawTxtr->CreateShaderResourceView(g_dxHandler->GetDevice());
 
     // Convert to respective srgb non srgb format for texture slicing later.
     uiAsset->convertedTxtr = std::make_shared<CTexture>(txtrData.get(), highestMip->slicePitch, highestMip->width, highestMip->height, uiAsset->format, 1u, 1u);
@@ -325,7 +329,7 @@ void* PreviewUIImageAtlasAsset(CAsset* const asset, const bool firstFrameForAsse
 
     const ImVec2 outerSize = ImVec2(0.f, ImGui::GetTextLineHeightWithSpacing() * 12.f);
 
-    ImGui::TextUnformatted(std::format("Atlas: {} (0x{:X})", pakAsset->GetAssetName().c_str(), pakAsset->data()->guid).c_str());
+    ImGui::TextUnformatted(std::format("Atlas: {} (0x{:X})", pakAsset->GetAssetName().data(), pakAsset->data()->guid).c_str());
 
     if (ImGui::BeginTable("Image Table", UITexturePreviewData_t::eColumnID::_TPC_COUNT, tableFlags, outerSize))
     {
@@ -472,6 +476,81 @@ enum eUIImageAtlasExportSetting
     DDS_T,  // DDS (Textures)
 };
 
+// exports every image of the atlas in parallel, each image is cropped straight out of the converted atlas into a per thread buffer
+static bool ExportUIImageAtlasSlices(UIImageAtlasAsset* const uiAsset, const uint64_t guid, const std::filesystem::path& exportPath, const bool asPng)
+{
+    // we skip the last element, this is the main atlas texture.
+    if (uiAsset->imageArray.size() <= 1)
+        return true;
+
+    const uint32_t imageCount = static_cast<uint32_t>(uiAsset->imageArray.size()) - 1u;
+
+    CTexture* const atlas = uiAsset->convertedTxtr.get();
+
+    std::atomic<uint32_t> imageIdx = 0;
+    std::atomic<bool> failed = false;
+
+    const uint32_t threadCount = std::clamp(UtilsConfig->exportThreadCount, 1u, imageCount);
+    CParallelTask parallelExportTask(threadCount);
+
+    parallelExportTask.addTask([uiAsset, guid, &exportPath, asPng, imageCount, atlas, &imageIdx, &failed]
+    {
+        std::vector<uint8_t> sliceBuf;
+
+        while (imageIdx < imageCount && !failed)
+        {
+            const uint32_t imageToProcess = imageIdx++;
+            if (imageToProcess >= imageCount)
+                continue;
+
+            const UIAtlasImage* const image = &uiAsset->imageArray[imageToProcess];
+
+            // [amos] if either of them are null, the DirectX::CopyRectangle call will crash.
+            // the preview function above logs it as N/A so I think we should just skip them.
+            if (!image->width || !image->height)
+            {
+                if (!asPng)
+                    LOG_WARN(UI, "skipping image %x in altas %llx (invalid texture)...\n", image->pathHash, guid);
+
+                continue;
+            }
+
+            std::filesystem::path currentPath = exportPath;
+            const std::filesystem::path itemPath = image->path;
+
+            // Setup paths.
+            if (currentPath.has_parent_path())
+                currentPath.append(itemPath.parent_path().string());
+
+            // [amos] Need to remove trailing slash because otherwise std::filesystem::create_directories
+            // will fail with the error message "The operation completed successfully".
+            // See https://developercommunity.visualstudio.com/t/stdfilesystemcreate-directories-returns-false-if-p/278829
+            currentPath = currentPath.parent_path();
+
+            if (!CreateDirectories(currentPath))
+            {
+                assertm(false, "Failed to create export type directory");
+                failed = true;
+                return;
+            }
+            currentPath.concat(std::format("\\{}.{}", itemPath.filename().string(), asPng ? "png" : "dds"));
+
+            const size_t posX = static_cast<size_t>(image->posX);
+            const size_t posY = static_cast<size_t>(image->posY);
+
+            if (asPng)
+                atlas->ExportRectAsPng(currentPath, posX, posY, image->width, image->height, sliceBuf);
+            else
+                atlas->ExportRectAsDds(currentPath, posX, posY, image->width, image->height, sliceBuf);
+        }
+    }, threadCount);
+
+    parallelExportTask.execute();
+    parallelExportTask.wait();
+
+    return !failed;
+}
+
 //static_assert(s_AssetTypePaths.count(PakAssetType_t::UIMG));
 static const char* const s_PathPrefixUIMG = s_AssetTypePaths.find(AssetType_t::UIMG)->second;
 bool ExportUIImageAtlasAsset(CAsset* const asset, const int setting)
@@ -531,83 +610,11 @@ bool ExportUIImageAtlasAsset(CAsset* const asset, const int setting)
 
         return false;
     }
-    case eUIImageAtlasExportSetting::DDS_T:
-    {
-        assertm(uiAsset->convertedTxtr, "Converted atlas was not valid.");
-        for (auto it = uiAsset->imageArray.rbegin() + 1; it != uiAsset->imageArray.rend(); ++it) // We skip the last element, this is the main atlas texture.
-        {
-            // [amos] if either of them are null, the DirectX::CopyRectangle call will crash.
-            // the preview function above logs it as N/A so I think we should just skip them.
-            if (!it->width || !it->height)
-            {
-                printf("skipping image %x in altas %llx (invalid texture)...\n", it->pathHash, asset->GetAssetGUID());
-
-                continue;
-            }
-
-            std::filesystem::path currentPath = exportPath;
-            std::filesystem::path itemPath = it->path;
-
-            // Setup paths.
-            if (currentPath.has_parent_path())
-                currentPath.append(itemPath.parent_path().string());
-
-            // [amos] Need to remove trailing slash because otherwise std::filesystem::create_directories
-            // will fail with the error message "The operation completed successfully".
-            // See https://developercommunity.visualstudio.com/t/stdfilesystemcreate-directories-returns-false-if-p/278829
-            currentPath = currentPath.parent_path();
-
-            if (!CreateDirectories(currentPath))
-            {
-                assertm(false, "Failed to create export type directory");
-                return false;
-            }
-            currentPath.concat(std::format("\\{}.dds", itemPath.filename().string()));
-
-            printf("Format = %d\n", (int)uiAsset->format);
-
-            std::unique_ptr<CTexture> sliceData = std::make_unique<CTexture>(nullptr, 0u, it->width, it->height, (IsSRGB(uiAsset->format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM), 1u, 1u);
-            sliceData->CopySourceTextureSlice(uiAsset->convertedTxtr.get(), static_cast<size_t>(it->posX), static_cast<size_t>(it->posY), it->width, it->height, 0u, 0u);
-            sliceData->ExportAsDds(currentPath);
-        }
-
-        return true;
-    }
     case eUIImageAtlasExportSetting::PNG_T:
+    case eUIImageAtlasExportSetting::DDS_T:
     {
         assertm(uiAsset->convertedTxtr, "Converted atlas was not valid.");
-        for (auto it = uiAsset->imageArray.rbegin() + 1; it != uiAsset->imageArray.rend(); ++it) // We skip the last element, this is the main atlas texture.
-        {
-            // [amos] if either of them are null, the DirectX::CopyRectangle call will crash.
-            // the preview function above logs it as N/A so I think we should just skip them.
-            if (!it->width || !it->height)
-                continue;
-
-            std::filesystem::path currentPath = exportPath;
-            std::filesystem::path itemPath = it->path;
-
-            // Setup paths.
-            if (currentPath.has_parent_path())
-                currentPath.append(itemPath.parent_path().string());
-
-            // [amos] Need to remove trailing slash because otherwise std::filesystem::create_directories
-            // will fail with the error message "The operation completed successfully".
-            // See https://developercommunity.visualstudio.com/t/stdfilesystemcreate-directories-returns-false-if-p/278829
-            currentPath = currentPath.parent_path();
-
-            if (!CreateDirectories(currentPath))
-            {
-                assertm(false, "Failed to create export type directory");
-                return false;
-            }
-            currentPath.concat(std::format("\\{}.png", itemPath.filename().string()));
-
-            std::unique_ptr<CTexture> sliceData = std::make_unique<CTexture>(nullptr, 0u, it->width, it->height, (IsSRGB(uiAsset->format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM), 1u, 1u);
-            sliceData->CopySourceTextureSlice(uiAsset->convertedTxtr.get(), static_cast<size_t>(it->posX), static_cast<size_t>(it->posY), it->width, it->height, 0u, 0u);
-            sliceData->ExportAsPng(currentPath);
-        }
-
-        return true;
+        return ExportUIImageAtlasSlices(uiAsset, asset->GetAssetGUID(), exportPath, setting == eUIImageAtlasExportSetting::PNG_T);
     }
     default:
     {
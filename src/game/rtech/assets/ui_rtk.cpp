@@ -52,7 +52,7 @@ void LoadRTKAsset(CAssetContainer* pak, CAsset* asset)
 
         if (!hasWarned)
         {
-            Log("Failed to load RTK asset %llX with unknown header size. Header Size: %u, Version: %u\n",
+            LOG_WARN(UI, "Failed to load RTK asset %llX with unknown header size. Header Size: %u, Version: %u\n",
                 pakAsset->guid(), pakAsset->data()->headerStructSize, pakAsset->version());
 
             hasWarned = true;
@@ -4,6 +4,7 @@
 #include <game/rtech/utils/utils.h>
 #include <game/bsp/bsp.h>
 #include <thirdparty/imgui/imgui.h>
+#include <thirdparty/oodle/oodle2.h>
 
 void LoadWrapAsset(CAssetContainer* const pak, CAsset* const asset)
 {
@@ -32,70 +33,296 @@ void LoadWrapAsset(CAssetContainer* const pak, CAsset* const asset)
 }
 
 
-static bool GetStreamedDataForWrapAsset(CPakAsset* const asset, const uint32_t size, const int32_t skipSize, std::unique_ptr<char[]>& wrapData)
+// streamed wrap data is read from the starpak in pieces of this size
+static constexpr size_t s_wrapStreamChunkSize = 4ull * 1024 * 1024;
+
+// reads a wrap asset's stored data, either straight from pak memory or from its starpak in bounded chunks
+class CWrapDataReader
 {
-    AssetPtr_t streamEntry = asset->getStarPakStreamEntry(false);
-    if (!IS_ASSET_PTR_INVALID(streamEntry))
+public:
+    CWrapDataReader() : m_mem(nullptr), m_remaining(0ull), m_bufStart(0ull), m_bufEnd(0ull) {};
+
+    const bool Open(CPakAsset* const pakAsset, const WrapAsset* const wrapAsset)
     {
-        wrapData = asset->getStarPakData(streamEntry.offset + skipSize, size, false);
-        return true;
+        const uint64_t wrapSize = wrapAsset->isCompressed ? wrapAsset->cmpSize : wrapAsset->dcmpSize;
+
+        if (!wrapAsset->isStreamed)
+        {
+            constexpr int staticAsset = WRAP_FLAG_FILE_IS_COMPRESSED | WRAP_FLAG_FILE_IS_PERMANENT;
+            const char* buf = reinterpret_cast<const char*>(wrapAsset->data);
+
+            // [amos]: if this condition is met, some internal header needs to be skipped.
+            // only appears to happen on small files that appear to be marked for compress
+            // but failed during build, e.g. mp_rr_arena_phase_runner.bsp.0005.bsp_lump in
+            // release "build R5pc_r5-180_J25_CL4941853_2023_07_27_16_31". permanent assets
+            // only
+            if (!wrapAsset->isCompressed && (wrapAsset->flags & staticAsset) == staticAsset)
+                buf += 2;
+
+            m_mem = buf;
+            m_remaining = wrapSize;
+
+            return true;
+        }
+
+        for (const bool opt : { false, true })
+        {
+            const AssetPtr_t streamEntry = pakAsset->getStarPakStreamEntry(opt);
+            if (IS_ASSET_PTR_INVALID(streamEntry))
+                continue;
+
+            const StarPak_t* const starPak = pakAsset->getStarPak(opt);
+            if (!starPak)
+                return false;
+
+            return OpenFile(starPak->filePath, streamEntry.offset + wrapAsset->skipSize, wrapSize);
+        }
+
+        assertm(false, "CWrapDataReader opened a streamed asset with no streamed data?");
+        return false;
     }
 
-    streamEntry = asset->getStarPakStreamEntry(true);
-    if (!IS_ASSET_PTR_INVALID(streamEntry))
+    const bool OpenFile(const std::string& path, const uint64_t offset, const uint64_t size)
     {
-        wrapData = asset->getStarPakData(streamEntry.offset + skipSize, size, true);
+        if (!m_file.open(path, eStreamIOMode::Read))
+            return false;
+
+        m_file.seek(offset);
+        m_remaining = size;
+
         return true;
     }
 
-    assertm(false, "GetStreamedDataForWrapAsset called but no streamed data?");
-    return false;
+    // permanent data is in pak memory for as long as the pak is loaded
+    inline const bool IsInMemory() const { return m_mem != nullptr; };
+    inline const char* Memory() const { return m_mem; };
+    inline const uint64_t Remaining() const { return m_remaining; };
+
+    // makes at least minSize bytes available if there are that many left, returns the available size
+    const size_t Fill(const char** const data, const size_t minSize)
+    {
+        if (m_mem)
+        {
+            *data = m_mem;
+            return m_remaining;
+        }
+
+        size_t available = m_bufEnd - m_bufStart;
+        if ((available == 0 || available < minSize) && available < m_remaining)
+        {
+            // keep what hasn't been consumed at the front
+            if (m_bufStart)
+            {
+                std::memmove(m_buf.data(), m_buf.data() + m_bufStart, available);
+                m_bufStart = 0ull;
+                m_bufEnd = available;
+            }
+
+            const size_t toRead = std::min(std::max(minSize, s_wrapStreamChunkSize), static_cast<size_t>(m_remaining)) - available;
+            if (m_buf.size() < available + toRead)
+                m_buf.resize(available + toRead);
+
+            m_file.read(m_buf.data() + m_bufEnd, toRead);
+            m_bufEnd += toRead;
+
+            available = m_bufEnd - m_bufStart;
+        }
+
+        *data = m_buf.data() + m_bufStart;
+        return std::min(available, static_cast<size_t>(m_remaining));
+    }
+
+    void Consume(const size_t size)
+    {
+        assertm(size <= m_remaining, "consumed past the end of the wrap data");
+
+        m_remaining -= size;
+
+        if (m_mem)
+            m_mem += size;
+        else
+            m_bufStart += size;
+    }
+
+private:
+    const char* m_mem;
+    StreamIO m_file;
+    uint64_t m_remaining;
+
+    std::vector<char> m_buf;
+    size_t m_bufStart;
+    size_t m_bufEnd;
+};
+
+// decodes compressed wrap data into outBuf, which has to hold the whole decompressed size as it is also the decoder's window
+// writer is given each decoded piece as soon as it is final, if set
+static const bool DecodeWrapData(CWrapDataReader& reader, char* const outBuf, const uint64_t outSize, const std::function<void(const char*, size_t)>& writer)
+{
+    PROFILE_SCOPE("decompress wrap");
+
+    OodleLZDecoder* const decoder = OodleLZDecoder_Create(OodleLZ_Compressor::OodleLZ_Compressor_Invalid, outSize, nullptr, 0);
+
+    uint64_t outPos = 0ull;
+    size_t compNeeded = 0ull;
+
+    bool success = true;
+    while (outPos < outSize)
+    {
+        const char* comp = nullptr;
+        const size_t compAvail = reader.Fill(&comp, compNeeded);
+
+        OodleLZ_DecodeSome_Out decodeOut = {};
+        if (!OodleLZDecoder_DecodeSome(decoder, &decodeOut, outBuf, outPos, outSize, outSize - outPos, comp, compAvail, OodleLZ_FuzzSafe_No, OodleLZ_CheckCRC_No, OodleLZ_Verbosity::OodleLZ_Verbosity_None, OodleLZ_Decode_ThreadPhaseAll))
+        {
+            success = false;
+            break;
+        }
+
+        // not enough input for the next quantum
+        if (decodeOut.compBufUsed + decodeOut.decodedCount == 0)
+        {
+            // nothing left to give it
+            if (compAvail >= reader.Remaining())
+            {
+                success = false;
+                break;
+            }
+
+            compNeeded = std::max(static_cast<size_t>(decodeOut.curQuantumCompLen), compAvail + s_wrapStreamChunkSize);
+            continue;
+        }
+
+        if (writer && decodeOut.decodedCount > 0)
+            writer(outBuf + outPos, decodeOut.decodedCount);
+
+        outPos += decodeOut.decodedCount;
+        reader.Consume(decodeOut.compBufUsed);
+
+        compNeeded = 0ull;
+    }
+
+    OodleLZDecoder_Destroy(decoder);
+
+    PROFILE_COUNTER_ADD(eProfileCounter::BYTES_DECOMPRESSED, outPos);
+
+    return success;
 }
 
-std::unique_ptr<char[]> GetWrapAssetData(CAsset* const asset, uint64_t* outSize)
+const bool GetWrapAssetDataView(CAsset* const asset, WrapAssetDataView_t& view)
 {
     CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
 
     const WrapAsset* const wrapAsset = reinterpret_cast<WrapAsset*>(pakAsset->extraData());
     assertm(wrapAsset, "Extra data should be valid at this point.");
 
-    const uint32_t wrapSize = wrapAsset->isCompressed ? wrapAsset->cmpSize : wrapAsset->dcmpSize;
-    std::unique_ptr<char[]> wrapData = std::make_unique<char[]>(wrapSize);
+    view = {};
 
-    if (wrapAsset->isStreamed)
+    CWrapDataReader reader;
+    if (!reader.Open(pakAsset, wrapAsset))
+    {
+        assertm(false, "Failed to get data for wrap asset.");
+        return false;
+    }
+
+    const uint64_t wrapOutSize = wrapAsset->dcmpSize;
+
+    if (wrapAsset->isCompressed)
     {
-        if (!GetStreamedDataForWrapAsset(pakAsset, wrapSize, wrapAsset->skipSize, wrapData))
+        std::shared_ptr<char[]> outBuf(new char[wrapOutSize]);
+
+        if (!DecodeWrapData(reader, outBuf.get(), wrapOutSize, nullptr))
         {
-            assertm(false, "Failed to get streamed data for wrap asset.");
-            return nullptr;
+            LOG_ERROR(PAK, "WRAP: failed to decompress \"%s\"\n", asset->GetAssetName().data());
+            return false;
         }
+
+        view.owned = std::move(outBuf);
+    }
+    else if (reader.IsInMemory())
+    {
+        // no copy, the view points into the pak
+        view.data = reader.Memory();
+        view.size = wrapOutSize;
+
+        return true;
     }
     else
     {
-        const int staticAsset = WRAP_FLAG_FILE_IS_COMPRESSED | WRAP_FLAG_FILE_IS_PERMANENT;
-        const char* buf = (const char*)wrapAsset->data;
+        std::shared_ptr<char[]> outBuf(new char[wrapOutSize]);
 
-        // [amos]: if this condition is met, some internal header needs to be skipped.
-        // only appears to happen on small files that appear to be marked for compress
-        // but failed during build, e.g. mp_rr_arena_phase_runner.bsp.0005.bsp_lump in
-        // release "build R5pc_r5-180_J25_CL4941853_2023_07_27_16_31". permanent assets
-        // only
-        if (!wrapAsset->isCompressed && (wrapAsset->flags & staticAsset) == staticAsset)
-            buf += 2;
+        const char* data = nullptr;
+        uint64_t outPos = 0ull;
 
-        memcpy_s(wrapData.get(), wrapSize, buf, wrapSize);
+        while (reader.Remaining())
+        {
+            const size_t size = reader.Fill(&data, 0ull);
+            std::memcpy(outBuf.get() + outPos, data, size);
+
+            reader.Consume(size);
+            outPos += size;
+        }
+
+        view.owned = std::move(outBuf);
     }
 
-    uint64_t wrapOutSize = wrapAsset->dcmpSize;
-    if (wrapAsset->isCompressed)
+    view.data = view.owned.get();
+    view.size = wrapOutSize;
+
+    return true;
+}
+
+// compressed data is written as each quantum is decoded, uncompressed data is copied across a chunk at a time
+static const bool WriteWrapData(CWrapDataReader& reader, const bool isCompressed, const uint64_t outSize, StreamIO& out)
+{
+    if (isCompressed)
     {
-        wrapData = RTech::DecompressStreamedBuffer(std::move(wrapData), wrapOutSize, eCompressionType::OODLE);
+        std::unique_ptr<char[]> outBuf(new char[outSize]);
+
+        return DecodeWrapData(reader, outBuf.get(), outSize, [&out](const char* const data, const size_t size) { out.write(data, size); });
     }
 
-    if (outSize)
-        *outSize = wrapOutSize;
+    const char* data = nullptr;
+    while (reader.Remaining())
+    {
+        const size_t size = reader.Fill(&data, 0ull);
 
-    return wrapData;
+        out.write(data, size);
+        reader.Consume(size);
+    }
+
+    return true;
+}
+
+const bool WriteWrapAssetData(CAsset* const asset, StreamIO& out)
+{
+    CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
+
+    const WrapAsset* const wrapAsset = reinterpret_cast<WrapAsset*>(pakAsset->extraData());
+    assertm(wrapAsset, "Extra data should be valid at this point.");
+
+    CWrapDataReader reader;
+    if (!reader.Open(pakAsset, wrapAsset))
+    {
+        assertm(false, "Failed to get data for wrap asset.");
+        return false;
+    }
+
+    if (!WriteWrapData(reader, wrapAsset->isCompressed, wrapAsset->dcmpSize, out))
+    {
+        LOG_ERROR(PAK, "WRAP: failed to decompress \"%s\"\n", asset->GetAssetName().data());
+        return false;
+    }
+
+    return true;
+}
+
+const bool WriteWrapFileData(const std::string& path, const uint64_t offset, const uint64_t storedSize, const uint64_t outSize, const bool isCompressed, StreamIO& out)
+{
+    CWrapDataReader reader;
+    if (!reader.OpenFile(path, offset, storedSize))
+        return false;
+
+    return WriteWrapData(reader, isCompressed, outSize, out);
 }
 
 
@@ -117,10 +344,11 @@ void PostLoadWrapAsset(CAssetContainer* const pak, CAsset* const asset)
     //{
     //    wrapAsset->parsedDataType = eWrapAssetParsedDataType::BSP;
 
-    //    std::unique_ptr<char[]> wrapData = GetWrapAssetData(asset, nullptr);
+    //    WrapAssetDataView_t wrapData;
+    //    GetWrapAssetDataView(asset, wrapData);
 
     //    CBSPData* bspData = new CBSPData(assetPath.stem().string());
-    //    bspData->PopulateFromPakAsset(pakAsset, wrapData.get());
+    //    bspData->PopulateFromPakAsset(pakAsset, const_cast<char*>(wrapData.data));
 
     //    wrapAsset->parsedData = bspData;
     //}
@@ -162,14 +390,12 @@ bool ExportWrapAsset(CAsset* const asset, const int setting)
             return false;
         }
 
-        uint64_t wrapOutSize = 0;
-        std::unique_ptr<char[]> wrapData = GetWrapAssetData(asset, &wrapOutSize);
+        const bool success = WriteWrapAssetData(asset, wrapOut);
+        wrapOut.close();
 
-        if (!wrapData)
+        if (!success)
             return false;
 
-        wrapOut.write(wrapData.get(), wrapOutSize);
-        wrapOut.close();
         break;
     }
     // needs some stuff to be finished first
@@ -215,6 +441,7 @@ void* PreviewWrapAsset(CAsset* const asset, const bool firstFrameForAsset)
 
 }
 
+// no releaseRefsFunc, a wrap asset only points into its own pak and bsp lumps taken from other paks are copied
 void InitWrapAssetType()
 {
     AssetTypeBinding_t type =
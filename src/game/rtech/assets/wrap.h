@@ -73,4 +73,21 @@ public:
 	eWrapAssetParsedDataType parsedDataType;
 
 	void* parsedData; // data class for something like 
-};
\ No newline at end of file
+};
+// a wrap asset's decompressed data
+// uncompressed permanent data points straight into pak memory and is valid while the pak is loaded, anything else is held by owned
+struct WrapAssetDataView_t
+{
+	const char* data;
+	uint64_t size;
+
+	std::shared_ptr<char[]> owned;
+};
+
+const bool GetWrapAssetDataView(CAsset* const asset, WrapAssetDataView_t& view);
+
+// writes the decompressed data to out as it is decoded, streamed data is read from the starpak in chunks
+const bool WriteWrapAssetData(CAsset* const asset, StreamIO& out);
+
+// same as WriteWrapAssetData for wrap data stored in a file at offset, storedSize is the compressed size if it is compressed
+const bool WriteWrapFileData(const std::string& path, const uint64_t offset, const uint64_t storedSize, const uint64_t outSize, const bool isCompressed, StreamIO& out);
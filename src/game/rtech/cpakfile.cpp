@@ -3,8 +3,11 @@
 #include <game/rtech/patchapi.h>
 
 #include <game/rtech/utils/utils.h>
+#include <game/rtech/utils/pakdecoder.h>
 #include <thirdparty/imgui/misc/imgui_utility.h>
 
+#include <core/filehandling/assetdiff.h>
+
 //CGlobalPakData g_pakData;
 
 #if defined(PAKLOAD_PATCHING_ANY)
@@ -49,6 +52,8 @@ struct PakFileLoadState_t
 
 const bool CPakFile::ParseFileBuffer(const std::string& path)
 {
+    PROFILE_SCOPE("pak parse");
+
     if (!ParseFromFile(path, this->m_Buf))
         return false;
 
@@ -297,7 +302,7 @@ const bool CPakFile::LoadAndPatchPakFileData()
 {
     if (g_assetData.m_pakLoadStatusMap.count(header()->crc) != 0)
     {
-        Log("Pakfile '%s' failed to load because its CRC was already recorded as being loaded.\n", m_FilePath.c_str());
+        LOG_WARN(PAK, "Pakfile '%s' failed to load because its CRC was already recorded as being loaded.\n", m_FilePath.c_str());
 
         return false;
     }
@@ -350,8 +355,11 @@ const bool CPakFile::LoadAndPatchPakFileData()
         // Save the initialised pak load state into the chain's loaded pakfiles vector.
         pakChain.at(static_cast<size_t>(i + 1)) = loadState;
 
-        if(patchPakHdr->crc != 0 && g_assetData.m_pakLoadStatusMap.count(patchPakHdr->crc) == 0)
+        if (patchPakHdr->crc != 0 && g_assetData.m_pakLoadStatusMap.count(patchPakHdr->crc) == 0)
+        {
             g_assetData.m_pakLoadStatusMap.emplace(patchPakHdr->crc, true);
+            m_patchCrcs.push_back(patchPakHdr->crc);
+        }
     }
 
     std::shared_ptr<char[]> combinedPakDataBuffer = std::make_shared<char[]>(combinedPakBufferSize);
@@ -480,18 +488,118 @@ const bool CPakFile::LoadAndPatchPakFileData()
 const bool CPakFile::ParseFromFile(const std::string& filePath, std::shared_ptr<char[]>& buf)
 {
 #if (PAKLOAD_DEBUG == PAKLOAD_DEBUG_LOG)
-    Log("parsing pak file from path: ('%s')\n", filePath.c_str());
+    LOG_DEBUG(PAK, "parsing pak file from path: ('%s')\n", filePath.c_str());
 #endif // #if (PAKLOAD_DEBUG >= PAKLOAD_DEBUG_LOG)
 
-    if (!FileSystem::ReadFileData(filePath, &buf))
+    StreamIO file;
+    if (!file.open(filePath, eStreamIOMode::Read))
         return false;
 
+    const size_t fileSize = file.size();
+
+    // rtech encoded paks are streamed through the decoder instead of being read in full first
+    if (fileSize >= sizeof(PakHdr_v8_t))
+    {
+        char headerData[sizeof(PakHdr_v8_t)] = {};
+        if (!file.read(headerData, sizeof(PakHdr_v8_t)))
+            return false;
+
+        const short version = reinterpret_cast<const short*>(headerData)[2];
+        if (version == 7 || version == 8)
+        {
+            const PakHdr_t header = version == 7 ? PakHdr_t(reinterpret_cast<const PakHdr_v7_t*>(headerData)) : PakHdr_t(reinterpret_cast<const PakHdr_v8_t*>(headerData));
+
+            if (header.magic == pakFileMagic && (header.flags & PAK_HEADER_FLAGS_RTECH_ENCODED))
+                return DecodeFileStream(file, fileSize, header, headerData, buf);
+        }
+
+        file.seek(0);
+    }
+
+    {
+        PROFILE_SCOPE("pak read");
+
+        buf = std::shared_ptr<char[]>(new char[fileSize]);
+        if (!file.read(buf.get(), fileSize))
+        {
+            LOG_ERROR(PAK, "failed to read pak file '%s'\n", filePath.c_str());
+            return false;
+        }
+    }
+
+    PROFILE_SCOPE("pak decompress");
+
     if (!DecompressFileBuffer(buf.get(), &buf))
         return false;
 
     return true;
 }
 
+const bool CPakFile::DecodeFileStream(StreamIO& file, const size_t fileSize, const PakHdr_t& header, const char* const headerData, std::shared_ptr<char[]>& buf)
+{
+    PROFILE_SCOPE("pak decompress");
+
+    CPakDecoder decoder;
+    decoder.PushInput(headerData, sizeof(PakHdr_v8_t));
+
+    std::unique_ptr<char[]> slice = std::make_unique<char[]>(s_pakReadSliceSize);
+    size_t readPos = sizeof(PakHdr_v8_t);
+
+    const auto readSlice = [&]() -> bool
+    {
+        if (readPos >= fileSize)
+            return false;
+
+        const size_t sliceSize = std::min(s_pakReadSliceSize, fileSize - readPos);
+
+        {
+            PROFILE_SCOPE("pak read");
+            if (!file.read(slice.get(), sliceSize))
+                return false;
+        }
+
+        decoder.PushInput(slice.get(), sliceSize);
+        readPos += sliceSize;
+
+        return true;
+    };
+
+    size_t decodeSize = 0ull;
+    while ((decodeSize = decoder.ReadHeader(header.cmpSize, header.pakHdrSize)) == 0ull)
+    {
+        if (!readSlice())
+            return false;
+    }
+
+    // dcmpSize is what the rest of the pak is parsed with, keep the buffer at least that large
+    const size_t dcmpSize = std::max(decodeSize, static_cast<size_t>(header.dcmpSize));
+    std::shared_ptr<char[]> dcmpBuf = std::shared_ptr<char[]>(new char[dcmpSize + CPakDecoder::s_outputPadding]);
+
+    decoder.SetOutput(dcmpBuf.get(), dcmpSize + CPakDecoder::s_outputPadding);
+
+    for (;;)
+    {
+        const CPakDecoder::eStatus status = decoder.Decode();
+
+        if (status == CPakDecoder::eStatus::DONE)
+            break;
+
+        if (status == CPakDecoder::eStatus::CORRUPT || !readSlice())
+            return false;
+    }
+
+    PROFILE_COUNTER_ADD(eProfileCounter::BYTES_DECOMPRESSED, decodeSize);
+
+    // get pakhdr back from compressed buffer
+    memcpy_s(dcmpBuf.get(), header.pakHdrSize, headerData, header.pakHdrSize);
+
+    if (dcmpSize > decodeSize)
+        memset(dcmpBuf.get() + decodeSize, 0, dcmpSize - decodeSize);
+
+    buf = dcmpBuf;
+    return true;
+}
+
 const bool CPakFile::ParseStreamedFile(const std::string& fileName, bool opt)
 {
     // The end of the starpak path buffers is padded with null bytes to get back to (8 byte?) alignment
@@ -500,8 +608,10 @@ const bool CPakFile::ParseStreamedFile(const std::string& fileName, bool opt)
     if (fileName.length() == 0)
         return false;
 
+    PROFILE_SCOPE("starpak parse");
+
 #if (PAKLOAD_DEBUG == PAKLOAD_DEBUG_LOG)
-    Log("parsing starpak file from path: ('%s')\n", fileName.c_str());
+    LOG_DEBUG(PAK, "parsing starpak file from path: ('%s')\n", fileName.c_str());
 #endif // #if (PAKLOAD_DEBUG >= PAKLOAD_DEBUG_LOG)
 
     struct StarPakStreamEntry_t
@@ -517,7 +627,7 @@ const bool CPakFile::ParseStreamedFile(const std::string& fileName, bool opt)
     StreamIO file;
     if (!file.open(path, eStreamIOMode::Read))
     {
-        Log("failed to find starpak file '%s' on disk, assets may be missing data as a result...\n", fileName.c_str());
+        LOG_ERROR(PAK, "failed to find starpak file '%s' on disk, assets may be missing data as a result...\n", fileName.c_str());
         return false;
     }
 
@@ -577,17 +687,18 @@ const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, std::shared_pt
 
     if (header->flags & PAK_HEADER_FLAGS_RTECH_ENCODED) // standard pakfile compression
     {
-        std::shared_ptr<char[]> dcmpBuf = std::shared_ptr<char[]>(new char[header->dcmpSize] {});
+        CPakDecoder decoder;
+        decoder.SetInput(fileBuffer, header->cmpSize);
 
-        RTech::PakDecompressContext_t context = {};
-        uint64_t decodeSize = RTech::InitPakDecoder(&context, reinterpret_cast<const uint8_t*>(fileBuffer), PAK_DECODE_MASK, header->cmpSize, 0, header->pakHdrSize);
+        const size_t decodeSize = decoder.ReadHeader(header->cmpSize, header->pakHdrSize);
+        const size_t dcmpSize = std::max(decodeSize, static_cast<size_t>(header->dcmpSize));
 
-        context.m_outputMask = PAK_DECODE_MASK;
-        context.m_outputBuf = uint64_t(dcmpBuf.get());
+        std::shared_ptr<char[]> dcmpBuf = std::shared_ptr<char[]>(new char[dcmpSize + CPakDecoder::s_outputPadding] {});
+        decoder.SetOutput(dcmpBuf.get(), dcmpSize + CPakDecoder::s_outputPadding);
 
-        if (RTech::DecompressPakFile(&context, header->cmpSize, decodeSize))
+        if (decodeSize != 0ull && decoder.Decode() == CPakDecoder::eStatus::DONE)
         {
-            assertm(decodeSize == context.m_decompSize, "mismatch on decode size.");
+            PROFILE_COUNTER_ADD(eProfileCounter::BYTES_DECOMPRESSED, decodeSize);
 
             // get pakhdr back from compressed buffer
             memcpy_s(dcmpBuf.get(), header->pakHdrSize, fileBuffer, header->pakHdrSize);
@@ -669,7 +780,7 @@ const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, std::shared_pt
         if (decodeSize == 0 || data.get() == nullptr)
         {
             // TODO: Add proper logging system call here
-            // printf("ZSTD pak decompression failed: decodeSize=%llu, data=%p\n", decodeSize, data.get());
+            // LOG_ERROR(PAK, "ZSTD pak decompression failed: decodeSize=%llu, data=%p\n", decodeSize, data.get());
             delete header;
             return false;
         }
@@ -678,7 +789,7 @@ const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, std::shared_pt
         if (decodeSize != (header->dcmpSize - header->pakHdrSize)) {
             // Size mismatch - this might be expected with ZSTD_CONTENTSIZE_UNKNOWN
             // TODO: Add proper logging system call here
-            // printf("ZSTD size mismatch: got %llu, expected %llu\n", decodeSize, header->dcmpSize - header->pakHdrSize);
+            // LOG_ERROR(PAK, "ZSTD size mismatch: got %llu, expected %llu\n", decodeSize, header->dcmpSize - header->pakHdrSize);
         }
 
         // copy pak header to the decompressed buffer
@@ -854,7 +965,7 @@ const bool CPakFile::DecodePatchCommands()
         }
 
 #if (PAKLOAD_DEBUG == PAKLOAD_DEBUG_VERBOSE)
-        Log("patch func! %i: bytesToPatch %lld, dst sz %lld, nbts %lld nrfbb %lld\n", cmd, p.numBytesToPatch, p.patchDestinationSize, p.numBytesToSkip, p.numRemainingFileBufferBytes);
+        LOG_DEBUG(PAK, "patch func! %i: bytesToPatch %lld, dst sz %lld, nbts %lld nrfbb %lld\n", cmd, p.numBytesToPatch, p.patchDestinationSize, p.numBytesToSkip, p.numRemainingFileBufferBytes);
 #endif // #if (PAKLOAD_DEBUG == PAKLOAD_DEBUG_VERBOSE)
         if (!p.patchFunc(this, &p.numRemainingFileBufferBytes))
             break;
@@ -988,6 +1099,8 @@ static std::unordered_map<AssetType_t, std::string> s_ParsedPrefixes(63);
 
 void CPakFile::ProcessAssets()
 {
+    PROFILE_SCOPE("pak process assets");
+
     // prepare the parallel task with max threads to be used.
     const uint32_t threadCount = UtilsConfig->parseThreadCount;
     CParallelTask parallelLoadTask(threadCount);
@@ -995,9 +1108,12 @@ void CPakFile::ProcessAssets()
 
     std::mutex assetMutex;
 
+    std::vector<CAsset*> pakAssets;
+    pakAssets.reserve(assetCount());
+
     // atomic int will ensure we aren't processing the same asset multiple times.
     std::atomic<uint32_t> assetIdx = 0;
-    parallelProcessTask.addTask([this, &assetIdx, &assetMutex, &parallelLoadTask]
+    parallelProcessTask.addTask([this, &assetIdx, &assetMutex, &parallelLoadTask, &pakAssets]
     {
         const uint32_t cpyAssetCount = static_cast<uint32_t>(assetCount());
         while (assetIdx < cpyAssetCount)
@@ -1011,11 +1127,16 @@ void CPakFile::ProcessAssets()
 
             const AssetType_t type = static_cast<AssetType_t>(pAsset->type);
 
-            const std::string prefix = s_AssetTypePaths.contains(type) ? s_AssetTypePaths.find(type)->second : fourCCToString(pAsset->type);
+            const auto typePath = s_AssetTypePaths.find(type);
+            const std::string fallbackPrefix = typePath == s_AssetTypePaths.end() ? fourCCToString(pAsset->type) : std::string();
+            const std::string_view prefix = typePath != s_AssetTypePaths.end() ? std::string_view(typePath->second) : std::string_view(fallbackPrefix);
 
             // note(amos): crashes rarely when s_ParsedPrefixes.find() == s_ParsedPrefixes.end().
             // crashed on s3's mp_rr_desertlands_64k_x_64k.rpak in debug.
-            const std::string tempName = std::format("{}/0x{:X}", prefix, pAsset->guid);
+            // formatted on the stack, the name is copied into the pak's interner
+            char tempNameBuf[128];
+            const auto tempNameEnd = std::format_to_n(tempNameBuf, sizeof(tempNameBuf), "{}/0x{:X}", prefix, pAsset->guid).out;
+            const std::string_view tempName(tempNameBuf, static_cast<size_t>(tempNameEnd - tempNameBuf));
 
             CPakAsset* const asset = new CPakAsset(this, pAsset, tempName);
             parallelLoadTask.addTask([this, pAsset, asset]
@@ -1023,13 +1144,19 @@ void CPakFile::ProcessAssets()
                 if (auto it = g_assetData.m_assetTypeBindings.find(pAsset->type); it != g_assetData.m_assetTypeBindings.end())
                 {
                     if (it->second.loadFunc)
+                    {
+                        PROFILE_SCOPE_TYPE("load", pAsset->type);
+                        PROFILE_COUNTER_ADD(eProfileCounter::ASSETS_LOADED, 1);
+
                         it->second.loadFunc(this, asset);
+                    }
                 }
             }, 1u);
             
             // mutex so we can write to m_pakAssets safely.
             std::lock_guard<std::mutex> lock(assetMutex);
             g_assetData.v_assets.push_back({ pAsset->guid, asset });
+            pakAssets.push_back(asset);
         }
     }, threadCount);
 
@@ -1048,6 +1175,9 @@ void CPakFile::ProcessAssets()
     if(processingAssetsEvent)
         g_pImGuiHandler->FinishProgressBarEvent(processingAssetsEvent);
 
+    // has to see the pages before any load function does
+    CapturePakFingerprints(this, pakAssets);
+
     const ProgressBarEvent_t* const loadAssetsEvent = g_pImGuiHandler->AddProgressBarEvent("Processing Assets...", parallelLoadTask.getRemainingTasks(), &parallelLoadTask, fnRemainingTasks);
     parallelLoadTask.execute();
 
@@ -654,6 +654,8 @@ public:
     ~CPakFile();
 
     const CAsset::ContainerType GetContainerType() const { return CAsset::ContainerType::PAK; };
+    std::string GetContainerFileName() const { return getPakStem() + ".rpak"; };
+    std::filesystem::path GetContainerFilePath() const { return m_FilePath; };
 
     const bool ParseFileBuffer(const std::string& path);
     static const bool DecompressFileBuffer(const char* fileBuffer, std::shared_ptr<char[]>* outBuffer);
@@ -762,6 +764,8 @@ private:
     std::vector<std::unique_ptr<StarPak_t>> m_vStarPaks;
     std::vector<std::unique_ptr<StarPak_t>> m_vOptStarPaks;
 
+    std::vector<uint64_t> m_patchCrcs;
+
     PakSegmentHdr_t* m_pSegmentHeaders;
 
     PakPageHdr_t* m_pPageHeaders;
@@ -792,6 +796,12 @@ private:
 
     // Populates CPakFile members from file
     const bool ParseFromFile(const std::string& filePath, std::shared_ptr<char[]>& buf);
+
+    // rtech encoded paks are decoded from slices of the file as they're read
+    // a segment is only decoded once all of its input is in, so multi segment streams hold about one segment of the compressed file
+    // while single segment streams still hold all of it before decoding starts
+    static constexpr size_t s_pakReadSliceSize = 4ull << 20;
+    static const bool DecodeFileStream(StreamIO& file, const size_t fileSize, const PakHdr_t& header, const char* const headerData, std::shared_ptr<char[]>& buf);
     const bool ParseStreamedFile(const std::string& fileName, bool opt);
 
 #if defined(PAKLOAD_PATCHING_ANY)
@@ -843,6 +853,17 @@ public:
         return vPak->at(idx).get();
     }
 
+    inline size_t starPakCount(bool opt) const { return opt ? m_vOptStarPaks.size() : m_vStarPaks.size(); };
+
+    // loaded page data, the pointers in it are resolved. pages that weren't loaded are nullptr
+    inline char* pageBuffer(const int idx) const { return idx < static_cast<int>(pageBuffers.size()) ? pageBuffers[idx] : nullptr; };
+    inline const PakPageHdr_t* const pageHeaders() const { return m_pPageHeaders; };
+    inline const PakSegmentHdr_t* const segmentHeaders() const { return m_pSegmentHeaders; };
+    inline const PakPointerHdr_t* const pointerHeaders() const { return m_pPointerHeaders; };
+
+    // crcs of the patch files that were applied to this pak, recorded in g_assetData.m_pakLoadStatusMap alongside the pak's own
+    inline const std::vector<uint64_t>& patchCrcs() const { return m_patchCrcs; };
+
     inline const int* const dependents() const { return m_pDependentAssets; }; // [rika]: TEMP! rexx is gonna kill me!!!
     inline const PakGuidRefHdr_t* const guidRefs() const { return m_pGuidRefHeaders; };
 
@@ -944,6 +965,8 @@ bool CPakFile::ProcessNextPage()
 template<class PakAsset>
 const bool CPakFile::LoadAndPatchAssetData()
 {
+    PROFILE_SCOPE("pak patch pages");
+
     while (this->numAssetsWithProcessedPages < this->assetCount())
     {
         if (this->p.patchDestinationSize + this->p.numBytesToSkip == 0)
@@ -1071,15 +1094,15 @@ private:
     // stores the result of whether the last export attempt succeeded
     //bool m_exported;
 public:
-    CPakAsset(CPakFile* pak, PakAsset_t* asset, std::string name)
+    CPakAsset(CPakFile* pak, PakAsset_t* asset, const std::string_view name)
     {
         // set initial export status to false
         SetExportedStatus(false);
 
+        SetContainerFile(pak);
         SetAssetName(name);
         SetAssetVersion(asset->version);
         SetInternalAssetData(asset);
-        SetContainerFile(pak);
     };
 
     CPakAsset() = default;
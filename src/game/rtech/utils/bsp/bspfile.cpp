@@ -117,7 +117,7 @@ BSPModel_t& CollisionModel(CBSPFile* bsp)
 
 void DumpBSPFile(const fs::path& inputPath)
 {
-	printf("Dumping bsp file '%s' as branch 'apex'\n", inputPath.string().c_str());
+	LOG_INFO(MAP, "Dumping bsp file '%s' as branch 'apex'\n", inputPath.string().c_str());
 
 	CBSPFile* bsp = new CBSPFile();
 
@@ -125,12 +125,12 @@ void DumpBSPFile(const fs::path& inputPath)
 
 	BSPModel_t& collisionModel = CollisionModel(bsp);
 
-	printf("Exporting collision mesh...\n");
+	LOG_DEBUG(MAP, "Exporting collision mesh...\n");
 
 	//collisionModel.exportOBJ(fs::path(inputPath).replace_extension(".coll.obj"));
 	collisionModel.exportSTL(fs::path(inputPath).replace_extension(".coll.stl"));
 
-	printf("Exported collision mesh!\n");
+	LOG_DEBUG(MAP, "Exported collision mesh!\n");
 
 	delete bsp;
 }
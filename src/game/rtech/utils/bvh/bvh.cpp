@@ -181,7 +181,7 @@ void Coll_HandleNodeChildType(CollisionModel_t& colModel, const uint32_t content
 
 		if (skip)
 		{
-			//printf("Blocked node with contents %x, filter %x.\n", contents, pModel->maskFilter);
+			//LOG_DEBUG(MAP, "Blocked node with contents %x, filter %x.\n", contents, pModel->maskFilter);
 			return;
 		}
 	}
@@ -255,7 +255,7 @@ void Coll_HandleNodeChildType(CollisionModel_t& colModel, const uint32_t content
 	//	break;
 	//}
 	default:
-		printf("Unhandled bvh node child type %u\n", nodeType);
+		LOG_WARN(MAP, "Unhandled bvh node child type %u\n", nodeType);
 	}
 }
 
@@ -306,6 +306,8 @@ bool CollisionModel_t::exportSTL(const std::filesystem::path& outPath)
 	if (!out.is_open())
 		return false;
 
+	CWrittenFileTracker::Record(outPath);
+
 	// They seem to not be in the right spot yet, so might not want to export for now
 	//bool include_packed = false;
 
@@ -367,9 +369,11 @@ bool CollisionModel_t::exportOBJ(const std::filesystem::path& outFile)
 	if (!out.is_open())
 		return false;
 
+	CWrittenFileTracker::Record(outFile);
+
 	out << "# " << this->tris.size() << " tris\no tris\n";
 
-	printf("Writing tris...\n");
+	LOG_DEBUG(MAP, "Writing tris...\n");
 	for (Triangle& tri : this->tris)
 	{
 		out
@@ -381,7 +385,7 @@ bool CollisionModel_t::exportOBJ(const std::filesystem::path& outFile)
 
 	out << "\n# " << this->quads.size() << " quads\no quads\n";
 
-	printf("Writing quads...\n");
+	LOG_DEBUG(MAP, "Writing quads...\n");
 	for (Quad& quad : this->quads)
 	{
 		out
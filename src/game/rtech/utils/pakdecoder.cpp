@@ -0,0 +1,612 @@
+#include <pch.h>
+#include <game/rtech/utils/pakdecoder.h>
+
+// tokens are read from the low 8 bits of the bit window
+// negative values are literal runs of -value bytes, 4-16 are matches of that length, 17 is a match with an extended length
+struct PakLzToken_t
+{
+    int8_t value;
+    uint8_t bits;
+};
+
+// a literal run can't follow another literal run, so the token set changes after one
+static constexpr PakLzToken_t s_tokenTable[2][256] =
+{
+    {
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {   8, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, {  -7, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {   7, 6 }, {   4, 2 }, {   5, 5 }, {  -1, 4 }, { -12, 6 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {  16, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, { -10, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  -5, 6 }, {   4, 2 }, {   6, 5 }, {  -1, 4 }, {  11, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {   8, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, {  -8, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  12, 6 }, {   4, 2 }, {   5, 5 }, {  -1, 4 }, {  -9, 7 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {  16, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, { -11, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  -6, 6 }, {   4, 2 }, {   6, 5 }, {  -1, 4 }, { -13, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {   8, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, {  -7, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {   7, 6 }, {   4, 2 }, {   5, 5 }, {  -1, 4 }, { -12, 6 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {  16, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, { -10, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  -5, 6 }, {   4, 2 }, {   6, 5 }, {  -1, 4 }, {  14, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {   8, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, {  -8, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  12, 6 }, {   4, 2 }, {   5, 5 }, {  -1, 4 }, {   9, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {  16, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, { -11, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  -6, 6 }, {   4, 2 }, {   6, 5 }, {  -1, 4 }, { -15, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {   8, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, {  -7, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {   7, 6 }, {   4, 2 }, {   5, 5 }, {  -1, 4 }, { -12, 6 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {  16, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, { -10, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  -5, 6 }, {   4, 2 }, {   6, 5 }, {  -1, 4 }, {  13, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {   8, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, {  -8, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  12, 6 }, {   4, 2 }, {   5, 5 }, {  -1, 4 }, {  -9, 7 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {  16, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, { -11, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  -6, 6 }, {   4, 2 }, {   6, 5 }, {  -1, 4 }, { -14, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {   8, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, {  -7, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {   7, 6 }, {   4, 2 }, {   5, 5 }, {  -1, 4 }, { -12, 6 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {  16, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, { -10, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  -5, 6 }, {   4, 2 }, {   6, 5 }, {  -1, 4 }, {  15, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {   8, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, {  -8, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  12, 6 }, {   4, 2 }, {   5, 5 }, {  -1, 4 }, {  10, 8 },
+        {   4, 2 }, {  -2, 4 }, {  -4, 3 }, {  16, 5 }, {   4, 2 }, { -17, 4 }, {  17, 4 }, { -11, 6 },
+        {   4, 2 }, {  -3, 4 }, {  -4, 3 }, {  -6, 6 }, {   4, 2 }, {   6, 5 }, {  -1, 4 }, { -16, 8 },
+    },
+    {
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   7, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  17, 6 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   8, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  12, 7 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   7, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   9, 7 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   8, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  14, 8 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   7, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  17, 6 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   8, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  11, 8 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   7, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  10, 7 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   8, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  16, 8 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   7, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  17, 6 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   8, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  12, 7 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   7, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   9, 7 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   8, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  15, 8 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   7, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  17, 6 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   8, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  13, 8 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   7, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  10, 7 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {   8, 5 },
+        {   4, 1 }, {   5, 2 }, {   4, 1 }, {   6, 3 }, {   4, 1 }, {   5, 2 }, {   4, 1 }, {  -1, 8 },
+    },
+};
+
+// this literal run is followed by an extended length instead
+static constexpr int8_t s_longLiteralToken[2] = { -17, -1 };
+static constexpr int8_t s_longMatchToken = 17;
+
+// match distances are 16 * (exponent bits) + a short code for the low part of the distance
+struct PakLzDistance_t
+{
+    uint8_t low;
+    uint8_t bits;
+};
+
+static constexpr PakLzDistance_t s_distanceTable[64] =
+{
+    { 0, 1 }, { 8, 2 }, { 0, 1 }, {  4, 5 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, {  6, 6 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, {  1, 6 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, { 11, 6 },
+    { 0, 1 }, { 8, 2 }, { 0, 1 }, { 12, 5 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, {  9, 6 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, {  3, 6 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, { 14, 6 },
+    { 0, 1 }, { 8, 2 }, { 0, 1 }, {  4, 5 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, {  7, 6 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, {  2, 6 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, { 13, 6 },
+    { 0, 1 }, { 8, 2 }, { 0, 1 }, { 12, 5 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, { 10, 6 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, {  5, 6 }, { 0, 1 }, { 8, 2 }, { 0, 1 }, { 15, 6 },
+};
+
+// extended lengths are a 3 bit code, or a zero code followed by a 4 bit code for long ones, then the extra bits of the length
+struct PakLzLength_t
+{
+    uint32_t base;
+    uint8_t bits;
+};
+
+static constexpr PakLzLength_t s_shortLengthTable[8] =
+{
+    { 0, 0 }, { 0, 1 }, { 2, 1 }, { 4, 1 }, { 6, 1 }, { 8, 1 }, { 10, 5 }, { 42, 5 },
+};
+
+static constexpr PakLzLength_t s_longLengthTable[16] =
+{
+    { 74, 5 }, { 106, 5 }, { 138, 5 }, { 170, 5 }, { 202, 5 }, { 234, 5 }, { 266, 5 }, { 298, 5 },
+    { 330, 5 }, { 362, 5 }, { 394, 5 }, { 426, 9 }, { 938, 9 }, { 1450, 13 }, { 9642, 17 }, { 140714, 21 },
+};
+
+// zeroed bytes kept after the pushed input, the bit reader and the fixed size literal copies read past what they consume
+static constexpr size_t s_inputPadding = 32ull;
+
+// input read ahead of the decoded position, a segment is only decoded once this much input follows it (or the input is complete)
+static constexpr uint64_t s_inputLookahead = 16ull;
+
+// consumed input is dropped once there is at least this much of it
+static constexpr uint64_t s_inputCompactSize = 1ull << 20;
+
+// in place input stops this far before its end, a token reads at most 8 bytes of window refills and 16 literal bytes past its start
+static constexpr uint64_t s_inPlaceTail = 32ull;
+
+static FORCEINLINE const uint64_t ByteMask(const uint32_t bytes)
+{
+    return bytes >= 8u ? ~0ull : (1ull << (bytes * 8u)) - 1ull;
+}
+
+// tops the window back up after bits were consumed, bitsUsed has to be non zero
+static FORCEINLINE void RefillBits(uint64_t& bits, uint32_t& bitsUsed, uint64_t& inPos, const uint64_t next)
+{
+    bits |= next << (64u - bitsUsed);
+    inPos += bitsUsed >> 3;
+    bitsUsed &= 7u;
+    bits &= ~0ull >> bitsUsed;
+}
+
+// reads an extended length, matches pass their input position so the longest lengths can top the window up by a byte
+static FORCEINLINE const uint32_t ReadExtendedLength(uint64_t& bits, uint32_t& bitsUsed, const uint8_t* const nextByte, uint64_t* const inPos)
+{
+    const uint32_t shortCode = static_cast<uint32_t>(bits & 7ull);
+    bits >>= 3;
+    bitsUsed += 3u;
+
+    PakLzLength_t code = s_shortLengthTable[shortCode];
+
+    if (!shortCode)
+    {
+        code = s_longLengthTable[bits & 0xFull];
+        bits >>= 4;
+        bitsUsed += 4u;
+
+        if (inPos && bitsUsed + code.bits >= 64u)
+        {
+            bits |= static_cast<uint64_t>(*nextByte) << (64u - bitsUsed);
+            bitsUsed -= 8u;
+            (*inPos)++;
+        }
+    }
+
+    const uint32_t extra = static_cast<uint32_t>(bits) & ((1u << code.bits) - 1u);
+    bits >>= code.bits;
+    bitsUsed += code.bits;
+
+    return code.base + extra;
+}
+
+// copies through a register so overlapping matches repeat the bytes written by the previous copy
+static FORCEINLINE void Copy8(char* const dst, const char* const src)
+{
+    uint64_t tmp;
+    memcpy(&tmp, src, sizeof(uint64_t));
+    memcpy(dst, &tmp, sizeof(uint64_t));
+}
+
+CPakDecoder::CPakDecoder() : m_input(s_inputPadding, 0u), m_inputBase(0ull), m_inPlaceInput(nullptr), m_inPlaceEnd(0ull), m_inputEnd(0ull), m_compressedSize(0ull), m_output(nullptr), m_outputSize(0ull),
+    m_bits(0ull), m_bitsUsed(0u), m_afterLiteral(0u), m_inPos(0ull), m_outPos(0ull), m_decompSize(0ull), m_inputChunkMask(0ull), m_outputChunkMask(0ull), m_inputChunkLimit(0ull),
+    m_sizeFieldBytes(0u), m_inputNeeded(0ull), m_segmentInputEnd(0ull), m_segmentOutputEnd(0ull), m_headerRead(false), m_segmentDone(false), m_corrupt(false)
+{
+}
+
+FORCEINLINE const uint64_t CPakDecoder::LoadInput64(const uint64_t pos) const
+{
+    uint64_t value;
+
+    if (pos < m_inPlaceEnd)
+        memcpy(&value, m_inPlaceInput + pos, sizeof(uint64_t));
+    else
+        memcpy(&value, m_input.data() + (pos - m_inputBase), sizeof(uint64_t));
+
+    return value;
+}
+
+FORCEINLINE const bool CPakDecoder::HasInput(const uint64_t pos) const
+{
+    return pos + s_inputLookahead <= m_inputEnd || m_inputEnd >= m_compressedSize;
+}
+
+void CPakDecoder::PushInput(const char* const data, const size_t size)
+{
+    assertm(!m_inPlaceInput, "input was already set in place");
+
+    // drop input that has been consumed once it makes up most of the buffer, so a long stream isn't held in full
+    const uint64_t consumed = std::min(m_inPos, m_inputEnd) - m_inputBase;
+    if (consumed >= s_inputCompactSize && consumed * 2ull >= m_inputEnd - m_inputBase)
+    {
+        m_input.erase(m_input.begin(), m_input.begin() + consumed);
+        m_inputBase += consumed;
+    }
+
+    const size_t pushed = static_cast<size_t>(m_inputEnd - m_inputBase);
+
+    m_input.resize(pushed + size + s_inputPadding, 0u);
+    memcpy(m_input.data() + pushed, data, size);
+
+    m_inputEnd += size;
+}
+
+void CPakDecoder::SetInput(const char* const data, const size_t size)
+{
+    assertm(m_inputEnd == 0ull, "input was already pushed");
+
+    // only the tail is copied, so the reads past the end land in zeroed padding
+    m_inPlaceInput = reinterpret_cast<const uint8_t*>(data);
+    m_inPlaceEnd = size > s_inPlaceTail ? size - s_inPlaceTail : 0ull;
+
+    const size_t tailSize = static_cast<size_t>(size - m_inPlaceEnd);
+
+    m_input.assign(tailSize + s_inputPadding, 0u);
+    memcpy(m_input.data(), data + m_inPlaceEnd, tailSize);
+
+    m_inputBase = m_inPlaceEnd;
+    m_inputEnd = size;
+}
+
+const size_t CPakDecoder::ReadHeader(const size_t compressedSize, const size_t headerSize)
+{
+    if (m_headerRead)
+        return m_decompSize;
+
+    if (compressedSize < headerSize + 8ull)
+        return 0ull;
+
+    // size bits, decoded size, chunk sizes and the first size field
+    if (m_inputEnd < std::min<uint64_t>(compressedSize, headerSize + 32ull))
+        return 0ull;
+
+    m_compressedSize = compressedSize;
+
+    uint64_t inPos = headerSize + 8ull;
+    uint64_t bits = LoadInput64(headerSize);
+    uint32_t bitsUsed = 0u;
+
+    const uint32_t sizeBits = static_cast<uint32_t>(bits & 0x3Full);
+    if (sizeBits > 48u)
+        return 0ull;
+
+    bits >>= 6;
+
+    const uint64_t decompSize = (bits & ((1ull << sizeBits) - 1ull)) | (1ull << sizeBits);
+    bits >>= sizeBits;
+    bitsUsed += 6u + sizeBits;
+
+    RefillBits(bits, bitsUsed, inPos, LoadInput64(inPos));
+
+    const uint32_t chunkBits = static_cast<uint32_t>(bits & 0x1FFFull);
+    bits >>= 13;
+    bitsUsed += 13u;
+
+    RefillBits(bits, bitsUsed, inPos, LoadInput64(inPos));
+
+    const uint32_t inputChunkBits = ((chunkBits - 1u) & 0x3Fu) + 1u;
+
+    m_inputChunkMask = ~0ull >> (64u - inputChunkBits);
+    m_outputChunkMask = ~0ull >> (63u - (((chunkBits >> 6) - 1u) & 0x3Fu));
+
+    uint64_t segmentInputSize = compressedSize;
+    m_sizeFieldBytes = 0u;
+
+    // streams without input chunks are a single segment
+    if (m_inputChunkMask != ~0ull)
+    {
+        m_sizeFieldBytes = (inputChunkBits >> 3) + 1u;
+
+        segmentInputSize = LoadInput64(inPos) & ByteMask(m_sizeFieldBytes);
+        inPos += m_sizeFieldBytes;
+    }
+
+    m_inputChunkLimit = m_inputChunkMask - 6ull;
+    m_inputNeeded = segmentInputSize;
+    m_segmentInputEnd = segmentInputSize;
+    m_segmentOutputEnd = decompSize;
+
+    if (decompSize - 1ull > m_outputChunkMask)
+    {
+        m_segmentOutputEnd = m_outputChunkMask + 1ull;
+        m_segmentInputEnd = segmentInputSize - m_sizeFieldBytes;
+    }
+
+    if (m_segmentOutputEnd <= headerSize)
+        return 0ull;
+
+    m_bits = bits;
+    m_bitsUsed = bitsUsed;
+    m_afterLiteral = 0u;
+    m_inPos = inPos;
+    m_outPos = headerSize;
+    m_decompSize = decompSize;
+
+    m_headerRead = true;
+
+    return decompSize;
+}
+
+void CPakDecoder::SetOutput(char* const output, const size_t outputSize)
+{
+    assertm(m_headerRead, "stream header has to be read before the output is set");
+    assertm(outputSize >= m_decompSize + s_outputPadding, "output buffer is too small for the decoded stream");
+
+    m_output = output;
+    m_outputSize = outputSize;
+}
+
+const CPakDecoder::eStatus CPakDecoder::Decode()
+{
+    if (m_corrupt || !m_headerRead || !m_output || m_outputSize < m_decompSize + s_outputPadding)
+        return eStatus::CORRUPT;
+
+    for (;;)
+    {
+        if (m_segmentDone)
+        {
+            if (m_outPos == m_decompSize)
+                return eStatus::DONE;
+
+            if (!AdvanceSegment())
+                return m_corrupt ? eStatus::CORRUPT : eStatus::NEED_INPUT;
+
+            m_segmentDone = false;
+        }
+
+        if (!HasInput(m_inputNeeded))
+            return eStatus::NEED_INPUT;
+
+        if (!DecodeSegment())
+        {
+            m_corrupt = true;
+            return eStatus::CORRUPT;
+        }
+    }
+}
+
+// moves on to the next segment, returns false if its size field hasn't been pushed yet or is past the end of the stream
+const bool CPakDecoder::AdvanceSegment()
+{
+    uint64_t pos = m_inPos;
+
+    // size fields don't straddle input chunks, one that doesn't fit starts the next chunk
+    const uint64_t chunkRemaining = m_inputChunkMask & (0ull - pos);
+    const bool nextChunk = m_sizeFieldBytes > chunkRemaining;
+
+    if (nextChunk)
+        pos += chunkRemaining;
+
+    if (pos + m_sizeFieldBytes > m_compressedSize)
+    {
+        m_corrupt = true;
+        return false;
+    }
+
+    if (!HasInput(pos + m_sizeFieldBytes))
+        return false;
+
+    // the previous segment ends with a stop bit
+    m_bits >>= 1;
+    m_bitsUsed++;
+
+    if (nextChunk && pos > m_inputChunkLimit)
+        m_inputChunkLimit += m_inputChunkMask + 1ull;
+
+    const uint64_t segmentInputSize = LoadInput64(pos) & ByteMask(m_sizeFieldBytes);
+    pos += m_sizeFieldBytes;
+
+    m_inputNeeded += segmentInputSize;
+    m_segmentInputEnd += segmentInputSize;
+
+    m_segmentOutputEnd = m_outPos + m_outputChunkMask + 1ull;
+    if (m_segmentOutputEnd >= m_decompSize)
+    {
+        m_segmentOutputEnd = m_decompSize;
+        m_segmentInputEnd += m_sizeFieldBytes;
+    }
+
+    if (pos >= m_inputChunkLimit)
+    {
+        // only a corrupt stream reads past the chunk it started in
+        const uint64_t chunkStart = ~m_inputChunkMask & (pos + 7ull);
+        if (chunkStart < pos)
+        {
+            m_corrupt = true;
+            return false;
+        }
+
+        pos = chunkStart;
+        m_inputChunkLimit += m_inputChunkMask + 1ull;
+    }
+
+    m_inPos = pos;
+
+    return true;
+}
+
+// decodes tokens until the current segment is complete, returns false on corrupt input
+const bool CPakDecoder::DecodeSegment()
+{
+    const uint64_t inputEnd = m_inputEnd;
+    char* const output = m_output;
+    const uint64_t segmentOutputEnd = m_segmentOutputEnd;
+
+    uint64_t bits = m_bits;
+    uint32_t bitsUsed = m_bitsUsed;
+    uint32_t afterLiteral = m_afterLiteral;
+    uint64_t inPos = m_inPos;
+    uint64_t outPos = m_outPos;
+
+    // in place input is read directly until a token could read past its end, then from the padded copy of the tail
+    const uint8_t* input = m_input.data();
+    uint64_t inputBase = m_inputBase;
+    uint64_t inPlaceEnd = ~0ull;
+
+    if (inPos < m_inPlaceEnd)
+    {
+        input = m_inPlaceInput;
+        inputBase = 0ull;
+        inPlaceEnd = m_inPlaceEnd;
+    }
+
+    // a corrupt size field can't take the reads past the input either
+    uint64_t inputLimit = std::min({ m_inputChunkLimit, m_segmentInputEnd, inputEnd });
+
+    for (;;)
+    {
+        if (inPos >= inPlaceEnd)
+        {
+            input = m_input.data();
+            inputBase = m_inputBase;
+            inPlaceEnd = ~0ull;
+        }
+
+        if (bitsUsed)
+        {
+            uint64_t next;
+            memcpy(&next, input + (inPos - inputBase), sizeof(uint64_t));
+
+            RefillBits(bits, bitsUsed, inPos, next);
+        }
+
+        const PakLzToken_t token = s_tokenTable[afterLiteral][bits & 0xFFull];
+        bits >>= token.bits;
+        bitsUsed += token.bits;
+
+        char* const dst = output + outPos;
+
+        if (token.value < 0)
+        {
+            const char* const src = reinterpret_cast<const char*>(input + (inPos - inputBase));
+            uint32_t length = static_cast<uint32_t>(-token.value);
+
+            if (token.value == s_longLiteralToken[afterLiteral])
+            {
+                // the token length only counts towards the run away from the end of a chunk or the stream
+                if ((~inPos & m_inputChunkMask) < 15ull || (~outPos & m_outputChunkMask) < 15ull || m_decompSize - outPos < 16ull)
+                    length = 1u;
+
+                length += ReadExtendedLength(bits, bitsUsed, nullptr, nullptr);
+
+                if (inPos + length > inputEnd || outPos + length > segmentOutputEnd)
+                    return false;
+
+                memcpy(dst, src, length);
+            }
+            else
+            {
+                if (inPos + length > inputEnd || outPos + length > segmentOutputEnd)
+                    return false;
+
+                // short runs always copy 16 bytes, the padding takes the overrun
+                memcpy(dst, src, 16);
+            }
+
+            inPos += length;
+            outPos += length;
+
+            afterLiteral = 1u;
+        }
+        else
+        {
+            // 4 bit distance exponent, 15 is extended by another 2 bits
+            uint32_t exponent = static_cast<uint32_t>(bits & 0xFull);
+            uint32_t codeBits = 4u;
+
+            if (exponent == 15u)
+            {
+                exponent += static_cast<uint32_t>((bits >> 4) & 3ull);
+                codeBits = 6u;
+            }
+
+            const PakLzDistance_t& low = s_distanceTable[(bits >> codeBits) & 0x3Full];
+            codeBits += low.bits;
+
+            const uint32_t distanceBits = static_cast<uint32_t>(bits >> codeBits) & ((1u << exponent) - 1u);
+            const uint32_t distance = (16u * ((1u << exponent) + distanceBits)) + low.low - 16u;
+
+            bits >>= codeBits + exponent;
+            bitsUsed += codeBits + exponent;
+
+            if (distance > outPos)
+                return false;
+
+            const char* const src = dst - distance;
+
+            if (token.value == s_longMatchToken)
+            {
+                uint32_t length = ReadExtendedLength(bits, bitsUsed, input + (inPos - inputBase), &inPos) + 17u;
+
+                if (distance < 8u)
+                {
+                    // overlapping match, the encoder stores these 13 bytes longer
+                    length -= 13u;
+
+                    if (outPos + length > segmentOutputEnd)
+                        return false;
+
+                    if (distance == 1u)
+                    {
+                        memset(dst, *src, (length + 7u) & ~7u);
+                    }
+                    else
+                    {
+                        for (uint32_t i = 0u; i < length; ++i)
+                            dst[i] = src[i];
+                    }
+                }
+                else
+                {
+                    if (outPos + length > segmentOutputEnd)
+                        return false;
+
+                    for (uint32_t i = 0u; i < length; i += 8u)
+                        Copy8(dst + i, src + i);
+                }
+
+                outPos += length;
+            }
+            else
+            {
+                if (outPos + static_cast<uint32_t>(token.value) > segmentOutputEnd)
+                    return false;
+
+                Copy8(dst, src);
+                Copy8(dst + 8, src + 8);
+
+                outPos += static_cast<uint32_t>(token.value);
+            }
+
+            afterLiteral = 0u;
+        }
+
+        if (inPos < inputLimit)
+            continue;
+
+        if (outPos == segmentOutputEnd)
+            break;
+
+        // the window only ever reads 8 bytes ahead of what it has consumed
+        if (inPos > inputEnd + 8ull)
+            return false;
+
+        // skip the padding at the end of an input chunk, only a corrupt stream reads past the chunk it started in
+        if (inPos >= m_inputChunkLimit)
+        {
+            const uint64_t chunkStart = ~m_inputChunkMask & (inPos + 7ull);
+            if (chunkStart < inPos)
+                return false;
+
+            inPos = chunkStart;
+            m_inputChunkLimit += m_inputChunkMask + 1ull;
+        }
+
+        inputLimit = std::min({ m_inputChunkLimit, m_segmentInputEnd, inputEnd });
+    }
+
+    m_bits = bits;
+    m_bitsUsed = bitsUsed;
+    m_afterLiteral = afterLiteral;
+    m_inPos = inPos;
+    m_outPos = outPos;
+
+    m_segmentDone = true;
+
+    return true;
+}
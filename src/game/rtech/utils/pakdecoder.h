@@ -0,0 +1,81 @@
+#pragma once
+
+// streaming decoder for rtech pak lz compression
+// input is pushed in slices as it becomes available, Decode runs until it needs more input or the stream is done
+// the stream is split into segments of (outputChunkMask + 1) decoded bytes, each led by its compressed size,
+// a segment is only decoded once all of its input has been pushed, so a single segment stream needs all of its input first
+// RTech::DecompressPakFile is the reference this is checked against (pak.lzdecode selftest)
+class CPakDecoder
+{
+public:
+    enum class eStatus : uint8_t
+    {
+        NEED_INPUT,
+        DONE,
+        CORRUPT,
+    };
+
+    // matches and literals are copied in 8 and 16 byte blocks, the output buffer needs this much room past the decoded size
+    static constexpr size_t s_outputPadding = 16ull;
+
+    CPakDecoder();
+
+    // input is copied, consumed input is dropped again as the stream is decoded
+    void PushInput(const char* const data, const size_t size);
+
+    // the complete input, read in place instead of copied. it has to outlive the decoder and can't be combined with PushInput
+    void SetInput(const char* const data, const size_t size);
+
+    // parses the stream header, compressedSize is the full input size including headerSize
+    // returns the decoded size including headerSize, 0 if more input is needed or the header is invalid
+    const size_t ReadHeader(const size_t compressedSize, const size_t headerSize);
+
+    // output must hold the decoded size plus s_outputPadding, the first headerSize bytes are left untouched
+    void SetOutput(char* const output, const size_t outputSize);
+
+    const eStatus Decode();
+
+    inline const size_t DecodedSize() const { return m_decompSize; };
+
+private:
+    const uint64_t LoadInput64(const uint64_t pos) const;
+    const bool HasInput(const uint64_t pos) const;
+
+    const bool DecodeSegment();
+    const bool AdvanceSegment();
+
+    std::vector<uint8_t> m_input; // pushed input that hasn't been consumed yet, followed by zeroed padding
+    uint64_t m_inputBase;  // stream position of m_input[0]
+
+    // SetInput reads the stream in place up to m_inPlaceEnd, m_input holds a padded copy of the rest
+    const uint8_t* m_inPlaceInput;
+    uint64_t m_inPlaceEnd;
+
+    uint64_t m_inputEnd;   // stream position of the end of the pushed input
+    uint64_t m_compressedSize;
+
+    char* m_output;
+    size_t m_outputSize;
+
+    // bit reader, the window holds (64 - m_bitsUsed) valid bits that end at m_inPos
+    uint64_t m_bits;
+    uint32_t m_bitsUsed;
+    uint32_t m_afterLiteral; // selects the token table, a literal run can't directly follow another
+
+    uint64_t m_inPos;
+    uint64_t m_outPos;
+    uint64_t m_decompSize;
+
+    uint64_t m_inputChunkMask;
+    uint64_t m_outputChunkMask;
+    uint64_t m_inputChunkLimit;  // the last bytes of an input chunk are padding, reading past this skips to the next chunk
+    uint32_t m_sizeFieldBytes;   // size of each segment's compressed size field, 0 for a single segment
+
+    uint64_t m_inputNeeded;      // input required to decode the current segment
+    uint64_t m_segmentInputEnd;
+    uint64_t m_segmentOutputEnd;
+
+    bool m_headerRead;
+    bool m_segmentDone;
+    bool m_corrupt;
+};
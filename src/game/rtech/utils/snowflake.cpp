@@ -0,0 +1,378 @@
+#include <pch.h>
+#include <game/rtech/utils/snowflake.h>
+#include <game/rtech/utils/snowflake_decode.h>
+
+// evenly spread cdf
+static void InitSnowflakeCdf(uint16_t* const entries, const uint32_t symbols, const uint32_t precision)
+{
+    for (uint32_t i = 0; i <= symbols; ++i)
+        entries[i] = static_cast<uint16_t>(((i << precision) + (symbols >> 1)) / symbols);
+}
+
+// literal code lengths are prefix coded, the code itself is read up front
+// bitsUsed is set to the bits read from data, false if the code is over subscribed
+static const bool ReadSnowflakeCodeLengths(const uint8_t* const data, const uint32_t bitOffset, const uint32_t maxLength, uint8_t* const lengths, uint32_t& bitsUsed)
+{
+    struct CodeEntry_t
+    {
+        uint16_t value;
+        uint16_t length;
+    };
+
+    // next free code for each code length, 0xFFFF when there is none
+    uint16_t nextCode[8] = { 0, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF };
+    CodeEntry_t codes[128] = {};
+
+    uint64_t bits = SnowflakeLoad64(data) >> bitOffset;
+
+    for (uint32_t value = 0; value <= maxLength; ++value)
+    {
+        const uint32_t length = static_cast<uint32_t>(bits & 7);
+        bits >>= 3;
+
+        if (!length)
+            continue;
+
+        uint32_t code = nextCode[length];
+        nextCode[length] = 0xFFFF;
+
+        if (code == 0xFFFF)
+        {
+            // split the closest shorter free code
+            uint32_t shorter = length - 1;
+            while (nextCode[shorter] == 0xFFFF)
+            {
+                // over subscribed
+                if (shorter == 0)
+                    return false;
+
+                --shorter;
+            }
+
+            code = nextCode[shorter];
+            nextCode[shorter] = 0xFFFF;
+
+            for (uint32_t step = 1u << shorter; shorter != length; step *= 2)
+                nextCode[++shorter] = static_cast<uint16_t>(code + step);
+        }
+
+        for (; code < 128; code += 1u << length)
+            codes[code] = { static_cast<uint16_t>(value), static_cast<uint16_t>(length) };
+    }
+
+    const uint32_t entryCount = maxLength + 1;
+
+    const uint8_t* cur = data + ((bitOffset + 3 * entryCount) >> 3);
+    uint32_t bitPos = (bitOffset + 3 * entryCount) & 7;
+
+    // an empty code leaves every literal the same length
+    if (nextCode[0] == 0)
+    {
+        std::memset(lengths, 8, 256);
+    }
+    else
+    {
+        bits = SnowflakeLoad64(cur) >> bitPos;
+
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            const CodeEntry_t& entry = codes[bits & 0x7F];
+
+            bitPos += entry.length;
+            bits >>= entry.length;
+
+            lengths[i] = static_cast<uint8_t>(entry.value);
+
+            // at most 7 bits per length, refill every 8
+            if ((i & 7) == 7)
+            {
+                cur += bitPos >> 3;
+                bitPos &= 7;
+
+                bits = SnowflakeLoad64(cur) >> bitPos;
+            }
+        }
+    }
+
+    bitsUsed = bitPos + 8 * static_cast<uint32_t>(cur - data) - bitOffset;
+    return true;
+}
+
+// literal models start out from the literal code lengths instead of evenly spread
+static const bool InitSnowflakeLiteralModel(SnowflakeModel_t& model, const uint8_t* const lengths)
+{
+    const uint32_t positions = model.posMask + 1u;
+    uint16_t highCum = 0;
+
+    for (uint32_t high = 0; high < 16; ++high)
+    {
+        uint16_t freqs[17] = {};
+        uint16_t total = 0;
+
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            freqs[i] = static_cast<uint16_t>(1u << (15 - lengths[(high << 4) | i]));
+            total = static_cast<uint16_t>(total + freqs[i]);
+        }
+
+        if (total == 0)
+            return false;
+
+        uint32_t cum = 0;
+        for (uint32_t i = 0; i < 17; ++i)
+        {
+            const uint16_t entry = static_cast<uint16_t>(((total >> 1) + (cum << 15)) / total);
+            cum += freqs[i];
+
+            for (uint32_t pos = 0; pos < positions; ++pos)
+            {
+                for (uint32_t prevLow = 0; prevLow < 16; ++prevLow)
+                    model.literalLow[(pos << 8) | (high << 4) | prevLow][i] = entry;
+            }
+        }
+
+        for (uint32_t pos = 0; pos < positions; ++pos)
+        {
+            for (uint32_t prevHigh = 0; prevHigh < 16; ++prevHigh)
+                model.literalHigh[(pos << 4) | prevHigh][high] = highCum;
+        }
+
+        highCum = static_cast<uint16_t>(highCum + total);
+    }
+
+    for (uint32_t pos = 0; pos < positions; ++pos)
+    {
+        for (uint32_t prevHigh = 0; prevHigh < 16; ++prevHigh)
+            model.literalHigh[(pos << 4) | prevHigh][16] = 0x8000;
+    }
+
+    return true;
+}
+
+static const bool InitSnowflakeModel(SnowflakeModel_t& model, const uint32_t posMaskIndex, const uint8_t* const lengths)
+{
+    model.posMask = s_snowflakePosMasks[posMaskIndex];
+    model.modeledRunProb = 2048;
+
+    InitSnowflakeCdf(model.literalRun, 17, 15);
+    InitSnowflakeCdf(model.runBits, 9, 14);
+    InitSnowflakeCdf(model.runLow, 8, 15);
+    InitSnowflakeCdf(model.matchLength, 17, 15);
+    InitSnowflakeCdf(model.matchLengthExt, 17, 14);
+    InitSnowflakeCdf(model.matchLengthBits, 17, 15);
+    InitSnowflakeCdf(model.matchLengthLow, 16, 14);
+
+    for (SnowflakeDistanceModel_t& distModel : model.distance)
+    {
+        InitSnowflakeCdf(distModel.kind, 8, 12);
+
+        for (uint16_t* const rep : distModel.rep)
+            InitSnowflakeCdf(rep, 4, 14);
+
+        InitSnowflakeCdf(distModel.shortHigh, 8, 15);
+        InitSnowflakeCdf(distModel.shortLow, 8, 15);
+        InitSnowflakeCdf(distModel.low, 8, 15);
+
+        for (uint16_t* const slot : distModel.slot)
+            InitSnowflakeCdf(slot, 7, 13);
+    }
+
+    if (lengths)
+    {
+        if (!InitSnowflakeLiteralModel(model, lengths))
+            return false;
+    }
+    else
+    {
+        for (uint16_t* const row : model.literalHigh)
+            InitSnowflakeCdf(row, 16, 15);
+
+        for (uint16_t* const row : model.literalLow)
+            InitSnowflakeCdf(row, 16, 15);
+    }
+
+    model.lastByte = 0;
+    model.repState = 4;
+
+    model.repDistances[0] = 96;
+    model.repDistances[1] = 128;
+    model.repDistances[2] = 80;
+    model.repDistances[3] = 112;
+
+    return true;
+}
+
+CSnowflakeDecoder::CSnowflakeDecoder() : m_state(std::make_unique<SnowflakeState_t>()), m_outputSize(0ull), m_corrupt(false), m_useAVX2(HasAVX2())
+{
+
+}
+
+// the header is read in dwords and the literal code lengths in qwords, neither reaches this far into the stream
+static constexpr size_t s_snowflakeHeaderMaxRead = 320ull;
+
+const size_t CSnowflakeDecoder::ReadHeader(const char* const input, const size_t inputSize)
+{
+    SnowflakeState_t* const state = m_state.get();
+
+    // a short stream is parsed from a zero padded copy, so a corrupt header can't read past it
+    uint8_t paddedHeader[s_snowflakeHeaderMaxRead] = {};
+
+    if (inputSize < s_snowflakeHeaderMaxRead)
+    {
+        std::memcpy(paddedHeader, input, inputSize);
+        state->input = paddedHeader;
+        state->inputEnd = s_snowflakeHeaderMaxRead;
+    }
+    else
+    {
+        state->input = reinterpret_cast<const uint8_t*>(input);
+        state->inputEnd = inputSize;
+    }
+
+    state->inputPos = 0ull;
+    state->bits = 0u;
+    state->bitCount = 0u;
+
+    state->output = nullptr;
+    state->outputPos = 0ull;
+    state->pendingMatches = 0u;
+    state->blockTail = false;
+
+    m_outputSize = 0ull;
+    m_corrupt = true;
+
+    const bool valid = ParseHeader(state);
+
+    state->input = reinterpret_cast<const uint8_t*>(input);
+
+    if (!valid || state->inputPos > inputSize)
+        return 0ull;
+
+    m_corrupt = false;
+    return state->decompSize;
+}
+
+// fills in the sizes and models from the header, false if it is invalid
+const bool CSnowflakeDecoder::ParseHeader(SnowflakeState_t* const state)
+{
+    const uint32_t sizeBits = static_cast<uint32_t>(SnowflakeReadBits(state, 6));
+    state->decompSize = (SnowflakeReadBits(state, sizeBits) | (1ull << sizeBits)) - 1;
+
+    unsigned long streamSizeBits = 0;
+    if (!_BitScanReverse64(&streamSizeBits, (state->decompSize >> 6) + 100 + state->decompSize))
+        return false;
+
+    // the reader takes at most 63 bits at once, only a corrupt decoded size needs more
+    if (streamSizeBits >= 63)
+        return false;
+
+    state->streamSize = SnowflakeReadBits(state, streamSizeBits + 1);
+
+    const uint32_t blockSizeBits = static_cast<uint32_t>(SnowflakeReadBits(state, 4));
+    SnowflakeReadBits(state, 4); // unused block size
+
+    state->blockSize = 1u << (blockSizeBits + 9);
+    state->matchCountBits = blockSizeBits + 8;
+
+    // every whole block starts with a header of at least its match count and two 37 bit states, a size needing more blocks than that is corrupt
+    if ((state->decompSize >> (blockSizeBits + 9)) > (state->streamSize * 8) / (state->matchCountBits + 74) + 1)
+        return false;
+
+    const uint32_t posMaskIndex = static_cast<uint32_t>(SnowflakeReadBits(state, 2));
+    const uint32_t maxCodeLength = static_cast<uint32_t>(SnowflakeReadBits(state, 3)) | 8;
+
+    if (maxCodeLength == 8)
+    {
+        InitSnowflakeModel(state->model, posMaskIndex, nullptr);
+    }
+    else
+    {
+        // the code lengths start at the reader's current bit and are read straight from the input
+        const uint32_t bitCount = state->bitCount;
+        const uint32_t bitsRead = (0u - bitCount) & 31;
+        const uint64_t dwordPos = state->inputPos - (bitCount != 0 ? 4 : 0);
+
+        uint8_t lengths[256];
+        uint32_t bitsUsed = 0u;
+
+        if (!ReadSnowflakeCodeLengths(state->input + dwordPos + (bitsRead >> 3), (0u - bitCount) & 7, maxCodeLength, lengths, bitsUsed))
+            return false;
+
+        if (!InitSnowflakeModel(state->model, posMaskIndex, lengths))
+            return false;
+
+        const uint64_t endPos = dwordPos + 4 * ((static_cast<uint64_t>(bitsUsed) + bitsRead + 31) >> 5);
+        const uint32_t endBits = (bitsUsed + bitsRead) & 31;
+
+        state->inputPos = endPos;
+        state->bits = endBits ? SnowflakeLoad32(state->input + endPos - 4) >> endBits : 0u;
+        state->bitCount = endBits ? 32 - endBits : 0u;
+    }
+
+    state->blockEnd = std::min(state->decompSize, static_cast<uint64_t>(state->blockSize));
+
+    return true;
+}
+
+void CSnowflakeDecoder::SetOutput(char* const output, const size_t outputSize)
+{
+    m_state->output = reinterpret_cast<uint8_t*>(output);
+    m_outputSize = outputSize;
+}
+
+const CSnowflakeDecoder::eStatus CSnowflakeDecoder::Decode(const size_t inputAvailable)
+{
+    if (m_corrupt)
+        return eStatus::CORRUPT;
+
+    SnowflakeState_t* const state = m_state.get();
+
+    // small streams are stored
+    if (state->decompSize < 64)
+    {
+        if (state->inputPos + state->decompSize > inputAvailable)
+            return eStatus::NEED_INPUT;
+
+        if (m_outputSize < state->decompSize)
+            return eStatus::NEED_OUTPUT;
+
+        std::memcpy(state->output, state->input + state->inputPos, state->decompSize);
+        state->outputPos = state->decompSize;
+
+        return eStatus::DONE;
+    }
+
+    const eStatus status = m_useAVX2 ? DecodeAVX2(state, inputAvailable, m_outputSize) : DecodeSSE(state, inputAvailable, m_outputSize);
+
+    if (status == eStatus::CORRUPT)
+        m_corrupt = true;
+
+    return status;
+}
+
+const CSnowflakeDecoder::eStatus CSnowflakeDecoder::DecodeSSE(SnowflakeState_t* const state, const size_t inputAvailable, const size_t outputSize)
+{
+    return SnowflakeDecodeBlocks<false>(state, inputAvailable, outputSize);
+}
+
+const bool CSnowflakeDecoder::HasAVX2()
+{
+    static const bool s_hasAVX2 = []()
+    {
+        int regs[4] = {};
+
+        __cpuid(regs, 0);
+        if (regs[0] < 7)
+            return false;
+
+        // the os has to save the ymm registers too
+        __cpuid(regs, 1);
+        if (!(regs[2] & (1 << 27)) || !(regs[2] & (1 << 28)) || (_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+    }();
+
+    return s_hasAVX2;
+}
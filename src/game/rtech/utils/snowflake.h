@@ -0,0 +1,112 @@
+#pragma once
+
+// adaptive cdfs hold the cumulative frequency of each symbol, the first entry is 0 and the last one the total
+
+// distance models, one per match length class (3, 4, 5, longer)
+struct SnowflakeDistanceModel_t
+{
+    uint16_t kind[9];       // 12 bit, 0 = rep match, 1 = short distance, otherwise explicit distance with (kind * 3) bits
+    uint16_t rep[5][5];     // 14 bit, rep index, selected by the rep state
+    uint16_t shortHigh[9];  // 15 bit
+    uint16_t shortLow[9];   // 15 bit
+    uint16_t low[9];        // 15 bit, low 3 bits of explicit distances
+    uint16_t slot[6][8];    // 13 bit, top bits of explicit distances, per kind
+};
+static_assert(sizeof(SnowflakeDistanceModel_t) == 218);
+
+struct SnowflakeModel_t
+{
+    uint16_t literalRun[18];      // 15 bit, literals before the next match, 16 escapes to runLow and runBits
+    uint16_t runBits[10];         // 14 bit
+    uint16_t runLow[9];           // 15 bit
+    uint16_t matchLength[18];     // 15 bit, match length - 3, 15 escapes to matchLengthExt and 16 to matchLengthBits
+    uint16_t matchLengthExt[18];  // 14 bit
+    uint16_t matchLengthBits[18]; // 15 bit
+    uint16_t matchLengthLow[17];  // 14 bit
+
+    SnowflakeDistanceModel_t distance[4];
+
+    uint16_t modeledRunProb; // 12 bit probability of a long literal run being modeled instead of stored raw
+    uint8_t lastByte;
+    uint8_t repState;
+    uint32_t repDistances[4];
+    uint8_t posMask;
+
+    uint16_t literalHigh[256][17];  // high nibble, by position and the previous high nibble
+    uint16_t literalLow[4096][17];  // low nibble, by position, the high nibble and the previous low nibble
+};
+
+struct SnowflakeState_t
+{
+    // two interleaved range decoder states, each symbol is decoded from the first and the new state is pushed to the back
+    uint64_t rangeState[2];
+
+    // block headers are read with a separate bit reader that shares the input position
+    uint32_t bits;
+    uint32_t bitCount;
+
+    SnowflakeModel_t model;
+
+    const uint8_t* input;
+    uint64_t inputPos;
+    uint64_t inputEnd; // input that has arrived, nothing is read past it
+
+    uint8_t* output;
+    uint64_t outputPos;
+
+    uint64_t decompSize;
+    uint64_t streamSize; // compressed size of the whole stream
+    uint64_t blockEnd;
+    uint32_t blockSize;
+    uint32_t matchCountBits;
+    uint32_t pendingMatches; // matches left in the current block
+    bool blockTail; // the current block's matches are done and only its trailing literals are left
+};
+
+// decoder for rtech snowflake compression
+// the state is allocated once and reset by ReadHeader, so a decoder can be kept around and reused for any number of streams
+// a decoder isn't shared between threads, give each thread its own
+class CSnowflakeDecoder
+{
+public:
+    enum class eStatus : uint8_t
+    {
+        NEED_INPUT,
+        NEED_OUTPUT,
+        DONE,
+        CORRUPT,
+    };
+
+    CSnowflakeDecoder();
+
+    // parses the stream header and resets the models, inputSize is how much of the stream is already in input
+    // input has to stay valid while decoding, the rest of the stream can be filled in as it arrives
+    // returns the decompressed size, 0 if the stream is empty, the header is invalid or it runs past inputSize
+    const size_t ReadHeader(const char* const input, const size_t inputSize);
+
+    // output can be replaced with a larger buffer holding the same decoded data when Decode runs out of output
+    void SetOutput(char* const output, const size_t outputSize);
+
+    // decodes whole blocks while the input and output allow it, call again with more of either to continue
+    // nothing past inputAvailable is read, a corrupt stream that runs past it returns CORRUPT or NEED_INPUT
+    const eStatus Decode(const size_t inputAvailable);
+
+    inline const size_t DecodedSize() const { return m_state->outputPos; };
+    inline const size_t StreamSize() const { return m_state->streamSize; };
+
+    // avx2 is used whenever the cpu has it, the selftests turn it off to check the sse path against it
+    inline void SetUseAVX2(const bool use) { m_useAVX2 = use && HasAVX2(); };
+
+    static const bool HasAVX2();
+
+private:
+    static const bool ParseHeader(SnowflakeState_t* const state);
+
+    static const eStatus DecodeSSE(SnowflakeState_t* const state, const size_t inputAvailable, const size_t outputSize);
+    static const eStatus DecodeAVX2(SnowflakeState_t* const state, const size_t inputAvailable, const size_t outputSize);
+
+    std::unique_ptr<SnowflakeState_t> m_state;
+    size_t m_outputSize;
+    bool m_corrupt;
+    bool m_useAVX2;
+};
@@ -0,0 +1,14 @@
+// built with /arch:AVX2 and without the precompiled header, see rsx.vcxproj
+// only called once CSnowflakeDecoder::HasAVX2 has checked the cpu supports it
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+
+#include <game/rtech/utils/snowflake.h>
+#include <game/rtech/utils/snowflake_decode.h>
+
+const CSnowflakeDecoder::eStatus CSnowflakeDecoder::DecodeAVX2(SnowflakeState_t* const state, const size_t inputAvailable, const size_t outputSize)
+{
+    return SnowflakeDecodeBlocks<true>(state, inputAvailable, outputSize);
+}
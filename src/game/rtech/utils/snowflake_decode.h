@@ -0,0 +1,717 @@
+#pragma once
+
+// decode loops shared by snowflake.cpp and snowflake_avx2.cpp, only include this from those two
+// everything lives in an anonymous namespace so each translation unit compiles its own copy with its own instruction set,
+// code built for avx2 can't end up being called from the sse path
+
+#include <array>
+#include <intrin.h>
+
+namespace
+{
+    // every push renorms at most once, taking 4 bytes, and a command is at most a 511 literal run of two pushes per literal plus its match
+    // once the whole stream hasn't arrived yet, this much input is kept in reserve so a single command never reads past it
+    constexpr uint64_t s_snowflakeInputReserve = 4ull * (2ull * 511ull + 16ull);
+
+    // the trailing literals of a block aren't bounded by the reserve, they wait until this much input per literal is there
+    constexpr uint64_t s_snowflakeMaxLiteralInput = 8ull;
+
+    constexpr uint8_t s_snowflakePosMasks[4] = { 0, 3, 7, 15 };
+
+    // rep cdfs move towards these after decoding each symbol
+    constexpr uint64_t s_snowflakeRepTargets[4] =
+    {
+        0x40003FC13F820000ull, // 0, 16258, 16321, 16384
+        0x40003FC1003F0000ull, // 0, 63, 16321, 16384
+        0x4000007E003F0000ull, // 0, 63, 126, 16384
+        0x00BD007E003F0000ull, // 0, 63, 126, 189
+    };
+
+    // moves the used rep distance to the front
+    alignas(16) constexpr uint8_t s_snowflakeRepShuffles[4][16] =
+    {
+        { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+        { 4, 5, 6, 7, 0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15 },
+        { 8, 9, 10, 11, 0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15 },
+        { 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 },
+    };
+
+    // after decoding a symbol each cdf entry moves (1 / 2^shift) of the way towards its target,
+    // entries above the symbol target (total - step * (symbols - 1)) and entries below it 0, both plus (step * entry) so every symbol keeps a minimum frequency
+    // entries past the last symbol are the total and never move
+    template <uint32_t Total, uint32_t Symbols, uint32_t Step, uint32_t FirstEntry>
+    struct SnowflakeAdapt_t
+    {
+        static constexpr std::array<uint16_t, 16> MakeLanes(const bool increment)
+        {
+            std::array<uint16_t, 16> lanes = {};
+
+            for (uint32_t i = 0; i < 16; ++i)
+            {
+                const uint32_t entry = FirstEntry + i;
+
+                if (entry >= Symbols)
+                    lanes[i] = static_cast<uint16_t>(increment ? Total : 0);
+                else
+                    lanes[i] = static_cast<uint16_t>(increment ? Total - Step * (Symbols - 1) : Step * entry);
+            }
+
+            return lanes;
+        }
+
+        alignas(32) static constexpr std::array<uint16_t, 16> increment = MakeLanes(true);
+        alignas(32) static constexpr std::array<uint16_t, 16> base = MakeLanes(false);
+    };
+
+    using SnowflakeAdaptLiteralRun_t   = SnowflakeAdapt_t<0x8000, 17, 63, 1>;  // literalRun, matchLength, matchLengthBits
+    using SnowflakeAdaptLengthExt_t    = SnowflakeAdapt_t<0x4000, 17, 31, 1>;
+    using SnowflakeAdaptLengthLow_t    = SnowflakeAdapt_t<0x4000, 16, 63, 0>;
+    using SnowflakeAdaptRunBits_t      = SnowflakeAdapt_t<0x4000, 9, 63, 1>;
+    using SnowflakeAdaptRunLow_t       = SnowflakeAdapt_t<0x8000, 8, 31, 0>;
+    using SnowflakeAdaptKind_t         = SnowflakeAdapt_t<0x1000, 8, 31, 0>;
+    using SnowflakeAdaptShortHigh_t    = SnowflakeAdapt_t<0x8000, 8, 127, 0>;
+    using SnowflakeAdaptShortLow_t     = SnowflakeAdapt_t<0x8000, 8, 31, 0>;
+    using SnowflakeAdaptDistanceLow_t  = SnowflakeAdapt_t<0x8000, 8, 63, 0>;
+    using SnowflakeAdaptSlot_t         = SnowflakeAdapt_t<0x2000, 7, 63, 0>;
+    using SnowflakeAdaptLiteralHigh_t  = SnowflakeAdapt_t<0x8000, 16, 127, 0>;
+    using SnowflakeAdaptLiteralLow_t   = SnowflakeAdapt_t<0x8000, 16, 63, 0>;
+
+    template <typename Adapt, int Shift>
+    __forceinline const __m128i SnowflakeAdapt8(const __m128i entries, const __m128i greater, const uint32_t half)
+    {
+        const __m128i increment = _mm_load_si128(reinterpret_cast<const __m128i*>(Adapt::increment.data() + half * 8));
+        const __m128i base = _mm_load_si128(reinterpret_cast<const __m128i*>(Adapt::base.data() + half * 8));
+        const __m128i target = _mm_add_epi16(_mm_and_si128(greater, increment), base);
+
+        return _mm_add_epi16(_mm_srai_epi16(_mm_sub_epi16(target, entries), Shift), entries);
+    }
+
+    // 8 entry cdf, compares every entry against the decoded value
+    class CSnowflakeCdf8
+    {
+    public:
+        __forceinline CSnowflakeCdf8(const uint16_t* const entries, const uint32_t value) : m_entries(_mm_loadu_si128(reinterpret_cast<const __m128i*>(entries)))
+        {
+            m_greater = _mm_cmpgt_epi16(m_entries, _mm_set1_epi16(static_cast<short>(value)));
+        }
+
+        // number of entries above the value
+        __forceinline const uint32_t Count() const { return __popcnt(_mm_movemask_epi8(m_greater)) >> 1; };
+
+        template <typename Adapt, int Shift>
+        __forceinline void Store(uint16_t* const entries) const
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(entries), SnowflakeAdapt8<Adapt, Shift>(m_entries, m_greater, 0));
+        }
+
+    private:
+        __m128i m_entries;
+        __m128i m_greater;
+    };
+
+    // 16 entry cdf, one avx2 register or two sse ones
+    template <bool AVX2>
+    class CSnowflakeCdf16;
+
+    template <>
+    class CSnowflakeCdf16<false>
+    {
+    public:
+        __forceinline void Compare(const uint16_t* const entries, const uint32_t value)
+        {
+            const __m128i broadcast = _mm_set1_epi16(static_cast<short>(value));
+
+            m_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(entries));
+            m_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(entries + 8));
+            m_greaterLow = _mm_cmpgt_epi16(m_low, broadcast);
+            m_greaterHigh = _mm_cmpgt_epi16(m_high, broadcast);
+        }
+
+        // for adapting to a symbol that wasn't decoded from the cdf, entries past the symbol count as above it
+        __forceinline void CompareSymbol(const uint16_t* const entries, const uint32_t symbol)
+        {
+            const __m128i broadcast = _mm_set1_epi16(static_cast<short>(symbol));
+
+            m_low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(entries));
+            m_high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(entries + 8));
+            m_greaterLow = _mm_cmpgt_epi16(_mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7), broadcast);
+            m_greaterHigh = _mm_cmpgt_epi16(_mm_setr_epi16(8, 9, 10, 11, 12, 13, 14, 15), broadcast);
+        }
+
+        __forceinline const uint32_t Count() const { return __popcnt(Mask()); };
+
+        // index of the first entry above the value, 16 if there is none
+        __forceinline const uint32_t First() const
+        {
+            unsigned long index = 0;
+            _BitScanForward(&index, Mask() | 0x10000);
+
+            return index;
+        }
+
+        template <typename Adapt, int Shift>
+        __forceinline void Store(uint16_t* const entries) const
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(entries), SnowflakeAdapt8<Adapt, Shift>(m_low, m_greaterLow, 0));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(entries + 8), SnowflakeAdapt8<Adapt, Shift>(m_high, m_greaterHigh, 1));
+        }
+
+    private:
+        __forceinline const uint32_t Mask() const { return _mm_movemask_epi8(_mm_packs_epi16(m_greaterLow, m_greaterHigh)); };
+
+        __m128i m_low;
+        __m128i m_high;
+        __m128i m_greaterLow;
+        __m128i m_greaterHigh;
+    };
+
+    template <>
+    class CSnowflakeCdf16<true>
+    {
+    public:
+        __forceinline void Compare(const uint16_t* const entries, const uint32_t value)
+        {
+            m_entries = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entries));
+            m_greater = _mm256_cmpgt_epi16(m_entries, _mm256_set1_epi16(static_cast<short>(value)));
+        }
+
+        __forceinline void CompareSymbol(const uint16_t* const entries, const uint32_t symbol)
+        {
+            m_entries = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entries));
+            m_greater = _mm256_cmpgt_epi16(_mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm256_set1_epi16(static_cast<short>(symbol)));
+        }
+
+        // movemask gives two bits per entry
+        __forceinline const uint32_t Count() const { return __popcnt(_mm256_movemask_epi8(m_greater)) >> 1; };
+
+        __forceinline const uint32_t First() const
+        {
+            unsigned long index = 0;
+            _BitScanForward64(&index, static_cast<uint32_t>(_mm256_movemask_epi8(m_greater)) | (1ull << 32));
+
+            return index >> 1;
+        }
+
+        template <typename Adapt, int Shift>
+        __forceinline void Store(uint16_t* const entries) const
+        {
+            const __m256i increment = _mm256_load_si256(reinterpret_cast<const __m256i*>(Adapt::increment.data()));
+            const __m256i base = _mm256_load_si256(reinterpret_cast<const __m256i*>(Adapt::base.data()));
+            const __m256i target = _mm256_add_epi16(_mm256_and_si256(m_greater, increment), base);
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(entries), _mm256_add_epi16(_mm256_srai_epi16(_mm256_sub_epi16(target, m_entries), Shift), m_entries));
+        }
+
+    private:
+        __m256i m_entries;
+        __m256i m_greater;
+    };
+
+    __forceinline const uint32_t SnowflakeLoad32(const uint8_t* const data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(uint32_t));
+
+        return value;
+    }
+
+    __forceinline const uint64_t SnowflakeLoad64(const uint8_t* const data)
+    {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(uint64_t));
+
+        return value;
+    }
+
+    // reads past the input that has arrived give zeros, only a corrupt stream gets there and it's caught once its command is done
+    __forceinline const uint32_t SnowflakeLoadInput32(const SnowflakeState_t* const state, const uint64_t pos)
+    {
+        return pos + 4 <= state->inputEnd ? SnowflakeLoad32(state->input + pos) : 0u;
+    }
+
+    // reads up to 63 bits, the reader loads the input in dwords and keeps what it didn't use for the next read
+    inline const uint64_t SnowflakeReadBits(SnowflakeState_t* const state, const uint32_t count)
+    {
+        const uint32_t bitCount = state->bitCount;
+
+        if (bitCount >= count)
+        {
+            const uint32_t bits = state->bits;
+
+            state->bitCount = bitCount - count;
+            state->bits = static_cast<uint32_t>(static_cast<uint64_t>(bits) >> count);
+
+            return bits & ((1ull << count) - 1);
+        }
+
+        const uint64_t pos = state->inputPos;
+
+        uint64_t bits = state->bits | (static_cast<uint64_t>(SnowflakeLoadInput32(state, pos)) << bitCount);
+        uint32_t remaining = bitCount + 32 - count;
+        uint32_t next = 0;
+
+        state->inputPos = pos + 4;
+
+        if (bitCount + 32 >= count)
+        {
+            next = static_cast<uint32_t>(bits >> count);
+        }
+        else
+        {
+            const uint32_t more = SnowflakeLoadInput32(state, pos + 4);
+
+            state->inputPos = pos + 8;
+
+            bits |= static_cast<uint64_t>(more) << (bitCount + 32);
+            next = more >> (count - (bitCount + 32));
+            remaining += 32;
+        }
+
+        state->bits = next;
+        state->bitCount = remaining;
+
+        return bits & ((1ull << count) - 1);
+    }
+
+    __forceinline const uint64_t SnowflakeRenorm(SnowflakeState_t* const state, const uint64_t x)
+    {
+        if (x >= (1ull << 32))
+            return x;
+
+        const uint64_t renormed = (x << 32) | SnowflakeLoadInput32(state, state->inputPos);
+        state->inputPos += 4;
+
+        return renormed;
+    }
+
+    // removes a symbol with the given cumulative frequencies from a state
+    __forceinline const uint64_t SnowflakeDecodeState(const uint64_t x, const uint32_t bits, const uint32_t cum, const uint32_t next)
+    {
+        return (x & ((1ull << bits) - 1)) + (x >> bits) * static_cast<uint32_t>(next - cum) - cum;
+    }
+
+    __forceinline void SnowflakePush(SnowflakeState_t* const state, const uint64_t x)
+    {
+        const uint64_t renormed = SnowflakeRenorm(state, x);
+
+        state->rangeState[0] = state->rangeState[1];
+        state->rangeState[1] = renormed;
+    }
+
+    // both states decoded a symbol, they stay in place
+    __forceinline void SnowflakePushPair(SnowflakeState_t* const state, const uint64_t x0, const uint64_t x1)
+    {
+        const uint64_t renormed0 = SnowflakeRenorm(state, x0);
+        const uint64_t renormed1 = SnowflakeRenorm(state, x1);
+
+        state->rangeState[0] = renormed0;
+        state->rangeState[1] = renormed1;
+    }
+
+    template <bool AVX2>
+    void SnowflakeDecodeLiterals(SnowflakeState_t* const state, const uint32_t count)
+    {
+        SnowflakeModel_t& model = state->model;
+
+        uint8_t* out = state->output + state->outputPos;
+        uint64_t pos = state->outputPos;
+        uint32_t prev = model.lastByte;
+
+        state->outputPos += count;
+
+        CSnowflakeCdf16<AVX2> high;
+        CSnowflakeCdf16<AVX2> low;
+
+        if (count > 15)
+        {
+            const uint32_t prob = model.modeledRunProb;
+            const uint64_t x = state->rangeState[0];
+
+            if ((x & 0xFFF) >= prob)
+            {
+                model.modeledRunProb = static_cast<uint16_t>(prob - (prob >> 4));
+                SnowflakePush(state, (x & 0xFFF) + (x >> 12) * static_cast<uint16_t>(0x1000 - prob) - prob);
+
+                // raw run, bytes are taken straight from the state but the literal models still learn them
+                for (uint32_t i = 0; i < count; ++i)
+                {
+                    const uint32_t byte = static_cast<uint8_t>(state->rangeState[0]);
+                    SnowflakePush(state, state->rangeState[0] >> 8);
+
+                    const uint32_t posBits = static_cast<uint32_t>(pos & model.posMask) << 4;
+                    ++pos;
+
+                    *out++ = static_cast<uint8_t>(byte);
+
+                    uint16_t* const highRow = model.literalHigh[posBits | (prev >> 4)];
+                    high.CompareSymbol(highRow, byte >> 4);
+                    high.template Store<SnowflakeAdaptLiteralHigh_t, 7>(highRow);
+
+                    uint16_t* const lowRow = model.literalLow[(prev & 0xF) | ((posBits | (byte >> 4)) << 4)];
+                    low.CompareSymbol(lowRow, byte & 0xF);
+                    low.template Store<SnowflakeAdaptLiteralLow_t, 6>(lowRow);
+
+                    prev = byte;
+                }
+
+                model.lastByte = static_cast<uint8_t>(prev);
+                return;
+            }
+
+            model.modeledRunProb = static_cast<uint16_t>(prob + (static_cast<uint16_t>(0x1000 - prob) >> 4));
+            SnowflakePush(state, (x & 0xFFF) + prob * (x >> 12));
+        }
+
+        const uint32_t posMask = model.posMask;
+        uint8_t pos8 = static_cast<uint8_t>(pos);
+
+        // the high nibble of the first byte is decoded on its own, after that each step decodes
+        // the low nibble of one byte with the first state and the high nibble of the next with the second
+        uint32_t highIndex = (prev >> 4) | ((pos8 & posMask) << 4);
+        uint16_t* highRow = model.literalHigh[highIndex];
+
+        high.Compare(highRow, state->rangeState[0] & 0x7FFF);
+
+        uint32_t curHigh = 15 - high.Count();
+        SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 15, highRow[curHigh], highRow[curHigh + 1]));
+        high.template Store<SnowflakeAdaptLiteralHigh_t, 7>(highRow);
+
+        for (uint32_t i = 1; i < count; ++i)
+        {
+            highIndex = curHigh + ((posMask << 4) & (highIndex + 16));
+            highRow = model.literalHigh[highIndex];
+
+            uint16_t* const lowRow = model.literalLow[(prev & 0xF) | ((curHigh | ((posMask & pos8) << 4)) << 4)];
+
+            low.Compare(lowRow, state->rangeState[0] & 0x7FFF);
+            high.Compare(highRow, state->rangeState[1] & 0x7FFF);
+
+            const uint32_t lowEnd = low.First();
+            const uint32_t highEnd = high.First();
+
+            SnowflakePushPair(state,
+                SnowflakeDecodeState(state->rangeState[0], 15, lowRow[lowEnd - 1], lowRow[lowEnd]),
+                SnowflakeDecodeState(state->rangeState[1], 15, highRow[highEnd - 1], highRow[highEnd]));
+
+            const uint8_t byte = static_cast<uint8_t>((lowEnd - 1) | (curHigh << 4));
+            prev = byte;
+
+            low.template Store<SnowflakeAdaptLiteralLow_t, 6>(lowRow);
+            high.template Store<SnowflakeAdaptLiteralHigh_t, 7>(highRow);
+
+            ++pos8;
+            curHigh = highEnd - 1;
+
+            *out++ = byte;
+        }
+
+        uint16_t* const lowRow = model.literalLow[(prev & 0xF) | ((curHigh | ((posMask & pos8) << 4)) << 4)];
+        low.Compare(lowRow, state->rangeState[0] & 0x7FFF);
+
+        const uint32_t curLow = 15 - low.Count();
+        SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 15, lowRow[curLow], lowRow[curLow + 1]));
+        low.template Store<SnowflakeAdaptLiteralLow_t, 6>(lowRow);
+
+        const uint8_t byte = static_cast<uint8_t>((curHigh << 4) | curLow);
+
+        *out = byte;
+        model.lastByte = byte;
+    }
+
+    template <bool AVX2>
+    const CSnowflakeDecoder::eStatus SnowflakeDecodeBlocks(SnowflakeState_t* const state, const size_t inputAvailable, const size_t outputSize)
+    {
+        using eStatus = CSnowflakeDecoder::eStatus;
+
+        SnowflakeModel_t& model = state->model;
+
+        state->inputEnd = inputAvailable;
+
+        const bool finalInput = inputAvailable >= state->streamSize;
+
+        uint64_t inputLimit = inputAvailable;
+        if (!finalInput)
+        {
+            if (inputAvailable < s_snowflakeInputReserve)
+                return eStatus::NEED_INPUT;
+
+            inputLimit = inputAvailable - s_snowflakeInputReserve;
+        }
+
+        if (outputSize < state->blockEnd)
+            return eStatus::NEED_OUTPUT;
+
+        CSnowflakeCdf16<AVX2> cdf;
+        CSnowflakeCdf16<AVX2> cdfLow;
+
+        uint32_t pending = state->pendingMatches;
+
+        for (;;)
+        {
+            if (pending == 0 && !state->blockTail)
+            {
+                // the tail of the stream is stored
+                if (state->blockEnd - state->outputPos <= 8)
+                {
+                    const uint64_t tail = state->blockEnd - state->outputPos;
+                    if (state->inputPos + tail > inputAvailable)
+                        return eStatus::NEED_INPUT;
+
+                    std::memcpy(state->output + state->outputPos, state->input + state->inputPos, tail);
+                    state->inputPos += tail;
+                    state->outputPos = state->blockEnd;
+
+                    return eStatus::DONE;
+                }
+
+                pending = static_cast<uint32_t>(SnowflakeReadBits(state, state->matchCountBits));
+
+                const uint32_t stateBits0 = static_cast<uint32_t>(SnowflakeReadBits(state, 5)) | 32;
+                state->rangeState[0] = SnowflakeReadBits(state, stateBits0) | (1ull << stateBits0);
+
+                const uint32_t stateBits1 = static_cast<uint32_t>(SnowflakeReadBits(state, 5)) | 32;
+                state->rangeState[1] = SnowflakeReadBits(state, stateBits1) | (1ull << stateBits1);
+            }
+
+            while (pending != 0)
+            {
+                if (state->inputPos > inputLimit)
+                {
+                    state->pendingMatches = pending;
+                    return eStatus::NEED_INPUT;
+                }
+
+                const uint64_t literalLimit = state->blockEnd - 8;
+
+                // literals before the match
+                cdf.Compare(&model.literalRun[1], state->rangeState[0] & 0x7FFF);
+
+                uint32_t literals = 16 - cdf.Count();
+                SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 15, model.literalRun[literals], model.literalRun[literals + 1]));
+                cdf.template Store<SnowflakeAdaptLiteralRun_t, 6>(&model.literalRun[1]);
+
+                if (literals != 0)
+                {
+                    if (literals == 16)
+                    {
+                        const CSnowflakeCdf8 runLow(model.runLow, state->rangeState[0] & 0x7FFF);
+
+                        const uint32_t lowBits = 7 - runLow.Count();
+                        SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 15, model.runLow[lowBits], model.runLow[lowBits + 1]));
+                        runLow.Store<SnowflakeAdaptRunLow_t, 5>(model.runLow);
+
+                        const CSnowflakeCdf8 runBits(&model.runBits[1], state->rangeState[0] & 0x3FFF);
+
+                        const uint32_t bitCount = 8 - runBits.Count();
+                        SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 14, model.runBits[bitCount], model.runBits[bitCount + 1]));
+                        runBits.Store<SnowflakeAdaptRunBits_t, 6>(&model.runBits[1]);
+
+                        if (bitCount <= 5)
+                        {
+                            literals = lowBits + 8 * (bitCount + 2);
+                        }
+                        else
+                        {
+                            const uint64_t x = state->rangeState[0];
+                            const uint32_t rawBits = bitCount - 3;
+
+                            SnowflakePush(state, x >> rawBits);
+                            literals = lowBits + static_cast<uint32_t>((8 * (x & ((1u << rawBits) - 1))) | (1u << bitCount));
+                        }
+                    }
+
+                    if (state->outputPos > literalLimit || literals > literalLimit - state->outputPos)
+                        return eStatus::CORRUPT;
+
+                    SnowflakeDecodeLiterals<AVX2>(state, literals);
+
+                    // a run of the maximum length isn't followed by a match
+                    if (literals == 511)
+                        continue;
+                }
+
+                // match length
+                cdf.Compare(&model.matchLength[1], state->rangeState[0] & 0x7FFF);
+
+                const uint32_t lengthSymbol = 16 - cdf.Count();
+                SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 15, model.matchLength[lengthSymbol], model.matchLength[lengthSymbol + 1]));
+                cdf.template Store<SnowflakeAdaptLiteralRun_t, 6>(&model.matchLength[1]);
+
+                uint32_t length = lengthSymbol + 3;
+
+                if (lengthSymbol == 15)
+                {
+                    cdf.Compare(&model.matchLengthExt[1], state->rangeState[0] & 0x3FFF);
+
+                    const uint32_t ext = 16 - cdf.Count();
+                    SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 14, model.matchLengthExt[ext], model.matchLengthExt[ext + 1]));
+                    cdf.template Store<SnowflakeAdaptLengthExt_t, 5>(&model.matchLengthExt[1]);
+
+                    length = ext + 18;
+                }
+                else if (lengthSymbol == 16)
+                {
+                    cdf.Compare(&model.matchLengthBits[1], state->rangeState[0] & 0x7FFF);
+                    cdfLow.Compare(model.matchLengthLow, state->rangeState[1] & 0x3FFF);
+
+                    const uint32_t bitCount = 16 - cdf.Count();
+                    const uint32_t lowBits = 15 - cdfLow.Count();
+
+                    SnowflakePushPair(state,
+                        SnowflakeDecodeState(state->rangeState[0], 15, model.matchLengthBits[bitCount], model.matchLengthBits[bitCount + 1]),
+                        SnowflakeDecodeState(state->rangeState[1], 14, model.matchLengthLow[lowBits], model.matchLengthLow[lowBits + 1]));
+
+                    cdfLow.template Store<SnowflakeAdaptLengthLow_t, 6>(model.matchLengthLow);
+                    cdf.template Store<SnowflakeAdaptLiteralRun_t, 6>(&model.matchLengthBits[1]);
+
+                    const uint64_t x = state->rangeState[0];
+                    SnowflakePush(state, x >> (bitCount + 1));
+
+                    length = lowBits | static_cast<uint32_t>(16 * (x & ((1u << (bitCount + 1)) - 1))) | (32u << bitCount);
+                }
+
+                // match distance
+                SnowflakeDistanceModel_t& distModel = model.distance[std::min(length - 3, 3u)];
+
+                const CSnowflakeCdf8 kindCdf(distModel.kind, state->rangeState[0] & 0xFFF);
+
+                const uint32_t kind = 7 - kindCdf.Count();
+                SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 12, distModel.kind[kind], distModel.kind[kind + 1]));
+                kindCdf.Store<SnowflakeAdaptKind_t, 5>(distModel.kind);
+
+                uint32_t distance = 0;
+
+                if (kind > 1)
+                {
+                    uint16_t* const slotEntries = distModel.slot[kind - 2];
+
+                    const CSnowflakeCdf8 slot(slotEntries, state->rangeState[0] & 0x1FFF);
+                    const CSnowflakeCdf8 low(distModel.low, state->rangeState[1] & 0x7FFF);
+
+                    const uint32_t slotSymbol = 7 - slot.Count();
+                    const uint32_t lowBits = 7 - low.Count();
+
+                    SnowflakePushPair(state,
+                        SnowflakeDecodeState(state->rangeState[0], 13, slotEntries[slotSymbol], slotEntries[slotSymbol + 1]),
+                        SnowflakeDecodeState(state->rangeState[1], 15, distModel.low[lowBits], distModel.low[lowBits + 1]));
+
+                    slot.Store<SnowflakeAdaptSlot_t, 6>(slotEntries);
+                    low.Store<SnowflakeAdaptDistanceLow_t, 6>(distModel.low);
+
+                    const uint32_t rawBits = 3 * kind - 3;
+                    const uint32_t raw = static_cast<uint32_t>(state->rangeState[0]) & ((1u << rawBits) - 1);
+                    SnowflakePush(state, state->rangeState[0] >> rawBits);
+
+                    distance = (lowBits | (8 * raw) | ((slotSymbol + 1) << (3 * kind))) + 1;
+
+                    model.repState = static_cast<uint8_t>(model.repState - (model.repState >> 2) + 1);
+
+                    const __m128i reps = _mm_slli_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(model.repDistances)), 4);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(model.repDistances), _mm_or_si128(reps, _mm_cvtsi32_si128(distance)));
+                }
+                else if (kind == 1)
+                {
+                    const CSnowflakeCdf8 shortHigh(distModel.shortHigh, state->rangeState[0] & 0x7FFF);
+                    const CSnowflakeCdf8 shortLow(distModel.shortLow, state->rangeState[1] & 0x7FFF);
+
+                    const uint32_t highBits = 7 - shortHigh.Count();
+                    const uint32_t lowBits = 7 - shortLow.Count();
+
+                    SnowflakePushPair(state,
+                        SnowflakeDecodeState(state->rangeState[0], 15, distModel.shortHigh[highBits], distModel.shortHigh[highBits + 1]),
+                        SnowflakeDecodeState(state->rangeState[1], 15, distModel.shortLow[lowBits], distModel.shortLow[lowBits + 1]));
+
+                    distance = (lowBits | (8 * highBits)) + 1;
+
+                    shortHigh.Store<SnowflakeAdaptShortHigh_t, 7>(distModel.shortHigh);
+                    shortLow.Store<SnowflakeAdaptShortLow_t, 5>(distModel.shortLow);
+                }
+                else
+                {
+                    uint16_t* const repEntries = distModel.rep[model.repState];
+
+                    const __m128i entries = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(repEntries));
+                    const __m128i greater = _mm_cmpgt_epi16(entries, _mm_set1_epi16(static_cast<short>(state->rangeState[0] & 0x3FFF)));
+
+                    const uint32_t index = 3 - (__popcnt(_mm_movemask_epi8(greater)) >> 1);
+                    SnowflakePush(state, SnowflakeDecodeState(state->rangeState[0], 14, repEntries[index], repEntries[index + 1]));
+
+                    const __m128i target = _mm_cvtsi64_si128(static_cast<int64_t>(s_snowflakeRepTargets[index]));
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(repEntries), _mm_add_epi16(_mm_srai_epi16(_mm_sub_epi16(target, entries), 6), entries));
+
+                    distance = model.repDistances[index];
+
+                    const __m128i reps = _mm_loadu_si128(reinterpret_cast<const __m128i*>(model.repDistances));
+                    const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(s_snowflakeRepShuffles[index]));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(model.repDistances), _mm_shuffle_epi8(reps, shuffle));
+
+                    model.repState = 0;
+                }
+
+                if (distance > state->outputPos || state->outputPos > literalLimit || length > literalLimit - state->outputPos)
+                    return eStatus::CORRUPT;
+
+                // a match ends at least 8 bytes before the block end, so 4 byte copies can't overrun the output
+                uint8_t* const dst = state->output + state->outputPos;
+                const uint8_t* const src = dst - distance;
+
+                state->outputPos += length;
+
+                if (distance >= 4)
+                {
+                    for (uint32_t i = 0; i < length; i += 4)
+                        std::memcpy(dst + i, src + i, sizeof(uint32_t));
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < length; ++i)
+                        dst[i] = src[i];
+                }
+
+                model.lastByte = src[length - 1];
+
+                --pending;
+            }
+
+            // the rest of the block is literals, followed by the final range decoder states
+            if (state->outputPos + 8 > state->blockEnd)
+                return eStatus::CORRUPT;
+
+            const uint32_t literals = static_cast<uint32_t>(state->blockEnd - state->outputPos);
+
+            if (!finalInput && state->inputPos + s_snowflakeMaxLiteralInput * literals > inputAvailable)
+            {
+                state->pendingMatches = 0;
+                state->blockTail = true;
+                return eStatus::NEED_INPUT;
+            }
+
+            if (literals != 8)
+                SnowflakeDecodeLiterals<AVX2>(state, literals - 8);
+
+            if (state->inputPos > inputAvailable)
+                return eStatus::CORRUPT;
+
+            const uint32_t finalStates[2] = { static_cast<uint32_t>(state->rangeState[1]), static_cast<uint32_t>(state->rangeState[0]) };
+            std::memcpy(state->output + state->outputPos, finalStates, sizeof(finalStates));
+
+            const uint64_t blockEnd = state->blockEnd;
+
+            state->pendingMatches = 0;
+            state->blockTail = false;
+            state->outputPos = blockEnd;
+            state->blockEnd = blockEnd + state->blockSize;
+
+            if (state->blockEnd > state->decompSize)
+            {
+                if (blockEnd == state->decompSize)
+                    return eStatus::DONE;
+
+                state->blockEnd = state->decompSize;
+            }
+
+            if (outputSize < state->blockEnd)
+                return eStatus::NEED_OUTPUT;
+        }
+    }
+}
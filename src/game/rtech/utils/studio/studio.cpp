@@ -3,16 +3,16 @@
 #include <game/rtech/utils/studio/studio_r1.h>
 #include <game/rtech/utils/studio/studio_r2.h>
 
-StudioLooseData_t::StudioLooseData_t(const std::filesystem::path& path, const char* name, char* buffer) : vertexDataBuffer(nullptr), vertexDataOffset(), vertexDataSize(),
+StudioLooseData_t::StudioLooseData_t(const std::filesystem::path& path, const char* name) : vertexDataBuffer(nullptr), vertexDataOffset(), vertexDataSize(),
     physicsDataBuffer(nullptr), physicsDataOffset(0), physicsDataSize(0)
 {
     std::filesystem::path filePath(path);
 
     //
-    // parse and load vertex file
+    // map and load vertex files
     //
-    char* curpos = buffer;  // current position in the buffer
-    size_t curoff = 0ull;   // current offset in the buffer
+    CMappedFile vertexFiles[LooseDataType::SLD_COUNT];
+    size_t curoff = 0ull;   // current offset in the vertex buffer
 
     const char* const fileName = keepAfterLastSlashOrBackslash(name);
 
@@ -22,47 +22,39 @@ StudioLooseData_t::StudioLooseData_t(const std::filesystem::path& path, const ch
         filePath.replace_extension(s_StudioLooseDataExtensions[i]);
 
         // values should default to 0
-        if (!std::filesystem::exists(filePath))
+        if (!vertexFiles[i].Open(filePath))
             continue;
 
-        const size_t fileSize = std::filesystem::file_size(filePath);
-
-        StreamIO fileIn(filePath, eStreamIOMode::Read);
-        fileIn.R()->read(curpos, fileSize);
-
         vertexDataOffset[i] = static_cast<int>(curoff);
-        vertexDataSize[i] = static_cast<int>(fileSize);
+        vertexDataSize[i] = static_cast<int>(vertexFiles[i].Size());
 
-        curoff += IALIGN16(fileSize);
-        curpos += IALIGN16(fileSize);
-
-        assertm(curoff < managedBufferSize, "overflowed managed buffer");
+        curoff += IALIGN16(vertexFiles[i].Size());
     }
 
-    // only allocate memory if we have vertex data
+    // only allocate memory if we have vertex data, copied straight out of the mapped views
     if (curoff)
     {
-        vertexDataBuffer = new char[curoff];
-        memcpy_s(vertexDataBuffer, curoff, buffer, curoff);
+        vertexDataBuffer = new char[curoff] {};
+
+        for (int i = 0; i < LooseDataType::SLD_COUNT; i++)
+        {
+            if (vertexFiles[i].IsOpen())
+                memcpy_s(vertexDataBuffer + vertexDataOffset[i], curoff - static_cast<size_t>(vertexDataOffset[i]), vertexFiles[i].Data(), vertexFiles[i].Size());
+        }
     }
 
     //
-    // parse and load phys
+    // map and load phys
     //
     filePath.replace_extension(".phy");
 
-    if (std::filesystem::exists(filePath))
+    if (const CMappedFile physFile(filePath); physFile.IsOpen())
     {
-        const size_t fileSize = std::filesystem::file_size(filePath);
-
-        StreamIO fileIn(filePath, eStreamIOMode::Read);
-        fileIn.R()->read(buffer, fileSize);
-
         physicsDataOffset = 0;
-        physicsDataSize = static_cast<int>(fileSize);
+        physicsDataSize = static_cast<int>(physFile.Size());
 
         physicsDataBuffer = new char[physicsDataSize];
-        memcpy_s(physicsDataBuffer, physicsDataSize, buffer, physicsDataSize);
+        memcpy_s(physicsDataBuffer, physicsDataSize, physFile.Data(), physicsDataSize);
     }
 
     // here's where ani will go when I do animations (soontm)
@@ -1055,7 +1055,7 @@ struct studiohdr_short_t
 class StudioLooseData_t
 {
 public:
-	StudioLooseData_t(const std::filesystem::path& path, const char* name, char* buffer); // DO NOT call this without managing the allocated buffers.
+	StudioLooseData_t(const std::filesystem::path& path, const char* name); // DO NOT call this without managing the allocated buffers.
 	StudioLooseData_t(char* file);
 
 	enum LooseDataType : int8_t
@@ -305,7 +305,7 @@ seqdesc_t::seqdesc_t(const r5::mstudioseqdesc_v8_t* const seqdesc) : baseptr(rei
 		// fps can't be negative, fps practically shouldn't be more than 2048, 128k frames is an absurd amount, so this is a very good check, since the number (int) should never have those last bits filled.
 		if (ANIMDESC_SANITY_CHECK(pAnimdesc))
 		{
-			Log("Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
+			LOG_WARN(MODEL, "Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
 			break;
 		}
 
@@ -326,7 +326,7 @@ seqdesc_t::seqdesc_t(const r5::mstudioseqdesc_v8_t* const seqdesc, const r5::mst
 		// fps can't be negative, fps practically shouldn't be more than 2048, 128k frames is an absurd amount, so this is a very good check, since the number (int) should never have those last bits filled.
 		if (ANIMDESC_SANITY_CHECK(pAnimdesc))
 		{
-			Log("Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
+			LOG_WARN(MODEL, "Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
 			break;
 		}
 
@@ -347,7 +347,7 @@ seqdesc_t::seqdesc_t(const r5::mstudioseqdesc_v16_t* const seqdesc, const r5::ms
 		// fps can't be negative, fps practically shouldn't be more than 2048, 128k frames is an absurd amount, so this is a very good check, since the number (int) should never have those last bits filled.
 		if (ANIMDESC_SANITY_CHECK(pAnimdesc))
 		{
-			Log("Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
+			LOG_WARN(MODEL, "Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
 			break;
 		}
 
@@ -371,7 +371,7 @@ seqdesc_t::seqdesc_t(const r5::mstudioseqdesc_v18_t* const seqdesc, const r5::ms
 		// fps can't be negative, fps practically shouldn't be more than 2048, 128k frames is an absurd amount, so this is a very good check, since the number (int) should never have those last bits filled.
 		if (ANIMDESC_SANITY_CHECK(pAnimdesc))
 		{
-			Log("Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
+			LOG_WARN(MODEL, "Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
 			break;
 		}
 
@@ -395,7 +395,7 @@ seqdesc_t::seqdesc_t(const r5::mstudioseqdesc_v18_t* const seqdesc, const r5::ms
 		// fps can't be negative, fps practically shouldn't be more than 2048, 128k frames is an absurd amount, so this is a very good check, since the number (int) should never have those last bits filled.
 		if (ANIMDESC_SANITY_CHECK(pAnimdesc))
 		{
-			Log("Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
+			LOG_WARN(MODEL, "Sequence %s had animation(s) (index %i), but no animation description, skipping...\n", seqdesc->pszLabel(), i);
 			break;
 		}
 
@@ -1,5 +1,7 @@
 #include <pch.h>
 #include <game/rtech/utils/utils.h>
+#include <game/rtech/utils/pakdecoder.h>
+#include <game/rtech/utils/snowflake.h>
 #include <thirdparty/oodle/oodle2.h>
 #include <thirdparty/zstd/zstd.h>
 #include <intrin.h>
@@ -2250,6 +2252,11 @@ bool RTech::DecompressSnowflake(int64_t param_buffer, uint64_t data_size, uint64
 
 std::unique_ptr<char[]> RTech::DecompressStreamedBuffer(std::unique_ptr<char[]> buf, uint64_t& bufSize, const eCompressionType compType)
 {
+    PROFILE_SCOPE("decompress streamed");
+
+    // bufSize is the decompressed size by the time we return
+    PROFILE_COUNTER_ADD_ON_EXIT(eProfileCounter::BYTES_DECOMPRESSED, bufSize);
+
     switch (compType)
     {
     case eCompressionType::OODLE:
@@ -2292,40 +2299,55 @@ std::unique_ptr<char[]> RTech::DecompressStreamedBuffer(std::unique_ptr<char[]>
     }
 	case eCompressionType::PAKFILE:
 	{
-		RTech::PakDecompressContext_t context = {};
-		const uint64_t decodeSize = RTech::InitPakDecoder(&context, reinterpret_cast<uint8_t*>(buf.get()), PAK_DECODE_MASK, bufSize, 0, 0); // We don't want to skip any data here, hence why no headerSize.
+		CPakDecoder decoder;
+		decoder.SetInput(buf.get(), bufSize);
 
-		std::unique_ptr<char[]> outBuf = std::make_unique<char[]>(decodeSize);
-		context.m_outputMask = PAK_DECODE_MASK;
-		context.m_outputBuf = uint64_t(outBuf.get());
+		const uint64_t decodeSize = decoder.ReadHeader(bufSize, 0); // We don't want to skip any data here, hence why no headerSize.
+		if (decodeSize == 0)
+		{
+			bufSize = 0;
+			return nullptr;
+		}
+
+		std::unique_ptr<char[]> outBuf = std::make_unique<char[]>(decodeSize + CPakDecoder::s_outputPadding);
+		decoder.SetOutput(outBuf.get(), decodeSize + CPakDecoder::s_outputPadding);
+
+		if (decoder.Decode() != CPakDecoder::eStatus::DONE)
+		{
+			LOG_ERROR(PAK, "PAKFILE: failed to decode streamed buffer, data is corrupt\n");
 
-		DecompressPakFile(&context, bufSize, decodeSize);
-		assertm(decodeSize == context.m_decompSize, "Mismatch on decomp size.");
-		bufSize = context.m_decompSize;
+			bufSize = 0;
+			return nullptr;
+		}
+
+		bufSize = decodeSize;
 		return std::move(outBuf);
 	}
-	case eCompressionType::SNOWFLAKE: // Snowflake will be made prettier when it's working.
+	case eCompressionType::SNOWFLAKE:
 	{
-		std::unique_ptr<char[]> decompState = std::make_unique<char[]>(0x25000);
-		InitSnowflakeDecompState((long long)&decompState.get()[0], reinterpret_cast<int64_t>(buf.get()), bufSize);
-
-		__int64* editDecompState = (__int64*)&decompState.get()[0];
-		__int64 decodeSize = editDecompState[0x48D3];
+		// the decoder state is large, keep one per thread instead of allocating it for every buffer
+		static thread_local CSnowflakeDecoder decoder;
 
-		unsigned int v15 = *((unsigned int*)editDecompState + 0x91A4); // decomp pos?
-		*((uint32_t*)editDecompState + 0x91A2) = 0;
-		if (v15 < decodeSize)
-			decodeSize = v15;
+		// the whole stream has to be in the buffer, a header claiming more is corrupt and its size can't be trusted for the allocation
+		const uint64_t decodeSize = decoder.ReadHeader(buf.get(), bufSize);
+		if (decodeSize == 0 || decoder.StreamSize() > bufSize)
+		{
+			bufSize = 0;
+			return nullptr;
+		}
 
 		std::unique_ptr<char[]> outBuf = std::make_unique<char[]>(decodeSize);
+		decoder.SetOutput(outBuf.get(), decodeSize);
 
-		editDecompState[0x48D4] = decodeSize;
-		editDecompState[0x48DA] = (__int64)outBuf.get(); // output buffer.
-		editDecompState[0x48DB] = 0;
+		if (decoder.Decode(bufSize) != CSnowflakeDecoder::eStatus::DONE)
+		{
+			LOG_ERROR(PAK, "SNOWFLAKE: failed to decode streamed buffer, data is corrupt\n");
 
-		DecompressSnowflake((long long)&decompState.get()[0], bufSize, decodeSize);
-		bufSize = editDecompState[0x48db];
+			bufSize = 0;
+			return nullptr;
+		}
 
+		bufSize = decodeSize;
 		return std::move(outBuf);
 	}
 	case eCompressionType::ZSTD:
@@ -2336,18 +2358,18 @@ std::unique_ptr<char[]> RTech::DecompressStreamedBuffer(std::unique_ptr<char[]>
 		// Check ZSTD magic number first for debugging
 		if (inputSize >= 4) {
 			const unsigned char* p = (const unsigned char*)buf.get();
-			printf("ZSTD magic check: %02X %02X %02X %02X (expected: 28 B5 2F FD)\n",
+			LOG_DEBUG(PAK, "ZSTD magic check: %02X %02X %02X %02X (expected: 28 B5 2F FD)\n",
 				p[0], p[1], p[2], p[3]);
 		}
 
 		// Get the decompressed size from the ZSTD frame
 		const size_t frameContentSize = ZSTD_getFrameContentSize(buf.get(), inputSize);
-		printf("ZSTD frameContentSize: %zu, inputSize: %zu\n", frameContentSize, inputSize);
+		LOG_DEBUG(PAK, "ZSTD frameContentSize: %zu, inputSize: %zu\n", frameContentSize, inputSize);
 
 		if (frameContentSize == ZSTD_CONTENTSIZE_ERROR)
 		{
 			// Not a valid ZSTD frame
-			printf("ZSTD_CONTENTSIZE_ERROR - not a valid ZSTD frame\n");
+			LOG_ERROR(PAK, "ZSTD_CONTENTSIZE_ERROR - not a valid ZSTD frame\n");
 			bufSize = 0;
 			return nullptr;
 		}
@@ -2355,12 +2377,12 @@ std::unique_ptr<char[]> RTech::DecompressStreamedBuffer(std::unique_ptr<char[]>
 		// If frameContentSize equals inputSize, the frame header is likely corrupt or missing size info
 		// Use streaming decompression in this case
 		if (frameContentSize == ZSTD_CONTENTSIZE_UNKNOWN || frameContentSize == inputSize) {
-			printf("Using streaming decompression (frameContentSize == inputSize or UNKNOWN)\n");
+			LOG_DEBUG(PAK, "Using streaming decompression (frameContentSize == inputSize or UNKNOWN)\n");
 
 			// Use streaming decompression context for unknown size
 			ZSTD_DCtx* dctx = ZSTD_createDCtx();
 			if (!dctx) {
-				printf("Failed to create ZSTD decompression context\n");
+				LOG_ERROR(PAK, "Failed to create ZSTD decompression context\n");
 				bufSize = 0;
 				return nullptr;
 			}
@@ -2377,7 +2399,7 @@ std::unique_ptr<char[]> RTech::DecompressStreamedBuffer(std::unique_ptr<char[]>
 
 			if (ZSTD_isError(result)) {
 				const char* errorMsg = ZSTD_getErrorName(result);
-				printf("ZSTD streaming decompression failed: %s\n", errorMsg);
+				LOG_ERROR(PAK, "ZSTD streaming decompression failed: %s\n", errorMsg);
 				ZSTD_freeDCtx(dctx);
 				bufSize = 0;
 				return nullptr;
@@ -2385,15 +2407,15 @@ std::unique_ptr<char[]> RTech::DecompressStreamedBuffer(std::unique_ptr<char[]>
 
 			// If result > 0, there's more data to decompress, but we should have gotten it all in one shot
 			if (result > 0) {
-				printf("Warning: ZSTD decompression incomplete (remaining: %zu)\n", result);
+				LOG_WARN(PAK, "ZSTD decompression incomplete (remaining: %zu)\n", result);
 			}
 
 			ZSTD_freeDCtx(dctx);
 			bufSize = output.pos;
-			printf("ZSTD streaming decompression successful: %zu bytes -> %zu bytes\n", inputSize, bufSize);
+			LOG_DEBUG(PAK, "ZSTD streaming decompression successful: %zu bytes -> %zu bytes\n", inputSize, bufSize);
 			return std::move(outBuf);
 		} else {
-			printf("Using frame content size: %zu\n", frameContentSize);
+			LOG_DEBUG(PAK, "Using frame content size: %zu\n", frameContentSize);
 
 			// Allocate output buffer with known size
 			std::unique_ptr<char[]> outBuf = std::make_unique<char[]>(frameContentSize);
@@ -2405,13 +2427,13 @@ std::unique_ptr<char[]> RTech::DecompressStreamedBuffer(std::unique_ptr<char[]>
 			{
 				// Decompression failed - log error for debugging
 				const char* errorMsg = ZSTD_getErrorName(result);
-				printf("ZSTD decompression failed: %s (input size: %zu, output size: %zu)\n", errorMsg, inputSize, frameContentSize);
+				LOG_ERROR(PAK, "ZSTD decompression failed: %s (input size: %zu, output size: %zu)\n", errorMsg, inputSize, frameContentSize);
 				bufSize = 0;
 				return nullptr;
 			}
 
 			bufSize = result;
-			printf("ZSTD decompression successful: %zu bytes -> %zu bytes\n", inputSize, result);
+			LOG_DEBUG(PAK, "ZSTD decompression successful: %zu bytes -> %zu bytes\n", inputSize, result);
 			return std::move(outBuf);
 		}
 	}
@@ -3,6 +3,19 @@
 
 namespace
 {
+    std::array<std::uint8_t, 16> LUT_Snowflake_0
+    {
+        0, 3, 7, 15, 35, 63, 82, 71, 66, 69, 0, 0, 0, 0, 0, 0
+    };
+
+    std::array<std::uint64_t, 4> LUT_Snowflake_1
+    {
+        4611756117654110208,
+        4611756116592754688,
+        4611686559597395968,
+        53199311768322048,
+    };
+
     // Ignore const warning.
 #pragma warning( push )
 #pragma warning( disable : 4310 )
@@ -125,19 +138,6 @@ namespace
 		0x4C, 0x39, 0x56, 0x75, 0x42, 0x52, 0x65, 0x75, 0x70, 0x35, 0x31, 0x77, 0x4C, 0x51, 0x64, 0x61,
 	};
 #pragma warning( pop )
-
-    std::array<std::uint8_t, 16> LUT_Snowflake_0
-    {
-        0, 3, 7, 15, 35, 63, 82, 71, 66, 69, 0, 0, 0, 0, 0, 0
-    };
-
-    std::array<std::uint64_t, 4> LUT_Snowflake_1
-    {
-        4611756117654110208,
-        4611756116592754688,
-        4611686559597395968,
-        53199311768322048,
-    };
 }
 
 #define PAK_DECODE_MASK 0xFFFFFFFFFFFFFFFFui64
@@ -177,11 +177,11 @@ public:
         uint64_t m_decompStreamSize;
     };
 public:
-    // LZ Variant?
+    // reference pak lz decoder, kept for the differential selftest against CPakDecoder (pak.lzdecode)
     static size_t InitPakDecoder(PakDecompressContext_t* const context, const uint8_t* const fileBuffer, const uint64_t inputMask, const size_t dataSize, const size_t dataOffset, const size_t headerSize);
     static bool DecompressPakFile(PakDecompressContext_t* context, size_t inLen, size_t outLen);
 
-    // Unknown compressor, codename snowflake.
+    // reference snowflake decoder, kept for the differential selftest against CSnowflakeDecoder (snowflake.decode)
     static int64_t InitSnowflakeDecompState(int64_t param_buf, int64_t data_buf, uint64_t data_size);
     static bool DecompressSnowflake(int64_t param_buffer, uint64_t data_size, uint64_t buffer_size);
 
@@ -20,8 +20,12 @@
 #include <ranges>
 #include <mutex>
 
+// load/export stage instrumentation, comment out to compile it out entirely
+#define PROFILER
+
 #include <core/utils/utils_general.h>
 #include <core/utils/fileio.h>
+#include <core/utils/profiler.h>
 #include <core/utils/thread.h>
 #include <core/utils/ramen.h>
 
@@ -77,6 +77,26 @@ static void UtilSettings_ReadLine(ImGuiContext* const ctx, ImGuiSettingsHandler*
         uint32_t i;
         ImGuiReadSetting("ExportThreads=%u", cfg->exportThreadCount, i, uint32_t);
         ImGuiReadSetting("ParseThreads=%u", cfg->parseThreadCount, i, uint32_t);
+
+        // parsed data (ramen) memory settings
+        int n;
+        ImGuiReadSetting("RamenCodec=%u", g_RamenSettings.codec, i, eRamenCodec);
+        ImGuiReadSetting("RamenLevel=%i", g_RamenSettings.level, n, int);
+        ImGuiReadSetting("RamenBudgetMB=%u", g_RamenSettings.budgetMB, i, uint32_t);
+        ImGuiReadSetting("RamenCacheMB=%u", g_RamenSettings.cacheMB, i, uint32_t);
+        ImGuiReadSetting("RamenSpill=%i", g_RamenSettings.spill, n, bool);
+
+        if (g_RamenSettings.codec >= eRamenCodec::_COUNT)
+        {
+            g_RamenSettings.codec = eRamenCodec::KRAKEN;
+            g_RamenSettings.level = CRamen::DefaultCodecLevel(eRamenCodec::KRAKEN);
+        }
+
+        // logging, the logger keeps these itself
+        if (sscanf_s(line, "LogLevel=%u", &i) == 1)        g_logger.SetLevel(static_cast<eLogLevel>(i));
+        if (sscanf_s(line, "LogCategories=%x", &i) == 1)   g_logger.SetCategoryMask(i);
+        if (sscanf_s(line, "LogConsole=%i", &n) == 1)      g_logger.SetConsoleOutput(n != 0);
+        if (strncmp(line, "LogFile=", 8) == 0)              g_logger.SetFile(line + 8);
     }
 }
 
@@ -84,10 +104,19 @@ static void UtilSettings_WriteAll(ImGuiContext* const ctx, ImGuiSettingsHandler*
 {
     UNUSED(ctx);
 
-    buf->reserve(buf->size() + 64);
+    buf->reserve(buf->size() + 320);
     buf->appendf("[%s][utils]\n", handler->TypeName );
     buf->appendf("ExportThreads=%u\n", UtilsConfig->exportThreadCount);
     buf->appendf("ParseThreads=%u\n", UtilsConfig->parseThreadCount);
+    buf->appendf("RamenCodec=%u\n", static_cast<uint32_t>(g_RamenSettings.codec));
+    buf->appendf("RamenLevel=%i\n", g_RamenSettings.level);
+    buf->appendf("RamenBudgetMB=%u\n", g_RamenSettings.budgetMB);
+    buf->appendf("RamenCacheMB=%u\n", g_RamenSettings.cacheMB);
+    buf->appendf("RamenSpill=%i\n", g_RamenSettings.spill);
+    buf->appendf("LogLevel=%u\n", static_cast<uint32_t>(g_logger.GetLevel()));
+    buf->appendf("LogCategories=%x\n", g_logger.GetCategoryMask());
+    buf->appendf("LogConsole=%i\n", g_logger.GetConsoleOutput());
+    buf->appendf("LogFile=%s\n", g_logger.GetFile().c_str());
     buf->append("\n");
 }
 
@@ -113,10 +142,12 @@ static void ExportSettings_ReadLine(ImGuiContext* const ctx, ImGuiSettingsHandle
         int i;
         ImGuiReadSetting("ExportPathsFull=%i",              settings->exportPathsFull, i, int);
         ImGuiReadSetting("ExportAssetDeps=%i",              settings->exportAssetDeps, i, int);
+        ImGuiReadSetting("ExportIncremental=%i",            settings->exportIncremental, i, int);
 
         ImGuiReadSetting("ExportTextureNameSetting=%u",     settings->exportTextureNameSetting, i, uint32_t);
         ImGuiReadSetting("ExportNormalRecalcSetting=%u",    settings->exportNormalRecalcSetting, i, uint32_t);
         ImGuiReadSetting("ExportMaterialTextures=%i",       settings->exportMaterialTextures, i, int);
+        ImGuiReadSetting("ExportTextureDedupe=%i",          settings->exportTextureDedupe, i, int);
 
         ImGuiReadSetting("QCMajorVersion=%u",               settings->qcMajorVersion, i, uint16_t);
         ImGuiReadSetting("QCMinorVersion=%u",               settings->qcMinorVersion, i, uint16_t);
@@ -124,6 +155,15 @@ static void ExportSettings_ReadLine(ImGuiContext* const ctx, ImGuiSettingsHandle
         ImGuiReadSetting("ExportRigSequences=%i",           settings->exportRigSequences, i, int);
         ImGuiReadSetting("ExportModelSkin=%i",              settings->exportModelSkin, i, int);
         ImGuiReadSetting("ExportTruncatedMaterials=%i",     settings->exportModelMatsTruncated, i, int);
+        ImGuiReadSetting("ExportSeqKeyReduction=%i",        settings->exportSeqKeyReduction, i, int);
+
+        float f;
+        ImGuiReadSetting("ExportSeqKeyPosTolerance=%f",     settings->exportSeqKeyPosTolerance, f, float);
+        ImGuiReadSetting("ExportSeqKeyRotTolerance=%f",     settings->exportSeqKeyRotTolerance, f, float);
+        ImGuiReadSetting("ExportSeqKeyScaleTolerance=%f",   settings->exportSeqKeyScaleTolerance, f, float);
+
+        ImGuiReadSetting("ExportAudioFlacLevel=%u",         settings->exportAudioFlacLevel, i, uint32_t);
+        ImGuiReadSetting("ExportAudioFlacBitDepth=%u",      settings->exportAudioFlacBitDepth, i, uint32_t);
     }
 }
 
@@ -131,15 +171,17 @@ static void ExportSettings_WriteAll(ImGuiContext* const ctx, ImGuiSettingsHandle
 {
     UNUSED(ctx);
 
-    buf->reserve(buf->size() + (48 * 10));
+    buf->reserve(buf->size() + (48 * 20));
     buf->appendf("[%s][general]\n", handler->TypeName);
     
     buf->appendf("ExportPathsFull=%i\n",            g_ExportSettings.exportPathsFull);
     buf->appendf("ExportAssetDeps=%i\n",            g_ExportSettings.exportAssetDeps);
+    buf->appendf("ExportIncremental=%i\n",          g_ExportSettings.exportIncremental);
 
     buf->appendf("ExportTextureNameSetting=%u\n",   g_ExportSettings.exportTextureNameSetting);
     buf->appendf("ExportNormalRecalcSetting=%u\n",  g_ExportSettings.exportNormalRecalcSetting);
     buf->appendf("ExportMaterialTextures=%i\n",     g_ExportSettings.exportMaterialTextures);
+    buf->appendf("ExportTextureDedupe=%i\n",        g_ExportSettings.exportTextureDedupe);
 
     buf->appendf("QCMajorVersion=%u\n",             g_ExportSettings.qcMajorVersion);
     buf->appendf("QCMinorVersion=%u\n",             g_ExportSettings.qcMinorVersion);
@@ -147,6 +189,13 @@ static void ExportSettings_WriteAll(ImGuiContext* const ctx, ImGuiSettingsHandle
     buf->appendf("ExportRigSequences=%i\n",         g_ExportSettings.exportRigSequences);
     buf->appendf("ExportModelSkin=%i\n",            g_ExportSettings.exportModelSkin);
     buf->appendf("ExportTruncatedMaterials=%i\n",   g_ExportSettings.exportModelMatsTruncated);
+    buf->appendf("ExportSeqKeyReduction=%i\n",      g_ExportSettings.exportSeqKeyReduction);
+    buf->appendf("ExportSeqKeyPosTolerance=%f\n",   g_ExportSettings.exportSeqKeyPosTolerance);
+    buf->appendf("ExportSeqKeyRotTolerance=%f\n",   g_ExportSettings.exportSeqKeyRotTolerance);
+    buf->appendf("ExportSeqKeyScaleTolerance=%f\n", g_ExportSettings.exportSeqKeyScaleTolerance);
+
+    buf->appendf("ExportAudioFlacLevel=%u\n",       g_ExportSettings.exportAudioFlacLevel);
+    buf->appendf("ExportAudioFlacBitDepth=%u\n",    g_ExportSettings.exportAudioFlacBitDepth);
 
 
     // [rika]: there is no reason the other settings could not be saved in the future, it just seemed unneeded to save them for now.